@@ -9,6 +9,9 @@ URL:        https://github.com/Scribery/%{name}
 Source:     https://github.com/Scribery/%{name}/releases/download/v%{version}/%{name}-%{version}.tar.gz
 
 BuildRequires:  audit-libs-devel
+BuildRequires:  zlib-devel
+BuildRequires:  libzstd-devel
+BuildRequires:  sqlite-devel
 
 BuildRoot: %(mktemp -ud %{_tmppath}/%{name}-%{version}-%{release}-XXXXXX)
 
@@ -42,6 +45,9 @@ rm -r %{buildroot}/usr/include/%{name}.h
 %license COPYING.LESSER
 %doc %{_defaultdocdir}/%{name}
 %{_bindir}/%{name}
+%{_bindir}/%{name}-expand
+%{_bindir}/%{name}-extract
+%{_bindir}/%{name}-shm-read
 %{_libdir}/lib%{name}.so*
 
 %post
@@ -0,0 +1,95 @@
+/**
+ * @brief Memory arena.
+ *
+ * An arena serves allocations from a few large blocks, extending the most
+ * recent allocation in place when possible, and releases all of them at
+ * once when destroyed. Suitable for buffers of a single converter, which
+ * grow to a steady size during the first events and are reused afterwards.
+ * Not thread-safe.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_ARENA_H
+#define _AUSHAPE_ARENA_H
+
+#include <aushape/mem.h>
+#include <aushape/rc.h>
+#include <stdbool.h>
+
+/** Default arena block size */
+#define AUSHAPE_ARENA_BLOCK_SIZE   (256 * 1024)
+
+/** Memory arena (opaque) */
+struct aushape_arena;
+
+/**
+ * Create a memory arena.
+ *
+ * @param parena        Location for the created arena pointer, will not be
+ *                      modified in case of error.
+ * @param block_size    Size of the blocks to allocate from the system, or
+ *                      zero for AUSHAPE_ARENA_BLOCK_SIZE. Bigger
+ *                      allocations get blocks of their own.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - arena created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM        - failed allocating memory.
+ */
+extern enum aushape_rc aushape_arena_create(struct aushape_arena **parena,
+                                            size_t block_size);
+
+/**
+ * Check if an arena is valid.
+ *
+ * @param arena The arena to check.
+ *
+ * @return True if the arena is valid, false otherwise.
+ */
+extern bool aushape_arena_is_valid(const struct aushape_arena *arena);
+
+/**
+ * Get the allocator of an arena, to pass to aushape_conv_create_mem, or
+ * other users. The allocator stays valid until the arena is destroyed.
+ *
+ * @param arena The arena to get the allocator of.
+ *
+ * @return The arena allocator.
+ */
+extern const struct aushape_mem *aushape_arena_get_mem(
+                                        const struct aushape_arena *arena);
+
+/**
+ * Get the total size of the blocks allocated by an arena from the system.
+ *
+ * @param arena The arena to get the size of.
+ *
+ * @return The total size of the allocated blocks, bytes.
+ */
+extern size_t aushape_arena_get_size(const struct aushape_arena *arena);
+
+/**
+ * Destroy an arena, releasing all the memory allocated from it.
+ * The arena users must be destroyed beforehand.
+ *
+ * @param arena The arena to destroy, can be NULL.
+ */
+extern void aushape_arena_destroy(struct aushape_arena *arena);
+
+#endif /* _AUSHAPE_ARENA_H */
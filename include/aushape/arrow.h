@@ -0,0 +1,214 @@
+/**
+ * @brief Apache Arrow IPC stream record batch builder
+ *
+ * Accumulates events in columns and outputs them as Arrow IPC stream
+ * messages: the schema once, then dictionary batches and a record batch for
+ * each batch of events. Each event is a row with these columns:
+ *
+ *  serial  - uint64, event serial number,
+ *  time    - timestamp[ms, UTC], event time,
+ *  node    - utf8, nullable, host name,
+ *  text    - list<utf8>, source text lines, only if requested,
+ *  records - list<struct<type, fields>>, event records in input order:
+ *      type    - dictionary<int32, utf8>, record type name,
+ *      fields  - list<struct<name, value, raw>>, record fields:
+ *          name    - dictionary<int32, utf8>, field name,
+ *          value   - utf8, interpreted value,
+ *          raw     - utf8, nullable, raw value, if different.
+ *
+ * Dictionaries are kept for the whole stream, new entries are output as
+ * dictionary deltas before each record batch.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_ARROW_H
+#define _AUSHAPE_ARROW_H
+
+#include <aushape/conv_ir.h>
+#include <aushape/gbuf.h>
+#include <aushape/mem.h>
+#include <aushape/rc.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Column buffers of a record batch being built */
+enum aushape_arrow_buf {
+    AUSHAPE_ARROW_BUF_SERIAL,       /**< Event serial values */
+    AUSHAPE_ARROW_BUF_TIME,         /**< Event time values */
+    AUSHAPE_ARROW_BUF_NODE_VALID,   /**< Event node validity bitmap */
+    AUSHAPE_ARROW_BUF_NODE_OFFS,    /**< Event node offsets */
+    AUSHAPE_ARROW_BUF_NODE_DATA,    /**< Event node characters */
+    AUSHAPE_ARROW_BUF_TEXT_OFFS,    /**< Event text line list offsets */
+    AUSHAPE_ARROW_BUF_LINE_OFFS,    /**< Text line offsets */
+    AUSHAPE_ARROW_BUF_LINE_DATA,    /**< Text line characters */
+    AUSHAPE_ARROW_BUF_RECORD_OFFS,  /**< Event record list offsets */
+    AUSHAPE_ARROW_BUF_TYPE_IDX,     /**< Record type dictionary indices */
+    AUSHAPE_ARROW_BUF_FIELD_OFFS,   /**< Record field list offsets */
+    AUSHAPE_ARROW_BUF_NAME_IDX,     /**< Field name dictionary indices */
+    AUSHAPE_ARROW_BUF_VALUE_OFFS,   /**< Field value offsets */
+    AUSHAPE_ARROW_BUF_VALUE_DATA,   /**< Field value characters */
+    AUSHAPE_ARROW_BUF_RAW_VALID,    /**< Field raw value validity bitmap */
+    AUSHAPE_ARROW_BUF_RAW_OFFS,     /**< Field raw value offsets */
+    AUSHAPE_ARROW_BUF_RAW_DATA,     /**< Field raw value characters */
+    AUSHAPE_ARROW_BUF_NUM           /**< Number of buffers (not a buffer) */
+};
+
+/** Column item counters of a record batch being built */
+enum aushape_arrow_count {
+    AUSHAPE_ARROW_COUNT_ROW,        /**< Events */
+    AUSHAPE_ARROW_COUNT_NODE_NULL,  /**< Events without node */
+    AUSHAPE_ARROW_COUNT_LINE,       /**< Text lines */
+    AUSHAPE_ARROW_COUNT_RECORD,     /**< Records */
+    AUSHAPE_ARROW_COUNT_FIELD,      /**< Fields */
+    AUSHAPE_ARROW_COUNT_RAW_NULL,   /**< Fields without raw value */
+    AUSHAPE_ARROW_COUNT_NUM         /**< Number of counters (not a counter) */
+};
+
+/** A string dictionary, with a hash index */
+struct aushape_arrow_dict {
+    /** Value offsets, one more than values */
+    struct aushape_gbuf         offs;
+    /** Value characters */
+    struct aushape_gbuf         data;
+    /** Hash table slots with value index plus one, zero if empty */
+    uint32_t                   *slot_list;
+    /** Number of hash table slots, zero or a power of two */
+    size_t                      slot_num;
+    /** Number of values */
+    size_t                      len;
+    /** Number of values already output */
+    size_t                      sent;
+    /** Memory allocator for the slots, NULL for the C library one */
+    const struct aushape_mem   *mem;
+};
+
+/** Record batch builder */
+struct aushape_arrow {
+    /** True if source text lines should be included */
+    bool                        with_text;
+    /** True if the schema was output */
+    bool                        schema_done;
+    /** Number of record batches output */
+    size_t                      batch_num;
+    /** Column buffers */
+    struct aushape_gbuf         buf_list[AUSHAPE_ARROW_BUF_NUM];
+    /** Column item counters */
+    size_t                      count_list[AUSHAPE_ARROW_COUNT_NUM];
+    /** Record type name dictionary */
+    struct aushape_arrow_dict   types;
+    /** Field name dictionary */
+    struct aushape_arrow_dict   names;
+    /** Scratch buffer for dictionary delta offsets */
+    struct aushape_gbuf         scratch;
+};
+
+/**
+ * Check if a record batch builder is valid.
+ *
+ * @param arrow The builder to check.
+ *
+ * @return True if the builder is valid, false otherwise.
+ */
+extern bool aushape_arrow_is_valid(const struct aushape_arrow *arrow);
+
+/**
+ * Initialize a record batch builder.
+ *
+ * @param arrow     The builder to initialize.
+ * @param with_text True if source text lines should be included.
+ * @param mem       Memory allocator to use, NULL for the C library one.
+ */
+extern void aushape_arrow_init(struct aushape_arrow *arrow, bool with_text,
+                               const struct aushape_mem *mem);
+
+/**
+ * Cleanup a record batch builder (free allocated data).
+ *
+ * @param arrow The builder to cleanup.
+ */
+extern void aushape_arrow_cleanup(struct aushape_arrow *arrow);
+
+/**
+ * Shrink the buffers of a record batch builder back toward their initial
+ * sizes, keeping the contents.
+ *
+ * @param arrow The builder to shrink.
+ */
+extern void aushape_arrow_shrink(struct aushape_arrow *arrow);
+
+/**
+ * Add current and peak memory usage of a record batch builder to a
+ * statistics structure.
+ *
+ * @param arrow The builder to add memory usage of.
+ * @param usage The statistics to add the memory usage to.
+ */
+extern void aushape_arrow_get_mem_usage(const struct aushape_arrow *arrow,
+                                        struct aushape_mem_usage *usage);
+
+/**
+ * Add an event, in its intermediate representation, as a row to the record
+ * batch being built. Events with no records besides EOE are dropped.
+ *
+ * @param arrow     The builder to add the event to.
+ * @param padded    Location for the flag signifying that the event was added.
+ *                  Set to true if the event was added. Not modified, if it
+ *                  was dropped or an error occurred.
+ * @param ir        The intermediate representation of the event to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - added successfully,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed,
+ *          other                       - the failure of parsing the
+ *                                        event's records.
+ */
+extern enum aushape_rc aushape_arrow_add_event(
+                                    struct aushape_arrow *arrow,
+                                    bool *padded,
+                                    const struct aushape_conv_ir *ir);
+
+/**
+ * Output the stream schema message to a growing buffer, if not output yet.
+ *
+ * @param arrow The builder to output the schema of.
+ * @param gbuf  The growing buffer to output to.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - output successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_arrow_write_schema(struct aushape_arrow *arrow,
+                                                  struct aushape_gbuf *gbuf);
+
+/**
+ * Output the record batch being built to a growing buffer, preceded by the
+ * schema, if not output yet, and by dictionary batches with new dictionary
+ * entries, if any. Start building a new record batch.
+ *
+ * @param arrow The builder to output the record batch of.
+ * @param gbuf  The growing buffer to output to.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - output successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_arrow_write_batch(struct aushape_arrow *arrow,
+                                                 struct aushape_gbuf *gbuf);
+
+#endif /* _AUSHAPE_ARROW_H */
@@ -0,0 +1,158 @@
+/**
+ * @file
+ * @brief Asynchronous aushape output.
+ *
+ * An implementation of an output passing output to another output on a
+ * dedicated writer thread, through a bounded queue, so a slow inner output
+ * doesn't stall the conversion.
+ *
+ * Output is queued in items, each ended at a document boundary, i.e. where
+ * the converter synchronizes the output, or, with continuous inner outputs,
+ * once it accumulates AUSHAPE_ASYNC_OUTPUT_ITEM_SIZE bytes in the middle of
+ * a document. Event notifications are queued with the output they belong
+ * to. When the queue is full, the output either blocks until the writer
+ * catches up, drops the new, or the oldest queued item, or spills items to
+ * an unlinked temporary file, to pass them on in order once the queue
+ * drains. Items are dropped whole, so dropping only keeps documents intact
+ * if they're not bigger than the item size.
+ *
+ * Full synchronization waits for the writer to write out everything queued,
+ * and fully synchronizes the inner output.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_ASYNC_OUTPUT_H
+#define _AUSHAPE_ASYNC_OUTPUT_H
+
+#include <aushape/output.h>
+#include <stdint.h>
+
+/**
+ * Amount of output accumulated in a queue item, at which it is queued
+ * without waiting for a document boundary, bytes.
+ */
+#define AUSHAPE_ASYNC_OUTPUT_ITEM_SIZE  (64 * 1024)
+
+/** Full queue policy */
+enum aushape_async_output_policy {
+    AUSHAPE_ASYNC_OUTPUT_POLICY_INVALID,
+    /** Wait for the writer to take an item */
+    AUSHAPE_ASYNC_OUTPUT_POLICY_BLOCK,
+    /** Drop the new item */
+    AUSHAPE_ASYNC_OUTPUT_POLICY_DROP_NEWEST,
+    /** Drop the oldest queued item */
+    AUSHAPE_ASYNC_OUTPUT_POLICY_DROP_OLDEST,
+    /** Spill items to a temporary file until the queue drains */
+    AUSHAPE_ASYNC_OUTPUT_POLICY_SPILL,
+    AUSHAPE_ASYNC_OUTPUT_POLICY_NUM
+};
+
+/**
+ * Check if a full queue policy is valid.
+ *
+ * @param policy    The policy to check.
+ *
+ * @return True if the policy is valid, false otherwise.
+ */
+static inline bool
+aushape_async_output_policy_is_valid(enum aushape_async_output_policy policy)
+{
+    return policy > AUSHAPE_ASYNC_OUTPUT_POLICY_INVALID &&
+           policy < AUSHAPE_ASYNC_OUTPUT_POLICY_NUM;
+}
+
+/** Asynchronous output statistics */
+struct aushape_async_output_stats {
+    /** Number of items in the queue */
+    size_t      depth;
+    /** Maximum number of items the queue had */
+    size_t      max_depth;
+    /** Number of items spilled to the temporary file, but not written */
+    size_t      spill_depth;
+    /** Number of times the queue was full */
+    uint64_t    full;
+    /** Number of times the output waited for the writer to take an item */
+    uint64_t    stalls;
+    /** Number of items dropped */
+    uint64_t    dropped;
+    /** Number of items spilled to the temporary file */
+    uint64_t    spilled;
+    /** Number of items written to the inner output */
+    uint64_t    written;
+};
+
+/** Asynchronous output type, for continuous inner outputs */
+extern const struct aushape_output_type aushape_async_output_type;
+
+/** Asynchronous output type, for discrete inner outputs */
+extern const struct aushape_output_type aushape_async_disc_output_type;
+
+/**
+ * Create an instance of asynchronous output. The output is continuous if
+ * the inner output is, and discrete otherwise.
+ *
+ * @param poutput       Location for the created output pointer, will be set
+ *                      to NULL in case of error.
+ * @param inner         The output to write output to on the writer thread.
+ * @param inner_owned   True if the inner output should be destroyed upon
+ *                      destruction of the output, false otherwise.
+ * @param queue_size    Maximum number of items in the queue, positive.
+ * @param policy        Full queue policy.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - temporary file or thread
+ *                                            creation failed.
+ */
+static inline enum aushape_rc
+aushape_async_output_create(struct aushape_output **poutput,
+                            struct aushape_output *inner,
+                            bool inner_owned,
+                            size_t queue_size,
+                            enum aushape_async_output_policy policy)
+{
+    if (!aushape_output_is_valid(inner) ||
+        queue_size == 0 ||
+        !aushape_async_output_policy_is_valid(policy)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput,
+                                 aushape_output_is_cont(inner)
+                                    ? &aushape_async_output_type
+                                    : &aushape_async_disc_output_type,
+                                 inner, inner_owned, queue_size, policy);
+}
+
+/**
+ * Retrieve statistics of an asynchronous output.
+ *
+ * @param output    The asynchronous output to retrieve statistics of.
+ * @param pstats    Location for the statistics.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - invalid arguments supplied.
+ */
+extern enum aushape_rc aushape_async_output_get_stats(
+                            const struct aushape_output *output,
+                            struct aushape_async_output_stats *pstats);
+
+#endif /* _AUSHAPE_ASYNC_OUTPUT_H */
@@ -2,15 +2,17 @@
  * @brief Abstract record collector interface
  *
  * A collector is used for accumulating record sequences before they can be
- * output as part of an event.
+ * output as part of an event. Collectors don't depend on the output
+ * language: they arrange records into an intermediate tree, which each
+ * output then renders in its own language.
  *
- * Upon creation a collector is supplied with the output format, the growing
- * buffer tree to output to and type-specific arguments.
+ * Upon creation a collector is supplied with the intermediate tree to add
+ * collected nodes to, and type-specific arguments.
  *
- * After creating, records can be added to the collector with aushape_coll_add
- * repeatedly and the sequence needs to be ended with aushape_coll_end. Either
- * of these may add complete objects/elements to the output (although only one
- * does normally).
+ * After creating, record nodes can be added to the collector with
+ * aushape_coll_add repeatedly and the sequence needs to be ended with
+ * aushape_coll_end. Either of these may add complete nodes to the tree
+ * (although only one does normally).
  *
  * At any point a collector can be emptied with aushape_coll_empty to begin a
  * new record sequence. However no new records can be added with
@@ -63,16 +65,14 @@
 #define _AUSHAPE_COLL_H
 
 #include <aushape/coll_type.h>
-#include <aushape/gbtree.h>
+#include <aushape/itree.h>
 
 /** Abstract record collector instance */
 struct aushape_coll {
     /** Collector type */
     const struct aushape_coll_type *type;
-    /** The output format to use */
-    struct aushape_format           format;
-    /** The growing buffer tree to add collected output records to */
-    struct aushape_gbtree          *gbtree;
+    /** The intermediate tree to add collected nodes to */
+    struct aushape_itree           *itree;
     /** True if the record sequence was ended, false otherwise */
     bool                            ended;
 };
@@ -82,10 +82,11 @@ struct aushape_coll {
  *
  * @param pcoll     Location for the created collector pointer, cannot be NULL.
  * @param type      The type of the collector to create.
- * @param format    The output format to use.
- * @param gbtree    The growing buffer tree to add collected output records
- *                  to. Never emptied by the collector. Must stay valid for
- *                  the existence of the collector.
+ * @param itree     The intermediate tree to add collected nodes to.
+ *                  Never emptied by the collector. Must stay valid for the
+ *                  existence of the collector. Its pool is used for the
+ *                  strings and fields of the added nodes, and its memory
+ *                  allocator for the collector.
  * @param args      Initialization arguments, type-specific. See description
  *                  of the corresponding type for the expected values.
  *
@@ -100,8 +101,7 @@ struct aushape_coll {
 extern enum aushape_rc aushape_coll_create(
                                 struct aushape_coll **pcoll,
                                 const struct aushape_coll_type *type,
-                                const struct aushape_format *format,
-                                struct aushape_gbtree *gbtree,
+                                struct aushape_itree *itree,
                                 const void *args);
 
 /**
@@ -138,6 +138,24 @@ extern bool aushape_coll_is_empty(const struct aushape_coll *coll);
  */
 extern void aushape_coll_empty(struct aushape_coll *coll);
 
+/**
+ * Shrink the memory of a collector's buffers down to the smallest sizes
+ * fitting their current contents.
+ *
+ * @param coll      The collector to shrink.
+ */
+extern void aushape_coll_shrink(struct aushape_coll *coll);
+
+/**
+ * Add the memory usage of a collector, including the instance itself, to an
+ * accumulated usage.
+ *
+ * @param coll      The collector to get memory usage of.
+ * @param usage     The accumulated memory usage to add to.
+ */
+extern void aushape_coll_get_mem_usage(const struct aushape_coll *coll,
+                                       struct aushape_mem_usage *usage);
+
 /**
  * Check if a collector record sequence was ended.
  *
@@ -148,17 +166,16 @@ extern void aushape_coll_empty(struct aushape_coll *coll);
 extern bool aushape_coll_is_ended(const struct aushape_coll *coll);
 
 /**
- * Add a record to the collector record sequence. Can output a complete
- * record. Cannot be called after the sequence collection was ended, without
- * emptying the collector first.
+ * Add a record to the collector record sequence. Can add a complete node to
+ * the tree. Cannot be called after the sequence collection was ended,
+ * without emptying the collector first.
  *
  * @param coll      The collector to add the record to.
- * @param pcount    Location of/for the record counter in the container.
- *                  Incremented for every record added by the function.
- * @param level     Syntactic nesting level to output at.
- * @param prio      Growing buffer tree priority to add the record with.
- * @param au        The auparse state with the current record as the record to
- *                  be added.
+ * @param pcount    Location of/for the node counter in the container.
+ *                  Incremented for every node added by the function.
+ * @param prio      Priority to add the node with.
+ * @param record    The record node to be added, referring to the pool of
+ *                  the collector's tree.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - added successfully,
@@ -166,27 +183,26 @@ extern bool aushape_coll_is_ended(const struct aushape_coll *coll);
  *          AUSHAPE_RC_INVALID_STATE    - called after ending record
  *                                        sequence, without emptying,
  *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed,
  *          other                       - collector-specific errors,
  *                                        see corresponding collector type
  *                                        documentation.
  */
-extern enum aushape_rc aushape_coll_add(struct aushape_coll *coll,
-                                        size_t *pcount,
-                                        size_t level,
-                                        size_t prio,
-                                        auparse_state_t *au);
+extern enum aushape_rc aushape_coll_add(
+                                struct aushape_coll *coll,
+                                size_t *pcount,
+                                size_t prio,
+                                const struct aushape_itree_node *record);
 
 /**
- * End collection of a collector's record sequence. Can output a complete
- * record. Has no effect if no record sequence has been accumulated by the
- * collector. Cannot be called repeatedly, without emptying the collector.
+ * End collection of a collector's record sequence. Can add a complete node
+ * to the tree. Has no effect if no record sequence has been accumulated by
+ * the collector. Cannot be called repeatedly, without emptying the
+ * collector.
  *
  * @param coll      The collector to end the sequence for.
- * @param pcount    Location of/for the record counter in the container.
- *                  Incremented for every record added by the function.
- * @param level     Syntactic nesting level to output at.
- * @param prio      Growing buffer tree priority to add the record with.
+ * @param pcount    Location of/for the node counter in the container.
+ *                  Incremented for every node added by the function.
+ * @param prio      Priority to add the node with.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - added successfully,
@@ -200,7 +216,6 @@ extern enum aushape_rc aushape_coll_add(struct aushape_coll *coll,
  */
 extern enum aushape_rc aushape_coll_end(struct aushape_coll *coll,
                                         size_t *pcount,
-                                        size_t level,
                                         size_t prio);
 
 #endif /* _AUSHAPE_COLL_H */
@@ -21,8 +21,9 @@
 #ifndef _AUSHAPE_COLL_TYPE_H
 #define _AUSHAPE_COLL_TYPE_H
 
+#include <aushape/itree.h>
+#include <aushape/mem.h>
 #include <aushape/rc.h>
-#include <auparse.h>
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -90,21 +91,19 @@ typedef void (*aushape_coll_type_empty_fn)(
 /**
  * Prototype for a function adding a record to the collector record sequence.
  * Cannot be called after the collection was ended, but the collector was not
- * emptied. Does not have to make the collector non-empty. Can output a
- * complete record.
+ * emptied. Does not have to make the collector non-empty. Can add a
+ * complete node to the tree.
  *
  * @param coll      The collector to add the record to.
- * @param pcount    Location of/for the record counter in the container.
- *                  Incremented for every record added by the function.
- * @param level     Syntactic nesting level to output at.
- * @param prio      Growing buffer tree priority to add the record with.
- * @param au        The auparse state with the current record as the record to
- *                  be added.
+ * @param pcount    Location of/for the node counter in the container.
+ *                  Incremented for every node added by the function.
+ * @param prio      Priority to add the node with.
+ * @param record    The record node to be added, referring to the pool of
+ *                  the collector's tree.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - added successfully,
  *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed,
  *          other                       - collector-specific return code,
  *                                        see corresponding collector type
  *                                        documentation.
@@ -112,20 +111,18 @@ typedef void (*aushape_coll_type_empty_fn)(
 typedef enum aushape_rc (*aushape_coll_type_add_fn)(
                                 struct aushape_coll *coll,
                                 size_t *pcount,
-                                size_t level,
                                 size_t prio,
-                                auparse_state_t *au);
+                                const struct aushape_itree_node *record);
 
 /**
  * Prototype for a function ending collection of the record sequence for a
  * collector. Cannot be called if the collector is empty or already ended.
- * Can output a complete record.
+ * Can add a complete node to the tree.
  *
  * @param coll      The collector to end the sequence for.
- * @param pcount    Location of/for the record counter in the container.
- *                  Incremented for every record added by the function.
- * @param level     Syntactic nesting level to output at.
- * @param prio      Growing buffer tree priority to add the record with.
+ * @param pcount    Location of/for the node counter in the container.
+ *                  Incremented for every node added by the function.
+ * @param prio      Priority to add the node with.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - added successfully,
@@ -137,9 +134,28 @@ typedef enum aushape_rc (*aushape_coll_type_add_fn)(
 typedef enum aushape_rc (*aushape_coll_type_end_fn)(
                                 struct aushape_coll *coll,
                                 size_t *pcount,
-                                size_t level,
                                 size_t prio);
 
+/**
+ * Prototype for a function shrinking the memory of a collector's buffers down
+ * to the smallest sizes fitting their current contents.
+ *
+ * @param coll      The collector to shrink.
+ */
+typedef void (*aushape_coll_type_shrink_fn)(
+                                struct aushape_coll *coll);
+
+/**
+ * Prototype for a function adding the memory usage of a collector's buffers
+ * to an accumulated usage. The instance itself is accounted by the caller.
+ *
+ * @param coll      The collector to get memory usage of.
+ * @param usage     The accumulated memory usage to add to.
+ */
+typedef void (*aushape_coll_type_get_mem_usage_fn)(
+                                const struct aushape_coll *coll,
+                                struct aushape_mem_usage *usage);
+
 /** Record collector type */
 struct aushape_coll_type {
     /** Instance size */
@@ -158,6 +174,10 @@ struct aushape_coll_type {
     aushape_coll_type_add_fn        add;
     /** Record sequence-ending function */
     aushape_coll_type_end_fn        end;
+    /** Buffer-shrinking function */
+    aushape_coll_type_shrink_fn     shrink;
+    /** Memory usage-reporting function */
+    aushape_coll_type_get_mem_usage_fn  get_mem_usage;
 };
 
 /**
@@ -0,0 +1,72 @@
+/**
+ * @brief Aushape output compression algorithm.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_COMP_H
+#define _AUSHAPE_COMP_H
+
+#include <stdbool.h>
+#include <limits.h>
+
+/** Compression level requesting the algorithm's default */
+#define AUSHAPE_COMP_LEVEL_DEFAULT  INT_MIN
+
+/** Compression algorithm */
+enum aushape_comp {
+    AUSHAPE_COMP_INVALID,   /** Invalid, uninitialized algorithm */
+    AUSHAPE_COMP_GZIP,      /** gzip (RFC 1952) */
+    AUSHAPE_COMP_ZSTD,      /** Zstandard (RFC 8478) */
+    AUSHAPE_COMP_NUM        /** Number of algorithms (not an algorithm) */
+};
+
+/**
+ * Check if a compression algorithm is valid.
+ *
+ * @param comp  The algorithm to check.
+ *
+ * @return True if the algorithm is valid, false otherwise.
+ */
+static inline bool
+aushape_comp_is_valid(enum aushape_comp comp)
+{
+    return comp > AUSHAPE_COMP_INVALID &&
+           comp < AUSHAPE_COMP_NUM;
+}
+
+/**
+ * Check if a compression algorithm is supported by the library build.
+ *
+ * @param comp  The algorithm to check. Must be valid.
+ *
+ * @return True if the algorithm is supported, false otherwise.
+ */
+extern bool aushape_comp_is_available(enum aushape_comp comp);
+
+/**
+ * Check if a compression level is supported by an algorithm.
+ *
+ * @param comp  The algorithm to check the level for. Must be valid.
+ * @param level The level to check, or AUSHAPE_COMP_LEVEL_DEFAULT.
+ *
+ * @return True if the level is supported, false otherwise.
+ */
+extern bool aushape_comp_level_is_valid(enum aushape_comp comp, int level);
+
+#endif /* _AUSHAPE_COMP_H */
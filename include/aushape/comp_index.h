@@ -0,0 +1,168 @@
+/**
+ * @brief Compressed output frame index
+ *
+ * The frame index lists frames (gzip members or zstd frames) of compressed
+ * output, along with the serial numbers and times of events they contain,
+ * letting readers decompress only the frames they need. It is text, starting
+ * with AUSHAPE_COMP_INDEX_MAGIC, followed by a line per frame, listing
+ * decimal, space-separated:
+ *
+ *      offset size length events first_serial last_serial earliest latest
+ *
+ * where "offset" and "size" are the compressed offset and size of the frame,
+ * "length" is its uncompressed size, "events" is the number of events in the
+ * frame, "first_serial" and "last_serial" are the serial numbers of the
+ * first and the last of them, and "earliest" and "latest" are their earliest
+ * and latest times, in seconds since epoch, with three fractional digits.
+ * The last four are zero if the frame has no events.
+ *
+ * The index is appended to the compressed output as a trailer, which
+ * regular decompressors ignore:
+ *
+ * With gzip, the trailer is an empty member with the index as its comment,
+ * followed by an empty locator member of AUSHAPE_COMP_INDEX_GZIP_LOC_SIZE
+ * bytes, with an extra field subfield with ID AUSHAPE_COMP_INDEX_GZIP_SI1
+ * and AUSHAPE_COMP_INDEX_GZIP_SI2, containing the 64-bit little-endian
+ * offset of the index member.
+ *
+ * With zstd, the trailer is a skippable frame with magic number
+ * AUSHAPE_COMP_INDEX_ZSTD_MAGIC containing the index, followed by a seek
+ * table in the zstd seekable format, listing all the frames, including the
+ * index frame, so that the output can be read with seekable format readers
+ * as well.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_COMP_INDEX_H
+#define _AUSHAPE_COMP_INDEX_H
+
+#include <aushape/comp.h>
+#include <aushape/gbuf.h>
+#include <aushape/rc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/** The first line of the index */
+#define AUSHAPE_COMP_INDEX_MAGIC                "aushape-index 1\n"
+
+/** First ID byte of the gzip locator member extra subfield */
+#define AUSHAPE_COMP_INDEX_GZIP_SI1             'A'
+/** Second ID byte of the gzip locator member extra subfield */
+#define AUSHAPE_COMP_INDEX_GZIP_SI2             'X'
+/** Size of the gzip locator member */
+#define AUSHAPE_COMP_INDEX_GZIP_LOC_SIZE        34
+
+/** Magic number of the zstd skippable frame containing the index */
+#define AUSHAPE_COMP_INDEX_ZSTD_MAGIC           0x184D2A5AU
+/** Magic number of the zstd skippable frame containing the seek table */
+#define AUSHAPE_COMP_INDEX_ZSTD_SEEK_MAGIC      0x184D2A5EU
+/** Magic number ending the zstd seek table */
+#define AUSHAPE_COMP_INDEX_ZSTD_SEEK_END_MAGIC  0x8F92EAB1U
+/** Size of the zstd seek table footer */
+#define AUSHAPE_COMP_INDEX_ZSTD_SEEK_FOOTER_SIZE    9
+
+/** Frame index entry */
+struct aushape_comp_index_frame {
+    /** Compressed offset */
+    uint64_t            offset;
+    /** Compressed size */
+    uint64_t            size;
+    /** Uncompressed size */
+    uint64_t            len;
+    /** Number of events */
+    uint64_t            events;
+    /** Serial number of the first event */
+    unsigned long       first_serial;
+    /** Serial number of the last event */
+    unsigned long       last_serial;
+    /** Earliest event time, milliseconds since epoch */
+    long long           earliest;
+    /** Latest event time, milliseconds since epoch */
+    long long           latest;
+};
+
+/**
+ * Add a frame entry to an index.
+ *
+ * @param index     The growing buffer with the index to add the entry to,
+ *                  empty to add the index header first.
+ * @param frame     The frame entry to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_comp_index_add_frame(
+                                struct aushape_gbuf *index,
+                                const struct aushape_comp_index_frame *frame);
+
+/**
+ * Parse a frame entry line of an index.
+ *
+ * @param line      The line to parse, without the newline, zero-terminated.
+ * @param frame     Location for the parsed frame entry.
+ *
+ * @return True if parsed successfully, false if the line is invalid.
+ */
+extern bool aushape_comp_index_parse_frame(
+                                const char *line,
+                                struct aushape_comp_index_frame *frame);
+
+/**
+ * Format an index trailer.
+ *
+ * @param trailer   The growing buffer to add the trailer to.
+ * @param comp      The compression algorithm of the output.
+ * @param index     The index to put into the trailer, with at least the
+ *                  header.
+ * @param seek      The zstd seek table entries for the frames preceding the
+ *                  trailer (ignored for other algorithms).
+ * @param offset    Offset of the trailer in the compressed output.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - formatted successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - the index or the frames are too big
+ *                                    to format,
+ *          AUSHAPE_RC_NOMEM        - memory allocation failed.
+ */
+extern enum aushape_rc aushape_comp_index_add_trailer(
+                                struct aushape_gbuf *trailer,
+                                enum aushape_comp comp,
+                                const struct aushape_gbuf *index,
+                                const struct aushape_gbuf *seek,
+                                uint64_t offset);
+
+/**
+ * Add a zstd seek table entry for a frame.
+ *
+ * @param seek  The growing buffer with the seek table entries to add to.
+ * @param size  Compressed size of the frame.
+ * @param len   Uncompressed size of the frame.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - added successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - the frame is too big for the table,
+ *          AUSHAPE_RC_NOMEM        - memory allocation failed.
+ */
+extern enum aushape_rc aushape_comp_index_add_seek(struct aushape_gbuf *seek,
+                                                   uint64_t size,
+                                                   uint64_t len);
+
+#endif /* _AUSHAPE_COMP_INDEX_H */
@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Compressing aushape output.
+ *
+ * An implementation of an output compressing output fragments and writing
+ * the result to another, continuous output, e.g. a file descriptor output.
+ *
+ * The compressed stream is split into independent frames (gzip members, or
+ * zstd frames), which are only ended at document boundaries, i.e. where the
+ * converter synchronizes the output, so each frame decompresses into
+ * complete documents, or events, if these are not put into documents. A
+ * frame is ended at the first boundary after it accumulates the specified
+ * amount of uncompressed output, and when the output is fully synchronized.
+ * The frames together form a regular multi-member gzip, or multi-frame zstd
+ * stream.
+ *
+ * Optionally, the output can record the offsets, sizes, and the serial
+ * numbers and times of the events contained in each frame, and append the
+ * resulting index to the compressed stream upon destruction, in a trailer
+ * ignored by regular decompressors. See comp_index.h for the format.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_COMP_OUTPUT_H
+#define _AUSHAPE_COMP_OUTPUT_H
+
+#include <aushape/output.h>
+#include <aushape/comp.h>
+
+/** Compressing output type */
+extern const struct aushape_output_type aushape_comp_output_type;
+
+/**
+ * Create an instance of compressing output.
+ *
+ * @param poutput       Location for the created output pointer, will be set
+ *                      to NULL in case of error.
+ * @param inner         The continuous output to write compressed output to.
+ * @param inner_owned   True if the inner output should be destroyed upon
+ *                      destruction of the output, false otherwise.
+ * @param comp          Compression algorithm, must be available.
+ * @param level         Compression level, or AUSHAPE_COMP_LEVEL_DEFAULT.
+ * @param frame_size    Minimum amount of uncompressed output in a frame,
+ *                      bytes. Zero to end a frame at every document
+ *                      boundary.
+ * @param indexed       True if the frame index should be appended to the
+ *                      output upon destruction, false otherwise.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - compressor initialization
+ *                                            failed.
+ */
+static inline enum aushape_rc
+aushape_comp_output_create(struct aushape_output **poutput,
+                           struct aushape_output *inner,
+                           bool inner_owned,
+                           enum aushape_comp comp,
+                           int level,
+                           size_t frame_size,
+                           bool indexed)
+{
+    if (!aushape_output_is_valid(inner) ||
+        !aushape_output_is_cont(inner) ||
+        !aushape_comp_is_valid(comp) ||
+        !aushape_comp_is_available(comp) ||
+        !aushape_comp_level_is_valid(comp, level)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_comp_output_type,
+                                 inner, inner_owned, comp, level, frame_size,
+                                 indexed);
+}
+
+#endif /* _AUSHAPE_COMP_OUTPUT_H */
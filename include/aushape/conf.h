@@ -22,6 +22,11 @@
 #define _AUSHAPE_CONF_H
 
 #include <aushape/format.h>
+#include <aushape/async_output.h>
+#include <aushape/spool_output.h>
+#include <aushape/sock_output.h>
+#include <aushape/devlog_output.h>
+#include <aushape/comp.h>
 #include <stdbool.h>
 
 /** Command-line usage help message */
@@ -32,6 +37,11 @@ enum aushape_conf_output_type {
     AUSHAPE_CONF_OUTPUT_TYPE_INVALID,
     AUSHAPE_CONF_OUTPUT_TYPE_FD,
     AUSHAPE_CONF_OUTPUT_TYPE_SYSLOG,
+    AUSHAPE_CONF_OUTPUT_TYPE_SOCK,
+    AUSHAPE_CONF_OUTPUT_TYPE_JOURNAL,
+    AUSHAPE_CONF_OUTPUT_TYPE_HTTP,
+    AUSHAPE_CONF_OUTPUT_TYPE_SQLITE,
+    AUSHAPE_CONF_OUTPUT_TYPE_SHM,
     AUSHAPE_CONF_OUTPUT_TYPE_NUM,
 };
 
@@ -45,7 +55,21 @@ aushape_conf_output_type_is_valid(enum aushape_conf_output_type type)
 /** FD output configuration */
 struct aushape_conf_fd_output {
     /** Output file name, or "-" */
-    const char *path;
+    const char     *path;
+    /** Size of the buffer to accumulate output in, zero for none */
+    size_t          buf_size;
+    /** Maximum time to keep output buffered, milliseconds, zero for any */
+    unsigned int    max_latency;
+    /** Maximum time to keep output not synced, milliseconds, zero for any */
+    unsigned int    sync_interval;
+    /** Maximum amount of output to keep not synced, zero for any */
+    size_t          sync_size;
+    /** Size to rotate the output file at, zero to not rotate by size */
+    size_t          rotate_size;
+    /** Age to rotate the output file at, seconds, zero to not rotate */
+    unsigned int    rotate_time;
+    /** Space to preallocate for the output file, zero for none */
+    size_t          prealloc;
 };
 
 /** Syslog output configuration */
@@ -54,16 +78,129 @@ struct aushape_conf_syslog_output {
     int facility;
     /** Syslog priority */
     int priority;
+    /** Path to the local syslog socket */
+    const char                         *path;
+    /** Message header format */
+    enum aushape_devlog_output_format   format;
+    /** Number of messages to send at once */
+    size_t                              batch_size;
+    /** Maximum size of queued messages, bytes */
+    size_t                              queue_size;
+    /** Maximum time to keep messages queued, milliseconds, zero for any */
+    unsigned int                        max_latency;
 };
 
-/** Configuration */
-struct aushape_conf {
-    /** True if -h/--help option was specified */
-    bool                                help;
-    /** True if -v/--version option was specified */
-    bool                                version;
-    /** Input file name, or "-" */
-    const char                         *input;
+/** Journal output configuration, facility and priority are syslog's */
+struct aushape_conf_journal_output {
+    /** Path to the journald socket */
+    const char     *path;
+    /** Number of entries to send at once */
+    size_t          batch_size;
+    /** Maximum time to keep entries queued, milliseconds, zero for any */
+    unsigned int    max_latency;
+};
+
+/** Socket output configuration */
+struct aushape_conf_sock_output {
+    /** Socket protocol, or AUSHAPE_SOCK_OUTPUT_PROTO_INVALID if not set */
+    enum aushape_sock_output_proto  proto;
+    /** Socket address, or NULL if not set */
+    const char                     *addr;
+    /** True if documents should be prefixed with their length */
+    bool                            framed;
+    /** Size of the buffer to accumulate a batch in, bytes */
+    size_t                          buf_size;
+    /** Maximum time to keep output buffered, milliseconds, zero for any */
+    unsigned int                    max_latency;
+    /** Delay before the first reconnection attempt, milliseconds */
+    unsigned int                    retry_min;
+    /** Maximum delay between reconnection attempts, milliseconds */
+    unsigned int                    retry_max;
+    /** Time to fail after, if output couldn't be sent, ms, zero for never */
+    unsigned int                    timeout;
+};
+
+/** HTTP bulk output configuration */
+struct aushape_conf_http_output {
+    /** Base URL of the server, or NULL if not set */
+    const char     *url;
+    /** Name of the index to put events into */
+    const char     *index;
+    /** True if request bodies should be compressed with gzip */
+    bool            gzip;
+    /** Size of the request body to send a batch at, bytes */
+    size_t          batch_size;
+    /** Maximum time to keep events in a batch, milliseconds, zero for any */
+    unsigned int    max_latency;
+    /** Delay before the first retry, milliseconds */
+    unsigned int    retry_min;
+    /** Maximum delay between retries, milliseconds */
+    unsigned int    retry_max;
+    /** Time to fail after, if a batch couldn't be sent, ms, zero for never */
+    unsigned int    timeout;
+};
+
+/** SQLite output configuration */
+struct aushape_conf_sqlite_output {
+    /** Database file path, or NULL if not set */
+    const char     *path;
+    /** Number of events to insert in a transaction */
+    size_t          batch_size;
+    /** Maximum time to keep a transaction open, ms, zero for any */
+    unsigned int    max_latency;
+};
+
+/** Shared-memory output configuration */
+struct aushape_conf_shm_output {
+    /** Consumer socket path, or NULL if not set */
+    const char     *path;
+    /** Size of the ring data area, bytes */
+    size_t          size;
+    /** True if the output should wait for space in a full ring */
+    bool            block;
+};
+
+/** Output compression configuration */
+struct aushape_conf_comp {
+    /** Compression algorithm, or AUSHAPE_COMP_INVALID for no compression */
+    enum aushape_comp   comp;
+    /** Compression level, or AUSHAPE_COMP_LEVEL_DEFAULT */
+    int                 level;
+    /** Minimum amount of uncompressed output in a frame, bytes */
+    size_t              frame_size;
+    /** Number of worker threads to compress with, zero for none */
+    size_t              threads;
+    /** True if the frame index should be appended to the output */
+    bool                indexed;
+};
+
+/** Asynchronous output configuration */
+struct aushape_conf_async {
+    /** Maximum number of items in the queue, zero to write synchronously */
+    size_t                              queue_size;
+    /** Full queue policy */
+    enum aushape_async_output_policy    policy;
+};
+
+/** Spooling output configuration */
+struct aushape_conf_spool {
+    /** Spool directory path, or NULL to write without spooling */
+    const char                         *dir;
+    /** Maximum size of the spool segment files, bytes */
+    size_t                              max_size;
+    /** Size of the spool segment file to start a new one at, bytes */
+    size_t                              segment_size;
+    /** Delay before retrying a failed write, milliseconds */
+    unsigned int                        retry;
+    /** Full spool policy */
+    enum aushape_spool_output_policy    policy;
+};
+
+/** Maximum number of outputs */
+#define AUSHAPE_CONF_OUTPUT_MAX 8
+
+/** Output configuration */
+struct aushape_conf_output {
     /** Output format */
     struct aushape_format               format;
     /** Output type */
@@ -73,7 +210,39 @@ struct aushape_conf {
         struct aushape_conf_fd_output       fd;
         /* Syslog output configuration */
         struct aushape_conf_syslog_output   syslog;
+        /* Socket output configuration */
+        struct aushape_conf_sock_output     sock;
+        /* Journal output configuration */
+        struct aushape_conf_journal_output  journal;
+        /* HTTP bulk output configuration */
+        struct aushape_conf_http_output     http;
+        /* SQLite output configuration */
+        struct aushape_conf_sqlite_output   sqlite;
+        /* Shared-memory output configuration */
+        struct aushape_conf_shm_output      shm;
     } output_conf;
+    /** Output compression configuration */
+    struct aushape_conf_comp            comp;
+    /** Asynchronous output configuration */
+    struct aushape_conf_async           async;
+    /** Spooling output configuration */
+    struct aushape_conf_spool           spool;
+};
+
+/** Configuration */
+struct aushape_conf {
+    /** True if -h/--help option was specified */
+    bool                                help;
+    /** True if -v/--version option was specified */
+    bool                                version;
+    /** True if --key-dict option was specified */
+    bool                                key_dict;
+    /** Input file name, or "-" */
+    const char                         *input;
+    /** Outputs to write the converted input to, in order specified */
+    struct aushape_conf_output          output_list[AUSHAPE_CONF_OUTPUT_MAX];
+    /** Number of outputs in output_list, at least one */
+    size_t                              output_num;
 };
 
 /**
@@ -23,6 +23,7 @@
 
 #include <aushape/output.h>
 #include <aushape/format.h>
+#include <aushape/mem.h>
 #include <aushape/rc.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -30,6 +31,36 @@
 /** Converter state */
 struct aushape_conv;
 
+/** Converter memory statistics, per buffer */
+struct aushape_conv_mem_stats {
+    /** Output (document) buffer */
+    struct aushape_mem_usage    output;
+    /** Event buffer tree */
+    struct aushape_mem_usage    event;
+    /** Event source text buffer tree */
+    struct aushape_mem_usage    text;
+    /** Event data buffer tree */
+    struct aushape_mem_usage    data;
+    /** Event normalized data buffer tree */
+    struct aushape_mem_usage    norm;
+    /** Event intermediate trees and record collectors, shared by outputs */
+    struct aushape_mem_usage    colls;
+    /** Columnar record batch builder */
+    struct aushape_mem_usage    batch;
+    /** Record shape cache */
+    struct aushape_mem_usage    shapes;
+    /** Sum of the above */
+    struct aushape_mem_usage    total;
+};
+
+/** Converter record shape cache statistics */
+struct aushape_conv_shape_stats {
+    /** Number of records output using a cached shape */
+    size_t  hits;
+    /** Number of records output without a cached shape */
+    size_t  misses;
+};
+
 /**
  * Check if a converter pointer is valid.
  *
@@ -63,10 +94,128 @@ enum aushape_rc aushape_conv_create(struct aushape_conv **pconv,
                                     struct aushape_output *output,
                                     bool output_owned);
 
+/**
+ * Create (allocate and initialize) a converter, allocating the converter
+ * and all its conversion buffers with the specified memory allocator, e.g.
+ * one returned by aushape_arena_get_mem. The allocator must stay valid until
+ * the converter is destroyed. Otherwise the same as aushape_conv_create.
+ *
+ * @param pconv             Location for the created converter pointer.
+ *                          Not modified in case of error. Cannot be NULL.
+ * @param format            The output format to use.
+ * @param output            The output to write to.
+ * @param output_owned      True if the output should be destroyed when
+ *                          converter is destroyed.
+ * @param mem               The memory allocator to use, NULL for the C
+ *                          library one.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments received,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed.
+ */
+enum aushape_rc aushape_conv_create_mem(struct aushape_conv **pconv,
+                                        const struct aushape_format *format,
+                                        struct aushape_output *output,
+                                        bool output_owned,
+                                        const struct aushape_mem *mem);
+
+/**
+ * Add another output to a converter, to write the same events to, in
+ * another format. The input is parsed once for all the outputs, and the
+ * same events are formatted separately for each of them, with their own
+ * buffers, trimming and documents. Can only be called before
+ * aushape_conv_begin, or after aushape_conv_end.
+ *
+ * Outputs fail independently: once writing to one fails, it is skipped,
+ * while the others keep receiving events. See aushape_conv_get_output_rc.
+ *
+ * @param conv              The converter to add the output to.
+ * @param format            The output format to use.
+ * @param output            The output to write to.
+ * @param output_owned      True if the output should be destroyed when
+ *                          converter is destroyed. The output is not
+ *                          destroyed in case of error.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - added successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments received,
+ *          AUSHAPE_RC_INVALID_STATE        - called inside a document,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed.
+ */
+enum aushape_rc aushape_conv_add_output(struct aushape_conv *conv,
+                                        const struct aushape_format *format,
+                                        struct aushape_output *output,
+                                        bool output_owned);
+
+/**
+ * Retrieve current and peak memory usage of a converter's buffers, summed
+ * over all its outputs. Memory allocated by auparse is not included.
+ *
+ * @param conv      The converter to retrieve memory statistics for.
+ * @param pstats    Location for the retrieved statistics.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments received.
+ */
+enum aushape_rc aushape_conv_get_mem_stats(
+                                const struct aushape_conv *conv,
+                                struct aushape_conv_mem_stats *pstats);
+
+/**
+ * Retrieve the record shape cache statistics of a converter: how many
+ * records had their fields output using the pre-rendered skeleton of a
+ * previously seen field layout, summed over all its outputs.
+ *
+ * @param conv      The converter to retrieve shape cache statistics for.
+ * @param pstats    Location for the retrieved statistics.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments received.
+ */
+enum aushape_rc aushape_conv_get_shape_stats(
+                                const struct aushape_conv *conv,
+                                struct aushape_conv_shape_stats *pstats);
+
+/**
+ * Retrieve the first failure of a converter output, if any. A failed output
+ * is skipped until the converter is destroyed, while the other outputs keep
+ * receiving events.
+ *
+ * @param conv      The converter to retrieve the output failure from.
+ * @param index     Index of the output, in the order added, the one the
+ *                  converter was created with being zero.
+ * @param prc       Location for the output's first failure return code,
+ *                  or AUSHAPE_RC_OK, if it didn't fail.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments received,
+ *                                            including an index past the
+ *                                            last output.
+ */
+enum aushape_rc aushape_conv_get_output_rc(const struct aushape_conv *conv,
+                                           size_t index,
+                                           enum aushape_rc *prc);
+
+/**
+ * Shrink a converter's buffers back toward their initial sizes,
+ * independently of the format's shrinking policy.
+ *
+ * @param conv      The converter to shrink buffers of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - shrunk successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments received.
+ */
+enum aushape_rc aushape_conv_shrink(struct aushape_conv *conv);
+
 /**
  * Begin converter document output. Must be called once before
  * aushape_conv_input, aushape_conv_flush, and aushape_conv_end. Has effect
- * only if converter was created with format->events_per_doc == SSIZE_MAX.
+ * only on outputs with format->events_per_doc == SSIZE_MAX.
  *
  * @param pconv         Converter to start the document output with.
  *
@@ -85,6 +234,9 @@ enum aushape_rc aushape_conv_begin(struct aushape_conv *conv);
 /**
  * Provide a piece of raw audit log input to a converter.
  * Can only be called after aushape_conv_begin and before aushape_conv_end.
+ * With format->ndjson, events converted from the piece are written in
+ * batches, the last one before returning. Output failures are only
+ * reported once all outputs failed, see aushape_conv_get_output_rc.
  *
  * @param conv  The converter to provide input to.
  * @param ptr   The pointer to the log piece. Can be NULL, if len is 0.
@@ -112,7 +264,10 @@ enum aushape_rc aushape_conv_input(struct aushape_conv *conv,
 /**
  * Process any raw log input buffered in a converter. To be called at the end
  * of a log to make sure everything was processed. Can only be called after
- * aushape_conv_begin and before aushape_conv_end.
+ * aushape_conv_begin and before aushape_conv_end. Unless in the middle of a
+ * document, synchronizes the output fully afterwards, see
+ * aushape_output_sync. Reports the first output failure, if any, but
+ * processes the input for the working outputs regardless.
  *
  * @param conv  The converter to flush.
  *
@@ -135,8 +290,10 @@ enum aushape_rc aushape_conv_flush(struct aushape_conv *conv);
 
 /**
  * End converter document output. Can only be called after aushape_conv_begin.
- * Has effect only if converter was created with format->events_per_doc != 0
- * and a document was started.
+ * Outputs the document epilogue only to outputs with
+ * format->events_per_doc != 0 and a document started. Synchronizes the
+ * outputs fully afterwards, see aushape_output_sync. Reports the first
+ * output failure, if any, after finishing the working outputs.
  *
  * @param pconv         Converter to start the document output with.
  *
@@ -153,8 +310,8 @@ enum aushape_rc aushape_conv_flush(struct aushape_conv *conv);
 enum aushape_rc aushape_conv_end(struct aushape_conv *conv);
 
 /**
- * Destroy (cleanup and free) a converter. If converter was created with
- * output_owned true, then the supplied output is destroyed as well.
+ * Destroy (cleanup and free) a converter. Outputs created, or added with
+ * output_owned true, are destroyed as well.
  *
  * @param conv  The converter to destroy. Can be NULL.
  *              Must be valid, if not NULL.
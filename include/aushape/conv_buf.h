@@ -21,19 +21,33 @@
 #ifndef _AUSHAPE_CONV_BUF_H
 #define _AUSHAPE_CONV_BUF_H
 
-#include <aushape/coll.h>
+#include <aushape/arrow.h>
+#include <aushape/conv.h>
+#include <aushape/conv_ir.h>
+#include <aushape/emitter.h>
 #include <aushape/format.h>
+#include <aushape/garr.h>
 #include <aushape/gbtree.h>
 #include <aushape/gbuf.h>
 #include <aushape/rc.h>
-#include <auparse.h>
+#include <aushape/shape_cache.h>
 
 /** Converter's output buffer */
 struct aushape_conv_buf {
     /** The output format to use */
     struct aushape_format   format;
+    /** The formatting functions specialized for the format */
+    const struct aushape_emitter *emitter;
     /** Growing buffer for an output piece */
     struct aushape_gbuf     gbuf;
+    /**
+     * Growing buffer for the events of the current document, held back
+     * until the epilogue, for the MessagePack language, as the document
+     * array head needs the number of events
+     */
+    struct aushape_gbuf     doc;
+    /** Number of events in the document buffer */
+    size_t                  doc_event_num;
     /** Growing buffer tree for an event */
     struct aushape_gbtree   event;
     /** Growing buffer sub-tree for event's text */
@@ -42,10 +56,20 @@ struct aushape_conv_buf {
     struct aushape_gbtree   data;
     /** Growing buffer sub-tree for event's normalized data */
     struct aushape_gbtree   norm;
-    /** Growing buffer sub-tree for normalized data attr lists */
-    struct aushape_gbtree   norm_list;
-    /** Record collector */
-    struct aushape_coll    *coll;
+    /**
+     * Growing buffer sub-trees for event's data lists
+     * (struct aushape_gbtree *), allocated on demand
+     */
+    struct aushape_garr     lists;
+    /** Record batch builder, for the Arrow language */
+    struct aushape_arrow    arrow;
+    /** Record shape cache */
+    struct aushape_shape_cache  shapes;
+    /**
+     * Number of consecutive events smaller than format.shrink_below
+     * since the last shrinking
+     */
+    size_t                  small_events;
 };
 
 /**
@@ -62,6 +86,8 @@ extern bool aushape_conv_buf_is_valid(const struct aushape_conv_buf *buf);
  *
  * @param buf       The buffer to initialize.
  * @param format    The output format to use.
+ * @param mem       The memory allocator to use for all the buffers,
+ *                  NULL for the C library one.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK                   - initialized successfully,
@@ -70,7 +96,36 @@ extern bool aushape_conv_buf_is_valid(const struct aushape_conv_buf *buf);
  */
 extern enum aushape_rc aushape_conv_buf_init(
                                         struct aushape_conv_buf *buf,
-                                        const struct aushape_format *format);
+                                        const struct aushape_format *format,
+                                        const struct aushape_mem *mem);
+
+/**
+ * Shrink all growing buffers of a converter output buffer back toward their
+ * initial sizes.
+ *
+ * @param buf   The buffer to shrink.
+ */
+extern void aushape_conv_buf_shrink(struct aushape_conv_buf *buf);
+
+/**
+ * Retrieve current and peak memory usage of a converter output buffer.
+ *
+ * @param buf       The buffer to retrieve memory statistics for.
+ * @param stats     Location for the retrieved statistics.
+ */
+extern void aushape_conv_buf_get_mem_stats(
+                            const struct aushape_conv_buf *buf,
+                            struct aushape_conv_mem_stats *stats);
+
+/**
+ * Retrieve record shape cache statistics of a converter output buffer.
+ *
+ * @param buf       The buffer to retrieve shape cache statistics for.
+ * @param stats     Location for the retrieved statistics.
+ */
+extern void aushape_conv_buf_get_shape_stats(
+                            const struct aushape_conv_buf *buf,
+                            struct aushape_conv_shape_stats *stats);
 
 /**
  * Cleanup a converter output buffer (free allocated data).
@@ -86,6 +141,21 @@ extern void aushape_conv_buf_cleanup(struct aushape_conv_buf *buf);
  */
 extern void aushape_conv_buf_empty(struct aushape_conv_buf *buf);
 
+/**
+ * Get the length of the output added to a converter output buffer,
+ * including the document events held back until the epilogue.
+ *
+ * @param buf   The buffer to get the output length of.
+ *
+ * @return The output length.
+ */
+static inline size_t
+aushape_conv_buf_get_len(const struct aushape_conv_buf *buf)
+{
+    assert(aushape_conv_buf_is_valid(buf));
+    return buf->gbuf.len + buf->doc.len;
+}
+
 /**
  * Add a document prologue fragment to a converter output buffer.
  *
@@ -99,7 +169,7 @@ extern enum aushape_rc aushape_conv_buf_add_prologue(
                                     struct aushape_conv_buf *buf);
 
 /**
- * Add a formatted fragment for an auparse event to a converter output buffer.
+ * Add a formatted fragment for an event to a converter output buffer.
  *
  * @param buf       The converter buffer to add the fragment to.
  * @param first     True if this is the first event being output for a record,
@@ -107,21 +177,22 @@ extern enum aushape_rc aushape_conv_buf_add_prologue(
  * @param padded    Location for the flag signifying that the event was added.
  *                  Set to true if the event was added. Not modified, if it
  *                  was dropped or an error occurred.
- * @param au        The auparse state with the current event as the one to be
- *                  output.
+ * @param ir        The intermediate representation of the event to be
+ *                  output, built with normalized data, if the buffer
+ *                  format requires it.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - added successfully,
  *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed,
- *          AUSHAPE_RC_INVALID_EXECVE   - invalid execve record sequence
- *                                        encountered.
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed while
+ *                                        building required parts of the
+ *                                        representation.
  */
 extern enum aushape_rc aushape_conv_buf_add_event(
                                     struct aushape_conv_buf *buf,
                                     bool first,
                                     bool *padded,
-                                    auparse_state_t *au);
+                                    const struct aushape_conv_ir *ir);
 
 /**
  * Add a document epilogue fragment to a converter output buffer.
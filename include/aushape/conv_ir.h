@@ -0,0 +1,177 @@
+/**
+ * @brief An aushape converter intermediate event representation
+ *
+ * The intermediate representation of an event is built once per event from
+ * the auparse state, and is then rendered by each converter output in its
+ * own language. It consists of intermediate trees (see itree.h) of source
+ * text lines, parsed records, data collected from the records, and
+ * normalized data, sharing a single pool of strings and fields.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_CONV_IR_H
+#define _AUSHAPE_CONV_IR_H
+
+#include <aushape/coll.h>
+#include <aushape/itree.h>
+#include <aushape/mem.h>
+#include <aushape/rc.h>
+#include <auparse.h>
+#include <time.h>
+
+/** Converter's intermediate event representation */
+struct aushape_conv_ir {
+    /** Pool of strings and fields the trees below refer to */
+    struct aushape_itree_pool   pool;
+    /** Event serial number */
+    unsigned long               serial;
+    /** Event time, seconds since the epoch */
+    time_t                      sec;
+    /** Event time, milliseconds part */
+    unsigned int                milli;
+    /** Event time, formatted as local ISO-8601 timestamp */
+    char                        time[64];
+    /**
+     * Position of the event node name in the pool text,
+     * AUSHAPE_ITREE_POS_NONE if unspecified
+     */
+    size_t                      node;
+    /** Source text lines (string nodes), one per record */
+    struct aushape_itree        text;
+    /** Parsed records (record nodes), in event order */
+    struct aushape_itree        records;
+    /**
+     * First failure of parsing the records, or OK. Records following
+     * the failed one are not parsed.
+     */
+    enum aushape_rc             records_rc;
+    /** Data collected from the records (record and list nodes) */
+    struct aushape_itree        data;
+    /** Record collector adding to the data */
+    struct aushape_coll        *coll;
+    /** Number of the data nodes added by the collector */
+    size_t                      data_num;
+    /**
+     * Failure of parsing or collecting the records into the data, or OK.
+     * The data is incomplete if not OK.
+     */
+    enum aushape_rc             data_rc;
+    /** True if the normalized data was built */
+    bool                        with_norm;
+    /** Normalized data (field and list nodes) */
+    struct aushape_itree        norm;
+    /** Items of the normalized data list nodes (field nodes) */
+    struct aushape_itree        norm_items;
+    /**
+     * Failure of building the normalized data, or OK.
+     * The normalized data is incomplete if not OK.
+     */
+    enum aushape_rc             norm_rc;
+};
+
+/**
+ * Check if an intermediate event representation is valid.
+ *
+ * @param ir    The representation to check.
+ *
+ * @return True if the representation is valid, false otherwise.
+ */
+extern bool aushape_conv_ir_is_valid(const struct aushape_conv_ir *ir);
+
+/**
+ * Initialize an intermediate event representation.
+ *
+ * @param ir    The representation to initialize.
+ * @param mem   The memory allocator to use, NULL for the C library one.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - initialized successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed.
+ */
+extern enum aushape_rc aushape_conv_ir_init(struct aushape_conv_ir *ir,
+                                            const struct aushape_mem *mem);
+
+/**
+ * Cleanup an intermediate event representation (free allocated data).
+ *
+ * @param ir    The representation to cleanup.
+ */
+extern void aushape_conv_ir_cleanup(struct aushape_conv_ir *ir);
+
+/**
+ * Empty an intermediate event representation.
+ *
+ * @param ir    The representation to empty.
+ */
+extern void aushape_conv_ir_empty(struct aushape_conv_ir *ir);
+
+/**
+ * Shrink the memory of an intermediate event representation down to the
+ * smallest size fitting its current contents.
+ *
+ * @param ir    The representation to shrink.
+ */
+extern void aushape_conv_ir_shrink(struct aushape_conv_ir *ir);
+
+/**
+ * Add the memory usage of an intermediate event representation, including
+ * its record collectors, to an accumulated usage.
+ *
+ * @param ir    The representation to get memory usage of.
+ * @param usage The accumulated memory usage to add to.
+ */
+extern void aushape_conv_ir_get_mem_usage(const struct aushape_conv_ir *ir,
+                                          struct aushape_mem_usage *usage);
+
+/**
+ * Build an intermediate representation of an auparse event, replacing the
+ * previous contents. Failures of parsing records, collecting data, and
+ * building normalized data are recorded in the representation, as they only
+ * affect the corresponding parts of the output.
+ *
+ * @param ir        The representation to build.
+ * @param with_norm True if the normalized data should be built,
+ *                  false otherwise.
+ * @param au        The auparse state with the current event as the one to
+ *                  build the representation of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - built successfully,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed,
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ */
+extern enum aushape_rc aushape_conv_ir_build(struct aushape_conv_ir *ir,
+                                             bool with_norm,
+                                             auparse_state_t *au);
+
+/**
+ * Check if an intermediate event representation should be dropped from
+ * output, i.e. if no data was collected and no error occurred.
+ *
+ * @param ir    The representation to check.
+ *
+ * @return True if the event should be dropped, false otherwise.
+ */
+static inline bool
+aushape_conv_ir_is_dropped(const struct aushape_conv_ir *ir)
+{
+    return ir->data_num == 0 && ir->data_rc == AUSHAPE_RC_OK;
+}
+
+#endif /* _AUSHAPE_CONV_IR_H */
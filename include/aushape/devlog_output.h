@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief Native syslog discrete aushape output.
+ *
+ * An implementation of an output sending discrete output fragments as
+ * syslog messages directly to the local syslog socket, usually /dev/log,
+ * without going through syslog(3).
+ *
+ * Each message gets a header in either the traditional BSD (RFC 3164)
+ * format, as produced by syslog(3), or in the RFC 5424 format, with UTC
+ * timestamps, formatted once per second. Messages are collected into
+ * batches and sent with a single sendmmsg(2), once the batch is full, on
+ * full synchronization, or by a flusher thread, once the oldest message
+ * waits for the specified maximum latency.
+ *
+ * Sending never blocks: if the syslog daemon doesn't keep up, or its
+ * socket is missing, messages stay queued and are retried, until the queue
+ * reaches its size limit, after which new messages are dropped. Only full
+ * synchronization waits for the queue to be sent, for a limited time.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_DEVLOG_OUTPUT_H
+#define _AUSHAPE_DEVLOG_OUTPUT_H
+
+#include <aushape/output.h>
+#include <stdint.h>
+
+/** Default path to the local syslog socket */
+#define AUSHAPE_DEVLOG_OUTPUT_PATH  "/dev/log"
+
+/**
+ * Maximum time full synchronization waits for the queue to be sent,
+ * milliseconds
+ */
+#define AUSHAPE_DEVLOG_OUTPUT_DRAIN_TIMEOUT 1000
+
+/** Syslog message header format */
+enum aushape_devlog_output_format {
+    AUSHAPE_DEVLOG_OUTPUT_FORMAT_INVALID,
+    /** BSD syslog (RFC 3164), as produced by syslog(3) */
+    AUSHAPE_DEVLOG_OUTPUT_FORMAT_RFC3164,
+    /** The syslog protocol (RFC 5424) */
+    AUSHAPE_DEVLOG_OUTPUT_FORMAT_RFC5424,
+    AUSHAPE_DEVLOG_OUTPUT_FORMAT_NUM
+};
+
+/**
+ * Check if a syslog message header format is valid.
+ *
+ * @param format    The format to check.
+ *
+ * @return True if the format is valid, false otherwise.
+ */
+static inline bool
+aushape_devlog_output_format_is_valid(enum aushape_devlog_output_format format)
+{
+    return format > AUSHAPE_DEVLOG_OUTPUT_FORMAT_INVALID &&
+           format < AUSHAPE_DEVLOG_OUTPUT_FORMAT_NUM;
+}
+
+/** Native syslog output statistics */
+struct aushape_devlog_output_stats {
+    /** Number of messages in the queue */
+    size_t      depth;
+    /** Number of times the socket couldn't accept more messages */
+    uint64_t    full;
+    /** Number of messages dropped */
+    uint64_t    dropped;
+    /** Number of batches sent */
+    uint64_t    batches;
+    /** Number of messages sent */
+    uint64_t    sent;
+};
+
+/** Native syslog output type */
+extern const struct aushape_output_type aushape_devlog_output_type;
+
+/**
+ * Create an instance of native syslog output.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param path          Path to the local syslog datagram socket.
+ * @param ident         Identifier to put into message headers,
+ *                      as the tag or the application name.
+ * @param facility      Syslog facility, as accepted by openlog(3).
+ * @param priority      Syslog priority, as accepted by syslog(3).
+ * @param format        Message header format.
+ * @param batch_size    Number of messages to send at once, positive.
+ * @param queue_size    Maximum size of queued messages, bytes, positive.
+ *                      A single message is queued even if bigger.
+ * @param max_latency   Maximum time to keep a message queued before
+ *                      trying to send it, milliseconds, zero for no limit.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - flusher thread creation
+ *                                            failed.
+ */
+static inline enum aushape_rc
+aushape_devlog_output_create(struct aushape_output **poutput,
+                             const char *path,
+                             const char *ident,
+                             int facility,
+                             int priority,
+                             enum aushape_devlog_output_format format,
+                             size_t batch_size,
+                             size_t queue_size,
+                             unsigned int max_latency)
+{
+    if (path == NULL || ident == NULL ||
+        !aushape_devlog_output_format_is_valid(format) ||
+        batch_size == 0 || queue_size == 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_devlog_output_type,
+                                 path, ident, facility, priority, format,
+                                 batch_size, queue_size, max_latency);
+}
+
+/**
+ * Retrieve statistics of a native syslog output.
+ *
+ * @param output    The native syslog output to retrieve statistics of.
+ * @param pstats    Location for the statistics.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - invalid arguments supplied.
+ */
+extern enum aushape_rc aushape_devlog_output_get_stats(
+                            const struct aushape_output *output,
+                            struct aushape_devlog_output_stats *pstats);
+
+#endif /* _AUSHAPE_DEVLOG_OUTPUT_H */
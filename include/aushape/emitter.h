@@ -0,0 +1,146 @@
+/**
+ * @brief Formatting functions specialized for an output language and folding
+ *
+ * Each emitter is an instance of the generic field and record formatting
+ * code, compiled with the output language and with "folding" (fold level
+ * zero, i.e. single-line output) being constants. This removes the
+ * per-token language and whitespace branches from the formatting paths.
+ * An emitter is selected once per format, when a converter, or a collector
+ * is created, and is then called with the same format.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_EMITTER_H
+#define _AUSHAPE_EMITTER_H
+
+#include <aushape/field_def.h>
+#include <aushape/gbuf.h>
+#include <aushape/format.h>
+#include <aushape/itree.h>
+#include <aushape/record_def.h>
+#include <aushape/shape_cache.h>
+#include <aushape/rc.h>
+#include <stdbool.h>
+
+/** Emitter: specialized formatting functions */
+struct aushape_emitter {
+    /** Output language the functions are specialized for */
+    enum aushape_lang   lang;
+    /**
+     * True if the functions are specialized for fold level zero,
+     * false if for any fold level. Always true for binary languages.
+     */
+    bool                folded;
+
+    /**
+     * Output field properties, see aushape_field_format_props.
+     * Arguments are expected to be valid.
+     */
+    enum aushape_rc   (*field_props)(struct aushape_gbuf *gbuf,
+                                     const struct aushape_format *format,
+                                     size_t level,
+                                     bool first,
+                                     bool list,
+                                     const char *name,
+                                     const char *value_r,
+                                     const char *value_i);
+
+    /**
+     * Output an intermediate tree field, see aushape_field_format.
+     * Arguments are expected to be valid.
+     */
+    enum aushape_rc   (*field)(struct aushape_gbuf *gbuf,
+                               const struct aushape_format *format,
+                               size_t level,
+                               bool first,
+                               bool list,
+                               const char *name,
+                               const struct aushape_itree_pool *pool,
+                               const struct aushape_itree_field *field);
+
+    /**
+     * Output intermediate record node fields, see
+     * aushape_record_format_fields. Arguments are expected to be valid.
+     * If the shape cache is not NULL, it is used to output the fields, and
+     * the record's shape is cached.
+     */
+    enum aushape_rc   (*record_fields)(
+                                struct aushape_gbuf *gbuf,
+                                const struct aushape_format *format,
+                                size_t level,
+                                struct aushape_shape_cache *shapes,
+                                const struct aushape_itree_pool *pool,
+                                const struct aushape_itree_node *record);
+
+    /**
+     * Output an intermediate record node, see aushape_record_format.
+     * Arguments are expected to be valid, the shape cache can be NULL.
+     */
+    enum aushape_rc   (*record)(struct aushape_gbuf *gbuf,
+                                const struct aushape_format *format,
+                                size_t level,
+                                bool first,
+                                struct aushape_shape_cache *shapes,
+                                const struct aushape_itree_pool *pool,
+                                const struct aushape_itree_node *record);
+
+    /**
+     * Output an intermediate record node of a known type, using the
+     * pre-formatted markup of its definition, see aushape_record_format.
+     * Arguments are expected to be valid, the shape cache can be NULL.
+     */
+    enum aushape_rc   (*record_def)(struct aushape_gbuf *gbuf,
+                                    const struct aushape_format *format,
+                                    size_t level,
+                                    bool first,
+                                    struct aushape_shape_cache *shapes,
+                                    const struct aushape_itree_pool *pool,
+                                    const struct aushape_itree_node *record);
+};
+
+/**
+ * Get the emitter specialized for a format.
+ *
+ * @param format    The format to get the emitter for, must be valid.
+ *
+ * @return The emitter.
+ */
+extern const struct aushape_emitter *aushape_emitter_get(
+                                    const struct aushape_format *format);
+
+/**
+ * Check if an emitter is valid for use with a format.
+ *
+ * @param emitter   The emitter to check.
+ * @param format    The format the emitter would be used with.
+ *
+ * @return True if the emitter is valid for the format, false otherwise.
+ */
+static inline bool
+aushape_emitter_is_valid(const struct aushape_emitter *emitter,
+                         const struct aushape_format *format)
+{
+    return emitter != NULL &&
+           aushape_format_is_valid(format) &&
+           emitter->lang == format->lang &&
+           (emitter->folded == (format->fold_level == 0) ||
+            aushape_lang_is_binary(format->lang));
+}
+
+#endif /* _AUSHAPE_EMITTER_H */
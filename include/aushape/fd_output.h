@@ -4,6 +4,14 @@
  *
  * An implementation of an output writing output fragments into a file
  * descriptor.
+ *
+ * The output can optionally accumulate fragments in a buffer, and write
+ * them together, with a single write(2), or writev(2) for a fragment not
+ * fitting into the buffer, once the buffer is full. To bound the time the
+ * output stays buffered, a flusher thread can write the buffer once it
+ * holds output for the specified maximum latency. The buffer is also
+ * written when the output is fully synchronized, e.g. by
+ * aushape_output_sync(output, true), which can serve as an explicit flush.
  */
 /*
  * Copyright (C) 2016 Red Hat
@@ -53,7 +61,86 @@ aushape_fd_output_create(struct aushape_output **poutput,
         return AUSHAPE_RC_INVALID_ARGS;
     }
     return aushape_output_create(poutput, &aushape_fd_output_type,
-                                 fd, fd_owned);
+                                 fd, fd_owned, (size_t)0, 0U, 0U, (size_t)0);
+}
+
+/**
+ * Create an instance of buffered file descriptor output.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param fd            File descriptor to write fragments to.
+ * @param fd_owned      True if the file descriptor should be closed upon
+ *                      destruction of the output, false otherwise.
+ * @param buf_size      Size of the buffer to accumulate fragments in,
+ *                      bytes, zero to write each fragment immediately.
+ * @param max_latency   Maximum time to keep output in the buffer,
+ *                      milliseconds, zero for no limit.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - flusher thread creation
+ *                                            failed.
+ */
+static inline enum aushape_rc
+aushape_fd_output_create_buffered(struct aushape_output **poutput,
+                                  int fd, bool fd_owned,
+                                  size_t buf_size,
+                                  unsigned int max_latency)
+{
+    if (fd < 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_fd_output_type,
+                                 fd, fd_owned, buf_size, max_latency,
+                                 0U, (size_t)0);
+}
+
+/**
+ * Create an instance of buffered file descriptor output, synchronizing
+ * output to disk in groups, with fdatasync(2), once the oldest output not
+ * synchronized yet is old enough, or once enough of it accumulates,
+ * whichever happens first, as well as on full synchronization of the
+ * output, and on its destruction. File descriptors which don't support
+ * synchronization, such as pipes, are not synchronized.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param fd            File descriptor to write fragments to.
+ * @param fd_owned      True if the file descriptor should be closed upon
+ *                      destruction of the output, false otherwise.
+ * @param buf_size      Size of the buffer to accumulate fragments in,
+ *                      bytes, zero to write each fragment immediately.
+ * @param max_latency   Maximum time to keep output in the buffer,
+ *                      milliseconds, zero for no limit.
+ * @param sync_interval Maximum time to keep output not synchronized,
+ *                      milliseconds, zero for no limit.
+ * @param sync_size     Maximum amount of output to keep not synchronized,
+ *                      bytes, zero for no limit.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - flusher thread creation
+ *                                            failed.
+ */
+static inline enum aushape_rc
+aushape_fd_output_create_synced(struct aushape_output **poutput,
+                                int fd, bool fd_owned,
+                                size_t buf_size,
+                                unsigned int max_latency,
+                                unsigned int sync_interval,
+                                size_t sync_size)
+{
+    if (fd < 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_fd_output_type,
+                                 fd, fd_owned, buf_size, max_latency,
+                                 sync_interval, sync_size);
 }
 
 #endif /* _AUSHAPE_FD_OUTPUT_H */
@@ -22,10 +22,13 @@
 #ifndef _AUSHAPE_FIELD_H
 #define _AUSHAPE_FIELD_H
 
+#include <aushape/field_def.h>
 #include <aushape/gbuf.h>
 #include <aushape/format.h>
+#include <aushape/itree.h>
 #include <aushape/rc.h>
 #include <auparse.h>
+#include <assert.h>
 
 /**
  * Output an auparse field as extracted properties to a growing buffer
@@ -59,8 +62,78 @@ extern enum aushape_rc aushape_field_format_props(
                                     const char *value_i);
 
 /**
- * Output an auparse field to a growing buffer according to format and
- * syntactic nesting level.
+ * Retrieve the kind of the current auparse field's values. The kind is
+ * taken from the known field definitions, if the field is known, and from
+ * the auparse field type otherwise.
+ *
+ * @param au        The auparse state with the current field as the one to
+ *                  retrieve the value kind of.
+ *
+ * @return The field value kind.
+ */
+extern enum aushape_field_kind aushape_field_get_kind(auparse_state_t *au);
+
+/**
+ * Retrieve the kind field values should be output as with a format: the
+ * field value kind if the format outputs typed values, and string otherwise.
+ *
+ * @param format    The output format, must be valid.
+ * @param kind      The field value kind.
+ *
+ * @return The field output value kind.
+ */
+static inline enum aushape_field_kind
+aushape_field_get_format_kind(const struct aushape_format *format,
+                              enum aushape_field_kind kind)
+{
+    assert(aushape_format_is_valid(format));
+    return format->typed ? kind : AUSHAPE_FIELD_KIND_STR;
+}
+
+/**
+ * Retrieve the raw and the "interpreted" values of the current auparse field.
+ *
+ * @param au        The auparse state with the current field as the one to
+ *                  retrieve the values of.
+ * @param pvalue_r  Location for the raw value.
+ * @param pvalue_i  Location for the "interpreted" value.
+ * @param pwith_raw Location for the flag, set to true if the raw value
+ *                  should be output along with the interpreted one, and to
+ *                  false if the field is escaped, or if the raw value is
+ *                  the same as interpreted.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - retrieved successfully,
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ */
+extern enum aushape_rc aushape_field_get_values(auparse_state_t *au,
+                                                const char **pvalue_r,
+                                                const char **pvalue_i,
+                                                bool *pwith_raw);
+
+/**
+ * Add the current auparse field to an intermediate tree pool.
+ *
+ * @param pool      The pool to add the field to.
+ * @param name      The field name to use.
+ * @param kind      Kind of the field values.
+ * @param au        The auparse state with the current field as the one to
+ *                  be added.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - added successfully,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed,
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ */
+extern enum aushape_rc aushape_field_add_to_pool(
+                                    struct aushape_itree_pool *pool,
+                                    const char *name,
+                                    enum aushape_field_kind kind,
+                                    auparse_state_t *au);
+
+/**
+ * Output an intermediate tree field to a growing buffer according to format
+ * and syntactic nesting level.
  *
  * @param gbuf      The growing buffer to add the formatted field to.
  * @param format    The output format to use.
@@ -71,14 +144,13 @@ extern enum aushape_rc aushape_field_format_props(
  *                  false if outputting a "map" item.
  * @param name      The field "element" name. Not used for list items in
  *                  languages where they don't have to be named, such as JSON.
- * @param au        The auparse state with the current field as the one to be
- *                  output.
+ * @param pool      The pool holding the field.
+ * @param field     The field to be output.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - output successfully,
  *          AUSHAPE_RC_INVALID_ARGS     - invalid arguments supplied,
- *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed.
  */
 extern enum aushape_rc aushape_field_format(
                                     struct aushape_gbuf *gbuf,
@@ -87,6 +159,7 @@ extern enum aushape_rc aushape_field_format(
                                     bool first,
                                     bool list,
                                     const char *name,
-                                    auparse_state_t *au);
+                                    const struct aushape_itree_pool *pool,
+                                    const struct aushape_itree_field *field);
 
 #endif /* _AUSHAPE_FIELD_H */
@@ -0,0 +1,62 @@
+/**
+ * @brief Known record field definitions
+ *
+ * The list of record fields and the kinds of their values is generated from
+ * the "generic_fields" definition in aushape.schema.json by field_def.awk at
+ * build time.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_FIELD_DEF_H
+#define _AUSHAPE_FIELD_DEF_H
+
+#include <stddef.h>
+
+/** Field value kind */
+enum aushape_field_kind {
+    AUSHAPE_FIELD_KIND_STR,     /**< String */
+    AUSHAPE_FIELD_KIND_INT,     /**< Integer, if the value is one */
+    AUSHAPE_FIELD_KIND_BOOL,    /**< Boolean, if the value is one */
+};
+
+/** Known record field definition */
+struct aushape_field_def {
+    /** Field name, as output by auparse */
+    const char             *name;
+    /** Kind of the field values */
+    enum aushape_field_kind kind;
+};
+
+/** Known record field definitions, sorted by name (generated) */
+extern const struct aushape_field_def aushape_field_def_list[];
+
+/** Number of known record field definitions (generated) */
+extern const size_t aushape_field_def_num;
+
+/**
+ * Lookup a known record field definition.
+ *
+ * @param name  The field name to lookup.
+ *
+ * @return The field definition, or NULL if not known.
+ */
+extern const struct aushape_field_def *aushape_field_def_lookup(
+                                                    const char *name);
+
+#endif /* _AUSHAPE_FIELD_DEF_H */
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Rotating file aushape output.
+ *
+ * An implementation of an output writing to a file at a path, through a
+ * buffered, group-synchronized FD output (see fd_output.h), and rotating
+ * the file once it grows to a size, or ages to a time limit, whichever
+ * happens first. Files are only rotated at document boundaries, i.e. where
+ * the converter synchronizes the output, so each of them holds complete
+ * documents.
+ *
+ * Rotation writes out and synchronizes the file, renames it atomically to
+ * its path with a suffix of a dot and the UTC time of rotation, e.g.
+ * "audit.json.20161231T235959Z", followed by a dot and a three-digit
+ * number, if that name is taken, so the names sort in the order of
+ * rotation, synchronizes the directory, and starts a new file at the path.
+ * If rotation is enabled, a non-empty file found at the path on creation
+ * is rotated the same way, instead of truncated.
+ *
+ * Files can have space preallocated with fallocate(2), without changing
+ * their size, to reduce fragmentation and metadata updates on synchronization.
+ * Space unused by a file is released once it's rotated or closed.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_FILE_OUTPUT_H
+#define _AUSHAPE_FILE_OUTPUT_H
+
+#include <aushape/output.h>
+#include <stdint.h>
+
+/** Rotating file output type */
+extern const struct aushape_output_type aushape_file_output_type;
+
+/**
+ * Create an instance of rotating file output.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param path          Path to the file to write.
+ * @param buf_size      Size of the buffer to accumulate fragments in,
+ *                      bytes, zero to write each fragment immediately.
+ * @param max_latency   Maximum time to keep output in the buffer,
+ *                      milliseconds, zero for no limit.
+ * @param sync_interval Maximum time to keep output not synchronized to
+ *                      disk, milliseconds, zero for no limit.
+ * @param sync_size     Maximum amount of output to keep not synchronized
+ *                      to disk, bytes, zero for no limit.
+ * @param rotate_size   Size of the file to rotate it at, bytes, zero to not
+ *                      rotate by size.
+ * @param rotate_time   Age of the file to rotate it at, seconds, zero to
+ *                      not rotate by time.
+ * @param prealloc      Amount of space to preallocate for each file,
+ *                      bytes, zero to not preallocate.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - opening or rotating the file,
+ *                                            or flusher thread creation
+ *                                            failed, errno is set to the
+ *                                            cause.
+ */
+static inline enum aushape_rc
+aushape_file_output_create(struct aushape_output **poutput,
+                           const char *path,
+                           size_t buf_size,
+                           unsigned int max_latency,
+                           unsigned int sync_interval,
+                           size_t sync_size,
+                           uint64_t rotate_size,
+                           unsigned int rotate_time,
+                           size_t prealloc)
+{
+    if (path == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_file_output_type,
+                                 path, buf_size, max_latency,
+                                 sync_interval, sync_size,
+                                 rotate_size, rotate_time, prealloc);
+}
+
+#endif /* _AUSHAPE_FILE_OUTPUT_H */
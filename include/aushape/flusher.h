@@ -0,0 +1,195 @@
+/**
+ * @file
+ * @brief Output flusher thread and monotonic time helpers.
+ *
+ * A flusher is a thread flushing the buffered contents of an output once
+ * it's been buffered long enough. The output supplies two functions: one
+ * getting the monotonic time the next flush is due at, if any, and one
+ * doing the flush. Both are called on the flusher thread with the flusher
+ * mutex locked, which the output locks itself to access the state they
+ * use, and the output signals the flusher when a flush becomes pending.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_FLUSHER_H
+#define _AUSHAPE_FLUSHER_H
+
+#include <aushape/rc.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+#include <assert.h>
+
+/**
+ * Advance a monotonic time by a number of milliseconds.
+ *
+ * @param ptime The location of the time to advance.
+ * @param msec  The number of milliseconds to advance by.
+ */
+extern void aushape_flusher_time_add(struct timespec *ptime,
+                                     unsigned int msec);
+
+/**
+ * Check if a monotonic time is earlier than another.
+ *
+ * @param a     The time to check.
+ * @param b     The time to compare against.
+ *
+ * @return True if the time is earlier, false otherwise.
+ */
+extern bool aushape_flusher_time_before(const struct timespec *a,
+                                        const struct timespec *b);
+
+/**
+ * Get the number of milliseconds left until a monotonic time, rounded up.
+ *
+ * @param time  The time to get the milliseconds until, or NULL for never.
+ *
+ * @return Number of milliseconds left, zero if the time has passed, or -1
+ *         if the time is never, as accepted by poll(2).
+ */
+extern int aushape_flusher_time_left(const struct timespec *time);
+
+/**
+ * Flusher "due" function prototype: get the monotonic time the next flush
+ * of an output is due at.
+ *
+ * @param data      The output data.
+ * @param pdeadline Location for the time the flush is due at.
+ *
+ * @return True if a flush is pending and its time was output,
+ *         false if there is nothing to flush, or flushing failed.
+ */
+typedef bool (*aushape_flusher_due_fn)(void *data,
+                                       struct timespec *pdeadline);
+
+/**
+ * Flusher "flush" function prototype: flush an output, as its flush came
+ * due. Can unlock the flusher while blocking, but must lock it back.
+ *
+ * @param data      The output data.
+ * @param now       The current monotonic time.
+ */
+typedef void (*aushape_flusher_flush_fn)(void *data,
+                                         const struct timespec *now);
+
+/** Flusher, zeroed memory constitutes a stopped one */
+struct aushape_flusher {
+    aushape_flusher_due_fn      due;    /**< Flush time function */
+    aushape_flusher_flush_fn    flush;  /**< Flush function */
+    void                       *data;   /**< Output data for the functions */
+    /** True if the mutex and condition are initialized */
+    bool                        init;
+    /** Mutex protecting the output state against the flusher thread */
+    pthread_mutex_t             mutex;
+    /**
+     * Condition signaled on a flush becoming pending, or on stop.
+     * Uses the monotonic clock.
+     */
+    pthread_cond_t              cond;
+    bool                        stop;   /**< True if the thread should stop */
+    bool                        run;    /**< True if the thread is running */
+    pthread_t                   thread; /**< Flusher thread */
+};
+
+/**
+ * Start a flusher.
+ *
+ * @param flusher   The flusher to start, must be zeroed.
+ * @param due       The function getting the time of the next flush.
+ * @param flush     The function doing the flush.
+ * @param data      The output data to pass to the functions.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - started successfully,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - failed initializing the
+ *                                            synchronization, or creating
+ *                                            the thread.
+ */
+extern enum aushape_rc aushape_flusher_start(struct aushape_flusher *flusher,
+                                             aushape_flusher_due_fn due,
+                                             aushape_flusher_flush_fn flush,
+                                             void *data);
+
+/**
+ * Stop a flusher, if started, waiting for it to finish a flush in
+ * progress, and zero it.
+ *
+ * @param flusher   The flusher to stop.
+ */
+extern void aushape_flusher_stop(struct aushape_flusher *flusher);
+
+/**
+ * Check if a flusher is started.
+ *
+ * @param flusher   The flusher to check.
+ *
+ * @return True if the flusher is started, false otherwise.
+ */
+static inline bool
+aushape_flusher_is_started(const struct aushape_flusher *flusher)
+{
+    assert(flusher != NULL);
+    return flusher->init;
+}
+
+/**
+ * Lock a flusher's mutex, if the flusher is started.
+ *
+ * @param flusher   The flusher to lock.
+ */
+static inline void
+aushape_flusher_lock(struct aushape_flusher *flusher)
+{
+    assert(flusher != NULL);
+    if (flusher->init) {
+        pthread_mutex_lock(&flusher->mutex);
+    }
+}
+
+/**
+ * Unlock a flusher's mutex, if the flusher is started.
+ *
+ * @param flusher   The flusher to unlock.
+ */
+static inline void
+aushape_flusher_unlock(struct aushape_flusher *flusher)
+{
+    assert(flusher != NULL);
+    if (flusher->init) {
+        pthread_mutex_unlock(&flusher->mutex);
+    }
+}
+
+/**
+ * Notify a locked flusher of a flush becoming pending, or its time
+ * changing, if the flusher is started.
+ *
+ * @param flusher   The flusher to notify.
+ */
+static inline void
+aushape_flusher_signal(struct aushape_flusher *flusher)
+{
+    assert(flusher != NULL);
+    if (flusher->init) {
+        pthread_cond_signal(&flusher->cond);
+    }
+}
+
+#endif /* _AUSHAPE_FLUSHER_H */
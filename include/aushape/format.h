@@ -57,6 +57,27 @@ struct aushape_format {
      * the size of accumulated event text crosses the negated number.
      */
     ssize_t             events_per_doc;
+    /**
+     * True for newline-delimited JSON output: each event on its own line,
+     * terminated with a newline. Requires the JSON language, fold_level
+     * zero, and events_per_doc zero. Events are written to continuous
+     * outputs in batches.
+     */
+    bool                ndjson;
+    /**
+     * True if values of fields known to be integer or boolean should be
+     * output as JSON numbers and booleans, where they can be parsed as
+     * such, instead of strings. Requires the JSON language. Normalized
+     * data is not affected.
+     */
+    bool                typed;
+    /**
+     * True if object member names known from the schema should be output
+     * as short IDs from the compact key dictionary (see key_dict.h).
+     * Requires the JSON language. Each document starts with the dictionary
+     * identification string.
+     */
+    bool                compact_keys;
     /**
      * Maximum output event size, bytes
      */
@@ -71,6 +92,17 @@ struct aushape_format {
      * false otherwise.
      */
     bool                with_norm;
+    /**
+     * Number of consecutive events with (untrimmed) size below shrink_below
+     * after which conversion buffers are shrunk back toward their initial
+     * sizes, releasing memory retained after a big event. Zero to never
+     * shrink.
+     */
+    size_t              shrink_after;
+    /**
+     * Event size, bytes, below which an event counts towards shrink_after.
+     */
+    size_t              shrink_below;
 };
 
 /**
@@ -85,6 +117,14 @@ aushape_format_is_valid(const struct aushape_format *format)
 {
     return format != NULL &&
            aushape_lang_is_valid(format->lang) &&
+           (format->lang != AUSHAPE_LANG_ARROW ||
+            format->events_per_doc >= 0) &&
+           (!format->ndjson ||
+            (format->lang == AUSHAPE_LANG_JSON &&
+             format->fold_level == 0 &&
+             format->events_per_doc == 0)) &&
+           (!format->typed || format->lang == AUSHAPE_LANG_JSON) &&
+           (!format->compact_keys || format->lang == AUSHAPE_LANG_JSON) &&
            format->max_event_size >= AUSHAPE_FORMAT_MIN_MAX_EVENT_SIZE;
 }
 
@@ -22,6 +22,7 @@
 #ifndef _AUSHAPE_GARR_H
 #define _AUSHAPE_GARR_H
 
+#include <aushape/mem.h>
 #include <aushape/rc.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -34,6 +35,10 @@ struct aushape_garr {
     size_t  valid_len;      /**< Valid item number */
     size_t  alloc_len;      /**< Allocated item number */
     size_t  init_alloc_len; /**< Initial allocated item number */
+    /** Memory allocator, NULL for the C library one */
+    const struct aushape_mem   *mem;
+    /** Peak allocated item number */
+    size_t  peak_alloc_len;
 };
 
 /**
@@ -51,10 +56,12 @@ extern bool aushape_garr_is_valid(const struct aushape_garr *garr);
  * @param garr      The growing array to initialize.
  * @param item_size The array item size, bytes. Cannot be zero.
  * @param alloc_len Initial array length to allocate. Cannot be zero.
+ * @param mem       Memory allocator to use, NULL for the C library one.
  */
 extern void aushape_garr_init(struct aushape_garr *garr,
                               size_t item_size,
-                              size_t alloc_len);
+                              size_t alloc_len,
+                              const struct aushape_mem *mem);
 
 /**
  * Cleanup a growing array.
@@ -108,6 +115,24 @@ aushape_garr_get_len(const struct aushape_garr *garr)
 extern enum aushape_rc aushape_garr_accomodate(struct aushape_garr *garr,
                                                size_t len);
 
+/**
+ * Shrink the memory of a growing array down to the smallest size it could
+ * have grown to with its current valid items, i.e. the initial length
+ * doubled enough times to fit them. The valid items are kept.
+ *
+ * @param garr  The growing array to shrink.
+ */
+extern void aushape_garr_shrink(struct aushape_garr *garr);
+
+/**
+ * Add the memory usage of a growing array to an accumulated usage.
+ *
+ * @param garr  The growing array to get memory usage of.
+ * @param usage The accumulated memory usage to add to.
+ */
+extern void aushape_garr_get_mem_usage(const struct aushape_garr *garr,
+                                       struct aushape_mem_usage *usage);
+
 /**
  * Store an item copy in a growing array at a specified index.
  *
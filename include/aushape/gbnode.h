@@ -24,12 +24,19 @@
 
 #include <aushape/gbuf.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <assert.h>
 #include <stdbool.h>
 
 /** Forward declaration of an (exponentially) growing buffer tree */
 struct aushape_gbtree;
 
+/** Node index/priority value meaning "no node" */
+#define AUSHAPE_GBNODE_INDEX_NONE   UINT32_MAX
+
+/** Maximum number of nodes, priorities, subtrees, or text bytes in a tree */
+#define AUSHAPE_GBNODE_MAX          (UINT32_MAX - 1)
+
 /** Growing buffer node type */
 enum aushape_gbnode_type {
     /** Void node (no node in an array) */
@@ -38,6 +45,12 @@ enum aushape_gbnode_type {
     AUSHAPE_GBNODE_TYPE_TEXT,
     /** Tree node. Represents the tree itself. */
     AUSHAPE_GBNODE_TYPE_TREE,
+    /**
+     * Head node. Represents a MessagePack array or map head, counting the
+     * non-empty nodes following it in the owner tree, as they are when
+     * rendered, i.e. after trimming.
+     */
+    AUSHAPE_GBNODE_TYPE_HEAD,
     /** Number of node types, not a valid node type */
     AUSHAPE_GBNODE_TYPE_NUM
 };
@@ -45,94 +58,105 @@ enum aushape_gbnode_type {
 /**
  * A growing buffer node.
  * Zeroed memory constitutes a void node.
+ *
+ * The node doesn't refer to its owner tree, and refers to subtrees by their
+ * index in the owner's subtree array, so nodes stay small and a whole node
+ * array of a typical event fits into a few cache lines. The owner tree has to
+ * be supplied to every node function instead.
  */
 struct aushape_gbnode {
     /** Node type */
     enum aushape_gbnode_type    type;
     /** Node priority */
-    size_t                      prio;
+    uint32_t                    prio;
     /** Index of the previous node with the same priority */
-    size_t                      prev_index;
+    uint32_t                    prev_index;
     /** Index of the next node with the same priority */
-    size_t                      next_index;
+    uint32_t                    next_index;
     /**
-     * The node owner tree.
-     * Must be valid, if node is not void.
-     */
-    struct aushape_gbtree      *owner;
-    /**
-     * The growing buffer tree this node refers to.
-     * Must be valid, if node type is AUSHAPE_GBNODE_TYPE_TREE.
-     */
-    struct aushape_gbtree      *tree;
-    /**
-     * Position of the node text in the owner's text buffer.
-     * Cannot point outside the owner's text buffer.
+     * For text nodes - position of the node text in the owner's text
+     * buffer, cannot point outside the owner's text buffer.
+     * For tree nodes - index of the referenced tree in the owner's subtree
+     * array, cannot point outside the array.
+     * For head nodes - the head's MessagePack type, array or map.
      */
-    size_t                      pos;
+    uint32_t                    pos;
     /**
-     * Length of the node text in the owner's text buffer.
+     * For text nodes - length of the node text in the owner's text buffer.
      * Cannot point outside the owner's text buffer.
      */
-    size_t                      len;
+    uint32_t                    len;
 };
 
 /**
  * Check if a growing buffer node is valid.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to check.
  *
  * @return True if the node is valid, false otherwise.
  */
-extern bool aushape_gbnode_is_valid(const struct aushape_gbnode *gbnode);
+extern bool aushape_gbnode_is_valid(const struct aushape_gbtree *owner,
+                                    const struct aushape_gbnode *gbnode);
 
 /**
  * Check if a growing buffer node is empty,
  * i.e. if it is void, or its tree is empty.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to check.
  *
  * @return True if the node is empty, false otherwise.
  */
-extern bool aushape_gbnode_is_empty(const struct aushape_gbnode *gbnode);
+extern bool aushape_gbnode_is_empty(const struct aushape_gbtree *owner,
+                                    const struct aushape_gbnode *gbnode);
 
 /**
  * Check if a growing buffer node is solid,
  * i.e. if it is not void or its buffer is solid.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to check.
  *
  * @return True if the node is solid, false otherwise.
  */
-extern bool aushape_gbnode_is_solid(const struct aushape_gbnode *gbnode);
+extern bool aushape_gbnode_is_solid(const struct aushape_gbtree *owner,
+                                    const struct aushape_gbnode *gbnode);
 
 /**
  * Check if a growing buffer node is atomic, i.e. if it can be trimmed.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to check.
  * @param cached    True if the cached atomic status should be used,
  *                  false if it should be determined and cached.
  *
  * @return True if the node is atomic, false otherwise.
  */
-extern bool aushape_gbnode_is_atomic(struct aushape_gbnode *gbnode,
+extern bool aushape_gbnode_is_atomic(const struct aushape_gbtree *owner,
+                                     struct aushape_gbnode *gbnode,
                                      bool cached);
 
 /**
  * Get the (cached) length of a growing buffer node content.
+ * The length of a head node is always calculated, as it depends on the
+ * following nodes, which can only shrink when trimmed.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to get the content length of.
  * @param cached    True if cached tree lengths should be used,
  *                  false if tree lengths should be calculated and cached.
  *
  * @return The node content length.
  */
-extern size_t aushape_gbnode_get_len(struct aushape_gbnode *gbnode,
+extern size_t aushape_gbnode_get_len(const struct aushape_gbtree *owner,
+                                     struct aushape_gbnode *gbnode,
                                      bool cached);
 
 /**
  * Trim a node to fit the specified length.
  *
+ * @param owner         The growing buffer tree owning the node.
  * @param gbnode        The growing buffer node to trim.
  * @param atomic_cached True if cached tree atomicity should be used,
  *                      false if atomicity should be determined and cached.
@@ -143,7 +167,8 @@ extern size_t aushape_gbnode_get_len(struct aushape_gbnode *gbnode,
  * @return The resulting length of the buffer contents. Can be bigger than the
  *         requested length if the node ended up being atomic.
  */
-extern size_t aushape_gbnode_trim(struct aushape_gbnode *gbnode,
+extern size_t aushape_gbnode_trim(const struct aushape_gbtree *owner,
+                                  struct aushape_gbnode *gbnode,
                                   bool atomic_cached,
                                   bool len_cached,
                                   size_t len);
@@ -153,6 +178,7 @@ extern size_t aushape_gbnode_trim(struct aushape_gbnode *gbnode,
  * Output the contents of a growing buffer node to a growing buffer.
  * In short, "render" a node.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to render.
  * @param gbuf      The growing buffer to render to.
  *
@@ -160,13 +186,16 @@ extern size_t aushape_gbnode_trim(struct aushape_gbnode *gbnode,
  *          AUSHAPE_RC_OK       - rendered successfully,
  *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
  */
-extern enum aushape_rc aushape_gbnode_render(struct aushape_gbnode *gbnode,
-                                             struct aushape_gbuf *gbuf);
+extern enum aushape_rc aushape_gbnode_render(
+                                    const struct aushape_gbtree *owner,
+                                    struct aushape_gbnode *gbnode,
+                                    struct aushape_gbuf *gbuf);
 
 /**
  * Render a dump of the structure of a growing buffer node into a growing
  * buffer for debugging.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to dump.
  * @param gbuf      The growing buffer to dump into.
  * @param format    The output format to use.
@@ -179,6 +208,7 @@ extern enum aushape_rc aushape_gbnode_render(struct aushape_gbnode *gbnode,
  *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
  */
 extern enum aushape_rc aushape_gbnode_render_dump(
+                                    const struct aushape_gbtree *owner,
                                     const struct aushape_gbnode *gbnode,
                                     struct aushape_gbuf *gbuf,
                                     const struct aushape_format *format,
@@ -190,6 +220,7 @@ extern enum aushape_rc aushape_gbnode_render_dump(
  * debugging, in specified language, without leading indent, with 4-space
  * indent per nesting level, and fully unfolded.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to dump.
  * @param fd        The descriptor of the file to print to.
  * @param lang      The output language to use.
@@ -199,6 +230,7 @@ extern enum aushape_rc aushape_gbnode_render_dump(
  *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
  */
 extern enum aushape_rc aushape_gbnode_print_dump_to_fd(
+                                    const struct aushape_gbtree *owner,
                                     const struct aushape_gbnode *gbnode,
                                     int fd,
                                     enum aushape_lang lang);
@@ -208,6 +240,7 @@ extern enum aushape_rc aushape_gbnode_print_dump_to_fd(
  * debugging, in specified language, without leading indent, with 4-space
  * indent per nesting level, and fully unfolded.
  *
+ * @param owner     The growing buffer tree owning the node.
  * @param gbnode    The growing buffer node to dump.
  * @param filename  The name of the file to print to.
  * @param lang      The output language to use.
@@ -217,6 +250,7 @@ extern enum aushape_rc aushape_gbnode_print_dump_to_fd(
  *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
  */
 extern enum aushape_rc aushape_gbnode_print_dump_to_file(
+                                    const struct aushape_gbtree *owner,
                                     const struct aushape_gbnode *gbnode,
                                     const char *filename,
                                     enum aushape_lang lang);
@@ -44,11 +44,16 @@ struct aushape_gbtree {
      */
     struct aushape_garr     nodes;
     /**
-     * Priority->node index map.
-     * SIZE_MAX means no index.
+     * Priority->node index map, of uint32_t.
+     * AUSHAPE_GBNODE_INDEX_NONE means no index.
      * Lower numbers are higher priorities.
      */
     struct aushape_garr     prios;
+    /**
+     * Subtree array, of struct aushape_gbtree pointers.
+     * Referred to by tree nodes.
+     */
+    struct aushape_garr     trees;
     /**
      * Cached atomic status of the buffer content.
      * If true, then this tree cannot be trimmed,
@@ -87,11 +92,26 @@ extern bool aushape_gbtree_is_valid(const struct aushape_gbtree *gbtree);
  *                  Cannot be zero.
  * @param prio_min  Initial number of priorities to allocate.
  *                  Cannot be zero.
+ * @param mem       Memory allocator to use, NULL for the C library one.
  */
 extern void aushape_gbtree_init(struct aushape_gbtree *gbtree,
                                 size_t text_min,
                                 size_t node_min,
-                                size_t prio_min);
+                                size_t prio_min,
+                                const struct aushape_mem *mem);
+
+/**
+ * Get the memory allocator used by a growing buffer tree.
+ *
+ * @param gbtree    The growing buffer tree to get the allocator of.
+ *
+ * @return The memory allocator, NULL for the C library one.
+ */
+static inline const struct aushape_mem *
+aushape_gbtree_get_mem(const struct aushape_gbtree *gbtree)
+{
+    return gbtree->text.mem;
+}
 
 /**
  * Cleanup a growing buffer tree.
@@ -117,6 +137,24 @@ extern void aushape_gbtree_empty(struct aushape_gbtree *gbtree);
  */
 extern bool aushape_gbtree_is_empty(const struct aushape_gbtree *gbtree);
 
+/**
+ * Shrink the memory of a growing buffer tree's text buffer and arrays down
+ * to the smallest sizes fitting their current contents.
+ *
+ * @param gbtree    The growing buffer tree to shrink.
+ */
+extern void aushape_gbtree_shrink(struct aushape_gbtree *gbtree);
+
+/**
+ * Add the memory usage of a growing buffer tree to an accumulated usage.
+ * Subtrees are not included.
+ *
+ * @param gbtree    The growing buffer tree to get memory usage of.
+ * @param usage     The accumulated memory usage to add to.
+ */
+extern void aushape_gbtree_get_mem_usage(const struct aushape_gbtree *gbtree,
+                                         struct aushape_mem_usage *usage);
+
 /**
  * Check if a growing buffer tree is solid (or continuous), i.e. if there are
  * no missing nodes.
@@ -185,7 +223,8 @@ extern bool aushape_gbtree_node_exists(const struct aushape_gbtree *gbtree,
  *
  * @return Return code:
  *          AUSHAPE_RC_OK       - node voided successfully,
- *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory, or the index
+ *                                exceeds AUSHAPE_GBNODE_MAX.
  */
 extern enum aushape_rc aushape_gbtree_node_void(struct aushape_gbtree *gbtree,
                                                 size_t index);
@@ -201,7 +240,9 @@ extern enum aushape_rc aushape_gbtree_node_void(struct aushape_gbtree *gbtree,
  *
  * @return Return code:
  *          AUSHAPE_RC_OK       - node added successfully,
- *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory, or the index,
+ *                                the priority, or the text buffer length
+ *                                exceed AUSHAPE_GBNODE_MAX.
  */
 extern enum aushape_rc aushape_gbtree_node_put_text(
                                         struct aushape_gbtree *gbtree,
@@ -218,7 +259,9 @@ extern enum aushape_rc aushape_gbtree_node_put_text(
  *
  * @return Return code:
  *          AUSHAPE_RC_OK       - node added successfully,
- *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory, or the node
+ *                                number, the priority, or the text buffer
+ *                                length exceed AUSHAPE_GBNODE_MAX.
  */
 extern enum aushape_rc aushape_gbtree_node_add_text(
                                         struct aushape_gbtree *gbtree,
@@ -235,7 +278,9 @@ extern enum aushape_rc aushape_gbtree_node_add_text(
  *
  * @return Return code:
  *          AUSHAPE_RC_OK       - node added successfully,
- *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory, or the index,
+ *                                the priority, or the number of subtrees
+ *                                exceed AUSHAPE_GBNODE_MAX.
  */
 extern enum aushape_rc aushape_gbtree_node_put_tree(
                                         struct aushape_gbtree *gbtree,
@@ -253,13 +298,58 @@ extern enum aushape_rc aushape_gbtree_node_put_tree(
  *
  * @return Return code:
  *          AUSHAPE_RC_OK       - node added successfully,
- *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory, or the node
+ *                                number, the priority, or the number of
+ *                                subtrees exceed AUSHAPE_GBNODE_MAX.
  */
 extern enum aushape_rc aushape_gbtree_node_add_tree(
                                         struct aushape_gbtree *gbtree,
                                         size_t prio,
                                         struct aushape_gbtree *node_tree);
 
+/**
+ * Put a new head node to a specified position in a growing buffer tree,
+ * rendering to a MessagePack array or map head, counting the non-empty nodes
+ * following it in the tree when rendered. Replaces existing node. The text
+ * added since the last text node stays pending.
+ *
+ * @param gbtree    The growing buffer tree to add the head node to.
+ * @param index     The index to put the new node at.
+ * @param prio      The priority to assign to the added node.
+ * @param type      The MessagePack type of the head: array or map.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - node added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory, or the index, or
+ *                                the priority exceed AUSHAPE_GBNODE_MAX.
+ */
+extern enum aushape_rc aushape_gbtree_node_put_head(
+                                        struct aushape_gbtree *gbtree,
+                                        size_t index,
+                                        size_t prio,
+                                        enum aushape_msgpack_type type);
+
+/**
+ * Add a new head node to the end of a growing buffer tree, rendering to a
+ * MessagePack array or map head, counting the non-empty nodes following it
+ * in the tree when rendered. The text added since the last text node stays
+ * pending.
+ *
+ * @param gbtree    The growing buffer tree to add the head node to.
+ * @param prio      The priority to assign to the added node.
+ * @param type      The MessagePack type of the head: array or map.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - node added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory, or the node
+ *                                number, or the priority exceed
+ *                                AUSHAPE_GBNODE_MAX.
+ */
+extern enum aushape_rc aushape_gbtree_node_add_head(
+                                        struct aushape_gbtree *gbtree,
+                                        size_t prio,
+                                        enum aushape_msgpack_type type);
+
 /**
  * Trim a growing buffer tree to a specified length by voiding nodes of the
  * lowest possible priority until the total contents fits. Items of the same
@@ -23,10 +23,41 @@
 #define _AUSHAPE_GBUF_H
 
 #include <aushape/format.h>
+#include <aushape/mem.h>
 #include <aushape/rc.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+/** CBOR data item major type */
+enum aushape_cbor_major {
+    AUSHAPE_CBOR_MAJOR_UINT     = 0,    /**< Unsigned integer */
+    AUSHAPE_CBOR_MAJOR_NINT     = 1,    /**< Negative integer */
+    AUSHAPE_CBOR_MAJOR_BYTES    = 2,    /**< Byte string */
+    AUSHAPE_CBOR_MAJOR_TEXT     = 3,    /**< Text string */
+    AUSHAPE_CBOR_MAJOR_ARRAY    = 4,    /**< Array */
+    AUSHAPE_CBOR_MAJOR_MAP      = 5,    /**< Map */
+    AUSHAPE_CBOR_MAJOR_TAG      = 6,    /**< Tag */
+    AUSHAPE_CBOR_MAJOR_SIMPLE   = 7,    /**< Float and simple value */
+};
+
+/** CBOR "break" stop code, terminating an indefinite-length item */
+#define AUSHAPE_CBOR_BREAK  ((char)0xff)
+
+/** CBOR tag of an epoch-based date/time */
+#define AUSHAPE_CBOR_TAG_EPOCH  1
+
+/** MessagePack type of an item with a length-prefixed head */
+enum aushape_msgpack_type {
+    AUSHAPE_MSGPACK_TYPE_STR,       /**< String (UTF-8 text) */
+    AUSHAPE_MSGPACK_TYPE_BIN,       /**< Binary (byte string) */
+    AUSHAPE_MSGPACK_TYPE_ARRAY,     /**< Array */
+    AUSHAPE_MSGPACK_TYPE_MAP,       /**< Map */
+};
+
+/** Maximum length of a MessagePack item head */
+#define AUSHAPE_MSGPACK_HEAD_MAX_LEN    5
 
 /** An (exponentially) growing buffer */
 struct aushape_gbuf {
@@ -34,6 +65,10 @@ struct aushape_gbuf {
     size_t  size;       /**< Buffer size */
     size_t  init_size;  /**< Initial buffer size */
     size_t  len;        /**< Buffer contents length */
+    /** Memory allocator, NULL for the C library one */
+    const struct aushape_mem   *mem;
+    /** Peak buffer size */
+    size_t  peak_size;
 };
 
 /**
@@ -50,8 +85,10 @@ extern bool aushape_gbuf_is_valid(const struct aushape_gbuf *gbuf);
  *
  * @param gbuf  The growing buffer to initialize.
  * @param size  Initial buffer size to allocate. Cannot be zero.
+ * @param mem   Memory allocator to use, NULL for the C library one.
  */
-extern void aushape_gbuf_init(struct aushape_gbuf *gbuf, size_t size);
+extern void aushape_gbuf_init(struct aushape_gbuf *gbuf, size_t size,
+                              const struct aushape_mem *mem);
 
 /**
  * Cleanup a growing buffer.
@@ -91,6 +128,24 @@ extern bool aushape_gbuf_is_empty(const struct aushape_gbuf *gbuf);
 extern enum aushape_rc aushape_gbuf_accomodate(struct aushape_gbuf *gbuf,
                                                size_t len);
 
+/**
+ * Shrink the memory of a growing buffer down to the smallest size it could
+ * have grown to with its current contents, i.e. the initial size doubled
+ * enough times to fit them. The contents are kept.
+ *
+ * @param gbuf  The growing buffer to shrink.
+ */
+extern void aushape_gbuf_shrink(struct aushape_gbuf *gbuf);
+
+/**
+ * Add the memory usage of a growing buffer to an accumulated usage.
+ *
+ * @param gbuf  The growing buffer to get memory usage of.
+ * @param usage The accumulated memory usage to add to.
+ */
+extern void aushape_gbuf_get_mem_usage(const struct aushape_gbuf *gbuf,
+                                       struct aushape_mem_usage *usage);
+
 /**
  * Add a character to a growing buffer.
  *
@@ -301,4 +356,232 @@ extern enum aushape_rc aushape_gbuf_add_buf_json(struct aushape_gbuf *gbuf,
 extern enum aushape_rc aushape_gbuf_add_str_json(struct aushape_gbuf *gbuf,
                                                  const char *str);
 
+/**
+ * Add a CBOR data item head to a growing buffer: the major type with the
+ * argument encoded in the shortest form.
+ *
+ * @param gbuf      The growing buffer to add the head to.
+ * @param major     The item major type.
+ * @param arg       The item argument: value, length, or tag number.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_cbor_head(
+                                        struct aushape_gbuf *gbuf,
+                                        enum aushape_cbor_major major,
+                                        uint64_t arg);
+
+/**
+ * Add a CBOR indefinite-length item head to a growing buffer. The item must
+ * be terminated with AUSHAPE_CBOR_BREAK.
+ *
+ * @param gbuf      The growing buffer to add the head to.
+ * @param major     The item major type: byte or text string, array or map.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_cbor_indef(
+                                        struct aushape_gbuf *gbuf,
+                                        enum aushape_cbor_major major);
+
+/**
+ * Add a double-precision floating point number to a growing buffer, as a
+ * CBOR data item.
+ *
+ * @param gbuf      The growing buffer to add the number to.
+ * @param value     The number to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_double_cbor(struct aushape_gbuf *gbuf,
+                                                    double value);
+
+/**
+ * Add the contents of an abstract buffer to a growing buffer, as a CBOR
+ * byte string.
+ *
+ * @param gbuf      The growing buffer to add the string to.
+ * @param ptr       The pointer to the buffer to add.
+ * @param len       The length of the buffer to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_bytes_cbor(struct aushape_gbuf *gbuf,
+                                                   const void *ptr,
+                                                   size_t len);
+
+/**
+ * Add the contents of an abstract buffer to a growing buffer, as a CBOR
+ * text string if it is valid UTF-8, or as a byte string otherwise.
+ *
+ * @param gbuf      The growing buffer to add the string to.
+ * @param ptr       The pointer to the buffer to add.
+ * @param len       The length of the buffer to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_buf_cbor(struct aushape_gbuf *gbuf,
+                                                 const void *ptr, size_t len);
+
+/**
+ * Add a string to a growing buffer, as a CBOR text string if it is valid
+ * UTF-8, or as a byte string otherwise.
+ *
+ * @param gbuf      The growing buffer to add the string to.
+ * @param str       The string to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_str_cbor(struct aushape_gbuf *gbuf,
+                                                 const char *str);
+
+/**
+ * Add a string to a growing buffer, lowercased, as a CBOR text string if it
+ * is valid UTF-8, or as a byte string otherwise.
+ *
+ * @param gbuf      The growing buffer to add the string to.
+ * @param str       The string to lowercase and add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_str_lowercase_cbor(
+                                                struct aushape_gbuf *gbuf,
+                                                const char *str);
+
+/**
+ * Get the length of a MessagePack item head, as output by
+ * aushape_gbuf_add_msgpack_head.
+ *
+ * @param type      The item type.
+ * @param len       The item length: number of bytes, elements, or pairs.
+ *
+ * @return The head length.
+ */
+extern size_t aushape_gbuf_get_msgpack_head_len(enum aushape_msgpack_type type,
+                                                size_t len);
+
+/**
+ * Add a MessagePack item head to a growing buffer: the type with the length
+ * encoded in the shortest form.
+ *
+ * @param gbuf      The growing buffer to add the head to.
+ * @param type      The item type.
+ * @param len       The item length: number of bytes, elements, or pairs.
+ *                  Cannot exceed UINT32_MAX.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_msgpack_head(
+                                        struct aushape_gbuf *gbuf,
+                                        enum aushape_msgpack_type type,
+                                        size_t len);
+
+/**
+ * Add an unsigned integer to a growing buffer, as a MessagePack integer in
+ * the shortest form.
+ *
+ * @param gbuf      The growing buffer to add the integer to.
+ * @param value     The integer to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_uint_msgpack(struct aushape_gbuf *gbuf,
+                                                     uint64_t value);
+
+/**
+ * Add a time to a growing buffer, as a MessagePack timestamp extension
+ * (type -1) in the shortest form.
+ *
+ * @param gbuf      The growing buffer to add the time to.
+ * @param sec       Seconds since the epoch.
+ * @param nsec      Nanoseconds part, less than one billion.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_time_msgpack(struct aushape_gbuf *gbuf,
+                                                     int64_t sec,
+                                                     uint32_t nsec);
+
+/**
+ * Add the contents of an abstract buffer to a growing buffer, as a
+ * MessagePack binary.
+ *
+ * @param gbuf      The growing buffer to add the binary to.
+ * @param ptr       The pointer to the buffer to add.
+ * @param len       The length of the buffer to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_bytes_msgpack(
+                                                struct aushape_gbuf *gbuf,
+                                                const void *ptr,
+                                                size_t len);
+
+/**
+ * Add the contents of an abstract buffer to a growing buffer, as a
+ * MessagePack string if it is valid UTF-8, or as a binary otherwise.
+ *
+ * @param gbuf      The growing buffer to add the string to.
+ * @param ptr       The pointer to the buffer to add.
+ * @param len       The length of the buffer to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_buf_msgpack(struct aushape_gbuf *gbuf,
+                                                    const void *ptr,
+                                                    size_t len);
+
+/**
+ * Add a string to a growing buffer, as a MessagePack string if it is valid
+ * UTF-8, or as a binary otherwise.
+ *
+ * @param gbuf      The growing buffer to add the string to.
+ * @param str       The string to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_str_msgpack(struct aushape_gbuf *gbuf,
+                                                    const char *str);
+
+/**
+ * Add a string to a growing buffer, lowercased, as a MessagePack string if
+ * it is valid UTF-8, or as a binary otherwise.
+ *
+ * @param gbuf      The growing buffer to add the string to.
+ * @param str       The string to lowercase and add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+extern enum aushape_rc aushape_gbuf_add_str_lowercase_msgpack(
+                                                struct aushape_gbuf *gbuf,
+                                                const char *str);
+
 #endif /* _AUSHAPE_GBUF_H */
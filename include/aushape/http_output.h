@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief HTTP bulk discrete aushape output.
+ *
+ * An implementation of an output sending single-line JSON events to an
+ * Elasticsearch-compatible _bulk endpoint over HTTP/1.1.
+ *
+ * Each event is put into the request body after an "index" action line
+ * naming the target index and a document ID made of the event node, time
+ * and serial number, so a batch sent again after a failure doesn't create
+ * duplicates. Events are accumulated into a batch, and it is sent once it
+ * reaches the specified size, on full synchronization, or by a flusher
+ * thread, once it holds events for the specified maximum latency. The
+ * request body can be compressed with gzip.
+ *
+ * The connection is kept alive between requests and is reopened when the
+ * server closes it, or it fails. If sending fails, or the server responds
+ * with 429 (Too Many Requests), or a 5xx status, the batch is sent again,
+ * after delays doubling from the minimum to the maximum retry delay, and
+ * the output fails only if it couldn't send the batch for the specified
+ * timeout. Other non-2xx responses fail the output immediately. Items the
+ * server rejected in a successful response are counted, but not resent.
+ *
+ * Only plain "http://" URLs are supported.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_HTTP_OUTPUT_H
+#define _AUSHAPE_HTTP_OUTPUT_H
+
+#include <aushape/output.h>
+#include <stdint.h>
+
+/** HTTP bulk output statistics */
+struct aushape_http_output_stats {
+    /** Number of requests sent successfully */
+    uint64_t    requests;
+    /** Number of requests sent again */
+    uint64_t    retries;
+    /** Number of events sent successfully */
+    uint64_t    events;
+    /** Number of events rejected by the server */
+    uint64_t    rejected;
+};
+
+/** HTTP bulk output type */
+extern const struct aushape_output_type aushape_http_output_type;
+
+/**
+ * Create an instance of HTTP bulk output.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param url           Base URL of the server, "http://HOST[:PORT][/PATH]",
+ *                      "/_bulk" is appended to the path.
+ * @param index         Name of the index to put events into.
+ * @param gzip          True if request bodies should be compressed with
+ *                      gzip, false otherwise.
+ * @param batch_size    Size of the request body to send a batch at, bytes,
+ *                      positive.
+ * @param max_latency   Maximum time to keep events in a batch,
+ *                      milliseconds, zero for no limit.
+ * @param retry_min     Delay before the first retry, milliseconds,
+ *                      positive.
+ * @param retry_max     Maximum delay between retries, milliseconds, not
+ *                      less than the minimum.
+ * @param timeout       Time to fail after, if a batch couldn't be sent,
+ *                      milliseconds, zero to never fail. Also limits the
+ *                      time to wait for a single response.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - compressor or flusher thread
+ *                                            creation failed.
+ */
+static inline enum aushape_rc
+aushape_http_output_create(struct aushape_output **poutput,
+                           const char *url,
+                           const char *index,
+                           bool gzip,
+                           size_t batch_size,
+                           unsigned int max_latency,
+                           unsigned int retry_min,
+                           unsigned int retry_max,
+                           unsigned int timeout)
+{
+    if (url == NULL || index == NULL || *index == '\0' ||
+        batch_size == 0 || retry_min == 0 || retry_max < retry_min) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_http_output_type,
+                                 url, index, gzip, batch_size, max_latency,
+                                 retry_min, retry_max, timeout);
+}
+
+/**
+ * Retrieve statistics of an HTTP bulk output.
+ *
+ * @param output    The HTTP bulk output to retrieve statistics of.
+ * @param pstats    Location for the statistics.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - invalid arguments supplied.
+ */
+extern enum aushape_rc aushape_http_output_get_stats(
+                            const struct aushape_output *output,
+                            struct aushape_http_output_stats *pstats);
+
+#endif /* _AUSHAPE_HTTP_OUTPUT_H */
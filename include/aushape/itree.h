@@ -0,0 +1,448 @@
+/**
+ * @brief An intermediate event tree, independent of the output language.
+ *
+ * An event is parsed and its records are collected into intermediate trees
+ * once, and then each output renders them into its own language. The trees
+ * refer to strings and fields stored in a pool shared by all the trees of an
+ * event, by their position, so the pool can grow while the trees are built.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_ITREE_H
+#define _AUSHAPE_ITREE_H
+
+#include <aushape/field_def.h>
+#include <aushape/garr.h>
+#include <aushape/gbuf.h>
+#include <aushape/record_def.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+/** String position meaning "no string" */
+#define AUSHAPE_ITREE_POS_NONE  SIZE_MAX
+
+/** A field in an intermediate tree pool */
+struct aushape_itree_field {
+    /** Position of the field name in the pool text */
+    size_t                  name;
+    /** Position of the "interpreted" value in the pool text */
+    size_t                  value_i;
+    /**
+     * Position of the raw value in the pool text,
+     * same as value_i if the values are the same
+     */
+    size_t                  value_r;
+    /**
+     * True if the raw value should be output along with the interpreted
+     * one, i.e. if it differs and the field is not escaped, false otherwise
+     */
+    bool                    with_raw;
+    /** Kind of the field values */
+    enum aushape_field_kind kind;
+};
+
+/** A pool of strings and fields shared by intermediate trees of an event */
+struct aushape_itree_pool {
+    /** Zero-terminated strings, one after another */
+    struct aushape_gbuf     text;
+    /** Fields (struct aushape_itree_field) */
+    struct aushape_garr     fields;
+};
+
+/** Intermediate tree node type */
+enum aushape_itree_node_type {
+    /** Void node (no node in an array) */
+    AUSHAPE_ITREE_NODE_TYPE_VOID,
+    /** Text string node, e.g. a source text line */
+    AUSHAPE_ITREE_NODE_TYPE_STR,
+    /** Byte string node, e.g. an execve argument */
+    AUSHAPE_ITREE_NODE_TYPE_BYTES,
+    /** Single field node */
+    AUSHAPE_ITREE_NODE_TYPE_FIELD,
+    /** Record node, a map of fields */
+    AUSHAPE_ITREE_NODE_TYPE_RECORD,
+    /** List node, a named list of the nodes of another tree */
+    AUSHAPE_ITREE_NODE_TYPE_LIST,
+};
+
+/** Forward declaration of an intermediate tree */
+struct aushape_itree;
+
+/**
+ * An intermediate tree node.
+ * Zeroed memory constitutes a void node.
+ */
+struct aushape_itree_node {
+    /** Node type */
+    enum aushape_itree_node_type        type;
+    /** Node priority, lower numbers are higher priorities */
+    size_t                              prio;
+    /**
+     * For record nodes - position of the record type name,
+     * for list nodes - position of the list name, in the pool text,
+     * AUSHAPE_ITREE_POS_NONE for others
+     */
+    size_t                              name;
+    /**
+     * For list nodes - position of the name of item elements in the pool
+     * text, for languages which name them, AUSHAPE_ITREE_POS_NONE for others
+     */
+    size_t                              item_name;
+    /**
+     * For string nodes - position of the string in the pool text,
+     * for field nodes - index of the field in the pool,
+     * for record nodes - index of the first field in the pool,
+     * for list nodes - index of the first item node in the list tree
+     */
+    size_t                              pos;
+    /**
+     * For string nodes - length of the string,
+     * for record nodes - number of the fields,
+     * for list nodes - number of the item nodes
+     */
+    size_t                              len;
+    /** For record nodes - record type, as returned by auparse_get_type */
+    int                                 record_type;
+    /** For record nodes - the known record type definition, or NULL */
+    const struct aushape_record_def    *def;
+    /**
+     * For list nodes - the tree with the list items, each having its
+     * priority relative to the list node
+     */
+    const struct aushape_itree         *tree;
+};
+
+/** An intermediate tree */
+struct aushape_itree {
+    /** The pool the nodes refer to */
+    struct aushape_itree_pool  *pool;
+    /** Nodes (struct aushape_itree_node), in output order */
+    struct aushape_garr         nodes;
+};
+
+/**
+ * Check if an intermediate tree pool is valid.
+ *
+ * @param pool  The pool to check.
+ *
+ * @return True if the pool is valid, false otherwise.
+ */
+extern bool aushape_itree_pool_is_valid(
+                        const struct aushape_itree_pool *pool);
+
+/**
+ * Initialize an intermediate tree pool.
+ *
+ * @param pool  The pool to initialize.
+ * @param mem   Memory allocator to use, NULL for the C library one.
+ */
+extern void aushape_itree_pool_init(struct aushape_itree_pool *pool,
+                                    const struct aushape_mem *mem);
+
+/**
+ * Get the memory allocator used by an intermediate tree pool.
+ *
+ * @param pool  The pool to get the allocator of.
+ *
+ * @return The memory allocator, NULL for the C library one.
+ */
+static inline const struct aushape_mem *
+aushape_itree_pool_get_mem(const struct aushape_itree_pool *pool)
+{
+    return pool->text.mem;
+}
+
+/**
+ * Cleanup an intermediate tree pool.
+ *
+ * @param pool  The pool to cleanup.
+ */
+extern void aushape_itree_pool_cleanup(struct aushape_itree_pool *pool);
+
+/**
+ * Empty an intermediate tree pool.
+ *
+ * @param pool  The pool to empty.
+ */
+extern void aushape_itree_pool_empty(struct aushape_itree_pool *pool);
+
+/**
+ * Shrink the memory of an intermediate tree pool down to the smallest size
+ * fitting its current contents.
+ *
+ * @param pool  The pool to shrink.
+ */
+extern void aushape_itree_pool_shrink(struct aushape_itree_pool *pool);
+
+/**
+ * Add the memory usage of an intermediate tree pool to an accumulated usage.
+ *
+ * @param pool  The pool to get memory usage of.
+ * @param usage The accumulated memory usage to add to.
+ */
+extern void aushape_itree_pool_get_mem_usage(
+                        const struct aushape_itree_pool *pool,
+                        struct aushape_mem_usage *usage);
+
+/**
+ * Add a string buffer to an intermediate tree pool, zero-terminated.
+ *
+ * @param pool  The pool to add the string to.
+ * @param ptr   The string buffer to add.
+ * @param len   Length of the string buffer.
+ * @param ppos  Location for the position of the added string.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_itree_pool_add_buf(
+                        struct aushape_itree_pool *pool,
+                        const char *ptr,
+                        size_t len,
+                        size_t *ppos);
+
+/**
+ * Add a string to an intermediate tree pool.
+ *
+ * @param pool  The pool to add the string to.
+ * @param str   The string to add.
+ * @param ppos  Location for the position of the added string.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_itree_pool_add_str(
+                        struct aushape_itree_pool *pool,
+                        const char *str,
+                        size_t *ppos);
+
+/**
+ * Get a string from an intermediate tree pool. The returned pointer is
+ * invalidated by adding to the pool.
+ *
+ * @param pool  The pool to get the string from.
+ * @param pos   Position of the string, as returned when adding it.
+ *
+ * @return The zero-terminated string.
+ */
+static inline const char *
+aushape_itree_pool_get_str(const struct aushape_itree_pool *pool, size_t pos)
+{
+    assert(pos < pool->text.len);
+    return pool->text.ptr + pos;
+}
+
+/**
+ * Add a field to an intermediate tree pool.
+ *
+ * @param pool      The pool to add the field to.
+ * @param field     The field to add, with strings already in the pool.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_itree_pool_add_field(
+                        struct aushape_itree_pool *pool,
+                        const struct aushape_itree_field *field);
+
+/**
+ * Get the number of fields in an intermediate tree pool, i.e. the index the
+ * next added field will have.
+ *
+ * @param pool  The pool to get the number of fields of.
+ *
+ * @return The number of fields.
+ */
+static inline size_t
+aushape_itree_pool_get_field_num(const struct aushape_itree_pool *pool)
+{
+    return aushape_garr_get_len(&pool->fields);
+}
+
+/**
+ * Get a field from an intermediate tree pool. The returned pointer is
+ * invalidated by adding to the pool.
+ *
+ * @param pool  The pool to get the field from.
+ * @param index Index of the field.
+ *
+ * @return The field.
+ */
+static inline const struct aushape_itree_field *
+aushape_itree_pool_get_field(const struct aushape_itree_pool *pool,
+                             size_t index)
+{
+    return aushape_garr_const_get(&pool->fields, index);
+}
+
+/**
+ * Check if an intermediate tree is valid.
+ *
+ * @param itree The tree to check.
+ *
+ * @return True if the tree is valid, false otherwise.
+ */
+extern bool aushape_itree_is_valid(const struct aushape_itree *itree);
+
+/**
+ * Initialize an intermediate tree.
+ *
+ * @param itree     The tree to initialize.
+ * @param pool      The pool the tree nodes will refer to. Must stay valid
+ *                  for the existence of the tree. Its memory allocator is
+ *                  used for the tree.
+ * @param node_min  Initial number of nodes to allocate. Cannot be zero.
+ */
+extern void aushape_itree_init(struct aushape_itree *itree,
+                               struct aushape_itree_pool *pool,
+                               size_t node_min);
+
+/**
+ * Cleanup an intermediate tree.
+ *
+ * @param itree The tree to cleanup.
+ */
+extern void aushape_itree_cleanup(struct aushape_itree *itree);
+
+/**
+ * Empty an intermediate tree.
+ *
+ * @param itree The tree to empty.
+ */
+extern void aushape_itree_empty(struct aushape_itree *itree);
+
+/**
+ * Shrink the memory of an intermediate tree down to the smallest size
+ * fitting its current contents.
+ *
+ * @param itree The tree to shrink.
+ */
+extern void aushape_itree_shrink(struct aushape_itree *itree);
+
+/**
+ * Add the memory usage of an intermediate tree, not including its pool, to
+ * an accumulated usage.
+ *
+ * @param itree The tree to get memory usage of.
+ * @param usage The accumulated memory usage to add to.
+ */
+extern void aushape_itree_get_mem_usage(const struct aushape_itree *itree,
+                                        struct aushape_mem_usage *usage);
+
+/**
+ * Check if an intermediate tree is empty, i.e. if it has no nodes, even
+ * void ones.
+ *
+ * @param itree The tree to check.
+ *
+ * @return True if the tree is empty, false otherwise.
+ */
+static inline bool
+aushape_itree_is_empty(const struct aushape_itree *itree)
+{
+    return aushape_garr_is_empty(&itree->nodes);
+}
+
+/**
+ * Check if an intermediate tree is solid, i.e. if it has no void nodes.
+ *
+ * @param itree The tree to check.
+ *
+ * @return True if the tree is solid, false otherwise.
+ */
+extern bool aushape_itree_is_solid(const struct aushape_itree *itree);
+
+/**
+ * Get the number of nodes in an intermediate tree, including void ones.
+ *
+ * @param itree The tree to get the number of nodes of.
+ *
+ * @return The number of nodes.
+ */
+static inline size_t
+aushape_itree_get_node_num(const struct aushape_itree *itree)
+{
+    return aushape_garr_get_len(&itree->nodes);
+}
+
+/**
+ * Get a node of an intermediate tree.
+ *
+ * @param itree The tree to get the node of.
+ * @param index Index of the node, must be less than the number of nodes.
+ *
+ * @return The node, possibly void.
+ */
+static inline const struct aushape_itree_node *
+aushape_itree_get_node(const struct aushape_itree *itree, size_t index)
+{
+    return aushape_garr_const_get(&itree->nodes, index);
+}
+
+/**
+ * Check if a non-void node exists in an intermediate tree.
+ *
+ * @param itree The tree to check.
+ * @param index Index of the node to check.
+ *
+ * @return True if the node exists, false otherwise.
+ */
+extern bool aushape_itree_node_exists(const struct aushape_itree *itree,
+                                      size_t index);
+
+/**
+ * Put a node into an intermediate tree, replacing the node at the index,
+ * and filling the gap before it with void nodes, if any.
+ *
+ * @param itree The tree to put the node into.
+ * @param index Index to put the node at.
+ * @param node  The node to put, referring to the tree's pool.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - put successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_itree_node_put(
+                            struct aushape_itree *itree,
+                            size_t index,
+                            const struct aushape_itree_node *node);
+
+/**
+ * Add a node to the end of an intermediate tree.
+ *
+ * @param itree The tree to add the node to.
+ * @param node  The node to add, referring to the tree's pool.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static inline enum aushape_rc
+aushape_itree_node_add(struct aushape_itree *itree,
+                       const struct aushape_itree_node *node)
+{
+    return aushape_itree_node_put(itree, aushape_itree_get_node_num(itree),
+                                  node);
+}
+
+#endif /* _AUSHAPE_ITREE_H */
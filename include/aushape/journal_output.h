@@ -0,0 +1,97 @@
+/**
+ * @file
+ * @brief Native journald discrete aushape output.
+ *
+ * An implementation of an output sending discrete output fragments as
+ * systemd journal entries, using the native journald protocol, instead of
+ * syslog. Each entry carries the document, or event, as the MESSAGE field,
+ * along with the PRIORITY, SYSLOG_FACILITY and SYSLOG_IDENTIFIER fields,
+ * and indexed fields describing the events it contains:
+ *
+ *  AUSHAPE_SERIAL  - event serial number,
+ *  AUSHAPE_TIME    - event time, as seconds since epoch, with milliseconds,
+ *  AUSHAPE_NODE    - node the event came from,
+ *  AUSHAPE_TYPE    - type of a record in the event, once per distinct type,
+ *  AUSHAPE_KEY     - audit rule key,
+ *  AUSHAPE_SUBJECT - primary subject of the normalized event,
+ *  AUSHAPE_OBJECT  - primary object of the normalized event.
+ *
+ * A field is repeated for each event in a document, and is omitted if the
+ * event doesn't have it. The fields are only available if the output
+ * receives event notifications with fields from the converter directly, or
+ * through asynchronous or compressed outputs, but not spooling ones.
+ *
+ * Entries are collected into batches and sent with a single sendmmsg(2),
+ * once the batch is full, on full synchronization, or by a flusher thread,
+ * once the oldest entry waits for the specified maximum latency. Entries too
+ * large for a datagram are passed in sealed memory files instead, as
+ * journald expects. Sending waits for journald to accept the entries, and
+ * fails if it's not running.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_JOURNAL_OUTPUT_H
+#define _AUSHAPE_JOURNAL_OUTPUT_H
+
+#include <aushape/output.h>
+
+/** Default path to the journald native protocol socket */
+#define AUSHAPE_JOURNAL_OUTPUT_PATH "/run/systemd/journal/socket"
+
+/** Native journald output type */
+extern const struct aushape_output_type aushape_journal_output_type;
+
+/**
+ * Create an instance of native journald output.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param path          Path to the journald native protocol socket.
+ * @param ident         Identifier to put into the SYSLOG_IDENTIFIER field.
+ * @param facility      Syslog facility, as accepted by openlog(3).
+ * @param priority      Syslog priority, as accepted by syslog(3).
+ * @param batch_size    Number of entries to send at once, positive.
+ * @param max_latency   Maximum time to keep an entry queued, milliseconds,
+ *                      zero for no limit.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - socket or flusher thread
+ *                                            creation failed.
+ */
+static inline enum aushape_rc
+aushape_journal_output_create(struct aushape_output **poutput,
+                              const char *path,
+                              const char *ident,
+                              int facility,
+                              int priority,
+                              size_t batch_size,
+                              unsigned int max_latency)
+{
+    if (path == NULL || ident == NULL || batch_size == 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_journal_output_type,
+                                 path, ident, facility, priority,
+                                 batch_size, max_latency);
+}
+
+#endif /* _AUSHAPE_JOURNAL_OUTPUT_H */
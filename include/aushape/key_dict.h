@@ -0,0 +1,117 @@
+/**
+ * @brief Compact key dictionary
+ *
+ * The dictionary maps every object member name known from aushape.schema.json
+ * to a short key ID, used instead of the name in JSON output with compact
+ * keys. It is generated by key_dict.awk at build time and identified by a
+ * version string, which changes whenever the assignment of IDs does.
+ *
+ * Key IDs are an upper-case letter, optionally followed by another one, or
+ * a digit. Names which are not in the dictionary are output verbatim, unless
+ * they look like a key ID or start with a tilde, in which case they are
+ * prefixed with a tilde.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_KEY_DICT_H
+#define _AUSHAPE_KEY_DICT_H
+
+#include <aushape/gbuf.h>
+#include <aushape/format.h>
+#include <aushape/rc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <unistd.h>
+
+/** Maximum length of a key ID */
+#define AUSHAPE_KEY_DICT_ID_MAX_LEN     2
+
+/** Prefix escaping verbatim names which could be taken for key IDs */
+#define AUSHAPE_KEY_DICT_ESCAPE         '~'
+
+/**
+ * Prefix of the dictionary identification, followed by the version: the
+ * first line of the dictionary sidecar, and the first element of each
+ * compact-key JSON document.
+ */
+#define AUSHAPE_KEY_DICT_MAGIC          "aushape-key-dict "
+
+/** Known key definition */
+struct aushape_key_def {
+    /** Key name, as output without compact keys */
+    const char *name;
+    /** Key ID */
+    const char *id;
+};
+
+/** Dictionary version (generated) */
+extern const char aushape_key_dict_version[];
+
+/** Known key definitions, in key ID order (generated) */
+extern const struct aushape_key_def aushape_key_dict_list[];
+
+/** Indexes of aushape_key_dict_list entries, sorted by name (generated) */
+extern const unsigned short aushape_key_dict_sorted[];
+
+/** Number of known key definitions (generated) */
+extern const size_t aushape_key_dict_num;
+
+/**
+ * Lookup a known key definition by name.
+ *
+ * @param name  The key name to lookup.
+ *
+ * @return The key definition, or NULL if not known.
+ */
+extern const struct aushape_key_def *aushape_key_dict_lookup(
+                                                    const char *name);
+
+/**
+ * Convert a key ID to its index in the known key definitions, whether
+ * there is a definition with that index or not.
+ *
+ * @param id    The key ID to convert, doesn't have to be zero-terminated.
+ * @param len   Length of the key ID.
+ *
+ * @return The key index, or -1 if the string is not a key ID.
+ */
+extern ssize_t aushape_key_dict_id_to_index(const char *id, size_t len);
+
+/**
+ * Output a JSON object member name ("key"), including the quotes, but not
+ * the colon, as a key ID, if the format requests compact keys and the name
+ * is in the dictionary, and as the name otherwise.
+ *
+ * @param gbuf      The growing buffer to add the key to.
+ * @param format    The output format.
+ * @param name      The name to output.
+ * @param lowercase True if the name should be converted to lower case
+ *                  before output, false if not.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_key_dict_add_json(
+                                    struct aushape_gbuf *gbuf,
+                                    const struct aushape_format *format,
+                                    const char *name,
+                                    bool lowercase);
+
+#endif /* _AUSHAPE_KEY_DICT_H */
@@ -30,6 +30,9 @@ enum aushape_lang {
     AUSHAPE_LANG_INVALID, /** Invalid, uninitialized language */
     AUSHAPE_LANG_XML,     /** XML */
     AUSHAPE_LANG_JSON,    /** JSON */
+    AUSHAPE_LANG_CBOR,    /** CBOR (RFC 7049) */
+    AUSHAPE_LANG_MSGPACK, /** MessagePack */
+    AUSHAPE_LANG_ARROW,   /** Apache Arrow IPC stream */
     AUSHAPE_LANG_NUM      /** Number of languages (not a valid language) */
 };
 
@@ -47,4 +50,19 @@ aushape_lang_is_valid(enum aushape_lang lang)
            lang < AUSHAPE_LANG_NUM;
 }
 
+/**
+ * Check if a language is binary, i.e. not text.
+ *
+ * @param lang      The language to check.
+ *
+ * @return True if the language is binary, false otherwise.
+ */
+static inline bool
+aushape_lang_is_binary(enum aushape_lang lang)
+{
+    assert(aushape_lang_is_valid(lang));
+    return lang == AUSHAPE_LANG_CBOR || lang == AUSHAPE_LANG_MSGPACK ||
+           lang == AUSHAPE_LANG_ARROW;
+}
+
 #endif /* _AUSHAPE_LANG_H */
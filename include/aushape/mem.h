@@ -0,0 +1,126 @@
+/**
+ * @brief Pluggable memory allocator.
+ *
+ * Memory allocator hooks let embedders control where conversion buffers are
+ * placed, e.g. in their own arenas. A NULL allocator stands for the standard
+ * C library allocator everywhere an allocator is accepted.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_MEM_H
+#define _AUSHAPE_MEM_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+/** Memory allocator */
+struct aushape_mem {
+    /**
+     * Allocate, reallocate, or free memory, with the semantics of realloc(3)
+     * for non-zero sizes. Must not be NULL.
+     *
+     * @param data  The allocator's opaque data.
+     * @param ptr   The memory to reallocate, or NULL to allocate.
+     * @param size  The size of the memory to (re)allocate, never zero.
+     *
+     * @return The (re)allocated memory, or NULL, if failed.
+     */
+    void   *(*realloc)(void *data, void *ptr, size_t size);
+    /**
+     * Free memory, with the semantics of free(3). Must not be NULL.
+     *
+     * @param data  The allocator's opaque data.
+     * @param ptr   The memory to free, can be NULL.
+     */
+    void    (*free)(void *data, void *ptr);
+    /** Opaque data passed to the hooks */
+    void   *data;
+};
+
+/** Memory usage */
+struct aushape_mem_usage {
+    /** Currently allocated bytes */
+    size_t  size;
+    /**
+     * Peak allocated bytes. For a group of buffers - the sum of their
+     * peaks, which is an upper bound of the group's actual peak.
+     */
+    size_t  peak;
+};
+
+/**
+ * Add memory usage to an accumulated memory usage.
+ *
+ * @param sum   The accumulated usage to add to.
+ * @param usage The usage to add.
+ */
+static inline void
+aushape_mem_usage_add(struct aushape_mem_usage *sum,
+                      const struct aushape_mem_usage *usage)
+{
+    sum->size += usage->size;
+    sum->peak += usage->peak;
+}
+
+/**
+ * Check if a memory allocator is valid.
+ *
+ * @param mem   The allocator to check, NULL means the C library allocator.
+ *
+ * @return True if the allocator is valid, false otherwise.
+ */
+static inline bool
+aushape_mem_is_valid(const struct aushape_mem *mem)
+{
+    return mem == NULL || (mem->realloc != NULL && mem->free != NULL);
+}
+
+/**
+ * Allocate, or reallocate memory with an allocator.
+ *
+ * @param mem   The allocator to use, NULL means the C library allocator.
+ * @param ptr   The memory to reallocate, or NULL to allocate.
+ * @param size  The size of the memory to (re)allocate, cannot be zero.
+ *
+ * @return The (re)allocated memory, or NULL, if failed.
+ */
+static inline void *
+aushape_mem_realloc(const struct aushape_mem *mem, void *ptr, size_t size)
+{
+    return mem == NULL ? realloc(ptr, size)
+                       : mem->realloc(mem->data, ptr, size);
+}
+
+/**
+ * Free memory allocated with an allocator.
+ *
+ * @param mem   The allocator to use, NULL means the C library allocator.
+ * @param ptr   The memory to free, can be NULL.
+ */
+static inline void
+aushape_mem_free(const struct aushape_mem *mem, void *ptr)
+{
+    if (mem == NULL) {
+        free(ptr);
+    } else if (ptr != NULL) {
+        mem->free(mem->data, ptr);
+    }
+}
+
+#endif /* _AUSHAPE_MEM_H */
@@ -32,6 +32,11 @@
 struct aushape_output {
     /** Output type */
     const struct aushape_output_type   *type;
+    /**
+     * True if the output wants descriptive fields with event notifications,
+     * set by the output initialization function.
+     */
+    bool                                event_fields;
 };
 
 /**
@@ -80,6 +85,20 @@ static inline bool aushape_output_is_cont(
     return output->type->cont;
 }
 
+/**
+ * Check if an output wants descriptive fields with event notifications.
+ *
+ * @param output    The output to check. Must be valid.
+ *
+ * @return True if the output wants event fields, false otherwise.
+ */
+static inline bool aushape_output_wants_event_fields(
+                                    const struct aushape_output *output)
+{
+    assert(aushape_output_is_valid(output));
+    return output->event_fields;
+}
+
 /**
  * Write to an output.
  *
@@ -95,6 +114,38 @@ static inline bool aushape_output_is_cont(
 extern enum aushape_rc aushape_output_write(struct aushape_output *output,
                                             const char *ptr, size_t len);
 
+/**
+ * Synchronize an output at a document boundary, see
+ * aushape_output_type_sync_fn.
+ *
+ * @param output    The output to synchronize.
+ * @param full      True if everything written so far should be passed on,
+ *                  false if the output may keep it for now.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - synchronized successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - output-specific write failure.
+ */
+extern enum aushape_rc aushape_output_sync(struct aushape_output *output,
+                                           bool full);
+
+/**
+ * Notify an output of an event about to be written to it, see
+ * aushape_output_type_event_fn.
+ *
+ * @param output    The output to notify.
+ * @param event     The event identification.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - notified successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed.
+ */
+extern enum aushape_rc aushape_output_event(
+                                struct aushape_output *output,
+                                const struct aushape_output_event *event);
+
 /**
  * Cleanup and deallocate an output.
  *
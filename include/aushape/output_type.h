@@ -26,10 +26,34 @@
 #include <stdbool.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <time.h>
 
 /** Forward declaration of the output instance */
 struct aushape_output;
 
+/** Size of the buffer for descriptive fields of an output event, bytes */
+#define AUSHAPE_OUTPUT_EVENT_FIELDS_SIZE    512
+
+/** Identification of an event written to an output */
+struct aushape_output_event {
+    /** Serial number */
+    unsigned long   serial;
+    /** Time: seconds since epoch */
+    time_t          sec;
+    /** Time: milliseconds */
+    unsigned int    msec;
+    /** Length of the descriptive fields below, bytes, zero if none */
+    size_t          fields_len;
+    /**
+     * Descriptive fields, supplied only to outputs wanting them, as
+     * consecutive zero-terminated "name=value" strings. The names are
+     * "node", "type" (once per distinct record type), "key", "subject",
+     * and "object", the latter two from the normalized event. Fields
+     * which don't fit are omitted.
+     */
+    char            fields[AUSHAPE_OUTPUT_EVENT_FIELDS_SIZE];
+};
+
 /**
  * Output initialization function prototype.
  *
@@ -73,6 +97,41 @@ typedef enum aushape_rc (*aushape_output_type_write_fn)(
                                 struct aushape_output *output,
                                 const char *ptr, size_t len);
 
+/**
+ * Output synchronization function prototype. Called at the end of each
+ * document written, or of each event or batch of events, if they're not put
+ * into documents, i.e. whenever the output written so far can be read back
+ * as a whole.
+ *
+ * @param output    The output to synchronize.
+ * @param full      True if everything written so far should be passed on
+ *                  (e.g. the input was exhausted, or is being flushed),
+ *                  false if the output may choose to keep it for now.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - synchronized successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - output-specific write failure.
+ */
+typedef enum aushape_rc (*aushape_output_type_sync_fn)(
+                                struct aushape_output *output,
+                                bool full);
+
+/**
+ * Output event notification function prototype. Called for each event
+ * converted, after the previous synchronization, and before the output
+ * containing the event is synchronized.
+ *
+ * @param output    The output to notify.
+ * @param event     The event identification.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - notified successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed.
+ */
+typedef enum aushape_rc (*aushape_output_type_event_fn)(
+                                struct aushape_output *output,
+                                const struct aushape_output_event *event);
+
 /**
  * Output cleanup function prototype.
  *
@@ -95,6 +154,10 @@ struct aushape_output_type {
     aushape_output_type_is_valid_fn is_valid;
     /** Write function */
     aushape_output_type_write_fn    write;
+    /** Synchronization function, NULL if not needed */
+    aushape_output_type_sync_fn     sync;
+    /** Event notification function, NULL if not needed */
+    aushape_output_type_event_fn    event;
     /** Cleanup function */
     aushape_output_type_cleanup_fn  cleanup;
 };
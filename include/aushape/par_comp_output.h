@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief Parallel compressing aushape output.
+ *
+ * An implementation of an output splitting output into blocks, compressing
+ * them on a pool of worker threads, and writing the resulting gzip members,
+ * or zstd frames, in order, to another, continuous output. The result is a
+ * regular multi-member gzip, or multi-frame zstd stream.
+ *
+ * Like with the (single-threaded) compressing output, a block is ended at
+ * the first document boundary after it accumulates the specified amount of
+ * output, and when the output is fully synchronized. However, to keep the
+ * workers busy with large documents, a block is also ended regardless of
+ * document boundaries once it reaches AUSHAPE_PAR_COMP_OUTPUT_BLOCK_MAX_RATIO
+ * times that amount.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_PAR_COMP_OUTPUT_H
+#define _AUSHAPE_PAR_COMP_OUTPUT_H
+
+#include <aushape/output.h>
+#include <aushape/comp.h>
+
+/**
+ * Ratio of the block size at which a block is ended without waiting for a
+ * document boundary.
+ */
+#define AUSHAPE_PAR_COMP_OUTPUT_BLOCK_MAX_RATIO    4
+
+/** Parallel compressing output type */
+extern const struct aushape_output_type aushape_par_comp_output_type;
+
+/**
+ * Create an instance of parallel compressing output.
+ *
+ * @param poutput       Location for the created output pointer, will be set
+ *                      to NULL in case of error.
+ * @param inner         The continuous output to write compressed output to.
+ * @param inner_owned   True if the inner output should be destroyed upon
+ *                      destruction of the output, false otherwise.
+ * @param comp          Compression algorithm, must be available.
+ * @param level         Compression level, or AUSHAPE_COMP_LEVEL_DEFAULT.
+ * @param block_size    Minimum amount of uncompressed output in a block,
+ *                      bytes. Zero to end a block at every document
+ *                      boundary, and never in the middle of a document.
+ * @param threads       Number of worker threads to compress with, positive.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - compressor initialization, or
+ *                                            thread creation failed.
+ */
+static inline enum aushape_rc
+aushape_par_comp_output_create(struct aushape_output **poutput,
+                               struct aushape_output *inner,
+                               bool inner_owned,
+                               enum aushape_comp comp,
+                               int level,
+                               size_t block_size,
+                               size_t threads)
+{
+    if (!aushape_output_is_valid(inner) ||
+        !aushape_output_is_cont(inner) ||
+        !aushape_comp_is_valid(comp) ||
+        !aushape_comp_is_available(comp) ||
+        !aushape_comp_level_is_valid(comp, level) ||
+        threads == 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_par_comp_output_type,
+                                 inner, inner_owned, comp, level,
+                                 block_size, threads);
+}
+
+#endif /* _AUSHAPE_PAR_COMP_OUTPUT_H */
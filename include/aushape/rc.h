@@ -43,6 +43,10 @@ enum aushape_rc {
     AUSHAPE_RC_OUTPUT_INIT_FAILED,
     /** Output write failed */
     AUSHAPE_RC_OUTPUT_WRITE_FAILED,
+    /** Shared-memory consumer initialization failed */
+    AUSHAPE_RC_SHM_CONSUMER_INIT_FAILED,
+    /** Shared-memory consumer read failed */
+    AUSHAPE_RC_SHM_CONSUMER_READ_FAILED,
     /** Number of return codes (not a valid return code) */
     AUSHAPE_RC_NUM
 };
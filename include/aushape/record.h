@@ -24,56 +24,54 @@
 
 #include <aushape/gbuf.h>
 #include <aushape/format.h>
+#include <aushape/itree.h>
 #include <aushape/rc.h>
-#include <auparse.h>
 
 /**
- * Output auparse record fields to a growing buffer according to a format and
- * syntactic nesting level.
+ * Output intermediate record node fields to a growing buffer according to a
+ * format and syntactic nesting level.
  *
  * @param gbuf      The growing buffer to add the formatted record to.
  * @param format    The output format to use.
  * @param level     Syntactic nesting level the fields are output at.
- * @param au        The auparse state with the current record as the one to
- *                  output fields of.
+ * @param pool      The pool holding the record fields.
+ * @param record    The record node to output fields of.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - output successfully,
  *          AUSHAPE_RC_INVALID_ARGS     - invalid arguments supplied,
- *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed.
  */
 extern enum aushape_rc aushape_record_format_fields(
                                     struct aushape_gbuf *gbuf,
                                     const struct aushape_format *format,
                                     size_t level,
-                                    auparse_state_t *au);
+                                    const struct aushape_itree_pool *pool,
+                                    const struct aushape_itree_node *record);
 
 /**
- * Output an auparse record to a growing buffer according to format and
- * syntactic nesting level.
+ * Output an intermediate record node to a growing buffer according to format
+ * and syntactic nesting level.
  *
  * @param gbuf      The growing buffer to add the formatted record to.
  * @param format    The output format to use.
  * @param level     Syntactic nesting level the record is output at.
  * @param first     True if this is the first record being output for a
  *                  container, false otherwise.
- * @param name      The record container name.
- * @param au        The auparse state with the current record as the one to be
- *                  output.
+ * @param pool      The pool holding the record name and fields.
+ * @param record    The record node to output.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - output successfully,
  *          AUSHAPE_RC_INVALID_ARGS     - invalid arguments supplied,
- *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed.
  */
 extern enum aushape_rc aushape_record_format(
                                     struct aushape_gbuf *gbuf,
                                     const struct aushape_format *format,
                                     size_t level,
                                     bool first,
-                                    const char *name,
-                                    auparse_state_t *au);
+                                    const struct aushape_itree_pool *pool,
+                                    const struct aushape_itree_node *record);
 
 #endif /* _AUSHAPE_RECORD_H */
@@ -0,0 +1,86 @@
+/**
+ * @brief Known record type definitions
+ *
+ * The list of record types output as single records is generated from
+ * aushape.schema.json by record_def.awk at build time, together with their
+ * opening and closing markup pre-formatted for each output language.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_RECORD_DEF_H
+#define _AUSHAPE_RECORD_DEF_H
+
+#include <aushape/lang.h>
+#include <stddef.h>
+
+/** Pre-formatted record markup for a language */
+struct aushape_record_def_markup {
+    /**
+     * Record opening, up to and including the field container opening,
+     * except for MessagePack, where the container head depends on the
+     * number of fields, and is output separately
+     */
+    const char *open;
+    /** Length of the record opening */
+    size_t      open_len;
+    /** Record closing, starting with the field container closing */
+    const char *close;
+    /** Length of the record closing */
+    size_t      close_len;
+};
+
+/**
+ * Initializer of a record markup from two string literals.
+ *
+ * @param _open     Record opening string literal.
+ * @param _close    Record closing string literal.
+ */
+#define AUSHAPE_RECORD_DEF_MARKUP(_open, _close) \
+    {                                           \
+        .open = _open,                          \
+        .open_len = sizeof(_open) - 1,          \
+        .close = _close,                        \
+        .close_len = sizeof(_close) - 1,        \
+    }
+
+/** Known record type definition */
+struct aushape_record_def {
+    /** Record type name, as output by auparse */
+    const char                         *name;
+    /** Pre-formatted markup, indexed by language, empty for Arrow */
+    struct aushape_record_def_markup    markup[AUSHAPE_LANG_NUM];
+};
+
+/** Known record type definitions, sorted by name (generated) */
+extern const struct aushape_record_def aushape_record_def_list[];
+
+/** Number of known record type definitions (generated) */
+extern const size_t aushape_record_def_num;
+
+/**
+ * Lookup a known record type definition.
+ *
+ * @param name  The record type name to lookup.
+ *
+ * @return The record type definition, or NULL if not known.
+ */
+extern const struct aushape_record_def *aushape_record_def_lookup(
+                                                    const char *name);
+
+#endif /* _AUSHAPE_RECORD_DEF_H */
@@ -0,0 +1,190 @@
+/**
+ * @brief Record shape cache
+ *
+ * A record "shape" is the sequence of its field names, together with the
+ * record type and the syntactic nesting level the fields are output at.
+ * Most record types have the same shape in nearly every event. The cache
+ * keeps the output preceding each field's values - separators, whitespace,
+ * and the formatted field name - pre-rendered for the shapes seen recently,
+ * so records of a known shape are output by splicing escaped values into
+ * that skeleton.
+ *
+ * The cache is direct-mapped: a shape is kept in the slot selected by the
+ * hash of its key, replacing whatever shape was there. Pre-rendered output
+ * is only valid for the format it was rendered with, so each cache must be
+ * used with a single format.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_SHAPE_CACHE_H
+#define _AUSHAPE_SHAPE_CACHE_H
+
+#include <aushape/field_def.h>
+#include <aushape/garr.h>
+#include <aushape/gbuf.h>
+#include <aushape/itree.h>
+#include <aushape/mem.h>
+#include <aushape/rc.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Number of shape cache slots, must be a power of two */
+#define AUSHAPE_SHAPE_CACHE_SIZE    64
+
+/** A field of a cached shape */
+struct aushape_shape_field {
+    /** Length of the field name, not including the terminating zero */
+    size_t                  name_len;
+    /** Length of the pre-rendered output preceding the field values */
+    size_t                  skel_len;
+    /** Kind of the field values to output */
+    enum aushape_field_kind kind;
+};
+
+/** A cached record shape */
+struct aushape_shape {
+    /** True if the shape is completely rendered and can be used */
+    bool                complete;
+    /** Hash of the key below */
+    uint32_t            hash;
+    /** Record type, as returned by auparse_get_type */
+    int                 type;
+    /** Syntactic nesting level of the fields */
+    size_t              level;
+    /** Number of the record fields */
+    size_t              field_num;
+    /** Zero-terminated field names, in record order */
+    struct aushape_gbuf names;
+    /** Pre-rendered output preceding the values of each field */
+    struct aushape_gbuf skel;
+    /** Fields (struct aushape_shape_field), in record order */
+    struct aushape_garr fields;
+};
+
+/** Record shape cache */
+struct aushape_shape_cache {
+    /** Shape slots, indexed by the shape hash */
+    struct aushape_shape    slot_list[AUSHAPE_SHAPE_CACHE_SIZE];
+    /** Number of records output using a cached shape */
+    size_t                  hits;
+    /** Number of records output without a cached shape */
+    size_t                  misses;
+};
+
+/**
+ * Check if a shape cache is valid.
+ *
+ * @param cache The cache to check.
+ *
+ * @return True if the cache is valid, false otherwise.
+ */
+extern bool aushape_shape_cache_is_valid(
+                        const struct aushape_shape_cache *cache);
+
+/**
+ * Initialize a shape cache.
+ *
+ * @param cache The cache to initialize.
+ * @param mem   The memory allocator to use, NULL for the C library one.
+ */
+extern void aushape_shape_cache_init(struct aushape_shape_cache *cache,
+                                     const struct aushape_mem *mem);
+
+/**
+ * Cleanup a shape cache (free allocated data).
+ *
+ * @param cache The cache to cleanup.
+ */
+extern void aushape_shape_cache_cleanup(struct aushape_shape_cache *cache);
+
+/**
+ * Shrink the memory of a shape cache's buffers down to the smallest sizes
+ * fitting their current contents.
+ *
+ * @param cache The cache to shrink.
+ */
+extern void aushape_shape_cache_shrink(struct aushape_shape_cache *cache);
+
+/**
+ * Add the memory usage of a shape cache's buffers to an accumulated usage.
+ *
+ * @param cache The cache to get memory usage of.
+ * @param usage The accumulated memory usage to add to.
+ */
+extern void aushape_shape_cache_get_mem_usage(
+                        const struct aushape_shape_cache *cache,
+                        struct aushape_mem_usage *usage);
+
+/**
+ * Get the cache slot for the shape of an intermediate record's fields.
+ * If the slot holds a different, or an incomplete shape, it is emptied and
+ * assigned the record's shape key, for rendering.
+ *
+ * A returned complete shape can still differ from the record in field
+ * names, if their hashes collide. The names must be verified while using
+ * the shape, and the shape emptied with aushape_shape_empty on mismatch.
+ *
+ * @param cache     The cache to get the shape from.
+ * @param level     Syntactic nesting level the fields are output at.
+ * @param pool      The pool holding the record fields.
+ * @param record    The record node to get the shape for.
+ *
+ * @return The shape slot, complete if the shape was cached.
+ */
+extern struct aushape_shape *aushape_shape_cache_get(
+                        struct aushape_shape_cache *cache,
+                        size_t level,
+                        const struct aushape_itree_pool *pool,
+                        const struct aushape_itree_node *record);
+
+/**
+ * Empty a shape, keeping its key, and prepare it for rendering.
+ *
+ * @param shape The shape to empty.
+ */
+extern void aushape_shape_empty(struct aushape_shape *shape);
+
+/**
+ * Add the next field to a shape being rendered.
+ *
+ * @param shape     The shape to add the field to, must not be complete.
+ * @param name      The field name.
+ * @param kind      Kind of the field values to output.
+ * @param skel      The pre-rendered output preceding the field values.
+ * @param skel_len  Length of the pre-rendered output.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+extern enum aushape_rc aushape_shape_add_field(struct aushape_shape *shape,
+                                               const char *name,
+                                               enum aushape_field_kind kind,
+                                               const char *skel,
+                                               size_t skel_len);
+
+/**
+ * Complete rendering of a shape, making it usable, if all its fields were
+ * added.
+ *
+ * @param shape     The shape to complete.
+ */
+extern void aushape_shape_complete(struct aushape_shape *shape);
+
+#endif /* _AUSHAPE_SHAPE_CACHE_H */
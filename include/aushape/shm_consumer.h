@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @brief Shared-memory ring consumer.
+ *
+ * A consumer of items appended to the ring of a shared-memory output (see
+ * aushape/shm_output.h), reading them in place. A consumer receives every
+ * item appended after it connected, unless dropped by the output, and
+ * holds each item it retrieves, keeping the output from overwriting it,
+ * until it retrieves the next one. A slow consumer thus slows down the
+ * output, or makes it drop items, depending on its configuration.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_SHM_CONSUMER_H
+#define _AUSHAPE_SHM_CONSUMER_H
+
+#include <aushape/rc.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Shared-memory consumer (opaque) */
+struct aushape_shm_consumer;
+
+/**
+ * Connect a consumer to a shared-memory output.
+ *
+ * @param pconsumer Location for the created consumer pointer, will be set
+ *                  to NULL in case of error.
+ * @param path      Path to the Unix socket the output accepts consumers on.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                       - connected successfully,
+ *          AUSHAPE_RC_INVALID_ARGS             - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                    - failed allocating memory,
+ *          AUSHAPE_RC_SHM_CONSUMER_INIT_FAILED - connecting, or mapping the
+ *                                                ring failed, or the ring
+ *                                                is invalid.
+ */
+extern enum aushape_rc aushape_shm_consumer_open(
+                                struct aushape_shm_consumer **pconsumer,
+                                const char *path);
+
+/**
+ * Check if a shared-memory consumer is valid.
+ *
+ * @param consumer  The consumer to check.
+ *
+ * @return True if the consumer is valid, false otherwise.
+ */
+extern bool aushape_shm_consumer_is_valid(
+                                const struct aushape_shm_consumer *consumer);
+
+/**
+ * Get the file descriptor becoming readable when a shared-memory consumer
+ * is woken up, for use with poll(2) and similar, before calling
+ * aushape_shm_consumer_next with zero timeout.
+ *
+ * @param consumer  The consumer to get the file descriptor of.
+ *
+ * @return The file descriptor.
+ */
+extern int aushape_shm_consumer_get_fd(
+                                const struct aushape_shm_consumer *consumer);
+
+/**
+ * Release the item retrieved previously, if any, and retrieve the next item
+ * from a shared-memory consumer, waiting for it, if necessary.
+ *
+ * @param consumer  The consumer to retrieve the item from.
+ * @param timeout   Maximum time to wait for an item, milliseconds, or a
+ *                  negative number to wait indefinitely.
+ * @param pptr      Location for the pointer to the item contents in the
+ *                  ring, set to NULL, if no item arrived before the timeout,
+ *                  or the output was destroyed. Valid until the next call.
+ * @param plen      Location for the item length, can be NULL.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                       - retrieved successfully, or
+ *                                                no item arrived,
+ *          AUSHAPE_RC_INVALID_ARGS             - invalid arguments supplied,
+ *          AUSHAPE_RC_SHM_CONSUMER_READ_FAILED - waiting failed, or the ring
+ *                                                is corrupted.
+ */
+extern enum aushape_rc aushape_shm_consumer_next(
+                                struct aushape_shm_consumer *consumer,
+                                int timeout,
+                                const void **pptr,
+                                size_t *plen);
+
+/**
+ * Check if a shared-memory consumer has no items left, and will receive no
+ * more, because the output was destroyed.
+ *
+ * @param consumer  The consumer to check.
+ *
+ * @return True if the consumer is exhausted, false otherwise.
+ */
+extern bool aushape_shm_consumer_is_closed(
+                                const struct aushape_shm_consumer *consumer);
+
+/**
+ * Disconnect a shared-memory consumer and free it, releasing its slot.
+ *
+ * @param consumer  The consumer to close, can be NULL.
+ */
+extern void aushape_shm_consumer_close(struct aushape_shm_consumer *consumer);
+
+#endif /* _AUSHAPE_SHM_CONSUMER_H */
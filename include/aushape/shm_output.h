@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief Shared-memory ring discrete aushape output.
+ *
+ * An implementation of an output appending discrete output fragments, i.e.
+ * documents or events, to a ring in a memory file shared with co-located
+ * consumers, which read them in place, without copying, or system calls
+ * per item. The ring has a single producer and many consumers, each
+ * reading every item appended after it connected, at its own pace, and
+ * woken up with its own eventfd, only when it waits for items. See
+ * aushape/shm_consumer.h for the consumer interface.
+ *
+ * Consumers connect to a Unix socket the output listens on, which is
+ * created at the specified path, replacing any existing file, and is
+ * removed when the output is destroyed. A thread accepts connections and
+ * frees slots of consumers which disconnect.
+ *
+ * If the ring has no space for an item, because a consumer lags behind, the
+ * output either waits for the space, or drops the item. Items larger than
+ * the ring are dropped.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_SHM_OUTPUT_H
+#define _AUSHAPE_SHM_OUTPUT_H
+
+#include <aushape/output.h>
+#include <stdint.h>
+
+/** Shared-memory output statistics */
+struct aushape_shm_output_stats {
+    /** Number of items appended */
+    uint64_t    appended;
+    /** Number of times the ring was full */
+    uint64_t    full;
+    /** Number of items dropped */
+    uint64_t    dropped;
+};
+
+/** Shared-memory output type */
+extern const struct aushape_output_type aushape_shm_output_type;
+
+/**
+ * Create an instance of shared-memory output.
+ *
+ * @param poutput   Location for the created output pointer, will be set to
+ *                  NULL in case of error.
+ * @param path      Path to the Unix socket to accept consumers on.
+ * @param size      Size of the ring data area, bytes, rounded up to a power
+ *                  of two, at least 4096.
+ * @param block     True if the output should wait for space in the ring,
+ *                  false if items should be dropped when it's full.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - memory file, socket or thread
+ *                                            creation failed.
+ */
+static inline enum aushape_rc
+aushape_shm_output_create(struct aushape_output **poutput,
+                          const char *path,
+                          size_t size,
+                          bool block)
+{
+    if (path == NULL || size < 4096 || size > SIZE_MAX / 4) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_shm_output_type,
+                                 path, size, block);
+}
+
+/**
+ * Retrieve statistics of a shared-memory output.
+ *
+ * @param output    The shared-memory output to retrieve statistics of.
+ * @param pstats    Location for the statistics.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - invalid arguments supplied.
+ */
+extern enum aushape_rc aushape_shm_output_get_stats(
+                            const struct aushape_output *output,
+                            struct aushape_shm_output_stats *pstats);
+
+#endif /* _AUSHAPE_SHM_OUTPUT_H */
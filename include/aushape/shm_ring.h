@@ -0,0 +1,122 @@
+/**
+ * @file
+ * @brief Shared-memory ring layout.
+ *
+ * The ring shared by a shared-memory output and its consumers is a memory
+ * file starting with struct aushape_shm_ring, followed by the data area of
+ * a power-of-two size. The producer appends items to the data area, each
+ * made of a 32-bit length, 32 reserved bits, and the item contents, padded
+ * to AUSHAPE_SHM_RING_ALIGN bytes. An item which doesn't fit before the end
+ * of the data area is preceded by a length of AUSHAPE_SHM_RING_WRAP, and
+ * starts at the beginning.
+ *
+ * Positions in the ring are byte counts since its creation, the offset in
+ * the data area being the position modulo its size. The producer publishes
+ * appended items by advancing the head position, and each consumer
+ * publishes the items it's done with by advancing its cursor position in
+ * its slot. The producer never overwrites items an active consumer hasn't
+ * consumed. A consumer about to sleep sets the "waiting" flag of its slot,
+ * and the producer writes to the consumer's eventfd, if it finds the flag
+ * set after advancing the head.
+ *
+ * Consumers connect to the producer's Unix sequenced-packet socket, and
+ * receive a message with their 32-bit slot index and two file descriptors
+ * attached: the memory file and their eventfd. The slot is freed once the
+ * consumer closes the connection.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_SHM_RING_H
+#define _AUSHAPE_SHM_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Magic string starting the ring */
+#define AUSHAPE_SHM_RING_MAGIC          "aushring"
+/** Ring layout version */
+#define AUSHAPE_SHM_RING_VERSION        1
+/** Maximum number of consumers */
+#define AUSHAPE_SHM_RING_CONSUMER_NUM   32
+/** Size of an item header */
+#define AUSHAPE_SHM_RING_HDR_SIZE       8
+/** Alignment of items */
+#define AUSHAPE_SHM_RING_ALIGN          8
+/** Item length marking the rest of the data area skipped */
+#define AUSHAPE_SHM_RING_WRAP           UINT32_MAX
+
+/** Consumer slot, taking a cache line */
+struct aushape_shm_ring_consumer {
+    /** Position of the next item to consume, written by the consumer */
+    uint64_t    cursor;
+    /** Non-zero if the slot is taken, written by the producer */
+    uint32_t    active;
+    /** Non-zero if the consumer waits for a wakeup */
+    uint32_t    waiting;
+    uint8_t     pad[48];
+};
+
+/** Ring header, with the fields written by the producer apart */
+struct aushape_shm_ring {
+    /** AUSHAPE_SHM_RING_MAGIC, without the terminating zero */
+    char        magic[8];
+    /** AUSHAPE_SHM_RING_VERSION */
+    uint32_t    version;
+    /** Non-zero if the producer won't append any more items */
+    uint32_t    closed;
+    /** Size of the data area, a power of two */
+    uint64_t    size;
+    uint8_t     pad1[40];
+    /** Position after the last published item */
+    uint64_t    head;
+    uint8_t     pad2[56];
+    /** Consumer slots */
+    struct aushape_shm_ring_consumer consumer_list[
+                                        AUSHAPE_SHM_RING_CONSUMER_NUM];
+};
+
+/**
+ * Get the size an item takes in the ring data area.
+ *
+ * @param len   The item contents length.
+ *
+ * @return The item size, including the header and padding.
+ */
+static inline uint64_t
+aushape_shm_ring_item_size(size_t len)
+{
+    return AUSHAPE_SHM_RING_HDR_SIZE +
+           (((uint64_t)len + AUSHAPE_SHM_RING_ALIGN - 1) &
+            ~(uint64_t)(AUSHAPE_SHM_RING_ALIGN - 1));
+}
+
+/**
+ * Get the data area of a ring.
+ *
+ * @param ring  The ring to get the data area of.
+ *
+ * @return The data area.
+ */
+static inline char *
+aushape_shm_ring_data(struct aushape_shm_ring *ring)
+{
+    return (char *)(ring + 1);
+}
+
+#endif /* _AUSHAPE_SHM_RING_H */
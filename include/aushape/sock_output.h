@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief Socket aushape output.
+ *
+ * An implementation of an output sending output to a Unix stream or
+ * datagram socket, or a TCP connection, e.g. to a local log collector.
+ *
+ * Output is accumulated in a buffer and sent in batches: with a single
+ * send(2) on stream sockets, and with a single sendmmsg(2), one datagram
+ * per document, or event, on datagram sockets. The buffer is sent once it
+ * can't fit more output, on full synchronization, and by a flusher thread,
+ * once it holds output for the specified maximum latency.
+ *
+ * Output sent to stream sockets is either continuous, or, with length
+ * framing, has each document, or event, prefixed with its length, as a
+ * four-byte big-endian unsigned integer, for the receiver to split it
+ * without parsing.
+ *
+ * The socket is connected without blocking on the first batch, and
+ * reconnected after it fails, with delays between attempts doubling from
+ * the minimum to the maximum retry delay. Meanwhile, the output waits,
+ * and fails only if it couldn't send a batch for the specified timeout.
+ * After reconnecting, the output is resent from the start of the first
+ * document it didn't finish sending, if it's still in the buffer, so the
+ * receiver always gets whole documents on a new connection, unless they
+ * don't fit into the buffer. Output accepted by the system before the
+ * failure, but not yet received, is lost.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_SOCK_OUTPUT_H
+#define _AUSHAPE_SOCK_OUTPUT_H
+
+#include <aushape/output.h>
+
+/** Socket protocol */
+enum aushape_sock_output_proto {
+    AUSHAPE_SOCK_OUTPUT_PROTO_INVALID,
+    /** Unix stream socket, address is a path */
+    AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_STREAM,
+    /** Unix datagram socket, address is a path */
+    AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_DGRAM,
+    /** TCP, address is "HOST:PORT", or "[HOST]:PORT" */
+    AUSHAPE_SOCK_OUTPUT_PROTO_TCP,
+    AUSHAPE_SOCK_OUTPUT_PROTO_NUM
+};
+
+/**
+ * Check if a socket protocol is valid.
+ *
+ * @param proto The protocol to check.
+ *
+ * @return True if the protocol is valid, false otherwise.
+ */
+static inline bool
+aushape_sock_output_proto_is_valid(enum aushape_sock_output_proto proto)
+{
+    return proto > AUSHAPE_SOCK_OUTPUT_PROTO_INVALID &&
+           proto < AUSHAPE_SOCK_OUTPUT_PROTO_NUM;
+}
+
+/** Socket output type, for continuous stream output */
+extern const struct aushape_output_type aushape_sock_output_type;
+
+/** Socket output type, for datagrams or length-framed stream output */
+extern const struct aushape_output_type aushape_sock_disc_output_type;
+
+/**
+ * Create an instance of socket output. The output is discrete, if the
+ * socket is a datagram one, or the output is length-framed, and is
+ * continuous otherwise.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param proto         Socket protocol.
+ * @param addr          Address to connect to, see the protocols.
+ * @param framed        True if documents sent to a stream socket should
+ *                      be prefixed with their length, false otherwise.
+ *                      Must be false for datagram sockets.
+ * @param buf_size      Size of the buffer to accumulate a batch in, bytes,
+ *                      positive.
+ * @param max_latency   Maximum time to keep output in the buffer,
+ *                      milliseconds, zero for no limit.
+ * @param retry_min     Delay before the first reconnection attempt,
+ *                      milliseconds, positive.
+ * @param retry_max     Maximum delay between reconnection attempts,
+ *                      milliseconds, not less than the minimum.
+ * @param timeout       Time to fail after, if a batch couldn't be sent,
+ *                      milliseconds, zero to never fail.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - flusher thread creation
+ *                                            failed.
+ */
+static inline enum aushape_rc
+aushape_sock_output_create(struct aushape_output **poutput,
+                           enum aushape_sock_output_proto proto,
+                           const char *addr,
+                           bool framed,
+                           size_t buf_size,
+                           unsigned int max_latency,
+                           unsigned int retry_min,
+                           unsigned int retry_max,
+                           unsigned int timeout)
+{
+    bool dgram = proto == AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_DGRAM;
+    if (!aushape_sock_output_proto_is_valid(proto) ||
+        addr == NULL || (dgram && framed) || buf_size == 0 ||
+        retry_min == 0 || retry_max < retry_min) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput,
+                                 (dgram || framed)
+                                    ? &aushape_sock_disc_output_type
+                                    : &aushape_sock_output_type,
+                                 proto, addr, framed, buf_size, max_latency,
+                                 retry_min, retry_max, timeout);
+}
+
+#endif /* _AUSHAPE_SOCK_OUTPUT_H */
@@ -0,0 +1,188 @@
+/**
+ * @file
+ * @brief Disk-spooling aushape output.
+ *
+ * An implementation of an output appending output to segment files in a
+ * spool directory, and passing it from there to another output on a
+ * dedicated writer thread, in order, so the conversion neither waits for,
+ * nor loses output to an inner output which is slow or failing.
+ *
+ * Output is appended in records, each ended at a document boundary, i.e.
+ * where the converter synchronizes the output, or, with continuous inner
+ * outputs, once it accumulates AUSHAPE_SPOOL_OUTPUT_REC_SIZE bytes in the
+ * middle of a document. Event notifications are recorded with the output
+ * they belong to. Segments are started once they reach the segment size,
+ * and removed once written out and confirmed.
+ *
+ * Records written to the inner output are only confirmed by its full
+ * synchronization, done before each periodic checkpoint, and before
+ * removing a segment. When writing to, or synchronizing the inner output
+ * fails, the records written since the last confirmation are retried after
+ * a delay, so only inner outputs able to recover from failures recover
+ * without a restart.
+ *
+ * The position of the confirmed records is checkpointed to a cursor file
+ * in the spool directory, so output left in the spool, e.g. when the inner
+ * output fails, is written out after the spool is opened again. Since
+ * checkpoints are made periodically, some output might be written out
+ * again after that.
+ *
+ * Disk usage is limited to a maximum size, after reaching which the output
+ * either blocks until the writer removes a segment, drops the new record,
+ * or drops the oldest segments. A single record is written even if bigger
+ * than the limit, provided the spool is empty otherwise.
+ *
+ * Full synchronization makes the spooled output durable, and has the
+ * writer fully synchronize the inner output, once it writes everything
+ * out, but doesn't wait for that.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_SPOOL_OUTPUT_H
+#define _AUSHAPE_SPOOL_OUTPUT_H
+
+#include <aushape/output.h>
+#include <stdint.h>
+
+/**
+ * Amount of output accumulated in a record, at which it is appended
+ * without waiting for a document boundary, bytes.
+ */
+#define AUSHAPE_SPOOL_OUTPUT_REC_SIZE   (64 * 1024)
+
+/** Full spool policy */
+enum aushape_spool_output_policy {
+    AUSHAPE_SPOOL_OUTPUT_POLICY_INVALID,
+    /** Wait for the writer to remove a segment */
+    AUSHAPE_SPOOL_OUTPUT_POLICY_BLOCK,
+    /** Drop the new record */
+    AUSHAPE_SPOOL_OUTPUT_POLICY_DROP_NEWEST,
+    /** Drop the oldest segments */
+    AUSHAPE_SPOOL_OUTPUT_POLICY_DROP_OLDEST,
+    AUSHAPE_SPOOL_OUTPUT_POLICY_NUM
+};
+
+/**
+ * Check if a full spool policy is valid.
+ *
+ * @param policy    The policy to check.
+ *
+ * @return True if the policy is valid, false otherwise.
+ */
+static inline bool
+aushape_spool_output_policy_is_valid(enum aushape_spool_output_policy policy)
+{
+    return policy > AUSHAPE_SPOOL_OUTPUT_POLICY_INVALID &&
+           policy < AUSHAPE_SPOOL_OUTPUT_POLICY_NUM;
+}
+
+/** Spooling output statistics */
+struct aushape_spool_output_stats {
+    /** Size of the segment files, bytes */
+    uint64_t    size;
+    /** Number of segments, including written, but not yet removed */
+    uint64_t    segments;
+    /** Number of times the spool was full */
+    uint64_t    full;
+    /** Number of times the output waited for the writer to remove a segment */
+    uint64_t    stalls;
+    /** Amount of output dropped, bytes */
+    uint64_t    dropped;
+    /** Number of segments skipped past a damaged record */
+    uint64_t    damaged;
+    /** Number of failed attempts to write to the inner output */
+    uint64_t    failures;
+    /** Number of records written to the inner output */
+    uint64_t    written;
+};
+
+/** Spooling output type, for continuous inner outputs */
+extern const struct aushape_output_type aushape_spool_output_type;
+
+/** Spooling output type, for discrete inner outputs */
+extern const struct aushape_output_type aushape_spool_disc_output_type;
+
+/**
+ * Create an instance of spooling output. The output is continuous if the
+ * inner output is, and discrete otherwise. The spool directory is created,
+ * if it doesn't exist, and is locked against opening by another output,
+ * until the output is destroyed.
+ *
+ * @param poutput       Location for the created output pointer, will be set
+ *                      to NULL in case of error.
+ * @param inner         The output to write spooled output to on the writer
+ *                      thread.
+ * @param inner_owned   True if the inner output should be destroyed upon
+ *                      destruction of the output, false otherwise.
+ * @param dir           Path to the spool directory.
+ * @param max_size      Maximum size of the segment files, bytes.
+ * @param segment_size  Size of the segment file at which a new one is
+ *                      started, bytes, positive, not greater than half of
+ *                      the maximum size.
+ * @param retry         Delay before retrying a failed write to the inner
+ *                      output, milliseconds.
+ * @param policy        Full spool policy.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - opening or locking the spool,
+ *                                            or starting the writer
+ *                                            failed.
+ */
+static inline enum aushape_rc
+aushape_spool_output_create(struct aushape_output **poutput,
+                            struct aushape_output *inner,
+                            bool inner_owned,
+                            const char *dir,
+                            uint64_t max_size,
+                            uint64_t segment_size,
+                            unsigned int retry,
+                            enum aushape_spool_output_policy policy)
+{
+    if (!aushape_output_is_valid(inner) ||
+        dir == NULL ||
+        segment_size == 0 || segment_size > max_size / 2 ||
+        !aushape_spool_output_policy_is_valid(policy)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput,
+                                 aushape_output_is_cont(inner)
+                                    ? &aushape_spool_output_type
+                                    : &aushape_spool_disc_output_type,
+                                 inner, inner_owned, dir,
+                                 max_size, segment_size, retry, policy);
+}
+
+/**
+ * Retrieve statistics of a spooling output.
+ *
+ * @param output    The spooling output to retrieve statistics of.
+ * @param pstats    Location for the statistics.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK           - retrieved successfully,
+ *          AUSHAPE_RC_INVALID_ARGS - invalid arguments supplied.
+ */
+extern enum aushape_rc aushape_spool_output_get_stats(
+                            const struct aushape_output *output,
+                            struct aushape_spool_output_stats *pstats);
+
+#endif /* _AUSHAPE_SPOOL_OUTPUT_H */
@@ -0,0 +1,100 @@
+/**
+ * @file
+ * @brief SQLite discrete aushape output.
+ *
+ * An implementation of an output inserting JSON events into an SQLite
+ * database, creating these tables, if they don't exist:
+ *
+ *  event   - one row per event: "id" (row ID), "serial", "time" (seconds
+ *            since epoch, with milliseconds), "node" (empty if missing),
+ *            "key" (audit rule key), and "json" (the event as output),
+ *            unique by node, serial and time.
+ *  record  - one row per record: "event" (the event row ID), "type"
+ *            (record type name), and "json" (the record data as output).
+ *
+ * Records are extracted from the "data" object of the events by SQLite
+ * itself, so events must be output with full key names. The node and the
+ * key are only available if the output receives event notifications with
+ * fields from the converter directly, or through asynchronous outputs.
+ *
+ * The database is switched to write-ahead logging. Events are inserted with
+ * prepared statements in transactions, committed once they hold the
+ * specified number of events, on synchronization, or by a flusher thread,
+ * once they're open for the specified maximum latency. Events already in
+ * the database, e.g. when the same log is converted again, are skipped
+ * together with their records, using a unique key on the event node,
+ * serial and time created with the tables. Events without serial and time,
+ * i.e. without event notifications, are never considered the same.
+ * Indexes on the event time, serial and key, and on the record event and
+ * type are created after the bulk load: on the first full synchronization,
+ * or on cleanup.
+ *
+ * The output is only available if the library is built with SQLite.
+ */
+/*
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUSHAPE_SQLITE_OUTPUT_H
+#define _AUSHAPE_SQLITE_OUTPUT_H
+
+#include <aushape/output.h>
+
+/** SQLite output type */
+extern const struct aushape_output_type aushape_sqlite_output_type;
+
+/**
+ * Check if SQLite output is supported by the library build.
+ *
+ * @return True if SQLite output is supported, false otherwise.
+ */
+extern bool aushape_sqlite_output_is_available(void);
+
+/**
+ * Create an instance of SQLite output.
+ *
+ * @param poutput       Location for the created output pointer, will be
+ *                      set to NULL in case of error.
+ * @param path          Path to the database file, created if missing.
+ * @param batch_size    Number of events to insert in a transaction,
+ *                      positive.
+ * @param max_latency   Maximum time to keep a transaction open,
+ *                      milliseconds, zero for no limit.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - output created successfully,
+ *          AUSHAPE_RC_INVALID_ARGS         - invalid arguments supplied,
+ *          AUSHAPE_RC_NOMEM                - failed allocating memory,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - SQLite output is not
+ *                                            supported, or opening the
+ *                                            database, or flusher thread
+ *                                            creation failed.
+ */
+static inline enum aushape_rc
+aushape_sqlite_output_create(struct aushape_output **poutput,
+                             const char *path,
+                             size_t batch_size,
+                             unsigned int max_latency)
+{
+    if (path == NULL || batch_size == 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    return aushape_output_create(poutput, &aushape_sqlite_output_type,
+                                 path, batch_size, max_latency);
+}
+
+#endif /* _AUSHAPE_SQLITE_OUTPUT_H */
@@ -0,0 +1,287 @@
+/*
+ * Memory arena.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/arena.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+/** Alignment of arena allocations and headers */
+#define AUSHAPE_ARENA_ALIGN     16
+
+/** Round a size up to the arena alignment */
+#define AUSHAPE_ARENA_ROUND(_size) \
+    (((_size) + AUSHAPE_ARENA_ALIGN - 1) & ~(size_t)(AUSHAPE_ARENA_ALIGN - 1))
+
+/** Arena block, followed by allocations, each prefixed with its size */
+struct aushape_arena_block {
+    /** Previously allocated block, or NULL */
+    struct aushape_arena_block *prev;
+    /** Size of the block space after the (aligned) block header */
+    size_t                      size;
+    /** Used block space */
+    size_t                      used;
+};
+
+/** Size of the (aligned) block header */
+#define AUSHAPE_ARENA_BLOCK_HDR_SIZE \
+    AUSHAPE_ARENA_ROUND(sizeof(struct aushape_arena_block))
+
+/** Size of the (aligned) allocation header */
+#define AUSHAPE_ARENA_ALLOC_HDR_SIZE \
+    AUSHAPE_ARENA_ROUND(sizeof(size_t))
+
+struct aushape_arena {
+    /** Allocator interface to the arena */
+    struct aushape_mem          mem;
+    /** Size of blocks to allocate */
+    size_t                      block_size;
+    /** Total size of allocated blocks */
+    size_t                      size;
+    /** Current block to allocate from, or NULL */
+    struct aushape_arena_block *block;
+};
+
+/**
+ * Get the start of a block's allocation space.
+ *
+ * @param block The block to get the space of.
+ *
+ * @return The start of the block space.
+ */
+static char *
+aushape_arena_block_space(struct aushape_arena_block *block)
+{
+    return (char *)block + AUSHAPE_ARENA_BLOCK_HDR_SIZE;
+}
+
+/**
+ * Get a pointer to the size of an arena allocation.
+ *
+ * @param ptr   The allocation to get the size pointer of.
+ *
+ * @return The allocation size pointer.
+ */
+static size_t *
+aushape_arena_alloc_psize(void *ptr)
+{
+    return (size_t *)((char *)ptr - AUSHAPE_ARENA_ALLOC_HDR_SIZE);
+}
+
+/**
+ * Check if an allocation is the last one in the current arena block.
+ *
+ * @param arena The arena to check the allocation in.
+ * @param ptr   The allocation to check.
+ *
+ * @return True if the allocation is the last one, false otherwise.
+ */
+static bool
+aushape_arena_is_last(const struct aushape_arena *arena, void *ptr)
+{
+    struct aushape_arena_block *block = arena->block;
+    return block != NULL &&
+           (char *)ptr + *aushape_arena_alloc_psize(ptr) ==
+                aushape_arena_block_space(block) + block->used;
+}
+
+/**
+ * Allocate memory from an arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param size  The size to allocate, aligned.
+ *
+ * @return The allocated memory, or NULL if failed.
+ */
+static void *
+aushape_arena_alloc(struct aushape_arena *arena, size_t size)
+{
+    struct aushape_arena_block *block = arena->block;
+    size_t full_size = AUSHAPE_ARENA_ALLOC_HDR_SIZE + size;
+    char *ptr;
+
+    if (full_size < size) {
+        return NULL;
+    }
+
+    /* If there's no space in the current block, start a new one */
+    if (block == NULL || block->size - block->used < full_size) {
+        size_t block_size = full_size > arena->block_size
+                                ? full_size
+                                : arena->block_size;
+        if (block_size > SIZE_MAX - AUSHAPE_ARENA_BLOCK_HDR_SIZE) {
+            return NULL;
+        }
+        block = malloc(AUSHAPE_ARENA_BLOCK_HDR_SIZE + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->prev = arena->block;
+        block->size = block_size;
+        block->used = 0;
+        arena->block = block;
+        arena->size += AUSHAPE_ARENA_BLOCK_HDR_SIZE + block_size;
+    }
+
+    ptr = aushape_arena_block_space(block) + block->used +
+            AUSHAPE_ARENA_ALLOC_HDR_SIZE;
+    *aushape_arena_alloc_psize(ptr) = size;
+    block->used += full_size;
+    return ptr;
+}
+
+/**
+ * Free memory allocated from an arena. Only the last allocation of the
+ * current block is actually returned to the arena.
+ *
+ * @param data  The arena to free the memory in.
+ * @param ptr   The memory to free.
+ */
+static void
+aushape_arena_free(void *data, void *ptr)
+{
+    struct aushape_arena *arena = (struct aushape_arena *)data;
+
+    assert(aushape_arena_is_valid(arena));
+    assert(ptr != NULL);
+
+    if (aushape_arena_is_last(arena, ptr)) {
+        arena->block->used -= AUSHAPE_ARENA_ALLOC_HDR_SIZE +
+                              *aushape_arena_alloc_psize(ptr);
+    }
+}
+
+/**
+ * Allocate or reallocate memory in an arena. The last allocation of the
+ * current block is extended in place, if there's space left.
+ *
+ * @param data  The arena to allocate the memory in.
+ * @param ptr   The memory to reallocate, or NULL to allocate.
+ * @param size  The size to (re)allocate.
+ *
+ * @return The (re)allocated memory, or NULL if failed.
+ */
+static void *
+aushape_arena_realloc(void *data, void *ptr, size_t size)
+{
+    struct aushape_arena *arena = (struct aushape_arena *)data;
+    size_t old_size;
+    void *new_ptr;
+
+    assert(aushape_arena_is_valid(arena));
+    assert(size != 0);
+
+    if (size > SIZE_MAX - AUSHAPE_ARENA_ALIGN) {
+        return NULL;
+    }
+    size = AUSHAPE_ARENA_ROUND(size);
+
+    if (ptr == NULL) {
+        return aushape_arena_alloc(arena, size);
+    }
+
+    old_size = *aushape_arena_alloc_psize(ptr);
+    if (size <= old_size) {
+        return ptr;
+    }
+
+    /* Extend in place, if possible */
+    if (aushape_arena_is_last(arena, ptr) &&
+        arena->block->size - arena->block->used >= size - old_size) {
+        arena->block->used += size - old_size;
+        *aushape_arena_alloc_psize(ptr) = size;
+        return ptr;
+    }
+
+    new_ptr = aushape_arena_alloc(arena, size);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, old_size);
+    }
+    return new_ptr;
+}
+
+enum aushape_rc
+aushape_arena_create(struct aushape_arena **parena, size_t block_size)
+{
+    struct aushape_arena *arena;
+
+    if (parena == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    arena = calloc(1, sizeof(*arena));
+    if (arena == NULL) {
+        return AUSHAPE_RC_NOMEM;
+    }
+
+    arena->mem.realloc = aushape_arena_realloc;
+    arena->mem.free = aushape_arena_free;
+    arena->mem.data = arena;
+    arena->block_size = block_size == 0 ? AUSHAPE_ARENA_BLOCK_SIZE
+                                        : block_size;
+
+    assert(aushape_arena_is_valid(arena));
+    *parena = arena;
+    return AUSHAPE_RC_OK;
+}
+
+bool
+aushape_arena_is_valid(const struct aushape_arena *arena)
+{
+    return arena != NULL &&
+           arena->mem.data == arena &&
+           arena->block_size != 0 &&
+           (arena->block == NULL ||
+            arena->block->used <= arena->block->size);
+}
+
+const struct aushape_mem *
+aushape_arena_get_mem(const struct aushape_arena *arena)
+{
+    assert(aushape_arena_is_valid(arena));
+    return &arena->mem;
+}
+
+size_t
+aushape_arena_get_size(const struct aushape_arena *arena)
+{
+    assert(aushape_arena_is_valid(arena));
+    return arena->size;
+}
+
+void
+aushape_arena_destroy(struct aushape_arena *arena)
+{
+    struct aushape_arena_block *block;
+    struct aushape_arena_block *prev;
+
+    if (arena == NULL) {
+        return;
+    }
+
+    assert(aushape_arena_is_valid(arena));
+
+    for (block = arena->block; block != NULL; block = prev) {
+        prev = block->prev;
+        free(block);
+    }
+    memset(arena, 0, sizeof(*arena));
+    free(arena);
+}
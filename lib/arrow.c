@@ -0,0 +1,1540 @@
+/*
+ * Apache Arrow IPC stream record batch builder.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * The message metadata is a FlatBuffer, see Schema.fbs and Message.fbs in
+ * the Arrow format specification. It is written front-to-back: each table
+ * is preceded by its vtable, and is followed by the objects it refers to,
+ * with the references patched once the objects are written.
+ */
+
+#include <aushape/arrow.h>
+#include <aushape/guard.h>
+#include <aushape/misc.h>
+#include <string.h>
+#include <assert.h>
+
+/** Maximum number of fields in a FlatBuffer table we write */
+#define AUSHAPE_ARROW_FB_MAX_FIELDS 8
+
+/** Message metadata version (V5) */
+#define AUSHAPE_ARROW_METADATA_VERSION  4
+
+/** Message header types */
+enum aushape_arrow_header {
+    AUSHAPE_ARROW_HEADER_SCHEMA             = 1,
+    AUSHAPE_ARROW_HEADER_DICTIONARY_BATCH   = 2,
+    AUSHAPE_ARROW_HEADER_RECORD_BATCH       = 3,
+};
+
+/** Column types */
+enum aushape_arrow_type {
+    AUSHAPE_ARROW_TYPE_INT          = 2,
+    AUSHAPE_ARROW_TYPE_UTF8         = 5,
+    AUSHAPE_ARROW_TYPE_TIMESTAMP    = 10,
+    AUSHAPE_ARROW_TYPE_LIST         = 12,
+    AUSHAPE_ARROW_TYPE_STRUCT       = 13,
+};
+
+/** Time unit of the timestamp columns (milliseconds) */
+#define AUSHAPE_ARROW_TIME_UNIT_MILLISECOND 1
+
+/** Dictionary IDs */
+enum aushape_arrow_dict_id {
+    AUSHAPE_ARROW_DICT_ID_TYPES,
+    AUSHAPE_ARROW_DICT_ID_NAMES,
+};
+
+/** Schema field description */
+struct aushape_arrow_field {
+    /** Field name */
+    const char                         *name;
+    /** True if the field can contain nulls */
+    bool                                nullable;
+    /** Field (value) type */
+    enum aushape_arrow_type             type;
+    /** Bit width, for integer type */
+    size_t                              bit_width;
+    /** True if signed, for integer type */
+    bool                                is_signed;
+    /** True if dictionary-encoded with int32 indices */
+    bool                                dict;
+    /** Dictionary ID, if dictionary-encoded */
+    enum aushape_arrow_dict_id          dict_id;
+    /** Child fields */
+    const struct aushape_arrow_field   *child_list;
+    /** Number of child fields */
+    size_t                              child_num;
+};
+
+static const struct aushape_arrow_field aushape_arrow_field_field_list[] = {
+    {
+        .name       = "name",
+        .type       = AUSHAPE_ARROW_TYPE_UTF8,
+        .dict       = true,
+        .dict_id    = AUSHAPE_ARROW_DICT_ID_NAMES,
+    },
+    {
+        .name       = "value",
+        .type       = AUSHAPE_ARROW_TYPE_UTF8,
+    },
+    {
+        .name       = "raw",
+        .nullable   = true,
+        .type       = AUSHAPE_ARROW_TYPE_UTF8,
+    },
+};
+
+static const struct aushape_arrow_field aushape_arrow_field_field = {
+    .name       = "item",
+    .type       = AUSHAPE_ARROW_TYPE_STRUCT,
+    .child_list = aushape_arrow_field_field_list,
+    .child_num  = AUSHAPE_ARRAY_SIZE(aushape_arrow_field_field_list),
+};
+
+static const struct aushape_arrow_field aushape_arrow_record_field_list[] = {
+    {
+        .name       = "type",
+        .type       = AUSHAPE_ARROW_TYPE_UTF8,
+        .dict       = true,
+        .dict_id    = AUSHAPE_ARROW_DICT_ID_TYPES,
+    },
+    {
+        .name       = "fields",
+        .type       = AUSHAPE_ARROW_TYPE_LIST,
+        .child_list = &aushape_arrow_field_field,
+        .child_num  = 1,
+    },
+};
+
+static const struct aushape_arrow_field aushape_arrow_record_field = {
+    .name       = "item",
+    .type       = AUSHAPE_ARROW_TYPE_STRUCT,
+    .child_list = aushape_arrow_record_field_list,
+    .child_num  = AUSHAPE_ARRAY_SIZE(aushape_arrow_record_field_list),
+};
+
+static const struct aushape_arrow_field aushape_arrow_line_field = {
+    .name       = "item",
+    .type       = AUSHAPE_ARROW_TYPE_UTF8,
+};
+
+/** Event fields, in schema order */
+enum aushape_arrow_event_field {
+    AUSHAPE_ARROW_EVENT_FIELD_SERIAL,
+    AUSHAPE_ARROW_EVENT_FIELD_TIME,
+    AUSHAPE_ARROW_EVENT_FIELD_NODE,
+    AUSHAPE_ARROW_EVENT_FIELD_TEXT,
+    AUSHAPE_ARROW_EVENT_FIELD_RECORDS,
+    AUSHAPE_ARROW_EVENT_FIELD_NUM
+};
+
+static const struct aushape_arrow_field
+aushape_arrow_event_field_list[AUSHAPE_ARROW_EVENT_FIELD_NUM] = {
+    [AUSHAPE_ARROW_EVENT_FIELD_SERIAL] = {
+        .name       = "serial",
+        .type       = AUSHAPE_ARROW_TYPE_INT,
+        .bit_width  = 64,
+        .is_signed  = false,
+    },
+    [AUSHAPE_ARROW_EVENT_FIELD_TIME] = {
+        .name       = "time",
+        .type       = AUSHAPE_ARROW_TYPE_TIMESTAMP,
+    },
+    [AUSHAPE_ARROW_EVENT_FIELD_NODE] = {
+        .name       = "node",
+        .nullable   = true,
+        .type       = AUSHAPE_ARROW_TYPE_UTF8,
+    },
+    [AUSHAPE_ARROW_EVENT_FIELD_TEXT] = {
+        .name       = "text",
+        .type       = AUSHAPE_ARROW_TYPE_LIST,
+        .child_list = &aushape_arrow_line_field,
+        .child_num  = 1,
+    },
+    [AUSHAPE_ARROW_EVENT_FIELD_RECORDS] = {
+        .name       = "records",
+        .type       = AUSHAPE_ARROW_TYPE_LIST,
+        .child_list = &aushape_arrow_record_field,
+        .child_num  = 1,
+    },
+};
+
+/** Record batch field node: an array's length and null count */
+struct aushape_arrow_node {
+    size_t  len;        /**< Number of items */
+    size_t  null_num;   /**< Number of null items */
+};
+
+/** Record batch body buffer */
+struct aushape_arrow_body {
+    const void *ptr;    /**< Buffer contents, can be NULL if empty */
+    size_t      len;    /**< Buffer length */
+};
+
+/**
+ * Maximum number of field nodes and body buffers in a record batch:
+ * all event fields with their children, and three buffers per field.
+ */
+#define AUSHAPE_ARROW_MAX_NODES     16
+#define AUSHAPE_ARROW_MAX_BODIES    (AUSHAPE_ARROW_MAX_NODES * 3)
+
+/**
+ * Encode an unsigned integer in little-endian byte order into memory.
+ *
+ * @param ptr   The memory to encode into.
+ * @param value The value to encode.
+ * @param size  The number of bytes to encode, up to eight.
+ */
+static void
+aushape_arrow_put_le(void *ptr, uint64_t value, size_t size)
+{
+    uint8_t *p = (uint8_t *)ptr;
+    assert(ptr != NULL);
+    assert(size <= 8);
+    for (; size > 0; size--) {
+        *p++ = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+/**
+ * Decode an unsigned integer in little-endian byte order from memory.
+ *
+ * @param ptr   The memory to decode from.
+ * @param size  The number of bytes to decode, up to eight.
+ *
+ * @return The decoded value.
+ */
+static uint64_t
+aushape_arrow_get_le(const void *ptr, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)ptr + size;
+    uint64_t value = 0;
+    assert(ptr != NULL);
+    assert(size <= 8);
+    for (; size > 0; size--) {
+        value = (value << 8) | *--p;
+    }
+    return value;
+}
+
+/**
+ * Add an unsigned integer in little-endian byte order to a growing buffer.
+ *
+ * @param gbuf  The growing buffer to add to.
+ * @param value The value to add.
+ * @param size  The number of bytes to add, up to eight.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_add_le(struct aushape_gbuf *gbuf, uint64_t value, size_t size)
+{
+    uint8_t buf[8];
+    aushape_arrow_put_le(buf, value, size);
+    return aushape_gbuf_add_buf(gbuf, buf, size);
+}
+
+/**
+ * Add zero padding to a growing buffer, so its contents past a base
+ * position are aligned to a boundary.
+ *
+ * @param gbuf  The growing buffer to pad.
+ * @param base  The position alignment is relative to.
+ * @param align The alignment, a power of two.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - padded successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_pad(struct aushape_gbuf *gbuf, size_t base, size_t align)
+{
+    size_t len;
+    assert(gbuf->len >= base);
+    len = (align - (gbuf->len - base) % align) % align;
+    return len == 0 ? AUSHAPE_RC_OK : aushape_gbuf_add_span(gbuf, 0, len);
+}
+
+/**
+ * Patch a FlatBuffer offset to refer to an object.
+ *
+ * @param gbuf  The growing buffer with the FlatBuffer.
+ * @param pos   The position of the offset to patch.
+ * @param obj   The position of the object to refer to, after the offset.
+ */
+static void
+aushape_arrow_fb_patch(struct aushape_gbuf *gbuf, size_t pos, size_t obj)
+{
+    assert(obj > pos);
+    assert(obj < gbuf->len);
+    aushape_arrow_put_le(gbuf->ptr + pos, obj - pos, 4);
+}
+
+/** FlatBuffer table field */
+struct aushape_arrow_fb_field {
+    /** Field size in bytes: 1, 2, 4 (also offsets), or 8; zero if absent */
+    size_t      size;
+    /** Field scalar value, zero for offsets to be patched */
+    uint64_t    value;
+};
+
+/**
+ * Add a FlatBuffer table with its vtable to a growing buffer.
+ *
+ * @param gbuf          The growing buffer with the FlatBuffer.
+ * @param base          The position of the FlatBuffer start.
+ * @param field_list    The table fields, in schema order.
+ * @param field_num     Number of table fields.
+ * @param pos_list      Location for the positions of the added fields,
+ *                      for patching offsets. Can be NULL.
+ * @param ptable        Location for the position of the added table.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_fb_add_table(struct aushape_gbuf *gbuf, size_t base,
+                           const struct aushape_arrow_fb_field *field_list,
+                           size_t field_num,
+                           size_t *pos_list,
+                           size_t *ptable)
+{
+    enum aushape_rc rc;
+    size_t off_list[AUSHAPE_ARROW_FB_MAX_FIELDS];
+    size_t size;
+    size_t table_len;
+    size_t vtable;
+    size_t table;
+    size_t i;
+
+    assert(field_num <= AUSHAPE_ARROW_FB_MAX_FIELDS);
+    assert(ptable != NULL);
+
+    /* Lay out fields after the vtable offset, largest first */
+    table_len = 4;
+    for (size = 8; size > 0; size /= 2) {
+        for (i = 0; i < field_num; i++) {
+            if (field_list[i].size == size) {
+                table_len = (table_len + size - 1) & ~(size - 1);
+                off_list[i] = table_len;
+                table_len += size;
+            }
+        }
+    }
+
+    /* Add vtable */
+    AUSHAPE_GUARD(aushape_arrow_pad(gbuf, base, 2));
+    vtable = gbuf->len;
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, 4 + field_num * 2, 2));
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, table_len, 2));
+    for (i = 0; i < field_num; i++) {
+        AUSHAPE_GUARD(aushape_arrow_add_le(
+                            gbuf, field_list[i].size == 0 ? 0 : off_list[i],
+                            2));
+    }
+
+    /* Add table, aligned for its largest fields */
+    AUSHAPE_GUARD(aushape_arrow_pad(gbuf, base, 8));
+    table = gbuf->len;
+    AUSHAPE_GUARD(aushape_gbuf_add_span(gbuf, 0, table_len));
+    aushape_arrow_put_le(gbuf->ptr + table, table - vtable, 4);
+    for (i = 0; i < field_num; i++) {
+        if (field_list[i].size != 0) {
+            aushape_arrow_put_le(gbuf->ptr + table + off_list[i],
+                                 field_list[i].value, field_list[i].size);
+            if (pos_list != NULL) {
+                pos_list[i] = table + off_list[i];
+            }
+        }
+    }
+
+    *ptable = table;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add a zero-filled FlatBuffer vector to a growing buffer.
+ *
+ * @param gbuf      The growing buffer with the FlatBuffer.
+ * @param base      The position of the FlatBuffer start.
+ * @param size      Element size: 4 for offsets, or 16 for our structs.
+ * @param num       Number of elements.
+ * @param pvector   Location for the position of the vector.
+ * @param pdata     Location for the position of the first element.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_fb_add_vector(struct aushape_gbuf *gbuf, size_t base,
+                            size_t size, size_t num,
+                            size_t *pvector, size_t *pdata)
+{
+    enum aushape_rc rc;
+    size_t align = size < 4 ? 4 : (size > 8 ? 8 : size);
+
+    /* Align the elements following the length */
+    AUSHAPE_GUARD(aushape_arrow_pad(gbuf, base, 4));
+    if ((gbuf->len - base + 4) % align != 0) {
+        AUSHAPE_GUARD(aushape_gbuf_add_span(gbuf, 0, 4));
+    }
+    *pvector = gbuf->len;
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, num, 4));
+    *pdata = gbuf->len;
+    if (size * num > 0) {
+        AUSHAPE_GUARD(aushape_gbuf_add_span(gbuf, 0, size * num));
+    }
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add a FlatBuffer string to a growing buffer.
+ *
+ * @param gbuf      The growing buffer with the FlatBuffer.
+ * @param base      The position of the FlatBuffer start.
+ * @param str       The string to add.
+ * @param pstring   Location for the position of the string.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_fb_add_string(struct aushape_gbuf *gbuf, size_t base,
+                            const char *str, size_t *pstring)
+{
+    enum aushape_rc rc;
+    size_t len = strlen(str);
+    AUSHAPE_GUARD(aushape_arrow_pad(gbuf, base, 4));
+    *pstring = gbuf->len;
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, len, 4));
+    /* Include the terminating zero */
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, str, len + 1));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add an Int type table to a growing buffer.
+ *
+ * @param gbuf      The growing buffer with the FlatBuffer.
+ * @param base      The position of the FlatBuffer start.
+ * @param bit_width The integer bit width.
+ * @param is_signed True if the integer is signed.
+ * @param ptable    Location for the position of the table.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_fb_add_int(struct aushape_gbuf *gbuf, size_t base,
+                         size_t bit_width, bool is_signed,
+                         size_t *ptable)
+{
+    const struct aushape_arrow_fb_field field_list[] = {
+        {.size = 4, .value = bit_width},    /* bitWidth */
+        {.size = 1, .value = is_signed},    /* is_signed */
+    };
+    return aushape_arrow_fb_add_table(gbuf, base,
+                                      field_list,
+                                      AUSHAPE_ARRAY_SIZE(field_list),
+                                      NULL, ptable);
+}
+
+/**
+ * Add a Field table, with the tables it refers to, to a growing buffer.
+ *
+ * @param gbuf      The growing buffer with the FlatBuffer.
+ * @param base      The position of the FlatBuffer start.
+ * @param field     The field to add.
+ * @param ptable    Location for the position of the table.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_fb_add_field(struct aushape_gbuf *gbuf, size_t base,
+                           const struct aushape_arrow_field *field,
+                           size_t *ptable)
+{
+    enum aushape_rc rc;
+    const struct aushape_arrow_fb_field field_list[] = {
+        {.size = 4},                            /* name */
+        {.size = 1, .value = field->nullable},  /* nullable */
+        {.size = 1, .value = field->type},      /* type_type */
+        {.size = 4},                            /* type */
+        {.size = field->dict ? 4 : 0},          /* dictionary */
+        {.size = 4},                            /* children */
+    };
+    const struct aushape_arrow_fb_field timestamp_field_list[] = {
+        {.size = 2, .value = AUSHAPE_ARROW_TIME_UNIT_MILLISECOND},
+        {.size = 4},                            /* timezone */
+    };
+    const struct aushape_arrow_fb_field dict_field_list[] = {
+        {.size = 8, .value = field->dict_id},   /* id */
+        {.size = 4},                            /* indexType */
+    };
+    size_t pos_list[AUSHAPE_ARRAY_SIZE(field_list)];
+    size_t sub_pos_list[2];
+    size_t obj;
+    size_t data;
+    size_t i;
+
+    AUSHAPE_GUARD(aushape_arrow_fb_add_table(gbuf, base,
+                                             field_list,
+                                             AUSHAPE_ARRAY_SIZE(field_list),
+                                             pos_list, ptable));
+
+    AUSHAPE_GUARD(aushape_arrow_fb_add_string(gbuf, base, field->name, &obj));
+    aushape_arrow_fb_patch(gbuf, pos_list[0], obj);
+
+    switch (field->type) {
+    case AUSHAPE_ARROW_TYPE_INT:
+        AUSHAPE_GUARD(aushape_arrow_fb_add_int(gbuf, base,
+                                               field->bit_width,
+                                               field->is_signed, &obj));
+        aushape_arrow_fb_patch(gbuf, pos_list[3], obj);
+        break;
+    case AUSHAPE_ARROW_TYPE_TIMESTAMP:
+        AUSHAPE_GUARD(aushape_arrow_fb_add_table(
+                            gbuf, base,
+                            timestamp_field_list,
+                            AUSHAPE_ARRAY_SIZE(timestamp_field_list),
+                            sub_pos_list, &obj));
+        aushape_arrow_fb_patch(gbuf, pos_list[3], obj);
+        AUSHAPE_GUARD(aushape_arrow_fb_add_string(gbuf, base, "UTC", &obj));
+        aushape_arrow_fb_patch(gbuf, sub_pos_list[1], obj);
+        break;
+    default:
+        /* Utf8, List, and Struct_ have no properties */
+        AUSHAPE_GUARD(aushape_arrow_fb_add_table(gbuf, base, NULL, 0,
+                                                 NULL, &obj));
+        aushape_arrow_fb_patch(gbuf, pos_list[3], obj);
+        break;
+    }
+
+    if (field->dict) {
+        AUSHAPE_GUARD(aushape_arrow_fb_add_table(
+                            gbuf, base,
+                            dict_field_list,
+                            AUSHAPE_ARRAY_SIZE(dict_field_list),
+                            sub_pos_list, &obj));
+        aushape_arrow_fb_patch(gbuf, pos_list[4], obj);
+        AUSHAPE_GUARD(aushape_arrow_fb_add_int(gbuf, base, 32, true, &obj));
+        aushape_arrow_fb_patch(gbuf, sub_pos_list[1], obj);
+    }
+
+    AUSHAPE_GUARD(aushape_arrow_fb_add_vector(gbuf, base, 4,
+                                              field->child_num,
+                                              &obj, &data));
+    aushape_arrow_fb_patch(gbuf, pos_list[5], obj);
+    for (i = 0; i < field->child_num; i++) {
+        AUSHAPE_GUARD(aushape_arrow_fb_add_field(gbuf, base,
+                                                 &field->child_list[i],
+                                                 &obj));
+        aushape_arrow_fb_patch(gbuf, data + i * 4, obj);
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Begin an encapsulated message in a growing buffer: add the continuation
+ * marker, the metadata length placeholder, and the Message table, refering
+ * to a header.
+ *
+ * @param gbuf          The growing buffer to add the message to.
+ * @param header_type   The message header type.
+ * @param body_len      The message body length.
+ * @param pbase         Location for the position of the metadata
+ *                      FlatBuffer start.
+ * @param pheader       Location for the position of the header offset,
+ *                      to be patched.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_msg_begin(struct aushape_gbuf *gbuf,
+                        enum aushape_arrow_header header_type,
+                        size_t body_len,
+                        size_t *pbase, size_t *pheader)
+{
+    enum aushape_rc rc;
+    const struct aushape_arrow_fb_field field_list[] = {
+        {.size = 2, .value = AUSHAPE_ARROW_METADATA_VERSION}, /* version */
+        {.size = 1, .value = header_type},  /* header_type */
+        {.size = 4},                        /* header */
+        {.size = 8, .value = body_len},     /* bodyLength */
+    };
+    size_t pos_list[AUSHAPE_ARRAY_SIZE(field_list)];
+    size_t base;
+    size_t table;
+
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, UINT32_MAX, 4));
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, 0, 4));
+    base = gbuf->len;
+    /* Root table offset */
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, 0, 4));
+    AUSHAPE_GUARD(aushape_arrow_fb_add_table(gbuf, base,
+                                             field_list,
+                                             AUSHAPE_ARRAY_SIZE(field_list),
+                                             pos_list, &table));
+    aushape_arrow_fb_patch(gbuf, base, table);
+    *pbase = base;
+    *pheader = pos_list[2];
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * End the metadata of an encapsulated message in a growing buffer: pad it
+ * and fill in its length.
+ *
+ * @param gbuf  The growing buffer with the message.
+ * @param base  The position of the metadata FlatBuffer start.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - ended successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_msg_end(struct aushape_gbuf *gbuf, size_t base)
+{
+    enum aushape_rc rc;
+    AUSHAPE_GUARD(aushape_arrow_pad(gbuf, base, 8));
+    aushape_arrow_put_le(gbuf->ptr + base - 4, gbuf->len - base, 4);
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add a record batch message, or a dictionary batch message with a record
+ * batch, to a growing buffer.
+ *
+ * @param gbuf      The growing buffer to add the message to.
+ * @param dict      True if adding a dictionary batch.
+ * @param dict_id   The dictionary ID, if adding a dictionary batch.
+ * @param is_delta  True if the dictionary batch is a delta.
+ * @param len       The number of rows in the record batch.
+ * @param node_list The record batch field nodes.
+ * @param node_num  The number of field nodes.
+ * @param body_list The record batch body buffers.
+ * @param body_num  The number of body buffers.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_add_batch_msg(struct aushape_gbuf *gbuf,
+                            bool dict,
+                            enum aushape_arrow_dict_id dict_id,
+                            bool is_delta,
+                            size_t len,
+                            const struct aushape_arrow_node *node_list,
+                            size_t node_num,
+                            const struct aushape_arrow_body *body_list,
+                            size_t body_num)
+{
+    enum aushape_rc rc;
+    const struct aushape_arrow_fb_field dict_field_list[] = {
+        {.size = 8, .value = dict_id},      /* id */
+        {.size = 4},                        /* data */
+        {.size = 1, .value = is_delta},     /* isDelta */
+    };
+    const struct aushape_arrow_fb_field batch_field_list[] = {
+        {.size = 8, .value = len},          /* length */
+        {.size = 4},                        /* nodes */
+        {.size = 4},                        /* buffers */
+    };
+    size_t pos_list[3];
+    size_t body_len;
+    size_t base;
+    size_t header;
+    size_t table;
+    size_t vector;
+    size_t data;
+    size_t i;
+
+    body_len = 0;
+    for (i = 0; i < body_num; i++) {
+        body_len += (body_list[i].len + 7) & ~(size_t)7;
+    }
+
+    AUSHAPE_GUARD(aushape_arrow_msg_begin(
+                        gbuf,
+                        dict ? AUSHAPE_ARROW_HEADER_DICTIONARY_BATCH
+                             : AUSHAPE_ARROW_HEADER_RECORD_BATCH,
+                        body_len, &base, &header));
+
+    if (dict) {
+        AUSHAPE_GUARD(aushape_arrow_fb_add_table(
+                            gbuf, base,
+                            dict_field_list,
+                            AUSHAPE_ARRAY_SIZE(dict_field_list),
+                            pos_list, &table));
+        aushape_arrow_fb_patch(gbuf, header, table);
+        header = pos_list[1];
+    }
+
+    AUSHAPE_GUARD(aushape_arrow_fb_add_table(
+                        gbuf, base,
+                        batch_field_list,
+                        AUSHAPE_ARRAY_SIZE(batch_field_list),
+                        pos_list, &table));
+    aushape_arrow_fb_patch(gbuf, header, table);
+
+    AUSHAPE_GUARD(aushape_arrow_fb_add_vector(gbuf, base, 16, node_num,
+                                              &vector, &data));
+    aushape_arrow_fb_patch(gbuf, pos_list[1], vector);
+    for (i = 0; i < node_num; i++) {
+        aushape_arrow_put_le(gbuf->ptr + data + i * 16,
+                             node_list[i].len, 8);
+        aushape_arrow_put_le(gbuf->ptr + data + i * 16 + 8,
+                             node_list[i].null_num, 8);
+    }
+
+    AUSHAPE_GUARD(aushape_arrow_fb_add_vector(gbuf, base, 16, body_num,
+                                              &vector, &data));
+    aushape_arrow_fb_patch(gbuf, pos_list[2], vector);
+    body_len = 0;
+    for (i = 0; i < body_num; i++) {
+        aushape_arrow_put_le(gbuf->ptr + data + i * 16, body_len, 8);
+        aushape_arrow_put_le(gbuf->ptr + data + i * 16 + 8,
+                             body_list[i].len, 8);
+        body_len += (body_list[i].len + 7) & ~(size_t)7;
+    }
+
+    AUSHAPE_GUARD(aushape_arrow_msg_end(gbuf, base));
+
+    /* Add the body */
+    for (i = 0; i < body_num; i++) {
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, body_list[i].ptr,
+                                           body_list[i].len));
+        AUSHAPE_GUARD(aushape_arrow_pad(gbuf, base, 8));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add an offset to an offset buffer, adding the initial zero offset first,
+ * if the buffer is empty.
+ *
+ * @param gbuf      The offset buffer to add to.
+ * @param offset    The offset to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed, or the offset
+ *                                exceeds the int32 range.
+ */
+static enum aushape_rc
+aushape_arrow_add_offset(struct aushape_gbuf *gbuf, size_t offset)
+{
+    enum aushape_rc rc;
+    AUSHAPE_GUARD_BOOL(NOMEM, offset <= INT32_MAX);
+    if (gbuf->len == 0) {
+        AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, 0, 4));
+    }
+    AUSHAPE_GUARD(aushape_arrow_add_le(gbuf, offset, 4));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Retrieve an offset from an offset buffer, which can be empty.
+ *
+ * @param gbuf  The offset buffer to retrieve from.
+ * @param idx   The index of the offset to retrieve.
+ *
+ * @return The offset.
+ */
+static size_t
+aushape_arrow_get_offset(const struct aushape_gbuf *gbuf, size_t idx)
+{
+    if (gbuf->len == 0) {
+        assert(idx == 0);
+        return 0;
+    }
+    assert((idx + 1) * 4 <= gbuf->len);
+    return aushape_arrow_get_le(gbuf->ptr + idx * 4, 4);
+}
+
+/**
+ * Add a string to a pair of offset and data buffers.
+ *
+ * @param offs  The offset buffer to add to.
+ * @param data  The data buffer to add to.
+ * @param str   The string to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_add_str(struct aushape_gbuf *offs, struct aushape_gbuf *data,
+                      const char *str)
+{
+    enum aushape_rc rc;
+    AUSHAPE_GUARD(aushape_gbuf_add_str(data, str));
+    AUSHAPE_GUARD(aushape_arrow_add_offset(offs, data->len));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add a bit to a validity bitmap.
+ *
+ * @param gbuf  The bitmap buffer to add to.
+ * @param idx   The index of the bit to add, must be the number of bits
+ *              already added.
+ * @param valid The bit value.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_add_bit(struct aushape_gbuf *gbuf, size_t idx, bool valid)
+{
+    enum aushape_rc rc;
+    if (idx % 8 == 0) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, 0));
+    }
+    assert(idx / 8 + 1 == gbuf->len);
+    if (valid) {
+        gbuf->ptr[idx / 8] |= 1 << (idx % 8);
+    }
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Hash a string with FNV-1a.
+ *
+ * @param ptr   The string characters.
+ * @param len   The string length.
+ *
+ * @return The hash.
+ */
+static uint32_t
+aushape_arrow_hash(const char *ptr, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (; len > 0; len--) {
+        hash = (hash ^ (uint8_t)*ptr++) * 16777619u;
+    }
+    return hash;
+}
+
+static bool
+aushape_arrow_dict_is_valid(const struct aushape_arrow_dict *dict)
+{
+    return dict != NULL &&
+           aushape_gbuf_is_valid(&dict->offs) &&
+           aushape_gbuf_is_valid(&dict->data) &&
+           (dict->slot_num & (dict->slot_num - 1)) == 0 &&
+           (dict->slot_list != NULL || dict->slot_num == 0) &&
+           dict->len * 2 <= dict->slot_num &&
+           dict->sent <= dict->len;
+}
+
+static void
+aushape_arrow_dict_init(struct aushape_arrow_dict *dict,
+                        const struct aushape_mem *mem)
+{
+    assert(dict != NULL);
+    memset(dict, 0, sizeof(*dict));
+    aushape_gbuf_init(&dict->offs, 1024, mem);
+    aushape_gbuf_init(&dict->data, 4096, mem);
+    dict->mem = mem;
+    assert(aushape_arrow_dict_is_valid(dict));
+}
+
+static void
+aushape_arrow_dict_cleanup(struct aushape_arrow_dict *dict)
+{
+    assert(aushape_arrow_dict_is_valid(dict));
+    aushape_gbuf_cleanup(&dict->offs);
+    aushape_gbuf_cleanup(&dict->data);
+    aushape_mem_free(dict->mem, dict->slot_list);
+    memset(dict, 0, sizeof(*dict));
+}
+
+/**
+ * Find the hash table slot of a string in a dictionary.
+ *
+ * @param dict  The dictionary to look up the string in.
+ * @param ptr   The string characters.
+ * @param len   The string length.
+ *
+ * @return The slot index, either containing the string, or empty.
+ */
+static size_t
+aushape_arrow_dict_find(const struct aushape_arrow_dict *dict,
+                        const char *ptr, size_t len)
+{
+    size_t mask = dict->slot_num - 1;
+    size_t slot = aushape_arrow_hash(ptr, len) & mask;
+    size_t idx;
+    size_t start;
+
+    assert(dict->slot_num > 0);
+
+    while (dict->slot_list[slot] != 0) {
+        idx = dict->slot_list[slot] - 1;
+        start = aushape_arrow_get_offset(&dict->offs, idx);
+        if (aushape_arrow_get_offset(&dict->offs, idx + 1) - start == len &&
+            memcmp(dict->data.ptr + start, ptr, len) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * Double the hash table of a dictionary, or allocate the initial one.
+ *
+ * @param dict  The dictionary to grow the hash table of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - grown successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_dict_grow(struct aushape_arrow_dict *dict)
+{
+    enum aushape_rc rc;
+    uint32_t *new_slot_list;
+    size_t new_slot_num = dict->slot_num == 0 ? 64 : dict->slot_num * 2;
+    size_t start;
+    size_t end;
+    size_t idx;
+
+    new_slot_list = aushape_mem_realloc(dict->mem, NULL,
+                                        new_slot_num *
+                                        sizeof(*new_slot_list));
+    AUSHAPE_GUARD_BOOL(NOMEM, new_slot_list != NULL);
+    memset(new_slot_list, 0, new_slot_num * sizeof(*new_slot_list));
+    aushape_mem_free(dict->mem, dict->slot_list);
+    dict->slot_list = new_slot_list;
+    dict->slot_num = new_slot_num;
+
+    for (idx = 0; idx < dict->len; idx++) {
+        start = aushape_arrow_get_offset(&dict->offs, idx);
+        end = aushape_arrow_get_offset(&dict->offs, idx + 1);
+        dict->slot_list[aushape_arrow_dict_find(dict,
+                                                dict->data.ptr + start,
+                                                end - start)] = idx + 1;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Retrieve the index of a string in a dictionary, adding it if missing.
+ *
+ * @param dict  The dictionary to look up the string in.
+ * @param str   The string to look up.
+ * @param pidx  Location for the string index.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - retrieved successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_dict_index(struct aushape_arrow_dict *dict,
+                         const char *str, size_t *pidx)
+{
+    enum aushape_rc rc;
+    size_t len = strlen(str);
+    size_t slot;
+
+    assert(aushape_arrow_dict_is_valid(dict));
+
+    if ((dict->len + 1) * 2 > dict->slot_num) {
+        AUSHAPE_GUARD(aushape_arrow_dict_grow(dict));
+    }
+
+    slot = aushape_arrow_dict_find(dict, str, len);
+    if (dict->slot_list[slot] == 0) {
+        AUSHAPE_GUARD(aushape_arrow_add_str(&dict->offs, &dict->data, str));
+        dict->slot_list[slot] = ++dict->len;
+    }
+    *pidx = dict->slot_list[slot] - 1;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    assert(aushape_arrow_dict_is_valid(dict));
+    return rc;
+}
+
+/**
+ * Add a dictionary batch message with the dictionary values not output
+ * yet to a growing buffer.
+ *
+ * @param dict      The dictionary to output.
+ * @param id        The dictionary ID.
+ * @param is_delta  True if the values should be output as a delta.
+ * @param scratch   The growing buffer to use for rebased value offsets.
+ * @param gbuf      The growing buffer to add the message to.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_dict_write(struct aushape_arrow_dict *dict,
+                         enum aushape_arrow_dict_id id,
+                         bool is_delta,
+                         struct aushape_gbuf *scratch,
+                         struct aushape_gbuf *gbuf)
+{
+    enum aushape_rc rc;
+    size_t start = aushape_arrow_get_offset(&dict->offs, dict->sent);
+    size_t len = dict->len - dict->sent;
+    struct aushape_arrow_node node = {.len = len, .null_num = 0};
+    struct aushape_arrow_body body_list[3];
+    size_t idx;
+
+    assert(aushape_arrow_dict_is_valid(dict));
+
+    aushape_gbuf_empty(scratch);
+    for (idx = dict->sent; idx <= dict->len; idx++) {
+        AUSHAPE_GUARD(aushape_arrow_add_le(
+                            scratch,
+                            aushape_arrow_get_offset(&dict->offs, idx) -
+                                start,
+                            4));
+    }
+
+    body_list[0].ptr = NULL;
+    body_list[0].len = 0;
+    body_list[1].ptr = scratch->ptr;
+    body_list[1].len = scratch->len;
+    body_list[2].ptr = dict->data.ptr + start;
+    body_list[2].len = dict->data.len - start;
+
+    AUSHAPE_GUARD(aushape_arrow_add_batch_msg(
+                        gbuf, true, id, is_delta, len, &node, 1,
+                        body_list, AUSHAPE_ARRAY_SIZE(body_list)));
+    dict->sent = dict->len;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+bool
+aushape_arrow_is_valid(const struct aushape_arrow *arrow)
+{
+    size_t i;
+
+    if (arrow == NULL ||
+        !aushape_arrow_dict_is_valid(&arrow->types) ||
+        !aushape_arrow_dict_is_valid(&arrow->names) ||
+        !aushape_gbuf_is_valid(&arrow->scratch)) {
+        return false;
+    }
+    for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+        if (!aushape_gbuf_is_valid(&arrow->buf_list[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+aushape_arrow_init(struct aushape_arrow *arrow, bool with_text,
+                   const struct aushape_mem *mem)
+{
+    size_t i;
+
+    assert(arrow != NULL);
+    assert(aushape_mem_is_valid(mem));
+
+    memset(arrow, 0, sizeof(*arrow));
+    arrow->with_text = with_text;
+    for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+        aushape_gbuf_init(&arrow->buf_list[i], 4096, mem);
+    }
+    aushape_arrow_dict_init(&arrow->types, mem);
+    aushape_arrow_dict_init(&arrow->names, mem);
+    aushape_gbuf_init(&arrow->scratch, 1024, mem);
+    assert(aushape_arrow_is_valid(arrow));
+}
+
+void
+aushape_arrow_cleanup(struct aushape_arrow *arrow)
+{
+    size_t i;
+
+    assert(aushape_arrow_is_valid(arrow));
+
+    for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+        aushape_gbuf_cleanup(&arrow->buf_list[i]);
+    }
+    aushape_arrow_dict_cleanup(&arrow->types);
+    aushape_arrow_dict_cleanup(&arrow->names);
+    aushape_gbuf_cleanup(&arrow->scratch);
+    memset(arrow, 0, sizeof(*arrow));
+}
+
+void
+aushape_arrow_shrink(struct aushape_arrow *arrow)
+{
+    size_t i;
+
+    assert(aushape_arrow_is_valid(arrow));
+
+    for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+        aushape_gbuf_shrink(&arrow->buf_list[i]);
+    }
+    aushape_gbuf_shrink(&arrow->scratch);
+}
+
+void
+aushape_arrow_get_mem_usage(const struct aushape_arrow *arrow,
+                            struct aushape_mem_usage *usage)
+{
+    const struct aushape_arrow_dict *dict_list[] = {
+        &arrow->types,
+        &arrow->names,
+    };
+    size_t i;
+
+    assert(aushape_arrow_is_valid(arrow));
+    assert(usage != NULL);
+
+    for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+        aushape_gbuf_get_mem_usage(&arrow->buf_list[i], usage);
+    }
+    for (i = 0; i < AUSHAPE_ARRAY_SIZE(dict_list); i++) {
+        aushape_gbuf_get_mem_usage(&dict_list[i]->offs, usage);
+        aushape_gbuf_get_mem_usage(&dict_list[i]->data, usage);
+        /* Hash tables never shrink */
+        usage->size += dict_list[i]->slot_num * sizeof(uint32_t);
+        usage->peak += dict_list[i]->slot_num * sizeof(uint32_t);
+    }
+    aushape_gbuf_get_mem_usage(&arrow->scratch, usage);
+}
+
+/**
+ * Add an intermediate record node's fields to the record batch being built.
+ *
+ * @param arrow     The builder to add the fields to.
+ * @param pool      The pool the record node refers to.
+ * @param record    The record node to add the fields of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - added successfully,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_arrow_add_fields(struct aushape_arrow *arrow,
+                         const struct aushape_itree_pool *pool,
+                         const struct aushape_itree_node *record)
+{
+    enum aushape_rc rc;
+    struct aushape_gbuf *buf_list = arrow->buf_list;
+    size_t *count_list = arrow->count_list;
+    const struct aushape_itree_field *field;
+    size_t idx;
+    size_t i;
+
+    for (i = 0; i < record->len; i++) {
+        field = aushape_itree_pool_get_field(pool, record->pos + i);
+        AUSHAPE_GUARD(aushape_arrow_dict_index(
+                            &arrow->names,
+                            aushape_itree_pool_get_str(pool, field->name),
+                            &idx));
+        AUSHAPE_GUARD(aushape_arrow_add_le(
+                        &buf_list[AUSHAPE_ARROW_BUF_NAME_IDX], idx, 4));
+        AUSHAPE_GUARD(aushape_arrow_add_str(
+                        &buf_list[AUSHAPE_ARROW_BUF_VALUE_OFFS],
+                        &buf_list[AUSHAPE_ARROW_BUF_VALUE_DATA],
+                        aushape_itree_pool_get_str(pool, field->value_i)));
+        AUSHAPE_GUARD(aushape_arrow_add_bit(
+                        &buf_list[AUSHAPE_ARROW_BUF_RAW_VALID],
+                        count_list[AUSHAPE_ARROW_COUNT_FIELD],
+                        field->with_raw));
+        AUSHAPE_GUARD(aushape_arrow_add_str(
+                        &buf_list[AUSHAPE_ARROW_BUF_RAW_OFFS],
+                        &buf_list[AUSHAPE_ARROW_BUF_RAW_DATA],
+                        field->with_raw
+                            ? aushape_itree_pool_get_str(pool, field->value_r)
+                            : ""));
+        if (!field->with_raw) {
+            count_list[AUSHAPE_ARROW_COUNT_RAW_NULL]++;
+        }
+        count_list[AUSHAPE_ARROW_COUNT_FIELD]++;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_arrow_add_event(struct aushape_arrow *arrow,
+                        bool *padded,
+                        const struct aushape_conv_ir *ir)
+{
+    enum aushape_rc rc;
+    struct aushape_gbuf *buf_list = arrow->buf_list;
+    size_t *count_list = arrow->count_list;
+    size_t len_list[AUSHAPE_ARROW_BUF_NUM];
+    size_t orig_count_list[AUSHAPE_ARROW_COUNT_NUM];
+    const struct aushape_itree_node *node;
+    const char *str;
+    size_t record_num = 0;
+    size_t idx;
+    size_t i;
+
+    assert(aushape_arrow_is_valid(arrow));
+    assert(padded != NULL);
+    assert(aushape_conv_ir_is_valid(ir));
+
+    /* Remember the batch state to roll back to on failure */
+    for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+        len_list[i] = buf_list[i].len;
+    }
+    memcpy(orig_count_list, count_list, sizeof(orig_count_list));
+
+    /* Fail if some records couldn't be parsed */
+    rc = ir->records_rc;
+    if (rc != AUSHAPE_RC_OK) {
+        goto cleanup;
+    }
+
+    /* Add source text lines */
+    if (arrow->with_text) {
+        for (i = 0; i < aushape_itree_get_node_num(&ir->text); i++) {
+            node = aushape_itree_get_node(&ir->text, i);
+            AUSHAPE_GUARD(aushape_arrow_add_str(
+                                &buf_list[AUSHAPE_ARROW_BUF_LINE_OFFS],
+                                &buf_list[AUSHAPE_ARROW_BUF_LINE_DATA],
+                                aushape_itree_pool_get_str(&ir->pool,
+                                                           node->pos)));
+            count_list[AUSHAPE_ARROW_COUNT_LINE]++;
+        }
+    }
+
+    /* Add records */
+    for (i = 0; i < aushape_itree_get_node_num(&ir->records); i++) {
+        node = aushape_itree_get_node(&ir->records, i);
+        str = aushape_itree_pool_get_str(&ir->pool, node->name);
+        /* Skip the end-of-event record, as other languages do */
+        if (strcmp(str, "EOE") == 0) {
+            continue;
+        }
+        AUSHAPE_GUARD(aushape_arrow_dict_index(&arrow->types, str, &idx));
+        AUSHAPE_GUARD(aushape_arrow_add_le(
+                            &buf_list[AUSHAPE_ARROW_BUF_TYPE_IDX], idx, 4));
+        AUSHAPE_GUARD(aushape_arrow_add_fields(arrow, &ir->pool, node));
+        AUSHAPE_GUARD(aushape_arrow_add_offset(
+                            &buf_list[AUSHAPE_ARROW_BUF_FIELD_OFFS],
+                            count_list[AUSHAPE_ARROW_COUNT_FIELD]));
+        count_list[AUSHAPE_ARROW_COUNT_RECORD]++;
+        record_num++;
+    }
+
+    /* Drop the event if no records were added */
+    if (record_num == 0) {
+        rc = AUSHAPE_RC_OK;
+        goto cleanup;
+    }
+
+    /* Add the event itself */
+    str = ir->node == AUSHAPE_ITREE_POS_NONE
+                ? NULL
+                : aushape_itree_pool_get_str(&ir->pool, ir->node);
+    AUSHAPE_GUARD(aushape_arrow_add_le(&buf_list[AUSHAPE_ARROW_BUF_SERIAL],
+                                       ir->serial, 8));
+    AUSHAPE_GUARD(aushape_arrow_add_le(&buf_list[AUSHAPE_ARROW_BUF_TIME],
+                                       (uint64_t)ir->sec * 1000 + ir->milli,
+                                       8));
+    AUSHAPE_GUARD(aushape_arrow_add_bit(&buf_list[AUSHAPE_ARROW_BUF_NODE_VALID],
+                                        count_list[AUSHAPE_ARROW_COUNT_ROW],
+                                        str != NULL));
+    AUSHAPE_GUARD(aushape_arrow_add_str(&buf_list[AUSHAPE_ARROW_BUF_NODE_OFFS],
+                                        &buf_list[AUSHAPE_ARROW_BUF_NODE_DATA],
+                                        str == NULL ? "" : str));
+    if (str == NULL) {
+        count_list[AUSHAPE_ARROW_COUNT_NODE_NULL]++;
+    }
+    if (arrow->with_text) {
+        AUSHAPE_GUARD(aushape_arrow_add_offset(
+                            &buf_list[AUSHAPE_ARROW_BUF_TEXT_OFFS],
+                            count_list[AUSHAPE_ARROW_COUNT_LINE]));
+    }
+    AUSHAPE_GUARD(aushape_arrow_add_offset(
+                            &buf_list[AUSHAPE_ARROW_BUF_RECORD_OFFS],
+                            count_list[AUSHAPE_ARROW_COUNT_RECORD]));
+    count_list[AUSHAPE_ARROW_COUNT_ROW]++;
+
+    *padded = true;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    /* Roll back the partially-added event, if dropped or failed */
+    if (rc != AUSHAPE_RC_OK || record_num == 0) {
+        for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+            buf_list[i].len = len_list[i];
+        }
+        memcpy(count_list, orig_count_list, sizeof(orig_count_list));
+    }
+    assert(aushape_arrow_is_valid(arrow));
+    return rc;
+}
+
+enum aushape_rc
+aushape_arrow_write_schema(struct aushape_arrow *arrow,
+                           struct aushape_gbuf *gbuf)
+{
+    enum aushape_rc rc;
+    const struct aushape_arrow_fb_field field_list[] = {
+        {.size = 0},                    /* endianness, default little */
+        {.size = 4},                    /* fields */
+    };
+    size_t pos_list[AUSHAPE_ARRAY_SIZE(field_list)];
+    size_t field_num;
+    size_t base;
+    size_t header;
+    size_t obj;
+    size_t data;
+    size_t i;
+
+    assert(aushape_arrow_is_valid(arrow));
+    assert(aushape_gbuf_is_valid(gbuf));
+
+    if (arrow->schema_done) {
+        return AUSHAPE_RC_OK;
+    }
+
+    AUSHAPE_GUARD(aushape_arrow_msg_begin(gbuf, AUSHAPE_ARROW_HEADER_SCHEMA,
+                                          0, &base, &header));
+    AUSHAPE_GUARD(aushape_arrow_fb_add_table(gbuf, base,
+                                             field_list,
+                                             AUSHAPE_ARRAY_SIZE(field_list),
+                                             pos_list, &obj));
+    aushape_arrow_fb_patch(gbuf, header, obj);
+
+    field_num = AUSHAPE_ARROW_EVENT_FIELD_NUM - !arrow->with_text;
+    AUSHAPE_GUARD(aushape_arrow_fb_add_vector(gbuf, base, 4, field_num,
+                                              &obj, &data));
+    aushape_arrow_fb_patch(gbuf, pos_list[1], obj);
+    for (i = 0; i < AUSHAPE_ARROW_EVENT_FIELD_NUM; i++) {
+        if (i == AUSHAPE_ARROW_EVENT_FIELD_TEXT && !arrow->with_text) {
+            continue;
+        }
+        AUSHAPE_GUARD(aushape_arrow_fb_add_field(
+                                gbuf, base,
+                                &aushape_arrow_event_field_list[i],
+                                &obj));
+        aushape_arrow_fb_patch(gbuf, data, obj);
+        data += 4;
+    }
+
+    AUSHAPE_GUARD(aushape_arrow_msg_end(gbuf, base));
+    arrow->schema_done = true;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    assert(aushape_arrow_is_valid(arrow));
+    return rc;
+}
+
+enum aushape_rc
+aushape_arrow_write_batch(struct aushape_arrow *arrow,
+                          struct aushape_gbuf *gbuf)
+{
+    static const enum aushape_arrow_buf offs_list[] = {
+        AUSHAPE_ARROW_BUF_NODE_OFFS,
+        AUSHAPE_ARROW_BUF_TEXT_OFFS,
+        AUSHAPE_ARROW_BUF_LINE_OFFS,
+        AUSHAPE_ARROW_BUF_RECORD_OFFS,
+        AUSHAPE_ARROW_BUF_FIELD_OFFS,
+        AUSHAPE_ARROW_BUF_VALUE_OFFS,
+        AUSHAPE_ARROW_BUF_RAW_OFFS,
+    };
+    enum aushape_rc rc;
+    struct aushape_gbuf *buf_list = arrow->buf_list;
+    const size_t *count_list = arrow->count_list;
+    struct aushape_arrow_node node_list[AUSHAPE_ARROW_MAX_NODES];
+    struct aushape_arrow_body body_list[AUSHAPE_ARROW_MAX_BODIES];
+    size_t node_num = 0;
+    size_t body_num = 0;
+    size_t i;
+
+    assert(aushape_arrow_is_valid(arrow));
+    assert(aushape_gbuf_is_valid(gbuf));
+
+    AUSHAPE_GUARD(aushape_arrow_write_schema(arrow, gbuf));
+
+    /* Output the dictionaries first time, and their deltas afterwards */
+    if (arrow->batch_num == 0 || arrow->types.len > arrow->types.sent) {
+        AUSHAPE_GUARD(aushape_arrow_dict_write(&arrow->types,
+                                               AUSHAPE_ARROW_DICT_ID_TYPES,
+                                               arrow->batch_num > 0,
+                                               &arrow->scratch, gbuf));
+    }
+    if (arrow->batch_num == 0 || arrow->names.len > arrow->names.sent) {
+        AUSHAPE_GUARD(aushape_arrow_dict_write(&arrow->names,
+                                               AUSHAPE_ARROW_DICT_ID_NAMES,
+                                               arrow->batch_num > 0,
+                                               &arrow->scratch, gbuf));
+    }
+
+    /* Make sure offset buffers have at least the initial offset */
+    for (i = 0; i < AUSHAPE_ARRAY_SIZE(offs_list); i++) {
+        if (buf_list[offs_list[i]].len == 0) {
+            AUSHAPE_GUARD(aushape_arrow_add_le(&buf_list[offs_list[i]],
+                                               0, 4));
+        }
+    }
+
+#define NODE(_len, _null_num) \
+    do {                                                    \
+        assert(node_num < AUSHAPE_ARRAY_SIZE(node_list));   \
+        node_list[node_num].len = count_list[_len];         \
+        node_list[node_num].null_num = (_null_num);         \
+        node_num++;                                         \
+    } while (0)
+#define BODY(_buf) \
+    do {                                                    \
+        assert(body_num < AUSHAPE_ARRAY_SIZE(body_list));   \
+        body_list[body_num].ptr = buf_list[_buf].ptr;       \
+        body_list[body_num].len = buf_list[_buf].len;       \
+        body_num++;                                         \
+    } while (0)
+#define NO_BODY() \
+    do {                                                    \
+        assert(body_num < AUSHAPE_ARRAY_SIZE(body_list));   \
+        body_list[body_num].ptr = NULL;                     \
+        body_list[body_num].len = 0;                        \
+        body_num++;                                         \
+    } while (0)
+
+    /* serial */
+    NODE(AUSHAPE_ARROW_COUNT_ROW, 0);
+    NO_BODY();
+    BODY(AUSHAPE_ARROW_BUF_SERIAL);
+    /* time */
+    NODE(AUSHAPE_ARROW_COUNT_ROW, 0);
+    NO_BODY();
+    BODY(AUSHAPE_ARROW_BUF_TIME);
+    /* node */
+    NODE(AUSHAPE_ARROW_COUNT_ROW, count_list[AUSHAPE_ARROW_COUNT_NODE_NULL]);
+    BODY(AUSHAPE_ARROW_BUF_NODE_VALID);
+    BODY(AUSHAPE_ARROW_BUF_NODE_OFFS);
+    BODY(AUSHAPE_ARROW_BUF_NODE_DATA);
+    if (arrow->with_text) {
+        /* text */
+        NODE(AUSHAPE_ARROW_COUNT_ROW, 0);
+        NO_BODY();
+        BODY(AUSHAPE_ARROW_BUF_TEXT_OFFS);
+        /* text item */
+        NODE(AUSHAPE_ARROW_COUNT_LINE, 0);
+        NO_BODY();
+        BODY(AUSHAPE_ARROW_BUF_LINE_OFFS);
+        BODY(AUSHAPE_ARROW_BUF_LINE_DATA);
+    }
+    /* records */
+    NODE(AUSHAPE_ARROW_COUNT_ROW, 0);
+    NO_BODY();
+    BODY(AUSHAPE_ARROW_BUF_RECORD_OFFS);
+    /* record */
+    NODE(AUSHAPE_ARROW_COUNT_RECORD, 0);
+    NO_BODY();
+    /* record type */
+    NODE(AUSHAPE_ARROW_COUNT_RECORD, 0);
+    NO_BODY();
+    BODY(AUSHAPE_ARROW_BUF_TYPE_IDX);
+    /* record fields */
+    NODE(AUSHAPE_ARROW_COUNT_RECORD, 0);
+    NO_BODY();
+    BODY(AUSHAPE_ARROW_BUF_FIELD_OFFS);
+    /* field */
+    NODE(AUSHAPE_ARROW_COUNT_FIELD, 0);
+    NO_BODY();
+    /* field name */
+    NODE(AUSHAPE_ARROW_COUNT_FIELD, 0);
+    NO_BODY();
+    BODY(AUSHAPE_ARROW_BUF_NAME_IDX);
+    /* field value */
+    NODE(AUSHAPE_ARROW_COUNT_FIELD, 0);
+    NO_BODY();
+    BODY(AUSHAPE_ARROW_BUF_VALUE_OFFS);
+    BODY(AUSHAPE_ARROW_BUF_VALUE_DATA);
+    /* field raw value */
+    NODE(AUSHAPE_ARROW_COUNT_FIELD,
+         count_list[AUSHAPE_ARROW_COUNT_RAW_NULL]);
+    BODY(AUSHAPE_ARROW_BUF_RAW_VALID);
+    BODY(AUSHAPE_ARROW_BUF_RAW_OFFS);
+    BODY(AUSHAPE_ARROW_BUF_RAW_DATA);
+
+#undef NO_BODY
+#undef BODY
+#undef NODE
+
+    AUSHAPE_GUARD(aushape_arrow_add_batch_msg(
+                        gbuf, false, 0, false,
+                        count_list[AUSHAPE_ARROW_COUNT_ROW],
+                        node_list, node_num, body_list, body_num));
+
+    /* Start a new batch */
+    for (i = 0; i < AUSHAPE_ARROW_BUF_NUM; i++) {
+        aushape_gbuf_empty(&buf_list[i]);
+    }
+    memset(arrow->count_list, 0, sizeof(arrow->count_list));
+    arrow->batch_num++;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    assert(aushape_arrow_is_valid(arrow));
+    return rc;
+}
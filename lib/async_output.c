@@ -0,0 +1,779 @@
+/*
+ * Asynchronous aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/async_output.h>
+#include <aushape/gbuf.h>
+#include <aushape/guard.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Initial size of item data buffers, bytes */
+#define AUSHAPE_ASYNC_OUTPUT_BUF_SIZE   4096
+
+/** Queue item */
+struct aushape_async_output_item {
+    /** Output */
+    struct aushape_gbuf data;
+    /** Notified events, an array of struct aushape_output_event */
+    struct aushape_gbuf events;
+    /** True if the item ends at a document boundary */
+    bool boundary;
+};
+
+/** Header of an item spilled to the temporary file */
+struct aushape_async_output_spill_hdr {
+    size_t data_len;            /**< Length of the output */
+    size_t events_len;          /**< Length of the events array, bytes */
+    bool boundary;              /**< True if ends at a document boundary */
+};
+
+/** Asynchronous output data */
+struct aushape_async_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    struct aushape_output *inner;   /**< Output to write to */
+    bool inner_owned;               /**< True if inner output is owned */
+    /** Full queue policy */
+    enum aushape_async_output_policy policy;
+
+    /** Item being filled, accessed by the converting thread only */
+    struct aushape_async_output_item fill;
+    /** Item being written, accessed by the writer thread only */
+    struct aushape_async_output_item work;
+
+    /** Queue item ring */
+    struct aushape_async_output_item   *item_list;
+    /** Number of items in the ring */
+    size_t                              item_num;
+
+    /** Temporary file spilled items are appended to, or NULL */
+    FILE           *spill;
+    /** Offset of the next spilled item to read */
+    off_t           spill_read;
+    /** Offset to append the next spilled item at */
+    off_t           spill_write;
+
+    /** True if the mutex and conditions below are initialized */
+    bool            sync_init;
+    /** Mutex protecting everything below and the queue items */
+    pthread_mutex_t mutex;
+    /** Condition signaled when an item is queued, or the writer stops */
+    pthread_cond_t  queued_cond;
+    /** Condition signaled when the writer takes or writes an item */
+    pthread_cond_t  taken_cond;
+    /** Index of the oldest item in the ring */
+    size_t          head;
+    /** Number of items in the ring */
+    size_t          count;
+    /** Number of items in the temporary file */
+    size_t          spill_num;
+    /** True if the writer is writing an item */
+    bool            busy;
+    /** True if the writer should exit when out of items */
+    bool            stop;
+    /** True if the writer thread is running */
+    bool            writer_run;
+    /** Writer thread */
+    pthread_t       writer;
+    /** First failure return code, or OK */
+    enum aushape_rc rc;
+    /** Statistics, except depths */
+    struct aushape_async_output_stats stats;
+};
+
+/**
+ * Initialize a queue item.
+ *
+ * @param item  The item to initialize.
+ */
+static void
+aushape_async_output_item_init(struct aushape_async_output_item *item)
+{
+    assert(item != NULL);
+    aushape_gbuf_init(&item->data, AUSHAPE_ASYNC_OUTPUT_BUF_SIZE, NULL);
+    aushape_gbuf_init(&item->events,
+                      sizeof(struct aushape_output_event) * 16, NULL);
+    item->boundary = false;
+}
+
+/**
+ * Empty a queue item, keeping its memory.
+ *
+ * @param item  The item to empty.
+ */
+static void
+aushape_async_output_item_empty(struct aushape_async_output_item *item)
+{
+    assert(item != NULL);
+    aushape_gbuf_empty(&item->data);
+    aushape_gbuf_empty(&item->events);
+    item->boundary = false;
+}
+
+/**
+ * Check if a queue item is empty.
+ *
+ * @param item  The item to check.
+ *
+ * @return True if the item has no output or events, false otherwise.
+ */
+static bool
+aushape_async_output_item_is_empty(
+                            const struct aushape_async_output_item *item)
+{
+    assert(item != NULL);
+    return item->data.len == 0 && item->events.len == 0;
+}
+
+/**
+ * Cleanup a queue item, freeing its memory.
+ *
+ * @param item  The item to cleanup.
+ */
+static void
+aushape_async_output_item_cleanup(struct aushape_async_output_item *item)
+{
+    assert(item != NULL);
+    aushape_gbuf_cleanup(&item->data);
+    aushape_gbuf_cleanup(&item->events);
+}
+
+/**
+ * Swap the contents of two queue items.
+ *
+ * @param a     The first item to swap.
+ * @param b     The second item to swap.
+ */
+static void
+aushape_async_output_item_swap(struct aushape_async_output_item *a,
+                               struct aushape_async_output_item *b)
+{
+    struct aushape_async_output_item tmp;
+    assert(a != NULL);
+    assert(b != NULL);
+    tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/**
+ * Write a piece to the temporary file of an asynchronous output completely.
+ *
+ * @param async_output  The asynchronous output to write the file of.
+ * @param ptr           The piece to write.
+ * @param len           Length of the piece.
+ *
+ * @return True if written successfully, false otherwise.
+ */
+static bool
+aushape_async_output_spill_write(struct aushape_async_output *async_output,
+                                 const void *ptr, size_t len)
+{
+    ssize_t rc;
+
+    assert(async_output != NULL);
+    assert(async_output->spill != NULL);
+
+    while (len > 0) {
+        rc = pwrite(fileno(async_output->spill), ptr, len,
+                    async_output->spill_write);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ptr = (const char *)ptr + rc;
+        len -= (size_t)rc;
+        async_output->spill_write += rc;
+    }
+    return true;
+}
+
+/**
+ * Read a piece from the temporary file of an asynchronous output completely.
+ *
+ * @param async_output  The asynchronous output to read the file of.
+ * @param ptr           The buffer to read into.
+ * @param len           Length of the piece to read.
+ *
+ * @return True if read successfully, false otherwise.
+ */
+static bool
+aushape_async_output_spill_read(struct aushape_async_output *async_output,
+                                void *ptr, size_t len)
+{
+    ssize_t rc;
+
+    assert(async_output != NULL);
+    assert(async_output->spill != NULL);
+
+    while (len > 0) {
+        rc = pread(fileno(async_output->spill), ptr, len,
+                   async_output->spill_read);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        } else if (rc == 0) {
+            return false;
+        }
+        ptr = (char *)ptr + rc;
+        len -= (size_t)rc;
+        async_output->spill_read += rc;
+    }
+    return true;
+}
+
+/**
+ * Append an item to the temporary file of an asynchronous output, with the
+ * mutex locked.
+ *
+ * @param async_output  The asynchronous output to spill the item of.
+ * @param item          The item to spill.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - spilled successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - writing the file failed.
+ */
+static enum aushape_rc
+aushape_async_output_spill_put(struct aushape_async_output *async_output,
+                               const struct aushape_async_output_item *item)
+{
+    struct aushape_async_output_spill_hdr hdr;
+
+    assert(async_output != NULL);
+    assert(item != NULL);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.data_len = item->data.len;
+    hdr.events_len = item->events.len;
+    hdr.boundary = item->boundary;
+    if (!aushape_async_output_spill_write(async_output, &hdr, sizeof(hdr)) ||
+        !aushape_async_output_spill_write(async_output,
+                                          item->data.ptr, item->data.len) ||
+        !aushape_async_output_spill_write(async_output,
+                                          item->events.ptr,
+                                          item->events.len)) {
+        return AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+    }
+    async_output->spill_num++;
+    async_output->stats.spilled++;
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Take the oldest item from the temporary file of an asynchronous output,
+ * with the mutex locked, and truncate the file once it's drained.
+ *
+ * @param async_output  The asynchronous output to take the item from.
+ * @param item          The empty item to read the item into.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - taken successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - reading the file failed.
+ */
+static enum aushape_rc
+aushape_async_output_spill_get(struct aushape_async_output *async_output,
+                               struct aushape_async_output_item *item)
+{
+    enum aushape_rc rc;
+    struct aushape_async_output_spill_hdr hdr;
+
+    assert(async_output != NULL);
+    assert(async_output->spill_num > 0);
+    assert(aushape_async_output_item_is_empty(item));
+
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                       aushape_async_output_spill_read(async_output,
+                                                       &hdr, sizeof(hdr)));
+    AUSHAPE_GUARD(aushape_gbuf_accomodate(&item->data, hdr.data_len));
+    AUSHAPE_GUARD(aushape_gbuf_accomodate(&item->events, hdr.events_len));
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                       aushape_async_output_spill_read(async_output,
+                                                       item->data.ptr,
+                                                       hdr.data_len) &&
+                       aushape_async_output_spill_read(async_output,
+                                                       item->events.ptr,
+                                                       hdr.events_len));
+    item->data.len = hdr.data_len;
+    item->events.len = hdr.events_len;
+    item->boundary = hdr.boundary;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    async_output->spill_num--;
+    /* Reclaim the space once drained, or give up on the rest on failure */
+    if (async_output->spill_num == 0 || rc != AUSHAPE_RC_OK) {
+        async_output->spill_num = 0;
+        async_output->spill_read = 0;
+        async_output->spill_write = 0;
+        if (ftruncate(fileno(async_output->spill), 0) < 0 &&
+            rc == AUSHAPE_RC_OK) {
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+    }
+    return rc;
+}
+
+/**
+ * Run the writer of an asynchronous output: write queued items to the
+ * inner output in order, until stopped and out of items. After a failure,
+ * discard the items, so the converting thread doesn't wait for them.
+ *
+ * @param arg   The asynchronous output to run the writer for.
+ *
+ * @return NULL.
+ */
+static void *
+aushape_async_output_writer_run(void *arg)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)arg;
+    struct aushape_async_output_item *work = &async_output->work;
+    const struct aushape_output_event *event;
+    const struct aushape_output_event *events_end;
+    enum aushape_rc rc;
+
+    pthread_mutex_lock(&async_output->mutex);
+    while (true) {
+        while (!async_output->stop &&
+               async_output->count == 0 && async_output->spill_num == 0) {
+            pthread_cond_wait(&async_output->queued_cond,
+                              &async_output->mutex);
+        }
+        if (async_output->count > 0) {
+            aushape_async_output_item_swap(
+                    work, &async_output->item_list[async_output->head]);
+            async_output->head = (async_output->head + 1) %
+                                 async_output->item_num;
+            async_output->count--;
+            rc = async_output->rc;
+        } else if (async_output->spill_num > 0) {
+            rc = aushape_async_output_spill_get(async_output, work);
+            if (async_output->rc == AUSHAPE_RC_OK) {
+                async_output->rc = rc;
+            }
+            rc = async_output->rc;
+        } else {
+            break;
+        }
+        async_output->busy = true;
+        pthread_cond_broadcast(&async_output->taken_cond);
+        pthread_mutex_unlock(&async_output->mutex);
+
+        if (rc == AUSHAPE_RC_OK) {
+            if (work->events.len > 0) {
+                event = (const struct aushape_output_event *)
+                            work->events.ptr;
+                events_end = (const struct aushape_output_event *)
+                                (work->events.ptr + work->events.len);
+                for (; event < events_end && rc == AUSHAPE_RC_OK; event++) {
+                    rc = aushape_output_event(async_output->inner, event);
+                }
+            }
+            if (rc == AUSHAPE_RC_OK && work->data.len > 0) {
+                rc = aushape_output_write(async_output->inner,
+                                          work->data.ptr, work->data.len);
+            }
+            if (rc == AUSHAPE_RC_OK && work->boundary) {
+                rc = aushape_output_sync(async_output->inner, false);
+            }
+        }
+        aushape_async_output_item_empty(work);
+
+        pthread_mutex_lock(&async_output->mutex);
+        async_output->busy = false;
+        if (rc == AUSHAPE_RC_OK) {
+            async_output->stats.written++;
+        } else if (async_output->rc == AUSHAPE_RC_OK) {
+            async_output->rc = rc;
+        }
+        pthread_cond_broadcast(&async_output->taken_cond);
+    }
+    pthread_mutex_unlock(&async_output->mutex);
+
+    return NULL;
+}
+
+static void aushape_async_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_async_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)output;
+    struct aushape_output *inner = va_arg(ap, struct aushape_output *);
+    bool inner_owned = (bool)va_arg(ap, int);
+    size_t queue_size = va_arg(ap, size_t);
+    enum aushape_async_output_policy policy =
+                        (enum aushape_async_output_policy)va_arg(ap, int);
+    enum aushape_rc rc;
+    size_t i;
+
+    assert(async_output != NULL);
+
+    if (!aushape_output_is_valid(inner) ||
+        aushape_output_is_cont(inner) != output->type->cont ||
+        queue_size == 0 ||
+        !aushape_async_output_policy_is_valid(policy)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    async_output->policy = policy;
+    aushape_async_output_item_init(&async_output->fill);
+    aushape_async_output_item_init(&async_output->work);
+
+    /* Allocate the queue */
+    async_output->item_list = calloc(queue_size,
+                                     sizeof(*async_output->item_list));
+    AUSHAPE_GUARD_BOOL(NOMEM, async_output->item_list != NULL);
+    async_output->item_num = queue_size;
+    for (i = 0; i < async_output->item_num; i++) {
+        aushape_async_output_item_init(&async_output->item_list[i]);
+    }
+
+    if (policy == AUSHAPE_ASYNC_OUTPUT_POLICY_SPILL) {
+        async_output->spill = tmpfile();
+        AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, async_output->spill != NULL);
+    }
+
+    /* Start the writer */
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_mutex_init(&async_output->mutex, NULL) == 0);
+    if (pthread_cond_init(&async_output->queued_cond, NULL) != 0) {
+        pthread_mutex_destroy(&async_output->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    if (pthread_cond_init(&async_output->taken_cond, NULL) != 0) {
+        pthread_cond_destroy(&async_output->queued_cond);
+        pthread_mutex_destroy(&async_output->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    async_output->sync_init = true;
+    async_output->inner = inner;
+    /* Events are queued whole, fields included */
+    output->event_fields = inner->event_fields;
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_create(&async_output->writer, NULL,
+                                      aushape_async_output_writer_run,
+                                      async_output) == 0);
+    async_output->writer_run = true;
+
+    async_output->inner_owned = inner_owned;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_async_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_async_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)output;
+    assert(async_output != NULL);
+
+    return aushape_output_is_valid(async_output->inner) &&
+           aushape_async_output_policy_is_valid(async_output->policy) &&
+           (async_output->policy != AUSHAPE_ASYNC_OUTPUT_POLICY_SPILL ||
+            async_output->spill != NULL) &&
+           async_output->item_list != NULL &&
+           async_output->item_num > 0 &&
+           async_output->writer_run &&
+           aushape_gbuf_is_valid(&async_output->fill.data) &&
+           aushape_gbuf_is_valid(&async_output->fill.events);
+}
+
+/**
+ * Queue the item being filled, applying the full queue policy, if needed.
+ *
+ * @param async_output  The asynchronous output to queue the item of.
+ * @param boundary      True if the item ends at a document boundary.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - queued, or dropped
+ *                                            successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - spilling or writing failed.
+ */
+static enum aushape_rc
+aushape_async_output_queue(struct aushape_async_output *async_output,
+                           bool boundary)
+{
+    enum aushape_rc rc;
+    struct aushape_async_output_item *fill = &async_output->fill;
+    struct aushape_async_output_stats *stats = &async_output->stats;
+
+    assert(async_output != NULL);
+
+    if (aushape_async_output_item_is_empty(fill)) {
+        return AUSHAPE_RC_OK;
+    }
+    fill->boundary = boundary;
+
+    pthread_mutex_lock(&async_output->mutex);
+    AUSHAPE_GUARD(async_output->rc);
+
+    /* Keep spilling until the spilled items are written */
+    if (async_output->spill_num > 0) {
+        AUSHAPE_GUARD(aushape_async_output_spill_put(async_output, fill));
+        goto queued;
+    }
+
+    if (async_output->count == async_output->item_num) {
+        stats->full++;
+        switch (async_output->policy) {
+        case AUSHAPE_ASYNC_OUTPUT_POLICY_BLOCK:
+            stats->stalls++;
+            do {
+                pthread_cond_wait(&async_output->taken_cond,
+                                  &async_output->mutex);
+                AUSHAPE_GUARD(async_output->rc);
+            } while (async_output->count == async_output->item_num);
+            break;
+        case AUSHAPE_ASYNC_OUTPUT_POLICY_DROP_NEWEST:
+            stats->dropped++;
+            goto queued;
+        case AUSHAPE_ASYNC_OUTPUT_POLICY_DROP_OLDEST:
+            stats->dropped++;
+            aushape_async_output_item_empty(
+                        &async_output->item_list[async_output->head]);
+            async_output->head = (async_output->head + 1) %
+                                 async_output->item_num;
+            async_output->count--;
+            break;
+        case AUSHAPE_ASYNC_OUTPUT_POLICY_SPILL:
+            AUSHAPE_GUARD(aushape_async_output_spill_put(async_output, fill));
+            goto queued;
+        default:
+            assert(false);
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            goto cleanup;
+        }
+    }
+
+    /* Swap the filled item with the empty one in the ring */
+    aushape_async_output_item_swap(
+            fill,
+            &async_output->item_list[(async_output->head +
+                                      async_output->count) %
+                                     async_output->item_num]);
+    async_output->count++;
+    if (async_output->count > stats->max_depth) {
+        stats->max_depth = async_output->count;
+    }
+
+queued:
+    pthread_cond_signal(&async_output->queued_cond);
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_async_output_item_empty(fill);
+    if (async_output->rc == AUSHAPE_RC_OK) {
+        async_output->rc = rc;
+    }
+    pthread_mutex_unlock(&async_output->mutex);
+    return rc;
+}
+
+static enum aushape_rc
+aushape_async_output_write(struct aushape_output *output,
+                           const char *ptr,
+                           size_t len)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)output;
+    enum aushape_rc rc;
+
+    assert(async_output != NULL);
+
+    if (len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+    rc = aushape_gbuf_add_buf(&async_output->fill.data, ptr, len);
+    if (rc != AUSHAPE_RC_OK) {
+        return rc;
+    }
+    /* Discrete outputs get complete documents with every write */
+    if (!output->type->cont) {
+        return aushape_async_output_queue(async_output, true);
+    } else if (async_output->fill.data.len >=
+               AUSHAPE_ASYNC_OUTPUT_ITEM_SIZE) {
+        return aushape_async_output_queue(async_output, false);
+    }
+    return AUSHAPE_RC_OK;
+}
+
+static enum aushape_rc
+aushape_async_output_event(struct aushape_output *output,
+                           const struct aushape_output_event *event)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)output;
+
+    assert(async_output != NULL);
+    assert(event != NULL);
+
+    return aushape_gbuf_add_buf(&async_output->fill.events,
+                                event, sizeof(*event));
+}
+
+static enum aushape_rc
+aushape_async_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)output;
+    enum aushape_rc rc;
+
+    assert(async_output != NULL);
+
+    rc = aushape_async_output_queue(async_output, true);
+    if (rc != AUSHAPE_RC_OK || !full) {
+        return rc;
+    }
+
+    /* Wait for the writer to write everything */
+    pthread_mutex_lock(&async_output->mutex);
+    while (async_output->rc == AUSHAPE_RC_OK &&
+           (async_output->count > 0 || async_output->spill_num > 0 ||
+            async_output->busy)) {
+        pthread_cond_wait(&async_output->taken_cond, &async_output->mutex);
+    }
+    rc = async_output->rc;
+    pthread_mutex_unlock(&async_output->mutex);
+    if (rc != AUSHAPE_RC_OK) {
+        return rc;
+    }
+
+    /* The writer is idle until the next item, synchronize ourselves */
+    rc = aushape_output_sync(async_output->inner, true);
+    if (rc != AUSHAPE_RC_OK) {
+        pthread_mutex_lock(&async_output->mutex);
+        if (async_output->rc == AUSHAPE_RC_OK) {
+            async_output->rc = rc;
+        }
+        pthread_mutex_unlock(&async_output->mutex);
+    }
+    return rc;
+}
+
+static void
+aushape_async_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)output;
+    size_t i;
+
+    assert(async_output != NULL);
+
+    /* Try to queue the remaining output, and stop the writer */
+    if (async_output->writer_run) {
+        aushape_async_output_queue(async_output, true);
+        pthread_mutex_lock(&async_output->mutex);
+        async_output->stop = true;
+        pthread_cond_signal(&async_output->queued_cond);
+        pthread_mutex_unlock(&async_output->mutex);
+        pthread_join(async_output->writer, NULL);
+        async_output->writer_run = false;
+    }
+
+    if (async_output->sync_init) {
+        pthread_cond_destroy(&async_output->taken_cond);
+        pthread_cond_destroy(&async_output->queued_cond);
+        pthread_mutex_destroy(&async_output->mutex);
+        async_output->sync_init = false;
+    }
+
+    if (async_output->spill != NULL) {
+        fclose(async_output->spill);
+        async_output->spill = NULL;
+    }
+
+    for (i = 0; i < async_output->item_num; i++) {
+        aushape_async_output_item_cleanup(&async_output->item_list[i]);
+    }
+    free(async_output->item_list);
+    async_output->item_list = NULL;
+    async_output->item_num = 0;
+    aushape_async_output_item_cleanup(&async_output->fill);
+    aushape_async_output_item_cleanup(&async_output->work);
+
+    if (async_output->inner_owned) {
+        aushape_output_destroy(async_output->inner);
+        async_output->inner = NULL;
+        async_output->inner_owned = false;
+    }
+}
+
+enum aushape_rc
+aushape_async_output_get_stats(const struct aushape_output *output,
+                               struct aushape_async_output_stats *pstats)
+{
+    struct aushape_async_output *async_output =
+                                    (struct aushape_async_output *)output;
+
+    if (!aushape_output_is_valid(output) ||
+        (output->type != &aushape_async_output_type &&
+         output->type != &aushape_async_disc_output_type) ||
+        pstats == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    pthread_mutex_lock(&async_output->mutex);
+    *pstats = async_output->stats;
+    pstats->depth = async_output->count;
+    pstats->spill_depth = async_output->spill_num;
+    pthread_mutex_unlock(&async_output->mutex);
+
+    return AUSHAPE_RC_OK;
+}
+
+const struct aushape_output_type aushape_async_output_type = {
+    .size       = sizeof(struct aushape_async_output),
+    .cont       = true,
+    .init       = aushape_async_output_init,
+    .is_valid   = aushape_async_output_is_valid,
+    .write      = aushape_async_output_write,
+    .sync       = aushape_async_output_sync,
+    .event      = aushape_async_output_event,
+    .cleanup    = aushape_async_output_cleanup,
+};
+
+const struct aushape_output_type aushape_async_disc_output_type = {
+    .size       = sizeof(struct aushape_async_output),
+    .cont       = false,
+    .init       = aushape_async_output_init,
+    .is_valid   = aushape_async_output_is_valid,
+    .write      = aushape_async_output_write,
+    .sync       = aushape_async_output_sync,
+    .event      = aushape_async_output_event,
+    .cleanup    = aushape_async_output_cleanup,
+};
@@ -24,8 +24,7 @@
 enum aushape_rc
 aushape_coll_create(struct aushape_coll **pcoll,
                     const struct aushape_coll_type *type,
-                    const struct aushape_format *format,
-                    struct aushape_gbtree *gbtree,
+                    struct aushape_itree *itree,
                     const void *args)
 {
     enum aushape_rc rc;
@@ -33,18 +32,18 @@ aushape_coll_create(struct aushape_coll **pcoll,
 
     if (pcoll == NULL ||
         !aushape_coll_type_is_valid(type) ||
-        !aushape_format_is_valid(format) ||
-        !aushape_gbtree_is_valid(gbtree)) {
+        !aushape_itree_is_valid(itree)) {
         return AUSHAPE_RC_INVALID_ARGS;
     }
 
-    coll = calloc(type->size, 1);
+    coll = aushape_mem_realloc(aushape_itree_pool_get_mem(itree->pool),
+                               NULL, type->size);
     if (coll == NULL) {
         rc = AUSHAPE_RC_NOMEM;
     } else {
+        memset(coll, 0, type->size);
         coll->type = type;
-        coll->format = *format;
-        coll->gbtree = gbtree;
+        coll->itree = itree;
 
         rc = (type->init != NULL) ? type->init(coll, args) : AUSHAPE_RC_OK;
         if (rc == AUSHAPE_RC_OK) {
@@ -53,7 +52,7 @@ aushape_coll_create(struct aushape_coll **pcoll,
             assert(!aushape_coll_is_ended(coll));
             *pcoll = coll;
         } else {
-            free(coll);
+            aushape_mem_free(aushape_itree_pool_get_mem(itree->pool), coll);
         }
     }
 
@@ -65,8 +64,7 @@ aushape_coll_is_valid(const struct aushape_coll *coll)
 {
     return coll != NULL &&
            aushape_coll_type_is_valid(coll->type) &&
-           aushape_format_is_valid(&coll->format) &&
-           aushape_gbtree_is_valid(coll->gbtree) &&
+           aushape_itree_is_valid(coll->itree) &&
            (coll->type->is_valid == NULL ||
             coll->type->is_valid(coll));
 }
@@ -74,6 +72,8 @@ aushape_coll_is_valid(const struct aushape_coll *coll)
 void
 aushape_coll_destroy(struct aushape_coll *coll)
 {
+    const struct aushape_mem *mem;
+
     assert(coll == NULL || aushape_coll_is_valid(coll));
 
     if (coll == NULL) {
@@ -82,8 +82,9 @@ aushape_coll_destroy(struct aushape_coll *coll)
     if (coll->type->cleanup != NULL) {
         coll->type->cleanup(coll);
     }
+    mem = aushape_itree_pool_get_mem(coll->itree->pool);
     memset(coll, 0, coll->type->size);
-    free(coll);
+    aushape_mem_free(mem, coll);
 }
 
 bool
@@ -108,6 +109,29 @@ aushape_coll_empty(struct aushape_coll *coll)
     assert(!aushape_coll_is_ended(coll));
 }
 
+void
+aushape_coll_shrink(struct aushape_coll *coll)
+{
+    assert(aushape_coll_is_valid(coll));
+    if (coll->type->shrink != NULL) {
+        coll->type->shrink(coll);
+    }
+    assert(aushape_coll_is_valid(coll));
+}
+
+void
+aushape_coll_get_mem_usage(const struct aushape_coll *coll,
+                           struct aushape_mem_usage *usage)
+{
+    assert(aushape_coll_is_valid(coll));
+    assert(usage != NULL);
+    usage->size += coll->type->size;
+    usage->peak += coll->type->size;
+    if (coll->type->get_mem_usage != NULL) {
+        coll->type->get_mem_usage(coll, usage);
+    }
+}
+
 bool
 aushape_coll_is_ended(const struct aushape_coll *coll)
 {
@@ -118,19 +142,19 @@ aushape_coll_is_ended(const struct aushape_coll *coll)
 enum aushape_rc
 aushape_coll_add(struct aushape_coll *coll,
                  size_t *pcount,
-                 size_t level,
                  size_t prio,
-                 auparse_state_t *au)
+                 const struct aushape_itree_node *record)
 {
     enum aushape_rc rc;
-    if (!aushape_coll_is_valid(coll) || pcount == NULL || au == NULL) {
+    if (!aushape_coll_is_valid(coll) || pcount == NULL ||
+        record == NULL || record->type != AUSHAPE_ITREE_NODE_TYPE_RECORD) {
         return AUSHAPE_RC_INVALID_ARGS;
     }
     if (aushape_coll_is_ended(coll)) {
         return AUSHAPE_RC_INVALID_STATE;
     }
     rc = (coll->type->add != NULL)
-                ? coll->type->add(coll, pcount, level, prio, au)
+                ? coll->type->add(coll, pcount, prio, record)
                 : AUSHAPE_RC_OK;
     assert(aushape_coll_is_valid(coll));
     assert(!aushape_coll_is_ended(coll));
@@ -140,7 +164,6 @@ aushape_coll_add(struct aushape_coll *coll,
 enum aushape_rc
 aushape_coll_end(struct aushape_coll *coll,
                  size_t *pcount,
-                 size_t level,
                  size_t prio)
 {
     enum aushape_rc rc;
@@ -151,7 +174,7 @@ aushape_coll_end(struct aushape_coll *coll,
         return AUSHAPE_RC_INVALID_STATE;
     }
     rc = (!aushape_coll_is_empty(coll) && coll->type->end != NULL)
-                ? coll->type->end(coll, pcount, level, prio)
+                ? coll->type->end(coll, pcount, prio)
                 : AUSHAPE_RC_OK;
     coll->ended = true;
     assert(aushape_coll_is_valid(coll));
@@ -0,0 +1,58 @@
+/*
+ * Aushape output compression algorithm.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/comp.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <assert.h>
+
+bool
+aushape_comp_is_available(enum aushape_comp comp)
+{
+    assert(aushape_comp_is_valid(comp));
+#ifdef HAVE_ZSTD
+    return true;
+#else
+    return comp != AUSHAPE_COMP_ZSTD;
+#endif
+}
+
+bool
+aushape_comp_level_is_valid(enum aushape_comp comp, int level)
+{
+    assert(aushape_comp_is_valid(comp));
+
+    if (level == AUSHAPE_COMP_LEVEL_DEFAULT) {
+        return true;
+    }
+    switch (comp) {
+    case AUSHAPE_COMP_GZIP:
+        return level >= Z_NO_COMPRESSION && level <= Z_BEST_COMPRESSION;
+#ifdef HAVE_ZSTD
+    case AUSHAPE_COMP_ZSTD:
+        return level >= ZSTD_minCLevel() && level <= ZSTD_maxCLevel();
+#endif
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,295 @@
+/*
+ * Compressed output frame index.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/comp_index.h>
+#include <aushape/guard.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+/** Size of a zstd seek table entry, without checksum */
+#define AUSHAPE_COMP_INDEX_ZSTD_SEEK_ENTRY_SIZE 8
+
+/**
+ * Add a little-endian unsigned integer to a growing buffer.
+ *
+ * @param gbuf  The growing buffer to add to.
+ * @param val   The value to add.
+ * @param size  Number of bytes to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_comp_index_add_le(struct aushape_gbuf *gbuf,
+                          uint64_t val, size_t size)
+{
+    enum aushape_rc rc;
+    size_t i;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(size <= 8);
+
+    for (i = 0; i < size; i++) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, (char)(val & 0xff)));
+        val >>= 8;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Format a time in milliseconds since epoch into an index.
+ *
+ * @param index The growing buffer with the index to add the time to.
+ * @param time  The time to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_comp_index_add_time(struct aushape_gbuf *index, long long time)
+{
+    const char *sign = "";
+    unsigned long long abs_time = (unsigned long long)time;
+
+    if (time < 0) {
+        sign = "-";
+        abs_time = -abs_time;
+    }
+    return aushape_gbuf_add_fmt(index, "%s%llu.%03llu",
+                                sign, abs_time / 1000, abs_time % 1000);
+}
+
+enum aushape_rc
+aushape_comp_index_add_frame(struct aushape_gbuf *index,
+                             const struct aushape_comp_index_frame *frame)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(index));
+    assert(frame != NULL);
+
+    if (index->len == 0) {
+        AUSHAPE_GUARD(aushape_gbuf_add_str(index, AUSHAPE_COMP_INDEX_MAGIC));
+    }
+    AUSHAPE_GUARD(aushape_gbuf_add_fmt(index,
+                                       "%" PRIu64 " %" PRIu64
+                                       " %" PRIu64 " %" PRIu64
+                                       " %lu %lu ",
+                                       frame->offset, frame->size,
+                                       frame->len, frame->events,
+                                       frame->first_serial,
+                                       frame->last_serial));
+    AUSHAPE_GUARD(aushape_comp_index_add_time(index, frame->earliest));
+    AUSHAPE_GUARD(aushape_gbuf_add_char(index, ' '));
+    AUSHAPE_GUARD(aushape_comp_index_add_time(index, frame->latest));
+    AUSHAPE_GUARD(aushape_gbuf_add_char(index, '\n'));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Parse a time in seconds since epoch, with three fractional digits.
+ *
+ * @param pstr  Location of the pointer to the string to parse, will be
+ *              advanced past the time.
+ * @param ptime Location for the parsed time, milliseconds since epoch.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+aushape_comp_index_parse_time(const char **pstr, long long *ptime)
+{
+    const char *p = *pstr;
+    bool negative = false;
+    long long time = 0;
+    size_t i;
+
+    if (*p == '-') {
+        negative = true;
+        p++;
+    }
+    if (*p < '0' || *p > '9') {
+        return false;
+    }
+    for (; *p >= '0' && *p <= '9'; p++) {
+        if (time > (LLONG_MAX / 1000 - 9) / 10) {
+            return false;
+        }
+        time = time * 10 + (*p - '0');
+    }
+    if (*p++ != '.') {
+        return false;
+    }
+    for (i = 0; i < 3; i++, p++) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        time = time * 10 + (*p - '0');
+    }
+    *ptime = negative ? -time : time;
+    *pstr = p;
+    return true;
+}
+
+bool
+aushape_comp_index_parse_frame(const char *line,
+                               struct aushape_comp_index_frame *frame)
+{
+    struct aushape_comp_index_frame f;
+    int end = 0;
+
+    assert(line != NULL);
+    assert(frame != NULL);
+
+    if (sscanf(line, "%" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64
+                     " %lu %lu %n",
+               &f.offset, &f.size, &f.len, &f.events,
+               &f.first_serial, &f.last_serial, &end) < 6 ||
+        end == 0) {
+        return false;
+    }
+    line += end;
+    if (!aushape_comp_index_parse_time(&line, &f.earliest) ||
+        *line++ != ' ' ||
+        !aushape_comp_index_parse_time(&line, &f.latest) ||
+        *line != '\0') {
+        return false;
+    }
+    *frame = f;
+    return true;
+}
+
+enum aushape_rc
+aushape_comp_index_add_seek(struct aushape_gbuf *seek,
+                            uint64_t size, uint64_t len)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(seek));
+
+    AUSHAPE_GUARD_BOOL(INVALID_ARGS,
+                       size <= UINT32_MAX && len <= UINT32_MAX);
+    AUSHAPE_GUARD(aushape_comp_index_add_le(seek, size, 4));
+    AUSHAPE_GUARD(aushape_comp_index_add_le(seek, len, 4));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_comp_index_add_trailer(struct aushape_gbuf *trailer,
+                               enum aushape_comp comp,
+                               const struct aushape_gbuf *index,
+                               const struct aushape_gbuf *seek,
+                               uint64_t offset)
+{
+    enum aushape_rc rc;
+    size_t entries;
+
+    assert(aushape_gbuf_is_valid(trailer));
+    assert(aushape_comp_is_valid(comp));
+    assert(aushape_gbuf_is_valid(index));
+    assert(index->len > 0);
+    assert(memchr(index->ptr, '\0', index->len) == NULL);
+    assert(aushape_gbuf_is_valid(seek));
+    assert(seek->len % AUSHAPE_COMP_INDEX_ZSTD_SEEK_ENTRY_SIZE == 0);
+
+    switch (comp) {
+    case AUSHAPE_COMP_GZIP:
+        /*
+         * Index member: gzip ID, deflate method, FCOMMENT flag,
+         * zero mtime, no extra flags, unknown OS, the comment,
+         * an empty final stored block, zero CRC32 and size.
+         */
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(trailer,
+                                           "\x1f\x8b\x08\x10"
+                                           "\x00\x00\x00\x00"
+                                           "\x00\xff", 10));
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(trailer, index->ptr, index->len));
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(trailer,
+                                           "\x00"
+                                           "\x03\x00"
+                                           "\x00\x00\x00\x00"
+                                           "\x00\x00\x00\x00", 11));
+        /* Locator member: same, but with FEXTRA instead of FCOMMENT */
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(trailer,
+                                           "\x1f\x8b\x08\x04"
+                                           "\x00\x00\x00\x00"
+                                           "\x00\xff"
+                                           "\x0c\x00", 12));
+        AUSHAPE_GUARD(aushape_gbuf_add_char(trailer,
+                                            AUSHAPE_COMP_INDEX_GZIP_SI1));
+        AUSHAPE_GUARD(aushape_gbuf_add_char(trailer,
+                                            AUSHAPE_COMP_INDEX_GZIP_SI2));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(trailer, 8, 2));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(trailer, offset, 8));
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(trailer,
+                                           "\x03\x00"
+                                           "\x00\x00\x00\x00"
+                                           "\x00\x00\x00\x00", 10));
+        break;
+    case AUSHAPE_COMP_ZSTD:
+        AUSHAPE_GUARD_BOOL(INVALID_ARGS, index->len <= UINT32_MAX - 8);
+        /* Index skippable frame */
+        AUSHAPE_GUARD(aushape_comp_index_add_le(
+                            trailer, AUSHAPE_COMP_INDEX_ZSTD_MAGIC, 4));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(trailer, index->len, 4));
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(trailer, index->ptr, index->len));
+        /* Seek table, including the index frame, with no checksums */
+        entries = seek->len / AUSHAPE_COMP_INDEX_ZSTD_SEEK_ENTRY_SIZE + 1;
+        AUSHAPE_GUARD_BOOL(INVALID_ARGS,
+                           entries <= (UINT32_MAX -
+                                AUSHAPE_COMP_INDEX_ZSTD_SEEK_FOOTER_SIZE) /
+                                AUSHAPE_COMP_INDEX_ZSTD_SEEK_ENTRY_SIZE);
+        AUSHAPE_GUARD(aushape_comp_index_add_le(
+                            trailer, AUSHAPE_COMP_INDEX_ZSTD_SEEK_MAGIC, 4));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(
+                            trailer,
+                            entries * AUSHAPE_COMP_INDEX_ZSTD_SEEK_ENTRY_SIZE +
+                            AUSHAPE_COMP_INDEX_ZSTD_SEEK_FOOTER_SIZE, 4));
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(trailer, seek->ptr, seek->len));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(trailer, 8 + index->len, 4));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(trailer, 0, 4));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(trailer, entries, 4));
+        AUSHAPE_GUARD(aushape_gbuf_add_char(trailer, 0));
+        AUSHAPE_GUARD(aushape_comp_index_add_le(
+                        trailer, AUSHAPE_COMP_INDEX_ZSTD_SEEK_END_MAGIC, 4));
+        break;
+    default:
+        assert(false);
+        rc = AUSHAPE_RC_INVALID_ARGS;
+        goto cleanup;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
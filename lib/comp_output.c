@@ -0,0 +1,490 @@
+/*
+ * Compressing aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/comp_output.h>
+#include <aushape/comp_index.h>
+#include <aushape/guard.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <string.h>
+#include <assert.h>
+
+/** Size of the buffer for compressed output, bytes */
+#define AUSHAPE_COMP_OUTPUT_BUF_SIZE    (64 * 1024)
+
+/** Compressing output data */
+struct aushape_comp_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    struct aushape_output *inner;   /**< Output to write compressed data to */
+    bool inner_owned;               /**< True if inner output is owned */
+    enum aushape_comp comp;         /**< Compression algorithm */
+    size_t frame_size;              /**< Minimum uncompressed frame size */
+    size_t frame_len;               /**< Uncompressed length of the frame */
+    bool indexed;                   /**< True if frame index is appended */
+    uint64_t offset;                /**< Compressed bytes written so far */
+    /** Index entry of the current frame, without size and length */
+    struct aushape_comp_index_frame frame;
+    struct aushape_gbuf index;      /**< Frame index */
+    struct aushape_gbuf seek;       /**< zstd seek table entries */
+    bool gzip_init;                 /**< True if gzip stream is initialized */
+    z_stream gzip;                  /**< gzip stream */
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx *zstd;                /**< zstd compression context */
+#endif
+    /** Buffer for compressed output */
+    char buf[AUSHAPE_COMP_OUTPUT_BUF_SIZE];
+};
+
+static enum aushape_rc
+aushape_comp_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_comp_output *comp_output =
+                                    (struct aushape_comp_output *)output;
+    struct aushape_output *inner = va_arg(ap, struct aushape_output *);
+    bool inner_owned = (bool)va_arg(ap, int);
+    enum aushape_comp comp = (enum aushape_comp)va_arg(ap, int);
+    int level = va_arg(ap, int);
+    size_t frame_size = va_arg(ap, size_t);
+    bool indexed = (bool)va_arg(ap, int);
+
+    assert(comp_output != NULL);
+
+    if (!aushape_output_is_valid(inner) ||
+        !aushape_output_is_cont(inner) ||
+        !aushape_comp_is_valid(comp) ||
+        !aushape_comp_is_available(comp) ||
+        !aushape_comp_level_is_valid(comp, level)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    switch (comp) {
+    case AUSHAPE_COMP_GZIP:
+        /* Add 16 to window bits to have gzip header and trailer */
+        switch (deflateInit2(&comp_output->gzip,
+                             level == AUSHAPE_COMP_LEVEL_DEFAULT
+                                ? Z_DEFAULT_COMPRESSION : level,
+                             Z_DEFLATED, MAX_WBITS + 16, 8,
+                             Z_DEFAULT_STRATEGY)) {
+        case Z_OK:
+            break;
+        case Z_MEM_ERROR:
+            return AUSHAPE_RC_NOMEM;
+        default:
+            return AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        }
+        comp_output->gzip_init = true;
+        break;
+#ifdef HAVE_ZSTD
+    case AUSHAPE_COMP_ZSTD:
+        comp_output->zstd = ZSTD_createCCtx();
+        if (comp_output->zstd == NULL) {
+            return AUSHAPE_RC_NOMEM;
+        }
+        if ((level != AUSHAPE_COMP_LEVEL_DEFAULT &&
+             ZSTD_isError(ZSTD_CCtx_setParameter(comp_output->zstd,
+                                                 ZSTD_c_compressionLevel,
+                                                 level))) ||
+            ZSTD_isError(ZSTD_CCtx_setParameter(comp_output->zstd,
+                                                ZSTD_c_checksumFlag, 1))) {
+            ZSTD_freeCCtx(comp_output->zstd);
+            comp_output->zstd = NULL;
+            return AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        }
+        break;
+#endif
+    default:
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    comp_output->inner = inner;
+    comp_output->inner_owned = inner_owned;
+    output->event_fields = inner->event_fields;
+    comp_output->comp = comp;
+    comp_output->frame_size = frame_size;
+    comp_output->indexed = indexed;
+    aushape_gbuf_init(&comp_output->index, 4096, NULL);
+    aushape_gbuf_init(&comp_output->seek, 4096, NULL);
+
+    return AUSHAPE_RC_OK;
+}
+
+static bool
+aushape_comp_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_comp_output *comp_output =
+                                    (struct aushape_comp_output *)output;
+    assert(comp_output != NULL);
+
+    return aushape_output_is_valid(comp_output->inner) &&
+           aushape_comp_is_valid(comp_output->comp) &&
+#ifdef HAVE_ZSTD
+           (comp_output->comp != AUSHAPE_COMP_ZSTD ||
+            comp_output->zstd != NULL) &&
+#endif
+           (comp_output->comp != AUSHAPE_COMP_GZIP ||
+            comp_output->gzip_init) &&
+           aushape_gbuf_is_valid(&comp_output->index) &&
+           aushape_gbuf_is_valid(&comp_output->seek);
+}
+
+/**
+ * Write compressed data to the inner output of a compressing output,
+ * accounting for it in the compressed offset.
+ *
+ * @param comp_output   The compressing output to write with.
+ * @param ptr           Pointer to the compressed data.
+ * @param len           Length of the compressed data.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - written successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - writing failed.
+ */
+static enum aushape_rc
+aushape_comp_output_write_inner(struct aushape_comp_output *comp_output,
+                                const char *ptr, size_t len)
+{
+    enum aushape_rc rc;
+
+    assert(comp_output != NULL);
+    assert(ptr != NULL || len == 0);
+
+    rc = aushape_output_write(comp_output->inner, ptr, len);
+    if (rc == AUSHAPE_RC_OK) {
+        comp_output->offset += len;
+    }
+    return rc;
+}
+
+/**
+ * Compress a piece of output and write the compressed data produced so far
+ * to the inner output, optionally ending the current frame.
+ *
+ * @param comp_output   The compressing output to compress with.
+ * @param ptr           Pointer to the output piece.
+ * @param len           Length of the output piece.
+ * @param end           True if the frame should be ended after the piece,
+ *                      false otherwise.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - compressed successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - compression or writing failed.
+ */
+static enum aushape_rc
+aushape_comp_output_process(struct aushape_comp_output *comp_output,
+                            const char *ptr, size_t len, bool end)
+{
+    enum aushape_rc rc;
+
+    assert(comp_output != NULL);
+    assert(ptr != NULL || len == 0);
+
+    switch (comp_output->comp) {
+    case AUSHAPE_COMP_GZIP:
+        {
+            z_stream *gzip = &comp_output->gzip;
+            int zrc;
+            do {
+                /* Feed zlib at most what its counter can hold */
+                gzip->next_in = (Bytef *)ptr;
+                gzip->avail_in = len > UINT_MAX ? UINT_MAX : (uInt)len;
+                if (gzip->avail_in > 0) {
+                    ptr += gzip->avail_in;
+                    len -= gzip->avail_in;
+                }
+                do {
+                    gzip->next_out = (Bytef *)comp_output->buf;
+                    gzip->avail_out = sizeof(comp_output->buf);
+                    zrc = deflate(gzip,
+                                  (end && len == 0) ? Z_FINISH : Z_NO_FLUSH);
+                    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                                       zrc == Z_OK || zrc == Z_STREAM_END ||
+                                       zrc == Z_BUF_ERROR);
+                    if (gzip->avail_out < sizeof(comp_output->buf)) {
+                        AUSHAPE_GUARD(
+                            aushape_comp_output_write_inner(
+                                comp_output,
+                                comp_output->buf,
+                                sizeof(comp_output->buf) - gzip->avail_out));
+                    }
+                } while ((end && len == 0) ? zrc != Z_STREAM_END
+                                           : gzip->avail_in > 0);
+            } while (len > 0);
+            /* Start a new member with the next write */
+            if (end) {
+                AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                                   deflateReset(gzip) == Z_OK);
+            }
+        }
+        break;
+#ifdef HAVE_ZSTD
+    case AUSHAPE_COMP_ZSTD:
+        {
+            ZSTD_inBuffer in = {.src = ptr, .size = len, .pos = 0};
+            ZSTD_outBuffer out;
+            size_t remaining;
+            do {
+                out.dst = comp_output->buf;
+                out.size = sizeof(comp_output->buf);
+                out.pos = 0;
+                /* A new frame is started with the next write after end */
+                remaining = ZSTD_compressStream2(comp_output->zstd,
+                                                 &out, &in,
+                                                 end ? ZSTD_e_end
+                                                     : ZSTD_e_continue);
+                AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                                   !ZSTD_isError(remaining));
+                if (out.pos > 0) {
+                    AUSHAPE_GUARD(aushape_comp_output_write_inner(
+                                                        comp_output,
+                                                        comp_output->buf,
+                                                        out.pos));
+                }
+            } while (end ? remaining != 0 : in.pos < in.size);
+        }
+        break;
+#endif
+    default:
+        assert(false);
+        rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        goto cleanup;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * End the current frame of a compressing output, and add it to the index,
+ * if the output is indexed.
+ *
+ * @param comp_output   The compressing output to end the frame of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - ended successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - compression or writing failed.
+ */
+static enum aushape_rc
+aushape_comp_output_end_frame(struct aushape_comp_output *comp_output)
+{
+    enum aushape_rc rc;
+    struct aushape_comp_index_frame *frame;
+
+    assert(comp_output != NULL);
+
+    AUSHAPE_GUARD(aushape_comp_output_process(comp_output, NULL, 0, true));
+
+    frame = &comp_output->frame;
+    if (comp_output->indexed) {
+        frame->size = comp_output->offset - frame->offset;
+        frame->len = comp_output->frame_len;
+        AUSHAPE_GUARD(aushape_comp_index_add_frame(&comp_output->index,
+                                                   frame));
+        if (comp_output->comp == AUSHAPE_COMP_ZSTD) {
+            rc = aushape_comp_index_add_seek(&comp_output->seek,
+                                             frame->size, frame->len);
+            /* A frame too big for the seek table can't be indexed */
+            if (rc == AUSHAPE_RC_INVALID_ARGS) {
+                rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            }
+            if (rc != AUSHAPE_RC_OK) {
+                goto cleanup;
+            }
+        }
+    }
+
+    memset(frame, 0, sizeof(*frame));
+    frame->offset = comp_output->offset;
+    comp_output->frame_len = 0;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+static enum aushape_rc
+aushape_comp_output_write(struct aushape_output *output,
+                          const char *ptr,
+                          size_t len)
+{
+    struct aushape_comp_output *comp_output =
+                                    (struct aushape_comp_output *)output;
+    enum aushape_rc rc;
+
+    assert(comp_output != NULL);
+
+    if (len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+    rc = aushape_comp_output_process(comp_output, ptr, len, false);
+    if (rc == AUSHAPE_RC_OK) {
+        comp_output->frame_len += len;
+    }
+    return rc;
+}
+
+static enum aushape_rc
+aushape_comp_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_comp_output *comp_output =
+                                    (struct aushape_comp_output *)output;
+    enum aushape_rc rc;
+
+    assert(comp_output != NULL);
+
+    if (comp_output->frame_len > 0) {
+        /* Keep filling the frame, if it's not big enough yet */
+        if (!full && comp_output->frame_len < comp_output->frame_size) {
+            return AUSHAPE_RC_OK;
+        }
+        rc = aushape_comp_output_end_frame(comp_output);
+        if (rc != AUSHAPE_RC_OK) {
+            return rc;
+        }
+    }
+
+    /* The inner output is at a document boundary now too */
+    return aushape_output_sync(comp_output->inner, full);
+}
+
+static enum aushape_rc
+aushape_comp_output_event(struct aushape_output *output,
+                          const struct aushape_output_event *event)
+{
+    struct aushape_comp_output *comp_output =
+                                    (struct aushape_comp_output *)output;
+    struct aushape_comp_index_frame *frame;
+    long long time;
+
+    assert(comp_output != NULL);
+    assert(event != NULL);
+
+    if (comp_output->indexed) {
+        frame = &comp_output->frame;
+        time = (long long)event->sec * 1000 + event->msec;
+        if (frame->events == 0) {
+            frame->first_serial = event->serial;
+            frame->earliest = time;
+            frame->latest = time;
+        } else if (time < frame->earliest) {
+            frame->earliest = time;
+        } else if (time > frame->latest) {
+            frame->latest = time;
+        }
+        frame->last_serial = event->serial;
+        frame->events++;
+    }
+
+    return aushape_output_event(comp_output->inner, event);
+}
+
+/**
+ * Write the index trailer of an indexed compressing output.
+ *
+ * @param comp_output   The compressing output to write the trailer of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - written successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - the index is too big, or
+ *                                            writing failed.
+ */
+static enum aushape_rc
+aushape_comp_output_write_trailer(struct aushape_comp_output *comp_output)
+{
+    enum aushape_rc rc;
+    struct aushape_gbuf trailer;
+
+    assert(comp_output != NULL);
+    assert(comp_output->indexed);
+
+    aushape_gbuf_init(&trailer, 4096, NULL);
+
+    if (comp_output->index.len == 0) {
+        AUSHAPE_GUARD(aushape_gbuf_add_str(&comp_output->index,
+                                           AUSHAPE_COMP_INDEX_MAGIC));
+    }
+    rc = aushape_comp_index_add_trailer(&trailer, comp_output->comp,
+                                        &comp_output->index,
+                                        &comp_output->seek,
+                                        comp_output->offset);
+    if (rc == AUSHAPE_RC_INVALID_ARGS) {
+        rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+    }
+    if (rc != AUSHAPE_RC_OK) {
+        goto cleanup;
+    }
+    AUSHAPE_GUARD(aushape_comp_output_write_inner(comp_output,
+                                                  trailer.ptr, trailer.len));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_gbuf_cleanup(&trailer);
+    return rc;
+}
+
+static void
+aushape_comp_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_comp_output *comp_output =
+                                    (struct aushape_comp_output *)output;
+    bool ended = true;
+    assert(comp_output != NULL);
+
+    /* Try to end the last frame, if it wasn't */
+    if (comp_output->frame_len > 0) {
+        ended = aushape_comp_output_end_frame(comp_output) == AUSHAPE_RC_OK;
+    }
+    /* Try to append the index, if all the frames made it */
+    if (comp_output->indexed && ended) {
+        aushape_comp_output_write_trailer(comp_output);
+    }
+    aushape_gbuf_cleanup(&comp_output->index);
+    aushape_gbuf_cleanup(&comp_output->seek);
+
+    if (comp_output->gzip_init) {
+        deflateEnd(&comp_output->gzip);
+        comp_output->gzip_init = false;
+    }
+#ifdef HAVE_ZSTD
+    ZSTD_freeCCtx(comp_output->zstd);
+    comp_output->zstd = NULL;
+#endif
+
+    if (comp_output->inner_owned) {
+        aushape_output_destroy(comp_output->inner);
+        comp_output->inner = NULL;
+        comp_output->inner_owned = false;
+    }
+}
+
+const struct aushape_output_type aushape_comp_output_type = {
+    .size       = sizeof(struct aushape_comp_output),
+    .cont       = true,
+    .init       = aushape_comp_output_init,
+    .is_valid   = aushape_comp_output_is_valid,
+    .write      = aushape_comp_output_write,
+    .sync       = aushape_comp_output_sync,
+    .event      = aushape_comp_output_event,
+    .cleanup    = aushape_comp_output_cleanup,
+};
@@ -19,6 +19,8 @@
  */
 
 #include <aushape/conf.h>
+#include <aushape/journal_output.h>
+#include <aushape/sqlite_output.h>
 #include <aushape/syslog_misc.h>
 #include <aushape/misc.h>
 #include <syslog.h>
@@ -39,9 +41,11 @@ const char *aushape_conf_cmd_help =
    "General options:\n"
    "    -h, --help              Output this help message and exit.\n"
    "    -v, --version           Output version information and exit.\n"
+   "    --key-dict              Output the compact key dictionary and exit.\n"
    "\n"
    "Formatting options:\n"
-   "    -l, --lang=STRING       Output STRING language (\"xml\" or \"json\").\n"
+   "    -l, --lang=STRING       Output STRING language (\"xml\", \"json\",\n"
+   "                            \"cbor\", \"msgpack\", or \"arrow\").\n"
    "                            Default: \"json\"\n"
    "    --events-per-doc=STRING Put STRING amount of events into each document:\n"
    "                                0 / \"none\"  - don't put events in documents,\n"
@@ -68,17 +72,215 @@ const char *aushape_conf_cmd_help =
    "                            Default: off\n"
    "    --with-norm             Include normalized data in the output.\n"
    "                            Default: off\n"
+   "    --ndjson                Output newline-delimited JSON: one event per\n"
+   "                            line, written in batches. Implies --lang=json\n"
+   "                            --fold=0 --events-per-doc=none.\n"
+   "                            Default: off\n"
+   "    --typed                 Output values of integer and boolean fields as\n"
+   "                            JSON numbers and booleans, where possible.\n"
+   "                            Default: off, output strings\n"
+   "    --compact-keys          Output known JSON keys as short IDs from the\n"
+   "                            compact key dictionary, see --key-dict.\n"
+   "                            Default: off\n"
+   "\n"
+   "Memory options:\n"
+   "    --shrink-after=NUMBER   Shrink conversion buffers back to initial sizes\n"
+   "                            after NUMBER consecutive small events.\n"
+   "                            Default: 0, never shrink\n"
+   "    --shrink-below=STRING   Consider events smaller than STRING small:\n"
+   "                                N           - N bytes\n"
+   "                                Nk          - N kilobytes\n"
+   "                                Nm          - N megabytes\n"
+   "                            Default: 64k\n"
    "\n"
    "Output options:\n"
-   "    -o, --output=STRING         Use STRING output type (\"file\"/\"syslog\").\n"
+   "    -o, --output=STRING         Use STRING output type (\"file\", \"syslog\",\n"
+   "                                \"journal\", \"socket\", \"http\",\n"
+   "                                \"sqlite\", or \"shm\").\n"
+   "                                Repeat to convert the input once for\n"
+   "                                several outputs: each option after the\n"
+   "                                first starts another output with default\n"
+   "                                settings, and formatting, memory, and\n"
+   "                                output options apply to the output\n"
+   "                                started last, up to 8 outputs.\n"
    "                                Default: \"file\"\n"
    "    -f,--file=PATH              Write to file PATH with file output.\n"
    "                                Write to stdout if PATH is \"-\"\n"
    "                                Default: \"-\"\n"
-   "    --syslog-facility=STRING    Log with STRING facility with syslog output.\n"
+   "    --syslog-facility=STRING    Log with STRING facility with syslog and\n"
+   "                                journal output.\n"
    "                                Default: \"authpriv\"\n"
-   "    --syslog-priority=STRING    Log with STRING priority with syslog output.\n"
-   "                                Default: \"info\"\n";
+   "    --syslog-priority=STRING    Log with STRING priority with syslog and\n"
+   "                                journal output.\n"
+   "                                Default: \"info\"\n"
+   "    --syslog-socket=PATH        Send syslog output to socket PATH.\n"
+   "                                Default: \"/dev/log\"\n"
+   "    --syslog-format=STRING      Use STRING syslog message header format:\n"
+   "                                    \"rfc3164\" - as syslog(3) does,\n"
+   "                                    \"rfc5424\" - with UTC timestamps.\n"
+   "                                Default: \"rfc3164\"\n"
+   "    --syslog-batch=NUMBER       Send syslog messages in batches of NUMBER.\n"
+   "                                Default: 64\n"
+   "    --syslog-queue=STRING       Queue up to STRING (N, Nk, or Nm) of syslog\n"
+   "                                messages the socket can't accept, and drop\n"
+   "                                messages beyond that.\n"
+   "                                Default: 1m\n"
+   "    --syslog-latency=NUMBER     Send queued syslog messages after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 100, 0 for no limit\n"
+   "    --journal-socket=PATH       Send journal output to journald socket PATH.\n"
+   "                                Default: \"/run/systemd/journal/socket\"\n"
+   "    --journal-batch=NUMBER      Send journal entries in batches of NUMBER.\n"
+   "                                Default: 64\n"
+   "    --journal-latency=NUMBER    Send queued journal entries after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 100, 0 for no limit\n"
+   "    --socket=STRING             Send to socket STRING with socket output:\n"
+   "                                    \"unix:PATH\"       - Unix stream,\n"
+   "                                    \"unix-dgram:PATH\" - Unix datagram,\n"
+   "                                    \"tcp:HOST:PORT\"   - TCP.\n"
+   "    --socket-framing=STRING     Frame documents sent to stream sockets:\n"
+   "                                    \"none\"   - don't frame,\n"
+   "                                    \"length\" - prefix with 32-bit\n"
+   "                                               big-endian length.\n"
+   "                                Default: \"none\"\n"
+   "    --socket-buffer=STRING      Send socket output in batches of up to\n"
+   "                                STRING (N, Nk, or Nm).\n"
+   "                                Default: 64k\n"
+   "    --socket-latency=NUMBER     Send accumulated socket output after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 1000, 0 for no limit\n"
+   "    --socket-retry=NUMBER       Retry connecting the socket after NUMBER\n"
+   "                                milliseconds, doubling the delay after\n"
+   "                                each failed attempt.\n"
+   "                                Default: 100\n"
+   "    --socket-retry-max=NUMBER   Retry connecting the socket after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 30000\n"
+   "    --socket-timeout=NUMBER     Fail if socket output couldn't be sent for\n"
+   "                                NUMBER milliseconds.\n"
+   "                                Default: 60000, 0 to never fail\n"
+   "    --http-url=URL              Send HTTP output to the _bulk endpoint under\n"
+   "                                \"http://HOST[:PORT][/PATH]\" URL.\n"
+   "    --http-index=NAME           Put events sent with HTTP output into\n"
+   "                                index NAME.\n"
+   "                                Default: \"aushape\"\n"
+   "    --http-compress=STRING      Compress HTTP request bodies with STRING\n"
+   "                                (\"none\" or \"gzip\").\n"
+   "                                Default: \"none\"\n"
+   "    --http-batch=STRING         Send HTTP output in requests of STRING\n"
+   "                                (N, Nk, or Nm).\n"
+   "                                Default: 5m\n"
+   "    --http-latency=NUMBER       Send accumulated HTTP output after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 1000, 0 for no limit\n"
+   "    --http-retry=NUMBER         Retry failed or throttled HTTP requests\n"
+   "                                after NUMBER milliseconds, doubling the\n"
+   "                                delay after each failed attempt.\n"
+   "                                Default: 100\n"
+   "    --http-retry-max=NUMBER     Retry HTTP requests after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 30000\n"
+   "    --http-timeout=NUMBER       Fail if HTTP output couldn't be sent for\n"
+   "                                NUMBER milliseconds.\n"
+   "                                Default: 60000, 0 to never fail\n"
+   "    --sqlite-db=PATH            Insert events into SQLite database PATH\n"
+   "                                with sqlite output.\n"
+   "    --sqlite-batch=NUMBER       Insert events in transactions of NUMBER.\n"
+   "                                Default: 10000\n"
+   "    --sqlite-latency=NUMBER     Commit SQLite transactions after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 1000, 0 for no limit\n"
+   "    --shm-socket=PATH           Accept shm output consumers on Unix socket\n"
+   "                                PATH.\n"
+   "    --shm-size=STRING           Use a shared-memory ring of STRING\n"
+   "                                (N, Nk, or Nm), rounded up to a power of\n"
+   "                                two, at least 4k.\n"
+   "                                Default: 16m\n"
+   "    --shm-policy=STRING         Use STRING policy when the shared-memory\n"
+   "                                ring is full:\n"
+   "                                    block       - wait for consumers\n"
+   "                                    drop        - drop the item\n"
+   "                                Default: block\n"
+   "    --file-buffer=STRING        Accumulate up to STRING of file output\n"
+   "                                before writing it:\n"
+   "                                    N           - N bytes\n"
+   "                                    Nk          - N kilobytes\n"
+   "                                    Nm          - N megabytes\n"
+   "                                Default: 64k, 0 to write immediately\n"
+   "    --file-latency=NUMBER       Write accumulated file output after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 1000, 0 for no limit\n"
+   "    --file-sync-time=NUMBER     Synchronize file output to disk after NUMBER\n"
+   "                                milliseconds at most.\n"
+   "                                Default: 0, no limit\n"
+   "    --file-sync-size=STRING     Synchronize file output to disk after STRING\n"
+   "                                (N, Nk, or Nm) of it at most.\n"
+   "                                Default: 0, no limit\n"
+   "    --file-rotate-size=STRING   Rotate the output file at the first document\n"
+   "                                boundary after STRING (N, Nk, or Nm).\n"
+   "                                Default: 0, don't rotate by size\n"
+   "    --file-rotate-time=NUMBER   Rotate the output file at the first document\n"
+   "                                boundary after NUMBER seconds.\n"
+   "                                Default: 0, don't rotate by time\n"
+   "    --file-prealloc=STRING      Preallocate STRING (N, Nk, or Nm) of disk\n"
+   "                                space for each output file.\n"
+   "                                Default: 0, don't preallocate\n"
+   "    --compress=STRING           Compress file output with STRING algorithm\n"
+   "                                (\"none\", \"gzip\", or \"zstd\").\n"
+   "                                Default: \"none\"\n"
+   "    --compress-level=NUMBER     Compress with level NUMBER.\n"
+   "                                Default: algorithm default\n"
+   "    --compress-frame=STRING     End compressed frames at the first document\n"
+   "                                boundary after STRING of output:\n"
+   "                                    N           - N bytes\n"
+   "                                    Nk          - N kilobytes\n"
+   "                                    Nm          - N megabytes\n"
+   "                                Default: 256k\n"
+   "    --compress-threads=NUMBER   Compress frames on NUMBER worker threads,\n"
+   "                                frames are also ended in the middle of\n"
+   "                                documents at four times their size.\n"
+   "                                Default: 0, compress in the main thread\n"
+   "    --compress-index            Append an index of frames, with serial\n"
+   "                                numbers and times of events they contain,\n"
+   "                                to compressed output, for aushape-extract.\n"
+   "                                Cannot be used with --compress-threads.\n"
+   "                                Default: off\n"
+   "    --async-queue=NUMBER        Write output on a separate thread, queueing\n"
+   "                                up to NUMBER documents, or pieces of them.\n"
+   "                                Default: 0, write in the main thread\n"
+   "    --async-policy=STRING       When the queue is full:\n"
+   "                                    \"block\"       - wait for the writer,\n"
+   "                                    \"drop-newest\" - drop the new piece,\n"
+   "                                    \"drop-oldest\" - drop the oldest piece,\n"
+   "                                    \"spill\"       - queue to a temporary\n"
+   "                                                    file until drained.\n"
+   "                                Default: \"block\"\n"
+   "    --spool-dir=STRING          Spool output to segment files in directory\n"
+   "                                STRING, and write it from there on a\n"
+   "                                separate thread, keeping what's not written\n"
+   "                                for the next run.\n"
+   "                                Default: none, don't spool\n"
+   "    --spool-size=STRING         Limit spool segment files to STRING:\n"
+   "                                    N           - N bytes\n"
+   "                                    Nk          - N kilobytes\n"
+   "                                    Nm          - N megabytes\n"
+   "                                Default: 1024m\n"
+   "    --spool-segment=STRING      Start a new spool segment file after STRING\n"
+   "                                (N, Nk, or Nm), half the limit at most.\n"
+   "                                Default: 16m\n"
+   "    --spool-retry=NUMBER        Retry writing spooled output after NUMBER\n"
+   "                                milliseconds, if it failed.\n"
+   "                                Default: 1000\n"
+   "    --spool-policy=STRING       When the spool is full:\n"
+   "                                    \"block\"       - wait for the writer,\n"
+   "                                    \"drop-newest\" - drop the new output,\n"
+   "                                    \"drop-oldest\" - drop the oldest\n"
+   "                                                    segment files.\n"
+   "                                Default: \"block\"\n";
+
+/** Maximum number of compression threads accepted */
+#define AUSHAPE_CONF_COMP_MAX_THREADS   256
 
 /** Option codes */
 enum aushape_conf_opt {
@@ -87,14 +289,68 @@ enum aushape_conf_opt {
     AUSHAPE_CONF_OPT_LANG = 'l',
     AUSHAPE_CONF_OPT_OUTPUT = 'o',
     AUSHAPE_CONF_OPT_FILE = 'f',
-    AUSHAPE_CONF_OPT_EVENTS_PER_DOC = 0x100,
+    AUSHAPE_CONF_OPT_KEY_DICT = 0x100,
+    AUSHAPE_CONF_OPT_EVENTS_PER_DOC,
     AUSHAPE_CONF_OPT_MAX_EVENT_SIZE,
     AUSHAPE_CONF_OPT_FOLD,
     AUSHAPE_CONF_OPT_INDENT,
     AUSHAPE_CONF_OPT_WITH_TEXT,
     AUSHAPE_CONF_OPT_WITH_NORM,
+    AUSHAPE_CONF_OPT_NDJSON,
+    AUSHAPE_CONF_OPT_TYPED,
+    AUSHAPE_CONF_OPT_COMPACT_KEYS,
+    AUSHAPE_CONF_OPT_SHRINK_AFTER,
+    AUSHAPE_CONF_OPT_SHRINK_BELOW,
     AUSHAPE_CONF_OPT_SYSLOG_FACILITY,
     AUSHAPE_CONF_OPT_SYSLOG_PRIORITY,
+    AUSHAPE_CONF_OPT_SYSLOG_SOCKET,
+    AUSHAPE_CONF_OPT_SYSLOG_FORMAT,
+    AUSHAPE_CONF_OPT_SYSLOG_BATCH,
+    AUSHAPE_CONF_OPT_SYSLOG_QUEUE,
+    AUSHAPE_CONF_OPT_SYSLOG_LATENCY,
+    AUSHAPE_CONF_OPT_JOURNAL_SOCKET,
+    AUSHAPE_CONF_OPT_JOURNAL_BATCH,
+    AUSHAPE_CONF_OPT_JOURNAL_LATENCY,
+    AUSHAPE_CONF_OPT_SOCKET,
+    AUSHAPE_CONF_OPT_SOCKET_FRAMING,
+    AUSHAPE_CONF_OPT_SOCKET_BUFFER,
+    AUSHAPE_CONF_OPT_SOCKET_LATENCY,
+    AUSHAPE_CONF_OPT_SOCKET_RETRY,
+    AUSHAPE_CONF_OPT_SOCKET_RETRY_MAX,
+    AUSHAPE_CONF_OPT_SOCKET_TIMEOUT,
+    AUSHAPE_CONF_OPT_HTTP_URL,
+    AUSHAPE_CONF_OPT_HTTP_INDEX,
+    AUSHAPE_CONF_OPT_HTTP_COMPRESS,
+    AUSHAPE_CONF_OPT_HTTP_BATCH,
+    AUSHAPE_CONF_OPT_HTTP_LATENCY,
+    AUSHAPE_CONF_OPT_HTTP_RETRY,
+    AUSHAPE_CONF_OPT_HTTP_RETRY_MAX,
+    AUSHAPE_CONF_OPT_HTTP_TIMEOUT,
+    AUSHAPE_CONF_OPT_SQLITE_DB,
+    AUSHAPE_CONF_OPT_SQLITE_BATCH,
+    AUSHAPE_CONF_OPT_SQLITE_LATENCY,
+    AUSHAPE_CONF_OPT_SHM_SOCKET,
+    AUSHAPE_CONF_OPT_SHM_SIZE,
+    AUSHAPE_CONF_OPT_SHM_POLICY,
+    AUSHAPE_CONF_OPT_FILE_BUFFER,
+    AUSHAPE_CONF_OPT_FILE_LATENCY,
+    AUSHAPE_CONF_OPT_FILE_SYNC_TIME,
+    AUSHAPE_CONF_OPT_FILE_SYNC_SIZE,
+    AUSHAPE_CONF_OPT_FILE_ROTATE_SIZE,
+    AUSHAPE_CONF_OPT_FILE_ROTATE_TIME,
+    AUSHAPE_CONF_OPT_FILE_PREALLOC,
+    AUSHAPE_CONF_OPT_COMPRESS,
+    AUSHAPE_CONF_OPT_COMPRESS_LEVEL,
+    AUSHAPE_CONF_OPT_COMPRESS_FRAME,
+    AUSHAPE_CONF_OPT_COMPRESS_THREADS,
+    AUSHAPE_CONF_OPT_COMPRESS_INDEX,
+    AUSHAPE_CONF_OPT_ASYNC_QUEUE,
+    AUSHAPE_CONF_OPT_ASYNC_POLICY,
+    AUSHAPE_CONF_OPT_SPOOL_DIR,
+    AUSHAPE_CONF_OPT_SPOOL_SIZE,
+    AUSHAPE_CONF_OPT_SPOOL_SEGMENT,
+    AUSHAPE_CONF_OPT_SPOOL_RETRY,
+    AUSHAPE_CONF_OPT_SPOOL_POLICY,
 };
 
 /** Description of short options */
@@ -112,6 +368,11 @@ static const struct option aushape_conf_longopts[] = {
         .val = AUSHAPE_CONF_OPT_VERSION,
         .has_arg = no_argument,
     },
+    {
+        .name = "key-dict",
+        .val = AUSHAPE_CONF_OPT_KEY_DICT,
+        .has_arg = no_argument,
+    },
     {
         .name = "lang",
         .val = AUSHAPE_CONF_OPT_LANG,
@@ -157,6 +418,31 @@ static const struct option aushape_conf_longopts[] = {
         .val = AUSHAPE_CONF_OPT_WITH_NORM,
         .has_arg = no_argument,
     },
+    {
+        .name = "ndjson",
+        .val = AUSHAPE_CONF_OPT_NDJSON,
+        .has_arg = no_argument,
+    },
+    {
+        .name = "typed",
+        .val = AUSHAPE_CONF_OPT_TYPED,
+        .has_arg = no_argument,
+    },
+    {
+        .name = "compact-keys",
+        .val = AUSHAPE_CONF_OPT_COMPACT_KEYS,
+        .has_arg = no_argument,
+    },
+    {
+        .name = "shrink-after",
+        .val = AUSHAPE_CONF_OPT_SHRINK_AFTER,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "shrink-below",
+        .val = AUSHAPE_CONF_OPT_SHRINK_BELOW,
+        .has_arg = required_argument,
+    },
     {
         .name = "syslog-facility",
         .val = AUSHAPE_CONF_OPT_SYSLOG_FACILITY,
@@ -167,44 +453,587 @@ static const struct option aushape_conf_longopts[] = {
         .val = AUSHAPE_CONF_OPT_SYSLOG_PRIORITY,
         .has_arg = required_argument,
     },
+    {
+        .name = "syslog-socket",
+        .val = AUSHAPE_CONF_OPT_SYSLOG_SOCKET,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "syslog-format",
+        .val = AUSHAPE_CONF_OPT_SYSLOG_FORMAT,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "syslog-batch",
+        .val = AUSHAPE_CONF_OPT_SYSLOG_BATCH,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "syslog-queue",
+        .val = AUSHAPE_CONF_OPT_SYSLOG_QUEUE,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "syslog-latency",
+        .val = AUSHAPE_CONF_OPT_SYSLOG_LATENCY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "journal-socket",
+        .val = AUSHAPE_CONF_OPT_JOURNAL_SOCKET,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "journal-batch",
+        .val = AUSHAPE_CONF_OPT_JOURNAL_BATCH,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "journal-latency",
+        .val = AUSHAPE_CONF_OPT_JOURNAL_LATENCY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "socket",
+        .val = AUSHAPE_CONF_OPT_SOCKET,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "socket-framing",
+        .val = AUSHAPE_CONF_OPT_SOCKET_FRAMING,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "socket-buffer",
+        .val = AUSHAPE_CONF_OPT_SOCKET_BUFFER,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "socket-latency",
+        .val = AUSHAPE_CONF_OPT_SOCKET_LATENCY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "socket-retry",
+        .val = AUSHAPE_CONF_OPT_SOCKET_RETRY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "socket-retry-max",
+        .val = AUSHAPE_CONF_OPT_SOCKET_RETRY_MAX,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "socket-timeout",
+        .val = AUSHAPE_CONF_OPT_SOCKET_TIMEOUT,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-url",
+        .val = AUSHAPE_CONF_OPT_HTTP_URL,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-index",
+        .val = AUSHAPE_CONF_OPT_HTTP_INDEX,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-compress",
+        .val = AUSHAPE_CONF_OPT_HTTP_COMPRESS,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-batch",
+        .val = AUSHAPE_CONF_OPT_HTTP_BATCH,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-latency",
+        .val = AUSHAPE_CONF_OPT_HTTP_LATENCY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-retry",
+        .val = AUSHAPE_CONF_OPT_HTTP_RETRY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-retry-max",
+        .val = AUSHAPE_CONF_OPT_HTTP_RETRY_MAX,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "http-timeout",
+        .val = AUSHAPE_CONF_OPT_HTTP_TIMEOUT,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "sqlite-db",
+        .val = AUSHAPE_CONF_OPT_SQLITE_DB,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "sqlite-batch",
+        .val = AUSHAPE_CONF_OPT_SQLITE_BATCH,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "sqlite-latency",
+        .val = AUSHAPE_CONF_OPT_SQLITE_LATENCY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "shm-socket",
+        .val = AUSHAPE_CONF_OPT_SHM_SOCKET,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "shm-size",
+        .val = AUSHAPE_CONF_OPT_SHM_SIZE,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "shm-policy",
+        .val = AUSHAPE_CONF_OPT_SHM_POLICY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "file-buffer",
+        .val = AUSHAPE_CONF_OPT_FILE_BUFFER,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "file-latency",
+        .val = AUSHAPE_CONF_OPT_FILE_LATENCY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "file-sync-time",
+        .val = AUSHAPE_CONF_OPT_FILE_SYNC_TIME,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "file-sync-size",
+        .val = AUSHAPE_CONF_OPT_FILE_SYNC_SIZE,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "file-rotate-size",
+        .val = AUSHAPE_CONF_OPT_FILE_ROTATE_SIZE,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "file-rotate-time",
+        .val = AUSHAPE_CONF_OPT_FILE_ROTATE_TIME,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "file-prealloc",
+        .val = AUSHAPE_CONF_OPT_FILE_PREALLOC,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "compress",
+        .val = AUSHAPE_CONF_OPT_COMPRESS,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "compress-level",
+        .val = AUSHAPE_CONF_OPT_COMPRESS_LEVEL,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "compress-frame",
+        .val = AUSHAPE_CONF_OPT_COMPRESS_FRAME,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "compress-threads",
+        .val = AUSHAPE_CONF_OPT_COMPRESS_THREADS,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "compress-index",
+        .val = AUSHAPE_CONF_OPT_COMPRESS_INDEX,
+        .has_arg = no_argument,
+    },
+    {
+        .name = "async-queue",
+        .val = AUSHAPE_CONF_OPT_ASYNC_QUEUE,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "async-policy",
+        .val = AUSHAPE_CONF_OPT_ASYNC_POLICY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "spool-dir",
+        .val = AUSHAPE_CONF_OPT_SPOOL_DIR,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "spool-size",
+        .val = AUSHAPE_CONF_OPT_SPOOL_SIZE,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "spool-segment",
+        .val = AUSHAPE_CONF_OPT_SPOOL_SEGMENT,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "spool-retry",
+        .val = AUSHAPE_CONF_OPT_SPOOL_RETRY,
+        .has_arg = required_argument,
+    },
+    {
+        .name = "spool-policy",
+        .val = AUSHAPE_CONF_OPT_SPOOL_POLICY,
+        .has_arg = required_argument,
+    },
     {
         .name = NULL
     }
 };
 
+/**
+ * Parse a size with an optional "k"/"K" (kilobytes), or "m"/"M" (megabytes)
+ * suffix.
+ *
+ * @param str   The string to parse.
+ * @param psize Location for the parsed size, bytes.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+aushape_conf_parse_size(const char *str, size_t *psize)
+{
+    size_t size;
+    int end = 0;
+
+    if (sscanf(str, "%zu%n", &size, &end) < 1) {
+        return false;
+    }
+    if ((str[end] == 'k' || str[end] == 'K') && str[end + 1] == '\0') {
+        size <<= 10;
+    } else if ((str[end] == 'm' || str[end] == 'M') && str[end + 1] == '\0') {
+        size <<= 20;
+    } else if (str[end] != '\0') {
+        return false;
+    }
+    *psize = size;
+    return true;
+}
+
+/** Default output configuration */
+static const struct aushape_conf_output aushape_conf_output_default = {
+    .format = {
+        .lang = AUSHAPE_LANG_JSON,
+        .fold_level = 4,
+        .init_indent = 0,
+        .nest_indent = 4,
+        .events_per_doc = SSIZE_MAX,
+        .max_event_size = SIZE_MAX,
+        .with_text = false,
+        .with_norm = false,
+        .ndjson = false,
+        .typed = false,
+        .compact_keys = false,
+        .shrink_after = 0,
+        .shrink_below = 64 * 1024,
+    },
+    .output_type = AUSHAPE_CONF_OUTPUT_TYPE_FD,
+    .output_conf = {
+        .fd = {
+            .path = "-",
+            .buf_size = 64 * 1024,
+            .max_latency = 1000,
+            .sync_interval = 0,
+            .sync_size = 0,
+            .rotate_size = 0,
+            .rotate_time = 0,
+            .prealloc = 0,
+        },
+        .syslog = {
+            .facility = LOG_AUTHPRIV,
+            .priority = LOG_INFO,
+            .path = AUSHAPE_DEVLOG_OUTPUT_PATH,
+            .format = AUSHAPE_DEVLOG_OUTPUT_FORMAT_RFC3164,
+            .batch_size = 64,
+            .queue_size = 1024 * 1024,
+            .max_latency = 100,
+        },
+        .journal = {
+            .path = AUSHAPE_JOURNAL_OUTPUT_PATH,
+            .batch_size = 64,
+            .max_latency = 100,
+        },
+        .sock = {
+            .proto = AUSHAPE_SOCK_OUTPUT_PROTO_INVALID,
+            .addr = NULL,
+            .framed = false,
+            .buf_size = 64 * 1024,
+            .max_latency = 1000,
+            .retry_min = 100,
+            .retry_max = 30000,
+            .timeout = 60000,
+        },
+        .http = {
+            .url = NULL,
+            .index = "aushape",
+            .gzip = false,
+            .batch_size = 5 * 1024 * 1024,
+            .max_latency = 1000,
+            .retry_min = 100,
+            .retry_max = 30000,
+            .timeout = 60000,
+        },
+        .sqlite = {
+            .path = NULL,
+            .batch_size = 10000,
+            .max_latency = 1000,
+        },
+        .shm = {
+            .path = NULL,
+            .size = 16 * 1024 * 1024,
+            .block = true,
+        }
+    },
+    .comp = {
+        .comp = AUSHAPE_COMP_INVALID,
+        .level = AUSHAPE_COMP_LEVEL_DEFAULT,
+        .frame_size = 256 * 1024,
+        .threads = 0,
+        .indexed = false,
+    },
+    .async = {
+        .queue_size = 0,
+        .policy = AUSHAPE_ASYNC_OUTPUT_POLICY_BLOCK,
+    },
+    .spool = {
+        .dir = NULL,
+        .max_size = 1024 * 1024 * 1024,
+        .segment_size = 16 * 1024 * 1024,
+        .retry = 1000,
+        .policy = AUSHAPE_SPOOL_OUTPUT_POLICY_BLOCK,
+    }
+};
+
+/**
+ * Check an output configuration for conflicting, or missing options.
+ *
+ * @param output    The output configuration to check.
+ *
+ * @return True if the configuration is valid, false if not, and an error
+ *         message, followed by a help message, if necessary, was printed to
+ *         stderr.
+ */
+static bool
+aushape_conf_output_check(const struct aushape_conf_output *output)
+{
+    /* Syslog messages are text and cannot carry binary documents */
+    if (aushape_lang_is_binary(output->format.lang) &&
+        output->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SYSLOG) {
+        fprintf(stderr, "Binary languages cannot be output to syslog\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* Newline framing requires single-line JSON events out of documents */
+    if (output->format.ndjson &&
+        (output->format.lang != AUSHAPE_LANG_JSON ||
+         output->format.fold_level != 0 ||
+         output->format.events_per_doc != 0)) {
+        fprintf(stderr, "NDJSON output requires JSON language, "
+                        "fold level 0, and no documents\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* Only JSON has typed scalar values */
+    if (output->format.typed && output->format.lang != AUSHAPE_LANG_JSON) {
+        fprintf(stderr, "Typed values can only be output in JSON\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* Only JSON keys are compacted */
+    if (output->format.compact_keys &&
+        output->format.lang != AUSHAPE_LANG_JSON) {
+        fprintf(stderr, "Compact keys can only be output in JSON\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* Arrow record batches are sized in events, not bytes */
+    if (output->format.lang == AUSHAPE_LANG_ARROW &&
+        output->format.events_per_doc < 0) {
+        fprintf(stderr, "Arrow documents cannot be sized in bytes\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* Socket output needs a socket to send to */
+    if (output->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SOCK) {
+        if (output->output_conf.sock.addr == NULL) {
+            fprintf(stderr, "Socket output requires a socket\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+        if (output->output_conf.sock.framed &&
+            output->output_conf.sock.proto ==
+                AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_DGRAM) {
+            fprintf(stderr, "Datagram sockets cannot be framed\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+        if (output->output_conf.sock.retry_max <
+                output->output_conf.sock.retry_min) {
+            fprintf(stderr, "Maximum socket retry delay is less than "
+                            "the minimum\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+    }
+
+    /* HTTP output needs a server and single-line JSON events */
+    if (output->output_type == AUSHAPE_CONF_OUTPUT_TYPE_HTTP) {
+        if (output->output_conf.http.url == NULL) {
+            fprintf(stderr, "HTTP output requires a URL\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+        if (output->format.lang != AUSHAPE_LANG_JSON ||
+            output->format.fold_level != 0 ||
+            output->format.events_per_doc != 0) {
+            fprintf(stderr, "HTTP output requires JSON language, "
+                            "fold level 0, and no documents\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+        if (output->output_conf.http.retry_max <
+                output->output_conf.http.retry_min) {
+            fprintf(stderr, "Maximum HTTP retry delay is less than "
+                            "the minimum\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+    }
+
+    /* SQLite output needs a database, and JSON events with full keys */
+    if (output->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SQLITE) {
+        if (!aushape_sqlite_output_is_available()) {
+            fprintf(stderr, "SQLite output is not supported "
+                            "by this build\n");
+            return false;
+        }
+        if (output->output_conf.sqlite.path == NULL) {
+            fprintf(stderr, "SQLite output requires a database\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+        if (output->format.lang != AUSHAPE_LANG_JSON ||
+            output->format.events_per_doc != 0 ||
+            output->format.compact_keys) {
+            fprintf(stderr, "SQLite output requires JSON language, "
+                            "no documents, and no compact keys\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+    }
+
+    /* Shared-memory output needs a socket for consumers */
+    if (output->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SHM &&
+        output->output_conf.shm.path == NULL) {
+        fprintf(stderr, "Shared-memory output requires a socket\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* Only named files can be rotated, or preallocated */
+    if ((output->output_conf.fd.rotate_size > 0 ||
+         output->output_conf.fd.rotate_time > 0 ||
+         output->output_conf.fd.prealloc > 0) &&
+        (output->output_type != AUSHAPE_CONF_OUTPUT_TYPE_FD ||
+         strcmp(output->output_conf.fd.path, "-") == 0)) {
+        fprintf(stderr, "File rotation and preallocation require "
+                        "an output file\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* Compression is only applied to file output */
+    if (aushape_comp_is_valid(output->comp.comp)) {
+        if (output->output_type != AUSHAPE_CONF_OUTPUT_TYPE_FD) {
+            fprintf(stderr, "Compression requires file output\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+        if (!aushape_comp_is_available(output->comp.comp)) {
+            fprintf(stderr, "Compression algorithm is not supported "
+                            "by this build\n");
+            return false;
+        }
+        if (!aushape_comp_level_is_valid(output->comp.comp,
+                                         output->comp.level)) {
+            fprintf(stderr, "Invalid compression level: %d\n%s\n",
+                    output->comp.level, aushape_conf_cmd_help);
+            return false;
+        }
+        /* Frames are only indexed in the main thread */
+        if (output->comp.indexed && output->comp.threads > 0) {
+            fprintf(stderr, "Compressed output can only be indexed "
+                            "without compression threads\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+        /* Compressed streams and indexes span the whole output */
+        if (output->output_conf.fd.rotate_size > 0 ||
+            output->output_conf.fd.rotate_time > 0) {
+            fprintf(stderr, "Compressed output cannot be rotated\n%s\n",
+                    aushape_conf_cmd_help);
+            return false;
+        }
+    } else if (output->comp.indexed) {
+        fprintf(stderr, "Indexing requires compression\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    /* The spool has to fit at least two segments */
+    if (output->spool.dir != NULL &&
+        output->spool.segment_size > output->spool.max_size / 2) {
+        fprintf(stderr, "Spool segment size cannot exceed "
+                        "half of the spool size\n%s\n",
+                aushape_conf_cmd_help);
+        return false;
+    }
+
+    return true;
+}
+
 bool
 aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
 {
     bool result = false;
     struct aushape_conf conf = {
         .input = "-",
-        .format = {
-            .lang = AUSHAPE_LANG_JSON,
-            .fold_level = 4,
-            .init_indent = 0,
-            .nest_indent = 4,
-            .events_per_doc = SSIZE_MAX,
-            .max_event_size = SIZE_MAX,
-            .with_text = false,
-            .with_norm = false,
-        },
-        .output_type = AUSHAPE_CONF_OUTPUT_TYPE_FD,
-        .output_conf = {
-            .fd = {
-                .path = "-"
-            },
-            .syslog = {
-                .facility = LOG_AUTHPRIV,
-                .priority = LOG_INFO,
-            }
-        }
+        .output_num = 1,
     };
+    struct aushape_conf_output *output = conf.output_list;
+    bool output_typed = false;
+    bool stdout_used = false;
+    size_t idx;
     int opterr_orig;
     int optind_orig;
     int optcode;
     int end;
     int i;
 
+    *output = aushape_conf_output_default;
+
     /* Ask getopt_long to not print an error message */
     opterr_orig = opterr;
     opterr = 0;
@@ -226,11 +1055,21 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
             conf.version = true;
             break;
 
+        case AUSHAPE_CONF_OPT_KEY_DICT:
+            conf.key_dict = true;
+            break;
+
         case AUSHAPE_CONF_OPT_LANG:
             if (strcasecmp(optarg, "json") == 0) {
-                conf.format.lang = AUSHAPE_LANG_JSON;
+                output->format.lang = AUSHAPE_LANG_JSON;
             } else if (strcasecmp(optarg, "xml") == 0) {
-                conf.format.lang = AUSHAPE_LANG_XML;
+                output->format.lang = AUSHAPE_LANG_XML;
+            } else if (strcasecmp(optarg, "cbor") == 0) {
+                output->format.lang = AUSHAPE_LANG_CBOR;
+            } else if (strcasecmp(optarg, "msgpack") == 0) {
+                output->format.lang = AUSHAPE_LANG_MSGPACK;
+            } else if (strcasecmp(optarg, "arrow") == 0) {
+                output->format.lang = AUSHAPE_LANG_ARROW;
             } else {
                 fprintf(stderr, "Invalid language: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
@@ -239,10 +1078,31 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
             break;
 
         case AUSHAPE_CONF_OPT_OUTPUT:
+            /* Start another output, if this one has its type set already */
+            if (output_typed) {
+                if (conf.output_num >= AUSHAPE_CONF_OUTPUT_MAX) {
+                    fprintf(stderr, "Too many outputs, maximum is %d\n%s\n",
+                            AUSHAPE_CONF_OUTPUT_MAX, aushape_conf_cmd_help);
+                    goto cleanup;
+                }
+                output = &conf.output_list[conf.output_num++];
+                *output = aushape_conf_output_default;
+            }
+            output_typed = true;
             if (strcasecmp(optarg, "file") == 0) {
-                conf.output_type = AUSHAPE_CONF_OUTPUT_TYPE_FD;
+                output->output_type = AUSHAPE_CONF_OUTPUT_TYPE_FD;
             } else if (strcasecmp(optarg, "syslog") == 0) {
-                conf.output_type = AUSHAPE_CONF_OUTPUT_TYPE_SYSLOG;
+                output->output_type = AUSHAPE_CONF_OUTPUT_TYPE_SYSLOG;
+            } else if (strcasecmp(optarg, "journal") == 0) {
+                output->output_type = AUSHAPE_CONF_OUTPUT_TYPE_JOURNAL;
+            } else if (strcasecmp(optarg, "socket") == 0) {
+                output->output_type = AUSHAPE_CONF_OUTPUT_TYPE_SOCK;
+            } else if (strcasecmp(optarg, "http") == 0) {
+                output->output_type = AUSHAPE_CONF_OUTPUT_TYPE_HTTP;
+            } else if (strcasecmp(optarg, "sqlite") == 0) {
+                output->output_type = AUSHAPE_CONF_OUTPUT_TYPE_SQLITE;
+            } else if (strcasecmp(optarg, "shm") == 0) {
+                output->output_type = AUSHAPE_CONF_OUTPUT_TYPE_SHM;
             } else {
                 fprintf(stderr, "Invalid output type: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
@@ -251,17 +1111,17 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
             break;
 
         case AUSHAPE_CONF_OPT_FILE:
-            conf.output_conf.fd.path = optarg;
+            output->output_conf.fd.path = optarg;
             break;
 
         case AUSHAPE_CONF_OPT_EVENTS_PER_DOC:
             end = 0;
             if (strcasecmp(optarg, "none") == 0) {
-                conf.format.events_per_doc = 0;
+                output->format.events_per_doc = 0;
             } else if (strcasecmp(optarg, "all") == 0) {
-                conf.format.events_per_doc = SSIZE_MAX;
+                output->format.events_per_doc = SSIZE_MAX;
             } else if (sscanf(optarg, "%zd%n",
-                              &conf.format.events_per_doc, &end) < 1 ||
+                              &output->format.events_per_doc, &end) < 1 ||
                        (size_t)end != strlen(optarg)) {
                 fprintf(stderr, "Invalid events per doc value: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
@@ -272,26 +1132,26 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
         case AUSHAPE_CONF_OPT_MAX_EVENT_SIZE:
             end = 0;
             if (strcasecmp(optarg, "unlimited") == 0) {
-                conf.format.max_event_size = SIZE_MAX;
+                output->format.max_event_size = SIZE_MAX;
             } else if (sscanf(optarg, "%zu%n",
-                              &conf.format.max_event_size, &end) < 1) {
+                              &output->format.max_event_size, &end) < 1) {
                 fprintf(stderr, "Invalid maximum event size value: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
                 goto cleanup;
             }
             if ((optarg[end] == 'k' || optarg[end] == 'K') &&
                 optarg[end + 1] == '\0') {
-                conf.format.max_event_size <<= 10;
+                output->format.max_event_size <<= 10;
             } else if ((optarg[end] == 'm' || optarg[end] == 'M') &&
                        optarg[end + 1] == '\0') {
-                conf.format.max_event_size <<= 20;
+                output->format.max_event_size <<= 20;
             } else if (optarg[end] != '\0') {
                 fprintf(stderr, "Invalid maximum event size value: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
                 goto cleanup;
             }
 
-            if (conf.format.max_event_size <
+            if (output->format.max_event_size <
                 AUSHAPE_FORMAT_MIN_MAX_EVENT_SIZE) {
                 fprintf(stderr, "Invalid maximum event size value: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
@@ -302,11 +1162,11 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
         case AUSHAPE_CONF_OPT_FOLD:
             end = 0;
             if (strcasecmp(optarg, "none") == 0) {
-                conf.format.fold_level = SIZE_MAX;
+                output->format.fold_level = SIZE_MAX;
             } else if (strcasecmp(optarg, "all") == 0) {
-                conf.format.fold_level = 0;
+                output->format.fold_level = 0;
             } else if (sscanf(optarg, "%zu%n",
-                              &conf.format.fold_level, &end) < 1 ||
+                              &output->format.fold_level, &end) < 1 ||
                        (size_t)end != strlen(optarg)) {
                 fprintf(stderr, "Invalid fold level: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
@@ -317,7 +1177,7 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
         case AUSHAPE_CONF_OPT_INDENT:
             end = 0;
             if (sscanf(optarg, "%zu%n",
-                       &conf.format.nest_indent, &end) < 1 ||
+                       &output->format.nest_indent, &end) < 1 ||
                 (size_t)end != strlen(optarg)) {
                 fprintf(stderr, "Invalid indent size: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
@@ -326,21 +1186,56 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
             break;
 
         case AUSHAPE_CONF_OPT_WITH_TEXT:
-            conf.format.with_text = true;
+            output->format.with_text = true;
             break;
 
         case AUSHAPE_CONF_OPT_WITH_NORM:
-            conf.format.with_norm = true;
+            output->format.with_norm = true;
             break;
 
-        case AUSHAPE_CONF_OPT_SYSLOG_FACILITY:
-            i = aushape_syslog_facility_from_str(optarg);
-            if (i < 0) {
+        case AUSHAPE_CONF_OPT_NDJSON:
+            output->format.ndjson = true;
+            output->format.lang = AUSHAPE_LANG_JSON;
+            output->format.fold_level = 0;
+            output->format.events_per_doc = 0;
+            break;
+
+        case AUSHAPE_CONF_OPT_TYPED:
+            output->format.typed = true;
+            break;
+
+        case AUSHAPE_CONF_OPT_COMPACT_KEYS:
+            output->format.compact_keys = true;
+            break;
+
+        case AUSHAPE_CONF_OPT_SHRINK_AFTER:
+            end = 0;
+            if (sscanf(optarg, "%zu%n",
+                       &output->format.shrink_after, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid shrink-after event number: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SHRINK_BELOW:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->format.shrink_below)) {
+                fprintf(stderr, "Invalid shrink-below size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SYSLOG_FACILITY:
+            i = aushape_syslog_facility_from_str(optarg);
+            if (i < 0) {
                 fprintf(stderr, "Invalid syslog facility: %s\n%s\n",
                         optarg, aushape_conf_cmd_help);
                 goto cleanup;
             }
-            conf.output_conf.syslog.facility = i;
+            output->output_conf.syslog.facility = i;
             break;
 
         case AUSHAPE_CONF_OPT_SYSLOG_PRIORITY:
@@ -350,7 +1245,521 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
                         optarg, aushape_conf_cmd_help);
                 goto cleanup;
             }
-            conf.output_conf.syslog.priority = i;
+            output->output_conf.syslog.priority = i;
+            break;
+
+        case AUSHAPE_CONF_OPT_SYSLOG_SOCKET:
+            if (*optarg == '\0') {
+                fprintf(stderr, "Invalid syslog socket: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            output->output_conf.syslog.path = optarg;
+            break;
+
+        case AUSHAPE_CONF_OPT_SYSLOG_FORMAT:
+            if (strcasecmp(optarg, "rfc3164") == 0) {
+                output->output_conf.syslog.format =
+                                    AUSHAPE_DEVLOG_OUTPUT_FORMAT_RFC3164;
+            } else if (strcasecmp(optarg, "rfc5424") == 0) {
+                output->output_conf.syslog.format =
+                                    AUSHAPE_DEVLOG_OUTPUT_FORMAT_RFC5424;
+            } else {
+                fprintf(stderr, "Invalid syslog format: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SYSLOG_BATCH:
+            end = 0;
+            if (sscanf(optarg, "%zu%n",
+                       &output->output_conf.syslog.batch_size, &end) < 1 ||
+                (size_t)end != strlen(optarg) ||
+                output->output_conf.syslog.batch_size == 0) {
+                fprintf(stderr, "Invalid syslog batch size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SYSLOG_QUEUE:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.syslog.queue_size) ||
+                output->output_conf.syslog.queue_size == 0) {
+                fprintf(stderr, "Invalid syslog queue size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SYSLOG_LATENCY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.syslog.max_latency, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid syslog output latency: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_JOURNAL_SOCKET:
+            if (*optarg == '\0') {
+                fprintf(stderr, "Invalid journal socket: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            output->output_conf.journal.path = optarg;
+            break;
+
+        case AUSHAPE_CONF_OPT_JOURNAL_BATCH:
+            end = 0;
+            if (sscanf(optarg, "%zu%n",
+                       &output->output_conf.journal.batch_size, &end) < 1 ||
+                (size_t)end != strlen(optarg) ||
+                output->output_conf.journal.batch_size == 0) {
+                fprintf(stderr, "Invalid journal batch size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_JOURNAL_LATENCY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.journal.max_latency, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid journal output latency: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SOCKET:
+            if (strncmp(optarg, "unix:", 5) == 0) {
+                output->output_conf.sock.proto =
+                                    AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_STREAM;
+                output->output_conf.sock.addr = optarg + 5;
+            } else if (strncmp(optarg, "unix-dgram:", 11) == 0) {
+                output->output_conf.sock.proto =
+                                    AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_DGRAM;
+                output->output_conf.sock.addr = optarg + 11;
+            } else if (strncmp(optarg, "tcp:", 4) == 0 &&
+                       strchr(optarg + 4, ':') != NULL) {
+                output->output_conf.sock.proto = AUSHAPE_SOCK_OUTPUT_PROTO_TCP;
+                output->output_conf.sock.addr = optarg + 4;
+            } else {
+                fprintf(stderr, "Invalid socket: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SOCKET_FRAMING:
+            if (strcasecmp(optarg, "none") == 0) {
+                output->output_conf.sock.framed = false;
+            } else if (strcasecmp(optarg, "length") == 0) {
+                output->output_conf.sock.framed = true;
+            } else {
+                fprintf(stderr, "Invalid socket framing: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SOCKET_BUFFER:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.sock.buf_size) ||
+                output->output_conf.sock.buf_size == 0) {
+                fprintf(stderr, "Invalid socket buffer size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SOCKET_LATENCY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.sock.max_latency, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid socket output latency: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SOCKET_RETRY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.sock.retry_min, &end) < 1 ||
+                (size_t)end != strlen(optarg) ||
+                output->output_conf.sock.retry_min == 0) {
+                fprintf(stderr, "Invalid socket retry delay: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SOCKET_RETRY_MAX:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.sock.retry_max, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid maximum socket retry delay: "
+                                "%s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SOCKET_TIMEOUT:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.sock.timeout, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid socket timeout: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_URL:
+            if (strncasecmp(optarg, "http://", 7) != 0 ||
+                optarg[7] == '\0' || optarg[7] == '/') {
+                fprintf(stderr, "Invalid HTTP URL: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            output->output_conf.http.url = optarg;
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_INDEX:
+            if (*optarg == '\0') {
+                fprintf(stderr, "Invalid HTTP index: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            output->output_conf.http.index = optarg;
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_COMPRESS:
+            if (strcasecmp(optarg, "none") == 0) {
+                output->output_conf.http.gzip = false;
+            } else if (strcasecmp(optarg, "gzip") == 0) {
+                output->output_conf.http.gzip = true;
+            } else {
+                fprintf(stderr, "Invalid HTTP compression: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_BATCH:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.http.batch_size) ||
+                output->output_conf.http.batch_size == 0) {
+                fprintf(stderr, "Invalid HTTP batch size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_LATENCY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.http.max_latency, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid HTTP output latency: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_RETRY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.http.retry_min, &end) < 1 ||
+                (size_t)end != strlen(optarg) ||
+                output->output_conf.http.retry_min == 0) {
+                fprintf(stderr, "Invalid HTTP retry delay: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_RETRY_MAX:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.http.retry_max, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid maximum HTTP retry delay: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_HTTP_TIMEOUT:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.http.timeout, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid HTTP timeout: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SQLITE_DB:
+            if (*optarg == '\0') {
+                fprintf(stderr, "Invalid SQLite database: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            output->output_conf.sqlite.path = optarg;
+            break;
+
+        case AUSHAPE_CONF_OPT_SQLITE_BATCH:
+            end = 0;
+            if (sscanf(optarg, "%zu%n",
+                       &output->output_conf.sqlite.batch_size, &end) < 1 ||
+                (size_t)end != strlen(optarg) ||
+                output->output_conf.sqlite.batch_size == 0) {
+                fprintf(stderr, "Invalid SQLite batch size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SQLITE_LATENCY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.sqlite.max_latency, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid SQLite output latency: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SHM_SOCKET:
+            if (*optarg == '\0') {
+                fprintf(stderr, "Invalid shared-memory socket: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            output->output_conf.shm.path = optarg;
+            break;
+
+        case AUSHAPE_CONF_OPT_SHM_SIZE:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.shm.size) ||
+                output->output_conf.shm.size < 4096 ||
+                output->output_conf.shm.size > SIZE_MAX / 4) {
+                fprintf(stderr, "Invalid shared-memory ring size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SHM_POLICY:
+            if (strcasecmp(optarg, "block") == 0) {
+                output->output_conf.shm.block = true;
+            } else if (strcasecmp(optarg, "drop") == 0) {
+                output->output_conf.shm.block = false;
+            } else {
+                fprintf(stderr, "Invalid shared-memory ring policy: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_FILE_BUFFER:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.fd.buf_size)) {
+                fprintf(stderr, "Invalid file buffer size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_FILE_LATENCY:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.fd.max_latency, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid file output latency: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_FILE_SYNC_TIME:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.fd.sync_interval, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid file sync time: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_FILE_SYNC_SIZE:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.fd.sync_size)) {
+                fprintf(stderr, "Invalid file sync size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_FILE_ROTATE_SIZE:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.fd.rotate_size)) {
+                fprintf(stderr, "Invalid file rotation size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_FILE_ROTATE_TIME:
+            end = 0;
+            if (sscanf(optarg, "%u%n",
+                       &output->output_conf.fd.rotate_time, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid file rotation time: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_FILE_PREALLOC:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->output_conf.fd.prealloc)) {
+                fprintf(stderr, "Invalid file preallocation size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_COMPRESS:
+            if (strcasecmp(optarg, "none") == 0) {
+                output->comp.comp = AUSHAPE_COMP_INVALID;
+            } else if (strcasecmp(optarg, "gzip") == 0) {
+                output->comp.comp = AUSHAPE_COMP_GZIP;
+            } else if (strcasecmp(optarg, "zstd") == 0) {
+                output->comp.comp = AUSHAPE_COMP_ZSTD;
+            } else {
+                fprintf(stderr, "Invalid compression algorithm: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_COMPRESS_LEVEL:
+            end = 0;
+            if (sscanf(optarg, "%d%n", &output->comp.level, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid compression level: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_COMPRESS_FRAME:
+            if (!aushape_conf_parse_size(optarg, &output->comp.frame_size)) {
+                fprintf(stderr, "Invalid compressed frame size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_COMPRESS_THREADS:
+            end = 0;
+            if (sscanf(optarg, "%zu%n", &output->comp.threads, &end) < 1 ||
+                (size_t)end != strlen(optarg) ||
+                output->comp.threads > AUSHAPE_CONF_COMP_MAX_THREADS) {
+                fprintf(stderr, "Invalid compression thread number: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_COMPRESS_INDEX:
+            output->comp.indexed = true;
+            break;
+
+        case AUSHAPE_CONF_OPT_ASYNC_QUEUE:
+            end = 0;
+            if (sscanf(optarg, "%zu%n", &output->async.queue_size, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid asynchronous queue size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_ASYNC_POLICY:
+            if (strcasecmp(optarg, "block") == 0) {
+                output->async.policy = AUSHAPE_ASYNC_OUTPUT_POLICY_BLOCK;
+            } else if (strcasecmp(optarg, "drop-newest") == 0) {
+                output->async.policy = AUSHAPE_ASYNC_OUTPUT_POLICY_DROP_NEWEST;
+            } else if (strcasecmp(optarg, "drop-oldest") == 0) {
+                output->async.policy = AUSHAPE_ASYNC_OUTPUT_POLICY_DROP_OLDEST;
+            } else if (strcasecmp(optarg, "spill") == 0) {
+                output->async.policy = AUSHAPE_ASYNC_OUTPUT_POLICY_SPILL;
+            } else {
+                fprintf(stderr, "Invalid asynchronous queue policy: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SPOOL_DIR:
+            output->spool.dir = optarg;
+            break;
+
+        case AUSHAPE_CONF_OPT_SPOOL_SIZE:
+            if (!aushape_conf_parse_size(optarg, &output->spool.max_size)) {
+                fprintf(stderr, "Invalid spool size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SPOOL_SEGMENT:
+            if (!aushape_conf_parse_size(optarg,
+                                         &output->spool.segment_size) ||
+                output->spool.segment_size == 0) {
+                fprintf(stderr, "Invalid spool segment size: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SPOOL_RETRY:
+            end = 0;
+            if (sscanf(optarg, "%u%n", &output->spool.retry, &end) < 1 ||
+                (size_t)end != strlen(optarg)) {
+                fprintf(stderr, "Invalid spool retry delay: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            break;
+
+        case AUSHAPE_CONF_OPT_SPOOL_POLICY:
+            if (strcasecmp(optarg, "block") == 0) {
+                output->spool.policy = AUSHAPE_SPOOL_OUTPUT_POLICY_BLOCK;
+            } else if (strcasecmp(optarg, "drop-newest") == 0) {
+                output->spool.policy = AUSHAPE_SPOOL_OUTPUT_POLICY_DROP_NEWEST;
+            } else if (strcasecmp(optarg, "drop-oldest") == 0) {
+                output->spool.policy = AUSHAPE_SPOOL_OUTPUT_POLICY_DROP_OLDEST;
+            } else {
+                fprintf(stderr, "Invalid spool policy: %s\n%s\n",
+                        optarg, aushape_conf_cmd_help);
+                goto cleanup;
+            }
             break;
 
         case ':':
@@ -406,6 +1815,23 @@ aushape_conf_load(struct aushape_conf *pconf, int argc, char **argv)
         goto cleanup;
     }
 
+    /* Check each output, and make sure they don't share stdout */
+    for (idx = 0; idx < conf.output_num; idx++) {
+        output = &conf.output_list[idx];
+        if (!aushape_conf_output_check(output)) {
+            goto cleanup;
+        }
+        if (output->output_type == AUSHAPE_CONF_OUTPUT_TYPE_FD &&
+            strcmp(output->output_conf.fd.path, "-") == 0) {
+            if (stdout_used) {
+                fprintf(stderr, "Only one output can write to stdout\n%s\n",
+                        aushape_conf_cmd_help);
+                goto cleanup;
+            }
+            stdout_used = true;
+        }
+    }
+
     *pconf = conf;
     result = true;
 cleanup:
@@ -21,16 +21,23 @@
 #include <config.h>
 #include <aushape/conv.h>
 #include <aushape/conv_buf.h>
+#include <aushape/conv_ir.h>
 #include <aushape/gbuf.h>
 #include <aushape/guard.h>
 #include <auparse.h>
 #include <limits.h>
 #include <string.h>
 
-/** Converter */
-struct aushape_conv {
-    /** Auparse state */
-    auparse_state_t            *au;
+/**
+ * Amount of newline-delimited output to accumulate before writing it to a
+ * continuous output, bytes
+ */
+#define AUSHAPE_CONV_NDJSON_BATCH_SIZE  (64 * 1024)
+
+/** Converter output, with its own format and buffer */
+struct aushape_conv_sink {
+    /** Next output, or NULL */
+    struct aushape_conv_sink   *next;
     /** Output format */
     struct aushape_format       format;
     /** Output */
@@ -40,8 +47,6 @@ struct aushape_conv {
      * False otherwise.
      */
     bool                        output_owned;
-    /** First conversion failure return code, or OK */
-    enum aushape_rc             rc;
     /** Output buffer */
     struct aushape_conv_buf     buf;
     /** True if outputting inside of a document, false otherwise */
@@ -51,58 +56,397 @@ struct aushape_conv {
      * Events, if format.events_per_doc is positive, bytes if negative.
      */
     size_t                      events_in_doc;
+    /**
+     * First failure of this output, or OK. A failed output is skipped,
+     * while the other outputs carry on.
+     */
+    enum aushape_rc             rc;
 };
 
+/** Converter */
+struct aushape_conv {
+    /** Memory allocator, NULL for the C library one */
+    const struct aushape_mem   *mem;
+    /** Auparse state */
+    auparse_state_t            *au;
+    /** Outputs, in the order added, at least one */
+    struct aushape_conv_sink   *sink_list;
+    /** Intermediate representation of the current event, for all outputs */
+    struct aushape_conv_ir      ir;
+    /**
+     * First failure return code affecting all outputs, i.e. of parsing the
+     * input, or OK
+     */
+    enum aushape_rc             rc;
+};
+
+/** Output event notification, shared by the outputs of a converter */
+struct aushape_conv_event {
+    /** True if the event timestamp was retrieved */
+    bool                        ready;
+    /** True if the descriptive fields were filled in */
+    bool                        filled;
+    /** The event notification */
+    struct aushape_output_event event;
+};
+
+/**
+ * Check if a converter output is valid.
+ *
+ * @param sink  The output to check.
+ *
+ * @return True if the output is valid.
+ */
+static bool
+aushape_conv_sink_is_valid(const struct aushape_conv_sink *sink)
+{
+    return sink != NULL &&
+           aushape_output_is_valid(sink->output) &&
+           aushape_conv_buf_is_valid(&sink->buf);
+}
+
 bool
 aushape_conv_is_valid(const struct aushape_conv *conv)
 {
-    return conv != NULL &&
-           conv->au != NULL &&
-           aushape_output_is_valid(conv->output) &&
-           aushape_conv_buf_is_valid(&conv->buf);
+    const struct aushape_conv_sink *sink;
+
+    if (conv == NULL || conv->au == NULL || conv->sink_list == NULL ||
+        !aushape_conv_ir_is_valid(&conv->ir)) {
+        return false;
+    }
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (!aushape_conv_sink_is_valid(sink)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 /**
- * Handle auparse event callback.
+ * Check if a converter output can still be written to, i.e. if neither the
+ * converter, nor the output failed.
  *
- * @param au    The auparse state corresponding to the reported event.
- * @param type  The event type.
- * @param data  The opaque data passed to auparse_add_calback previously.
+ * @param conv  The converter the output belongs to.
+ * @param sink  The converter output to check.
+ *
+ * @return True if the output can be written to, false otherwise.
+ */
+static bool
+aushape_conv_sink_is_ok(const struct aushape_conv *conv,
+                        const struct aushape_conv_sink *sink)
+{
+    assert(aushape_conv_is_valid(conv));
+    assert(aushape_conv_sink_is_valid(sink));
+    return conv->rc == AUSHAPE_RC_OK && sink->rc == AUSHAPE_RC_OK;
+}
+
+/**
+ * Get the return code to report for a converter: its own failure, if any,
+ * or the failure of its first failed output.
+ *
+ * @param conv  The converter to get the return code of.
+ * @param all   True if an output failure should only be reported if all
+ *              the outputs failed, false if any should be.
+ *
+ * @return The return code to report.
+ */
+static enum aushape_rc
+aushape_conv_get_rc(const struct aushape_conv *conv, bool all)
+{
+    const struct aushape_conv_sink *sink;
+    enum aushape_rc rc = AUSHAPE_RC_OK;
+
+    assert(aushape_conv_is_valid(conv));
+
+    if (conv->rc != AUSHAPE_RC_OK) {
+        return conv->rc;
+    }
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (sink->rc == AUSHAPE_RC_OK) {
+            if (all) {
+                return AUSHAPE_RC_OK;
+            }
+        } else if (rc == AUSHAPE_RC_OK) {
+            rc = sink->rc;
+        }
+    }
+    return rc;
+}
+
+/**
+ * Synchronize an output of a converter at a document boundary.
+ * Records the failure as the output's return code.
+ *
+ * @param conv  The converter to synchronize the output of.
+ * @param sink  The converter output to synchronize.
+ * @param full  True if everything written so far should be passed on, false
+ *              if the output may keep it for now.
  */
 static void
-aushape_conv_cb(auparse_state_t *au, auparse_cb_event_t type, void *data)
+aushape_conv_sync(struct aushape_conv *conv,
+                  struct aushape_conv_sink *sink,
+                  bool full)
 {
     enum aushape_rc rc;
-    struct aushape_conv *conv = (struct aushape_conv *)data;
 
     assert(aushape_conv_is_valid(conv));
+    assert(aushape_conv_sink_is_valid(sink));
+
+    if (!aushape_conv_sink_is_ok(conv, sink)) {
+        return;
+    }
+    rc = aushape_output_sync(sink->output, full);
+    if (rc != AUSHAPE_RC_OK) {
+        sink->rc = rc;
+    }
+}
+
+/**
+ * Add a descriptive field to an output event, unless it's there already, or
+ * doesn't fit.
+ *
+ * @param event The event to add the field to.
+ * @param name  The field name.
+ * @param value The field value, or NULL to add nothing.
+ */
+static void
+aushape_conv_event_add_field(struct aushape_output_event *event,
+                             const char *name,
+                             const char *value)
+{
+    size_t name_len;
+    size_t value_len;
+    size_t len;
+    size_t i;
+    char *field;
+
+    assert(event != NULL);
+    assert(name != NULL);
+
+    if (value == NULL) {
+        return;
+    }
+    name_len = strlen(name);
+    value_len = strlen(value);
+    len = name_len + 1 + value_len + 1;
+    if (len > sizeof(event->fields) - event->fields_len) {
+        return;
+    }
+    field = event->fields + event->fields_len;
+    memcpy(field, name, name_len);
+    field[name_len] = '=';
+    memcpy(field + name_len + 1, value, value_len + 1);
+
+    /* Skip duplicates, e.g. types of repeated records */
+    for (i = 0; i < event->fields_len; i += strlen(event->fields + i) + 1) {
+        if (strcmp(event->fields + i, field) == 0) {
+            return;
+        }
+    }
+    event->fields_len += len;
+}
+
+/**
+ * Fill the descriptive fields of an output event from the current event.
+ *
+ * @param event The event to fill the fields of.
+ * @param au    The auparse state with the current event.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - filled successfully,
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ */
+static enum aushape_rc
+aushape_conv_event_fill_fields(struct aushape_output_event *event,
+                               auparse_state_t *au)
+{
+    const au_event_t *e;
+    const char *value;
+
+    assert(event != NULL);
+    assert(au != NULL);
+
+    e = auparse_get_timestamp(au);
+    if (e == NULL) {
+        return AUSHAPE_RC_AUPARSE_FAILED;
+    }
+    aushape_conv_event_add_field(event, "node", e->host);
+
+    if (auparse_first_record(au) != 1) {
+        return AUSHAPE_RC_AUPARSE_FAILED;
+    }
+    do {
+        aushape_conv_event_add_field(event, "type",
+                                     auparse_get_type_name(au));
+    } while (auparse_next_record(au) == 1);
+
+    if (auparse_normalize(au, NORM_OPT_ALL) != 0) {
+        return AUSHAPE_RC_AUPARSE_FAILED;
+    }
+#define FIELD(_name, _fn) \
+    do {                                                \
+        if (_fn(au) == 1) {                             \
+            value = auparse_interpret_field(au);        \
+            aushape_conv_event_add_field(               \
+                event, _name,                           \
+                value != NULL ? value                   \
+                              : auparse_get_field_str(au)); \
+        }                                               \
+    } while (0)
+    FIELD("key", auparse_normalize_key);
+    FIELD("subject", auparse_normalize_subject_primary);
+    FIELD("object", auparse_normalize_object_primary);
+#undef FIELD
+
+    return AUSHAPE_RC_OK;
+}
+
+
+/**
+ * Notify an output of a converter of an event being output, retrieving the
+ * event timestamp and descriptive fields only once for all the outputs.
+ * Records a retrieval failure as the converter's return code, and a
+ * notification failure as the output's.
+ *
+ * @param conv  The converter to notify the output of.
+ * @param sink  The converter output to notify.
+ * @param event The event notification shared by the outputs.
+ * @param au    The auparse state with the current event.
+ */
+static void
+aushape_conv_event(struct aushape_conv *conv,
+                   struct aushape_conv_sink *sink,
+                   struct aushape_conv_event *event,
+                   auparse_state_t *au)
+{
+    enum aushape_rc rc;
+    const au_event_t *e;
+
+    assert(aushape_conv_is_valid(conv));
+    assert(aushape_conv_sink_is_valid(sink));
+    assert(event != NULL);
+    assert(au != NULL);
+
+    if (!aushape_conv_sink_is_ok(conv, sink)) {
+        return;
+    }
+    if (!event->ready) {
+        e = auparse_get_timestamp(au);
+        if (e == NULL) {
+            conv->rc = AUSHAPE_RC_AUPARSE_FAILED;
+            return;
+        }
+        event->event.serial = e->serial;
+        event->event.sec = e->sec;
+        event->event.msec = e->milli;
+        event->event.fields_len = 0;
+        event->ready = true;
+    }
+    if (!event->filled && aushape_output_wants_event_fields(sink->output)) {
+        rc = aushape_conv_event_fill_fields(&event->event, au);
+        if (rc != AUSHAPE_RC_OK) {
+            conv->rc = rc;
+            return;
+        }
+        event->filled = true;
+    }
+    rc = aushape_output_event(sink->output, &event->event);
+    if (rc != AUSHAPE_RC_OK) {
+        sink->rc = rc;
+    }
+}
+
+/**
+ * Write the contents of a converter output's buffer, and empty it.
+ * Records the failure as the output's return code.
+ *
+ * @param conv  The converter to write the output of.
+ * @param sink  The converter output to write.
+ */
+static void
+aushape_conv_write(struct aushape_conv *conv, struct aushape_conv_sink *sink)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_conv_is_valid(conv));
+    assert(aushape_conv_sink_is_valid(sink));
 
-    if (type != AUPARSE_CB_EVENT_READY) {
+    if (!aushape_conv_sink_is_ok(conv, sink)) {
         return;
     }
+    rc = aushape_output_write(sink->output,
+                              sink->buf.gbuf.ptr, sink->buf.gbuf.len);
+    if (rc == AUSHAPE_RC_OK) {
+        aushape_conv_buf_empty(&sink->buf);
+    } else {
+        sink->rc = rc;
+    }
+}
+
+/**
+ * Write accumulated newline-delimited output of a converter output, if any.
+ * Records the failure as the output's return code.
+ *
+ * @param conv  The converter to write the output of.
+ * @param sink  The converter output to write.
+ */
+static void
+aushape_conv_write_batch(struct aushape_conv *conv,
+                         struct aushape_conv_sink *sink)
+{
+    assert(aushape_conv_is_valid(conv));
+    assert(aushape_conv_sink_is_valid(sink));
+    assert(sink->format.ndjson);
+
+    if (!aushape_conv_sink_is_ok(conv, sink) || sink->buf.gbuf.len == 0) {
+        return;
+    }
+    aushape_conv_write(conv, sink);
+    aushape_conv_sync(conv, sink, false);
+}
+
+/**
+ * Output an event to a converter output, unless it failed before.
+ * Records the failure as the output's return code.
+ *
+ * @param conv  The converter to output the event with.
+ * @param sink  The converter output to output the event to.
+ * @param event The event notification shared by the outputs.
+ * @param au    The auparse state with the current event.
+ * @param ir    The intermediate representation of the current event.
+ */
+static void
+aushape_conv_sink_add_event(struct aushape_conv *conv,
+                            struct aushape_conv_sink *sink,
+                            struct aushape_conv_event *event,
+                            auparse_state_t *au,
+                            const struct aushape_conv_ir *ir)
+{
+    enum aushape_rc rc;
+    size_t orig_len;
+    bool added = false;
+
+    assert(aushape_conv_is_valid(conv));
+    assert(aushape_conv_sink_is_valid(sink));
+    assert(event != NULL);
+    assert(au != NULL);
+    assert(aushape_conv_ir_is_valid(ir));
 
     /*
      * Output document prologue, if needed
      */
-    if (conv->rc == AUSHAPE_RC_OK) {
-        if (conv->format.events_per_doc != 0 &&
-            conv->format.events_per_doc != SSIZE_MAX) {
-            if (!conv->in_doc) {
-                rc = aushape_conv_buf_add_prologue(&conv->buf);
+    if (aushape_conv_sink_is_ok(conv, sink)) {
+        if (sink->format.events_per_doc != 0 &&
+            sink->format.events_per_doc != SSIZE_MAX) {
+            if (!sink->in_doc) {
+                rc = aushape_conv_buf_add_prologue(&sink->buf);
                 if (rc == AUSHAPE_RC_OK) {
-                    conv->in_doc = true;
-                    if (aushape_output_is_cont(conv->output)) {
-                        rc = aushape_output_write(conv->output,
-                                                  conv->buf.gbuf.ptr,
-                                                  conv->buf.gbuf.len);
-                        if (rc == AUSHAPE_RC_OK) {
-                            aushape_conv_buf_empty(&conv->buf);
-                        } else {
-                            conv->rc = rc;
-                        }
+                    sink->in_doc = true;
+                    if (aushape_output_is_cont(sink->output)) {
+                        aushape_conv_write(conv, sink);
                     }
                 } else {
-                    conv->rc = rc;
+                    sink->rc = rc;
                 }
             }
         }
@@ -111,88 +455,234 @@ aushape_conv_cb(auparse_state_t *au, auparse_cb_event_t type, void *data)
     /*
      * Output the event
      */
-    if (conv->rc == AUSHAPE_RC_OK) {
-        size_t orig_len = conv->buf.gbuf.len;
-        bool added = false;
-        rc = aushape_conv_buf_add_event(&conv->buf,
-                                        conv->events_in_doc == 0, &added, au);
+    if (aushape_conv_sink_is_ok(conv, sink)) {
+        orig_len = aushape_conv_buf_get_len(&sink->buf);
+        rc = aushape_conv_buf_add_event(&sink->buf,
+                                        sink->events_in_doc == 0,
+                                        &added, ir);
         if (rc == AUSHAPE_RC_OK) {
             if (added) {
-                if (conv->format.events_per_doc > 0) {
-                    conv->events_in_doc++;
-                } else if (conv->format.events_per_doc < 0) {
-                    conv->events_in_doc += conv->buf.gbuf.len - orig_len;
+                aushape_conv_event(conv, sink, event, au);
+                if (sink->format.events_per_doc > 0) {
+                    sink->events_in_doc++;
+                } else if (sink->format.events_per_doc < 0) {
+                    sink->events_in_doc +=
+                        aushape_conv_buf_get_len(&sink->buf) - orig_len;
                 }
-                if (aushape_output_is_cont(conv->output) ||
-                    conv->format.events_per_doc == 0) {
-                    rc = aushape_output_write(conv->output,
-                                              conv->buf.gbuf.ptr,
-                                              conv->buf.gbuf.len);
-                    if (rc == AUSHAPE_RC_OK) {
-                        aushape_conv_buf_empty(&conv->buf);
-                    } else {
-                        conv->rc = rc;
+                /* Batch newline-delimited events for continuous outputs */
+                if (sink->format.ndjson &&
+                    aushape_output_is_cont(sink->output)) {
+                    if (sink->buf.gbuf.len >= AUSHAPE_CONV_NDJSON_BATCH_SIZE) {
+                        aushape_conv_write_batch(conv, sink);
+                    }
+                } else if (aushape_output_is_cont(sink->output) ||
+                           sink->format.events_per_doc == 0) {
+                    aushape_conv_write(conv, sink);
+                    if (sink->format.events_per_doc == 0) {
+                        aushape_conv_sync(conv, sink, false);
                     }
                 }
             }
         } else {
-            conv->rc = rc;
+            sink->rc = rc;
         }
     }
 
     /*
      * Output document epilogue, if needed
      */
-    if (conv->rc == AUSHAPE_RC_OK) {
-        if (conv->format.events_per_doc != 0 &&
-            conv->format.events_per_doc != SSIZE_MAX) {
-            assert(conv->in_doc);
+    if (aushape_conv_sink_is_ok(conv, sink)) {
+        if (sink->format.events_per_doc != 0 &&
+            sink->format.events_per_doc != SSIZE_MAX) {
+            assert(sink->in_doc);
             /* If hit the limit */
-            if ((conv->format.events_per_doc > 0 &&
-                 conv->events_in_doc >= (size_t)conv->format.events_per_doc) ||
-                (conv->format.events_per_doc < 0 &&
-                 conv->events_in_doc >= (size_t)-conv->format.events_per_doc)) {
-                rc = aushape_conv_buf_add_epilogue(&conv->buf);
+            if ((sink->format.events_per_doc > 0 &&
+                 sink->events_in_doc >=
+                    (size_t)sink->format.events_per_doc) ||
+                (sink->format.events_per_doc < 0 &&
+                 sink->events_in_doc >=
+                    (size_t)-sink->format.events_per_doc)) {
+                rc = aushape_conv_buf_add_epilogue(&sink->buf);
                 if (rc == AUSHAPE_RC_OK) {
-                    rc = aushape_output_write(conv->output,
-                                              conv->buf.gbuf.ptr,
-                                              conv->buf.gbuf.len);
-                    if (rc == AUSHAPE_RC_OK) {
-                        aushape_conv_buf_empty(&conv->buf);
-                        conv->events_in_doc = 0;
-                        conv->in_doc = false;
-                    } else {
-                        conv->rc = rc;
+                    aushape_conv_write(conv, sink);
+                    if (aushape_conv_sink_is_ok(conv, sink)) {
+                        sink->events_in_doc = 0;
+                        sink->in_doc = false;
+                        aushape_conv_sync(conv, sink, false);
                     }
                 } else {
-                    conv->rc = rc;
+                    sink->rc = rc;
                 }
             }
         }
     }
 }
 
+/**
+ * Handle auparse event callback.
+ *
+ * @param au    The auparse state corresponding to the reported event.
+ * @param type  The event type.
+ * @param data  The opaque data passed to auparse_add_calback previously.
+ */
+static void
+aushape_conv_cb(auparse_state_t *au, auparse_cb_event_t type, void *data)
+{
+    struct aushape_conv *conv = (struct aushape_conv *)data;
+    struct aushape_conv_sink *sink;
+    struct aushape_conv_event event = {.ready = false, .filled = false};
+    bool with_sink = false;
+    bool with_norm = false;
+    enum aushape_rc rc;
+
+    assert(aushape_conv_is_valid(conv));
+
+    if (type != AUPARSE_CB_EVENT_READY || conv->rc != AUSHAPE_RC_OK) {
+        return;
+    }
+
+    /* Check what the working outputs need */
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (sink->rc == AUSHAPE_RC_OK) {
+            with_sink = true;
+            if (sink->format.with_norm &&
+                sink->format.lang != AUSHAPE_LANG_ARROW) {
+                with_norm = true;
+            }
+        }
+    }
+    if (!with_sink) {
+        return;
+    }
+
+    /* Parse and collect the event once, for all outputs */
+    rc = aushape_conv_ir_build(&conv->ir, with_norm, au);
+    if (rc != AUSHAPE_RC_OK) {
+        assert(rc != AUSHAPE_RC_INVALID_ARGS);
+        conv->rc = rc;
+        return;
+    }
+
+    /* Output the event to every working output, in its own format */
+    for (sink = conv->sink_list;
+         sink != NULL && conv->rc == AUSHAPE_RC_OK;
+         sink = sink->next) {
+        aushape_conv_sink_add_event(conv, sink, &event, au, &conv->ir);
+    }
+}
+
+/**
+ * Create (allocate and initialize) a converter output.
+ *
+ * @param psink         Location for the created output pointer.
+ * @param format        The output format to use.
+ * @param output        The output to write to.
+ * @param output_owned  True if the output should be destroyed when the
+ *                      converter output is destroyed.
+ * @param mem           The memory allocator to use, NULL for the C library
+ *                      one.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - created successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_conv_sink_create(struct aushape_conv_sink **psink,
+                         const struct aushape_format *format,
+                         struct aushape_output *output,
+                         bool output_owned,
+                         const struct aushape_mem *mem)
+{
+    enum aushape_rc rc;
+    struct aushape_conv_sink *sink;
+
+    assert(psink != NULL);
+    assert(aushape_format_is_valid(format));
+    assert(aushape_output_is_valid(output));
+    assert(aushape_mem_is_valid(mem));
+
+    sink = aushape_mem_realloc(mem, NULL, sizeof(*sink));
+    if (sink == NULL) {
+        return AUSHAPE_RC_NOMEM;
+    }
+    memset(sink, 0, sizeof(*sink));
+    sink->format = *format;
+    rc = aushape_conv_buf_init(&sink->buf, &sink->format, mem);
+    if (rc != AUSHAPE_RC_OK) {
+        assert(rc != AUSHAPE_RC_INVALID_ARGS);
+        aushape_mem_free(mem, sink);
+        return rc;
+    }
+    sink->output = output;
+    sink->output_owned = output_owned;
+
+    *psink = sink;
+    assert(aushape_conv_sink_is_valid(*psink));
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Destroy (cleanup and free) a converter output. If it was created with
+ * output_owned true, then the output is destroyed as well.
+ *
+ * @param sink  The converter output to destroy.
+ * @param mem   The memory allocator the output was created with.
+ */
+static void
+aushape_conv_sink_destroy(struct aushape_conv_sink *sink,
+                          const struct aushape_mem *mem)
+{
+    assert(aushape_conv_sink_is_valid(sink));
+    aushape_conv_buf_cleanup(&sink->buf);
+    if (sink->output_owned) {
+        aushape_output_destroy(sink->output);
+    }
+    memset(sink, 0, sizeof(*sink));
+    aushape_mem_free(mem, sink);
+}
+
 enum aushape_rc
 aushape_conv_create(struct aushape_conv **pconv,
                     const struct aushape_format *format,
                     struct aushape_output *output,
                     bool output_owned)
+{
+    return aushape_conv_create_mem(pconv, format, output, output_owned, NULL);
+}
+
+enum aushape_rc
+aushape_conv_create_mem(struct aushape_conv **pconv,
+                        const struct aushape_format *format,
+                        struct aushape_output *output,
+                        bool output_owned,
+                        const struct aushape_mem *mem)
 {
     enum aushape_rc rc;
     struct aushape_conv *conv = NULL;
 
     if (pconv == NULL ||
         !aushape_format_is_valid(format) ||
-        !aushape_output_is_valid(output)) {
+        !aushape_output_is_valid(output) ||
+        !aushape_mem_is_valid(mem)) {
         rc = AUSHAPE_RC_INVALID_ARGS;
         goto cleanup;
     }
 
-    conv = calloc(1, sizeof(*conv));
+    conv = aushape_mem_realloc(mem, NULL, sizeof(*conv));
     if (conv == NULL) {
         rc = AUSHAPE_RC_NOMEM;
         goto cleanup;
     }
+    memset(conv, 0, sizeof(*conv));
+    conv->mem = mem;
+
+    rc = aushape_conv_ir_init(&conv->ir, mem);
+    if (rc != AUSHAPE_RC_OK) {
+        assert(rc != AUSHAPE_RC_INVALID_ARGS);
+        aushape_mem_free(mem, conv);
+        conv = NULL;
+        goto cleanup;
+    }
 
     conv->au = auparse_init(AUSOURCE_FEED, NULL);
     AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, conv->au != NULL);
@@ -201,14 +691,8 @@ aushape_conv_create(struct aushape_conv **pconv,
 #endif
     auparse_add_callback(conv->au, aushape_conv_cb, conv, NULL);
 
-    conv->format = *format;
-    rc = aushape_conv_buf_init(&conv->buf, &conv->format);
-    if (rc != AUSHAPE_RC_OK) {
-        assert(rc != AUSHAPE_RC_INVALID_ARGS);
-        goto cleanup;
-    }
-    conv->output = output;
-    conv->output_owned = output_owned;
+    AUSHAPE_GUARD(aushape_conv_sink_create(&conv->sink_list, format,
+                                           output, output_owned, mem));
 
     *pconv = conv;
     conv = NULL;
@@ -218,86 +702,223 @@ aushape_conv_create(struct aushape_conv **pconv,
 
 cleanup:
     if (conv != NULL) {
-        auparse_destroy(conv->au);
-        free(conv);
+        if (conv->au != NULL) {
+            auparse_destroy(conv->au);
+        }
+        aushape_conv_ir_cleanup(&conv->ir);
+        aushape_mem_free(mem, conv);
     }
     return rc;
 }
 
 enum aushape_rc
-aushape_conv_begin(struct aushape_conv *conv)
+aushape_conv_add_output(struct aushape_conv *conv,
+                        const struct aushape_format *format,
+                        struct aushape_output *output,
+                        bool output_owned)
 {
+    enum aushape_rc rc;
+    struct aushape_conv_sink *sink;
+    struct aushape_conv_sink **plast;
+
+    if (!aushape_conv_is_valid(conv) ||
+        !aushape_format_is_valid(format) ||
+        !aushape_output_is_valid(output)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    for (plast = &conv->sink_list; *plast != NULL; plast = &(*plast)->next) {
+        if ((*plast)->in_doc) {
+            return AUSHAPE_RC_INVALID_STATE;
+        }
+    }
+
+    rc = aushape_conv_sink_create(&sink, format, output, output_owned,
+                                  conv->mem);
+    if (rc != AUSHAPE_RC_OK) {
+        return rc;
+    }
+    *plast = sink;
+
+    assert(aushape_conv_is_valid(conv));
+    return AUSHAPE_RC_OK;
+}
+
+enum aushape_rc
+aushape_conv_get_mem_stats(const struct aushape_conv *conv,
+                           struct aushape_conv_mem_stats *pstats)
+{
+    const struct aushape_conv_sink *sink;
+    struct aushape_conv_mem_stats stats;
+
+    if (!aushape_conv_is_valid(conv) || pstats == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    aushape_conv_buf_get_mem_stats(&conv->sink_list->buf, pstats);
+    for (sink = conv->sink_list->next; sink != NULL; sink = sink->next) {
+        aushape_conv_buf_get_mem_stats(&sink->buf, &stats);
+        aushape_mem_usage_add(&pstats->output, &stats.output);
+        aushape_mem_usage_add(&pstats->event, &stats.event);
+        aushape_mem_usage_add(&pstats->text, &stats.text);
+        aushape_mem_usage_add(&pstats->data, &stats.data);
+        aushape_mem_usage_add(&pstats->norm, &stats.norm);
+        aushape_mem_usage_add(&pstats->batch, &stats.batch);
+        aushape_mem_usage_add(&pstats->shapes, &stats.shapes);
+        aushape_mem_usage_add(&pstats->total, &stats.total);
+    }
+    /* Add the intermediate representation, shared by the outputs */
+    aushape_conv_ir_get_mem_usage(&conv->ir, &pstats->colls);
+    aushape_mem_usage_add(&pstats->total, &pstats->colls);
+    return AUSHAPE_RC_OK;
+}
+
+enum aushape_rc
+aushape_conv_get_shape_stats(const struct aushape_conv *conv,
+                             struct aushape_conv_shape_stats *pstats)
+{
+    const struct aushape_conv_sink *sink;
+    struct aushape_conv_shape_stats stats;
+
+    if (!aushape_conv_is_valid(conv) || pstats == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    aushape_conv_buf_get_shape_stats(&conv->sink_list->buf, pstats);
+    for (sink = conv->sink_list->next; sink != NULL; sink = sink->next) {
+        aushape_conv_buf_get_shape_stats(&sink->buf, &stats);
+        pstats->hits += stats.hits;
+        pstats->misses += stats.misses;
+    }
+    return AUSHAPE_RC_OK;
+}
+
+enum aushape_rc
+aushape_conv_get_output_rc(const struct aushape_conv *conv,
+                           size_t index,
+                           enum aushape_rc *prc)
+{
+    const struct aushape_conv_sink *sink;
+
+    if (!aushape_conv_is_valid(conv) || prc == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    for (sink = conv->sink_list; sink != NULL && index > 0;
+         sink = sink->next, index--);
+    if (sink == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    *prc = sink->rc;
+    return AUSHAPE_RC_OK;
+}
+
+enum aushape_rc
+aushape_conv_shrink(struct aushape_conv *conv)
+{
+    struct aushape_conv_sink *sink;
+
     if (!aushape_conv_is_valid(conv)) {
         return AUSHAPE_RC_INVALID_ARGS;
     }
-    if (conv->format.events_per_doc != SSIZE_MAX) {
-        return AUSHAPE_RC_OK;
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        aushape_conv_buf_shrink(&sink->buf);
     }
-    if (conv->in_doc) {
-        return AUSHAPE_RC_INVALID_STATE;
+    assert(aushape_conv_is_valid(conv));
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Check if a converter has an output with a single document for all events,
+ * which wasn't started with aushape_conv_begin, or was already ended with
+ * aushape_conv_end.
+ *
+ * @param conv  The converter to check.
+ *
+ * @return True if there is an output outside its only document.
+ */
+static bool
+aushape_conv_is_out_of_doc(const struct aushape_conv *conv)
+{
+    const struct aushape_conv_sink *sink;
+
+    assert(aushape_conv_is_valid(conv));
+
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (sink->format.events_per_doc == SSIZE_MAX && !sink->in_doc) {
+            return true;
+        }
     }
+    return false;
+}
 
-    if (conv->rc == AUSHAPE_RC_OK) {
-        enum aushape_rc rc;
-        rc = aushape_conv_buf_add_prologue(&conv->buf);
+enum aushape_rc
+aushape_conv_begin(struct aushape_conv *conv)
+{
+    struct aushape_conv_sink *sink;
+    enum aushape_rc rc;
+
+    if (!aushape_conv_is_valid(conv)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (sink->format.events_per_doc == SSIZE_MAX && sink->in_doc) {
+            return AUSHAPE_RC_INVALID_STATE;
+        }
+    }
+
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (sink->format.events_per_doc != SSIZE_MAX ||
+            !aushape_conv_sink_is_ok(conv, sink)) {
+            continue;
+        }
+        rc = aushape_conv_buf_add_prologue(&sink->buf);
         if (rc == AUSHAPE_RC_OK) {
-            conv->in_doc = true;
-            if (aushape_output_is_cont(conv->output)) {
-                rc = aushape_output_write(conv->output,
-                                          conv->buf.gbuf.ptr,
-                                          conv->buf.gbuf.len);
-                if (rc == AUSHAPE_RC_OK) {
-                    aushape_conv_buf_empty(&conv->buf);
-                } else {
-                    conv->rc = rc;
-                }
+            sink->in_doc = true;
+            if (aushape_output_is_cont(sink->output)) {
+                aushape_conv_write(conv, sink);
             }
         } else {
-            conv->rc = rc;
+            sink->rc = rc;
         }
-        assert(aushape_conv_is_valid(conv));
     }
+    assert(aushape_conv_is_valid(conv));
 
-    return conv->rc;
+    return aushape_conv_get_rc(conv, false);
 }
 
 enum aushape_rc
 aushape_conv_end(struct aushape_conv *conv)
 {
+    struct aushape_conv_sink *sink;
+    enum aushape_rc rc;
+
     if (!aushape_conv_is_valid(conv)) {
         return AUSHAPE_RC_INVALID_ARGS;
     }
-    if (conv->format.events_per_doc == 0) {
-        return AUSHAPE_RC_OK;
-    } else if (!conv->in_doc) {
-        if (conv->format.events_per_doc == SSIZE_MAX) {
-            return AUSHAPE_RC_INVALID_STATE;
-        } else {
-            return AUSHAPE_RC_OK;
-        }
+    if (aushape_conv_is_out_of_doc(conv)) {
+        return AUSHAPE_RC_INVALID_STATE;
     }
 
-    if (conv->rc == AUSHAPE_RC_OK) {
-        enum aushape_rc rc;
-        rc = aushape_conv_buf_add_epilogue(&conv->buf);
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (!aushape_conv_sink_is_ok(conv, sink)) {
+            continue;
+        }
+        if (!sink->in_doc) {
+            aushape_conv_sync(conv, sink, true);
+            continue;
+        }
+        rc = aushape_conv_buf_add_epilogue(&sink->buf);
         if (rc == AUSHAPE_RC_OK) {
-            rc = aushape_output_write(conv->output,
-                                      conv->buf.gbuf.ptr,
-                                      conv->buf.gbuf.len);
-            if (rc == AUSHAPE_RC_OK) {
-                aushape_conv_buf_empty(&conv->buf);
-                conv->events_in_doc = 0;
-                conv->in_doc = false;
-            } else {
-                conv->rc = rc;
+            aushape_conv_write(conv, sink);
+            if (aushape_conv_sink_is_ok(conv, sink)) {
+                sink->events_in_doc = 0;
+                sink->in_doc = false;
+                aushape_conv_sync(conv, sink, true);
             }
         } else {
-            conv->rc = rc;
+            sink->rc = rc;
         }
-        assert(aushape_conv_is_valid(conv));
     }
+    assert(aushape_conv_is_valid(conv));
 
-    return conv->rc;
+    return aushape_conv_get_rc(conv, false);
 }
 
 enum aushape_rc
@@ -305,11 +926,13 @@ aushape_conv_input(struct aushape_conv *conv,
                    const char *ptr,
                    size_t len)
 {
+    struct aushape_conv_sink *sink;
+
     if (!aushape_conv_is_valid(conv) ||
         (ptr == NULL && len > 0)) {
         return AUSHAPE_RC_INVALID_ARGS;
     }
-    if (conv->format.events_per_doc == SSIZE_MAX && !conv->in_doc) {
+    if (aushape_conv_is_out_of_doc(conv)) {
         return AUSHAPE_RC_INVALID_STATE;
     }
 
@@ -318,17 +941,26 @@ aushape_conv_input(struct aushape_conv *conv,
             conv->rc = AUSHAPE_RC_AUPARSE_FAILED;
         }
     }
+    /* Don't hold the events converted from this input piece */
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (sink->format.ndjson) {
+            aushape_conv_write_batch(conv, sink);
+        }
+    }
 
-    return conv->rc;
+    /* Carry on while any output works */
+    return aushape_conv_get_rc(conv, true);
 }
 
 enum aushape_rc
 aushape_conv_flush(struct aushape_conv *conv)
 {
+    struct aushape_conv_sink *sink;
+
     if (!aushape_conv_is_valid(conv)) {
         return AUSHAPE_RC_INVALID_ARGS;
     }
-    if (conv->format.events_per_doc == SSIZE_MAX && !conv->in_doc) {
+    if (aushape_conv_is_out_of_doc(conv)) {
         return AUSHAPE_RC_INVALID_STATE;
     }
 
@@ -337,21 +969,33 @@ aushape_conv_flush(struct aushape_conv *conv)
             conv->rc = AUSHAPE_RC_AUPARSE_FAILED;
         }
     }
+    for (sink = conv->sink_list; sink != NULL; sink = sink->next) {
+        if (sink->format.ndjson) {
+            aushape_conv_write_batch(conv, sink);
+        }
+        /* Pass on complete documents, if not in the middle of one */
+        if (!sink->in_doc) {
+            aushape_conv_sync(conv, sink, true);
+        }
+    }
 
-    return conv->rc;
+    return aushape_conv_get_rc(conv, false);
 }
 
 void
 aushape_conv_destroy(struct aushape_conv *conv)
 {
     if (conv != NULL) {
+        const struct aushape_mem *mem = conv->mem;
+        struct aushape_conv_sink *sink;
         assert(aushape_conv_is_valid(conv));
         auparse_destroy(conv->au);
-        aushape_conv_buf_cleanup(&conv->buf);
-        if (conv->output_owned) {
-            aushape_output_destroy(conv->output);
+        while ((sink = conv->sink_list) != NULL) {
+            conv->sink_list = sink->next;
+            aushape_conv_sink_destroy(sink, mem);
         }
+        aushape_conv_ir_cleanup(&conv->ir);
         memset(conv, 0, sizeof(*conv));
-        free(conv);
+        aushape_mem_free(mem, conv);
     }
 }
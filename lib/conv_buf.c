@@ -19,103 +19,47 @@
  */
 
 #include <aushape/conv_buf.h>
-#include <aushape/disp_coll.h>
-#include <aushape/drop_coll.h>
-#include <aushape/uniq_coll.h>
-#include <aushape/execve_coll.h>
-#include <aushape/path_coll.h>
-#include <aushape/rep_coll.h>
-#include <aushape/field.h>
 #include <aushape/guard.h>
-#include <aushape/misc.h>
-#include <stdio.h>
+#include <aushape/key_dict.h>
 #include <string.h>
 
 bool
 aushape_conv_buf_is_valid(const struct aushape_conv_buf *buf)
 {
     return buf != NULL &&
-           aushape_format_is_valid(&buf->format) &&
+           aushape_emitter_is_valid(buf->emitter, &buf->format) &&
            aushape_gbuf_is_valid(&buf->gbuf) &&
+           aushape_gbuf_is_valid(&buf->doc) &&
            aushape_gbtree_is_valid(&buf->event) &&
            aushape_gbtree_is_valid(&buf->text) &&
            aushape_gbtree_is_valid(&buf->data) &&
            aushape_gbtree_is_valid(&buf->norm) &&
-           aushape_coll_is_valid(buf->coll);
+           aushape_garr_is_valid(&buf->lists) &&
+           aushape_arrow_is_valid(&buf->arrow) &&
+           aushape_shape_cache_is_valid(&buf->shapes);
 }
 
 enum aushape_rc
 aushape_conv_buf_init(struct aushape_conv_buf *buf,
-                      const struct aushape_format *format)
+                      const struct aushape_format *format,
+                      const struct aushape_mem *mem)
 {
-    static const struct aushape_rep_coll_args obj_pid_args = {
-        .name = "obj_pid",
-    };
-    static const struct aushape_rep_coll_args avc_args = {
-        .name = "avc",
-    };
-    static const struct aushape_rep_coll_args netfilter_cfg_args = {
-        .name = "netfilter_cfg",
-    };
-    static const struct aushape_disp_coll_type_link map[] = {
-        {
-            .name   = "EXECVE",
-            .type   = &aushape_execve_coll_type,
-            .args   = NULL,
-        },
-        {
-            .name   = "PATH",
-            .type   = &aushape_path_coll_type,
-            .args   = NULL,
-        },
-        {
-            .name   = "OBJ_PID",
-            .type   = &aushape_rep_coll_type,
-            .args   = &obj_pid_args,
-        },
-        {
-            .name   = "AVC",
-            .type   = &aushape_rep_coll_type,
-            .args   = &avc_args,
-        },
-        {
-            .name   = "NETFILTER_CFG",
-            .type   = &aushape_rep_coll_type,
-            .args   = &netfilter_cfg_args,
-        },
-        {
-            .name   = "EOE",
-            .type   = &aushape_drop_coll_type,
-            .args   = NULL,
-        },
-        {
-            .name   = NULL,
-            .type   = &aushape_uniq_coll_type,
-            .args   = NULL,
-        },
-    };
-
-    enum aushape_rc rc;
-
-    if (buf == NULL || !aushape_format_is_valid(format)) {
+    if (buf == NULL || !aushape_format_is_valid(format) ||
+        !aushape_mem_is_valid(mem)) {
         return AUSHAPE_RC_INVALID_ARGS;
     }
     memset(buf, 0, sizeof(*buf));
     buf->format = *format;
-    aushape_gbuf_init(&buf->gbuf, 4096);
-    aushape_gbtree_init(&buf->event, 1024, 32, 32);
-    aushape_gbtree_init(&buf->text, 4096, 8, 8);
-    aushape_gbtree_init(&buf->data, 4096, 256, 256);
-    aushape_gbtree_init(&buf->norm, 4096, 32, 32);
-    rc = aushape_coll_create(&buf->coll,
-                             &aushape_disp_coll_type,
-                             &buf->format,
-                             &buf->data,
-                             &map);
-    if (rc != AUSHAPE_RC_OK) {
-        assert(rc != AUSHAPE_RC_INVALID_ARGS);
-        return rc;
-    }
+    buf->emitter = aushape_emitter_get(format);
+    aushape_gbuf_init(&buf->gbuf, 4096, mem);
+    aushape_gbuf_init(&buf->doc, 4096, mem);
+    aushape_gbtree_init(&buf->event, 1024, 32, 32, mem);
+    aushape_gbtree_init(&buf->text, 4096, 8, 8, mem);
+    aushape_gbtree_init(&buf->data, 4096, 256, 256, mem);
+    aushape_gbtree_init(&buf->norm, 4096, 32, 32, mem);
+    aushape_garr_init(&buf->lists, sizeof(struct aushape_gbtree *), 4, mem);
+    aushape_arrow_init(&buf->arrow, format->with_text, mem);
+    aushape_shape_cache_init(&buf->shapes, mem);
     assert(aushape_conv_buf_is_valid(buf));
     return AUSHAPE_RC_OK;
 }
@@ -123,16 +67,119 @@ aushape_conv_buf_init(struct aushape_conv_buf *buf,
 void
 aushape_conv_buf_cleanup(struct aushape_conv_buf *buf)
 {
+    struct aushape_gbtree *list;
+    size_t i;
+
     assert(aushape_conv_buf_is_valid(buf));
-    aushape_coll_destroy(buf->coll);
+    for (i = 0; i < aushape_garr_get_len(&buf->lists); i++) {
+        list = *(struct aushape_gbtree **)aushape_garr_get(&buf->lists, i);
+        aushape_gbtree_cleanup(list);
+        aushape_mem_free(buf->gbuf.mem, list);
+    }
+    aushape_garr_cleanup(&buf->lists);
     aushape_gbtree_cleanup(&buf->data);
     aushape_gbtree_cleanup(&buf->text);
     aushape_gbtree_cleanup(&buf->norm);
     aushape_gbtree_cleanup(&buf->event);
+    aushape_gbuf_cleanup(&buf->doc);
     aushape_gbuf_cleanup(&buf->gbuf);
+    aushape_arrow_cleanup(&buf->arrow);
+    aushape_shape_cache_cleanup(&buf->shapes);
     memset(buf, 0, sizeof(*buf));
 }
 
+void
+aushape_conv_buf_shrink(struct aushape_conv_buf *buf)
+{
+    size_t i;
+
+    assert(aushape_conv_buf_is_valid(buf));
+    aushape_gbuf_shrink(&buf->gbuf);
+    aushape_gbuf_shrink(&buf->doc);
+    aushape_gbtree_shrink(&buf->event);
+    aushape_gbtree_shrink(&buf->text);
+    aushape_gbtree_shrink(&buf->data);
+    aushape_gbtree_shrink(&buf->norm);
+    for (i = 0; i < aushape_garr_get_len(&buf->lists); i++) {
+        aushape_gbtree_shrink(
+                *(struct aushape_gbtree **)aushape_garr_get(&buf->lists, i));
+    }
+    aushape_arrow_shrink(&buf->arrow);
+    aushape_shape_cache_shrink(&buf->shapes);
+    buf->small_events = 0;
+    assert(aushape_conv_buf_is_valid(buf));
+}
+
+void
+aushape_conv_buf_get_mem_stats(const struct aushape_conv_buf *buf,
+                               struct aushape_conv_mem_stats *stats)
+{
+    size_t i;
+
+    assert(aushape_conv_buf_is_valid(buf));
+    assert(stats != NULL);
+
+    memset(stats, 0, sizeof(*stats));
+    aushape_gbuf_get_mem_usage(&buf->gbuf, &stats->output);
+    aushape_gbuf_get_mem_usage(&buf->doc, &stats->output);
+    aushape_gbtree_get_mem_usage(&buf->event, &stats->event);
+    aushape_gbtree_get_mem_usage(&buf->text, &stats->text);
+    aushape_gbtree_get_mem_usage(&buf->data, &stats->data);
+    aushape_garr_get_mem_usage(&buf->lists, &stats->data);
+    for (i = 0; i < aushape_garr_get_len(&buf->lists); i++) {
+        aushape_gbtree_get_mem_usage(
+                *(struct aushape_gbtree *const *)
+                    aushape_garr_const_get(&buf->lists, i),
+                &stats->data);
+    }
+    aushape_gbtree_get_mem_usage(&buf->norm, &stats->norm);
+    aushape_arrow_get_mem_usage(&buf->arrow, &stats->batch);
+    aushape_shape_cache_get_mem_usage(&buf->shapes, &stats->shapes);
+
+    aushape_mem_usage_add(&stats->total, &stats->output);
+    aushape_mem_usage_add(&stats->total, &stats->event);
+    aushape_mem_usage_add(&stats->total, &stats->text);
+    aushape_mem_usage_add(&stats->total, &stats->data);
+    aushape_mem_usage_add(&stats->total, &stats->norm);
+    aushape_mem_usage_add(&stats->total, &stats->batch);
+    aushape_mem_usage_add(&stats->total, &stats->shapes);
+}
+
+void
+aushape_conv_buf_get_shape_stats(const struct aushape_conv_buf *buf,
+                                 struct aushape_conv_shape_stats *stats)
+{
+    assert(aushape_conv_buf_is_valid(buf));
+    assert(stats != NULL);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->hits = buf->shapes.hits;
+    stats->misses = buf->shapes.misses;
+}
+
+/**
+ * Account an event in the buffer shrinking policy, and shrink the buffers,
+ * if the policy says so.
+ *
+ * @param buf   The buffer to account the event for.
+ * @param len   The (untrimmed) length of the event.
+ */
+static void
+aushape_conv_buf_account_event(struct aushape_conv_buf *buf, size_t len)
+{
+    assert(aushape_conv_buf_is_valid(buf));
+
+    if (buf->format.shrink_after == 0) {
+        return;
+    }
+
+    if (len >= buf->format.shrink_below) {
+        buf->small_events = 0;
+    } else if (++buf->small_events >= buf->format.shrink_after) {
+        aushape_conv_buf_shrink(buf);
+    }
+}
+
 void
 aushape_conv_buf_empty(struct aushape_conv_buf *buf)
 {
@@ -141,233 +188,369 @@ aushape_conv_buf_empty(struct aushape_conv_buf *buf)
     assert(aushape_conv_buf_is_valid(buf));
 }
 
-/** Normalized field type */
-enum aushape_conv_buf_norm_type {
-    /** Metadata field */
-    AUSHAPE_CONV_BUF_NORM_TYPE_META,
-    /** Positioning field */
-    AUSHAPE_CONV_BUF_NORM_TYPE_POS,
-    /** Position listing field */
-    AUSHAPE_CONV_BUF_NORM_TYPE_POS_LIST,
-};
-
-/** Description of a normalized field */
-struct aushape_conv_buf_norm_field {
-    /** Field name */
-    const char                         *name;
-    /** Field type */
-    enum aushape_conv_buf_norm_type     type;
-    /** Field item name for position listing fields */
-    const char                         *item_name;
-    /** Value extraсtion function for metadata fields */
-    const char *(*fn_meta)(auparse_state_t *au);
-    /** Cursor position function for positioning fields */
-    int (*fn_pos)(auparse_state_t *au);
-    /** Iteration beginning function for position listing fields */
-    int (*fn_pos_list_first)(auparse_state_t *au);
-    /** Iteration continuation function for position listing fields */
-    int (*fn_pos_list_next)(auparse_state_t *au);
-};
-
 /**
- * Add event normalized data.
+ * Get a growing buffer sub-tree for an event's data list, allocating it if
+ * necessary.
  *
- * @param buf   The buffer to add normalized data to.
- * @param level Syntactic nesting level to add normalized data with.
- * @param au    The auparse state with the current event as the event which
- *              normalized data should be added.
+ * @param buf   The buffer to get the sub-tree from.
+ * @param index Index of the sub-tree, must not exceed the number of already
+ *              allocated sub-trees.
+ * @param plist Location for the sub-tree pointer.
  *
  * @return Return code:
- *          AUSHAPE_RC_OK               - added successfully,
- *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ *          AUSHAPE_RC_OK       - retrieved successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
  */
 static enum aushape_rc
-aushape_conv_buf_add_event_norm(struct aushape_conv_buf *buf,
-                                size_t level,
-                                auparse_state_t *au)
+aushape_conv_buf_get_list(struct aushape_conv_buf *buf,
+                          size_t index,
+                          struct aushape_gbtree **plist)
 {
-    static const struct aushape_conv_buf_norm_field field_list[] = {
-#define FIELD_META(_name_tkn, _fn) \
-        {.name = #_name_tkn,                        \
-         .type = AUSHAPE_CONV_BUF_NORM_TYPE_META,   \
-         .fn_meta = _fn}
-#define FIELD_POS(_name_tkn, _fn) \
-        {.name = #_name_tkn,                        \
-         .type = AUSHAPE_CONV_BUF_NORM_TYPE_POS,   \
-         .fn_pos = _fn}
-#define FIELD_POS_LIST(_name_tkn, _item_name_tkn, _fn_first, _fn_next) \
-        {.name = #_name_tkn,                                            \
-         .item_name = #_item_name_tkn,                                  \
-         .type = AUSHAPE_CONV_BUF_NORM_TYPE_POS_LIST,                   \
-         .fn_pos_list_first = _fn_first,                                \
-         .fn_pos_list_next = _fn_next}
-
-        FIELD_META(event_kind,          auparse_normalize_get_event_kind),
-
-        FIELD_POS(session,              auparse_normalize_session),
-
-        FIELD_META(subject_kind,        auparse_normalize_subject_kind),
-        FIELD_POS(subject_primary,      auparse_normalize_subject_primary),
-        FIELD_POS(subject_secondary,    auparse_normalize_subject_secondary),
-        FIELD_POS_LIST(subject_attrs, attr,
-                                    auparse_normalize_subject_first_attribute,
-                                    auparse_normalize_subject_next_attribute),
-
-        FIELD_META(action,              auparse_normalize_get_action),
-
-        FIELD_META(object_kind,         auparse_normalize_object_kind),
-        FIELD_POS(object_primary,       auparse_normalize_object_primary),
-        FIELD_POS(object_secondary,     auparse_normalize_object_secondary),
-        FIELD_POS(object_primary2,      auparse_normalize_object_primary2),
-        FIELD_POS_LIST(object_attrs, attr,
-                                    auparse_normalize_object_first_attribute,
-                                    auparse_normalize_object_next_attribute),
-
-        FIELD_POS(result,               auparse_normalize_get_results),
-
-        FIELD_META(how,                 auparse_normalize_how),
-
-        FIELD_POS(key,                  auparse_normalize_key),
-
-#undef FIELD_POS_LIST
-#undef FIELD_POS
-#undef FIELD_META
-    };
+    enum aushape_rc rc;
+    struct aushape_gbtree *list = NULL;
 
-    struct aushape_gbtree *tree = &buf->norm;
-    struct aushape_gbuf *gbuf = &tree->text;
-    size_t prio;
+    assert(aushape_conv_buf_is_valid(buf));
+    assert(index <= aushape_garr_get_len(&buf->lists));
+    assert(plist != NULL);
+
+    if (index < aushape_garr_get_len(&buf->lists)) {
+        *plist = *(struct aushape_gbtree **)
+                        aushape_garr_get(&buf->lists, index);
+        return AUSHAPE_RC_OK;
+    }
+
+    list = aushape_mem_realloc(buf->gbuf.mem, NULL, sizeof(*list));
+    AUSHAPE_GUARD_BOOL(NOMEM, list != NULL);
+    aushape_gbtree_init(list, 4096, 8, 8, buf->gbuf.mem);
+    rc = aushape_garr_set(&buf->lists, index, &list);
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_gbtree_cleanup(list);
+        aushape_mem_free(buf->gbuf.mem, list);
+        goto cleanup;
+    }
+    *plist = list;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add an intermediate list node to a growing buffer tree, with the prologue
+ * and epilogue at the specified priority, and each item at that priority
+ * plus its own. For MessagePack the tree must be empty, as the list's array
+ * head counts all the nodes following it.
+ *
+ * @param buf   The buffer to output with.
+ * @param tree  The tree to add the list to.
+ * @param prio  The priority to add the list with.
+ * @param level Syntactic nesting level to output the list at.
+ * @param pool  The pool the list node refers to.
+ * @param list  The list node to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_conv_buf_add_list(struct aushape_conv_buf *buf,
+                          struct aushape_gbtree *tree,
+                          size_t prio,
+                          size_t level,
+                          const struct aushape_itree_pool *pool,
+                          const struct aushape_itree_node *list)
+{
     enum aushape_rc rc;
-    size_t i;
-    size_t j;
-    int auparse_rc;
-    size_t l = level;
+    struct aushape_gbuf *gbuf = &tree->text;
+    const char *name;
+    const char *item_name;
+    const struct aushape_itree_node *item;
     const char *str;
+    size_t l = level;
+    size_t i;
+    size_t len;
 
     assert(aushape_conv_buf_is_valid(buf));
-    assert(au != NULL);
-
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED,
-                       auparse_normalize(au, NORM_OPT_ALL) == 0);
-
-    prio = 1;
-    for (i = 0; i < AUSHAPE_ARRAY_SIZE(field_list); i++) {
-        const struct aushape_conv_buf_norm_field *field = &field_list[i];
-
-        switch (field->type) {
-        case AUSHAPE_CONV_BUF_NORM_TYPE_META:
-            str = field->fn_meta(au);
-            if (str != NULL) {
-                AUSHAPE_GUARD(aushape_field_format_props(gbuf, &buf->format,
-                                                         l, i == 0, false,
-                                                         field->name,
-                                                         NULL, str));
-                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio++));
-            }
-            break;
-        case AUSHAPE_CONV_BUF_NORM_TYPE_POS:
-            auparse_rc = field->fn_pos(au);
-            AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, auparse_rc >= 0);
-            if (auparse_rc == 1) {
-                AUSHAPE_GUARD(aushape_field_format(gbuf, &buf->format,
-                                                   l, i == 0, false,
-                                                   field->name, au));
-                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio++));
-            }
-            break;
-        case AUSHAPE_CONV_BUF_NORM_TYPE_POS_LIST:
-            auparse_rc = field->fn_pos_list_first(au);
-            AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, auparse_rc >= 0);
-            if (auparse_rc != 1) {
-                break;
-            }
+    assert(aushape_gbtree_is_valid(tree));
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(list != NULL);
+    assert(list->type == AUSHAPE_ITREE_NODE_TYPE_LIST);
+    assert(buf->format.lang != AUSHAPE_LANG_MSGPACK ||
+           aushape_gbtree_get_node_num(tree) == 0);
+
+    name = aushape_itree_pool_get_str(pool, list->name);
+    item_name = aushape_itree_pool_get_str(pool, list->item_name);
 
-            /* Add list prologue */
-            switch (buf->format.lang) {
-            case AUSHAPE_LANG_XML:
+    /* Output prologue */
+    if (buf->format.lang == AUSHAPE_LANG_XML) {
+        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &buf->format, l));
+        AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "<%s>", name));
+    } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
+        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &buf->format, l));
+        AUSHAPE_GUARD(aushape_key_dict_add_json(gbuf, &buf->format,
+                                                name, false));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, ":["));
+    } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(gbuf, name));
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(gbuf,
+                                                  AUSHAPE_CBOR_MAJOR_ARRAY));
+    } else if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+        AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(gbuf, name));
+    }
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio));
+    if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+        AUSHAPE_GUARD(aushape_gbtree_node_add_head(
+                                    tree, prio, AUSHAPE_MSGPACK_TYPE_ARRAY));
+    }
+
+    l++;
+
+    /* Output items */
+    for (i = 0; i < list->len; i++) {
+        item = aushape_itree_get_node(list->tree, list->pos + i);
+        if (item->type == AUSHAPE_ITREE_NODE_TYPE_FIELD) {
+            AUSHAPE_GUARD(buf->emitter->field(
+                                gbuf, &buf->format, l, i == 0, true,
+                                item_name, pool,
+                                aushape_itree_pool_get_field(pool,
+                                                             item->pos)));
+        } else if (item->type == AUSHAPE_ITREE_NODE_TYPE_BYTES) {
+            str = aushape_itree_pool_get_str(pool, item->pos);
+            if (buf->format.lang == AUSHAPE_LANG_XML) {
                 AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf,
                                                          &buf->format, l));
-                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '<'));
-                AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, field->name));
-                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '>'));
-                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio));
-                break;
-            case AUSHAPE_LANG_JSON:
+                AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "<%s>", item_name));
+                AUSHAPE_GUARD(aushape_gbuf_add_buf_xml(gbuf, str, item->len));
+                AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "</%s>", item_name));
+            } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
                 if (i > 0) {
                     AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
                 }
                 AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf,
                                                          &buf->format, l));
                 AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-                AUSHAPE_GUARD(aushape_gbuf_add_str_json(gbuf, field->name));
-                AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\":["));
-                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio));
-            default:
-                break;
+                AUSHAPE_GUARD(aushape_gbuf_add_buf_json(gbuf, str,
+                                                        item->len));
+                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
+            } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+                AUSHAPE_GUARD(aushape_gbuf_add_bytes_cbor(gbuf, str,
+                                                          item->len));
+            } else if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+                AUSHAPE_GUARD(aushape_gbuf_add_bytes_msgpack(gbuf, str,
+                                                             item->len));
             }
-            l++;
-
-            /* Add list items */
-            j = 0;
-            do {
-                AUSHAPE_GUARD(aushape_field_format(gbuf, &buf->format, l,
-                                                   j == 0, true,
-                                                   field->item_name, au));
-                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio + j));
-                j++;
-                auparse_rc = field->fn_pos_list_next(au);
-                AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, auparse_rc >= 0);
-            } while (auparse_rc == 1);
-
-            /* Add list epilogue */
-            l--;
-            switch (buf->format.lang) {
-            case AUSHAPE_LANG_XML:
-                AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf,
+        } else {
+            assert(item->type == AUSHAPE_ITREE_NODE_TYPE_RECORD);
+            if (buf->format.lang == AUSHAPE_LANG_XML) {
+                AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf,
+                                                         &buf->format, l));
+                AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "<%s>", item_name));
+            } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
+                if (i > 0) {
+                    AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+                }
+                AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf,
                                                          &buf->format, l));
-                AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</"));
-                AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, field->name));
-                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '>'));
-                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio));
-                break;
-            case AUSHAPE_LANG_JSON:
+                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '{'));
+            } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+                AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(
+                                            gbuf, AUSHAPE_CBOR_MAJOR_MAP));
+            } else if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+                AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(
+                                            gbuf, AUSHAPE_MSGPACK_TYPE_MAP,
+                                            item->len));
+            }
+            len = gbuf->len;
+            AUSHAPE_GUARD(buf->emitter->record_fields(gbuf, &buf->format,
+                                                      l + 1, &buf->shapes,
+                                                      pool, item));
+            if (buf->format.lang == AUSHAPE_LANG_XML) {
                 AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf,
                                                          &buf->format, l));
-                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ']'));
-                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio));
-            default:
-                break;
+                AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "</%s>", item_name));
+            } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
+                if (gbuf->len > len) {
+                    AUSHAPE_GUARD(aushape_gbuf_space_closing(
+                                                gbuf, &buf->format, l));
+                }
+                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '}'));
+            } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf,
+                                                    AUSHAPE_CBOR_BREAK));
             }
-            prio += j;
-            break;
-        default:
-            break;
         }
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio + item->prio));
     }
 
+    l--;
+
+    /* Output epilogue */
+    if (buf->format.lang == AUSHAPE_LANG_XML) {
+        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &buf->format, l));
+        AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "</%s>", name));
+    } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
+        if (list->len > 0) {
+            AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &buf->format, l));
+        }
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ']'));
+    } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, AUSHAPE_CBOR_BREAK));
+    }
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, prio));
+
     assert(l == level);
     rc = AUSHAPE_RC_OK;
 cleanup:
     return rc;
 }
 
+/**
+ * Add event data, rendering the data nodes of an intermediate event
+ * representation.
+ *
+ * @param buf   The buffer to add data to.
+ * @param level Syntactic nesting level to add data with.
+ * @param ir    The intermediate representation of the event.
+ * @param plist_num Location for the number of used list sub-trees.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_conv_buf_add_event_data(struct aushape_conv_buf *buf,
+                                size_t level,
+                                const struct aushape_conv_ir *ir,
+                                size_t *plist_num)
+{
+    enum aushape_rc rc;
+    struct aushape_gbtree *tree = &buf->data;
+    struct aushape_gbuf *gbuf = &tree->text;
+    struct aushape_gbtree *list;
+    const struct aushape_itree_node *node;
+    size_t i;
+
+    assert(aushape_conv_buf_is_valid(buf));
+    assert(aushape_conv_ir_is_valid(ir));
+    assert(plist_num != NULL);
+
+    for (i = 0; i < aushape_itree_get_node_num(&ir->data); i++) {
+        node = aushape_itree_get_node(&ir->data, i);
+        if (node->type == AUSHAPE_ITREE_NODE_TYPE_RECORD) {
+            if (node->def != NULL) {
+                AUSHAPE_GUARD(buf->emitter->record_def(gbuf, &buf->format,
+                                                       level, i == 0,
+                                                       &buf->shapes,
+                                                       &ir->pool, node));
+            } else {
+                AUSHAPE_GUARD(buf->emitter->record(gbuf, &buf->format,
+                                                   level, i == 0,
+                                                   &buf->shapes,
+                                                   &ir->pool, node));
+            }
+            AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, node->prio));
+        } else {
+            assert(node->type == AUSHAPE_ITREE_NODE_TYPE_LIST);
+            AUSHAPE_GUARD(aushape_conv_buf_get_list(buf, *plist_num, &list));
+            (*plist_num)++;
+            AUSHAPE_GUARD(aushape_conv_buf_add_list(buf, list, 0, level,
+                                                    &ir->pool, node));
+            if (buf->format.lang == AUSHAPE_LANG_JSON && i > 0) {
+                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+                AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree,
+                                                           node->prio));
+            }
+            AUSHAPE_GUARD(aushape_gbtree_node_add_tree(tree, node->prio,
+                                                       list));
+        }
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Add event normalized data, rendering the normalized data nodes of an
+ * intermediate event representation.
+ *
+ * @param buf   The buffer to add normalized data to.
+ * @param level Syntactic nesting level to add normalized data with.
+ * @param ir    The intermediate representation of the event.
+ * @param plist_num Location for the number of used list sub-trees.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_conv_buf_add_event_norm(struct aushape_conv_buf *buf,
+                                size_t level,
+                                const struct aushape_conv_ir *ir,
+                                size_t *plist_num)
+{
+    enum aushape_rc rc;
+    struct aushape_gbtree *tree = &buf->norm;
+    struct aushape_gbuf *gbuf = &tree->text;
+    struct aushape_gbtree *list;
+    const struct aushape_itree_node *node;
+    const struct aushape_itree_field *field;
+    size_t i;
+
+    assert(aushape_conv_buf_is_valid(buf));
+    assert(aushape_conv_ir_is_valid(ir));
+    assert(plist_num != NULL);
+
+    for (i = 0; i < aushape_itree_get_node_num(&ir->norm); i++) {
+        node = aushape_itree_get_node(&ir->norm, i);
+        if (node->type == AUSHAPE_ITREE_NODE_TYPE_FIELD) {
+            field = aushape_itree_pool_get_field(&ir->pool, node->pos);
+            AUSHAPE_GUARD(buf->emitter->field(
+                            gbuf, &buf->format, level, i == 0, false,
+                            aushape_itree_pool_get_str(&ir->pool,
+                                                       field->name),
+                            &ir->pool, field));
+            AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, node->prio));
+        } else {
+            assert(node->type == AUSHAPE_ITREE_NODE_TYPE_LIST);
+            if (buf->format.lang == AUSHAPE_LANG_JSON && i > 0) {
+                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+            }
+            /* A MessagePack list is a single map pair, so needs a sub-tree */
+            if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+                AUSHAPE_GUARD(aushape_conv_buf_get_list(buf, *plist_num,
+                                                        &list));
+                (*plist_num)++;
+                AUSHAPE_GUARD(aushape_conv_buf_add_list(buf, list, 0, level,
+                                                        &ir->pool, node));
+                AUSHAPE_GUARD(aushape_gbtree_node_add_tree(tree, node->prio,
+                                                           list));
+            } else {
+                AUSHAPE_GUARD(aushape_conv_buf_add_list(buf, tree,
+                                                        node->prio, level,
+                                                        &ir->pool, node));
+            }
+        }
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
 enum aushape_rc
 aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
                            bool first,
                            bool *padded,
-                           auparse_state_t *au)
+                           const struct aushape_conv_ir *ir)
 {
     enum aushape_rc rc;
     size_t level;
     size_t l;
-    const au_event_t *e;
-    struct tm *tm;
-    char time_buf[32];
-    char zone_buf[16];
-    char timestamp_buf[64];
+    const char *node;
+    const struct aushape_itree_node *line;
     size_t line_num;
     size_t record_num;
+    size_t list_num = 0;
     struct aushape_gbtree *event_tree = &buf->event;
     struct aushape_gbuf *event_buf = &event_tree->text;
     struct aushape_gbtree *text_tree = &buf->text;
@@ -376,32 +559,34 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
     struct aushape_gbuf *data_buf = &data_tree->text;
     struct aushape_gbtree *norm_tree = &buf->norm;
     struct aushape_gbuf *norm_buf = &norm_tree->text;
-    const char *line;
     enum aushape_rc error_rc;
     size_t trimmed_node_index;
     size_t error_node_index;
     size_t text_node_index;
     size_t data_node_index;
-    size_t len;
+    size_t len = 0;
     size_t trimmed_len;
 
     assert(aushape_conv_buf_is_valid(buf));
     assert(padded != NULL);
-    assert(au != NULL);
-    assert(aushape_coll_is_empty(buf->coll));
+    assert(aushape_conv_ir_is_valid(ir));
+
+    /* Arrow events are accumulated as rows of a record batch */
+    if (buf->format.lang == AUSHAPE_LANG_ARROW) {
+        rc = aushape_arrow_add_event(&buf->arrow, padded, ir);
+        /* Output each event as a batch, if not putting them in documents */
+        if (rc == AUSHAPE_RC_OK && buf->format.events_per_doc == 0) {
+            rc = aushape_arrow_write_batch(&buf->arrow, &buf->gbuf);
+        }
+        assert(aushape_conv_buf_is_valid(buf));
+        return rc;
+    }
 
     level = buf->format.events_per_doc != 0;
     l = level;
-
-    e = auparse_get_timestamp(au);
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, e != NULL);
-
-    /* Format timestamp */
-    tm = localtime(&e->sec);
-    strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%S", tm);
-    strftime(zone_buf, sizeof(zone_buf), "%z", tm);
-    snprintf(timestamp_buf, sizeof(timestamp_buf), "%s.%03u%.3s:%s",
-             time_buf, e->milli, zone_buf, zone_buf + 3);
+    node = ir->node == AUSHAPE_ITREE_POS_NONE
+                ? NULL
+                : aushape_itree_pool_get_str(&ir->pool, ir->node);
 
     /* Output event header */
     if (buf->format.lang == AUSHAPE_LANG_XML) {
@@ -409,10 +594,10 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
         AUSHAPE_GUARD(aushape_gbuf_space_opening(event_buf, &buf->format, l));
         AUSHAPE_GUARD(aushape_gbuf_add_fmt(
                             event_buf, "<event serial=\"%lu\" time=\"%s\"",
-                            e->serial, timestamp_buf));
-        if (e->host != NULL) {
+                            ir->serial, ir->time));
+        if (node != NULL) {
             AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, " node=\""));
-            AUSHAPE_GUARD(aushape_gbuf_add_str_xml(event_buf, e->host));
+            AUSHAPE_GUARD(aushape_gbuf_add_str_xml(event_buf, node));
             AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, "\""));
         }
         AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
@@ -451,9 +636,10 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
             AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 3,
                                                        norm_tree));
         }
-    } else {
-        /* Add event header */
-        if (!first) {
+    } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
+        /* Add event header, following the dictionary one, if any */
+        if (!first ||
+            (buf->format.compact_keys && buf->format.events_per_doc != 0)) {
             AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, ','));
         }
         AUSHAPE_GUARD(aushape_gbuf_space_opening(event_buf,
@@ -463,21 +649,25 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
 
         AUSHAPE_GUARD(aushape_gbuf_space_opening(event_buf,
                                                  &buf->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_fmt(event_buf,
-                                           "\"serial\":%lu", e->serial));
+        AUSHAPE_GUARD(aushape_key_dict_add_json(event_buf, &buf->format,
+                                                "serial", false));
+        AUSHAPE_GUARD(aushape_gbuf_add_fmt(event_buf, ":%lu", ir->serial));
 
         AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, ','));
         AUSHAPE_GUARD(aushape_gbuf_space_opening(event_buf,
                                                  &buf->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_fmt(event_buf,
-                                           "\"time\":\"%s\"",
-                                           timestamp_buf));
+        AUSHAPE_GUARD(aushape_key_dict_add_json(event_buf, &buf->format,
+                                                "time", false));
+        AUSHAPE_GUARD(aushape_gbuf_add_fmt(event_buf, ":\"%s\"",
+                                           ir->time));
 
-        if (e->host != NULL) {
+        if (node != NULL) {
             AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, ','));
             AUSHAPE_GUARD(aushape_gbuf_space_opening(event_buf, &buf->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, "\"node\":\""));
-            AUSHAPE_GUARD(aushape_gbuf_add_str_json(event_buf, e->host));
+            AUSHAPE_GUARD(aushape_key_dict_add_json(event_buf, &buf->format,
+                                                    "node", false));
+            AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, ":\""));
+            AUSHAPE_GUARD(aushape_gbuf_add_str_json(event_buf, node));
             AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, '"'));
         }
         AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
@@ -492,7 +682,9 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
         /* Begin and attach text node */
         AUSHAPE_GUARD(aushape_gbuf_add_char(text_buf, ','));
         AUSHAPE_GUARD(aushape_gbuf_space_opening(text_buf, &buf->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(text_buf, "\"text\":["));
+        AUSHAPE_GUARD(aushape_key_dict_add_json(text_buf, &buf->format,
+                                                "text", false));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(text_buf, ":["));
         AUSHAPE_GUARD(aushape_gbtree_node_add_text(text_tree, 0));
         text_node_index = aushape_gbtree_get_node_num(event_tree);
         AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 1, text_tree));
@@ -500,7 +692,9 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
         /* Begin and attach data node */
         AUSHAPE_GUARD(aushape_gbuf_add_char(data_buf, ','));
         AUSHAPE_GUARD(aushape_gbuf_space_opening(data_buf, &buf->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(data_buf, "\"data\":{"));
+        AUSHAPE_GUARD(aushape_key_dict_add_json(data_buf, &buf->format,
+                                                "data", false));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(data_buf, ":{"));
         AUSHAPE_GUARD(aushape_gbtree_node_add_text(data_tree, 0));
         data_node_index = aushape_gbtree_get_node_num(event_tree);
         AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 2, data_tree));
@@ -510,29 +704,149 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
             AUSHAPE_GUARD(aushape_gbuf_add_char(norm_buf, ','));
             AUSHAPE_GUARD(aushape_gbuf_space_opening(norm_buf,
                                                      &buf->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(norm_buf, "\"norm\":{"));
+            AUSHAPE_GUARD(aushape_key_dict_add_json(norm_buf, &buf->format,
+                                                    "norm", false));
+            AUSHAPE_GUARD(aushape_gbuf_add_str(norm_buf, ":{"));
             AUSHAPE_GUARD(aushape_gbtree_node_add_text(norm_tree, 0));
             AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 3,
                                                        norm_tree));
         }
+    } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+        /* Add event header */
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(event_buf,
+                                                  AUSHAPE_CBOR_MAJOR_MAP));
+        l++;
+
+        AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(event_buf, "serial"));
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(event_buf,
+                                                 AUSHAPE_CBOR_MAJOR_UINT,
+                                                 ir->serial));
+
+        AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(event_buf, "time"));
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(event_buf,
+                                                 AUSHAPE_CBOR_MAJOR_TAG,
+                                                 AUSHAPE_CBOR_TAG_EPOCH));
+        if (ir->milli == 0) {
+            AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(event_buf,
+                                                     AUSHAPE_CBOR_MAJOR_UINT,
+                                                     ir->sec));
+        } else {
+            AUSHAPE_GUARD(aushape_gbuf_add_double_cbor(
+                                    event_buf,
+                                    ir->sec + ir->milli / 1000.0));
+        }
+
+        if (node != NULL) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(event_buf, "node"));
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(event_buf, node));
+        }
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+
+        /* Add empty placeholder node for trimmed attribute */
+        trimmed_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+        /* Add empty placeholder node for error attribute */
+        error_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+
+        /* Begin and attach text node */
+        AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(text_buf, "text"));
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(text_buf,
+                                                  AUSHAPE_CBOR_MAJOR_ARRAY));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(text_tree, 0));
+        text_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 1, text_tree));
+
+        /* Begin and attach data node */
+        AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(data_buf, "data"));
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(data_buf,
+                                                  AUSHAPE_CBOR_MAJOR_MAP));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(data_tree, 0));
+        data_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 2, data_tree));
+
+        /* Begin and attach normalization node, if requested */
+        if (buf->format.with_norm) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(norm_buf, "norm"));
+            AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(
+                                        norm_buf, AUSHAPE_CBOR_MAJOR_MAP));
+            AUSHAPE_GUARD(aushape_gbtree_node_add_text(norm_tree, 0));
+            AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 3,
+                                                       norm_tree));
+        }
+    } else {
+        assert(buf->format.lang == AUSHAPE_LANG_MSGPACK);
+        /*
+         * Add event map head, counting the nodes following it, each being
+         * a single map pair, as they are after trimming
+         */
+        AUSHAPE_GUARD(aushape_gbtree_node_add_head(event_tree, 0,
+                                                   AUSHAPE_MSGPACK_TYPE_MAP));
+        l++;
+
+        AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(event_buf, "serial"));
+        AUSHAPE_GUARD(aushape_gbuf_add_uint_msgpack(event_buf, ir->serial));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+
+        AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(event_buf, "time"));
+        AUSHAPE_GUARD(aushape_gbuf_add_time_msgpack(event_buf, ir->sec,
+                                                    ir->milli * 1000000));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+
+        if (node != NULL) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(event_buf, "node"));
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(event_buf, node));
+            AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+        }
+
+        /* Add empty placeholder node for trimmed attribute */
+        trimmed_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+        /* Add empty placeholder node for error attribute */
+        error_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
+
+        /* Begin and attach text node, with the lines counted by the head */
+        AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(text_buf, "text"));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(text_tree, 0));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_head(
+                                text_tree, 0, AUSHAPE_MSGPACK_TYPE_ARRAY));
+        text_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 1, text_tree));
+
+        /* Begin and attach data node, with the records counted by the head */
+        AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(data_buf, "data"));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(data_tree, 0));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_head(
+                                data_tree, 0, AUSHAPE_MSGPACK_TYPE_MAP));
+        data_node_index = aushape_gbtree_get_node_num(event_tree);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 2, data_tree));
+
+        /* Begin and attach normalization node, if requested */
+        if (buf->format.with_norm) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(norm_buf, "norm"));
+            AUSHAPE_GUARD(aushape_gbtree_node_add_text(norm_tree, 0));
+            AUSHAPE_GUARD(aushape_gbtree_node_add_head(
+                                norm_tree, 0, AUSHAPE_MSGPACK_TYPE_MAP));
+            AUSHAPE_GUARD(aushape_gbtree_node_add_tree(event_tree, 3,
+                                                       norm_tree));
+        }
     }
 
     l++;
 
-    /* Output raw and parsed records */
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED,
-                       auparse_first_record(au) >= 0);
-    line_num = 0;
-    record_num = 0;
-    error_rc = AUSHAPE_RC_OK;
-    do {
-        /* Add the source text line */
-        line = auparse_get_record_text(au);
-        AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, line != NULL);
+    /* Output source text lines */
+    for (line_num = 0;
+         line_num < aushape_itree_get_node_num(&ir->text);
+         line_num++) {
+        line = aushape_itree_get_node(&ir->text, line_num);
+        assert(line->type == AUSHAPE_ITREE_NODE_TYPE_STR);
         if (buf->format.lang == AUSHAPE_LANG_XML) {
             AUSHAPE_GUARD(aushape_gbuf_space_opening(text_buf, &buf->format, l));
             AUSHAPE_GUARD(aushape_gbuf_add_str(text_buf, "<line>"));
-            AUSHAPE_GUARD(aushape_gbuf_add_str_xml(text_buf, line));
+            AUSHAPE_GUARD(aushape_gbuf_add_buf_xml(
+                    text_buf, aushape_itree_pool_get_str(&ir->pool, line->pos),
+                    line->len));
             AUSHAPE_GUARD(aushape_gbuf_add_str(text_buf, "</line>"));
         } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
             if (line_num > 0) {
@@ -540,31 +854,28 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
             }
             AUSHAPE_GUARD(aushape_gbuf_space_opening(text_buf, &buf->format, l));
             AUSHAPE_GUARD(aushape_gbuf_add_char(text_buf, '"'));
-            AUSHAPE_GUARD(aushape_gbuf_add_str_json(text_buf, line));
+            AUSHAPE_GUARD(aushape_gbuf_add_buf_json(
+                    text_buf, aushape_itree_pool_get_str(&ir->pool, line->pos),
+                    line->len));
             AUSHAPE_GUARD(aushape_gbuf_add_char(text_buf, '"'));
+        } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+            AUSHAPE_GUARD(aushape_gbuf_add_buf_cbor(
+                    text_buf, aushape_itree_pool_get_str(&ir->pool, line->pos),
+                    line->len));
+        } else if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+            AUSHAPE_GUARD(aushape_gbuf_add_buf_msgpack(
+                    text_buf, aushape_itree_pool_get_str(&ir->pool, line->pos),
+                    line->len));
         }
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(text_tree, line_num));
-        line_num++;
-
-        if (error_rc == AUSHAPE_RC_OK) {
-            /* Add the parsed record to the collector */
-            rc = aushape_coll_add(buf->coll, &record_num, l, record_num, au);
-            if (rc != AUSHAPE_RC_OK) {
-                assert(rc != AUSHAPE_RC_INVALID_ARGS);
-                assert(rc != AUSHAPE_RC_INVALID_STATE);
-                error_rc = rc;
-            }
-        }
-    } while(auparse_next_record(au) > 0);
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(text_tree, line->prio));
+    }
 
-    /* Finish the record sequence, if no error has occurred */
+    /* Output collected data, if no error has occurred */
+    record_num = ir->data_num;
+    error_rc = ir->data_rc;
     if (error_rc == AUSHAPE_RC_OK) {
-        rc = aushape_coll_end(buf->coll, &record_num, l, record_num);
-        if (rc != AUSHAPE_RC_OK) {
-            assert(rc != AUSHAPE_RC_INVALID_ARGS);
-            assert(aushape_conv_buf_is_valid(buf));
-            error_rc = rc;
-        }
+        AUSHAPE_GUARD(aushape_conv_buf_add_event_data(buf, l, ir,
+                                                      &list_num));
     }
 
     /* Drop the event if no records were added and no errors occurred */
@@ -575,7 +886,13 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
 
     /* Add normalized data, if requested */
     if (buf->format.with_norm) {
-        AUSHAPE_GUARD(aushape_conv_buf_add_event_norm(buf, l, au));
+        assert(ir->with_norm);
+        rc = ir->norm_rc;
+        if (rc != AUSHAPE_RC_OK) {
+            goto cleanup;
+        }
+        AUSHAPE_GUARD(aushape_conv_buf_add_event_norm(buf, l, ir,
+                                                      &list_num));
     }
 
     l--;
@@ -589,6 +906,8 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
             AUSHAPE_GUARD(aushape_gbuf_space_closing(text_buf, &buf->format, l));
         }
         AUSHAPE_GUARD(aushape_gbuf_add_str(text_buf, "]"));
+    } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(text_buf, AUSHAPE_CBOR_BREAK));
     }
     AUSHAPE_GUARD(aushape_gbtree_node_add_text(text_tree, 0));
 
@@ -604,6 +923,9 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
                                                          &buf->format, l));
             }
             AUSHAPE_GUARD(aushape_gbuf_add_char(data_buf, '}'));
+        } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(data_buf,
+                                                AUSHAPE_CBOR_BREAK));
         }
         AUSHAPE_GUARD(aushape_gbtree_node_add_text(data_tree, 0));
     }
@@ -620,6 +942,9 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
                                                          &buf->format, l));
             }
             AUSHAPE_GUARD(aushape_gbuf_add_str(norm_buf, "}"));
+        } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(norm_buf,
+                                                AUSHAPE_CBOR_BREAK));
         }
         AUSHAPE_GUARD(aushape_gbtree_node_add_text(norm_tree, 0));
     }
@@ -638,10 +963,20 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
             AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, ','));
             AUSHAPE_GUARD(aushape_gbuf_space_opening(event_buf,
                                                      &buf->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, "\"error\":\""));
+            AUSHAPE_GUARD(aushape_key_dict_add_json(event_buf, &buf->format,
+                                                    "error", false));
+            AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, ":\""));
             AUSHAPE_GUARD(aushape_gbuf_add_str_json(
                                     event_buf, aushape_rc_to_desc(error_rc)));
             AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, '"'));
+        } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(event_buf, "error"));
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(
+                                    event_buf, aushape_rc_to_desc(error_rc)));
+        } else if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(event_buf, "error"));
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(
+                                    event_buf, aushape_rc_to_desc(error_rc)));
         }
         AUSHAPE_GUARD(aushape_gbtree_node_put_text(event_tree,
                                                    error_node_index, 0));
@@ -653,9 +988,11 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
     if (buf->format.lang == AUSHAPE_LANG_XML) {
         AUSHAPE_GUARD(aushape_gbuf_space_closing(event_buf, &buf->format, l));
         AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, "</event>"));
-    } else {
+    } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
         AUSHAPE_GUARD(aushape_gbuf_space_closing(event_buf, &buf->format, l));
         AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, '}'));
+    } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, AUSHAPE_CBOR_BREAK));
     }
     AUSHAPE_GUARD(aushape_gbtree_node_add_text(event_tree, 0));
 
@@ -681,7 +1018,17 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
             AUSHAPE_GUARD(aushape_gbuf_add_char(event_buf, ','));
             AUSHAPE_GUARD(aushape_gbuf_space_opening(event_buf,
                                                      &buf->format, level + 1));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, "\"trimmed\":[]"));
+            AUSHAPE_GUARD(aushape_key_dict_add_json(event_buf, &buf->format,
+                                                    "trimmed", false));
+            AUSHAPE_GUARD(aushape_gbuf_add_str(event_buf, ":[]"));
+        } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(event_buf, "trimmed"));
+            AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(
+                                    event_buf, AUSHAPE_CBOR_MAJOR_ARRAY, 0));
+        } else if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(event_buf, "trimmed"));
+            AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(
+                                    event_buf, AUSHAPE_MSGPACK_TYPE_ARRAY, 0));
         }
         AUSHAPE_GUARD(aushape_gbtree_node_put_text(event_tree,
                                                    trimmed_node_index, 0));
@@ -692,18 +1039,32 @@ aushape_conv_buf_add_event(struct aushape_conv_buf *buf,
         assert(trimmed_len <= buf->format.max_event_size);
     }
 
-    /* Render the event */
-    AUSHAPE_GUARD(aushape_gbtree_render(event_tree, &buf->gbuf));
+    /* Render the event, holding MessagePack document events back */
+    if (buf->format.lang == AUSHAPE_LANG_MSGPACK &&
+        buf->format.events_per_doc != 0) {
+        AUSHAPE_GUARD_BOOL(NOMEM, buf->doc_event_num < UINT32_MAX);
+        AUSHAPE_GUARD(aushape_gbtree_render(event_tree, &buf->doc));
+        buf->doc_event_num++;
+    } else {
+        AUSHAPE_GUARD(aushape_gbtree_render(event_tree, &buf->gbuf));
+    }
+    if (buf->format.ndjson) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(&buf->gbuf, '\n'));
+    }
 
     assert(l == level);
     *padded = true;
     rc = AUSHAPE_RC_OK;
 cleanup:
-    aushape_coll_empty(buf->coll);
+    while (list_num > 0) {
+        aushape_gbtree_empty(*(struct aushape_gbtree **)
+                                aushape_garr_get(&buf->lists, --list_num));
+    }
     aushape_gbtree_empty(event_tree);
     aushape_gbtree_empty(text_tree);
     aushape_gbtree_empty(data_tree);
     aushape_gbtree_empty(norm_tree);
+    aushape_conv_buf_account_event(buf, len);
     assert(aushape_conv_buf_is_valid(buf));
     return rc;
 }
@@ -715,7 +1076,9 @@ aushape_conv_buf_add_prologue(struct aushape_conv_buf *buf)
     assert(aushape_conv_buf_is_valid(buf));
 
     AUSHAPE_GUARD(aushape_gbuf_space_opening(&buf->gbuf, &buf->format, 0));
-    if (buf->format.lang == AUSHAPE_LANG_XML) {
+    if (buf->format.lang == AUSHAPE_LANG_ARROW) {
+        AUSHAPE_GUARD(aushape_arrow_write_schema(&buf->arrow, &buf->gbuf));
+    } else if (buf->format.lang == AUSHAPE_LANG_XML) {
         AUSHAPE_GUARD(
             aushape_gbuf_add_str(
                 &buf->gbuf,
@@ -729,6 +1092,17 @@ aushape_conv_buf_add_prologue(struct aushape_conv_buf *buf)
         AUSHAPE_GUARD(aushape_gbuf_add_str(&buf->gbuf, "<log>"));
     } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
         AUSHAPE_GUARD(aushape_gbuf_add_char(&buf->gbuf, '['));
+        /* Identify the dictionary the compact keys are from */
+        if (buf->format.compact_keys) {
+            AUSHAPE_GUARD(aushape_gbuf_space_opening(&buf->gbuf,
+                                                     &buf->format, 1));
+            AUSHAPE_GUARD(aushape_gbuf_add_fmt(&buf->gbuf, "\"%s%s\"",
+                                               AUSHAPE_KEY_DICT_MAGIC,
+                                               aushape_key_dict_version));
+        }
+    } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(&buf->gbuf,
+                                                  AUSHAPE_CBOR_MAJOR_ARRAY));
     }
 
     rc = AUSHAPE_RC_OK;
@@ -744,10 +1118,23 @@ aushape_conv_buf_add_epilogue(struct aushape_conv_buf *buf)
     assert(aushape_conv_buf_is_valid(buf));
 
     AUSHAPE_GUARD(aushape_gbuf_space_closing(&buf->gbuf, &buf->format, 0));
-    if (buf->format.lang == AUSHAPE_LANG_XML) {
+    if (buf->format.lang == AUSHAPE_LANG_ARROW) {
+        AUSHAPE_GUARD(aushape_arrow_write_batch(&buf->arrow, &buf->gbuf));
+    } else if (buf->format.lang == AUSHAPE_LANG_XML) {
         AUSHAPE_GUARD(aushape_gbuf_add_str(&buf->gbuf, "</log>"));
     } else if (buf->format.lang == AUSHAPE_LANG_JSON) {
         AUSHAPE_GUARD(aushape_gbuf_add_char(&buf->gbuf, ']'));
+    } else if (buf->format.lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(&buf->gbuf, AUSHAPE_CBOR_BREAK));
+    } else if (buf->format.lang == AUSHAPE_LANG_MSGPACK) {
+        /* Output the document array, now that the number of events is known */
+        AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(
+                                &buf->gbuf, AUSHAPE_MSGPACK_TYPE_ARRAY,
+                                buf->doc_event_num));
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(&buf->gbuf,
+                                           buf->doc.ptr, buf->doc.len));
+        aushape_gbuf_empty(&buf->doc);
+        buf->doc_event_num = 0;
     }
 
     rc = AUSHAPE_RC_OK;
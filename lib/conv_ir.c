@@ -0,0 +1,580 @@
+/*
+ * An aushape converter intermediate event representation
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/conv_ir.h>
+#include <aushape/auparse.h>
+#include <aushape/disp_coll.h>
+#include <aushape/drop_coll.h>
+#include <aushape/uniq_coll.h>
+#include <aushape/execve_coll.h>
+#include <aushape/path_coll.h>
+#include <aushape/rep_coll.h>
+#include <aushape/field.h>
+#include <aushape/guard.h>
+#include <aushape/misc.h>
+#include <stdio.h>
+#include <string.h>
+
+bool
+aushape_conv_ir_is_valid(const struct aushape_conv_ir *ir)
+{
+    return ir != NULL &&
+           aushape_itree_pool_is_valid(&ir->pool) &&
+           aushape_itree_is_valid(&ir->text) &&
+           aushape_itree_is_valid(&ir->records) &&
+           aushape_itree_is_valid(&ir->data) &&
+           aushape_itree_is_valid(&ir->norm) &&
+           aushape_itree_is_valid(&ir->norm_items) &&
+           aushape_coll_is_valid(ir->coll) &&
+           (ir->node == AUSHAPE_ITREE_POS_NONE ||
+            ir->node < ir->pool.text.len);
+}
+
+enum aushape_rc
+aushape_conv_ir_init(struct aushape_conv_ir *ir,
+                     const struct aushape_mem *mem)
+{
+    static const struct aushape_rep_coll_args obj_pid_args = {
+        .name = "obj_pid",
+    };
+    static const struct aushape_rep_coll_args avc_args = {
+        .name = "avc",
+    };
+    static const struct aushape_rep_coll_args netfilter_cfg_args = {
+        .name = "netfilter_cfg",
+    };
+    static const struct aushape_disp_coll_type_link map[] = {
+        {
+            .name   = "EXECVE",
+            .type   = &aushape_execve_coll_type,
+            .args   = NULL,
+        },
+        {
+            .name   = "PATH",
+            .type   = &aushape_path_coll_type,
+            .args   = NULL,
+        },
+        {
+            .name   = "OBJ_PID",
+            .type   = &aushape_rep_coll_type,
+            .args   = &obj_pid_args,
+        },
+        {
+            .name   = "AVC",
+            .type   = &aushape_rep_coll_type,
+            .args   = &avc_args,
+        },
+        {
+            .name   = "NETFILTER_CFG",
+            .type   = &aushape_rep_coll_type,
+            .args   = &netfilter_cfg_args,
+        },
+        {
+            .name   = "EOE",
+            .type   = &aushape_drop_coll_type,
+            .args   = NULL,
+        },
+        {
+            .name   = NULL,
+            .type   = &aushape_uniq_coll_type,
+            .args   = NULL,
+        },
+    };
+
+    enum aushape_rc rc;
+
+    if (ir == NULL || !aushape_mem_is_valid(mem)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    memset(ir, 0, sizeof(*ir));
+    aushape_itree_pool_init(&ir->pool, mem);
+    aushape_itree_init(&ir->text, &ir->pool, 8);
+    aushape_itree_init(&ir->records, &ir->pool, 32);
+    aushape_itree_init(&ir->data, &ir->pool, 32);
+    aushape_itree_init(&ir->norm, &ir->pool, 16);
+    aushape_itree_init(&ir->norm_items, &ir->pool, 8);
+    ir->node = AUSHAPE_ITREE_POS_NONE;
+    rc = aushape_coll_create(&ir->coll, &aushape_disp_coll_type,
+                             &ir->data, &map);
+    if (rc != AUSHAPE_RC_OK) {
+        assert(rc != AUSHAPE_RC_INVALID_ARGS);
+        aushape_itree_cleanup(&ir->norm_items);
+        aushape_itree_cleanup(&ir->norm);
+        aushape_itree_cleanup(&ir->data);
+        aushape_itree_cleanup(&ir->records);
+        aushape_itree_cleanup(&ir->text);
+        aushape_itree_pool_cleanup(&ir->pool);
+        return rc;
+    }
+    assert(aushape_conv_ir_is_valid(ir));
+    return AUSHAPE_RC_OK;
+}
+
+void
+aushape_conv_ir_cleanup(struct aushape_conv_ir *ir)
+{
+    assert(aushape_conv_ir_is_valid(ir));
+    aushape_coll_destroy(ir->coll);
+    aushape_itree_cleanup(&ir->norm_items);
+    aushape_itree_cleanup(&ir->norm);
+    aushape_itree_cleanup(&ir->data);
+    aushape_itree_cleanup(&ir->records);
+    aushape_itree_cleanup(&ir->text);
+    aushape_itree_pool_cleanup(&ir->pool);
+    memset(ir, 0, sizeof(*ir));
+}
+
+void
+aushape_conv_ir_empty(struct aushape_conv_ir *ir)
+{
+    assert(aushape_conv_ir_is_valid(ir));
+    aushape_coll_empty(ir->coll);
+    aushape_itree_empty(&ir->norm_items);
+    aushape_itree_empty(&ir->norm);
+    aushape_itree_empty(&ir->data);
+    aushape_itree_empty(&ir->records);
+    aushape_itree_empty(&ir->text);
+    aushape_itree_pool_empty(&ir->pool);
+    ir->serial = 0;
+    ir->sec = 0;
+    ir->milli = 0;
+    ir->time[0] = '\0';
+    ir->node = AUSHAPE_ITREE_POS_NONE;
+    ir->records_rc = AUSHAPE_RC_OK;
+    ir->data_num = 0;
+    ir->data_rc = AUSHAPE_RC_OK;
+    ir->with_norm = false;
+    ir->norm_rc = AUSHAPE_RC_OK;
+    assert(aushape_conv_ir_is_valid(ir));
+}
+
+void
+aushape_conv_ir_shrink(struct aushape_conv_ir *ir)
+{
+    assert(aushape_conv_ir_is_valid(ir));
+    aushape_itree_pool_shrink(&ir->pool);
+    aushape_itree_shrink(&ir->text);
+    aushape_itree_shrink(&ir->records);
+    aushape_itree_shrink(&ir->data);
+    aushape_itree_shrink(&ir->norm);
+    aushape_itree_shrink(&ir->norm_items);
+    aushape_coll_shrink(ir->coll);
+    assert(aushape_conv_ir_is_valid(ir));
+}
+
+void
+aushape_conv_ir_get_mem_usage(const struct aushape_conv_ir *ir,
+                              struct aushape_mem_usage *usage)
+{
+    assert(aushape_conv_ir_is_valid(ir));
+    assert(usage != NULL);
+    aushape_itree_pool_get_mem_usage(&ir->pool, usage);
+    aushape_itree_get_mem_usage(&ir->text, usage);
+    aushape_itree_get_mem_usage(&ir->records, usage);
+    aushape_itree_get_mem_usage(&ir->data, usage);
+    aushape_itree_get_mem_usage(&ir->norm, usage);
+    aushape_itree_get_mem_usage(&ir->norm_items, usage);
+    aushape_coll_get_mem_usage(ir->coll, usage);
+}
+
+/**
+ * Add the current auparse record to the parsed records of an intermediate
+ * event representation.
+ *
+ * @param ir    The representation to add the record to.
+ * @param au    The auparse state with the current record as the one to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - added successfully,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed,
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ */
+static enum aushape_rc
+aushape_conv_ir_add_record(struct aushape_conv_ir *ir, auparse_state_t *au)
+{
+    enum aushape_rc rc;
+    struct aushape_itree_node node = {
+        .type       = AUSHAPE_ITREE_NODE_TYPE_RECORD,
+        .item_name  = AUSHAPE_ITREE_POS_NONE,
+    };
+    const char *str;
+
+    assert(aushape_conv_ir_is_valid(ir));
+    assert(au != NULL);
+
+    node.prio = aushape_itree_get_node_num(&ir->records);
+    str = aushape_auparse_get_type_name(au);
+    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, str != NULL);
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(&ir->pool, str, &node.name));
+    node.record_type = auparse_get_type(au);
+    node.pos = aushape_itree_pool_get_field_num(&ir->pool);
+
+    if (auparse_first_field(au)) {
+        do {
+            str = auparse_get_field_name(au);
+            AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, str != NULL);
+            /* Skip the type, and the node handled at event level */
+            if (strcmp(str, "type") == 0 || strcmp(str, "node") == 0) {
+                continue;
+            }
+            AUSHAPE_GUARD(aushape_field_add_to_pool(
+                                            &ir->pool, str,
+                                            aushape_field_get_kind(au), au));
+            node.len++;
+        } while (auparse_next_field(au) > 0);
+    }
+
+    AUSHAPE_GUARD(aushape_itree_node_add(&ir->records, &node));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Collect the parsed records of an intermediate event representation into
+ * its data, recording the failure, if any.
+ *
+ * @param ir    The representation to collect the records of.
+ */
+static void
+aushape_conv_ir_collect(struct aushape_conv_ir *ir)
+{
+    enum aushape_rc rc = AUSHAPE_RC_OK;
+    size_t i;
+
+    assert(aushape_conv_ir_is_valid(ir));
+
+    for (i = 0; i < aushape_itree_get_node_num(&ir->records); i++) {
+        rc = aushape_coll_add(ir->coll, &ir->data_num, ir->data_num,
+                              aushape_itree_get_node(&ir->records, i));
+        if (rc != AUSHAPE_RC_OK) {
+            assert(rc != AUSHAPE_RC_INVALID_ARGS);
+            assert(rc != AUSHAPE_RC_INVALID_STATE);
+            break;
+        }
+    }
+
+    /* The record which failed to parse would be collected next */
+    if (rc == AUSHAPE_RC_OK) {
+        rc = ir->records_rc;
+    }
+
+    /* Finish the record sequence, if no error has occurred */
+    if (rc == AUSHAPE_RC_OK) {
+        rc = aushape_coll_end(ir->coll, &ir->data_num, ir->data_num);
+        assert(rc != AUSHAPE_RC_INVALID_ARGS);
+    }
+
+    ir->data_rc = rc;
+}
+
+/** Normalized field type */
+enum aushape_conv_ir_norm_type {
+    /** Metadata field */
+    AUSHAPE_CONV_IR_NORM_TYPE_META,
+    /** Positioning field */
+    AUSHAPE_CONV_IR_NORM_TYPE_POS,
+    /** Position listing field */
+    AUSHAPE_CONV_IR_NORM_TYPE_POS_LIST,
+};
+
+/** Description of a normalized field */
+struct aushape_conv_ir_norm_field {
+    /** Field name */
+    const char                         *name;
+    /** Field type */
+    enum aushape_conv_ir_norm_type      type;
+    /** Field item name for position listing fields */
+    const char                         *item_name;
+    /** Value extraсtion function for metadata fields */
+    const char *(*fn_meta)(auparse_state_t *au);
+    /** Cursor position function for positioning fields */
+    int (*fn_pos)(auparse_state_t *au);
+    /** Iteration beginning function for position listing fields */
+    int (*fn_pos_list_first)(auparse_state_t *au);
+    /** Iteration continuation function for position listing fields */
+    int (*fn_pos_list_next)(auparse_state_t *au);
+};
+
+/**
+ * Add a field node with the current auparse field's values to an
+ * intermediate tree.
+ *
+ * @param itree The tree to add the node to.
+ * @param prio  Priority of the node.
+ * @param name  Name of the field.
+ * @param au    The auparse state with the current field as the one to add.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - added successfully,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed,
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ */
+static enum aushape_rc
+aushape_conv_ir_add_norm_pos(struct aushape_itree *itree,
+                             size_t prio,
+                             const char *name,
+                             auparse_state_t *au)
+{
+    enum aushape_rc rc;
+    struct aushape_itree_node node = {
+        .type       = AUSHAPE_ITREE_NODE_TYPE_FIELD,
+        .prio       = prio,
+        .name       = AUSHAPE_ITREE_POS_NONE,
+        .item_name  = AUSHAPE_ITREE_POS_NONE,
+        .len        = 1,
+    };
+
+    node.pos = aushape_itree_pool_get_field_num(itree->pool);
+    AUSHAPE_GUARD(aushape_field_add_to_pool(itree->pool, name,
+                                            AUSHAPE_FIELD_KIND_STR, au));
+    AUSHAPE_GUARD(aushape_itree_node_add(itree, &node));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Build the normalized data of an intermediate event representation.
+ *
+ * @param ir    The representation to build the normalized data of.
+ * @param au    The auparse state with the current event as the event which
+ *              normalized data should be built.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK               - built successfully,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed,
+ *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed.
+ */
+static enum aushape_rc
+aushape_conv_ir_add_norm(struct aushape_conv_ir *ir, auparse_state_t *au)
+{
+    static const struct aushape_conv_ir_norm_field field_list[] = {
+#define FIELD_META(_name_tkn, _fn) \
+        {.name = #_name_tkn,                        \
+         .type = AUSHAPE_CONV_IR_NORM_TYPE_META,    \
+         .fn_meta = _fn}
+#define FIELD_POS(_name_tkn, _fn) \
+        {.name = #_name_tkn,                        \
+         .type = AUSHAPE_CONV_IR_NORM_TYPE_POS,     \
+         .fn_pos = _fn}
+#define FIELD_POS_LIST(_name_tkn, _item_name_tkn, _fn_first, _fn_next) \
+        {.name = #_name_tkn,                                            \
+         .item_name = #_item_name_tkn,                                  \
+         .type = AUSHAPE_CONV_IR_NORM_TYPE_POS_LIST,                    \
+         .fn_pos_list_first = _fn_first,                                \
+         .fn_pos_list_next = _fn_next}
+
+        FIELD_META(event_kind,          auparse_normalize_get_event_kind),
+
+        FIELD_POS(session,              auparse_normalize_session),
+
+        FIELD_META(subject_kind,        auparse_normalize_subject_kind),
+        FIELD_POS(subject_primary,      auparse_normalize_subject_primary),
+        FIELD_POS(subject_secondary,    auparse_normalize_subject_secondary),
+        FIELD_POS_LIST(subject_attrs, attr,
+                                    auparse_normalize_subject_first_attribute,
+                                    auparse_normalize_subject_next_attribute),
+
+        FIELD_META(action,              auparse_normalize_get_action),
+
+        FIELD_META(object_kind,         auparse_normalize_object_kind),
+        FIELD_POS(object_primary,       auparse_normalize_object_primary),
+        FIELD_POS(object_secondary,     auparse_normalize_object_secondary),
+        FIELD_POS(object_primary2,      auparse_normalize_object_primary2),
+        FIELD_POS_LIST(object_attrs, attr,
+                                    auparse_normalize_object_first_attribute,
+                                    auparse_normalize_object_next_attribute),
+
+        FIELD_POS(result,               auparse_normalize_get_results),
+
+        FIELD_META(how,                 auparse_normalize_how),
+
+        FIELD_POS(key,                  auparse_normalize_key),
+
+#undef FIELD_POS_LIST
+#undef FIELD_POS
+#undef FIELD_META
+    };
+
+    struct aushape_itree_pool *pool = &ir->pool;
+    struct aushape_itree_field meta;
+    struct aushape_itree_node node;
+    size_t prio;
+    enum aushape_rc rc;
+    size_t i;
+    size_t j;
+    int auparse_rc;
+    const char *str;
+
+    assert(aushape_conv_ir_is_valid(ir));
+    assert(au != NULL);
+
+    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED,
+                       auparse_normalize(au, NORM_OPT_ALL) == 0);
+
+    prio = 1;
+    for (i = 0; i < AUSHAPE_ARRAY_SIZE(field_list); i++) {
+        const struct aushape_conv_ir_norm_field *field = &field_list[i];
+
+        memset(&node, 0, sizeof(node));
+        node.prio = prio;
+        node.name = AUSHAPE_ITREE_POS_NONE;
+        node.item_name = AUSHAPE_ITREE_POS_NONE;
+
+        switch (field->type) {
+        case AUSHAPE_CONV_IR_NORM_TYPE_META:
+            str = field->fn_meta(au);
+            if (str != NULL) {
+                memset(&meta, 0, sizeof(meta));
+                meta.kind = AUSHAPE_FIELD_KIND_STR;
+                AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, field->name,
+                                                         &meta.name));
+                AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, str,
+                                                         &meta.value_i));
+                meta.value_r = meta.value_i;
+                node.type = AUSHAPE_ITREE_NODE_TYPE_FIELD;
+                node.pos = aushape_itree_pool_get_field_num(pool);
+                node.len = 1;
+                AUSHAPE_GUARD(aushape_itree_pool_add_field(pool, &meta));
+                AUSHAPE_GUARD(aushape_itree_node_add(&ir->norm, &node));
+                prio++;
+            }
+            break;
+        case AUSHAPE_CONV_IR_NORM_TYPE_POS:
+            auparse_rc = field->fn_pos(au);
+            AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, auparse_rc >= 0);
+            if (auparse_rc == 1) {
+                AUSHAPE_GUARD(aushape_conv_ir_add_norm_pos(&ir->norm, prio,
+                                                           field->name, au));
+                prio++;
+            }
+            break;
+        case AUSHAPE_CONV_IR_NORM_TYPE_POS_LIST:
+            auparse_rc = field->fn_pos_list_first(au);
+            AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, auparse_rc >= 0);
+            if (auparse_rc != 1) {
+                break;
+            }
+
+            /* Add list items, with priorities relative to the list */
+            node.pos = aushape_itree_get_node_num(&ir->norm_items);
+            j = 0;
+            do {
+                AUSHAPE_GUARD(aushape_conv_ir_add_norm_pos(&ir->norm_items,
+                                                           j,
+                                                           field->item_name,
+                                                           au));
+                j++;
+                auparse_rc = field->fn_pos_list_next(au);
+                AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, auparse_rc >= 0);
+            } while (auparse_rc == 1);
+
+            /* Add the list */
+            node.type = AUSHAPE_ITREE_NODE_TYPE_LIST;
+            node.len = j;
+            node.tree = &ir->norm_items;
+            AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, field->name,
+                                                     &node.name));
+            AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, field->item_name,
+                                                     &node.item_name));
+            AUSHAPE_GUARD(aushape_itree_node_add(&ir->norm, &node));
+            prio += j;
+            break;
+        default:
+            break;
+        }
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_conv_ir_build(struct aushape_conv_ir *ir,
+                      bool with_norm,
+                      auparse_state_t *au)
+{
+    enum aushape_rc rc;
+    const au_event_t *e;
+    struct tm *tm;
+    char time_buf[32];
+    char zone_buf[16];
+    struct aushape_itree_node line = {
+        .type       = AUSHAPE_ITREE_NODE_TYPE_STR,
+        .name       = AUSHAPE_ITREE_POS_NONE,
+        .item_name  = AUSHAPE_ITREE_POS_NONE,
+    };
+    const char *str;
+
+    assert(aushape_conv_ir_is_valid(ir));
+    assert(au != NULL);
+
+    aushape_conv_ir_empty(ir);
+
+    e = auparse_get_timestamp(au);
+    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, e != NULL);
+    ir->serial = e->serial;
+    ir->sec = e->sec;
+    ir->milli = e->milli;
+
+    /* Format timestamp */
+    tm = localtime(&e->sec);
+    strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%S", tm);
+    strftime(zone_buf, sizeof(zone_buf), "%z", tm);
+    snprintf(ir->time, sizeof(ir->time), "%s.%03u%.3s:%s",
+             time_buf, e->milli, zone_buf, zone_buf + 3);
+
+    if (e->host != NULL) {
+        AUSHAPE_GUARD(aushape_itree_pool_add_str(&ir->pool, e->host,
+                                                 &ir->node));
+    }
+
+    /* Add source text lines and parsed records */
+    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, auparse_first_record(au) >= 0);
+    do {
+        str = auparse_get_record_text(au);
+        AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, str != NULL);
+        line.len = strlen(str);
+        AUSHAPE_GUARD(aushape_itree_pool_add_buf(&ir->pool, str, line.len,
+                                                 &line.pos));
+        AUSHAPE_GUARD(aushape_itree_node_add(&ir->text, &line));
+        line.prio++;
+
+        if (ir->records_rc == AUSHAPE_RC_OK) {
+            ir->records_rc = aushape_conv_ir_add_record(ir, au);
+        }
+    } while(auparse_next_record(au) > 0);
+
+    /* Collect the records into data */
+    aushape_conv_ir_collect(ir);
+
+    /* Add normalized data, if requested, and the event is not dropped */
+    if (with_norm && !aushape_conv_ir_is_dropped(ir)) {
+        ir->norm_rc = aushape_conv_ir_add_norm(ir, au);
+        ir->with_norm = true;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    assert(aushape_conv_ir_is_valid(ir));
+    return rc;
+}
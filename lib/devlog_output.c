@@ -0,0 +1,577 @@
+/*
+ * Native syslog discrete aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/devlog_output.h>
+#include <aushape/guard.h>
+#include <aushape/flusher.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Maximum length of a message header, bytes */
+#define AUSHAPE_DEVLOG_OUTPUT_HDR_MAX   512
+
+/** Native syslog output data */
+struct aushape_devlog_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    struct sockaddr_un addr;        /**< Syslog socket address */
+    int fd;                         /**< Connected socket, or -1 */
+    char *ident;                    /**< Header identifier */
+    int pri;                        /**< Header priority value */
+    /** Header format */
+    enum aushape_devlog_output_format format;
+    pid_t pid;                      /**< Header process ID */
+    char host[256];                 /**< Header host name */
+    /** Header for the current second */
+    char hdr[AUSHAPE_DEVLOG_OUTPUT_HDR_MAX];
+    size_t hdr_len;                 /**< Length of the header */
+    time_t hdr_sec;                 /**< Second the header is for, or -1 */
+    size_t batch_size;              /**< Number of messages in a batch */
+    size_t queue_size;              /**< Maximum size of queued messages */
+    char *buf;                      /**< Buffer of queued messages */
+    size_t buf_alloc;               /**< Allocated size of the buffer */
+    size_t buf_head;                /**< Offset of the first message */
+    size_t buf_len;                 /**< Length of the buffer used */
+    /** Offsets of message ends in the buffer, ascending */
+    size_t *ends;
+    size_t ends_head;               /**< Index of the first message end */
+    size_t ends_num;                /**< Number of message ends used */
+    size_t ends_alloc;              /**< Allocated number of message ends */
+    /** Message headers for sending a batch, batch_size long */
+    struct mmsghdr *msgs;
+    /** Message pieces for sending a batch, batch_size long */
+    struct iovec *iovs;
+    unsigned int max_latency;       /**< Max queueing time, ms, or zero */
+    /** Monotonic time the oldest queued message was last tried at */
+    struct timespec queue_time;
+    /** Statistics */
+    struct aushape_devlog_output_stats stats;
+    /** Flusher sending the queue after the maximum latency */
+    struct aushape_flusher flusher;
+};
+
+/**
+ * Format the message header of a native syslog output for the current
+ * second, if it isn't formatted already.
+ *
+ * @param devlog_output The native syslog output to format the header for.
+ */
+static void
+aushape_devlog_output_format_hdr(struct aushape_devlog_output *devlog_output)
+{
+    static const char *month_list[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+    time_t sec = time(NULL);
+    struct tm tm;
+    int len;
+
+    assert(devlog_output != NULL);
+
+    if (sec == devlog_output->hdr_sec) {
+        return;
+    }
+
+    if (devlog_output->format == AUSHAPE_DEVLOG_OUTPUT_FORMAT_RFC3164) {
+        /* The same header syslog(3) produces, in the C locale */
+        localtime_r(&sec, &tm);
+        len = snprintf(devlog_output->hdr, sizeof(devlog_output->hdr),
+                       "<%d>%s %2d %02d:%02d:%02d %s: ",
+                       devlog_output->pri, month_list[tm.tm_mon],
+                       tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                       devlog_output->ident);
+    } else {
+        gmtime_r(&sec, &tm);
+        len = snprintf(devlog_output->hdr, sizeof(devlog_output->hdr),
+                       "<%d>1 %04d-%02d-%02dT%02d:%02d:%02dZ %s %s %d - - ",
+                       devlog_output->pri,
+                       tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                       tm.tm_hour, tm.tm_min, tm.tm_sec,
+                       devlog_output->host, devlog_output->ident,
+                       (int)devlog_output->pid);
+    }
+    devlog_output->hdr_len = (len < 0) ? 0 :
+                             ((size_t)len >= sizeof(devlog_output->hdr)
+                                ? sizeof(devlog_output->hdr) - 1
+                                : (size_t)len);
+    devlog_output->hdr_sec = sec;
+}
+
+/**
+ * Remove a number of messages from the front of the queue of a native
+ * syslog output.
+ *
+ * @param devlog_output The native syslog output to remove messages from.
+ * @param num           The number of messages to remove.
+ */
+static void
+aushape_devlog_output_remove(struct aushape_devlog_output *devlog_output,
+                             size_t num)
+{
+    assert(devlog_output != NULL);
+    assert(num <= devlog_output->ends_num - devlog_output->ends_head);
+
+    if (num == 0) {
+        return;
+    }
+    devlog_output->ends_head += num;
+    if (devlog_output->ends_head == devlog_output->ends_num) {
+        devlog_output->ends_head = 0;
+        devlog_output->ends_num = 0;
+        devlog_output->buf_head = 0;
+        devlog_output->buf_len = 0;
+    } else {
+        devlog_output->buf_head =
+            devlog_output->ends[devlog_output->ends_head - 1];
+    }
+}
+
+/**
+ * Try to send queued messages of a native syslog output, without
+ * blocking, connecting the socket, if necessary.
+ *
+ * @param devlog_output The native syslog output to send messages of.
+ *
+ * @return True if the queue was sent completely, false otherwise.
+ */
+static bool
+aushape_devlog_output_send(struct aushape_devlog_output *devlog_output)
+{
+    bool reconnected = false;
+    size_t start;
+    size_t num;
+    int rc;
+
+    assert(devlog_output != NULL);
+
+    while (devlog_output->ends_head < devlog_output->ends_num) {
+        /* Connect, if not connected */
+        if (devlog_output->fd < 0) {
+            devlog_output->fd = socket(AF_UNIX,
+                                       SOCK_DGRAM | SOCK_NONBLOCK |
+                                       SOCK_CLOEXEC, 0);
+            if (devlog_output->fd < 0) {
+                return false;
+            }
+            if (connect(devlog_output->fd,
+                        (struct sockaddr *)&devlog_output->addr,
+                        sizeof(devlog_output->addr)) < 0) {
+                close(devlog_output->fd);
+                devlog_output->fd = -1;
+                return false;
+            }
+            reconnected = true;
+        }
+
+        /* Describe a batch */
+        start = devlog_output->buf_head;
+        for (num = 0; num < devlog_output->batch_size &&
+                      devlog_output->ends_head + num <
+                        devlog_output->ends_num; num++) {
+            size_t end = devlog_output->ends[devlog_output->ends_head + num];
+            devlog_output->iovs[num].iov_base = devlog_output->buf + start;
+            devlog_output->iovs[num].iov_len = end - start;
+            memset(&devlog_output->msgs[num], 0,
+                   sizeof(devlog_output->msgs[num]));
+            devlog_output->msgs[num].msg_hdr.msg_iov =
+                                            &devlog_output->iovs[num];
+            devlog_output->msgs[num].msg_hdr.msg_iovlen = 1;
+            start = end;
+        }
+
+        rc = sendmmsg(devlog_output->fd, devlog_output->msgs,
+                      (unsigned int)num, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (rc >= 0) {
+            devlog_output->stats.batches++;
+            devlog_output->stats.sent += (size_t)rc;
+            aushape_devlog_output_remove(devlog_output, (size_t)rc);
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK ||
+                   errno == ENOBUFS) {
+            devlog_output->stats.full++;
+            return false;
+        } else if (errno == EMSGSIZE) {
+            /* The message can never be sent */
+            devlog_output->stats.dropped++;
+            aushape_devlog_output_remove(devlog_output, 1);
+        } else {
+            /* The daemon might have restarted, reconnect once */
+            close(devlog_output->fd);
+            devlog_output->fd = -1;
+            if (reconnected) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Send the queue of a native syslog output, waiting for the socket for a
+ * limited time, if it can't accept more messages, or is missing.
+ *
+ * @param devlog_output The native syslog output to drain the queue of.
+ */
+static void
+aushape_devlog_output_drain(struct aushape_devlog_output *devlog_output)
+{
+    struct timespec deadline;
+    struct timespec delay;
+    struct pollfd pfd;
+    int left;
+
+    assert(devlog_output != NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    aushape_flusher_time_add(&deadline, AUSHAPE_DEVLOG_OUTPUT_DRAIN_TIMEOUT);
+    while (!aushape_devlog_output_send(devlog_output) &&
+           (left = aushape_flusher_time_left(&deadline)) > 0) {
+        if (devlog_output->fd >= 0) {
+            pfd.fd = devlog_output->fd;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, left);
+        } else {
+            /* Wait for the socket to appear */
+            left = left < 100 ? left : 100;
+            delay.tv_sec = 0;
+            delay.tv_nsec = (long)left * 1000000;
+            nanosleep(&delay, NULL);
+        }
+    }
+}
+
+/**
+ * Get the time a native syslog output's queue is due to be sent at by the
+ * flusher: once the oldest message waits for the maximum latency.
+ *
+ * @param data      The native syslog output to get the flush time of.
+ * @param pdeadline Location for the flush time.
+ *
+ * @return True if a flush is pending, false otherwise.
+ */
+static bool
+aushape_devlog_output_flusher_due(void *data, struct timespec *pdeadline)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)data;
+
+    assert(devlog_output != NULL);
+    assert(pdeadline != NULL);
+
+    if (devlog_output->ends_head == devlog_output->ends_num) {
+        return false;
+    }
+    *pdeadline = devlog_output->queue_time;
+    aushape_flusher_time_add(pdeadline, devlog_output->max_latency);
+    return true;
+}
+
+/**
+ * Flush a native syslog output from the flusher: try to send the queue,
+ * and retry after another latency period, if it couldn't be sent whole.
+ *
+ * @param data  The native syslog output to flush.
+ * @param now   The current monotonic time.
+ */
+static void
+aushape_devlog_output_flusher_flush(void *data, const struct timespec *now)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)data;
+
+    assert(devlog_output != NULL);
+    assert(now != NULL);
+
+    if (!aushape_devlog_output_send(devlog_output)) {
+        devlog_output->queue_time = *now;
+    }
+}
+
+static void aushape_devlog_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_devlog_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)output;
+    const char *path = va_arg(ap, const char *);
+    const char *ident = va_arg(ap, const char *);
+    int facility = va_arg(ap, int);
+    int priority = va_arg(ap, int);
+    enum aushape_devlog_output_format format =
+                        (enum aushape_devlog_output_format)va_arg(ap, int);
+    size_t batch_size = va_arg(ap, size_t);
+    size_t queue_size = va_arg(ap, size_t);
+    unsigned int max_latency = va_arg(ap, unsigned int);
+    enum aushape_rc rc;
+
+    assert(devlog_output != NULL);
+
+    devlog_output->fd = -1;
+
+    if (path == NULL || ident == NULL ||
+        !aushape_devlog_output_format_is_valid(format) ||
+        batch_size == 0 || queue_size == 0 ||
+        *path == '\0' || strlen(path) >= sizeof(devlog_output->addr.sun_path)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    devlog_output->addr.sun_family = AF_UNIX;
+    strcpy(devlog_output->addr.sun_path, path);
+    devlog_output->pri = LOG_MAKEPRI(LOG_FAC(facility) << 3,
+                                     LOG_PRI(priority));
+    devlog_output->format = format;
+    devlog_output->pid = getpid();
+    if (gethostname(devlog_output->host,
+                    sizeof(devlog_output->host) - 1) < 0 ||
+        devlog_output->host[0] == '\0') {
+        strcpy(devlog_output->host, "-");
+    }
+    devlog_output->hdr_sec = (time_t)-1;
+    devlog_output->batch_size = batch_size;
+    devlog_output->queue_size = queue_size;
+
+    devlog_output->ident = strdup(ident);
+    AUSHAPE_GUARD_BOOL(NOMEM, devlog_output->ident != NULL);
+    devlog_output->buf = malloc(queue_size);
+    AUSHAPE_GUARD_BOOL(NOMEM, devlog_output->buf != NULL);
+    devlog_output->buf_alloc = queue_size;
+    devlog_output->msgs = calloc(batch_size, sizeof(*devlog_output->msgs));
+    AUSHAPE_GUARD_BOOL(NOMEM, devlog_output->msgs != NULL);
+    devlog_output->iovs = calloc(batch_size, sizeof(*devlog_output->iovs));
+    AUSHAPE_GUARD_BOOL(NOMEM, devlog_output->iovs != NULL);
+
+    /* Start the flusher, if the queueing time is limited */
+    if (max_latency > 0) {
+        devlog_output->max_latency = max_latency;
+        AUSHAPE_GUARD(aushape_flusher_start(&devlog_output->flusher,
+                                            aushape_devlog_output_flusher_due,
+                                            aushape_devlog_output_flusher_flush,
+                                            devlog_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_devlog_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_devlog_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)output;
+    assert(devlog_output != NULL);
+
+    return devlog_output->ident != NULL &&
+           aushape_devlog_output_format_is_valid(devlog_output->format) &&
+           devlog_output->batch_size > 0 &&
+           devlog_output->queue_size > 0 &&
+           devlog_output->buf != NULL &&
+           devlog_output->msgs != NULL &&
+           devlog_output->iovs != NULL &&
+           (devlog_output->max_latency == 0 ||
+            aushape_flusher_is_started(&devlog_output->flusher));
+}
+
+static void
+aushape_devlog_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)output;
+    assert(devlog_output != NULL);
+
+    /* Stop the flusher */
+    aushape_flusher_stop(&devlog_output->flusher);
+
+    /* Try to send the remaining messages once more */
+    if (devlog_output->msgs != NULL && devlog_output->iovs != NULL) {
+        aushape_devlog_output_send(devlog_output);
+    }
+    if (devlog_output->fd >= 0) {
+        close(devlog_output->fd);
+        devlog_output->fd = -1;
+    }
+
+    free(devlog_output->iovs);
+    devlog_output->iovs = NULL;
+    free(devlog_output->msgs);
+    devlog_output->msgs = NULL;
+    free(devlog_output->ends);
+    devlog_output->ends = NULL;
+    devlog_output->ends_head = 0;
+    devlog_output->ends_num = 0;
+    devlog_output->ends_alloc = 0;
+    free(devlog_output->buf);
+    devlog_output->buf = NULL;
+    devlog_output->buf_head = 0;
+    devlog_output->buf_len = 0;
+    free(devlog_output->ident);
+    devlog_output->ident = NULL;
+}
+
+static enum aushape_rc
+aushape_devlog_output_write(struct aushape_output *output,
+                            const char *ptr,
+                            size_t len)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)output;
+    size_t msg_len;
+    size_t queued;
+    size_t i;
+    void *new_ptr;
+    enum aushape_rc rc;
+
+    assert(devlog_output != NULL);
+
+    aushape_flusher_lock(&devlog_output->flusher);
+
+    aushape_devlog_output_format_hdr(devlog_output);
+    msg_len = devlog_output->hdr_len + len;
+
+    /* Make room in the queue, or drop the message, if it's full */
+    queued = devlog_output->buf_len - devlog_output->buf_head;
+    if (queued > 0 && queued + msg_len > devlog_output->queue_size) {
+        aushape_devlog_output_send(devlog_output);
+        queued = devlog_output->buf_len - devlog_output->buf_head;
+        if (queued > 0 && queued + msg_len > devlog_output->queue_size) {
+            devlog_output->stats.dropped++;
+            rc = AUSHAPE_RC_OK;
+            goto cleanup;
+        }
+    }
+
+    /* Make room in the buffer */
+    if (msg_len > devlog_output->buf_alloc - devlog_output->buf_len) {
+        memmove(devlog_output->buf,
+                devlog_output->buf + devlog_output->buf_head, queued);
+        for (i = devlog_output->ends_head; i < devlog_output->ends_num; i++) {
+            devlog_output->ends[i - devlog_output->ends_head] =
+                devlog_output->ends[i] - devlog_output->buf_head;
+        }
+        devlog_output->ends_num -= devlog_output->ends_head;
+        devlog_output->ends_head = 0;
+        devlog_output->buf_head = 0;
+        devlog_output->buf_len = queued;
+        /* Fit a single message bigger than the queue */
+        if (msg_len > devlog_output->buf_alloc - queued) {
+            new_ptr = realloc(devlog_output->buf, queued + msg_len);
+            AUSHAPE_GUARD_BOOL(NOMEM, new_ptr != NULL);
+            devlog_output->buf = new_ptr;
+            devlog_output->buf_alloc = queued + msg_len;
+        }
+    }
+    if (devlog_output->ends_num >= devlog_output->ends_alloc) {
+        size_t ends_alloc = devlog_output->ends_alloc == 0
+                                ? 64 : devlog_output->ends_alloc * 2;
+        new_ptr = realloc(devlog_output->ends,
+                          sizeof(*devlog_output->ends) * ends_alloc);
+        AUSHAPE_GUARD_BOOL(NOMEM, new_ptr != NULL);
+        devlog_output->ends = new_ptr;
+        devlog_output->ends_alloc = ends_alloc;
+    }
+
+    /* Queue the message */
+    if (queued == 0 && aushape_flusher_is_started(&devlog_output->flusher)) {
+        clock_gettime(CLOCK_MONOTONIC, &devlog_output->queue_time);
+        aushape_flusher_signal(&devlog_output->flusher);
+    }
+    memcpy(devlog_output->buf + devlog_output->buf_len,
+           devlog_output->hdr, devlog_output->hdr_len);
+    memcpy(devlog_output->buf + devlog_output->buf_len +
+                devlog_output->hdr_len,
+           ptr, len);
+    devlog_output->buf_len += msg_len;
+    devlog_output->ends[devlog_output->ends_num++] = devlog_output->buf_len;
+
+    /* Send a full batch */
+    if (devlog_output->ends_num - devlog_output->ends_head >=
+            devlog_output->batch_size) {
+        aushape_devlog_output_send(devlog_output);
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_flusher_unlock(&devlog_output->flusher);
+    return rc;
+}
+
+static enum aushape_rc
+aushape_devlog_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)output;
+
+    assert(devlog_output != NULL);
+
+    /* Keep collecting the batch, unless flushed explicitly */
+    if (full) {
+        aushape_flusher_lock(&devlog_output->flusher);
+        aushape_devlog_output_drain(devlog_output);
+        aushape_flusher_unlock(&devlog_output->flusher);
+    }
+    return AUSHAPE_RC_OK;
+}
+
+enum aushape_rc
+aushape_devlog_output_get_stats(const struct aushape_output *output,
+                                struct aushape_devlog_output_stats *pstats)
+{
+    struct aushape_devlog_output *devlog_output =
+                                    (struct aushape_devlog_output *)output;
+
+    if (!aushape_output_is_valid(output) ||
+        output->type != &aushape_devlog_output_type ||
+        pstats == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    aushape_flusher_lock(&devlog_output->flusher);
+    *pstats = devlog_output->stats;
+    pstats->depth = devlog_output->ends_num - devlog_output->ends_head;
+    aushape_flusher_unlock(&devlog_output->flusher);
+
+    return AUSHAPE_RC_OK;
+}
+
+const struct aushape_output_type aushape_devlog_output_type = {
+    .size       = sizeof(struct aushape_devlog_output),
+    .cont       = false,
+    .init       = aushape_devlog_output_init,
+    .is_valid   = aushape_devlog_output_is_valid,
+    .write      = aushape_devlog_output_write,
+    .sync       = aushape_devlog_output_sync,
+    .cleanup    = aushape_devlog_output_cleanup,
+};
@@ -21,7 +21,6 @@
 #include <aushape/disp_coll.h>
 #include <aushape/uniq_coll.h>
 #include <aushape/coll.h>
-#include <aushape/auparse.h>
 #include <aushape/misc.h>
 #include <string.h>
 
@@ -76,6 +75,8 @@ aushape_disp_coll_init(struct aushape_coll *coll,
                        const void *args)
 {
     struct aushape_disp_coll *disp_coll = (struct aushape_disp_coll *)coll;
+    const struct aushape_mem *mem =
+                    aushape_itree_pool_get_mem(coll->itree->pool);
     enum aushape_rc rc;
     const struct aushape_disp_coll_type_link  *type_map = 
                     (const struct aushape_disp_coll_type_link *)args;
@@ -94,11 +95,12 @@ aushape_disp_coll_init(struct aushape_coll *coll,
          map_size++, type_link++);
 
     /* Create instance link array */
-    inst_map = malloc(sizeof(*inst_map) * map_size);
+    inst_map = aushape_mem_realloc(mem, NULL, sizeof(*inst_map) * map_size);
     if (inst_map == NULL) {
         rc = AUSHAPE_RC_NOMEM;
         goto cleanup;
     }
+    memset(inst_map, 0, sizeof(*inst_map) * map_size);
 
     /* Initialize instance links */
     type_link = type_map;
@@ -106,8 +108,7 @@ aushape_disp_coll_init(struct aushape_coll *coll,
     while (true) {
         inst_link->name = type_link->name;
         rc = aushape_coll_create(&inst_link->inst, type_link->type,
-                                 &coll->format, coll->gbtree,
-                                 type_link->args);
+                                 coll->itree, type_link->args);
         if (rc != AUSHAPE_RC_OK) {
             assert(rc != AUSHAPE_RC_INVALID_ARGS);
             goto cleanup;
@@ -138,7 +139,7 @@ cleanup:
             }
             inst_link++;
         }
-        free(inst_map);
+        aushape_mem_free(mem, inst_map);
     }
     return rc;
 }
@@ -153,7 +154,8 @@ aushape_disp_coll_cleanup(struct aushape_coll *coll)
         aushape_coll_destroy(link->inst);
         link->inst = NULL;
     } while ((link++)->name != NULL);
-    free(disp_coll->map);
+    aushape_mem_free(aushape_itree_pool_get_mem(coll->itree->pool),
+                     disp_coll->map);
 }
 
 static bool
@@ -179,6 +181,30 @@ aushape_disp_coll_empty(struct aushape_coll *coll)
     } while ((link++)->name != NULL);
 }
 
+static void
+aushape_disp_coll_shrink(struct aushape_coll *coll)
+{
+    struct aushape_disp_coll *disp_coll = (struct aushape_disp_coll *)coll;
+    struct aushape_disp_coll_inst_link *link = disp_coll->map;
+    do {
+        aushape_coll_shrink(link->inst);
+    } while ((link++)->name != NULL);
+}
+
+static void
+aushape_disp_coll_get_mem_usage(const struct aushape_coll *coll,
+                                struct aushape_mem_usage *usage)
+{
+    const struct aushape_disp_coll *disp_coll =
+                    (const struct aushape_disp_coll *)coll;
+    const struct aushape_disp_coll_inst_link *link = disp_coll->map;
+    do {
+        usage->size += sizeof(*link);
+        usage->peak += sizeof(*link);
+        aushape_coll_get_mem_usage(link->inst, usage);
+    } while ((link++)->name != NULL);
+}
+
 /**
  * Lookup a collector corresponding to a record type name within a dispatcher
  * collector map.
@@ -209,28 +235,23 @@ aushape_disp_coll_lookup(struct aushape_coll *coll,
 static enum aushape_rc
 aushape_disp_coll_add(struct aushape_coll *coll,
                       size_t *pcount,
-                      size_t level,
                       size_t prio,
-                      auparse_state_t *au)
+                      const struct aushape_itree_node *record)
 {
     const char *name;
     assert(aushape_coll_is_valid(coll));
     assert(coll->type == &aushape_disp_coll_type);
     assert(pcount != NULL);
-    assert(au != NULL);
+    assert(record != NULL);
 
-    name = aushape_auparse_get_type_name(au);
-    if (name == NULL) {
-        return AUSHAPE_RC_AUPARSE_FAILED;
-    }
+    name = aushape_itree_pool_get_str(coll->itree->pool, record->name);
     return aushape_coll_add(aushape_disp_coll_lookup(coll, name),
-                            pcount, level, prio, au);
+                            pcount, prio, record);
 }
 
 static enum aushape_rc
 aushape_disp_coll_end(struct aushape_coll *coll,
                       size_t *pcount,
-                      size_t level,
                       size_t prio)
 {
     struct aushape_disp_coll *disp_coll =
@@ -246,7 +267,7 @@ aushape_disp_coll_end(struct aushape_coll *coll,
     link = disp_coll->map;
     do {
         prev_count = *pcount;
-        rc = aushape_coll_end(link->inst, pcount, level, prio);
+        rc = aushape_coll_end(link->inst, pcount, prio);
         /* FIXME We can't really mess with priority here */
         prio += *pcount - prev_count;
         if (rc != AUSHAPE_RC_OK) {
@@ -267,4 +288,6 @@ const struct aushape_coll_type aushape_disp_coll_type = {
     .empty      = aushape_disp_coll_empty,
     .add        = aushape_disp_coll_add,
     .end        = aushape_disp_coll_end,
+    .shrink     = aushape_disp_coll_shrink,
+    .get_mem_usage = aushape_disp_coll_get_mem_usage,
 };
@@ -20,7 +20,6 @@
 
 #include <aushape/drop_coll.h>
 #include <aushape/coll.h>
-#include <aushape/record.h>
 #include <aushape/guard.h>
 #include <string.h>
 
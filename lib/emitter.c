@@ -0,0 +1,741 @@
+/*
+ * Formatting functions specialized for an output language and folding.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * The generic formatting functions below take the language and folding as
+ * arguments, and are always inlined into the emitter instances defined with
+ * AUSHAPE_EMITTER_DEFINE, which pass them as constants. The compiler then
+ * drops the branches not taken by each instance.
+ */
+
+#include <aushape/emitter.h>
+#include <aushape/field.h>
+#include <aushape/guard.h>
+#include <aushape/key_dict.h>
+#include <string.h>
+
+/** Attributes of generic functions to be specialized */
+#define AUSHAPE_EMITTER_GENERIC static inline __attribute__((always_inline))
+
+/**
+ * Add whitespace preceding an opening token, according to the specialized
+ * language and folding, see aushape_gbuf_space_opening.
+ */
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_space_opening(struct aushape_gbuf *gbuf,
+                              const struct aushape_format *format,
+                              enum aushape_lang lang,
+                              bool folded,
+                              size_t level)
+{
+    if (aushape_lang_is_binary(lang)) {
+        return AUSHAPE_RC_OK;
+    } else if (folded) {
+        /* Only the top level is indented, when folded at level zero */
+        return level == 0 ? aushape_gbuf_add_span(gbuf, ' ',
+                                                  format->init_indent)
+                          : AUSHAPE_RC_OK;
+    } else {
+        return aushape_gbuf_space_opening(gbuf, format, level);
+    }
+}
+
+/**
+ * Add whitespace preceding a closing token, according to the specialized
+ * language and folding, see aushape_gbuf_space_closing.
+ */
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_space_closing(struct aushape_gbuf *gbuf,
+                              const struct aushape_format *format,
+                              enum aushape_lang lang,
+                              bool folded,
+                              size_t level)
+{
+    if (aushape_lang_is_binary(lang) || folded) {
+        return AUSHAPE_RC_OK;
+    } else {
+        return aushape_gbuf_space_closing(gbuf, format, level);
+    }
+}
+
+/**
+ * Output the part of field properties preceding the values: separators,
+ * whitespace, and the field name. Depends only on the format, the level,
+ * the position, and the name, and so can be pre-rendered for a record shape.
+ */
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_field_head(struct aushape_gbuf *gbuf,
+                           const struct aushape_format *format,
+                           enum aushape_lang lang,
+                           bool folded,
+                           size_t level,
+                           bool first,
+                           bool list,
+                           const char *name)
+{
+    enum aushape_rc rc;
+
+    switch (lang) {
+    case AUSHAPE_LANG_XML:
+        AUSHAPE_GUARD(aushape_emitter_space_opening(gbuf, format,
+                                                    lang, folded, level));
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '<'));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, name));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, " i=\""));
+        break;
+    case AUSHAPE_LANG_JSON:
+        if (!first) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+        }
+        AUSHAPE_GUARD(aushape_emitter_space_opening(gbuf, format,
+                                                    lang, folded, level));
+        if (list) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '['));
+        } else {
+            AUSHAPE_GUARD(aushape_key_dict_add_json(gbuf, format,
+                                                    name, false));
+            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, ":["));
+        }
+        break;
+    case AUSHAPE_LANG_CBOR:
+        if (!list) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(gbuf, name));
+        }
+        break;
+    case AUSHAPE_LANG_MSGPACK:
+        if (!list) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(gbuf, name));
+        }
+        break;
+    default:
+        break;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Check if a field value is a decimal integer fitting a signed 64-bit
+ * integer, and can be output as a JSON number verbatim.
+ *
+ * @param value The value to check.
+ *
+ * @return True if the value is such an integer, false otherwise.
+ */
+static bool
+aushape_emitter_value_is_int(const char *value)
+{
+    static const char max_pos[] = "9223372036854775807";
+    static const char max_neg[] = "9223372036854775808";
+    const char *max = max_pos;
+    const char *p;
+    size_t len;
+
+    if (*value == '-') {
+        value++;
+        max = max_neg;
+    }
+    /* No leading zeros, and no negative zero */
+    if (*value == '0') {
+        return value[1] == '\0' && max == max_pos;
+    }
+    p = value;
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    len = p - value;
+    if (*p != '\0' || len == 0 || len > sizeof(max_pos) - 1) {
+        return false;
+    }
+    return len < sizeof(max_pos) - 1 || strcmp(value, max) <= 0;
+}
+
+/**
+ * Convert a field value to a JSON boolean literal, if it is a boolean.
+ *
+ * @param value The value to convert.
+ *
+ * @return The boolean literal, or NULL if the value is not a boolean.
+ */
+static const char *
+aushape_emitter_value_to_bool(const char *value)
+{
+    if (strcmp(value, "yes") == 0 || strcmp(value, "success") == 0 ||
+        strcmp(value, "1") == 0) {
+        return "true";
+    } else if (strcmp(value, "no") == 0 || strcmp(value, "failed") == 0 ||
+               strcmp(value, "0") == 0) {
+        return "false";
+    }
+    return NULL;
+}
+
+/**
+ * Output a JSON field value, as a number or a boolean, if the field kind
+ * allows and the value is one, and as a string otherwise.
+ */
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_json_value(struct aushape_gbuf *gbuf,
+                           enum aushape_field_kind kind,
+                           const char *value)
+{
+    enum aushape_rc rc;
+    const char *literal;
+
+    if (kind == AUSHAPE_FIELD_KIND_INT &&
+        aushape_emitter_value_is_int(value)) {
+        return aushape_gbuf_add_str(gbuf, value);
+    } else if (kind == AUSHAPE_FIELD_KIND_BOOL) {
+        literal = aushape_emitter_value_to_bool(value);
+        if (literal != NULL) {
+            return aushape_gbuf_add_str(gbuf, literal);
+        }
+    }
+
+    AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
+    AUSHAPE_GUARD(aushape_gbuf_add_str_json(gbuf, value));
+    AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Output the part of field properties following aushape_emitter_field_head:
+ * the values, typed according to the field kind, if the language supports
+ * that, and the closing markup.
+ */
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_field_tail(struct aushape_gbuf *gbuf,
+                           enum aushape_lang lang,
+                           enum aushape_field_kind kind,
+                           const char *value_r,
+                           const char *value_i)
+{
+    enum aushape_rc rc;
+
+    switch (lang) {
+    case AUSHAPE_LANG_XML:
+        AUSHAPE_GUARD(aushape_gbuf_add_str_xml(gbuf, value_i));
+        if (value_r != NULL) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\" r=\""));
+            AUSHAPE_GUARD(aushape_gbuf_add_str_xml(gbuf, value_r));
+        }
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\"/>"));
+        break;
+    case AUSHAPE_LANG_JSON:
+        AUSHAPE_GUARD(aushape_emitter_json_value(gbuf, kind, value_i));
+        if (value_r != NULL) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+            AUSHAPE_GUARD(aushape_emitter_json_value(gbuf, kind, value_r));
+        }
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ']'));
+        break;
+    case AUSHAPE_LANG_CBOR:
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(gbuf,
+                                                 AUSHAPE_CBOR_MAJOR_ARRAY,
+                                                 value_r == NULL ? 1 : 2));
+        AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(gbuf, value_i));
+        if (value_r != NULL) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_cbor(gbuf, value_r));
+        }
+        break;
+    case AUSHAPE_LANG_MSGPACK:
+        AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(
+                                        gbuf, AUSHAPE_MSGPACK_TYPE_ARRAY,
+                                        value_r == NULL ? 1 : 2));
+        AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(gbuf, value_i));
+        if (value_r != NULL) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str_msgpack(gbuf, value_r));
+        }
+        break;
+    default:
+        break;
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_field_props(struct aushape_gbuf *gbuf,
+                            const struct aushape_format *format,
+                            enum aushape_lang lang,
+                            bool folded,
+                            size_t level,
+                            bool first,
+                            bool list,
+                            const char *name,
+                            const char *value_r,
+                            const char *value_i)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(aushape_format_is_valid(format));
+    assert(name != NULL);
+
+    AUSHAPE_GUARD(aushape_emitter_field_head(gbuf, format, lang, folded,
+                                             level, first, list, name));
+    AUSHAPE_GUARD(aushape_emitter_field_tail(gbuf, lang,
+                                             AUSHAPE_FIELD_KIND_STR,
+                                             value_r, value_i));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_field(struct aushape_gbuf *gbuf,
+                      const struct aushape_format *format,
+                      enum aushape_lang lang,
+                      bool folded,
+                      size_t level,
+                      bool first,
+                      bool list,
+                      const char *name,
+                      const struct aushape_itree_pool *pool,
+                      const struct aushape_itree_field *field)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(aushape_format_is_valid(format));
+    assert(name != NULL);
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(field != NULL);
+
+    AUSHAPE_GUARD(aushape_emitter_field_head(gbuf, format, lang, folded,
+                                             level, first, list, name));
+    AUSHAPE_GUARD(aushape_emitter_field_tail(
+                    gbuf, lang,
+                    aushape_field_get_format_kind(format, field->kind),
+                    field->with_raw
+                        ? aushape_itree_pool_get_str(pool, field->value_r)
+                        : NULL,
+                    aushape_itree_pool_get_str(pool, field->value_i)));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Output intermediate record fields using a complete cached shape, splicing
+ * the field values into its pre-rendered skeleton. Stops and reports a
+ * mismatch, if the field names differ from the shape's.
+ */
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_record_fields_shaped(
+                            struct aushape_gbuf *gbuf,
+                            enum aushape_lang lang,
+                            const struct aushape_shape *shape,
+                            bool *pmatched,
+                            const struct aushape_itree_pool *pool,
+                            const struct aushape_itree_node *record)
+{
+    enum aushape_rc rc;
+    const struct aushape_shape_field *shape_field;
+    const struct aushape_itree_field *field;
+    const char *name = shape->names.ptr;
+    const char *skel = shape->skel.ptr;
+    size_t i;
+
+    assert(shape->complete);
+    assert(shape->field_num == record->len);
+
+    for (i = 0; i < shape->field_num; i++) {
+        field = aushape_itree_pool_get_field(pool, record->pos + i);
+        if (strcmp(aushape_itree_pool_get_str(pool, field->name),
+                   name) != 0) {
+            *pmatched = false;
+            return AUSHAPE_RC_OK;
+        }
+        shape_field = aushape_garr_const_get(&shape->fields, i);
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, skel,
+                                           shape_field->skel_len));
+        AUSHAPE_GUARD(aushape_emitter_field_tail(
+                        gbuf, lang, shape_field->kind,
+                        field->with_raw
+                            ? aushape_itree_pool_get_str(pool,
+                                                         field->value_r)
+                            : NULL,
+                        aushape_itree_pool_get_str(pool, field->value_i)));
+        skel += shape_field->skel_len;
+        name += shape_field->name_len + 1;
+    }
+
+    *pmatched = true;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_record_fields(struct aushape_gbuf *gbuf,
+                              const struct aushape_format *format,
+                              enum aushape_lang lang,
+                              bool folded,
+                              size_t level,
+                              struct aushape_shape_cache *shapes,
+                              const struct aushape_itree_pool *pool,
+                              const struct aushape_itree_node *record)
+{
+    enum aushape_rc rc;
+    struct aushape_shape *shape = NULL;
+    bool matched;
+    size_t start = gbuf->len;
+    size_t head;
+    const struct aushape_itree_field *field;
+    const char *field_name;
+    enum aushape_field_kind kind;
+    size_t i;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(aushape_format_is_valid(format));
+    assert(shapes == NULL || aushape_shape_cache_is_valid(shapes));
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(record != NULL);
+
+    if (shapes != NULL) {
+        shape = aushape_shape_cache_get(shapes, level, pool, record);
+        if (shape->complete) {
+            AUSHAPE_GUARD(aushape_emitter_record_fields_shaped(
+                                                gbuf, lang, shape,
+                                                &matched, pool, record));
+            if (matched) {
+                shapes->hits++;
+                return AUSHAPE_RC_OK;
+            }
+            /* Field name hashes collided, render the new shape instead */
+            gbuf->len = start;
+            aushape_shape_empty(shape);
+        }
+        shapes->misses++;
+    }
+
+    for (i = 0; i < record->len; i++) {
+        field = aushape_itree_pool_get_field(pool, record->pos + i);
+        field_name = aushape_itree_pool_get_str(pool, field->name);
+        kind = aushape_field_get_format_kind(format, field->kind);
+        head = gbuf->len;
+        AUSHAPE_GUARD(aushape_emitter_field_head(gbuf, format,
+                                                 lang, folded, level,
+                                                 i == 0, false,
+                                                 field_name));
+        if (shape != NULL) {
+            AUSHAPE_GUARD(aushape_shape_add_field(shape, field_name, kind,
+                                                  gbuf->ptr + head,
+                                                  gbuf->len - head));
+        }
+        AUSHAPE_GUARD(aushape_emitter_field_tail(
+                        gbuf, lang, kind,
+                        field->with_raw
+                            ? aushape_itree_pool_get_str(pool,
+                                                         field->value_r)
+                            : NULL,
+                        aushape_itree_pool_get_str(pool, field->value_i)));
+    }
+
+    if (shape != NULL) {
+        aushape_shape_complete(shape);
+    }
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_record(struct aushape_gbuf *gbuf,
+                       const struct aushape_format *format,
+                       enum aushape_lang lang,
+                       bool folded,
+                       size_t level,
+                       bool first,
+                       struct aushape_shape_cache *shapes,
+                       const struct aushape_itree_pool *pool,
+                       const struct aushape_itree_node *record)
+{
+    enum aushape_rc rc;
+    size_t l = level;
+    size_t len;
+    const char *name;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(aushape_format_is_valid(format));
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(record != NULL);
+
+    name = aushape_itree_pool_get_str(pool, record->name);
+
+    if (lang == AUSHAPE_LANG_XML) {
+        AUSHAPE_GUARD(aushape_emitter_space_opening(gbuf, format,
+                                                    lang, folded, l));
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '<'));
+        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase(gbuf, name));
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '>'));
+    } else if (lang == AUSHAPE_LANG_JSON) {
+        if (!first) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+        }
+        AUSHAPE_GUARD(aushape_emitter_space_opening(gbuf, format,
+                                                    lang, folded, l));
+        AUSHAPE_GUARD(aushape_key_dict_add_json(gbuf, format, name, true));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, ":{"));
+    } else if (lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase_cbor(gbuf, name));
+        AUSHAPE_GUARD(aushape_gbuf_add_cbor_indef(gbuf,
+                                                  AUSHAPE_CBOR_MAJOR_MAP));
+    } else if (lang == AUSHAPE_LANG_MSGPACK) {
+        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase_msgpack(gbuf, name));
+        AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(gbuf,
+                                                    AUSHAPE_MSGPACK_TYPE_MAP,
+                                                    record->len));
+    }
+
+    l++;
+
+    len = gbuf->len;
+    AUSHAPE_GUARD(aushape_emitter_record_fields(gbuf, format,
+                                                lang, folded, l,
+                                                shapes, pool, record));
+
+    l--;
+
+    if (lang == AUSHAPE_LANG_XML) {
+        AUSHAPE_GUARD(aushape_emitter_space_closing(gbuf, format,
+                                                    lang, folded, l));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</"));
+        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase(gbuf, name));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, ">"));
+    } else if (lang == AUSHAPE_LANG_JSON) {
+        if (gbuf->len > len) {
+            AUSHAPE_GUARD(aushape_emitter_space_closing(gbuf, format,
+                                                        lang, folded, l));
+        }
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '}'));
+    } else if (lang == AUSHAPE_LANG_CBOR) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, AUSHAPE_CBOR_BREAK));
+    }
+
+    assert(l == level);
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+AUSHAPE_EMITTER_GENERIC enum aushape_rc
+aushape_emitter_record_def(struct aushape_gbuf *gbuf,
+                           const struct aushape_format *format,
+                           enum aushape_lang lang,
+                           bool folded,
+                           size_t level,
+                           bool first,
+                           struct aushape_shape_cache *shapes,
+                           const struct aushape_itree_pool *pool,
+                           const struct aushape_itree_node *record)
+{
+    enum aushape_rc rc;
+    const struct aushape_record_def *def;
+    const struct aushape_record_def_markup *markup;
+    size_t len;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(aushape_format_is_valid(format));
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(record != NULL);
+    assert(record->def != NULL);
+
+    def = record->def;
+    markup = &def->markup[lang];
+
+    if (lang == AUSHAPE_LANG_XML) {
+        AUSHAPE_GUARD(aushape_emitter_space_opening(gbuf, format,
+                                                    lang, folded, level));
+    } else if (lang == AUSHAPE_LANG_JSON) {
+        if (!first) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+        }
+        AUSHAPE_GUARD(aushape_emitter_space_opening(gbuf, format,
+                                                    lang, folded, level));
+    }
+    /* Compact keys are not pre-formatted */
+    if (lang == AUSHAPE_LANG_JSON && format->compact_keys) {
+        AUSHAPE_GUARD(aushape_key_dict_add_json(gbuf, format,
+                                                def->name, true));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, ":{"));
+    } else {
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, markup->open,
+                                           markup->open_len));
+    }
+    /* The MessagePack field map head depends on the number of fields */
+    if (lang == AUSHAPE_LANG_MSGPACK) {
+        AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(gbuf,
+                                                    AUSHAPE_MSGPACK_TYPE_MAP,
+                                                    record->len));
+    }
+
+    len = gbuf->len;
+    AUSHAPE_GUARD(aushape_emitter_record_fields(gbuf, format,
+                                                lang, folded, level + 1,
+                                                shapes, pool, record));
+
+    if (lang == AUSHAPE_LANG_XML ||
+        (lang == AUSHAPE_LANG_JSON && gbuf->len > len)) {
+        AUSHAPE_GUARD(aushape_emitter_space_closing(gbuf, format,
+                                                    lang, folded, level));
+    }
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, markup->close,
+                                       markup->close_len));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Define an emitter instance.
+ *
+ * @param _name_tkn The instance name token.
+ * @param _lang     The language to specialize for.
+ * @param _folded   The folding to specialize for.
+ */
+#define AUSHAPE_EMITTER_DEFINE(_name_tkn, _lang, _folded) \
+    static enum aushape_rc                                                  \
+    aushape_emitter_##_name_tkn##_field_props(                              \
+                                    struct aushape_gbuf *gbuf,              \
+                                    const struct aushape_format *format,    \
+                                    size_t level,                           \
+                                    bool first,                             \
+                                    bool list,                              \
+                                    const char *name,                       \
+                                    const char *value_r,                    \
+                                    const char *value_i)                    \
+    {                                                                       \
+        return aushape_emitter_field_props(gbuf, format, _lang, _folded,    \
+                                           level, first, list, name,        \
+                                           value_r, value_i);               \
+    }                                                                       \
+                                                                            \
+    static enum aushape_rc                                                  \
+    aushape_emitter_##_name_tkn##_field(                                    \
+                                    struct aushape_gbuf *gbuf,              \
+                                    const struct aushape_format *format,    \
+                                    size_t level,                           \
+                                    bool first,                             \
+                                    bool list,                              \
+                                    const char *name,                       \
+                                    const struct aushape_itree_pool *pool,  \
+                                    const struct aushape_itree_field *field) \
+    {                                                                       \
+        return aushape_emitter_field(gbuf, format, _lang, _folded,          \
+                                     level, first, list, name,              \
+                                     pool, field);                          \
+    }                                                                       \
+                                                                            \
+    static enum aushape_rc                                                  \
+    aushape_emitter_##_name_tkn##_record_fields(                            \
+                                    struct aushape_gbuf *gbuf,              \
+                                    const struct aushape_format *format,    \
+                                    size_t level,                           \
+                                    struct aushape_shape_cache *shapes,     \
+                                    const struct aushape_itree_pool *pool,  \
+                                    const struct aushape_itree_node *record) \
+    {                                                                       \
+        return aushape_emitter_record_fields(gbuf, format, _lang, _folded,  \
+                                             level, shapes, pool, record);  \
+    }                                                                       \
+                                                                            \
+    static enum aushape_rc                                                  \
+    aushape_emitter_##_name_tkn##_record(                                   \
+                                    struct aushape_gbuf *gbuf,              \
+                                    const struct aushape_format *format,    \
+                                    size_t level,                           \
+                                    bool first,                             \
+                                    struct aushape_shape_cache *shapes,     \
+                                    const struct aushape_itree_pool *pool,  \
+                                    const struct aushape_itree_node *record) \
+    {                                                                       \
+        return aushape_emitter_record(gbuf, format, _lang, _folded,         \
+                                      level, first, shapes, pool, record);  \
+    }                                                                       \
+                                                                            \
+    static enum aushape_rc                                                  \
+    aushape_emitter_##_name_tkn##_record_def(                               \
+                                    struct aushape_gbuf *gbuf,              \
+                                    const struct aushape_format *format,    \
+                                    size_t level,                           \
+                                    bool first,                             \
+                                    struct aushape_shape_cache *shapes,     \
+                                    const struct aushape_itree_pool *pool,  \
+                                    const struct aushape_itree_node *record) \
+    {                                                                       \
+        return aushape_emitter_record_def(gbuf, format, _lang, _folded,     \
+                                          level, first, shapes,             \
+                                          pool, record);                    \
+    }                                                                       \
+                                                                            \
+    static const struct aushape_emitter aushape_emitter_##_name_tkn = {     \
+        .lang           = _lang,                                            \
+        .folded         = _folded,                                          \
+        .field_props    = aushape_emitter_##_name_tkn##_field_props,        \
+        .field          = aushape_emitter_##_name_tkn##_field,              \
+        .record_fields  = aushape_emitter_##_name_tkn##_record_fields,      \
+        .record         = aushape_emitter_##_name_tkn##_record,             \
+        .record_def     = aushape_emitter_##_name_tkn##_record_def,         \
+    }
+
+AUSHAPE_EMITTER_DEFINE(xml_pretty, AUSHAPE_LANG_XML, false);
+AUSHAPE_EMITTER_DEFINE(xml_folded, AUSHAPE_LANG_XML, true);
+AUSHAPE_EMITTER_DEFINE(json_pretty, AUSHAPE_LANG_JSON, false);
+AUSHAPE_EMITTER_DEFINE(json_folded, AUSHAPE_LANG_JSON, true);
+/* Binary languages have no whitespace, and so no pretty variants */
+AUSHAPE_EMITTER_DEFINE(cbor, AUSHAPE_LANG_CBOR, true);
+AUSHAPE_EMITTER_DEFINE(msgpack, AUSHAPE_LANG_MSGPACK, true);
+AUSHAPE_EMITTER_DEFINE(arrow, AUSHAPE_LANG_ARROW, true);
+
+/** Emitters, indexed by language and folding */
+static const struct aushape_emitter *const
+aushape_emitter_list[AUSHAPE_LANG_NUM][2] = {
+    [AUSHAPE_LANG_XML]      = {&aushape_emitter_xml_pretty,
+                               &aushape_emitter_xml_folded},
+    [AUSHAPE_LANG_JSON]     = {&aushape_emitter_json_pretty,
+                               &aushape_emitter_json_folded},
+    [AUSHAPE_LANG_CBOR]     = {&aushape_emitter_cbor,
+                               &aushape_emitter_cbor},
+    [AUSHAPE_LANG_MSGPACK]  = {&aushape_emitter_msgpack,
+                               &aushape_emitter_msgpack},
+    [AUSHAPE_LANG_ARROW]    = {&aushape_emitter_arrow,
+                               &aushape_emitter_arrow},
+};
+
+const struct aushape_emitter *
+aushape_emitter_get(const struct aushape_format *format)
+{
+    const struct aushape_emitter *emitter;
+    assert(aushape_format_is_valid(format));
+    emitter = aushape_emitter_list[format->lang][format->fold_level == 0];
+    assert(aushape_emitter_is_valid(emitter, format));
+    return emitter;
+}
@@ -27,8 +27,10 @@
 struct aushape_execve_coll {
     /** Abstract base collector */
     struct aushape_coll     coll;
-    /** Output growing buffer tree */
-    struct aushape_gbtree   gbtree;
+    /** Collected argument items */
+    struct aushape_itree    items;
+    /** Slices of the argument being read */
+    struct aushape_gbuf     slices;
     /** Number of arguments expected */
     size_t                  arg_num;
     /** Index of the argument being read */
@@ -48,7 +50,8 @@ aushape_execve_coll_is_valid(const struct aushape_coll *coll)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
-    return aushape_gbtree_is_valid(&execve_coll->gbtree) &&
+    return aushape_itree_is_valid(&execve_coll->items) &&
+           aushape_gbuf_is_valid(&execve_coll->slices) &&
            execve_coll->arg_idx <= execve_coll->arg_num &&
            /*
             * slice_idx and len_total should be zero,
@@ -65,7 +68,9 @@ aushape_execve_coll_init(struct aushape_coll *coll, const void *args)
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
     (void)args;
-    aushape_gbtree_init(&execve_coll->gbtree, 1024, 8, 8);
+    aushape_itree_init(&execve_coll->items, coll->itree->pool, 8);
+    aushape_gbuf_init(&execve_coll->slices, 1024,
+                      aushape_itree_pool_get_mem(coll->itree->pool));
     return AUSHAPE_RC_OK;
 }
 
@@ -74,7 +79,27 @@ aushape_execve_coll_cleanup(struct aushape_coll *coll)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
-    aushape_gbtree_cleanup(&execve_coll->gbtree);
+    aushape_itree_cleanup(&execve_coll->items);
+    aushape_gbuf_cleanup(&execve_coll->slices);
+}
+
+static void
+aushape_execve_coll_shrink(struct aushape_coll *coll)
+{
+    struct aushape_execve_coll *execve_coll =
+                    (struct aushape_execve_coll *)coll;
+    aushape_itree_shrink(&execve_coll->items);
+    aushape_gbuf_shrink(&execve_coll->slices);
+}
+
+static void
+aushape_execve_coll_get_mem_usage(const struct aushape_coll *coll,
+                                  struct aushape_mem_usage *usage)
+{
+    const struct aushape_execve_coll *execve_coll =
+                    (const struct aushape_execve_coll *)coll;
+    aushape_itree_get_mem_usage(&execve_coll->items, usage);
+    aushape_gbuf_get_mem_usage(&execve_coll->slices, usage);
 }
 
 static bool
@@ -90,7 +115,8 @@ aushape_execve_coll_empty(struct aushape_coll *coll)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
-    aushape_gbtree_empty(&execve_coll->gbtree);
+    aushape_itree_empty(&execve_coll->items);
+    aushape_gbuf_empty(&execve_coll->slices);
     execve_coll->arg_num = 0;
     execve_coll->arg_idx = 0;
     execve_coll->got_len = false;
@@ -103,20 +129,16 @@ aushape_execve_coll_empty(struct aushape_coll *coll)
  * Process "argc" field for the execve record being collected.
  *
  * @param coll      The execve collector to process the field for.
- * @param level     Syntactic nesting level to output at.
- * @param au        The auparse context with the field to be processed as
- *                  the current field.
+ * @param field     The field to be processed.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - processed successfully,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed,
  *          AUSHAPE_RC_INVALID_EXECVE   - invalid execve record sequence
  *                                        encountered.
  */
 static enum aushape_rc
 aushape_execve_coll_add_argc(struct aushape_coll *coll,
-                             size_t level,
-                             auparse_state_t *au)
+                             const struct aushape_itree_field *field)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
@@ -127,12 +149,10 @@ aushape_execve_coll_add_argc(struct aushape_coll *coll,
 
     assert(aushape_coll_is_valid(coll));
     assert(coll->type == &aushape_execve_coll_type);
-    assert(au != NULL);
-    (void)level;
+    assert(field != NULL);
 
     AUSHAPE_GUARD_BOOL(INVALID_EXECVE, execve_coll->arg_num == 0);
-    str = auparse_get_field_str(au);
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, str != NULL);
+    str = aushape_itree_pool_get_str(coll->itree->pool, field->value_r);
     end = 0;
     AUSHAPE_GUARD_BOOL(INVALID_EXECVE,
                        sscanf(str, "%zu%n", &num, &end) >= 1 &&
@@ -145,47 +165,37 @@ cleanup:
 }
 
 /**
- * Add markup for the specified argument string value.
+ * Add an argument item with the specified value, already in the pool.
  *
- * @param coll      The execve collector to add markup to.
- * @param level     Syntactic nesting level to output at.
- * @param str       The argument string value.
+ * @param coll      The execve collector to add the item to.
+ * @param pos       Position of the argument value in the pool text.
+ * @param len       Length of the argument value.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK                   - added successfully,
  *          AUSHAPE_RC_NOMEM                - memory allocation failed,
  */
 static enum aushape_rc
-aushape_execve_coll_add_arg_str(struct aushape_coll *coll,
-                                size_t level,
-                                const char *str)
+aushape_execve_coll_add_arg_pos(struct aushape_coll *coll,
+                                size_t pos, size_t len)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
-    struct aushape_gbtree *gbtree = &execve_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
+    /* Arguments are arbitrary bytes, not necessarily UTF-8 */
+    struct aushape_itree_node node = {
+        .type   = AUSHAPE_ITREE_NODE_TYPE_BYTES,
+        .prio   = execve_coll->arg_idx,
+        .name   = AUSHAPE_ITREE_POS_NONE,
+        .item_name  = AUSHAPE_ITREE_POS_NONE,
+        .pos    = pos,
+        .len    = len,
+    };
     enum aushape_rc rc;
 
     assert(aushape_coll_is_valid(coll));
     assert(coll->type == &aushape_execve_coll_type);
-    assert(str != NULL);
-
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, level));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "<a>"));
-        AUSHAPE_GUARD(aushape_gbuf_add_str_xml(gbuf, str));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</a>"));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        /* If it's not the first argument in the record */
-        if (execve_coll->arg_idx > 0) {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, level));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-        AUSHAPE_GUARD(aushape_gbuf_add_str_json(gbuf, str));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-    }
-    AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree, execve_coll->arg_idx));
+
+    AUSHAPE_GUARD(aushape_itree_node_add(&execve_coll->items, &node));
 
     execve_coll->arg_idx++;
 
@@ -195,53 +205,78 @@ cleanup:
     return rc;
 }
 
+/**
+ * Add empty argument items for the arguments skipped before the specified
+ * one.
+ *
+ * @param coll      The execve collector to add the items to.
+ * @param arg_idx   Index of the argument following the skipped ones.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - added successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ */
+static enum aushape_rc
+aushape_execve_coll_add_skipped(struct aushape_coll *coll, size_t arg_idx)
+{
+    struct aushape_execve_coll *execve_coll =
+                    (struct aushape_execve_coll *)coll;
+    enum aushape_rc rc = AUSHAPE_RC_OK;
+    size_t pos;
+
+    assert(aushape_coll_is_valid(coll));
+    assert(coll->type == &aushape_execve_coll_type);
+
+    if (execve_coll->arg_idx < arg_idx) {
+        AUSHAPE_GUARD(aushape_itree_pool_add_buf(coll->itree->pool,
+                                                 "", 0, &pos));
+        while (execve_coll->arg_idx < arg_idx) {
+            AUSHAPE_GUARD(aushape_execve_coll_add_arg_pos(coll, pos, 0));
+        }
+    }
+
+cleanup:
+    return rc;
+}
+
 /**
  * Process "a[0-9]+" field for the execve record being collected.
  *
  * @param coll      The execve collector to process the field for.
- * @param level     Syntactic nesting level to output at.
  * @param arg_idx   The argument index from the field name.
- * @param au        The auparse context with the field to be processed as the
- *                  current field.
+ * @param field     The field to be processed.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - processed successfully,
  *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed,
  *          AUSHAPE_RC_INVALID_EXECVE   - invalid execve record sequence
  *                                        encountered.
  */
 static enum aushape_rc
 aushape_execve_coll_add_arg(struct aushape_coll *coll,
-                            size_t level,
                             size_t arg_idx,
-                            auparse_state_t *au)
+                            const struct aushape_itree_field *field)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
     enum aushape_rc rc;
-    const char *str;
 
     assert(aushape_coll_is_valid(coll));
     assert(coll->type == &aushape_execve_coll_type);
-    assert(au != NULL);
+    assert(field != NULL);
 
     AUSHAPE_GUARD_BOOL(INVALID_EXECVE,
                        arg_idx >= execve_coll->arg_idx &&
                        arg_idx < execve_coll->arg_num);
 
     /* Add skipped empty arguments */
-    while (execve_coll->arg_idx < arg_idx) {
-        rc = aushape_execve_coll_add_arg_str(coll, level, "");
-        if (rc != AUSHAPE_RC_OK) {
-            goto cleanup;
-        }
-    }
+    AUSHAPE_GUARD(aushape_execve_coll_add_skipped(coll, arg_idx));
 
-    /* Add the argument in question */
-    str = auparse_interpret_field(au);
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, str != NULL);
-    rc = aushape_execve_coll_add_arg_str(coll, level, str);
+    /* Add the argument in question, using the value in the pool */
+    rc = aushape_execve_coll_add_arg_pos(
+                coll, field->value_i,
+                strlen(aushape_itree_pool_get_str(coll->itree->pool,
+                                                  field->value_i)));
 
 cleanup:
     assert(aushape_coll_is_valid(coll));
@@ -252,22 +287,19 @@ cleanup:
  * Process "a[0-9]+_len" field for the execve record being collected.
  *
  * @param coll      The execve collector to process the field for.
- * @param level     Syntactic nesting level to output at.
  * @param arg_idx   The argument index from the field name.
- * @param au        The auparse context with the field to be processed as the
- *                  current field.
+ * @param field     The field to be processed.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - processed successfully,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed,
+ *          AUSHAPE_RC_NOMEM            - memory allocation failed,
  *          AUSHAPE_RC_INVALID_EXECVE   - invalid execve record sequence
  *                                        encountered.
  */
 static enum aushape_rc
 aushape_execve_coll_add_arg_len(struct aushape_coll *coll,
-                                size_t level,
                                 size_t arg_idx,
-                                auparse_state_t *au)
+                                const struct aushape_itree_field *field)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
@@ -278,7 +310,7 @@ aushape_execve_coll_add_arg_len(struct aushape_coll *coll,
 
     assert(aushape_coll_is_valid(coll));
     assert(coll->type == &aushape_execve_coll_type);
-    assert(au != NULL);
+    assert(field != NULL);
 
     AUSHAPE_GUARD_BOOL(INVALID_EXECVE,
                        arg_idx >= execve_coll->arg_idx &&
@@ -286,17 +318,11 @@ aushape_execve_coll_add_arg_len(struct aushape_coll *coll,
                        !execve_coll->got_len);
 
     /* Add skipped empty arguments */
-    while (execve_coll->arg_idx < arg_idx) {
-        rc = aushape_execve_coll_add_arg_str(coll, level, "");
-        if (rc != AUSHAPE_RC_OK) {
-            goto cleanup;
-        }
-    }
+    AUSHAPE_GUARD(aushape_execve_coll_add_skipped(coll, arg_idx));
 
     execve_coll->got_len = true;
 
-    str = auparse_get_field_str(au);
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, str != NULL);
+    str = aushape_itree_pool_get_str(coll->itree->pool, field->value_r);
     end = 0;
     AUSHAPE_GUARD_BOOL(INVALID_EXECVE,
                        sscanf(str, "%zu%n", &num, &end) >= 1 &&
@@ -313,39 +339,36 @@ cleanup:
  * Process "a[0-9]\[[0-9]+\]" field for the execve record being collected.
  *
  * @param coll      The execve collector to process the field for.
- * @param level     Syntactic nesting level to output at.
  * @param arg_idx   The argument index from the field name.
  * @param slice_idx The slice index from the field name.
- * @param au        The auparse context with the field to be processed as the
- *                  current field.
+ * @param field     The field to be processed.
  *
  * @return Return code:
  *          AUSHAPE_RC_OK               - processed successfully,
  *          AUSHAPE_RC_NOMEM            - memory allocation failed,
- *          AUSHAPE_RC_AUPARSE_FAILED   - an auparse call failed,
  *          AUSHAPE_RC_INVALID_EXECVE   - invalid execve record sequence
  *                                        encountered.
  */
 static enum aushape_rc
 aushape_execve_coll_add_arg_slice(struct aushape_coll *coll,
-                                  size_t level,
                                   size_t arg_idx, size_t slice_idx,
-                                  auparse_state_t *au)
+                                  const struct aushape_itree_field *field)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
-    struct aushape_gbtree *gbtree = &execve_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
+    struct aushape_itree_pool *pool = coll->itree->pool;
+    struct aushape_gbuf *gbuf = &execve_coll->slices;
     enum aushape_rc rc;
     const char *raw_str;
     size_t raw_len;
     const char *int_str;
     size_t int_len;
     size_t len;
+    size_t pos;
 
     assert(aushape_coll_is_valid(coll));
     assert(coll->type == &aushape_execve_coll_type);
-    assert(au != NULL);
+    assert(field != NULL);
 
     AUSHAPE_GUARD_BOOL(INVALID_EXECVE,
                        arg_idx == execve_coll->arg_idx &&
@@ -353,12 +376,10 @@ aushape_execve_coll_add_arg_slice(struct aushape_coll *coll,
                        execve_coll->got_len &&
                        slice_idx == execve_coll->slice_idx);
 
-    raw_str = auparse_get_field_str(au);
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, raw_str != NULL);
+    raw_str = aushape_itree_pool_get_str(pool, field->value_r);
     raw_len = strlen(raw_str);
 
-    int_str = auparse_interpret_field(au);
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, int_str != NULL);
+    int_str = aushape_itree_pool_get_str(pool, field->value_i);
     int_len = strlen(int_str);
 
     /*
@@ -376,48 +397,23 @@ aushape_execve_coll_add_arg_slice(struct aushape_coll *coll,
     AUSHAPE_GUARD_BOOL(INVALID_EXECVE,
                        execve_coll->len_read + len <= execve_coll->len_total);
 
-    /* If we are starting a new argument */
-    if (slice_idx == 0) {
-        /* Begin argument markup */
-        if (coll->format.lang == AUSHAPE_LANG_XML) {
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf,
-                                                     &coll->format, level));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "<a>"));
-        } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-            /* If it's not the first argument in the record */
-            if (execve_coll->arg_idx > 0) {
-                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
-            }
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf,
-                                                     &coll->format, level));
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-        }
-    }
-    /* Add the slice */
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_add_str_xml(gbuf, int_str));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        AUSHAPE_GUARD(aushape_gbuf_add_str_json(gbuf, int_str));
-    }
+    /*
+     * Accumulate the slice, as a multibyte character can straddle slices
+     */
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, int_str, int_len));
     execve_coll->len_read += len;
     /* If we have finished the argument */
     if (execve_coll->len_read == execve_coll->len_total) {
-        /* End argument markup */
-        if (coll->format.lang == AUSHAPE_LANG_XML) {
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</a>"));
-        } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-        }
-        /* Commit argument */
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree,
-                                                   execve_coll->arg_idx));
+        /* Add the argument */
+        AUSHAPE_GUARD(aushape_itree_pool_add_buf(pool, gbuf->ptr, gbuf->len,
+                                                 &pos));
+        AUSHAPE_GUARD(aushape_execve_coll_add_arg_pos(coll, pos, gbuf->len));
         /* Reset parsing state */
+        aushape_gbuf_empty(gbuf);
         execve_coll->got_len = false;
         execve_coll->slice_idx = 0;
         execve_coll->len_total = 0;
         execve_coll->len_read = 0;
-        /* Move onto the next argument */
-        execve_coll->arg_idx++;
     } else {
         execve_coll->slice_idx++;
     }
@@ -431,86 +427,62 @@ cleanup:
 static enum aushape_rc
 aushape_execve_coll_add(struct aushape_coll *coll,
                         size_t *pcount,
-                        size_t level,
                         size_t prio,
-                        auparse_state_t *au)
+                        const struct aushape_itree_node *record)
 {
-    struct aushape_execve_coll *execve_coll =
-                    (struct aushape_execve_coll *)coll;
-    struct aushape_gbtree *gbtree = &execve_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
+    struct aushape_itree_pool *pool = coll->itree->pool;
     enum aushape_rc rc;
-    size_t l = level;
+    struct aushape_itree_field field;
     const char *field_name;
     size_t arg_idx;
     size_t slice_idx;
     int end;
+    size_t i;
 
     (void)pcount;
     (void)prio;
 
-    /* If output hasn't started yet */
-    if (aushape_gbtree_is_empty(gbtree)) {
-        /* Output prologue */
-        if (coll->format.lang == AUSHAPE_LANG_XML) {
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "<execve>"));
-        } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\"execve\":["));
-        }
-        /* Commit prologue item */
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree, 0));
-    }
-
-    /* Account for the container markup */
-    l++;
+    assert(aushape_coll_is_valid(coll));
+    assert(pcount != NULL);
+    assert(record != NULL);
 
     /*
      * For each field in the record
      */
-    AUSHAPE_GUARD_BOOL(INVALID_EXECVE, auparse_first_field(au) != 0);
-    do {
-        field_name = auparse_get_field_name(au);
-        AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, field_name != NULL);
-        /* If it's the "type" pseudo-field */
-        if (strcmp(field_name, "type") == 0) {
-            continue;
-        /* If it's the "node" which we handle at event level */
-        } else if (strcmp(field_name, "node") == 0) {
-            continue;
+    for (i = 0; i < record->len; i++) {
+        /* Copy, as adding to the pool can move its fields */
+        field = *aushape_itree_pool_get_field(pool, record->pos + i);
+        field_name = aushape_itree_pool_get_str(pool, field.name);
         /* If it's the number of arguments */
-        } else if (strcmp(field_name, "argc") == 0) {
-            AUSHAPE_GUARD(aushape_execve_coll_add_argc(coll, l, au));
+        if (strcmp(field_name, "argc") == 0) {
+            AUSHAPE_GUARD(aushape_execve_coll_add_argc(coll, &field));
         /* If it's a whole argument */
         } else if (end = 0,
                    sscanf(field_name, "a%zu%n", &arg_idx, &end) >= 1 &&
                    (size_t)end == strlen(field_name)) {
-            AUSHAPE_GUARD(aushape_execve_coll_add_arg(coll, l, arg_idx, au));
+            AUSHAPE_GUARD(aushape_execve_coll_add_arg(coll, arg_idx,
+                                                      &field));
         /* If it's the length of an argument */
         } else if (end = 0,
                    sscanf(field_name, "a%zu_len%n", &arg_idx, &end) >= 1 &&
                    (size_t)end == strlen(field_name)) {
-            AUSHAPE_GUARD(aushape_execve_coll_add_arg_len(coll, l,
-                                                          arg_idx, au));
+            AUSHAPE_GUARD(aushape_execve_coll_add_arg_len(coll, arg_idx,
+                                                          &field));
         /* If it's an argument slice */
         } else if (end = 0,
                    sscanf(field_name, "a%zu[%zu]%n",
                           &arg_idx, &slice_idx, &end) >= 2 &&
                    (size_t)end == strlen(field_name)) {
-            AUSHAPE_GUARD(aushape_execve_coll_add_arg_slice(coll, l, arg_idx,
-                                                            slice_idx, au));
+            AUSHAPE_GUARD(aushape_execve_coll_add_arg_slice(coll, arg_idx,
+                                                            slice_idx,
+                                                            &field));
         /* If it's something else */
         } else {
             rc = AUSHAPE_RC_INVALID_EXECVE;
             goto cleanup;
         }
-    } while (auparse_next_field(au) > 0);
-
-    /* Account for the container markup */
-    l--;
+    }
 
-    assert(l == level);
     rc = AUSHAPE_RC_OK;
 cleanup:
     return rc;
@@ -519,15 +491,21 @@ cleanup:
 static enum aushape_rc
 aushape_execve_coll_end(struct aushape_coll *coll,
                         size_t *pcount,
-                        size_t level,
                         size_t prio)
 {
     struct aushape_execve_coll *execve_coll =
                     (struct aushape_execve_coll *)coll;
-    struct aushape_gbtree *gbtree = &execve_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
+    struct aushape_itree_pool *pool = coll->itree->pool;
+    struct aushape_itree_node node = {
+        .type   = AUSHAPE_ITREE_NODE_TYPE_LIST,
+        .prio   = prio,
+        .pos    = 0,
+        .tree   = &execve_coll->items,
+    };
     enum aushape_rc rc;
-    size_t l = level;
+
+    assert(aushape_coll_is_valid(coll));
+    assert(pcount != NULL);
 
     /* Check that the record sequence was finished */
     if (execve_coll->arg_idx != execve_coll->arg_num) {
@@ -535,41 +513,12 @@ aushape_execve_coll_end(struct aushape_coll *coll,
         goto cleanup;
     }
 
-    /* Account for the container markup */
-    l++;
-
-    /* Add skipped empty arguments */
-    while (execve_coll->arg_idx < execve_coll->arg_num) {
-        rc = aushape_execve_coll_add_arg_str(coll, l, "");
-        if (rc != AUSHAPE_RC_OK) {
-            goto cleanup;
-        }
-    }
-
-    /* Account for the container markup */
-    l--;
-
-    /* Output epilogue */
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</execve>"));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        if (execve_coll->arg_num > 0) {
-            AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, l));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ']'));
-    }
-    /* Commit epilogue item */
-    AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree, 0));
-
-    /* Commit record */
-    if (coll->format.lang == AUSHAPE_LANG_JSON && *pcount > 0) {
-        AUSHAPE_GUARD(aushape_gbuf_add_char(&coll->gbtree->text, ','));
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(coll->gbtree, prio));
-    }
-    AUSHAPE_GUARD(aushape_gbtree_node_add_tree(coll->gbtree, prio, gbtree));
+    /* Add the list of collected arguments */
+    node.len = aushape_itree_get_node_num(&execve_coll->items);
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, "execve", &node.name));
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, "a", &node.item_name));
+    AUSHAPE_GUARD(aushape_itree_node_add(coll->itree, &node));
 
-    assert(l == level);
     (*pcount)++;
     rc = AUSHAPE_RC_OK;
 cleanup:
@@ -585,4 +534,6 @@ const struct aushape_coll_type aushape_execve_coll_type = {
     .empty      = aushape_execve_coll_empty,
     .add        = aushape_execve_coll_add,
     .end        = aushape_execve_coll_end,
+    .shrink     = aushape_execve_coll_shrink,
+    .get_mem_usage = aushape_execve_coll_get_mem_usage,
 };
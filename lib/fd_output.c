@@ -19,7 +19,13 @@
  */
 
 #include <aushape/fd_output.h>
+#include <aushape/flusher.h>
+#include <aushape/guard.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/uio.h>
 #include <errno.h>
 #include <assert.h>
 
@@ -28,14 +34,219 @@ struct aushape_fd_output {
     struct aushape_output output;   /**< Abstract output instance */
     int fd;                         /**< FD to write to */
     bool fd_owned;                  /**< True if FD is owned */
+    size_t buf_size;                /**< Buffer size, zero if unbuffered */
+    char *buf;                      /**< Buffer of output not written yet */
+    size_t buf_len;                 /**< Length of output in the buffer */
+    unsigned int max_latency;       /**< Max buffering time, ms, or zero */
+    /** Monotonic time the buffer received its first byte at */
+    struct timespec buf_time;
+    unsigned int sync_interval;     /**< Max unsynced time, ms, or zero */
+    size_t sync_size;               /**< Max unsynced output, or zero */
+    size_t unsynced;                /**< Output not synced to disk yet */
+    /** Monotonic time the first unsynced byte was accepted at */
+    struct timespec unsynced_time;
+    /** Failure of writing the buffer, sticky */
+    enum aushape_rc rc;
+    /**
+     * Flusher writing and synchronizing output staying in the buffer, or
+     * unsynchronized, for too long, signaled on the buffer, or unsynced
+     * output becoming non-empty
+     */
+    struct aushape_flusher flusher;
 };
 
+/**
+ * Write a vector of output pieces to the FD of an FD output completely.
+ *
+ * @param fd_output The FD output to write to.
+ * @param iov       The vector of pieces to write, will be modified.
+ * @param iovcnt    Number of pieces in the vector.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - written successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - writing failed.
+ */
+static enum aushape_rc
+aushape_fd_output_writev(struct aushape_fd_output *fd_output,
+                         struct iovec *iov, int iovcnt)
+{
+    ssize_t rc;
+    size_t len;
+
+    assert(fd_output != NULL);
+    assert(iov != NULL || iovcnt == 0);
+
+    while (iovcnt > 0) {
+        rc = writev(fd_output->fd, iov, iovcnt);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else {
+                return AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            }
+        }
+        /* Skip written pieces and advance into the partially-written one */
+        len = (size_t)rc;
+        while (iovcnt > 0 && len >= iov->iov_len) {
+            len -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + len;
+            iov->iov_len -= len;
+        }
+    }
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Write the buffered output of an FD output, if any, with the flusher
+ * locked, if started. Records the failure as the output's sticky return
+ * code.
+ *
+ * @param fd_output The FD output to flush.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - flushed successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - writing failed.
+ */
+static enum aushape_rc
+aushape_fd_output_flush(struct aushape_fd_output *fd_output)
+{
+    struct iovec iov;
+
+    assert(fd_output != NULL);
+
+    if (fd_output->rc == AUSHAPE_RC_OK && fd_output->buf_len > 0) {
+        iov.iov_base = fd_output->buf;
+        iov.iov_len = fd_output->buf_len;
+        fd_output->rc = aushape_fd_output_writev(fd_output, &iov, 1);
+        fd_output->buf_len = 0;
+    }
+    return fd_output->rc;
+}
+
+/**
+ * Synchronize output written to the FD of an FD output to disk, if the
+ * output is synchronized and there is anything to synchronize. Ignores
+ * FDs which don't support synchronization, such as pipes. Records the
+ * failure as the output's sticky return code.
+ *
+ * @param fd_output The FD output to synchronize.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - synchronized successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - synchronization failed.
+ */
+static enum aushape_rc
+aushape_fd_output_datasync(struct aushape_fd_output *fd_output)
+{
+    assert(fd_output != NULL);
+
+    if (fd_output->rc == AUSHAPE_RC_OK && fd_output->unsynced > 0) {
+        fd_output->unsynced = 0;
+        if (fdatasync(fd_output->fd) < 0 &&
+            errno != EINVAL && errno != EROFS) {
+            fd_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+    }
+    return fd_output->rc;
+}
+
+/**
+ * Get the time the next flush of an FD output is due at: once the buffered
+ * output stays in the buffer for the maximum latency, or unsynchronized
+ * output stays unsynchronized for the synchronization interval.
+ *
+ * @param data      The FD output to get the flush time of.
+ * @param pdeadline Location for the flush time.
+ *
+ * @return True if a flush is pending, false otherwise.
+ */
+static bool
+aushape_fd_output_flusher_due(void *data, struct timespec *pdeadline)
+{
+    struct aushape_fd_output *fd_output = (struct aushape_fd_output *)data;
+    struct timespec sync_deadline;
+    bool flush;
+    bool sync;
+
+    assert(fd_output != NULL);
+    assert(pdeadline != NULL);
+
+    flush = fd_output->buf_len > 0 && fd_output->max_latency > 0;
+    sync = fd_output->unsynced > 0 && fd_output->sync_interval > 0;
+    if (!(flush || sync) || fd_output->rc != AUSHAPE_RC_OK) {
+        return false;
+    }
+    if (flush) {
+        *pdeadline = fd_output->buf_time;
+        aushape_flusher_time_add(pdeadline, fd_output->max_latency);
+    }
+    if (sync) {
+        sync_deadline = fd_output->unsynced_time;
+        aushape_flusher_time_add(&sync_deadline, fd_output->sync_interval);
+        if (!flush ||
+            aushape_flusher_time_before(&sync_deadline, pdeadline)) {
+            *pdeadline = sync_deadline;
+        }
+    }
+    return true;
+}
+
+/**
+ * Flush an FD output from the flusher: write and synchronize the output,
+ * if it stayed unsynchronized for the synchronization interval, or just
+ * write the buffered output otherwise.
+ *
+ * @param data  The FD output to flush.
+ * @param now   The current monotonic time.
+ */
+static void
+aushape_fd_output_flusher_flush(void *data, const struct timespec *now)
+{
+    struct aushape_fd_output *fd_output = (struct aushape_fd_output *)data;
+    struct timespec sync_deadline;
+    bool failed;
+
+    assert(fd_output != NULL);
+    assert(now != NULL);
+
+    if (fd_output->unsynced > 0 && fd_output->sync_interval > 0) {
+        sync_deadline = fd_output->unsynced_time;
+        aushape_flusher_time_add(&sync_deadline, fd_output->sync_interval);
+        if (!aushape_flusher_time_before(now, &sync_deadline)) {
+            /* Synchronize without blocking the writer */
+            if (aushape_fd_output_flush(fd_output) == AUSHAPE_RC_OK) {
+                fd_output->unsynced = 0;
+                aushape_flusher_unlock(&fd_output->flusher);
+                failed = fdatasync(fd_output->fd) < 0 &&
+                         errno != EINVAL && errno != EROFS;
+                aushape_flusher_lock(&fd_output->flusher);
+                if (failed) {
+                    fd_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+                }
+            }
+            return;
+        }
+    }
+    aushape_fd_output_flush(fd_output);
+}
+
+static void aushape_fd_output_cleanup(struct aushape_output *output);
+
 static enum aushape_rc
 aushape_fd_output_init(struct aushape_output *output, va_list ap)
 {
     struct aushape_fd_output *fd_output = (struct aushape_fd_output*)output;
     int fd = va_arg(ap, int);
     bool fd_owned = (bool)va_arg(ap, int);
+    size_t buf_size = va_arg(ap, size_t);
+    unsigned int max_latency = va_arg(ap, unsigned int);
+    unsigned int sync_interval = va_arg(ap, unsigned int);
+    size_t sync_size = va_arg(ap, size_t);
+    enum aushape_rc rc;
 
     assert(fd_output != NULL);
 
@@ -44,9 +255,33 @@ aushape_fd_output_init(struct aushape_output *output, va_list ap)
     }
 
     fd_output->fd = fd;
+    fd_output->rc = AUSHAPE_RC_OK;
+    fd_output->sync_size = sync_size;
+
+    if (buf_size > 0) {
+        fd_output->buf = malloc(buf_size);
+        AUSHAPE_GUARD_BOOL(NOMEM, fd_output->buf != NULL);
+        fd_output->buf_size = buf_size;
+    }
+
+    /* Start the flusher, if the buffering or unsynced time is limited */
+    if ((buf_size > 0 && max_latency > 0) || sync_interval > 0) {
+        fd_output->max_latency = buf_size > 0 ? max_latency : 0;
+        fd_output->sync_interval = sync_interval;
+        AUSHAPE_GUARD(aushape_flusher_start(&fd_output->flusher,
+                                            aushape_fd_output_flusher_due,
+                                            aushape_fd_output_flusher_flush,
+                                            fd_output));
+    }
+
     fd_output->fd_owned = fd_owned;
 
-    return AUSHAPE_RC_OK;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_fd_output_cleanup(output);
+    }
+    return rc;
 }
 
 static bool
@@ -55,7 +290,11 @@ aushape_fd_output_is_valid(const struct aushape_output *output)
     struct aushape_fd_output *fd_output = (struct aushape_fd_output*)output;
     assert(fd_output != NULL);
 
-    return fd_output->fd >= 0;
+    return fd_output->fd >= 0 &&
+           (fd_output->buf_size == 0 || fd_output->buf != NULL) &&
+           ((fd_output->max_latency == 0 &&
+             fd_output->sync_interval == 0) ||
+            aushape_flusher_is_started(&fd_output->flusher));
 }
 
 static void
@@ -64,6 +303,16 @@ aushape_fd_output_cleanup(struct aushape_output *output)
     struct aushape_fd_output *fd_output = (struct aushape_fd_output*)output;
     assert(fd_output != NULL);
 
+    aushape_flusher_stop(&fd_output->flusher);
+
+    /* Try to write and synchronize the remaining output */
+    if (aushape_fd_output_flush(fd_output) == AUSHAPE_RC_OK) {
+        aushape_fd_output_datasync(fd_output);
+    }
+    free(fd_output->buf);
+    fd_output->buf = NULL;
+    fd_output->buf_size = 0;
+
     if (fd_output->fd_owned) {
         close(fd_output->fd);
         fd_output->fd = -1;
@@ -77,25 +326,83 @@ aushape_fd_output_write(struct aushape_output *output,
                         size_t len)
 {
     struct aushape_fd_output *fd_output = (struct aushape_fd_output*)output;
-    ssize_t rc;
+    struct iovec iov[2];
+    enum aushape_rc rc;
 
     assert(fd_output != NULL);
 
-    while (true) {
-        rc = write(fd_output->fd, ptr, len);
-        if (rc < 0) {
-            if (errno == EINTR) {
-                continue;
-            } else {
-                return AUSHAPE_RC_OUTPUT_WRITE_FAILED;
-            }
+    if (len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+
+    aushape_flusher_lock(&fd_output->flusher);
+    AUSHAPE_GUARD(fd_output->rc);
+    /* Account for the piece to be synchronized, if requested */
+    if (fd_output->sync_interval > 0 || fd_output->sync_size > 0) {
+        if (fd_output->unsynced == 0 &&
+            aushape_flusher_is_started(&fd_output->flusher)) {
+            clock_gettime(CLOCK_MONOTONIC, &fd_output->unsynced_time);
+            aushape_flusher_signal(&fd_output->flusher);
         }
-        if ((size_t)rc == len) {
-            return AUSHAPE_RC_OK;
+        fd_output->unsynced += len;
+    }
+    if (len <= fd_output->buf_size - fd_output->buf_len) {
+        /* Accumulate the piece, and write once the buffer is full */
+        if (fd_output->buf_len == 0 &&
+            aushape_flusher_is_started(&fd_output->flusher)) {
+            clock_gettime(CLOCK_MONOTONIC, &fd_output->buf_time);
+            aushape_flusher_signal(&fd_output->flusher);
+        }
+        memcpy(fd_output->buf + fd_output->buf_len, ptr, len);
+        fd_output->buf_len += len;
+        if (fd_output->buf_len == fd_output->buf_size) {
+            AUSHAPE_GUARD(aushape_fd_output_flush(fd_output));
+        }
+    } else {
+        /* Write the buffer and the piece in one go */
+        iov[0].iov_base = fd_output->buf;
+        iov[0].iov_len = fd_output->buf_len;
+        iov[1].iov_base = (void *)ptr;
+        iov[1].iov_len = len;
+        fd_output->rc = (fd_output->buf_len > 0)
+                            ? aushape_fd_output_writev(fd_output, iov, 2)
+                            : aushape_fd_output_writev(fd_output, iov + 1, 1);
+        fd_output->buf_len = 0;
+        AUSHAPE_GUARD(fd_output->rc);
+    }
+    /* Synchronize once enough output accumulates */
+    if (fd_output->sync_size > 0 &&
+        fd_output->unsynced >= fd_output->sync_size) {
+        AUSHAPE_GUARD(aushape_fd_output_flush(fd_output));
+        AUSHAPE_GUARD(aushape_fd_output_datasync(fd_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_flusher_unlock(&fd_output->flusher);
+    return rc;
+}
+
+static enum aushape_rc
+aushape_fd_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_fd_output *fd_output = (struct aushape_fd_output*)output;
+    enum aushape_rc rc;
+
+    assert(fd_output != NULL);
+
+    aushape_flusher_lock(&fd_output->flusher);
+    /* Keep buffering between documents, unless flushed explicitly */
+    if (full) {
+        rc = aushape_fd_output_flush(fd_output);
+        if (rc == AUSHAPE_RC_OK) {
+            rc = aushape_fd_output_datasync(fd_output);
         }
-        ptr += rc;
-        len -= (size_t)rc;
+    } else {
+        rc = fd_output->rc;
     }
+    aushape_flusher_unlock(&fd_output->flusher);
+    return rc;
 }
 
 const struct aushape_output_type aushape_fd_output_type = {
@@ -104,5 +411,6 @@ const struct aushape_output_type aushape_fd_output_type = {
     .init       = aushape_fd_output_init,
     .is_valid   = aushape_fd_output_is_valid,
     .write      = aushape_fd_output_write,
+    .sync       = aushape_fd_output_sync,
     .cleanup    = aushape_fd_output_cleanup,
 };
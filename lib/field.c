@@ -20,6 +20,7 @@
 
 #include <config.h>
 #include <aushape/field.h>
+#include <aushape/emitter.h>
 #include <aushape/guard.h>
 #include <string.h>
 
@@ -33,106 +34,139 @@ aushape_field_format_props(struct aushape_gbuf *gbuf,
                            const char *value_r,
                            const char *value_i)
 {
-    enum aushape_rc rc;
-
     if (!aushape_gbuf_is_valid(gbuf) ||
         !aushape_format_is_valid(format) ||
         name == NULL) {
-        rc = AUSHAPE_RC_INVALID_ARGS;
-        goto cleanup;
+        return AUSHAPE_RC_INVALID_ARGS;
     }
 
-    switch (format->lang) {
-    case AUSHAPE_LANG_XML:
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, level));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '<'));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, name));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, " i=\""));
-        AUSHAPE_GUARD(aushape_gbuf_add_str_xml(gbuf, value_i));
-        if (value_r != NULL) {
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\" r=\""));
-            AUSHAPE_GUARD(aushape_gbuf_add_str_xml(gbuf, value_r));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\"/>"));
-        break;
-    case AUSHAPE_LANG_JSON:
-        if (!first) {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, level));
-        if (list) {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '['));
-        } else {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, name));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\":["));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-        AUSHAPE_GUARD(aushape_gbuf_add_str_json(gbuf, value_i));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-        if (value_r != NULL) {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-            AUSHAPE_GUARD(aushape_gbuf_add_str_json(gbuf, value_r));
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
+    return aushape_emitter_get(format)->field_props(gbuf, format, level,
+                                                    first, list, name,
+                                                    value_r, value_i);
+}
+
+enum aushape_field_kind
+aushape_field_get_kind(auparse_state_t *au)
+{
+    const char *name;
+    const struct aushape_field_def *def;
+
+    assert(au != NULL);
+
+    name = auparse_get_field_name(au);
+    if (name != NULL) {
+        def = aushape_field_def_lookup(name);
+        if (def != NULL) {
+            return def->kind;
         }
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ']'));
-        break;
-    default:
-        break;
     }
 
-    rc = AUSHAPE_RC_OK;
-cleanup:
-    return rc;
+    switch (auparse_get_field_type(au)) {
+    case AUPARSE_TYPE_UID:
+    case AUPARSE_TYPE_GID:
+    case AUPARSE_TYPE_SYSCALL:
+    case AUPARSE_TYPE_EXIT:
+    case AUPARSE_TYPE_SESSION:
+        return AUSHAPE_FIELD_KIND_INT;
+    case AUPARSE_TYPE_SUCCESS:
+        return AUSHAPE_FIELD_KIND_BOOL;
+    default:
+        return AUSHAPE_FIELD_KIND_STR;
+    }
 }
 
 enum aushape_rc
-aushape_field_format(struct aushape_gbuf *gbuf,
-                     const struct aushape_format *format,
-                     size_t level,
-                     bool first,
-                     bool list,
-                     const char *name,
-                     auparse_state_t *au)
+aushape_field_get_values(auparse_state_t *au,
+                         const char **pvalue_r,
+                         const char **pvalue_i,
+                         bool *pwith_raw)
 {
     enum aushape_rc rc;
     int type;
     const char *value_r;
     const char *value_i;
 
-    if (!aushape_gbuf_is_valid(gbuf) ||
-        !aushape_format_is_valid(format) ||
-        name == NULL ||
-        au == NULL) {
-        rc = AUSHAPE_RC_INVALID_ARGS;
-        goto cleanup;
-    }
+    assert(au != NULL);
+    assert(pvalue_r != NULL);
+    assert(pvalue_i != NULL);
+    assert(pwith_raw != NULL);
 
     type = auparse_get_field_type(au);
     value_i = auparse_interpret_field(au);
     AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, value_i != NULL);
+    value_r = auparse_get_field_str(au);
+    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, value_r != NULL);
 
     switch (type) {
     case AUPARSE_TYPE_ESCAPED:
 #if HAVE_DECL_AUPARSE_TYPE_ESCAPED_KEY
     case AUPARSE_TYPE_ESCAPED_KEY:
 #endif
-        value_r = NULL;
+        *pwith_raw = false;
         break;
     default:
-        value_r = auparse_get_field_str(au);
-        AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, value_r != NULL);
-        if (strcmp(value_r, value_i) == 0) {
-            value_r = NULL;
-        }
+        *pwith_raw = strcmp(value_r, value_i) != 0;
         break;
     }
 
-    AUSHAPE_GUARD(aushape_field_format_props(gbuf, format, level, first,
-                                             list, name, value_r, value_i));
+    *pvalue_r = value_r;
+    *pvalue_i = value_i;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_field_add_to_pool(struct aushape_itree_pool *pool,
+                          const char *name,
+                          enum aushape_field_kind kind,
+                          auparse_state_t *au)
+{
+    enum aushape_rc rc;
+    struct aushape_itree_field field = {.kind = kind};
+    const char *value_r;
+    const char *value_i;
+
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(name != NULL);
+    assert(au != NULL);
+
+    AUSHAPE_GUARD(aushape_field_get_values(au, &value_r, &value_i,
+                                           &field.with_raw));
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, name, &field.name));
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, value_i, &field.value_i));
+    if (strcmp(value_r, value_i) == 0) {
+        field.value_r = field.value_i;
+    } else {
+        AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, value_r,
+                                                 &field.value_r));
+    }
+    AUSHAPE_GUARD(aushape_itree_pool_add_field(pool, &field));
 
     rc = AUSHAPE_RC_OK;
 cleanup:
     return rc;
 }
+
+enum aushape_rc
+aushape_field_format(struct aushape_gbuf *gbuf,
+                     const struct aushape_format *format,
+                     size_t level,
+                     bool first,
+                     bool list,
+                     const char *name,
+                     const struct aushape_itree_pool *pool,
+                     const struct aushape_itree_field *field)
+{
+    if (!aushape_gbuf_is_valid(gbuf) ||
+        !aushape_format_is_valid(format) ||
+        name == NULL ||
+        !aushape_itree_pool_is_valid(pool) ||
+        field == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    return aushape_emitter_get(format)->field(gbuf, format, level,
+                                              first, list, name,
+                                              pool, field);
+}
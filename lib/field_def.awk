@@ -0,0 +1,95 @@
+#
+# Generate known record field definitions from the aushape JSON schema.
+#
+# Usage: LC_ALL=C awk -f field_def.awk aushape.schema.json > field_def_list.c
+#
+# Every property of the "generic_fields" definition in the schema gets an
+# entry, sorted by name, with its value kind taken from the referenced field
+# definition: "int_field", "bool_field", or plain "field" for strings.
+#
+# Copyright (C) 2016 Red Hat
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+function fail(msg) {
+    print "field_def.awk: " FILENAME ":" FNR ": " msg > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+/"generic_fields": *\{/ {
+    in_fields = 1
+    next
+}
+
+in_fields && /"additionalProperties"/ {
+    in_fields = 0
+    next
+}
+
+in_fields && /"\$ref": *"#\/definitions\/[a-z_]*field"/ {
+    if (match($0, /"[^"]*"/) == 0) {
+        fail("field name not found")
+    }
+    name = substr($0, RSTART + 1, RLENGTH - 2)
+    # Names are output verbatim as C strings, so must need no escaping
+    if (name !~ /^[a-z0-9_-]+$/) {
+        fail("unsupported field name \"" name "\"")
+    }
+    if ($0 ~ /"#\/definitions\/int_field"/) {
+        kind = "AUSHAPE_FIELD_KIND_INT"
+    } else if ($0 ~ /"#\/definitions\/bool_field"/) {
+        kind = "AUSHAPE_FIELD_KIND_BOOL"
+    } else if ($0 ~ /"#\/definitions\/field"/) {
+        kind = "AUSHAPE_FIELD_KIND_STR"
+    } else {
+        fail("unknown field definition for \"" name "\"")
+    }
+    for (i = num; i > 0 && list[i] > name; i--) {
+        list[i + 1] = list[i]
+        kinds[i + 1] = kinds[i]
+    }
+    if (i > 0 && list[i] == name) {
+        fail("duplicate field name \"" name "\"")
+    }
+    list[i + 1] = name
+    kinds[i + 1] = kind
+    num++
+}
+
+END {
+    if (failed) {
+        exit 1
+    }
+    if (num == 0) {
+        fail("no fields found")
+    }
+
+    print "/*"
+    print " * Known record field definitions."
+    print " *"
+    print " * Generated by field_def.awk from aushape.schema.json, do not edit."
+    print " */"
+    print ""
+    print "#include <aushape/field_def.h>"
+    print ""
+    print "const struct aushape_field_def aushape_field_def_list[] = {"
+    for (i = 1; i <= num; i++) {
+        printf "    {.name = %-28s .kind = %s},\n", "\"" list[i] "\",", kinds[i]
+    }
+    print "};"
+    print ""
+    print "const size_t aushape_field_def_num = " num ";"
+}
@@ -0,0 +1,242 @@
+/*
+ * Known record field definitions.
+ *
+ * Generated by field_def.awk from aushape.schema.json, do not edit.
+ */
+
+#include <aushape/field_def.h>
+
+const struct aushape_field_def aushape_field_def_list[] = {
+    {.name = "a0",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "a1",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "a2",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "a3",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "acct",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "acl",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "action",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "added",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "addr",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "algo",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "apparmor",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "arch",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "argc",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "audit_backlog_limit",       .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "audit_backlog_wait_time",   .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "audit_enabled",             .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "audit_failure",             .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "auid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "banners",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "bool",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "bus",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cap_fe",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cap_fi",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cap_fp",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cap_fver",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cap_pe",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cap_pi",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cap_pp",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "capability",                .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "category",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cgroup",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "changed",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cipher",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "class",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cmd",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "code",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "comm",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "compat",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "cwd",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "daddr",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "data",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "default-context",           .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "dest",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "dev",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "device",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "dir",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "direction",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "dmac",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "dport",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "egid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "enforcing",                 .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "entries",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "euid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "exe",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "exit",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "fam",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "family",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "fd",                        .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "fe",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "feature",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "fi",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "file",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "flags",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "format",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "fp",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "fsgid",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "fsuid",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "fver",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "gid",                       .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "grantors",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "grp",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "hook",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "hostname",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "icmp_type",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "id",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "igid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "img-ctx",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "inif",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ino",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "inode",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "inode_gid",                 .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "inode_uid",                 .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "invalid_context",           .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ioctlcmd",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ip",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ipid",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ipx-net",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "items",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "iuid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "kernel",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "key",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "kind",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ksize",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "laddr",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "len",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "list",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "lport",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "mac",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "macproto",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "maj",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "major",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "minor",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "mode",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "model",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "msg",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "name",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "nametype",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "nargs",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "net",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-chardev",               .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-disk",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-enabled",               .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-fs",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-level",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-log_passwd",            .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-mem",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-net",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-range",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-rng",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-role",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-seuser",                .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new-vcpu",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new_gid",                   .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "new_lock",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new_pe",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new_pi",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "new_pp",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "nlnk-fam",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "nlnk-grp",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "nlnk-pid",                  .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "oauid",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "obj",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "obj_gid",                   .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "obj_uid",                   .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "objtype",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ocomm",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "oflag",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ogid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "old",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-auid",                  .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "old-chardev",               .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-disk",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-enabled",               .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-fs",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-level",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-log_passwd",            .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-mem",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-net",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-range",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-rng",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-role",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-ses",                   .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "old-seuser",                .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old-vcpu",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old_enforcing",             .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "old_lock",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old_pe",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old_pi",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old_pp",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old_prom",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "old_val",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "op",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "opid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "oses",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "ouid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "outif",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "parent",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "path",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "per",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "perm",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "perm_mask",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "permissive",                .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "pfs",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "pid",                       .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "ppid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "printer",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "proctitle",                 .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "prom",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "proto",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "qbytes",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "range",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "rdev",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "reason",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "removed",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "res",                       .kind = AUSHAPE_FIELD_KIND_BOOL},
+    {.name = "resrc",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "result",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "role",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "rport",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "saddr",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "sauid",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "scontext",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "selected-context",          .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "seperm",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "seperms",                   .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "seqno",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "seresult",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ses",                       .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "seuser",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "sgid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "sig",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "sigev_signo",               .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "size",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "smac",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "spid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "sport",                     .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "state",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "subj",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "success",                   .kind = AUSHAPE_FIELD_KIND_BOOL},
+    {.name = "suid",                      .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "syscall",                   .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "table",                     .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "tclass",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "tcontext",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "terminal",                  .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "tty",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "type",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "uid",                       .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "unit",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "uri",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "user",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "uuid",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "val",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "ver",                       .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "virt",                      .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "vm",                        .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "vm-ctx",                    .kind = AUSHAPE_FIELD_KIND_STR},
+    {.name = "vm-pid",                    .kind = AUSHAPE_FIELD_KIND_INT},
+    {.name = "watch",                     .kind = AUSHAPE_FIELD_KIND_STR},
+};
+
+const size_t aushape_field_def_num = 230;
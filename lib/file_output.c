@@ -0,0 +1,391 @@
+/*
+ * Rotating file aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/file_output.h>
+#include <aushape/fd_output.h>
+#include <aushape/guard.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Maximum number of attempts to find a free name for a rotated file */
+#define AUSHAPE_FILE_OUTPUT_ROTATE_ATTEMPTS 1000
+
+/** Rotating file output data */
+struct aushape_file_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    char *path;                     /**< Path to the file */
+    size_t buf_size;                /**< FD output buffer size */
+    unsigned int max_latency;       /**< FD output buffering time */
+    unsigned int sync_interval;     /**< FD output unsynced time */
+    size_t sync_size;               /**< FD output unsynced size */
+    uint64_t rotate_size;           /**< Size to rotate at, or zero */
+    unsigned int rotate_time;       /**< Age to rotate at, s, or zero */
+    size_t prealloc;                /**< Space to preallocate, or zero */
+    int dir_fd;                     /**< Directory FD if rotating, or -1 */
+    int fd;                         /**< File FD, or -1 */
+    struct aushape_output *inner;   /**< FD output writing the file */
+    uint64_t size;                  /**< Size of the file */
+    /** Monotonic time the file was opened at */
+    struct timespec open_time;
+};
+
+/**
+ * Open a new file and an FD output for it.
+ *
+ * @param file_output   The file output to open the file for.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - opened successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - opening failed.
+ */
+static enum aushape_rc
+aushape_file_output_open(struct aushape_file_output *file_output)
+{
+    enum aushape_rc rc;
+
+    assert(file_output != NULL);
+    assert(file_output->fd < 0);
+    assert(file_output->inner == NULL);
+
+    file_output->fd = open(file_output->path,
+                           O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC,
+                           S_IRUSR | S_IRGRP | S_IROTH |
+                           S_IWUSR | S_IWGRP | S_IWOTH);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, file_output->fd >= 0);
+#ifdef FALLOC_FL_KEEP_SIZE
+    /* Preallocation is only advisory, ignore failures */
+    if (file_output->prealloc > 0) {
+        (void)fallocate(file_output->fd, FALLOC_FL_KEEP_SIZE,
+                        0, (off_t)file_output->prealloc);
+    }
+#endif
+    AUSHAPE_GUARD(aushape_fd_output_create_synced(
+                                        &file_output->inner,
+                                        file_output->fd, false,
+                                        file_output->buf_size,
+                                        file_output->max_latency,
+                                        file_output->sync_interval,
+                                        file_output->sync_size));
+    file_output->size = 0;
+    clock_gettime(CLOCK_MONOTONIC, &file_output->open_time);
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Write out, synchronize, and close the file and its FD output, if open.
+ *
+ * @param file_output   The file output to close the file of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - closed successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - writing or closing failed.
+ */
+static enum aushape_rc
+aushape_file_output_close(struct aushape_file_output *file_output)
+{
+    enum aushape_rc rc = AUSHAPE_RC_OK;
+
+    assert(file_output != NULL);
+
+    if (file_output->inner != NULL) {
+        rc = aushape_output_sync(file_output->inner, true);
+        aushape_output_destroy(file_output->inner);
+        file_output->inner = NULL;
+    }
+    if (file_output->fd >= 0) {
+        /* Release the preallocated space past the end */
+        if (file_output->prealloc > 0 &&
+            ftruncate(file_output->fd, (off_t)file_output->size) < 0 &&
+            rc == AUSHAPE_RC_OK) {
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+        /* Make sure complete files survive crashes after renaming */
+        if (fdatasync(file_output->fd) < 0 &&
+            errno != EINVAL && errno != EROFS && rc == AUSHAPE_RC_OK) {
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+        if (close(file_output->fd) < 0 && rc == AUSHAPE_RC_OK) {
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+        file_output->fd = -1;
+    }
+    return rc;
+}
+
+/**
+ * Rename the file at the path of a file output to a free name with a suffix
+ * of the current UTC time, and synchronize the directory, so the rename
+ * survives crashes.
+ *
+ * @param file_output   The file output to rename the file of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - renamed successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - renaming failed.
+ */
+static enum aushape_rc
+aushape_file_output_rename(struct aushape_file_output *file_output)
+{
+    enum aushape_rc rc;
+    time_t now = time(NULL);
+    struct tm tm;
+    char stamp[32];
+    size_t size;
+    char *name = NULL;
+    size_t len;
+    struct stat st;
+    unsigned int i;
+
+    assert(file_output != NULL);
+    assert(file_output->dir_fd >= 0);
+
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                       gmtime_r(&now, &tm) != NULL &&
+                       strftime(stamp, sizeof(stamp),
+                                "%Y%m%dT%H%M%SZ", &tm) > 0);
+    size = strlen(file_output->path) + 1 + strlen(stamp) + 16;
+    name = malloc(size);
+    AUSHAPE_GUARD_BOOL(NOMEM, name != NULL);
+    len = (size_t)snprintf(name, size, "%s.%s", file_output->path, stamp);
+
+    /* Find a free name, in case of a rotation within the same second */
+    for (i = 1; lstat(name, &st) == 0; i++) {
+        AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                           i < AUSHAPE_FILE_OUTPUT_ROTATE_ATTEMPTS);
+        snprintf(name + len, size - len, ".%03u", i);
+    }
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, errno == ENOENT);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                       rename(file_output->path, name) == 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                       fsync(file_output->dir_fd) == 0 ||
+                       errno == EINVAL || errno == EROFS);
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    free(name);
+    return rc;
+}
+
+/**
+ * Rotate the file of a file output: write out, synchronize, and close it,
+ * rename it, and open a new one.
+ *
+ * @param file_output   The file output to rotate the file of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - rotated successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - rotation failed.
+ */
+static enum aushape_rc
+aushape_file_output_rotate(struct aushape_file_output *file_output)
+{
+    enum aushape_rc rc;
+
+    assert(file_output != NULL);
+
+    AUSHAPE_GUARD(aushape_file_output_close(file_output));
+    AUSHAPE_GUARD(aushape_file_output_rename(file_output));
+    rc = aushape_file_output_open(file_output);
+    if (rc == AUSHAPE_RC_OUTPUT_INIT_FAILED) {
+        rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+    }
+cleanup:
+    return rc;
+}
+
+static void aushape_file_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_file_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_file_output *file_output =
+                                    (struct aushape_file_output *)output;
+    const char *path = va_arg(ap, const char *);
+    size_t buf_size = va_arg(ap, size_t);
+    unsigned int max_latency = va_arg(ap, unsigned int);
+    unsigned int sync_interval = va_arg(ap, unsigned int);
+    size_t sync_size = va_arg(ap, size_t);
+    uint64_t rotate_size = va_arg(ap, uint64_t);
+    unsigned int rotate_time = va_arg(ap, unsigned int);
+    size_t prealloc = va_arg(ap, size_t);
+    struct stat st;
+    const char *slash;
+    char *dir;
+    enum aushape_rc rc;
+    int errno_saved;
+
+    assert(file_output != NULL);
+
+    if (path == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    file_output->dir_fd = -1;
+    file_output->fd = -1;
+    file_output->buf_size = buf_size;
+    file_output->max_latency = max_latency;
+    file_output->sync_interval = sync_interval;
+    file_output->sync_size = sync_size;
+    file_output->rotate_size = rotate_size;
+    file_output->rotate_time = rotate_time;
+    file_output->prealloc = prealloc;
+    file_output->path = strdup(path);
+    AUSHAPE_GUARD_BOOL(NOMEM, file_output->path != NULL);
+
+    /* Open the directory to synchronize renames in, if rotating */
+    if (rotate_size > 0 || rotate_time > 0) {
+        slash = strrchr(path, '/');
+        if (slash == NULL) {
+            dir = strdup(".");
+        } else {
+            dir = strndup(path, slash == path ? 1 : (size_t)(slash - path));
+        }
+        AUSHAPE_GUARD_BOOL(NOMEM, dir != NULL);
+        file_output->dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        free(dir);
+        AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, file_output->dir_fd >= 0);
+    }
+
+    /* Keep a file left from before, if rotating */
+    if (file_output->dir_fd >= 0 &&
+        stat(path, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        rc = aushape_file_output_rename(file_output);
+        if (rc == AUSHAPE_RC_OUTPUT_WRITE_FAILED) {
+            rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        }
+        if (rc != AUSHAPE_RC_OK) {
+            goto cleanup;
+        }
+    }
+    AUSHAPE_GUARD(aushape_file_output_open(file_output));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        errno_saved = errno;
+        aushape_file_output_cleanup(output);
+        errno = errno_saved;
+    }
+    return rc;
+}
+
+static bool
+aushape_file_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_file_output *file_output =
+                                    (struct aushape_file_output *)output;
+    assert(file_output != NULL);
+
+    return file_output->path != NULL &&
+           file_output->fd >= 0 &&
+           aushape_output_is_valid(file_output->inner);
+}
+
+static void
+aushape_file_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_file_output *file_output =
+                                    (struct aushape_file_output *)output;
+    assert(file_output != NULL);
+
+    aushape_file_output_close(file_output);
+    if (file_output->dir_fd >= 0) {
+        close(file_output->dir_fd);
+        file_output->dir_fd = -1;
+    }
+    free(file_output->path);
+    file_output->path = NULL;
+}
+
+static enum aushape_rc
+aushape_file_output_write(struct aushape_output *output,
+                          const char *ptr,
+                          size_t len)
+{
+    struct aushape_file_output *file_output =
+                                    (struct aushape_file_output *)output;
+    enum aushape_rc rc;
+
+    assert(file_output != NULL);
+
+    rc = aushape_output_write(file_output->inner, ptr, len);
+    if (rc == AUSHAPE_RC_OK) {
+        file_output->size += len;
+    }
+    return rc;
+}
+
+static enum aushape_rc
+aushape_file_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_file_output *file_output =
+                                    (struct aushape_file_output *)output;
+    enum aushape_rc rc;
+    struct timespec now;
+
+    assert(file_output != NULL);
+
+    AUSHAPE_GUARD(aushape_output_sync(file_output->inner, full));
+
+    /* Rotate at the document boundary, if it's time */
+    if (file_output->size == 0) {
+        return AUSHAPE_RC_OK;
+    }
+    if (file_output->rotate_size > 0 &&
+        file_output->size >= file_output->rotate_size) {
+        return aushape_file_output_rotate(file_output);
+    }
+    if (file_output->rotate_time > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec - file_output->open_time.tv_sec >=
+                (time_t)file_output->rotate_time) {
+            return aushape_file_output_rotate(file_output);
+        }
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+const struct aushape_output_type aushape_file_output_type = {
+    .size       = sizeof(struct aushape_file_output),
+    .cont       = true,
+    .init       = aushape_file_output_init,
+    .is_valid   = aushape_file_output_is_valid,
+    .write      = aushape_file_output_write,
+    .sync       = aushape_file_output_sync,
+    .cleanup    = aushape_file_output_cleanup,
+};
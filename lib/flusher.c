@@ -0,0 +1,161 @@
+/*
+ * Output flusher thread and monotonic time helpers.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/flusher.h>
+#include <aushape/guard.h>
+#include <stdint.h>
+#include <string.h>
+
+void
+aushape_flusher_time_add(struct timespec *ptime, unsigned int msec)
+{
+    assert(ptime != NULL);
+    ptime->tv_sec += msec / 1000;
+    ptime->tv_nsec += (long)(msec % 1000) * 1000000;
+    if (ptime->tv_nsec >= 1000000000) {
+        ptime->tv_sec++;
+        ptime->tv_nsec -= 1000000000;
+    }
+}
+
+bool
+aushape_flusher_time_before(const struct timespec *a,
+                            const struct timespec *b)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+    return a->tv_sec < b->tv_sec ||
+           (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+int
+aushape_flusher_time_left(const struct timespec *time)
+{
+    struct timespec now;
+    long long left;
+
+    if (time == NULL) {
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    left = ((long long)time->tv_sec - now.tv_sec) * 1000 +
+           (time->tv_nsec - now.tv_nsec + 999999) / 1000000;
+    return left <= 0 ? 0 : (left > INT32_MAX ? INT32_MAX : (int)left);
+}
+
+/**
+ * Run a flusher: flush the output once each pending flush comes due,
+ * until stopped.
+ *
+ * @param arg   The flusher to run.
+ *
+ * @return NULL.
+ */
+static void *
+aushape_flusher_run(void *arg)
+{
+    struct aushape_flusher *flusher = (struct aushape_flusher *)arg;
+    struct timespec deadline;
+    struct timespec now;
+
+    pthread_mutex_lock(&flusher->mutex);
+    while (!flusher->stop) {
+        if (!flusher->due(flusher->data, &deadline)) {
+            pthread_cond_wait(&flusher->cond, &flusher->mutex);
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (aushape_flusher_time_before(&now, &deadline)) {
+            pthread_cond_timedwait(&flusher->cond, &flusher->mutex,
+                                   &deadline);
+        } else {
+            flusher->flush(flusher->data, &now);
+        }
+    }
+    pthread_mutex_unlock(&flusher->mutex);
+
+    return NULL;
+}
+
+enum aushape_rc
+aushape_flusher_start(struct aushape_flusher *flusher,
+                      aushape_flusher_due_fn due,
+                      aushape_flusher_flush_fn flush,
+                      void *data)
+{
+    pthread_condattr_t condattr;
+    enum aushape_rc rc;
+
+    assert(flusher != NULL);
+    assert(!flusher->init);
+    assert(due != NULL);
+    assert(flush != NULL);
+
+    flusher->due = due;
+    flusher->flush = flush;
+    flusher->data = data;
+
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_mutex_init(&flusher->mutex, NULL) == 0);
+    if (pthread_condattr_init(&condattr) != 0) {
+        pthread_mutex_destroy(&flusher->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    if (pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC) != 0 ||
+        pthread_cond_init(&flusher->cond, &condattr) != 0) {
+        pthread_condattr_destroy(&condattr);
+        pthread_mutex_destroy(&flusher->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    pthread_condattr_destroy(&condattr);
+    flusher->init = true;
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_create(&flusher->thread, NULL,
+                                      aushape_flusher_run, flusher) == 0);
+    flusher->run = true;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_flusher_stop(flusher);
+    }
+    return rc;
+}
+
+void
+aushape_flusher_stop(struct aushape_flusher *flusher)
+{
+    assert(flusher != NULL);
+
+    if (flusher->run) {
+        pthread_mutex_lock(&flusher->mutex);
+        flusher->stop = true;
+        pthread_cond_signal(&flusher->cond);
+        pthread_mutex_unlock(&flusher->mutex);
+        pthread_join(flusher->thread, NULL);
+    }
+    if (flusher->init) {
+        pthread_cond_destroy(&flusher->cond);
+        pthread_mutex_destroy(&flusher->mutex);
+    }
+    memset(flusher, 0, sizeof(*flusher));
+}
@@ -28,6 +28,7 @@ bool
 aushape_garr_is_valid(const struct aushape_garr *garr)
 {
     return garr != NULL &&
+           aushape_mem_is_valid(garr->mem) &&
            garr->item_size != 0 &&
            garr->init_alloc_len != 0 &&
            (garr->alloc_len == 0 ||
@@ -38,14 +39,17 @@ aushape_garr_is_valid(const struct aushape_garr *garr)
 void
 aushape_garr_init(struct aushape_garr *garr,
                   size_t item_size,
-                  size_t alloc_len)
+                  size_t alloc_len,
+                  const struct aushape_mem *mem)
 {
     assert(garr != NULL);
     assert(item_size != 0);
     assert(alloc_len != 0);
+    assert(aushape_mem_is_valid(mem));
     memset(garr, 0, sizeof(*garr));
     garr->item_size = item_size;
     garr->init_alloc_len = alloc_len;
+    garr->mem = mem;
     assert(aushape_garr_is_valid(garr));
 }
 
@@ -53,7 +57,7 @@ void
 aushape_garr_cleanup(struct aushape_garr *garr)
 {
     assert(aushape_garr_is_valid(garr));
-    free(garr->ptr);
+    aushape_mem_free(garr->mem, garr->ptr);
     memset(garr, 0, sizeof(*garr));
 }
 
@@ -85,10 +89,14 @@ aushape_garr_accomodate(struct aushape_garr *garr, size_t len)
         while (new_alloc_len < len) {
             new_alloc_len *= 2;
         }
-        new_ptr = realloc(garr->ptr, garr->item_size * new_alloc_len);
+        new_ptr = aushape_mem_realloc(garr->mem, garr->ptr,
+                                      garr->item_size * new_alloc_len);
         AUSHAPE_GUARD_BOOL(NOMEM, new_ptr != NULL);
         garr->ptr = new_ptr;
         garr->alloc_len = new_alloc_len;
+        if (new_alloc_len > garr->peak_alloc_len) {
+            garr->peak_alloc_len = new_alloc_len;
+        }
     }
 
     rc = AUSHAPE_RC_OK;
@@ -96,6 +104,42 @@ cleanup:
     return rc;
 }
 
+void
+aushape_garr_shrink(struct aushape_garr *garr)
+{
+    size_t new_alloc_len;
+    void *new_ptr;
+
+    assert(aushape_garr_is_valid(garr));
+
+    new_alloc_len = garr->init_alloc_len;
+    while (new_alloc_len < garr->valid_len) {
+        new_alloc_len *= 2;
+    }
+
+    if (new_alloc_len < garr->alloc_len) {
+        new_ptr = aushape_mem_realloc(garr->mem, garr->ptr,
+                                      garr->item_size * new_alloc_len);
+        /* Keep the old memory if shrinking failed */
+        if (new_ptr != NULL) {
+            garr->ptr = new_ptr;
+            garr->alloc_len = new_alloc_len;
+        }
+    }
+
+    assert(aushape_garr_is_valid(garr));
+}
+
+void
+aushape_garr_get_mem_usage(const struct aushape_garr *garr,
+                           struct aushape_mem_usage *usage)
+{
+    assert(aushape_garr_is_valid(garr));
+    assert(usage != NULL);
+    usage->size += garr->item_size * garr->alloc_len;
+    usage->peak += garr->item_size * garr->peak_alloc_len;
+}
+
 enum aushape_rc
 aushape_garr_set(struct aushape_garr *garr, size_t index, const void *item)
 {
@@ -25,9 +25,59 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <inttypes.h>
+
+/**
+ * Get the tree referenced by a tree node.
+ *
+ * @param owner     The tree owning the node.
+ * @param gbnode    The tree node to get the referenced tree of.
+ *
+ * @return The referenced tree.
+ */
+static struct aushape_gbtree *
+aushape_gbnode_get_tree(const struct aushape_gbtree *owner,
+                        const struct aushape_gbnode *gbnode)
+{
+    assert(gbnode->type == AUSHAPE_GBNODE_TYPE_TREE);
+    return *(struct aushape_gbtree * const *)
+                aushape_garr_const_get(&owner->trees, gbnode->pos);
+}
+
+/**
+ * Count the nodes a head node counts: the non-empty nodes following it in
+ * the owner tree.
+ *
+ * @param owner     The tree owning the node.
+ * @param gbnode    The head node to count the nodes for.
+ *
+ * @return The number of counted nodes.
+ */
+static size_t
+aushape_gbnode_head_count(const struct aushape_gbtree *owner,
+                          const struct aushape_gbnode *gbnode)
+{
+    const struct aushape_garr *nodes = &owner->nodes;
+    size_t index;
+    size_t count = 0;
+
+    assert(gbnode->type == AUSHAPE_GBNODE_TYPE_HEAD);
+
+    index = gbnode - (const struct aushape_gbnode *)
+                        aushape_garr_const_get(nodes, 0);
+    for (index++; index < aushape_garr_get_len(nodes); index++) {
+        if (!aushape_gbnode_is_empty(owner,
+                                     aushape_garr_const_get(nodes, index))) {
+            count++;
+        }
+    }
+
+    return count;
+}
 
 bool
-aushape_gbnode_is_valid(const struct aushape_gbnode *gbnode)
+aushape_gbnode_is_valid(const struct aushape_gbtree *owner,
+                        const struct aushape_gbnode *gbnode)
 {
     if (gbnode == NULL) {
         return false;
@@ -37,90 +87,113 @@ aushape_gbnode_is_valid(const struct aushape_gbnode *gbnode)
         return true;
     }
 
-    if (!aushape_gbtree_is_valid(gbnode->owner) ||
-        gbnode->prev_index >= aushape_garr_get_len(&gbnode->owner->nodes) ||
-        gbnode->next_index >= aushape_garr_get_len(&gbnode->owner->nodes)) {
+    if (!aushape_gbtree_is_valid(owner) ||
+        gbnode->prev_index >= aushape_garr_get_len(&owner->nodes) ||
+        gbnode->next_index >= aushape_garr_get_len(&owner->nodes)) {
         return false;
     }
 
     if (gbnode->type == AUSHAPE_GBNODE_TYPE_TEXT) {
-        return gbnode->pos + gbnode->len <= gbnode->owner->text.len;
+        return (size_t)gbnode->pos + gbnode->len <= owner->text.len;
     } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_TREE) {
-        return gbnode->tree != NULL;
+        return gbnode->pos < aushape_garr_get_len(&owner->trees) &&
+               aushape_gbnode_get_tree(owner, gbnode) != NULL;
+    } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_HEAD) {
+        return gbnode->pos == AUSHAPE_MSGPACK_TYPE_ARRAY ||
+               gbnode->pos == AUSHAPE_MSGPACK_TYPE_MAP;
     }
 
     return true;
 }
 
 bool
-aushape_gbnode_is_empty(const struct aushape_gbnode *gbnode)
+aushape_gbnode_is_empty(const struct aushape_gbtree *owner,
+                        const struct aushape_gbnode *gbnode)
 {
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
     switch (gbnode->type) {
     case AUSHAPE_GBNODE_TYPE_VOID:
         return true;
     case AUSHAPE_GBNODE_TYPE_TEXT:
         return gbnode->len == 0;
     case AUSHAPE_GBNODE_TYPE_TREE:
-        return aushape_gbtree_is_empty(gbnode->tree);
+        return aushape_gbtree_is_empty(
+                        aushape_gbnode_get_tree(owner, gbnode));
+    case AUSHAPE_GBNODE_TYPE_HEAD:
+        return false;
     default:
         return true;
     }
 }
 
 bool
-aushape_gbnode_is_solid(const struct aushape_gbnode *gbnode)
+aushape_gbnode_is_solid(const struct aushape_gbtree *owner,
+                        const struct aushape_gbnode *gbnode)
 {
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
     switch (gbnode->type) {
     case AUSHAPE_GBNODE_TYPE_VOID:
         return false;
     case AUSHAPE_GBNODE_TYPE_TEXT:
         return true;
     case AUSHAPE_GBNODE_TYPE_TREE:
-        return aushape_gbtree_is_solid(gbnode->tree);
+        return aushape_gbtree_is_solid(
+                        aushape_gbnode_get_tree(owner, gbnode));
+    case AUSHAPE_GBNODE_TYPE_HEAD:
+        return true;
     default:
         return false;
     }
 }
 
 bool
-aushape_gbnode_is_atomic(struct aushape_gbnode *gbnode, bool cached)
+aushape_gbnode_is_atomic(const struct aushape_gbtree *owner,
+                         struct aushape_gbnode *gbnode,
+                         bool cached)
 {
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
 
     if (gbnode->type == AUSHAPE_GBNODE_TYPE_VOID) {
         return true;
-    } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_TEXT) {
+    } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_TEXT ||
+               gbnode->type == AUSHAPE_GBNODE_TYPE_HEAD) {
         return true;
     } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_TREE) {
-        return aushape_gbtree_is_atomic(gbnode->tree, cached);
+        return aushape_gbtree_is_atomic(
+                        aushape_gbnode_get_tree(owner, gbnode), cached);
     } else {
         return false;
     }
 }
 
 size_t
-aushape_gbnode_get_len(struct aushape_gbnode *gbnode, bool cached)
+aushape_gbnode_get_len(const struct aushape_gbtree *owner,
+                       struct aushape_gbnode *gbnode,
+                       bool cached)
 {
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
 
     if (gbnode->type == AUSHAPE_GBNODE_TYPE_TEXT) {
         return gbnode->len;
     } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_TREE) {
-        return aushape_gbtree_get_len(gbnode->tree, cached);
+        return aushape_gbtree_get_len(
+                        aushape_gbnode_get_tree(owner, gbnode), cached);
+    } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_HEAD) {
+        return aushape_gbuf_get_msgpack_head_len(
+                        gbnode->pos, aushape_gbnode_head_count(owner, gbnode));
     } else {
         return 0;
     }
 }
 
 size_t
-aushape_gbnode_trim(struct aushape_gbnode *gbnode,
+aushape_gbnode_trim(const struct aushape_gbtree *owner,
+                    struct aushape_gbnode *gbnode,
                     bool atomic_cached,
                     bool len_cached,
                     size_t len)
 {
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
 
     switch (gbnode->type) {
     case AUSHAPE_GBNODE_TYPE_VOID:
@@ -128,33 +201,42 @@ aushape_gbnode_trim(struct aushape_gbnode *gbnode,
     case AUSHAPE_GBNODE_TYPE_TEXT:
         return gbnode->len;
     case AUSHAPE_GBNODE_TYPE_TREE:
-        return aushape_gbtree_trim(gbnode->tree,
+        return aushape_gbtree_trim(aushape_gbnode_get_tree(owner, gbnode),
                                    atomic_cached, len_cached, len);
+    case AUSHAPE_GBNODE_TYPE_HEAD:
+        return aushape_gbnode_get_len(owner, gbnode, len_cached);
     default:
         return 0;
     }
 }
 
 enum aushape_rc
-aushape_gbnode_render(struct aushape_gbnode *gbnode,
+aushape_gbnode_render(const struct aushape_gbtree *owner,
+                      struct aushape_gbnode *gbnode,
                       struct aushape_gbuf *gbuf)
 {
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
     assert(aushape_gbuf_is_valid(gbuf));
 
     if (gbnode->type == AUSHAPE_GBNODE_TYPE_TEXT) {
         return aushape_gbuf_add_buf(gbuf,
-                                    gbnode->owner->text.ptr + gbnode->pos,
+                                    owner->text.ptr + gbnode->pos,
                                     gbnode->len);
     } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_TREE) {
-        return aushape_gbtree_render(gbnode->tree, gbuf);
+        return aushape_gbtree_render(
+                        aushape_gbnode_get_tree(owner, gbnode), gbuf);
+    } else if (gbnode->type == AUSHAPE_GBNODE_TYPE_HEAD) {
+        return aushape_gbuf_add_msgpack_head(
+                        gbuf, gbnode->pos,
+                        aushape_gbnode_head_count(owner, gbnode));
     } else {
         return AUSHAPE_RC_OK;
     }
 }
 
 enum aushape_rc
-aushape_gbnode_render_dump(const struct aushape_gbnode *gbnode,
+aushape_gbnode_render_dump(const struct aushape_gbtree *owner,
+                           const struct aushape_gbnode *gbnode,
                            struct aushape_gbuf *gbuf,
                            const struct aushape_format *format,
                            size_t level,
@@ -164,7 +246,7 @@ aushape_gbnode_render_dump(const struct aushape_gbnode *gbnode,
     size_t l = level;
 
     assert(aushape_gbuf_is_valid(gbuf));
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
     assert(aushape_format_is_valid(format));
 
     switch (gbnode->type) {
@@ -185,11 +267,11 @@ aushape_gbnode_render_dump(const struct aushape_gbnode *gbnode,
             AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
             AUSHAPE_GUARD(aushape_gbuf_add_fmt(
                             gbuf,
-                            "<text pos=\"%zu\" len=\"%zu\">",
+                            "<text pos=\"%" PRIu32 "\" len=\"%" PRIu32 "\">",
                             gbnode->pos, gbnode->len));
             AUSHAPE_GUARD(aushape_gbuf_add_buf_xml(
                                     gbuf, 
-                                    gbnode->owner->text.ptr + gbnode->pos,
+                                    owner->text.ptr + gbnode->pos,
                                     gbnode->len));
             AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</text>"));
         } else if (format->lang == AUSHAPE_LANG_JSON) {
@@ -205,13 +287,13 @@ aushape_gbnode_render_dump(const struct aushape_gbnode *gbnode,
             AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
             AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
             AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf,
-                                               "\"pos\":\"%zu\"",
+                                               "\"pos\":\"%" PRIu32 "\"",
                                                gbnode->pos));
 
             AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
             AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
             AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf,
-                                               "\"len\":\"%zu\"",
+                                               "\"len\":\"%" PRIu32 "\"",
                                                gbnode->len));
 
             AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
@@ -219,7 +301,7 @@ aushape_gbnode_render_dump(const struct aushape_gbnode *gbnode,
             AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\"buf\":\""));
             AUSHAPE_GUARD(aushape_gbuf_add_buf_json(
                                     gbuf, 
-                                    gbnode->owner->text.ptr + gbnode->pos,
+                                    owner->text.ptr + gbnode->pos,
                                     gbnode->len));
             AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
             l--;
@@ -228,8 +310,32 @@ aushape_gbnode_render_dump(const struct aushape_gbnode *gbnode,
         }
         break;
     case AUSHAPE_GBNODE_TYPE_TREE:
-        AUSHAPE_GUARD(aushape_gbtree_render_dump(gbnode->tree, gbuf,
-                                                 format, l, first));
+        AUSHAPE_GUARD(aushape_gbtree_render_dump(
+                                aushape_gbnode_get_tree(owner, gbnode),
+                                gbuf, format, l, first));
+        break;
+    case AUSHAPE_GBNODE_TYPE_HEAD:
+        if (format->lang == AUSHAPE_LANG_XML) {
+            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
+            AUSHAPE_GUARD(aushape_gbuf_add_fmt(
+                            gbuf, "<head of=\"%s\" count=\"%zu\"/>",
+                            gbnode->pos == AUSHAPE_MSGPACK_TYPE_MAP
+                                ? "map" : "array",
+                            aushape_gbnode_head_count(owner, gbnode)));
+        } else if (format->lang == AUSHAPE_LANG_JSON) {
+            if (!first) {
+                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
+            }
+            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
+            AUSHAPE_GUARD(aushape_gbuf_add_fmt(
+                            gbuf,
+                            "{\"type\":\"head\",\"of\":\"%s\","
+                            "\"count\":\"%zu\"}",
+                            gbnode->pos == AUSHAPE_MSGPACK_TYPE_MAP
+                                ? "map" : "array",
+                            aushape_gbnode_head_count(owner, gbnode)));
+        }
+        break;
     default:
         break;
     }
@@ -241,7 +347,8 @@ cleanup:
 }
 
 enum aushape_rc
-aushape_gbnode_print_dump_to_fd(const struct aushape_gbnode *gbnode,
+aushape_gbnode_print_dump_to_fd(const struct aushape_gbtree *owner,
+                                const struct aushape_gbnode *gbnode,
                                 int fd,
                                 enum aushape_lang lang)
 {
@@ -250,7 +357,7 @@ aushape_gbnode_print_dump_to_fd(const struct aushape_gbnode *gbnode,
     struct aushape_gbuf gbuf;
 
     assert(fd >= 0);
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
     assert(aushape_lang_is_valid(lang));
 
     format = (struct aushape_format){
@@ -259,9 +366,9 @@ aushape_gbnode_print_dump_to_fd(const struct aushape_gbnode *gbnode,
                     .nest_indent = 4,
                     .max_event_size = AUSHAPE_FORMAT_MIN_MAX_EVENT_SIZE};
 
-    aushape_gbuf_init(&gbuf, 4096);
+    aushape_gbuf_init(&gbuf, 4096, NULL);
 
-    AUSHAPE_GUARD(aushape_gbnode_render_dump(gbnode, &gbuf,
+    AUSHAPE_GUARD(aushape_gbnode_render_dump(owner, gbnode, &gbuf,
                                              &format, 0, true));
     /* TODO Handle errors */
     write(fd, gbuf.ptr, gbuf.len);
@@ -273,14 +380,15 @@ cleanup:
 }
 
 enum aushape_rc
-aushape_gbnode_print_dump_to_file(const struct aushape_gbnode *gbnode,
+aushape_gbnode_print_dump_to_file(const struct aushape_gbtree *owner,
+                                  const struct aushape_gbnode *gbnode,
                                   const char *filename,
                                   enum aushape_lang lang)
 {
     int fd;
 
     assert(filename != NULL);
-    assert(aushape_gbnode_is_valid(gbnode));
+    assert(aushape_gbnode_is_valid(owner, gbnode));
     assert(aushape_lang_is_valid(lang));
 
     /* TODO Handle errors */
@@ -290,6 +398,6 @@ aushape_gbnode_print_dump_to_file(const struct aushape_gbnode *gbnode,
               S_IRGRP | S_IWGRP |
               S_IROTH | S_IWOTH);
 
-    return aushape_gbnode_print_dump_to_fd(gbnode, fd, lang);
+    return aushape_gbnode_print_dump_to_fd(owner, gbnode, fd, lang);
 }
 
@@ -34,12 +34,14 @@ aushape_gbtree_is_valid(const struct aushape_gbtree *gbtree)
            aushape_gbuf_is_valid(&gbtree->text) &&
            aushape_garr_is_valid(&gbtree->nodes) &&
            aushape_garr_is_valid(&gbtree->prios) &&
+           aushape_garr_is_valid(&gbtree->trees) &&
            gbtree->tail <= gbtree->text.len;
 }
 
 void
 aushape_gbtree_init(struct aushape_gbtree *gbtree,
-                    size_t text_min, size_t node_min, size_t prio_min)
+                    size_t text_min, size_t node_min, size_t prio_min,
+                    const struct aushape_mem *mem)
 {
     assert(gbtree != NULL);
     assert(text_min != 0);
@@ -47,10 +49,12 @@ aushape_gbtree_init(struct aushape_gbtree *gbtree,
     assert(prio_min != 0);
 
     memset(gbtree, 0, sizeof(*gbtree));
-    aushape_gbuf_init(&gbtree->text, text_min);
+    aushape_gbuf_init(&gbtree->text, text_min, mem);
     aushape_garr_init(&gbtree->nodes,
-                      sizeof(struct aushape_gbnode), node_min);
-    aushape_garr_init(&gbtree->prios, sizeof(size_t), prio_min);
+                      sizeof(struct aushape_gbnode), node_min, mem);
+    aushape_garr_init(&gbtree->prios, sizeof(uint32_t), prio_min, mem);
+    aushape_garr_init(&gbtree->trees, sizeof(struct aushape_gbtree *),
+                      node_min, mem);
     assert(aushape_gbtree_is_valid(gbtree));
 }
 
@@ -61,6 +65,7 @@ aushape_gbtree_cleanup(struct aushape_gbtree *gbtree)
     aushape_gbuf_cleanup(&gbtree->text);
     aushape_garr_cleanup(&gbtree->nodes);
     aushape_garr_cleanup(&gbtree->prios);
+    aushape_garr_cleanup(&gbtree->trees);
     memset(gbtree, 0, sizeof(*gbtree));
 }
 
@@ -71,9 +76,33 @@ aushape_gbtree_empty(struct aushape_gbtree *gbtree)
     aushape_gbuf_empty(&gbtree->text);
     aushape_garr_empty(&gbtree->nodes);
     aushape_garr_empty(&gbtree->prios);
+    aushape_garr_empty(&gbtree->trees);
     gbtree->tail = 0;
 }
 
+void
+aushape_gbtree_shrink(struct aushape_gbtree *gbtree)
+{
+    assert(aushape_gbtree_is_valid(gbtree));
+    aushape_gbuf_shrink(&gbtree->text);
+    aushape_garr_shrink(&gbtree->nodes);
+    aushape_garr_shrink(&gbtree->prios);
+    aushape_garr_shrink(&gbtree->trees);
+    assert(aushape_gbtree_is_valid(gbtree));
+}
+
+void
+aushape_gbtree_get_mem_usage(const struct aushape_gbtree *gbtree,
+                             struct aushape_mem_usage *usage)
+{
+    assert(aushape_gbtree_is_valid(gbtree));
+    assert(usage != NULL);
+    aushape_gbuf_get_mem_usage(&gbtree->text, usage);
+    aushape_garr_get_mem_usage(&gbtree->nodes, usage);
+    aushape_garr_get_mem_usage(&gbtree->prios, usage);
+    aushape_garr_get_mem_usage(&gbtree->trees, usage);
+}
+
 bool
 aushape_gbtree_is_empty(const struct aushape_gbtree *gbtree)
 {
@@ -83,7 +112,7 @@ aushape_gbtree_is_empty(const struct aushape_gbtree *gbtree)
 
     for (i = 0; i < aushape_garr_get_len(&gbtree->nodes); i++) {
         if (!aushape_gbnode_is_empty(
-                    aushape_garr_const_get(&gbtree->nodes, i))) {
+                    gbtree, aushape_garr_const_get(&gbtree->nodes, i))) {
             return false;
         }
     }
@@ -100,7 +129,7 @@ aushape_gbtree_is_solid(const struct aushape_gbtree *gbtree)
 
     for (i = 0; i < aushape_garr_get_len(&gbtree->nodes); i++) {
         if (!aushape_gbnode_is_solid(
-                    aushape_garr_const_get(&gbtree->nodes, i))) {
+                    gbtree, aushape_garr_const_get(&gbtree->nodes, i))) {
             return false;
         }
     }
@@ -122,14 +151,14 @@ aushape_gbtree_is_atomic(struct aushape_gbtree *gbtree, bool cached)
 
     /* We are not atomic, if we have non-atomic nodes with priority zero */
     if (aushape_garr_get_len(prios) > 0) {
-        size_t head_index = *(size_t *)aushape_garr_get(prios, 0);
+        uint32_t head_index = *(uint32_t *)aushape_garr_get(prios, 0);
         /* If we have nodes with priority zero */
-        if (~head_index != 0) {
+        if (head_index != AUSHAPE_GBNODE_INDEX_NONE) {
             struct aushape_gbnode *node;
-            size_t index = head_index;
+            uint32_t index = head_index;
             do {
                 node = aushape_garr_get(&gbtree->nodes, index);
-                if (!aushape_gbnode_is_atomic(node, false)) {
+                if (!aushape_gbnode_is_atomic(gbtree, node, false)) {
                     return (gbtree->atomic = false);
                 }
                 index = node->next_index;
@@ -139,7 +168,8 @@ aushape_gbtree_is_atomic(struct aushape_gbtree *gbtree, bool cached)
 
     /* We are not atomic, if we have nodes with priority > 0 */
     for (prio = 1; prio < aushape_garr_get_len(prios); prio++) {
-        if (~*(size_t *)aushape_garr_get(prios, prio) != 0) {
+        if (*(uint32_t *)aushape_garr_get(prios, prio) !=
+                AUSHAPE_GBNODE_INDEX_NONE) {
             return (gbtree->atomic = false);
         }
     }
@@ -160,7 +190,7 @@ aushape_gbtree_get_len(struct aushape_gbtree *gbtree, bool cached)
         for (i = 0; i < aushape_garr_get_len(&gbtree->nodes); i++) {
             struct aushape_gbnode *node;
             node = aushape_garr_get(&gbtree->nodes, i);
-            len += aushape_gbnode_get_len(node, cached);
+            len += aushape_gbnode_get_len(gbtree, node, cached);
         }
 
         gbtree->len = len;
@@ -196,6 +226,8 @@ aushape_gbtree_node_void(struct aushape_gbtree *gbtree, size_t index)
 
     assert(aushape_gbtree_is_valid(gbtree));
 
+    AUSHAPE_GUARD_BOOL(NOMEM, index <= AUSHAPE_GBNODE_MAX);
+
     /**
      * Reset or allocate the target node
      */
@@ -221,7 +253,8 @@ aushape_gbtree_node_void(struct aushape_gbtree *gbtree, size_t index)
                 next_node->prev_index = node->prev_index;
 
                 /* If it's the head node of the peer list */
-                if (*(size_t *)aushape_garr_get(prios, node->prio) == index) {
+                if (*(uint32_t *)aushape_garr_get(prios, node->prio) ==
+                        index) {
                     /* Make the next node the new head */
                     aushape_garr_set(prios, node->prio, &node->next_index);
                 }
@@ -249,10 +282,13 @@ aushape_gbtree_node_put(struct aushape_gbtree *gbtree,
     struct aushape_garr *prios = &gbtree->prios;
     size_t prios_len;
     struct aushape_gbnode *node;
+    uint32_t index32;
 
     assert(aushape_gbtree_is_valid(gbtree));
     assert(pnode != NULL);
 
+    AUSHAPE_GUARD_BOOL(NOMEM, prio <= AUSHAPE_GBNODE_MAX);
+
     /**
      * Reset or allocate the target node
      */
@@ -260,8 +296,8 @@ aushape_gbtree_node_put(struct aushape_gbtree *gbtree,
 
     /* Here the node should be considered not valid, uninitialized */
     node = aushape_garr_get(nodes, index);
-    node->owner = gbtree;
     node->prio = prio;
+    index32 = index;
 
     /**
      * Add the node to the priority level node list
@@ -269,15 +305,15 @@ aushape_gbtree_node_put(struct aushape_gbtree *gbtree,
     prios_len = aushape_garr_get_len(prios);
     /* If node priority is allocated */
     if (prio < prios_len) {
-        size_t head_index = *(size_t *)aushape_garr_get(prios, prio);
+        uint32_t head_index = *(uint32_t *)aushape_garr_get(prios, prio);
         /* If priority is uninitialized */
-        if (~head_index == 0) {
+        if (head_index == AUSHAPE_GBNODE_INDEX_NONE) {
             /* Make single-entry priority level list */
             node->prev_index = index;
             node->next_index = index;
         } else {
             struct aushape_gbnode *head_node;
-            size_t tail_index;
+            uint32_t tail_index;
             struct aushape_gbnode *tail_node;
             /* Add node to the start of the list */
             head_node = aushape_garr_get(nodes, head_index);
@@ -301,7 +337,7 @@ aushape_gbtree_node_put(struct aushape_gbtree *gbtree,
     /* Here the priority entry should be considered not valid, uninitialized */
 
     /* Store the new priority level list head index */
-    aushape_garr_set(prios, prio, &index);
+    aushape_garr_set(prios, prio, &index32);
 
     *pnode = node;
 
@@ -319,6 +355,7 @@ aushape_gbtree_node_put_text(struct aushape_gbtree *gbtree,
 
     assert(aushape_gbtree_is_valid(gbtree));
 
+    AUSHAPE_GUARD_BOOL(NOMEM, gbtree->text.len <= AUSHAPE_GBNODE_MAX);
     AUSHAPE_GUARD(aushape_gbtree_node_put(gbtree, index, prio, &node));
 
     /* Set the node data */
@@ -351,14 +388,23 @@ aushape_gbtree_node_put_tree(struct aushape_gbtree *gbtree,
 {
     enum aushape_rc rc;
     struct aushape_gbnode *node;
+    size_t trees_len;
 
     assert(aushape_gbtree_is_valid(gbtree));
     assert(aushape_gbtree_is_valid(node_tree));
 
+    trees_len = aushape_garr_get_len(&gbtree->trees);
+    AUSHAPE_GUARD_BOOL(NOMEM, trees_len <= AUSHAPE_GBNODE_MAX);
+    /*
+     * Make room for the subtree pointer before linking the node, so adding
+     * it can't fail and leave a linked node of void type behind.
+     */
+    AUSHAPE_GUARD(aushape_garr_accomodate(&gbtree->trees, trees_len + 1));
     AUSHAPE_GUARD(aushape_gbtree_node_put(gbtree, index, prio, &node));
+    AUSHAPE_GUARD(aushape_garr_add(&gbtree->trees, &node_tree));
 
     node->type = AUSHAPE_GBNODE_TYPE_TREE;
-    node->tree = node_tree;
+    node->pos = trees_len;
 
     rc = AUSHAPE_RC_OK;
 cleanup:
@@ -378,6 +424,42 @@ aushape_gbtree_node_add_tree(struct aushape_gbtree *gbtree,
                                         node_tree);
 }
 
+enum aushape_rc
+aushape_gbtree_node_put_head(struct aushape_gbtree *gbtree,
+                             size_t index,
+                             size_t prio,
+                             enum aushape_msgpack_type type)
+{
+    enum aushape_rc rc;
+    struct aushape_gbnode *node;
+
+    assert(aushape_gbtree_is_valid(gbtree));
+    assert(type == AUSHAPE_MSGPACK_TYPE_ARRAY ||
+           type == AUSHAPE_MSGPACK_TYPE_MAP);
+
+    AUSHAPE_GUARD(aushape_gbtree_node_put(gbtree, index, prio, &node));
+
+    node->type = AUSHAPE_GBNODE_TYPE_HEAD;
+    node->pos = type;
+    node->len = 0;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_gbtree_node_add_head(struct aushape_gbtree *gbtree,
+                             size_t prio,
+                             enum aushape_msgpack_type type)
+{
+    assert(aushape_gbtree_is_valid(gbtree));
+    return aushape_gbtree_node_put_head(gbtree,
+                                        aushape_garr_get_len(&gbtree->nodes),
+                                        prio,
+                                        type);
+}
+
 /**
  * Get the (cached) length of a given priority level contents in a growing
  * buffer tree.
@@ -398,20 +480,20 @@ aushape_gbtree_prio_get_len(struct aushape_gbtree *gbtree,
     struct aushape_garr *nodes = &gbtree->nodes;
     struct aushape_garr *prios = &gbtree->prios;
     size_t len = 0;
-    size_t head_index;
-    size_t index;
+    uint32_t head_index;
+    uint32_t index;
     struct aushape_gbnode *node;
 
     assert(aushape_gbtree_is_valid(gbtree));
     assert(prio < aushape_garr_get_len(prios));
 
-    head_index = *(size_t *)aushape_garr_get(prios, prio);
+    head_index = *(uint32_t *)aushape_garr_get(prios, prio);
     /* If priority is initialized */
-    if (~head_index != 0) {
+    if (head_index != AUSHAPE_GBNODE_INDEX_NONE) {
         index = head_index;
         do {
             node = aushape_garr_get(nodes, index);
-            len += aushape_gbnode_get_len(node, cached);
+            len += aushape_gbnode_get_len(gbtree, node, cached);
             index = node->next_index;
         } while (index != head_index);
     }
@@ -430,16 +512,16 @@ aushape_gbtree_prio_void(struct aushape_gbtree *gbtree, size_t prio)
 {
     struct aushape_garr *nodes = &gbtree->nodes;
     struct aushape_garr *prios = &gbtree->prios;
-    size_t head_index;
+    uint32_t head_index;
 
     assert(aushape_gbtree_is_valid(gbtree));
     assert(prio < aushape_garr_get_len(prios));
 
-    head_index = *(size_t *)aushape_garr_get(prios, prio);
+    head_index = *(uint32_t *)aushape_garr_get(prios, prio);
     /* If priority is initialized */
-    if (~head_index != 0) {
+    if (head_index != AUSHAPE_GBNODE_INDEX_NONE) {
         struct aushape_gbnode *node;
-        size_t index = head_index;
+        uint32_t index = head_index;
         do {
             node = aushape_garr_get(nodes, index);
             node->type = AUSHAPE_GBNODE_TYPE_VOID;
@@ -474,7 +556,7 @@ aushape_gbtree_prio_trim(struct aushape_gbtree *gbtree,
 {
     struct aushape_garr *nodes = &gbtree->nodes;
     struct aushape_garr *prios = &gbtree->prios;
-    size_t head_index;
+    uint32_t head_index;
     struct aushape_gbnode *node;
     size_t prio_len;
     size_t prio_len_atomic;
@@ -491,14 +573,14 @@ aushape_gbtree_prio_trim(struct aushape_gbtree *gbtree,
         prio_len_atomic = 0;
         prio_len_non_atomic = 0;
         /* For each node */
-        head_index = *(size_t *)aushape_garr_get(prios, prio);
-        if (~head_index != 0) {
-            size_t index = head_index;
+        head_index = *(uint32_t *)aushape_garr_get(prios, prio);
+        if (head_index != AUSHAPE_GBNODE_INDEX_NONE) {
+            uint32_t index = head_index;
             size_t node_len;
             do {
                 node = aushape_garr_get(nodes, index);
-                node_len = aushape_gbnode_get_len(node, len_cached);
-                if (aushape_gbnode_is_atomic(node, atomic_cached)) {
+                node_len = aushape_gbnode_get_len(gbtree, node, len_cached);
+                if (aushape_gbnode_is_atomic(gbtree, node, atomic_cached)) {
                     prio_len_atomic += node_len;
                 } else {
                     prio_len_non_atomic += node_len;
@@ -529,19 +611,21 @@ aushape_gbtree_prio_trim(struct aushape_gbtree *gbtree,
          * Try to trim as much as possible
          */
         /* For each node */
-        head_index = *(size_t *)aushape_garr_get(prios, prio);
-        if (~head_index != 0) {
-            size_t index = head_index;
+        head_index = *(uint32_t *)aushape_garr_get(prios, prio);
+        if (head_index != AUSHAPE_GBNODE_INDEX_NONE) {
+            uint32_t index = head_index;
             do {
                 node = aushape_garr_get(nodes, index);
                 /* If the node is not (cached) atomic */
-                if (!aushape_gbnode_is_atomic(node, atomic_cached)) {
+                if (!aushape_gbnode_is_atomic(gbtree, node, atomic_cached)) {
                     size_t orig_node_len;
                     size_t req_node_len;
-                    orig_node_len = aushape_gbnode_get_len(node, len_cached);
+                    orig_node_len = aushape_gbnode_get_len(gbtree, node,
+                                                           len_cached);
                     req_node_len = orig_node_len * len_non_atomic /
                                         prio_len_non_atomic;
-                    aushape_gbnode_trim(node, atomic_cached, len_cached,
+                    aushape_gbnode_trim(gbtree, node,
+                                        atomic_cached, len_cached,
                                         req_node_len);
                 }
                 index = node->next_index;
@@ -618,7 +702,7 @@ aushape_gbtree_render(struct aushape_gbtree *gbtree, struct aushape_gbuf *gbuf)
 
     for (i = 0; i < aushape_garr_get_len(nodes); i++) {
         AUSHAPE_GUARD(aushape_gbnode_render(
-                            aushape_garr_get(nodes, i), gbuf));
+                            gbtree, aushape_garr_get(nodes, i), gbuf));
     }
 
     rc = AUSHAPE_RC_OK;
@@ -637,8 +721,8 @@ aushape_gbtree_prio_render_dump(const struct aushape_gbtree *gbtree,
     const struct aushape_garr *nodes = &gbtree->nodes;
     const struct aushape_garr *prios = &gbtree->prios;
     enum aushape_rc rc;
-    size_t head_index;
-    size_t index;
+    uint32_t head_index;
+    uint32_t index;
     const struct aushape_gbnode *node;
     size_t l = level;
 
@@ -650,9 +734,9 @@ aushape_gbtree_prio_render_dump(const struct aushape_gbtree *gbtree,
     if (format->lang == AUSHAPE_LANG_JSON && !first) {
         AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
     }
-    head_index = *(size_t *)aushape_garr_const_get(prios, prio);
+    head_index = *(const uint32_t *)aushape_garr_const_get(prios, prio);
     /* If priority is initialized */
-    if (~head_index == 0) {
+    if (head_index == AUSHAPE_GBNODE_INDEX_NONE) {
         AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
         if (format->lang == AUSHAPE_LANG_XML) {
             AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "<prio/>"));
@@ -671,7 +755,8 @@ aushape_gbtree_prio_render_dump(const struct aushape_gbtree *gbtree,
         index = head_index;
         do {
             node = aushape_garr_const_get(nodes, index);
-            AUSHAPE_GUARD(aushape_gbnode_render_dump(node, gbuf, format, l,
+            AUSHAPE_GUARD(aushape_gbnode_render_dump(gbtree, node,
+                                                     gbuf, format, l,
                                                      index == head_index));
             index = node->next_index;
         } while (index != head_index);
@@ -733,7 +818,7 @@ aushape_gbtree_render_dump(const struct aushape_gbtree *gbtree,
 
     for (i = 0; i < aushape_garr_get_len(nodes); i++) {
         node = aushape_garr_const_get(nodes, i);
-        AUSHAPE_GUARD(aushape_gbnode_render_dump(node, gbuf,
+        AUSHAPE_GUARD(aushape_gbnode_render_dump(gbtree, node, gbuf,
                                                  format, l, i == 0));
     }
 
@@ -794,7 +879,7 @@ aushape_gbtree_print_dump_to_fd(const struct aushape_gbtree *gbtree,
                     .nest_indent = 4,
                     .max_event_size = AUSHAPE_FORMAT_MIN_MAX_EVENT_SIZE};
 
-    aushape_gbuf_init(&gbuf, 4096);
+    aushape_gbuf_init(&gbuf, 4096, NULL);
 
     AUSHAPE_GUARD(aushape_gbtree_render_dump(gbtree, &gbuf,
                                              &format, 0, true));
@@ -28,6 +28,7 @@ bool
 aushape_gbuf_is_valid(const struct aushape_gbuf *gbuf)
 {
     return gbuf != NULL &&
+           aushape_mem_is_valid(gbuf->mem) &&
            gbuf->init_size != 0 &&
            (gbuf->size == 0 ||
             (gbuf->ptr != NULL && gbuf->size >= gbuf->init_size)) &&
@@ -35,12 +36,15 @@ aushape_gbuf_is_valid(const struct aushape_gbuf *gbuf)
 }
 
 void
-aushape_gbuf_init(struct aushape_gbuf *gbuf, size_t size)
+aushape_gbuf_init(struct aushape_gbuf *gbuf, size_t size,
+                  const struct aushape_mem *mem)
 {
     assert(gbuf != NULL);
     assert(size != 0);
+    assert(aushape_mem_is_valid(mem));
     memset(gbuf, 0, sizeof(*gbuf));
     gbuf->init_size = size;
+    gbuf->mem = mem;
     assert(aushape_gbuf_is_valid(gbuf));
 }
 
@@ -48,7 +52,7 @@ void
 aushape_gbuf_cleanup(struct aushape_gbuf *gbuf)
 {
     assert(aushape_gbuf_is_valid(gbuf));
-    free(gbuf->ptr);
+    aushape_mem_free(gbuf->mem, gbuf->ptr);
     memset(gbuf, 0, sizeof(*gbuf));
 }
 
@@ -80,10 +84,13 @@ aushape_gbuf_accomodate(struct aushape_gbuf *gbuf, size_t len)
         while (new_size < len) {
             new_size *= 2;
         }
-        new_ptr = realloc(gbuf->ptr, new_size);
+        new_ptr = aushape_mem_realloc(gbuf->mem, gbuf->ptr, new_size);
         AUSHAPE_GUARD_BOOL(NOMEM, new_ptr != NULL);
         gbuf->ptr = new_ptr;
         gbuf->size = new_size;
+        if (new_size > gbuf->peak_size) {
+            gbuf->peak_size = new_size;
+        }
     }
 
     rc = AUSHAPE_RC_OK;
@@ -91,6 +98,41 @@ cleanup:
     return rc;
 }
 
+void
+aushape_gbuf_shrink(struct aushape_gbuf *gbuf)
+{
+    size_t new_size;
+    char *new_ptr;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+
+    new_size = gbuf->init_size;
+    while (new_size < gbuf->len) {
+        new_size *= 2;
+    }
+
+    if (new_size < gbuf->size) {
+        new_ptr = aushape_mem_realloc(gbuf->mem, gbuf->ptr, new_size);
+        /* Keep the old memory if shrinking failed */
+        if (new_ptr != NULL) {
+            gbuf->ptr = new_ptr;
+            gbuf->size = new_size;
+        }
+    }
+
+    assert(aushape_gbuf_is_valid(gbuf));
+}
+
+void
+aushape_gbuf_get_mem_usage(const struct aushape_gbuf *gbuf,
+                           struct aushape_mem_usage *usage)
+{
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(usage != NULL);
+    usage->size += gbuf->size;
+    usage->peak += gbuf->peak_size;
+}
+
 enum aushape_rc
 aushape_gbuf_add_char(struct aushape_gbuf *gbuf, char c)
 {
@@ -247,6 +289,10 @@ aushape_gbuf_space_opening(struct aushape_gbuf *gbuf,
     enum aushape_rc rc;
     assert(aushape_gbuf_is_valid(gbuf));
     assert(aushape_format_is_valid(format));
+    /* Binary languages have no whitespace */
+    if (aushape_lang_is_binary(format->lang)) {
+        return AUSHAPE_RC_OK;
+    }
     if (level <= format->fold_level) {
         if (level > 0) {
             AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '\n'));
@@ -268,6 +314,10 @@ aushape_gbuf_space_closing(struct aushape_gbuf *gbuf,
     enum aushape_rc rc;
     assert(aushape_gbuf_is_valid(gbuf));
     assert(aushape_format_is_valid(format));
+    /* Binary languages have no whitespace */
+    if (aushape_lang_is_binary(format->lang)) {
+        return AUSHAPE_RC_OK;
+    }
     if ((level + 1) <= format->fold_level) {
         AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '\n'));
         AUSHAPE_GUARD(aushape_gbuf_add_span(gbuf, ' ',
@@ -412,3 +462,420 @@ aushape_gbuf_add_str_json(struct aushape_gbuf *gbuf, const char *str)
     return aushape_gbuf_add_buf_json(gbuf, str, strlen(str));
 }
 
+
+enum aushape_rc
+aushape_gbuf_add_cbor_head(struct aushape_gbuf *gbuf,
+                           enum aushape_cbor_major major,
+                           uint64_t arg)
+{
+    uint8_t head[9];
+    size_t len;
+    size_t i;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(major <= AUSHAPE_CBOR_MAJOR_SIMPLE);
+
+    head[0] = (uint8_t)major << 5;
+    if (arg < 24) {
+        head[0] |= (uint8_t)arg;
+        len = 0;
+    } else if (arg <= UINT8_MAX) {
+        head[0] |= 24;
+        len = 1;
+    } else if (arg <= UINT16_MAX) {
+        head[0] |= 25;
+        len = 2;
+    } else if (arg <= UINT32_MAX) {
+        head[0] |= 26;
+        len = 4;
+    } else {
+        head[0] |= 27;
+        len = 8;
+    }
+    /* Store the argument in network byte order */
+    for (i = len; i > 0; i--) {
+        head[i] = (uint8_t)arg;
+        arg >>= 8;
+    }
+    return aushape_gbuf_add_buf(gbuf, head, len + 1);
+}
+
+enum aushape_rc
+aushape_gbuf_add_cbor_indef(struct aushape_gbuf *gbuf,
+                            enum aushape_cbor_major major)
+{
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(major == AUSHAPE_CBOR_MAJOR_BYTES ||
+           major == AUSHAPE_CBOR_MAJOR_TEXT ||
+           major == AUSHAPE_CBOR_MAJOR_ARRAY ||
+           major == AUSHAPE_CBOR_MAJOR_MAP);
+    return aushape_gbuf_add_char(gbuf, (char)(((uint8_t)major << 5) | 31));
+}
+
+enum aushape_rc
+aushape_gbuf_add_double_cbor(struct aushape_gbuf *gbuf, double value)
+{
+    union {
+        double      d;
+        uint64_t    u;
+    } bits;
+    uint8_t buf[9];
+    size_t i;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+
+    bits.d = value;
+    buf[0] = (AUSHAPE_CBOR_MAJOR_SIMPLE << 5) | 27;
+    for (i = 8; i > 0; i--) {
+        buf[i] = (uint8_t)bits.u;
+        bits.u >>= 8;
+    }
+    return aushape_gbuf_add_buf(gbuf, buf, sizeof(buf));
+}
+
+/**
+ * Check if a buffer contains valid UTF-8: no stray continuation bytes, no
+ * truncated, overlong, or surrogate sequences, and nothing above U+10FFFF.
+ *
+ * @param ptr   The pointer to the buffer to check.
+ * @param len   The length of the buffer to check.
+ *
+ * @return True if the buffer is valid UTF-8, false otherwise.
+ */
+static bool
+aushape_gbuf_utf8_is_valid(const void *ptr, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+    const uint8_t *end = p + len;
+    uint8_t c;
+    uint8_t min;
+    uint8_t max;
+    size_t num;
+
+    assert(ptr != NULL || len == 0);
+
+    while (p < end) {
+        c = *p++;
+        if (c < 0x80) {
+            continue;
+        }
+        /* Get the number and the range of the first continuation byte */
+        min = 0x80;
+        max = 0xbf;
+        if (c >= 0xc2 && c <= 0xdf) {
+            num = 1;
+        } else if (c >= 0xe0 && c <= 0xef) {
+            num = 2;
+            if (c == 0xe0) {
+                min = 0xa0;
+            } else if (c == 0xed) {
+                max = 0x9f;
+            }
+        } else if (c >= 0xf0 && c <= 0xf4) {
+            num = 3;
+            if (c == 0xf0) {
+                min = 0x90;
+            } else if (c == 0xf4) {
+                max = 0x8f;
+            }
+        } else {
+            return false;
+        }
+        if ((size_t)(end - p) < num || *p < min || *p > max) {
+            return false;
+        }
+        for (p++, num--; num > 0; p++, num--) {
+            if ((*p & 0xc0) != 0x80) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+enum aushape_rc
+aushape_gbuf_add_bytes_cbor(struct aushape_gbuf *gbuf,
+                            const void *ptr, size_t len)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(ptr != NULL || len == 0);
+
+    AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(gbuf, AUSHAPE_CBOR_MAJOR_BYTES,
+                                             len));
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, ptr, len));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_gbuf_add_buf_cbor(struct aushape_gbuf *gbuf,
+                          const void *ptr, size_t len)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(ptr != NULL || len == 0);
+
+    AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(
+                            gbuf,
+                            aushape_gbuf_utf8_is_valid(ptr, len)
+                                ? AUSHAPE_CBOR_MAJOR_TEXT
+                                : AUSHAPE_CBOR_MAJOR_BYTES,
+                            len));
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, ptr, len));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_gbuf_add_str_cbor(struct aushape_gbuf *gbuf, const char *str)
+{
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(str != NULL);
+    return aushape_gbuf_add_buf_cbor(gbuf, str, strlen(str));
+}
+
+enum aushape_rc
+aushape_gbuf_add_str_lowercase_cbor(struct aushape_gbuf *gbuf,
+                                    const char *str)
+{
+    enum aushape_rc rc;
+    size_t len;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(str != NULL);
+
+    len = strlen(str);
+    /* Lowercasing ASCII letters doesn't change UTF-8 validity */
+    AUSHAPE_GUARD(aushape_gbuf_add_cbor_head(
+                            gbuf,
+                            aushape_gbuf_utf8_is_valid(str, len)
+                                ? AUSHAPE_CBOR_MAJOR_TEXT
+                                : AUSHAPE_CBOR_MAJOR_BYTES,
+                            len));
+    AUSHAPE_GUARD(aushape_gbuf_add_buf_lowercase(gbuf, str, len));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Store an unsigned integer in network byte order.
+ *
+ * @param ptr   The pointer to the location to store the integer at.
+ * @param value The integer to store.
+ * @param len   The number of (least significant) bytes to store.
+ */
+static void
+aushape_gbuf_store_be(uint8_t *ptr, uint64_t value, size_t len)
+{
+    assert(ptr != NULL || len == 0);
+    for (; len > 0; len--) {
+        ptr[len - 1] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+/**
+ * Format a MessagePack item head, see aushape_gbuf_add_msgpack_head.
+ *
+ * @param head  The location to format the head at, must have room for
+ *              AUSHAPE_MSGPACK_HEAD_MAX_LEN bytes.
+ * @param type  The item type.
+ * @param len   The item length.
+ *
+ * @return The head length.
+ */
+static size_t
+aushape_gbuf_format_msgpack_head(uint8_t *head,
+                                 enum aushape_msgpack_type type,
+                                 size_t len)
+{
+    /* Fixed format limit and first byte, then 8, 16, and 32-bit formats */
+    static const uint8_t formats[][5] = {
+        [AUSHAPE_MSGPACK_TYPE_STR]      = {32, 0xa0, 0xd9, 0xda, 0xdb},
+        [AUSHAPE_MSGPACK_TYPE_BIN]      = {0, 0, 0xc4, 0xc5, 0xc6},
+        [AUSHAPE_MSGPACK_TYPE_ARRAY]    = {16, 0x90, 0, 0xdc, 0xdd},
+        [AUSHAPE_MSGPACK_TYPE_MAP]      = {16, 0x80, 0, 0xde, 0xdf},
+    };
+    const uint8_t *format;
+    size_t arg_len;
+
+    assert(head != NULL);
+    assert(type <= AUSHAPE_MSGPACK_TYPE_MAP);
+    assert(len <= UINT32_MAX);
+
+    format = formats[type];
+    if (len < format[0]) {
+        head[0] = format[1] | (uint8_t)len;
+        return 1;
+    } else if (len <= UINT8_MAX && format[2] != 0) {
+        head[0] = format[2];
+        arg_len = 1;
+    } else if (len <= UINT16_MAX) {
+        head[0] = format[3];
+        arg_len = 2;
+    } else {
+        head[0] = format[4];
+        arg_len = 4;
+    }
+    aushape_gbuf_store_be(head + 1, len, arg_len);
+    return arg_len + 1;
+}
+
+size_t
+aushape_gbuf_get_msgpack_head_len(enum aushape_msgpack_type type, size_t len)
+{
+    uint8_t head[AUSHAPE_MSGPACK_HEAD_MAX_LEN];
+    return aushape_gbuf_format_msgpack_head(head, type, len);
+}
+
+enum aushape_rc
+aushape_gbuf_add_msgpack_head(struct aushape_gbuf *gbuf,
+                              enum aushape_msgpack_type type,
+                              size_t len)
+{
+    uint8_t head[AUSHAPE_MSGPACK_HEAD_MAX_LEN];
+    assert(aushape_gbuf_is_valid(gbuf));
+    return aushape_gbuf_add_buf(gbuf, head,
+                                aushape_gbuf_format_msgpack_head(head,
+                                                                 type, len));
+}
+
+enum aushape_rc
+aushape_gbuf_add_uint_msgpack(struct aushape_gbuf *gbuf, uint64_t value)
+{
+    uint8_t buf[9];
+    size_t len;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+
+    if (value < 0x80) {
+        buf[0] = (uint8_t)value;
+        len = 0;
+    } else if (value <= UINT8_MAX) {
+        buf[0] = 0xcc;
+        len = 1;
+    } else if (value <= UINT16_MAX) {
+        buf[0] = 0xcd;
+        len = 2;
+    } else if (value <= UINT32_MAX) {
+        buf[0] = 0xce;
+        len = 4;
+    } else {
+        buf[0] = 0xcf;
+        len = 8;
+    }
+    aushape_gbuf_store_be(buf + 1, value, len);
+    return aushape_gbuf_add_buf(gbuf, buf, len + 1);
+}
+
+enum aushape_rc
+aushape_gbuf_add_time_msgpack(struct aushape_gbuf *gbuf,
+                              int64_t sec, uint32_t nsec)
+{
+    uint8_t buf[15];
+    size_t len;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(nsec < 1000000000);
+
+    /* Use timestamp 32, 64, or 96 format, all of extension type -1 */
+    if (sec >= 0 && (sec >> 34) == 0) {
+        if (nsec == 0 && sec <= UINT32_MAX) {
+            buf[0] = 0xd6;
+            buf[1] = 0xff;
+            aushape_gbuf_store_be(buf + 2, sec, 4);
+            len = 6;
+        } else {
+            buf[0] = 0xd7;
+            buf[1] = 0xff;
+            aushape_gbuf_store_be(buf + 2,
+                                  (uint64_t)nsec << 34 | (uint64_t)sec, 8);
+            len = 10;
+        }
+    } else {
+        buf[0] = 0xc7;
+        buf[1] = 12;
+        buf[2] = 0xff;
+        aushape_gbuf_store_be(buf + 3, nsec, 4);
+        aushape_gbuf_store_be(buf + 7, (uint64_t)sec, 8);
+        len = 15;
+    }
+    return aushape_gbuf_add_buf(gbuf, buf, len);
+}
+
+enum aushape_rc
+aushape_gbuf_add_bytes_msgpack(struct aushape_gbuf *gbuf,
+                               const void *ptr, size_t len)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(ptr != NULL || len == 0);
+
+    AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(gbuf,
+                                                AUSHAPE_MSGPACK_TYPE_BIN,
+                                                len));
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, ptr, len));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_gbuf_add_buf_msgpack(struct aushape_gbuf *gbuf,
+                             const void *ptr, size_t len)
+{
+    enum aushape_rc rc;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(ptr != NULL || len == 0);
+
+    AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(
+                            gbuf,
+                            aushape_gbuf_utf8_is_valid(ptr, len)
+                                ? AUSHAPE_MSGPACK_TYPE_STR
+                                : AUSHAPE_MSGPACK_TYPE_BIN,
+                            len));
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, ptr, len));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_gbuf_add_str_msgpack(struct aushape_gbuf *gbuf, const char *str)
+{
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(str != NULL);
+    return aushape_gbuf_add_buf_msgpack(gbuf, str, strlen(str));
+}
+
+enum aushape_rc
+aushape_gbuf_add_str_lowercase_msgpack(struct aushape_gbuf *gbuf,
+                                       const char *str)
+{
+    enum aushape_rc rc;
+    size_t len;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(str != NULL);
+
+    len = strlen(str);
+    /* Lowercasing ASCII letters doesn't change UTF-8 validity */
+    AUSHAPE_GUARD(aushape_gbuf_add_msgpack_head(
+                            gbuf,
+                            aushape_gbuf_utf8_is_valid(str, len)
+                                ? AUSHAPE_MSGPACK_TYPE_STR
+                                : AUSHAPE_MSGPACK_TYPE_BIN,
+                            len));
+    AUSHAPE_GUARD(aushape_gbuf_add_buf_lowercase(gbuf, str, len));
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
@@ -0,0 +1,1039 @@
+/*
+ * HTTP bulk discrete aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/http_output.h>
+#include <aushape/gbuf.h>
+#include <aushape/guard.h>
+#include <aushape/flusher.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <zlib.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Maximum size of response headers, bytes */
+#define AUSHAPE_HTTP_OUTPUT_HDR_MAX     65536
+
+/**
+ * Query added to bulk requests to have the server respond only with
+ * the errors, instead of the status of every item
+ */
+#define AUSHAPE_HTTP_OUTPUT_QUERY       "?filter_path=errors,items.*.error"
+
+/** Outcome of a request */
+enum aushape_http_output_req {
+    /** The server accepted the request */
+    AUSHAPE_HTTP_OUTPUT_REQ_OK,
+    /** The connection failed, or the server asked to try again */
+    AUSHAPE_HTTP_OUTPUT_REQ_RETRY,
+    /** The server rejected the request */
+    AUSHAPE_HTTP_OUTPUT_REQ_FAILED,
+};
+
+/** HTTP bulk output data */
+struct aushape_http_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    char *host;                     /**< Server host */
+    char *port;                     /**< Server port */
+    char *authority;                /**< Host header value */
+    char *target;                   /**< Request target */
+    char *index;                    /**< Index name */
+    bool gzip;                      /**< True if bodies are compressed */
+    bool gzip_init;                 /**< True if the compressor is ready */
+    z_stream zs;                    /**< Body compressor */
+    int fd;                         /**< Connected socket, or -1 */
+    bool reused;                    /**< True if the socket sent requests */
+    /** Document ID of the event about to be written, empty if unknown */
+    char id[AUSHAPE_OUTPUT_EVENT_FIELDS_SIZE];
+    size_t batch_size;              /**< Size of a batch body, bytes */
+    struct aushape_gbuf body;       /**< Body of the batch being collected */
+    size_t body_events;             /**< Number of events in the body */
+    struct aushape_gbuf gz;         /**< Compressed body */
+    struct aushape_gbuf req;        /**< Request headers */
+    struct aushape_gbuf resp;       /**< Response being received */
+    struct aushape_gbuf resp_body;  /**< Decoded response body */
+    unsigned int retry_min;         /**< Minimum retry delay, ms */
+    unsigned int retry_max;         /**< Maximum retry delay, ms */
+    unsigned int retry;             /**< Next retry delay, ms */
+    unsigned int timeout;           /**< Sending timeout, ms, or zero */
+    unsigned int max_latency;       /**< Max batching time, ms, or zero */
+    /** Monotonic time the oldest event in the batch was added at */
+    struct timespec body_time;
+    /** Statistics */
+    struct aushape_http_output_stats stats;
+    /** Flusher sending the batch after the maximum latency */
+    struct aushape_flusher flusher;
+    /** First sending failure return code, or OK */
+    enum aushape_rc rc;
+};
+
+/**
+ * Wait for a socket to become ready.
+ *
+ * @param fd        The socket to wait for.
+ * @param events    The poll(2) events to wait for.
+ * @param deadline  The monotonic time to stop waiting at, or NULL for
+ *                  never.
+ *
+ * @return True if the socket became ready, or failed, false if waiting
+ *         timed out, or failed.
+ */
+static bool
+aushape_http_output_wait(int fd, short events,
+                         const struct timespec *deadline)
+{
+    struct pollfd pfd;
+    int rc;
+
+    pfd.fd = fd;
+    pfd.events = events;
+    do {
+        rc = poll(&pfd, 1, aushape_flusher_time_left(deadline));
+    } while (rc < 0 && errno == EINTR);
+    return rc > 0;
+}
+
+/**
+ * Make an attempt to connect an HTTP bulk output to the server.
+ *
+ * @param http_output   The output to connect.
+ * @param deadline      The monotonic time to stop waiting for the
+ *                      connection at, or NULL for never.
+ *
+ * @return True if connected, false otherwise.
+ */
+static bool
+aushape_http_output_connect(struct aushape_http_output *http_output,
+                            const struct timespec *deadline)
+{
+    struct addrinfo hints;
+    struct addrinfo *list;
+    struct addrinfo *ai;
+    int fd;
+    int err;
+    socklen_t errlen;
+    int one = 1;
+
+    assert(http_output != NULL);
+    assert(http_output->fd < 0);
+
+    /* Resolve on each attempt, to follow address changes */
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+    if (getaddrinfo(http_output->host, http_output->port,
+                    &hints, &list) != 0) {
+        return false;
+    }
+    for (ai = list; ai != NULL && http_output->fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family,
+                    ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            continue;
+        }
+        errlen = sizeof(err);
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0 ||
+            ((errno == EINPROGRESS || errno == EINTR) &&
+             aushape_http_output_wait(fd, POLLOUT, deadline) &&
+             getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen) == 0 &&
+             err == 0)) {
+            http_output->fd = fd;
+        } else {
+            close(fd);
+        }
+    }
+    freeaddrinfo(list);
+    if (http_output->fd < 0) {
+        return false;
+    }
+    /* Requests are whole already, don't delay them further */
+    setsockopt(http_output->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    http_output->reused = false;
+    return true;
+}
+
+/**
+ * Close the connection of an HTTP bulk output.
+ *
+ * @param http_output   The output to disconnect.
+ */
+static void
+aushape_http_output_disconnect(struct aushape_http_output *http_output)
+{
+    assert(http_output != NULL);
+    if (http_output->fd >= 0) {
+        close(http_output->fd);
+        http_output->fd = -1;
+    }
+}
+
+/**
+ * Send pieces of a request to the server of an HTTP bulk output.
+ *
+ * @param http_output   The output to send the request with.
+ * @param iov           The request pieces, modified while sending.
+ * @param iovcnt        The number of the request pieces.
+ * @param deadline      The monotonic time to stop waiting at, or NULL for
+ *                      never.
+ *
+ * @return True if sent completely, false if the connection failed.
+ */
+static bool
+aushape_http_output_send(struct aushape_http_output *http_output,
+                         struct iovec *iov, size_t iovcnt,
+                         const struct timespec *deadline)
+{
+    struct msghdr msg;
+    ssize_t rc;
+    size_t len;
+
+    assert(http_output != NULL);
+    assert(http_output->fd >= 0);
+    assert(iov != NULL || iovcnt == 0);
+
+    while (iovcnt > 0) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        rc = sendmsg(http_output->fd, &msg, MSG_NOSIGNAL);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) &&
+                aushape_http_output_wait(http_output->fd, POLLOUT,
+                                         deadline)) {
+                continue;
+            }
+            return false;
+        }
+        /* Skip the pieces sent */
+        len = (size_t)rc;
+        while (iovcnt > 0 && len >= iov->iov_len) {
+            len -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + len;
+            iov->iov_len -= len;
+        }
+    }
+    return true;
+}
+
+/**
+ * Receive more of a response to an HTTP bulk output.
+ *
+ * @param http_output   The output to receive the response for.
+ * @param deadline      The monotonic time to stop waiting at, or NULL for
+ *                      never.
+ *
+ * @return True if received some, false if the connection was closed, or
+ *         failed.
+ */
+static bool
+aushape_http_output_recv(struct aushape_http_output *http_output,
+                         const struct timespec *deadline)
+{
+    struct aushape_gbuf *resp = &http_output->resp;
+    ssize_t rc;
+
+    assert(http_output != NULL);
+    assert(http_output->fd >= 0);
+
+    if (aushape_gbuf_accomodate(resp, resp->len + 16384) != AUSHAPE_RC_OK) {
+        return false;
+    }
+    while (true) {
+        rc = recv(http_output->fd, resp->ptr + resp->len,
+                  resp->size - resp->len, 0);
+        if (rc > 0) {
+            resp->len += (size_t)rc;
+            return true;
+        } else if (rc == 0) {
+            return false;
+        } else if (errno == EINTR) {
+            continue;
+        } else if ((errno == EAGAIN || errno == EWOULDBLOCK) &&
+                   aushape_http_output_wait(http_output->fd, POLLIN,
+                                            deadline)) {
+            continue;
+        }
+        return false;
+    }
+}
+
+/**
+ * Receive a number of bytes of a response to an HTTP bulk output,
+ * starting at an offset.
+ *
+ * @param http_output   The output to receive the response for.
+ * @param end           The offset the response must reach.
+ * @param deadline      The monotonic time to stop waiting at, or NULL for
+ *                      never.
+ *
+ * @return True if received, false if the connection was closed, or
+ *         failed.
+ */
+static bool
+aushape_http_output_recv_until(struct aushape_http_output *http_output,
+                               size_t end,
+                               const struct timespec *deadline)
+{
+    while (http_output->resp.len < end) {
+        if (!aushape_http_output_recv(http_output, deadline)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Receive a CRLF-terminated line of a response to an HTTP bulk output.
+ *
+ * @param http_output   The output to receive the response for.
+ * @param start         The offset the line starts at.
+ * @param pend          Location for the offset after the line's CRLF.
+ * @param deadline      The monotonic time to stop waiting at, or NULL for
+ *                      never.
+ *
+ * @return True if received, false if the connection was closed, or
+ *         failed, or the line is too long.
+ */
+static bool
+aushape_http_output_recv_line(struct aushape_http_output *http_output,
+                              size_t start, size_t *pend,
+                              const struct timespec *deadline)
+{
+    struct aushape_gbuf *resp = &http_output->resp;
+    const char *crlf;
+
+    while (true) {
+        if (resp->len > start) {
+            crlf = memmem(resp->ptr + start, resp->len - start, "\r\n", 2);
+            if (crlf != NULL) {
+                *pend = (size_t)(crlf - resp->ptr) + 2;
+                return true;
+            }
+        }
+        if (resp->len - start > AUSHAPE_HTTP_OUTPUT_HDR_MAX ||
+            !aushape_http_output_recv(http_output, deadline)) {
+            return false;
+        }
+    }
+}
+
+/**
+ * Find a key in a JSON text, without parsing it.
+ *
+ * @param ptr   The start of the text to search.
+ * @param end   The end of the text.
+ * @param key   The key to find, with quotes.
+ *
+ * @return The pointer to the key value, or NULL if not found.
+ */
+static const char *
+aushape_http_output_find_key(const char *ptr, const char *end,
+                             const char *key)
+{
+    size_t key_len = strlen(key);
+
+    assert(ptr != NULL);
+    assert(end >= ptr);
+    assert(key != NULL);
+
+    while ((ptr = memmem(ptr, (size_t)(end - ptr), key, key_len)) != NULL) {
+        ptr += key_len;
+        while (ptr < end && strchr(" \t\r\n", *ptr) != NULL) {
+            ptr++;
+        }
+        if (ptr < end && *ptr == ':') {
+            do {
+                ptr++;
+            } while (ptr < end && strchr(" \t\r\n", *ptr) != NULL);
+            return ptr;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Send the batch of an HTTP bulk output in a request and receive the
+ * response over the current connection.
+ *
+ * @param http_output   The output to send the batch of.
+ * @param deadline      The monotonic time to stop waiting at, or NULL for
+ *                      never.
+ * @param pbroken       Location for the flag set if the connection failed
+ *                      before a response was received.
+ *
+ * @return The request outcome.
+ */
+static enum aushape_http_output_req
+aushape_http_output_request(struct aushape_http_output *http_output,
+                            const struct timespec *deadline,
+                            bool *pbroken)
+{
+    struct aushape_gbuf *resp = &http_output->resp;
+    struct aushape_gbuf *resp_body = &http_output->resp_body;
+    const struct aushape_gbuf *body = http_output->gzip
+                                        ? &http_output->gz
+                                        : &http_output->body;
+    struct iovec iov[2];
+    size_t hdr_end;
+    size_t line_end;
+    size_t pos;
+    const char *line;
+    const char *p;
+    int status;
+    bool chunked = false;
+    bool has_len = false;
+    bool close_conn = false;
+    unsigned long long content_len = 0;
+    unsigned long long chunk_len;
+    char *end;
+
+    assert(http_output != NULL);
+    assert(pbroken != NULL);
+
+    *pbroken = true;
+    aushape_gbuf_empty(resp);
+    aushape_gbuf_empty(resp_body);
+
+    /* Send the request */
+    iov[0].iov_base = http_output->req.ptr;
+    iov[0].iov_len = http_output->req.len;
+    iov[1].iov_base = body->ptr;
+    iov[1].iov_len = body->len;
+    if (!aushape_http_output_send(http_output, iov, 2, deadline)) {
+        return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+    }
+    http_output->reused = true;
+
+    /* Receive the status line */
+    if (!aushape_http_output_recv_line(http_output, 0, &line_end,
+                                       deadline)) {
+        return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+    }
+    *pbroken = false;
+    if (sscanf(resp->ptr, "HTTP/1.%*1[01] %3d", &status) != 1) {
+        aushape_http_output_disconnect(http_output);
+        return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+    }
+    close_conn = resp->ptr[7] == '0';
+
+    /* Receive and parse the headers */
+    pos = line_end;
+    while (true) {
+        if (!aushape_http_output_recv_line(http_output, pos, &line_end,
+                                           deadline)) {
+            aushape_http_output_disconnect(http_output);
+            return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+        }
+        line = resp->ptr + pos;
+        if (line_end - pos == 2) {
+            break;
+        }
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_len = strtoull(line + 15, NULL, 10);
+            has_len = true;
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            chunked = memmem(line, line_end - pos, "chunked", 7) != NULL;
+        } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            close_conn = memmem(line, line_end - pos, "close", 5) != NULL;
+        }
+        pos = line_end;
+    }
+    hdr_end = line_end;
+
+    /* Receive and decode the body */
+    if (chunked) {
+        pos = hdr_end;
+        do {
+            if (!aushape_http_output_recv_line(http_output, pos, &line_end,
+                                               deadline)) {
+                aushape_http_output_disconnect(http_output);
+                return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+            }
+            chunk_len = strtoull(resp->ptr + pos, &end, 16);
+            if (end == resp->ptr + pos) {
+                aushape_http_output_disconnect(http_output);
+                return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+            }
+            pos = line_end;
+            if (chunk_len > 0) {
+                if (!aushape_http_output_recv_until(http_output,
+                                                    pos + chunk_len + 2,
+                                                    deadline) ||
+                    aushape_gbuf_add_buf(resp_body, resp->ptr + pos,
+                                         chunk_len) != AUSHAPE_RC_OK) {
+                    aushape_http_output_disconnect(http_output);
+                    return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+                }
+                pos += chunk_len + 2;
+            }
+        } while (chunk_len > 0);
+        /* Skip the trailer */
+        do {
+            if (!aushape_http_output_recv_line(http_output, pos, &line_end,
+                                               deadline)) {
+                aushape_http_output_disconnect(http_output);
+                return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+            }
+            line = resp->ptr + pos;
+            pos = line_end;
+        } while (line_end - (size_t)(line - resp->ptr) > 2);
+    } else if (has_len) {
+        if (!aushape_http_output_recv_until(http_output,
+                                            hdr_end + content_len,
+                                            deadline) ||
+            aushape_gbuf_add_buf(resp_body, resp->ptr + hdr_end,
+                                 content_len) != AUSHAPE_RC_OK) {
+            aushape_http_output_disconnect(http_output);
+            return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+        }
+    } else {
+        /* The body ends with the connection */
+        while (aushape_http_output_recv(http_output, deadline));
+        if (aushape_gbuf_add_buf(resp_body, resp->ptr + hdr_end,
+                                 resp->len - hdr_end) != AUSHAPE_RC_OK) {
+            aushape_http_output_disconnect(http_output);
+            return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+        }
+        close_conn = true;
+    }
+    if (close_conn) {
+        aushape_http_output_disconnect(http_output);
+    }
+
+    if (status == 429 || (status >= 500 && status < 600)) {
+        return AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+    } else if (status < 200 || status >= 300) {
+        return AUSHAPE_HTTP_OUTPUT_REQ_FAILED;
+    }
+
+    /* Count rejected items */
+    end = resp_body->ptr + resp_body->len;
+    p = aushape_http_output_find_key(resp_body->ptr, end, "\"errors\"");
+    if (p != NULL && (size_t)(end - p) >= 4 && memcmp(p, "true", 4) == 0) {
+        p = resp_body->ptr;
+        while ((p = aushape_http_output_find_key(p, end,
+                                                 "\"error\"")) != NULL) {
+            http_output->stats.rejected++;
+        }
+    }
+    return AUSHAPE_HTTP_OUTPUT_REQ_OK;
+}
+
+/**
+ * Send the batch of an HTTP bulk output, if any, unless sending failed
+ * already, retrying with exponentially increasing delays. Record the
+ * failure.
+ *
+ * @param http_output   The output to flush.
+ *
+ * @return The output return code.
+ */
+static enum aushape_rc
+aushape_http_output_flush(struct aushape_http_output *http_output)
+{
+    struct timespec deadline;
+    const struct timespec *pdeadline = NULL;
+    struct timespec delay;
+    enum aushape_http_output_req req;
+    bool broken;
+    bool reused;
+    int left;
+
+    assert(http_output != NULL);
+
+    if (http_output->rc != AUSHAPE_RC_OK || http_output->body.len == 0) {
+        return http_output->rc;
+    }
+
+    if (http_output->timeout > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        aushape_flusher_time_add(&deadline, http_output->timeout);
+        pdeadline = &deadline;
+    }
+
+    /* Compress the body */
+    if (http_output->gzip) {
+        aushape_gbuf_empty(&http_output->gz);
+        if (deflateReset(&http_output->zs) != Z_OK ||
+            aushape_gbuf_accomodate(&http_output->gz,
+                                    deflateBound(&http_output->zs,
+                                                 http_output->body.len)) !=
+                AUSHAPE_RC_OK) {
+            http_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            return http_output->rc;
+        }
+        http_output->zs.next_in = (Bytef *)http_output->body.ptr;
+        http_output->zs.avail_in = (uInt)http_output->body.len;
+        http_output->zs.next_out = (Bytef *)http_output->gz.ptr;
+        http_output->zs.avail_out = (uInt)http_output->gz.size;
+        if (deflate(&http_output->zs, Z_FINISH) != Z_STREAM_END) {
+            http_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            return http_output->rc;
+        }
+        http_output->gz.len = http_output->gz.size -
+                              http_output->zs.avail_out;
+    }
+
+    /* Format the request headers */
+    aushape_gbuf_empty(&http_output->req);
+    if (aushape_gbuf_add_fmt(&http_output->req,
+                             "POST %s HTTP/1.1\r\n"
+                             "Host: %s\r\n"
+                             "Content-Type: application/x-ndjson\r\n"
+                             "Content-Length: %zu\r\n"
+                             "%s"
+                             "\r\n",
+                             http_output->target,
+                             http_output->authority,
+                             http_output->gzip ? http_output->gz.len
+                                               : http_output->body.len,
+                             http_output->gzip
+                                ? "Content-Encoding: gzip\r\n" : "") !=
+            AUSHAPE_RC_OK) {
+        http_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        return http_output->rc;
+    }
+
+    while (true) {
+        req = AUSHAPE_HTTP_OUTPUT_REQ_RETRY;
+        reused = false;
+        if (http_output->fd >= 0 ||
+            aushape_http_output_connect(http_output, pdeadline)) {
+            reused = http_output->reused;
+            req = aushape_http_output_request(http_output, pdeadline,
+                                              &broken);
+            if (req == AUSHAPE_HTTP_OUTPUT_REQ_RETRY && broken) {
+                aushape_http_output_disconnect(http_output);
+                /* The server could've closed an idle connection */
+                if (reused) {
+                    continue;
+                }
+            }
+        }
+        if (req == AUSHAPE_HTTP_OUTPUT_REQ_OK) {
+            break;
+        } else if (req == AUSHAPE_HTTP_OUTPUT_REQ_FAILED) {
+            http_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            return http_output->rc;
+        }
+
+        /* Wait before retrying */
+        left = aushape_flusher_time_left(pdeadline);
+        if (left == 0) {
+            http_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            return http_output->rc;
+        }
+        if (left > 0 && (unsigned int)left < http_output->retry) {
+            delay.tv_sec = left / 1000;
+            delay.tv_nsec = (long)(left % 1000) * 1000000;
+        } else {
+            delay.tv_sec = http_output->retry / 1000;
+            delay.tv_nsec = (long)(http_output->retry % 1000) * 1000000;
+        }
+        while (nanosleep(&delay, &delay) < 0 && errno == EINTR);
+        http_output->retry = http_output->retry > http_output->retry_max / 2
+                                ? http_output->retry_max
+                                : http_output->retry * 2;
+        http_output->stats.retries++;
+    }
+    http_output->retry = http_output->retry_min;
+
+    http_output->stats.requests++;
+    http_output->stats.events += http_output->body_events;
+    aushape_gbuf_empty(&http_output->body);
+    http_output->body_events = 0;
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Get the time an HTTP bulk output's batch is due to be sent at by the
+ * flusher: once its oldest event waits for the maximum latency.
+ *
+ * @param data      The HTTP bulk output to get the flush time of.
+ * @param pdeadline Location for the flush time.
+ *
+ * @return True if a flush is pending, false otherwise.
+ */
+static bool
+aushape_http_output_flusher_due(void *data, struct timespec *pdeadline)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)data;
+
+    assert(http_output != NULL);
+    assert(pdeadline != NULL);
+
+    if (http_output->body.len == 0 || http_output->rc != AUSHAPE_RC_OK) {
+        return false;
+    }
+    *pdeadline = http_output->body_time;
+    aushape_flusher_time_add(pdeadline, http_output->max_latency);
+    return true;
+}
+
+/**
+ * Flush an HTTP bulk output from the flusher: send the batch.
+ *
+ * @param data  The HTTP bulk output to flush.
+ * @param now   The current monotonic time.
+ */
+static void
+aushape_http_output_flusher_flush(void *data, const struct timespec *now)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)data;
+
+    assert(http_output != NULL);
+    assert(now != NULL);
+    (void)now;
+
+    aushape_http_output_flush(http_output);
+}
+
+static void aushape_http_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_http_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)output;
+    const char *url = va_arg(ap, const char *);
+    const char *index = va_arg(ap, const char *);
+    bool gzip = (bool)va_arg(ap, int);
+    size_t batch_size = va_arg(ap, size_t);
+    unsigned int max_latency = va_arg(ap, unsigned int);
+    unsigned int retry_min = va_arg(ap, unsigned int);
+    unsigned int retry_max = va_arg(ap, unsigned int);
+    unsigned int timeout = va_arg(ap, unsigned int);
+    const char *authority;
+    size_t authority_len;
+    const char *path;
+    size_t path_len;
+    const char *host;
+    size_t host_len;
+    const char *port;
+    enum aushape_rc rc;
+
+    assert(http_output != NULL);
+
+    http_output->fd = -1;
+
+    if (url == NULL || index == NULL || *index == '\0' ||
+        batch_size == 0 || retry_min == 0 || retry_max < retry_min ||
+        strncasecmp(url, "http://", 7) != 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    /* Parse the URL */
+    authority = url + 7;
+    authority_len = strcspn(authority, "/?#");
+    path = authority + authority_len;
+    path_len = strcspn(path, "?#");
+    while (path_len > 0 && path[path_len - 1] == '/') {
+        path_len--;
+    }
+    host = authority;
+    if (*host == '[') {
+        host++;
+        host_len = strcspn(host, "]");
+        if (host_len >= authority_len - 1) {
+            return AUSHAPE_RC_INVALID_ARGS;
+        }
+        port = host + host_len + 1;
+    } else {
+        host_len = strcspn(host, ":/?#");
+        port = host + host_len;
+    }
+    if (host_len == 0 ||
+        (port < authority + authority_len && *port != ':')) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    http_output->host = strndup(host, host_len);
+    AUSHAPE_GUARD_BOOL(NOMEM, http_output->host != NULL);
+    if (port < authority + authority_len && port + 1 < path) {
+        http_output->port = strndup(port + 1,
+                                    (size_t)(path - port - 1));
+    } else {
+        http_output->port = strdup("80");
+    }
+    AUSHAPE_GUARD_BOOL(NOMEM, http_output->port != NULL);
+    http_output->authority = strndup(authority, authority_len);
+    AUSHAPE_GUARD_BOOL(NOMEM, http_output->authority != NULL);
+    http_output->target = malloc(path_len + sizeof("/_bulk") +
+                                 sizeof(AUSHAPE_HTTP_OUTPUT_QUERY));
+    AUSHAPE_GUARD_BOOL(NOMEM, http_output->target != NULL);
+    memcpy(http_output->target, path, path_len);
+    strcpy(http_output->target + path_len,
+           "/_bulk" AUSHAPE_HTTP_OUTPUT_QUERY);
+    http_output->index = strdup(index);
+    AUSHAPE_GUARD_BOOL(NOMEM, http_output->index != NULL);
+
+    http_output->gzip = gzip;
+    if (gzip) {
+        /* Favor latency, bulk bodies compress well anyway */
+        AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                           deflateInit2(&http_output->zs, Z_BEST_SPEED,
+                                        Z_DEFLATED, MAX_WBITS + 16, 8,
+                                        Z_DEFAULT_STRATEGY) == Z_OK);
+        http_output->gzip_init = true;
+    }
+    http_output->batch_size = batch_size;
+    aushape_gbuf_init(&http_output->body, batch_size + 4096, NULL);
+    aushape_gbuf_init(&http_output->gz, 4096, NULL);
+    aushape_gbuf_init(&http_output->req, 512, NULL);
+    aushape_gbuf_init(&http_output->resp, 16384, NULL);
+    aushape_gbuf_init(&http_output->resp_body, 4096, NULL);
+    http_output->retry_min = retry_min;
+    http_output->retry_max = retry_max;
+    http_output->retry = retry_min;
+    http_output->timeout = timeout;
+    http_output->rc = AUSHAPE_RC_OK;
+    /* Take the event node for document IDs */
+    output->event_fields = true;
+
+    /* Start the flusher, if the batching time is limited */
+    if (max_latency > 0) {
+        http_output->max_latency = max_latency;
+        AUSHAPE_GUARD(aushape_flusher_start(&http_output->flusher,
+                                            aushape_http_output_flusher_due,
+                                            aushape_http_output_flusher_flush,
+                                            http_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_http_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_http_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)output;
+    assert(http_output != NULL);
+
+    return http_output->host != NULL &&
+           http_output->port != NULL &&
+           http_output->authority != NULL &&
+           http_output->target != NULL &&
+           http_output->index != NULL &&
+           http_output->gzip == http_output->gzip_init &&
+           http_output->batch_size > 0 &&
+           http_output->retry_min > 0 &&
+           http_output->retry_max >= http_output->retry_min &&
+           (http_output->max_latency == 0 ||
+            aushape_flusher_is_started(&http_output->flusher));
+}
+
+static void
+aushape_http_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)output;
+    assert(http_output != NULL);
+
+    /* Stop the flusher */
+    aushape_flusher_stop(&http_output->flusher);
+
+    aushape_http_output_disconnect(http_output);
+    if (http_output->gzip_init) {
+        deflateEnd(&http_output->zs);
+        http_output->gzip_init = false;
+    }
+    aushape_gbuf_cleanup(&http_output->resp_body);
+    aushape_gbuf_cleanup(&http_output->resp);
+    aushape_gbuf_cleanup(&http_output->req);
+    aushape_gbuf_cleanup(&http_output->gz);
+    aushape_gbuf_cleanup(&http_output->body);
+    free(http_output->index);
+    http_output->index = NULL;
+    free(http_output->target);
+    http_output->target = NULL;
+    free(http_output->authority);
+    http_output->authority = NULL;
+    free(http_output->port);
+    http_output->port = NULL;
+    free(http_output->host);
+    http_output->host = NULL;
+}
+
+static enum aushape_rc
+aushape_http_output_event(struct aushape_output *output,
+                          const struct aushape_output_event *event)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)output;
+    const char *node = NULL;
+    size_t i;
+
+    assert(http_output != NULL);
+    assert(event != NULL);
+
+    /* The ID isn't shared with the flusher, no need to lock */
+    for (i = 0; i < event->fields_len;
+         i += strlen(event->fields + i) + 1) {
+        if (strncmp(event->fields + i, "node=", 5) == 0) {
+            node = event->fields + i + 5;
+            break;
+        }
+    }
+    snprintf(http_output->id, sizeof(http_output->id),
+             "%s%s%lld.%03u:%lu",
+             node == NULL ? "" : node, node == NULL ? "" : ":",
+             (long long)event->sec, event->msec, event->serial);
+    return AUSHAPE_RC_OK;
+}
+
+static enum aushape_rc
+aushape_http_output_write(struct aushape_output *output,
+                          const char *ptr,
+                          size_t len)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)output;
+    struct aushape_gbuf *body = &http_output->body;
+    size_t orig_len;
+    enum aushape_rc rc;
+
+    assert(http_output != NULL);
+
+    /* Accept single-line events only, with or without a newline */
+    if (len > 0 && ptr[len - 1] == '\n') {
+        len--;
+    }
+    if (len == 0 || memchr(ptr, '\n', len) != NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    aushape_flusher_lock(&http_output->flusher);
+    AUSHAPE_GUARD(http_output->rc);
+
+    /* Add the action and the event */
+    orig_len = body->len;
+    rc = aushape_gbuf_add_str(body, "{\"index\":{\"_index\":\"");
+    if (rc == AUSHAPE_RC_OK) {
+        rc = aushape_gbuf_add_str_json(body, http_output->index);
+    }
+    if (rc == AUSHAPE_RC_OK && http_output->id[0] != '\0') {
+        rc = aushape_gbuf_add_str(body, "\",\"_id\":\"");
+        if (rc == AUSHAPE_RC_OK) {
+            rc = aushape_gbuf_add_str_json(body, http_output->id);
+        }
+    }
+    if (rc == AUSHAPE_RC_OK) {
+        rc = aushape_gbuf_add_str(body, "\"}}\n");
+    }
+    if (rc == AUSHAPE_RC_OK) {
+        rc = aushape_gbuf_add_buf(body, ptr, len);
+    }
+    if (rc == AUSHAPE_RC_OK) {
+        rc = aushape_gbuf_add_char(body, '\n');
+    }
+    if (rc != AUSHAPE_RC_OK) {
+        body->len = orig_len;
+        goto cleanup;
+    }
+    http_output->id[0] = '\0';
+    http_output->body_events++;
+    if (orig_len == 0 && aushape_flusher_is_started(&http_output->flusher)) {
+        clock_gettime(CLOCK_MONOTONIC, &http_output->body_time);
+        aushape_flusher_signal(&http_output->flusher);
+    }
+
+    /* Send a full batch */
+    if (body->len >= http_output->batch_size) {
+        AUSHAPE_GUARD(aushape_http_output_flush(http_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_flusher_unlock(&http_output->flusher);
+    return rc;
+}
+
+static enum aushape_rc
+aushape_http_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)output;
+    enum aushape_rc rc;
+
+    assert(http_output != NULL);
+
+    aushape_flusher_lock(&http_output->flusher);
+    /* Keep collecting the batch, unless flushed explicitly */
+    rc = full ? aushape_http_output_flush(http_output) : http_output->rc;
+    aushape_flusher_unlock(&http_output->flusher);
+    return rc;
+}
+
+enum aushape_rc
+aushape_http_output_get_stats(const struct aushape_output *output,
+                              struct aushape_http_output_stats *pstats)
+{
+    struct aushape_http_output *http_output =
+                                    (struct aushape_http_output *)output;
+
+    if (!aushape_output_is_valid(output) ||
+        output->type != &aushape_http_output_type ||
+        pstats == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    aushape_flusher_lock(&http_output->flusher);
+    *pstats = http_output->stats;
+    aushape_flusher_unlock(&http_output->flusher);
+
+    return AUSHAPE_RC_OK;
+}
+
+const struct aushape_output_type aushape_http_output_type = {
+    .size       = sizeof(struct aushape_http_output),
+    .cont       = false,
+    .init       = aushape_http_output_init,
+    .is_valid   = aushape_http_output_is_valid,
+    .write      = aushape_http_output_write,
+    .sync       = aushape_http_output_sync,
+    .event      = aushape_http_output_event,
+    .cleanup    = aushape_http_output_cleanup,
+};
@@ -0,0 +1,231 @@
+/*
+ * An intermediate event tree, independent of the output language.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/itree.h>
+#include <aushape/guard.h>
+#include <string.h>
+
+bool
+aushape_itree_pool_is_valid(const struct aushape_itree_pool *pool)
+{
+    return pool != NULL &&
+           aushape_gbuf_is_valid(&pool->text) &&
+           aushape_garr_is_valid(&pool->fields);
+}
+
+void
+aushape_itree_pool_init(struct aushape_itree_pool *pool,
+                        const struct aushape_mem *mem)
+{
+    assert(pool != NULL);
+    assert(aushape_mem_is_valid(mem));
+    memset(pool, 0, sizeof(*pool));
+    aushape_gbuf_init(&pool->text, 4096, mem);
+    aushape_garr_init(&pool->fields, sizeof(struct aushape_itree_field),
+                      256, mem);
+    assert(aushape_itree_pool_is_valid(pool));
+}
+
+void
+aushape_itree_pool_cleanup(struct aushape_itree_pool *pool)
+{
+    assert(aushape_itree_pool_is_valid(pool));
+    aushape_gbuf_cleanup(&pool->text);
+    aushape_garr_cleanup(&pool->fields);
+    memset(pool, 0, sizeof(*pool));
+}
+
+void
+aushape_itree_pool_empty(struct aushape_itree_pool *pool)
+{
+    assert(aushape_itree_pool_is_valid(pool));
+    aushape_gbuf_empty(&pool->text);
+    aushape_garr_empty(&pool->fields);
+}
+
+void
+aushape_itree_pool_shrink(struct aushape_itree_pool *pool)
+{
+    assert(aushape_itree_pool_is_valid(pool));
+    aushape_gbuf_shrink(&pool->text);
+    aushape_garr_shrink(&pool->fields);
+}
+
+void
+aushape_itree_pool_get_mem_usage(const struct aushape_itree_pool *pool,
+                                 struct aushape_mem_usage *usage)
+{
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(usage != NULL);
+    aushape_gbuf_get_mem_usage(&pool->text, usage);
+    aushape_garr_get_mem_usage(&pool->fields, usage);
+}
+
+enum aushape_rc
+aushape_itree_pool_add_buf(struct aushape_itree_pool *pool,
+                           const char *ptr,
+                           size_t len,
+                           size_t *ppos)
+{
+    enum aushape_rc rc;
+    size_t pos;
+
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(ptr != NULL || len == 0);
+    assert(ppos != NULL);
+
+    pos = pool->text.len;
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(&pool->text, ptr, len));
+    rc = aushape_gbuf_add_char(&pool->text, '\0');
+    if (rc != AUSHAPE_RC_OK) {
+        pool->text.len = pos;
+        goto cleanup;
+    }
+    *ppos = pos;
+cleanup:
+    return rc;
+}
+
+enum aushape_rc
+aushape_itree_pool_add_str(struct aushape_itree_pool *pool,
+                           const char *str,
+                           size_t *ppos)
+{
+    assert(str != NULL);
+    return aushape_itree_pool_add_buf(pool, str, strlen(str), ppos);
+}
+
+enum aushape_rc
+aushape_itree_pool_add_field(struct aushape_itree_pool *pool,
+                             const struct aushape_itree_field *field)
+{
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(field != NULL);
+    assert(field->name < pool->text.len);
+    assert(field->value_i < pool->text.len);
+    assert(field->value_r < pool->text.len);
+    return aushape_garr_add(&pool->fields, field);
+}
+
+bool
+aushape_itree_is_valid(const struct aushape_itree *itree)
+{
+    return itree != NULL &&
+           aushape_itree_pool_is_valid(itree->pool) &&
+           aushape_garr_is_valid(&itree->nodes);
+}
+
+void
+aushape_itree_init(struct aushape_itree *itree,
+                   struct aushape_itree_pool *pool,
+                   size_t node_min)
+{
+    assert(itree != NULL);
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(node_min != 0);
+    memset(itree, 0, sizeof(*itree));
+    itree->pool = pool;
+    aushape_garr_init(&itree->nodes, sizeof(struct aushape_itree_node),
+                      node_min, aushape_itree_pool_get_mem(pool));
+    assert(aushape_itree_is_valid(itree));
+}
+
+void
+aushape_itree_cleanup(struct aushape_itree *itree)
+{
+    assert(aushape_itree_is_valid(itree));
+    aushape_garr_cleanup(&itree->nodes);
+    memset(itree, 0, sizeof(*itree));
+}
+
+void
+aushape_itree_empty(struct aushape_itree *itree)
+{
+    assert(aushape_itree_is_valid(itree));
+    aushape_garr_empty(&itree->nodes);
+}
+
+void
+aushape_itree_shrink(struct aushape_itree *itree)
+{
+    assert(aushape_itree_is_valid(itree));
+    aushape_garr_shrink(&itree->nodes);
+}
+
+void
+aushape_itree_get_mem_usage(const struct aushape_itree *itree,
+                            struct aushape_mem_usage *usage)
+{
+    assert(aushape_itree_is_valid(itree));
+    assert(usage != NULL);
+    aushape_garr_get_mem_usage(&itree->nodes, usage);
+}
+
+bool
+aushape_itree_is_solid(const struct aushape_itree *itree)
+{
+    size_t i;
+
+    assert(aushape_itree_is_valid(itree));
+
+    for (i = 0; i < aushape_itree_get_node_num(itree); i++) {
+        if (aushape_itree_get_node(itree, i)->type ==
+                AUSHAPE_ITREE_NODE_TYPE_VOID) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+aushape_itree_node_exists(const struct aushape_itree *itree, size_t index)
+{
+    assert(aushape_itree_is_valid(itree));
+    return index < aushape_itree_get_node_num(itree) &&
+           aushape_itree_get_node(itree, index)->type !=
+                AUSHAPE_ITREE_NODE_TYPE_VOID;
+}
+
+enum aushape_rc
+aushape_itree_node_put(struct aushape_itree *itree,
+                       size_t index,
+                       const struct aushape_itree_node *node)
+{
+    enum aushape_rc rc;
+    size_t node_num;
+
+    assert(aushape_itree_is_valid(itree));
+    assert(node != NULL);
+    assert(node->type != AUSHAPE_ITREE_NODE_TYPE_VOID);
+
+    node_num = aushape_itree_get_node_num(itree);
+    AUSHAPE_GUARD(aushape_garr_accomodate(&itree->nodes, index + 1));
+    /* Fill the gap with void nodes */
+    if (index > node_num) {
+        AUSHAPE_GUARD(aushape_garr_set_zero_span(&itree->nodes, node_num,
+                                                 index - node_num));
+    }
+    AUSHAPE_GUARD(aushape_garr_set(&itree->nodes, index, node));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    assert(aushape_itree_is_valid(itree));
+    return rc;
+}
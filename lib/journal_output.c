@@ -0,0 +1,573 @@
+/*
+ * Native journald discrete aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/journal_output.h>
+#include <aushape/gbuf.h>
+#include <aushape/guard.h>
+#include <aushape/flusher.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Initial size of the entry buffer, bytes */
+#define AUSHAPE_JOURNAL_OUTPUT_BUF_SIZE 65536
+
+/** Native journald output data */
+struct aushape_journal_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    struct sockaddr_un addr;        /**< Journald socket address */
+    int fd;                         /**< Unconnected datagram socket */
+    char *ident;                    /**< SYSLOG_IDENTIFIER field value */
+    int facility;                   /**< SYSLOG_FACILITY field value */
+    int priority;                   /**< PRIORITY field value */
+    /** Event fields for the next entry, in the protocol format */
+    struct aushape_gbuf fields;
+    /** Queued entries, in the protocol format */
+    struct aushape_gbuf buf;
+    /** Offsets of queued entry ends in the buffer, an array of size_t */
+    struct aushape_gbuf ends;
+    size_t batch_size;              /**< Number of entries in a batch */
+    /** Message headers for sending a batch, batch_size long */
+    struct mmsghdr *msgs;
+    /** Message pieces for sending a batch, batch_size long */
+    struct iovec *iovs;
+    unsigned int max_latency;       /**< Max queueing time, ms, or zero */
+    /** Monotonic time the oldest queued entry was queued at */
+    struct timespec queue_time;
+    /** Flusher sending the queue after the maximum latency */
+    struct aushape_flusher flusher;
+    /** First sending failure return code, or OK */
+    enum aushape_rc rc;
+};
+
+/**
+ * Add a field to a buffer in the journald native protocol format: as
+ * "NAME=VALUE\n", or, if the value contains newlines, as "NAME\n", followed
+ * by the 64-bit little-endian value length, the value, and "\n".
+ *
+ * @param gbuf      The buffer to add the field to.
+ * @param prefix    The prefix to add to the name.
+ * @param name      The field name, converted to upper case.
+ * @param name_len  The field name length.
+ * @param ptr       The field value.
+ * @param len       The field value length.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - added successfully,
+ *          AUSHAPE_RC_NOMEM    - failed allocating memory.
+ */
+static enum aushape_rc
+aushape_journal_output_add_field(struct aushape_gbuf *gbuf,
+                                 const char *prefix,
+                                 const char *name, size_t name_len,
+                                 const char *ptr, size_t len)
+{
+    enum aushape_rc rc;
+    uint8_t len_buf[8];
+    size_t i;
+
+    assert(gbuf != NULL);
+    assert(prefix != NULL);
+    assert(name != NULL);
+    assert(ptr != NULL || len == 0);
+
+    AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, prefix));
+    for (i = 0; i < name_len; i++) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf,
+                                            (name[i] >= 'a' && name[i] <= 'z')
+                                                ? name[i] - 'a' + 'A'
+                                                : name[i]));
+    }
+    if (memchr(ptr, '\n', len) == NULL) {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '='));
+    } else {
+        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '\n'));
+        for (i = 0; i < sizeof(len_buf); i++) {
+            len_buf[i] = (uint8_t)((uint64_t)len >> (i * 8));
+        }
+        AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, len_buf, sizeof(len_buf)));
+    }
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(gbuf, ptr, len));
+    AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '\n'));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Send an entry of a native journald output in a sealed memory file.
+ *
+ * @param journal_output    The output to send the entry of.
+ * @param ptr               The entry.
+ * @param len               The entry length.
+ *
+ * @return True if sent successfully, false otherwise, with errno set.
+ */
+static bool
+aushape_journal_output_send_memfd(struct aushape_journal_output
+                                                        *journal_output,
+                                  const char *ptr, size_t len)
+{
+#ifdef MFD_ALLOW_SEALING
+    union {
+        struct cmsghdr cmsg;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    int memfd;
+    ssize_t rc;
+    int orig_errno;
+    bool result = false;
+
+    assert(journal_output != NULL);
+    assert(ptr != NULL || len == 0);
+
+    memfd = memfd_create("aushape-journal", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0) {
+        return false;
+    }
+    while (len > 0) {
+        rc = write(memfd, ptr, len);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            goto cleanup;
+        }
+        ptr += rc;
+        len -= (size_t)rc;
+    }
+    if (fcntl(memfd, F_ADD_SEALS,
+              F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+        goto cleanup;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    msg.msg_name = &journal_output->addr;
+    msg.msg_namelen = sizeof(journal_output->addr);
+    msg.msg_control = &control;
+    msg.msg_controllen = sizeof(control);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+    do {
+        rc = sendmsg(journal_output->fd, &msg, MSG_NOSIGNAL);
+    } while (rc < 0 && errno == EINTR);
+    result = rc >= 0;
+
+cleanup:
+    orig_errno = errno;
+    close(memfd);
+    errno = orig_errno;
+    return result;
+#else
+    (void)journal_output;
+    (void)ptr;
+    (void)len;
+    errno = EMSGSIZE;
+    return false;
+#endif
+}
+
+/**
+ * Send queued entries of a native journald output, waiting for journald
+ * to accept them.
+ *
+ * @param journal_output    The output to send the entries of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - sent successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - sending failed.
+ */
+static enum aushape_rc
+aushape_journal_output_send(struct aushape_journal_output *journal_output)
+{
+    const size_t *ends;
+    size_t num;
+    size_t start;
+    size_t i;
+    int rc;
+
+    assert(journal_output != NULL);
+
+    ends = (const size_t *)journal_output->ends.ptr;
+    num = journal_output->ends.len / sizeof(*ends);
+    assert(num <= journal_output->batch_size);
+
+    /* Describe the batch */
+    start = 0;
+    for (i = 0; i < num; i++) {
+        journal_output->iovs[i].iov_base = journal_output->buf.ptr + start;
+        journal_output->iovs[i].iov_len = ends[i] - start;
+        memset(&journal_output->msgs[i], 0, sizeof(journal_output->msgs[i]));
+        journal_output->msgs[i].msg_hdr.msg_name = &journal_output->addr;
+        journal_output->msgs[i].msg_hdr.msg_namelen =
+                                            sizeof(journal_output->addr);
+        journal_output->msgs[i].msg_hdr.msg_iov = &journal_output->iovs[i];
+        journal_output->msgs[i].msg_hdr.msg_iovlen = 1;
+        start = ends[i];
+    }
+
+    /* Send it, passing entries too big for a datagram in memory files */
+    for (i = 0; i < num;) {
+        rc = sendmmsg(journal_output->fd, journal_output->msgs + i,
+                      (unsigned int)(num - i), MSG_NOSIGNAL);
+        if (rc > 0) {
+            i += (size_t)rc;
+        } else if (rc < 0 && errno == EINTR) {
+            continue;
+        } else if (rc < 0 && (errno == EMSGSIZE || errno == ENOBUFS) &&
+                   aushape_journal_output_send_memfd(
+                                    journal_output,
+                                    journal_output->iovs[i].iov_base,
+                                    journal_output->iovs[i].iov_len)) {
+            i++;
+        } else {
+            return AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+    }
+
+    aushape_gbuf_empty(&journal_output->buf);
+    aushape_gbuf_empty(&journal_output->ends);
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Send queued entries of a native journald output, if any, unless sending
+ * failed already, recording the failure.
+ *
+ * @param journal_output    The output to flush.
+ *
+ * @return The output return code.
+ */
+static enum aushape_rc
+aushape_journal_output_flush(struct aushape_journal_output *journal_output)
+{
+    assert(journal_output != NULL);
+    if (journal_output->rc == AUSHAPE_RC_OK &&
+        journal_output->ends.len > 0) {
+        journal_output->rc = aushape_journal_output_send(journal_output);
+    }
+    return journal_output->rc;
+}
+
+/**
+ * Get the time a native journald output's queue is due to be sent at by
+ * the flusher: once the oldest entry waits for the maximum latency.
+ *
+ * @param data      The native journald output to get the flush time of.
+ * @param pdeadline Location for the flush time.
+ *
+ * @return True if a flush is pending, false otherwise.
+ */
+static bool
+aushape_journal_output_flusher_due(void *data, struct timespec *pdeadline)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)data;
+
+    assert(journal_output != NULL);
+    assert(pdeadline != NULL);
+
+    if (journal_output->ends.len == 0 ||
+        journal_output->rc != AUSHAPE_RC_OK) {
+        return false;
+    }
+    *pdeadline = journal_output->queue_time;
+    aushape_flusher_time_add(pdeadline, journal_output->max_latency);
+    return true;
+}
+
+/**
+ * Flush a native journald output from the flusher: send the queue.
+ *
+ * @param data  The native journald output to flush.
+ * @param now   The current monotonic time.
+ */
+static void
+aushape_journal_output_flusher_flush(void *data, const struct timespec *now)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)data;
+
+    assert(journal_output != NULL);
+    assert(now != NULL);
+    (void)now;
+
+    aushape_journal_output_flush(journal_output);
+}
+
+static void aushape_journal_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_journal_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)output;
+    const char *path = va_arg(ap, const char *);
+    const char *ident = va_arg(ap, const char *);
+    int facility = va_arg(ap, int);
+    int priority = va_arg(ap, int);
+    size_t batch_size = va_arg(ap, size_t);
+    unsigned int max_latency = va_arg(ap, unsigned int);
+    enum aushape_rc rc;
+
+    assert(journal_output != NULL);
+
+    journal_output->fd = -1;
+
+    if (path == NULL || ident == NULL || batch_size == 0 ||
+        *path == '\0' ||
+        strlen(path) >= sizeof(journal_output->addr.sun_path)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    journal_output->addr.sun_family = AF_UNIX;
+    strcpy(journal_output->addr.sun_path, path);
+    journal_output->facility = LOG_FAC(facility);
+    journal_output->priority = LOG_PRI(priority);
+    journal_output->batch_size = batch_size;
+    journal_output->output.event_fields = true;
+    aushape_gbuf_init(&journal_output->fields, 4096, NULL);
+    aushape_gbuf_init(&journal_output->buf,
+                      AUSHAPE_JOURNAL_OUTPUT_BUF_SIZE, NULL);
+    aushape_gbuf_init(&journal_output->ends, sizeof(size_t) * batch_size,
+                      NULL);
+
+    journal_output->ident = strdup(ident);
+    AUSHAPE_GUARD_BOOL(NOMEM, journal_output->ident != NULL);
+    journal_output->msgs = calloc(batch_size, sizeof(*journal_output->msgs));
+    AUSHAPE_GUARD_BOOL(NOMEM, journal_output->msgs != NULL);
+    journal_output->iovs = calloc(batch_size, sizeof(*journal_output->iovs));
+    AUSHAPE_GUARD_BOOL(NOMEM, journal_output->iovs != NULL);
+
+    journal_output->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, journal_output->fd >= 0);
+
+    /* Start the flusher, if the queueing time is limited */
+    if (max_latency > 0) {
+        journal_output->max_latency = max_latency;
+        AUSHAPE_GUARD(aushape_flusher_start(
+                                    &journal_output->flusher,
+                                    aushape_journal_output_flusher_due,
+                                    aushape_journal_output_flusher_flush,
+                                    journal_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_journal_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_journal_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)output;
+    assert(journal_output != NULL);
+
+    return journal_output->fd >= 0 &&
+           journal_output->ident != NULL &&
+           journal_output->batch_size > 0 &&
+           journal_output->msgs != NULL &&
+           journal_output->iovs != NULL &&
+           (journal_output->max_latency == 0 ||
+            aushape_flusher_is_started(&journal_output->flusher));
+}
+
+static void
+aushape_journal_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)output;
+    assert(journal_output != NULL);
+
+    /* Stop the flusher */
+    aushape_flusher_stop(&journal_output->flusher);
+
+    /* Send the remaining entries */
+    if (journal_output->fd >= 0 && journal_output->msgs != NULL &&
+        journal_output->iovs != NULL) {
+        aushape_journal_output_flush(journal_output);
+    }
+    if (journal_output->fd >= 0) {
+        close(journal_output->fd);
+        journal_output->fd = -1;
+    }
+    free(journal_output->iovs);
+    journal_output->iovs = NULL;
+    free(journal_output->msgs);
+    journal_output->msgs = NULL;
+    aushape_gbuf_cleanup(&journal_output->ends);
+    aushape_gbuf_cleanup(&journal_output->buf);
+    aushape_gbuf_cleanup(&journal_output->fields);
+    free(journal_output->ident);
+    journal_output->ident = NULL;
+}
+
+static enum aushape_rc
+aushape_journal_output_event(struct aushape_output *output,
+                             const struct aushape_output_event *event)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)output;
+    struct aushape_gbuf *gbuf = &journal_output->fields;
+    char num_buf[64];
+    const char *field;
+    const char *eq;
+    size_t i;
+    enum aushape_rc rc;
+
+    assert(journal_output != NULL);
+    assert(event != NULL);
+
+    /* The fields aren't shared with the flusher, no need to lock */
+    snprintf(num_buf, sizeof(num_buf), "%lu", event->serial);
+    AUSHAPE_GUARD(aushape_journal_output_add_field(gbuf, "AUSHAPE_",
+                                                   "SERIAL", 6,
+                                                   num_buf,
+                                                   strlen(num_buf)));
+    snprintf(num_buf, sizeof(num_buf), "%lld.%03u",
+             (long long)event->sec, event->msec);
+    AUSHAPE_GUARD(aushape_journal_output_add_field(gbuf, "AUSHAPE_",
+                                                   "TIME", 4,
+                                                   num_buf,
+                                                   strlen(num_buf)));
+    for (i = 0; i < event->fields_len; i += strlen(field) + 1) {
+        field = event->fields + i;
+        eq = strchr(field, '=');
+        if (eq == NULL) {
+            continue;
+        }
+        AUSHAPE_GUARD(aushape_journal_output_add_field(
+                                gbuf, "AUSHAPE_",
+                                field, (size_t)(eq - field),
+                                eq + 1, strlen(eq + 1)));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+static enum aushape_rc
+aushape_journal_output_write(struct aushape_output *output,
+                             const char *ptr,
+                             size_t len)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)output;
+    struct aushape_gbuf *buf = &journal_output->buf;
+    char num_buf[16];
+    size_t end;
+    enum aushape_rc rc;
+
+    assert(journal_output != NULL);
+
+    aushape_flusher_lock(&journal_output->flusher);
+    AUSHAPE_GUARD(journal_output->rc);
+
+    /* Queue the entry */
+    if (aushape_flusher_is_started(&journal_output->flusher) &&
+        journal_output->ends.len == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &journal_output->queue_time);
+        aushape_flusher_signal(&journal_output->flusher);
+    }
+    snprintf(num_buf, sizeof(num_buf), "%d", journal_output->priority);
+    AUSHAPE_GUARD(aushape_journal_output_add_field(buf, "", "PRIORITY", 8,
+                                                   num_buf,
+                                                   strlen(num_buf)));
+    snprintf(num_buf, sizeof(num_buf), "%d", journal_output->facility);
+    AUSHAPE_GUARD(aushape_journal_output_add_field(buf, "",
+                                                   "SYSLOG_FACILITY", 15,
+                                                   num_buf,
+                                                   strlen(num_buf)));
+    AUSHAPE_GUARD(aushape_journal_output_add_field(
+                                        buf, "", "SYSLOG_IDENTIFIER", 17,
+                                        journal_output->ident,
+                                        strlen(journal_output->ident)));
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(buf, journal_output->fields.ptr,
+                                       journal_output->fields.len));
+    aushape_gbuf_empty(&journal_output->fields);
+    AUSHAPE_GUARD(aushape_journal_output_add_field(buf, "", "MESSAGE", 7,
+                                                   ptr, len));
+    end = buf->len;
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(&journal_output->ends,
+                                       &end, sizeof(end)));
+
+    /* Send a full batch */
+    if (journal_output->ends.len / sizeof(end) >=
+            journal_output->batch_size) {
+        AUSHAPE_GUARD(aushape_journal_output_flush(journal_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_flusher_unlock(&journal_output->flusher);
+    return rc;
+}
+
+static enum aushape_rc
+aushape_journal_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_journal_output *journal_output =
+                                    (struct aushape_journal_output *)output;
+    enum aushape_rc rc;
+
+    assert(journal_output != NULL);
+
+    aushape_flusher_lock(&journal_output->flusher);
+    /* Keep collecting the batch, unless flushed explicitly */
+    rc = full ? aushape_journal_output_flush(journal_output)
+              : journal_output->rc;
+    aushape_flusher_unlock(&journal_output->flusher);
+    return rc;
+}
+
+const struct aushape_output_type aushape_journal_output_type = {
+    .size       = sizeof(struct aushape_journal_output),
+    .cont       = false,
+    .init       = aushape_journal_output_init,
+    .is_valid   = aushape_journal_output_is_valid,
+    .write      = aushape_journal_output_write,
+    .sync       = aushape_journal_output_sync,
+    .event      = aushape_journal_output_event,
+    .cleanup    = aushape_journal_output_cleanup,
+};
@@ -0,0 +1,143 @@
+#
+# Generate the compact key dictionary from the aushape JSON schema.
+#
+# Usage: LC_ALL=C awk -f key_dict.awk aushape.schema.json > key_dict_list.c
+#
+# Every property name of every "properties" object in the schema - event
+# members, record types, record fields, and normalized data members - gets
+# an entry, in the order of its first appearance, and is assigned the next
+# key ID. The first 26 IDs are single upper-case letters, the rest are an
+# upper-case letter followed by an upper-case letter or a digit. The
+# dictionary version is a hash of the names in ID order, so any change to
+# the assignment produces a different version.
+#
+# Copyright (C) 2016 Red Hat
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+function fail(msg) {
+    print "key_dict.awk: " FILENAME ":" FNR ": " msg > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+# Format the key ID for a zero-based index
+function key_id(idx) {
+    if (idx < 26) {
+        return substr(letters, idx + 1, 1)
+    }
+    idx -= 26
+    return substr(letters, int(idx / 36) + 1, 1) \
+           substr(digits letters, idx % 36 + 1, 1)
+}
+
+BEGIN {
+    letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    digits = "0123456789"
+    for (i = 32; i < 127; i++) {
+        ord[sprintf("%c", i)] = i
+    }
+    depth = 0
+}
+
+{
+    # A property of a "properties" object directly containing this line
+    if (depth in props && match($0, /^ *"[^"]*":/)) {
+        name = substr($0, RSTART, RLENGTH)
+        sub(/^ *"/, "", name)
+        sub(/":$/, "", name)
+        # Names are output verbatim and must not look like key IDs
+        if (name !~ /^[a-z0-9_-]+$/) {
+            fail("unsupported key name \"" name "\"")
+        }
+        if (!(name in index_of)) {
+            index_of[name] = num
+            list[num++] = name
+        }
+    }
+
+    opening = /"properties": *\{/
+
+    # Track object nesting, no braces are expected in strings
+    line = $0
+    depth += gsub(/\{/, "", line) - gsub(/\}/, "", line)
+    for (d in props) {
+        if (d + 0 > depth) {
+            delete props[d]
+        }
+    }
+    if (opening) {
+        props[depth] = 1
+    }
+}
+
+END {
+    if (failed) {
+        exit 1
+    }
+    if (num == 0) {
+        fail("no keys found")
+    }
+    if (num > 26 + 26 * 36) {
+        fail("too many keys")
+    }
+
+    # Hash the names in ID order, 32-bit, polynomial
+    hash = 0
+    for (i = 0; i < num; i++) {
+        str = list[i] "\n"
+        for (j = 1; j <= length(str); j++) {
+            hash = (hash * 31 + ord[substr(str, j, 1)]) % 4294967296
+        }
+    }
+
+    # Sort indexes by name
+    for (i = 0; i < num; i++) {
+        for (j = i; j > 0 && list[sorted[j - 1]] > list[i]; j--) {
+            sorted[j] = sorted[j - 1]
+        }
+        sorted[j] = i
+    }
+
+    print "/*"
+    print " * Compact key dictionary."
+    print " *"
+    print " * Generated by key_dict.awk from aushape.schema.json, do not edit."
+    print " */"
+    print ""
+    print "#include <aushape/key_dict.h>"
+    print ""
+    printf "const char aushape_key_dict_version[] = \"%04x%04x\";\n",
+           int(hash / 65536), hash % 65536
+    print ""
+    print "const struct aushape_key_def aushape_key_dict_list[] = {"
+    for (i = 0; i < num; i++) {
+        printf "    {.name = %-28s .id = \"%s\"},\n",
+               "\"" list[i] "\",", key_id(i)
+    }
+    print "};"
+    print ""
+    print "const unsigned short aushape_key_dict_sorted[] = {"
+    for (i = 0; i < num; i += 8) {
+        line = "   "
+        for (j = i; j < i + 8 && j < num; j++) {
+            line = line " " sorted[j] ","
+        }
+        print line
+    }
+    print "};"
+    print ""
+    print "const size_t aushape_key_dict_num = " num ";"
+}
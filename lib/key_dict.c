@@ -0,0 +1,128 @@
+/*
+ * Compact key dictionary.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/key_dict.h>
+#include <aushape/guard.h>
+#include <assert.h>
+#include <ctype.h>
+#include <string.h>
+
+/** Maximum length of a name, which can be in the dictionary */
+#define AUSHAPE_KEY_DICT_NAME_MAX_LEN   63
+
+const struct aushape_key_def *
+aushape_key_dict_lookup(const char *name)
+{
+    size_t lo = 0;
+    size_t hi = aushape_key_dict_num;
+    size_t mid;
+    const struct aushape_key_def *def;
+    int cmp;
+
+    assert(name != NULL);
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        def = &aushape_key_dict_list[aushape_key_dict_sorted[mid]];
+        cmp = strcmp(name, def->name);
+        if (cmp == 0) {
+            return def;
+        } else if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return NULL;
+}
+
+ssize_t
+aushape_key_dict_id_to_index(const char *id, size_t len)
+{
+    assert(id != NULL || len == 0);
+
+    if (len == 0 || len > AUSHAPE_KEY_DICT_ID_MAX_LEN ||
+        id[0] < 'A' || id[0] > 'Z') {
+        return -1;
+    }
+    if (len == 1) {
+        return id[0] - 'A';
+    }
+    if (id[1] >= '0' && id[1] <= '9') {
+        return 26 + (id[0] - 'A') * 36 + (id[1] - '0');
+    }
+    if (id[1] >= 'A' && id[1] <= 'Z') {
+        return 26 + (id[0] - 'A') * 36 + 10 + (id[1] - 'A');
+    }
+    return -1;
+}
+
+enum aushape_rc
+aushape_key_dict_add_json(struct aushape_gbuf *gbuf,
+                          const struct aushape_format *format,
+                          const char *name,
+                          bool lowercase)
+{
+    enum aushape_rc rc;
+    char lower_buf[AUSHAPE_KEY_DICT_NAME_MAX_LEN + 1];
+    const char *key = name;
+    size_t len;
+    size_t i;
+    const struct aushape_key_def *def;
+
+    assert(aushape_gbuf_is_valid(gbuf));
+    assert(aushape_format_is_valid(format));
+    assert(name != NULL);
+
+    AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
+    if (format->compact_keys) {
+        len = strlen(name);
+        if (lowercase && len <= AUSHAPE_KEY_DICT_NAME_MAX_LEN) {
+            for (i = 0; i <= len; i++) {
+                lower_buf[i] = tolower((unsigned char)name[i]);
+            }
+            key = lower_buf;
+            lowercase = false;
+        }
+        def = aushape_key_dict_lookup(key);
+        if (def != NULL) {
+            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, def->id));
+            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
+            rc = AUSHAPE_RC_OK;
+            goto cleanup;
+        }
+        if (key[0] == AUSHAPE_KEY_DICT_ESCAPE ||
+            aushape_key_dict_id_to_index(key, len) >= 0) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf,
+                                                AUSHAPE_KEY_DICT_ESCAPE));
+        }
+    }
+    if (lowercase) {
+        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase(gbuf, key));
+    } else {
+        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, key));
+    }
+    AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
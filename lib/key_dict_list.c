@@ -0,0 +1,474 @@
+/*
+ * Compact key dictionary.
+ *
+ * Generated by key_dict.awk from aushape.schema.json, do not edit.
+ */
+
+#include <aushape/key_dict.h>
+
+const char aushape_key_dict_version[] = "b7f24899";
+
+const struct aushape_key_def aushape_key_dict_list[] = {
+    {.name = "a0",                        .id = "A"},
+    {.name = "a1",                        .id = "B"},
+    {.name = "a2",                        .id = "C"},
+    {.name = "a3",                        .id = "D"},
+    {.name = "acct",                      .id = "E"},
+    {.name = "acl",                       .id = "F"},
+    {.name = "action",                    .id = "G"},
+    {.name = "added",                     .id = "H"},
+    {.name = "addr",                      .id = "I"},
+    {.name = "algo",                      .id = "J"},
+    {.name = "apparmor",                  .id = "K"},
+    {.name = "arch",                      .id = "L"},
+    {.name = "argc",                      .id = "M"},
+    {.name = "audit_backlog_limit",       .id = "N"},
+    {.name = "audit_backlog_wait_time",   .id = "O"},
+    {.name = "audit_enabled",             .id = "P"},
+    {.name = "audit_failure",             .id = "Q"},
+    {.name = "auid",                      .id = "R"},
+    {.name = "banners",                   .id = "S"},
+    {.name = "bool",                      .id = "T"},
+    {.name = "bus",                       .id = "U"},
+    {.name = "capability",                .id = "V"},
+    {.name = "cap_fe",                    .id = "W"},
+    {.name = "cap_fi",                    .id = "X"},
+    {.name = "cap_fp",                    .id = "Y"},
+    {.name = "cap_fver",                  .id = "Z"},
+    {.name = "cap_pe",                    .id = "A0"},
+    {.name = "cap_pi",                    .id = "A1"},
+    {.name = "cap_pp",                    .id = "A2"},
+    {.name = "category",                  .id = "A3"},
+    {.name = "cgroup",                    .id = "A4"},
+    {.name = "changed",                   .id = "A5"},
+    {.name = "cipher",                    .id = "A6"},
+    {.name = "class",                     .id = "A7"},
+    {.name = "cmd",                       .id = "A8"},
+    {.name = "code",                      .id = "A9"},
+    {.name = "comm",                      .id = "AA"},
+    {.name = "compat",                    .id = "AB"},
+    {.name = "cwd",                       .id = "AC"},
+    {.name = "daddr",                     .id = "AD"},
+    {.name = "data",                      .id = "AE"},
+    {.name = "default-context",           .id = "AF"},
+    {.name = "dest",                      .id = "AG"},
+    {.name = "dev",                       .id = "AH"},
+    {.name = "device",                    .id = "AI"},
+    {.name = "dir",                       .id = "AJ"},
+    {.name = "direction",                 .id = "AK"},
+    {.name = "dmac",                      .id = "AL"},
+    {.name = "dport",                     .id = "AM"},
+    {.name = "egid",                      .id = "AN"},
+    {.name = "enforcing",                 .id = "AO"},
+    {.name = "entries",                   .id = "AP"},
+    {.name = "euid",                      .id = "AQ"},
+    {.name = "exe",                       .id = "AR"},
+    {.name = "exit",                      .id = "AS"},
+    {.name = "fam",                       .id = "AT"},
+    {.name = "family",                    .id = "AU"},
+    {.name = "fd",                        .id = "AV"},
+    {.name = "fe",                        .id = "AW"},
+    {.name = "feature",                   .id = "AX"},
+    {.name = "fi",                        .id = "AY"},
+    {.name = "file",                      .id = "AZ"},
+    {.name = "flags",                     .id = "B0"},
+    {.name = "format",                    .id = "B1"},
+    {.name = "fp",                        .id = "B2"},
+    {.name = "fsgid",                     .id = "B3"},
+    {.name = "fsuid",                     .id = "B4"},
+    {.name = "fver",                      .id = "B5"},
+    {.name = "gid",                       .id = "B6"},
+    {.name = "grantors",                  .id = "B7"},
+    {.name = "grp",                       .id = "B8"},
+    {.name = "hook",                      .id = "B9"},
+    {.name = "hostname",                  .id = "BA"},
+    {.name = "icmp_type",                 .id = "BB"},
+    {.name = "id",                        .id = "BC"},
+    {.name = "igid",                      .id = "BD"},
+    {.name = "img-ctx",                   .id = "BE"},
+    {.name = "inif",                      .id = "BF"},
+    {.name = "ino",                       .id = "BG"},
+    {.name = "inode",                     .id = "BH"},
+    {.name = "inode_gid",                 .id = "BI"},
+    {.name = "inode_uid",                 .id = "BJ"},
+    {.name = "invalid_context",           .id = "BK"},
+    {.name = "ioctlcmd",                  .id = "BL"},
+    {.name = "ip",                        .id = "BM"},
+    {.name = "ipid",                      .id = "BN"},
+    {.name = "ipx-net",                   .id = "BO"},
+    {.name = "items",                     .id = "BP"},
+    {.name = "iuid",                      .id = "BQ"},
+    {.name = "kernel",                    .id = "BR"},
+    {.name = "key",                       .id = "BS"},
+    {.name = "kind",                      .id = "BT"},
+    {.name = "ksize",                     .id = "BU"},
+    {.name = "laddr",                     .id = "BV"},
+    {.name = "len",                       .id = "BW"},
+    {.name = "list",                      .id = "BX"},
+    {.name = "lport",                     .id = "BY"},
+    {.name = "mac",                       .id = "BZ"},
+    {.name = "macproto",                  .id = "C0"},
+    {.name = "maj",                       .id = "C1"},
+    {.name = "major",                     .id = "C2"},
+    {.name = "minor",                     .id = "C3"},
+    {.name = "mode",                      .id = "C4"},
+    {.name = "model",                     .id = "C5"},
+    {.name = "msg",                       .id = "C6"},
+    {.name = "name",                      .id = "C7"},
+    {.name = "nametype",                  .id = "C8"},
+    {.name = "nargs",                     .id = "C9"},
+    {.name = "net",                       .id = "CA"},
+    {.name = "new",                       .id = "CB"},
+    {.name = "new-chardev",               .id = "CC"},
+    {.name = "new-disk",                  .id = "CD"},
+    {.name = "new-enabled",               .id = "CE"},
+    {.name = "new-fs",                    .id = "CF"},
+    {.name = "new_gid",                   .id = "CG"},
+    {.name = "new-level",                 .id = "CH"},
+    {.name = "new_lock",                  .id = "CI"},
+    {.name = "new-log_passwd",            .id = "CJ"},
+    {.name = "new-mem",                   .id = "CK"},
+    {.name = "new-net",                   .id = "CL"},
+    {.name = "new_pe",                    .id = "CM"},
+    {.name = "new_pi",                    .id = "CN"},
+    {.name = "new_pp",                    .id = "CO"},
+    {.name = "new-range",                 .id = "CP"},
+    {.name = "new-rng",                   .id = "CQ"},
+    {.name = "new-role",                  .id = "CR"},
+    {.name = "new-seuser",                .id = "CS"},
+    {.name = "new-vcpu",                  .id = "CT"},
+    {.name = "nlnk-fam",                  .id = "CU"},
+    {.name = "nlnk-grp",                  .id = "CV"},
+    {.name = "nlnk-pid",                  .id = "CW"},
+    {.name = "oauid",                     .id = "CX"},
+    {.name = "obj",                       .id = "CY"},
+    {.name = "obj_gid",                   .id = "CZ"},
+    {.name = "obj_uid",                   .id = "D0"},
+    {.name = "objtype",                   .id = "D1"},
+    {.name = "ocomm",                     .id = "D2"},
+    {.name = "oflag",                     .id = "D3"},
+    {.name = "ogid",                      .id = "D4"},
+    {.name = "old",                       .id = "D5"},
+    {.name = "old-auid",                  .id = "D6"},
+    {.name = "old-chardev",               .id = "D7"},
+    {.name = "old-disk",                  .id = "D8"},
+    {.name = "old-enabled",               .id = "D9"},
+    {.name = "old_enforcing",             .id = "DA"},
+    {.name = "old-fs",                    .id = "DB"},
+    {.name = "old-level",                 .id = "DC"},
+    {.name = "old_lock",                  .id = "DD"},
+    {.name = "old-log_passwd",            .id = "DE"},
+    {.name = "old-mem",                   .id = "DF"},
+    {.name = "old-net",                   .id = "DG"},
+    {.name = "old_pe",                    .id = "DH"},
+    {.name = "old_pi",                    .id = "DI"},
+    {.name = "old_pp",                    .id = "DJ"},
+    {.name = "old_prom",                  .id = "DK"},
+    {.name = "old-range",                 .id = "DL"},
+    {.name = "old-rng",                   .id = "DM"},
+    {.name = "old-role",                  .id = "DN"},
+    {.name = "old-ses",                   .id = "DO"},
+    {.name = "old-seuser",                .id = "DP"},
+    {.name = "old_val",                   .id = "DQ"},
+    {.name = "old-vcpu",                  .id = "DR"},
+    {.name = "op",                        .id = "DS"},
+    {.name = "opid",                      .id = "DT"},
+    {.name = "oses",                      .id = "DU"},
+    {.name = "ouid",                      .id = "DV"},
+    {.name = "outif",                     .id = "DW"},
+    {.name = "parent",                    .id = "DX"},
+    {.name = "path",                      .id = "DY"},
+    {.name = "per",                       .id = "DZ"},
+    {.name = "perm",                      .id = "E0"},
+    {.name = "permissive",                .id = "E1"},
+    {.name = "perm_mask",                 .id = "E2"},
+    {.name = "pfs",                       .id = "E3"},
+    {.name = "pid",                       .id = "E4"},
+    {.name = "ppid",                      .id = "E5"},
+    {.name = "printer",                   .id = "E6"},
+    {.name = "proctitle",                 .id = "E7"},
+    {.name = "prom",                      .id = "E8"},
+    {.name = "proto",                     .id = "E9"},
+    {.name = "qbytes",                    .id = "EA"},
+    {.name = "range",                     .id = "EB"},
+    {.name = "rdev",                      .id = "EC"},
+    {.name = "reason",                    .id = "ED"},
+    {.name = "removed",                   .id = "EE"},
+    {.name = "res",                       .id = "EF"},
+    {.name = "resrc",                     .id = "EG"},
+    {.name = "result",                    .id = "EH"},
+    {.name = "role",                      .id = "EI"},
+    {.name = "rport",                     .id = "EJ"},
+    {.name = "saddr",                     .id = "EK"},
+    {.name = "sauid",                     .id = "EL"},
+    {.name = "scontext",                  .id = "EM"},
+    {.name = "selected-context",          .id = "EN"},
+    {.name = "seperm",                    .id = "EO"},
+    {.name = "seperms",                   .id = "EP"},
+    {.name = "seqno",                     .id = "EQ"},
+    {.name = "seresult",                  .id = "ER"},
+    {.name = "ses",                       .id = "ES"},
+    {.name = "seuser",                    .id = "ET"},
+    {.name = "sgid",                      .id = "EU"},
+    {.name = "sig",                       .id = "EV"},
+    {.name = "sigev_signo",               .id = "EW"},
+    {.name = "size",                      .id = "EX"},
+    {.name = "smac",                      .id = "EY"},
+    {.name = "spid",                      .id = "EZ"},
+    {.name = "sport",                     .id = "F0"},
+    {.name = "state",                     .id = "F1"},
+    {.name = "subj",                      .id = "F2"},
+    {.name = "success",                   .id = "F3"},
+    {.name = "suid",                      .id = "F4"},
+    {.name = "syscall",                   .id = "F5"},
+    {.name = "table",                     .id = "F6"},
+    {.name = "tclass",                    .id = "F7"},
+    {.name = "tcontext",                  .id = "F8"},
+    {.name = "terminal",                  .id = "F9"},
+    {.name = "tty",                       .id = "FA"},
+    {.name = "type",                      .id = "FB"},
+    {.name = "uid",                       .id = "FC"},
+    {.name = "unit",                      .id = "FD"},
+    {.name = "uri",                       .id = "FE"},
+    {.name = "user",                      .id = "FF"},
+    {.name = "uuid",                      .id = "FG"},
+    {.name = "val",                       .id = "FH"},
+    {.name = "ver",                       .id = "FI"},
+    {.name = "virt",                      .id = "FJ"},
+    {.name = "vm",                        .id = "FK"},
+    {.name = "vm-ctx",                    .id = "FL"},
+    {.name = "vm-pid",                    .id = "FM"},
+    {.name = "watch",                     .id = "FN"},
+    {.name = "serial",                    .id = "FO"},
+    {.name = "time",                      .id = "FP"},
+    {.name = "node",                      .id = "FQ"},
+    {.name = "error",                     .id = "FR"},
+    {.name = "trimmed",                   .id = "FS"},
+    {.name = "text",                      .id = "FT"},
+    {.name = "acct_lock",                 .id = "FU"},
+    {.name = "acct_unlock",               .id = "FV"},
+    {.name = "add_group",                 .id = "FW"},
+    {.name = "add_user",                  .id = "FX"},
+    {.name = "anom_abend",                .id = "FY"},
+    {.name = "anom_access_fs",            .id = "FZ"},
+    {.name = "anom_add_acct",             .id = "G0"},
+    {.name = "anom_amtu_fail",            .id = "G1"},
+    {.name = "anom_crypto_fail",          .id = "G2"},
+    {.name = "anom_del_acct",             .id = "G3"},
+    {.name = "anom_exec",                 .id = "G4"},
+    {.name = "anom_link",                 .id = "G5"},
+    {.name = "anom_login_acct",           .id = "G6"},
+    {.name = "anom_login_failures",       .id = "G7"},
+    {.name = "anom_login_location",       .id = "G8"},
+    {.name = "anom_login_sessions",       .id = "G9"},
+    {.name = "anom_login_time",           .id = "GA"},
+    {.name = "anom_max_dac",              .id = "GB"},
+    {.name = "anom_max_mac",              .id = "GC"},
+    {.name = "anom_mk_exec",              .id = "GD"},
+    {.name = "anom_mod_acct",             .id = "GE"},
+    {.name = "anom_promiscuous",          .id = "GF"},
+    {.name = "anom_rbac_fail",            .id = "GG"},
+    {.name = "anom_rbac_integrity_fail",  .id = "GH"},
+    {.name = "anom_root_trans",           .id = "GI"},
+    {.name = "apparmor_allowed",          .id = "GJ"},
+    {.name = "apparmor_audit",            .id = "GK"},
+    {.name = "apparmor_denied",           .id = "GL"},
+    {.name = "apparmor_error",            .id = "GM"},
+    {.name = "apparmor_hint",             .id = "GN"},
+    {.name = "apparmor_status",           .id = "GO"},
+    {.name = "avc",                       .id = "GP"},
+    {.name = "avc_path",                  .id = "GQ"},
+    {.name = "bprm_fcaps",                .id = "GR"},
+    {.name = "capset",                    .id = "GS"},
+    {.name = "chgrp_id",                  .id = "GT"},
+    {.name = "chuser_id",                 .id = "GU"},
+    {.name = "config_change",             .id = "GV"},
+    {.name = "cred_acq",                  .id = "GW"},
+    {.name = "cred_disp",                 .id = "GX"},
+    {.name = "cred_refr",                 .id = "GY"},
+    {.name = "crypto_failure_user",       .id = "GZ"},
+    {.name = "crypto_ike_sa",             .id = "H0"},
+    {.name = "crypto_ipsec_sa",           .id = "H1"},
+    {.name = "crypto_key_user",           .id = "H2"},
+    {.name = "crypto_login",              .id = "H3"},
+    {.name = "crypto_logout",             .id = "H4"},
+    {.name = "crypto_param_change_user",  .id = "H5"},
+    {.name = "crypto_replay_user",        .id = "H6"},
+    {.name = "crypto_session",            .id = "H7"},
+    {.name = "crypto_test_user",          .id = "H8"},
+    {.name = "dac_check",                 .id = "H9"},
+    {.name = "daemon_abort",              .id = "HA"},
+    {.name = "daemon_accept",             .id = "HB"},
+    {.name = "daemon_close",              .id = "HC"},
+    {.name = "daemon_config",             .id = "HD"},
+    {.name = "daemon_end",                .id = "HE"},
+    {.name = "daemon_err",                .id = "HF"},
+    {.name = "daemon_resume",             .id = "HG"},
+    {.name = "daemon_rotate",             .id = "HH"},
+    {.name = "daemon_start",              .id = "HI"},
+    {.name = "del_group",                 .id = "HJ"},
+    {.name = "del_user",                  .id = "HK"},
+    {.name = "dev_alloc",                 .id = "HL"},
+    {.name = "dev_dealloc",               .id = "HM"},
+    {.name = "execve",                    .id = "HN"},
+    {.name = "fd_pair",                   .id = "HO"},
+    {.name = "feature_change",            .id = "HP"},
+    {.name = "fs_relabel",                .id = "HQ"},
+    {.name = "grp_auth",                  .id = "HR"},
+    {.name = "grp_chauthtok",             .id = "HS"},
+    {.name = "grp_mgmt",                  .id = "HT"},
+    {.name = "integrity_data",            .id = "HU"},
+    {.name = "integrity_hash",            .id = "HV"},
+    {.name = "integrity_metadata",        .id = "HW"},
+    {.name = "integrity_pcr",             .id = "HX"},
+    {.name = "integrity_rule",            .id = "HY"},
+    {.name = "integrity_status",          .id = "HZ"},
+    {.name = "ipc",                       .id = "I0"},
+    {.name = "ipc_set_perm",              .id = "I1"},
+    {.name = "kernel_other",              .id = "I2"},
+    {.name = "label_level_change",        .id = "I3"},
+    {.name = "label_override",            .id = "I4"},
+    {.name = "login",                     .id = "I5"},
+    {.name = "mac_check",                 .id = "I6"},
+    {.name = "mac_cipsov4_add",           .id = "I7"},
+    {.name = "mac_cipsov4_del",           .id = "I8"},
+    {.name = "mac_config_change",         .id = "I9"},
+    {.name = "mac_ipsec_addsa",           .id = "IA"},
+    {.name = "mac_ipsec_addspd",          .id = "IB"},
+    {.name = "mac_ipsec_delsa",           .id = "IC"},
+    {.name = "mac_ipsec_delspd",          .id = "ID"},
+    {.name = "mac_ipsec_event",           .id = "IE"},
+    {.name = "mac_map_add",               .id = "IF"},
+    {.name = "mac_map_del",               .id = "IG"},
+    {.name = "mac_policy_load",           .id = "IH"},
+    {.name = "mac_status",                .id = "II"},
+    {.name = "mac_unlbl_allow",           .id = "IJ"},
+    {.name = "mac_unlbl_stcadd",          .id = "IK"},
+    {.name = "mac_unlbl_stcdel",          .id = "IL"},
+    {.name = "mmap",                      .id = "IM"},
+    {.name = "mq_getsetattr",             .id = "IN"},
+    {.name = "mq_notify",                 .id = "IO"},
+    {.name = "mq_open",                   .id = "IP"},
+    {.name = "mq_sendrecv",               .id = "IQ"},
+    {.name = "netfilter_cfg",             .id = "IR"},
+    {.name = "netfilter_pkt",             .id = "IS"},
+    {.name = "obj_pid",                   .id = "IT"},
+    {.name = "resp_acct_lock",            .id = "IU"},
+    {.name = "resp_acct_lock_timed",      .id = "IV"},
+    {.name = "resp_acct_remote",          .id = "IW"},
+    {.name = "resp_acct_unlock_timed",    .id = "IX"},
+    {.name = "resp_alert",                .id = "IY"},
+    {.name = "resp_anomaly",              .id = "IZ"},
+    {.name = "resp_exec",                 .id = "J0"},
+    {.name = "resp_halt",                 .id = "J1"},
+    {.name = "resp_kill_proc",            .id = "J2"},
+    {.name = "resp_sebool",               .id = "J3"},
+    {.name = "resp_single",               .id = "J4"},
+    {.name = "resp_term_access",          .id = "J5"},
+    {.name = "resp_term_lock",            .id = "J6"},
+    {.name = "role_assign",               .id = "J7"},
+    {.name = "role_modify",               .id = "J8"},
+    {.name = "role_remove",               .id = "J9"},
+    {.name = "seccomp",                   .id = "JA"},
+    {.name = "selinux_err",               .id = "JB"},
+    {.name = "service_start",             .id = "JC"},
+    {.name = "service_stop",              .id = "JD"},
+    {.name = "sockaddr",                  .id = "JE"},
+    {.name = "socketcall",                .id = "JF"},
+    {.name = "system_boot",               .id = "JG"},
+    {.name = "system_runlevel",           .id = "JH"},
+    {.name = "system_shutdown",           .id = "JI"},
+    {.name = "test",                      .id = "JJ"},
+    {.name = "trusted_app",               .id = "JK"},
+    {.name = "user_acct",                 .id = "JL"},
+    {.name = "user_auth",                 .id = "JM"},
+    {.name = "user_avc",                  .id = "JN"},
+    {.name = "user_chauthtok",            .id = "JO"},
+    {.name = "user_cmd",                  .id = "JP"},
+    {.name = "user_end",                  .id = "JQ"},
+    {.name = "user_err",                  .id = "JR"},
+    {.name = "user_labeled_export",       .id = "JS"},
+    {.name = "user_login",                .id = "JT"},
+    {.name = "user_logout",               .id = "JU"},
+    {.name = "user_mac_config_change",    .id = "JV"},
+    {.name = "user_mac_policy_load",      .id = "JW"},
+    {.name = "user_mgmt",                 .id = "JX"},
+    {.name = "user_role_change",          .id = "JY"},
+    {.name = "user_selinux_err",          .id = "JZ"},
+    {.name = "user_start",                .id = "K0"},
+    {.name = "user_tty",                  .id = "K1"},
+    {.name = "user_unlabeled_export",     .id = "K2"},
+    {.name = "usys_config",               .id = "K3"},
+    {.name = "virt_control",              .id = "K4"},
+    {.name = "virt_machine_id",           .id = "K5"},
+    {.name = "virt_resource",             .id = "K6"},
+    {.name = "norm",                      .id = "K7"},
+    {.name = "event_kind",                .id = "K8"},
+    {.name = "session",                   .id = "K9"},
+    {.name = "subject_kind",              .id = "KA"},
+    {.name = "subject_primary",           .id = "KB"},
+    {.name = "subject_secondary",         .id = "KC"},
+    {.name = "subject_attrs",             .id = "KD"},
+    {.name = "object_kind",               .id = "KE"},
+    {.name = "object_primary",            .id = "KF"},
+    {.name = "object_secondary",          .id = "KG"},
+    {.name = "object_primary2",           .id = "KH"},
+    {.name = "object_attrs",              .id = "KI"},
+    {.name = "how",                       .id = "KJ"},
+};
+
+const unsigned short aushape_key_dict_sorted[] = {
+    0, 1, 2, 3, 4, 236, 237, 5,
+    6, 238, 239, 7, 8, 9, 240, 241,
+    242, 243, 244, 245, 246, 247, 248, 249,
+    250, 251, 252, 253, 254, 255, 256, 257,
+    258, 259, 260, 10, 261, 262, 263, 264,
+    265, 266, 11, 12, 13, 14, 15, 16,
+    17, 267, 268, 18, 19, 269, 20, 22,
+    23, 24, 25, 26, 27, 28, 21, 270,
+    29, 30, 31, 271, 272, 32, 33, 34,
+    35, 36, 37, 273, 274, 275, 276, 277,
+    278, 279, 280, 281, 282, 283, 284, 285,
+    286, 38, 287, 39, 288, 289, 290, 291,
+    292, 293, 294, 295, 296, 40, 41, 297,
+    298, 42, 43, 299, 300, 44, 45, 46,
+    47, 48, 49, 50, 51, 233, 52, 394,
+    53, 301, 54, 55, 56, 57, 302, 58,
+    59, 303, 60, 61, 62, 63, 64, 304,
+    65, 66, 67, 68, 69, 70, 305, 306,
+    307, 71, 72, 405, 73, 74, 75, 76,
+    77, 78, 79, 80, 81, 308, 309, 310,
+    311, 312, 313, 82, 83, 84, 314, 315,
+    85, 86, 87, 88, 89, 316, 90, 91,
+    92, 317, 318, 93, 94, 95, 319, 96,
+    97, 320, 321, 322, 323, 324, 325, 326,
+    327, 328, 329, 330, 331, 332, 333, 334,
+    335, 98, 99, 100, 101, 336, 102, 103,
+    337, 338, 339, 340, 104, 105, 106, 107,
+    108, 341, 342, 109, 110, 111, 112, 113,
+    115, 117, 118, 119, 123, 124, 125, 126,
+    127, 114, 116, 120, 121, 122, 128, 129,
+    130, 232, 393, 131, 132, 133, 343, 134,
+    404, 400, 401, 403, 402, 135, 136, 137,
+    138, 139, 140, 141, 142, 143, 145, 146,
+    148, 149, 150, 155, 156, 157, 158, 159,
+    161, 144, 147, 151, 152, 153, 154, 160,
+    162, 163, 164, 165, 166, 167, 168, 169,
+    170, 172, 171, 173, 174, 175, 176, 177,
+    178, 179, 180, 181, 182, 183, 184, 185,
+    344, 345, 346, 347, 348, 349, 350, 351,
+    352, 353, 354, 355, 356, 186, 187, 188,
+    357, 358, 359, 189, 190, 191, 192, 360,
+    193, 361, 194, 195, 196, 197, 230, 362,
+    363, 198, 395, 199, 200, 201, 202, 203,
+    204, 364, 365, 205, 206, 207, 208, 399,
+    396, 397, 398, 209, 210, 211, 366, 367,
+    368, 212, 213, 214, 215, 369, 235, 231,
+    234, 370, 216, 217, 218, 219, 220, 221,
+    371, 372, 373, 374, 375, 376, 377, 378,
+    379, 380, 381, 382, 383, 384, 385, 386,
+    387, 388, 389, 222, 223, 224, 225, 390,
+    391, 392, 226, 227, 228, 229,
+};
+
+const size_t aushape_key_dict_num = 406;
@@ -83,6 +83,31 @@ aushape_output_write(struct aushape_output *output,
     return output->type->write(output, ptr, len);
 }
 
+enum aushape_rc
+aushape_output_sync(struct aushape_output *output, bool full)
+{
+    if (!aushape_output_is_valid(output)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    if (output->type->sync == NULL) {
+        return AUSHAPE_RC_OK;
+    }
+    return output->type->sync(output, full);
+}
+
+enum aushape_rc
+aushape_output_event(struct aushape_output *output,
+                     const struct aushape_output_event *event)
+{
+    if (!aushape_output_is_valid(output) || event == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+    if (output->type->event == NULL) {
+        return AUSHAPE_RC_OK;
+    }
+    return output->type->event(output, event);
+}
+
 void
 aushape_output_destroy(struct aushape_output *output)
 {
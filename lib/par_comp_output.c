@@ -0,0 +1,610 @@
+/*
+ * Parallel compressing aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/par_comp_output.h>
+#include <aushape/gbuf.h>
+#include <aushape/guard.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <pthread.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/** Initial size of block buffers, bytes */
+#define AUSHAPE_PAR_COMP_OUTPUT_BUF_SIZE    (64 * 1024)
+
+/** Number of blocks per worker thread, in compression or waiting for it */
+#define AUSHAPE_PAR_COMP_OUTPUT_JOBS_PER_WORKER 2
+
+/** Block compression job */
+struct aushape_par_comp_output_job {
+    struct aushape_gbuf in;     /**< Uncompressed block */
+    struct aushape_gbuf out;    /**< Compressed block */
+    bool done;                  /**< True if compression is done */
+    enum aushape_rc rc;         /**< Compression return code, if done */
+};
+
+/** Forward declaration of parallel compressing output data */
+struct aushape_par_comp_output;
+
+/** Compression worker */
+struct aushape_par_comp_output_worker {
+    /** The output the worker belongs to */
+    struct aushape_par_comp_output *par_comp_output;
+    pthread_t thread;           /**< Worker thread */
+    bool gzip_init;             /**< True if gzip stream is initialized */
+    z_stream gzip;              /**< gzip stream */
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx *zstd;            /**< zstd compression context */
+#endif
+};
+
+/** Parallel compressing output data */
+struct aushape_par_comp_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    struct aushape_output *inner;   /**< Output to write compressed data to */
+    bool inner_owned;               /**< True if inner output is owned */
+    enum aushape_comp comp;         /**< Compression algorithm */
+    size_t block_size;              /**< Minimum uncompressed block size */
+
+    /** Worker list */
+    struct aushape_par_comp_output_worker  *worker_list;
+    /** Number of workers in the list */
+    size_t                                  worker_num;
+    /** Number of workers with running threads, the first in the list */
+    size_t                                  worker_run_num;
+
+    /** Job ring, block with sequence number N goes to slot N % job_num */
+    struct aushape_par_comp_output_job     *job_list;
+    /** Number of jobs in the ring */
+    size_t                                  job_num;
+
+    /** True if the mutex and conditions below are initialized */
+    bool            sync_init;
+    /** Mutex protecting everything below, and job "done" and "rc" */
+    pthread_mutex_t mutex;
+    /** Condition signaled when a block is submitted, or workers stop */
+    pthread_cond_t  submit_cond;
+    /** Condition signaled when a block compression is done */
+    pthread_cond_t  done_cond;
+    /** True if workers should exit when out of blocks */
+    bool            stop;
+    /** Sequence number of the block being filled */
+    size_t          fill_seq;
+    /** Sequence number of the next block to be compressed */
+    size_t          take_seq;
+    /** Sequence number of the next block to be written */
+    size_t          write_seq;
+    /** First failure return code, or OK */
+    enum aushape_rc rc;
+};
+
+/**
+ * Compress a block with gzip.
+ *
+ * @param worker    The worker to compress with.
+ * @param job       The job containing the block to compress.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - compressed successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - compression failed.
+ */
+static enum aushape_rc
+aushape_par_comp_output_worker_gzip(
+                        struct aushape_par_comp_output_worker *worker,
+                        struct aushape_par_comp_output_job *job)
+{
+    enum aushape_rc rc;
+    z_stream *gzip = &worker->gzip;
+    const char *ptr = job->in.ptr;
+    size_t len = job->in.len;
+    size_t space;
+    int zrc;
+
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, deflateReset(gzip) == Z_OK);
+    AUSHAPE_GUARD(aushape_gbuf_accomodate(&job->out,
+                                          deflateBound(gzip, (uLong)len)));
+    gzip->avail_in = 0;
+    do {
+        /* Feed zlib at most what its counters can hold */
+        if (gzip->avail_in == 0 && len > 0) {
+            gzip->next_in = (Bytef *)ptr;
+            gzip->avail_in = len > UINT_MAX ? UINT_MAX : (uInt)len;
+            ptr += gzip->avail_in;
+            len -= gzip->avail_in;
+        }
+        if (job->out.len == job->out.size) {
+            AUSHAPE_GUARD(aushape_gbuf_accomodate(&job->out,
+                                                  job->out.size + 1));
+        }
+        space = job->out.size - job->out.len;
+        gzip->next_out = (Bytef *)job->out.ptr + job->out.len;
+        gzip->avail_out = space > UINT_MAX ? UINT_MAX : (uInt)space;
+        zrc = deflate(gzip, len == 0 ? Z_FINISH : Z_NO_FLUSH);
+        AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                           zrc == Z_OK || zrc == Z_STREAM_END ||
+                           zrc == Z_BUF_ERROR);
+        job->out.len = (char *)gzip->next_out - job->out.ptr;
+    } while (zrc != Z_STREAM_END);
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+#ifdef HAVE_ZSTD
+/**
+ * Compress a block with zstd.
+ *
+ * @param worker    The worker to compress with.
+ * @param job       The job containing the block to compress.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - compressed successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - compression failed.
+ */
+static enum aushape_rc
+aushape_par_comp_output_worker_zstd(
+                        struct aushape_par_comp_output_worker *worker,
+                        struct aushape_par_comp_output_job *job)
+{
+    enum aushape_rc rc;
+    size_t len;
+
+    AUSHAPE_GUARD(aushape_gbuf_accomodate(&job->out,
+                                          ZSTD_compressBound(job->in.len)));
+    len = ZSTD_compress2(worker->zstd, job->out.ptr, job->out.size,
+                         job->in.ptr, job->in.len);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, !ZSTD_isError(len));
+    job->out.len = len;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+#endif
+
+/**
+ * Run a compression worker: compress submitted blocks in order of
+ * submission, until stopped and out of blocks.
+ *
+ * @param arg   The worker to run.
+ *
+ * @return NULL.
+ */
+static void *
+aushape_par_comp_output_worker_run(void *arg)
+{
+    struct aushape_par_comp_output_worker *worker =
+                                (struct aushape_par_comp_output_worker *)arg;
+    struct aushape_par_comp_output *par_comp_output =
+                                worker->par_comp_output;
+    struct aushape_par_comp_output_job *job;
+    enum aushape_rc rc;
+
+    pthread_mutex_lock(&par_comp_output->mutex);
+    while (true) {
+        while (!par_comp_output->stop &&
+               par_comp_output->take_seq == par_comp_output->fill_seq) {
+            pthread_cond_wait(&par_comp_output->submit_cond,
+                              &par_comp_output->mutex);
+        }
+        if (par_comp_output->take_seq == par_comp_output->fill_seq) {
+            break;
+        }
+        job = &par_comp_output->job_list[par_comp_output->take_seq %
+                                         par_comp_output->job_num];
+        par_comp_output->take_seq++;
+        pthread_mutex_unlock(&par_comp_output->mutex);
+
+        switch (par_comp_output->comp) {
+        case AUSHAPE_COMP_GZIP:
+            rc = aushape_par_comp_output_worker_gzip(worker, job);
+            break;
+#ifdef HAVE_ZSTD
+        case AUSHAPE_COMP_ZSTD:
+            rc = aushape_par_comp_output_worker_zstd(worker, job);
+            break;
+#endif
+        default:
+            assert(false);
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            break;
+        }
+
+        pthread_mutex_lock(&par_comp_output->mutex);
+        job->rc = rc;
+        job->done = true;
+        pthread_cond_broadcast(&par_comp_output->done_cond);
+    }
+    pthread_mutex_unlock(&par_comp_output->mutex);
+
+    return NULL;
+}
+
+/**
+ * Write compressed blocks to the inner output, in order, as long as they're
+ * done, or until all submitted blocks are written, or until the ring has a
+ * slot for a new block.
+ *
+ * @param par_comp_output   The parallel compressing output to write blocks
+ *                          of.
+ * @param all               True if all submitted blocks should be written,
+ *                          false if only a slot for a new block is required.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - written successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - compression or writing failed.
+ */
+static enum aushape_rc
+aushape_par_comp_output_drain(struct aushape_par_comp_output *par_comp_output,
+                              bool all)
+{
+    enum aushape_rc rc = AUSHAPE_RC_OK;
+    struct aushape_par_comp_output_job *job;
+
+    pthread_mutex_lock(&par_comp_output->mutex);
+    while (rc == AUSHAPE_RC_OK &&
+           par_comp_output->write_seq < par_comp_output->fill_seq) {
+        job = &par_comp_output->job_list[par_comp_output->write_seq %
+                                         par_comp_output->job_num];
+        if (!job->done) {
+            if (all ||
+                par_comp_output->fill_seq - par_comp_output->write_seq >=
+                    par_comp_output->job_num) {
+                pthread_cond_wait(&par_comp_output->done_cond,
+                                  &par_comp_output->mutex);
+                continue;
+            }
+            break;
+        }
+        pthread_mutex_unlock(&par_comp_output->mutex);
+        rc = job->rc;
+        if (rc == AUSHAPE_RC_OK) {
+            rc = aushape_output_write(par_comp_output->inner,
+                                      job->out.ptr, job->out.len);
+        }
+        aushape_gbuf_empty(&job->in);
+        aushape_gbuf_empty(&job->out);
+        pthread_mutex_lock(&par_comp_output->mutex);
+        job->done = false;
+        par_comp_output->write_seq++;
+    }
+    pthread_mutex_unlock(&par_comp_output->mutex);
+
+    return rc;
+}
+
+/**
+ * End the block being filled, if not empty: submit it for compression, and
+ * write whichever blocks are compressed already.
+ *
+ * @param par_comp_output   The parallel compressing output to end the block
+ *                          of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - ended successfully,
+ *          AUSHAPE_RC_NOMEM                - memory allocation failed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - compression or writing failed.
+ */
+static enum aushape_rc
+aushape_par_comp_output_end_block(
+                        struct aushape_par_comp_output *par_comp_output)
+{
+    struct aushape_par_comp_output_job *job =
+        &par_comp_output->job_list[par_comp_output->fill_seq %
+                                   par_comp_output->job_num];
+
+    if (job->in.len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+    pthread_mutex_lock(&par_comp_output->mutex);
+    par_comp_output->fill_seq++;
+    pthread_cond_signal(&par_comp_output->submit_cond);
+    pthread_mutex_unlock(&par_comp_output->mutex);
+
+    return aushape_par_comp_output_drain(par_comp_output, false);
+}
+
+static void
+aushape_par_comp_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_par_comp_output *par_comp_output =
+                                    (struct aushape_par_comp_output *)output;
+    struct aushape_par_comp_output_worker *worker;
+    size_t i;
+
+    assert(par_comp_output != NULL);
+
+    /* Try to write the remaining blocks, and stop the workers */
+    if (par_comp_output->worker_run_num > 0) {
+        if (par_comp_output->rc == AUSHAPE_RC_OK) {
+            aushape_par_comp_output_end_block(par_comp_output);
+        }
+        aushape_par_comp_output_drain(par_comp_output, true);
+        pthread_mutex_lock(&par_comp_output->mutex);
+        par_comp_output->stop = true;
+        pthread_cond_broadcast(&par_comp_output->submit_cond);
+        pthread_mutex_unlock(&par_comp_output->mutex);
+        for (i = 0; i < par_comp_output->worker_run_num; i++) {
+            pthread_join(par_comp_output->worker_list[i].thread, NULL);
+        }
+        par_comp_output->worker_run_num = 0;
+    }
+
+    if (par_comp_output->sync_init) {
+        pthread_cond_destroy(&par_comp_output->done_cond);
+        pthread_cond_destroy(&par_comp_output->submit_cond);
+        pthread_mutex_destroy(&par_comp_output->mutex);
+        par_comp_output->sync_init = false;
+    }
+
+    for (i = 0; i < par_comp_output->worker_num; i++) {
+        worker = &par_comp_output->worker_list[i];
+        if (worker->gzip_init) {
+            deflateEnd(&worker->gzip);
+        }
+#ifdef HAVE_ZSTD
+        ZSTD_freeCCtx(worker->zstd);
+#endif
+    }
+    free(par_comp_output->worker_list);
+    par_comp_output->worker_list = NULL;
+    par_comp_output->worker_num = 0;
+
+    for (i = 0; i < par_comp_output->job_num; i++) {
+        aushape_gbuf_cleanup(&par_comp_output->job_list[i].in);
+        aushape_gbuf_cleanup(&par_comp_output->job_list[i].out);
+    }
+    free(par_comp_output->job_list);
+    par_comp_output->job_list = NULL;
+    par_comp_output->job_num = 0;
+
+    if (par_comp_output->inner_owned) {
+        aushape_output_destroy(par_comp_output->inner);
+        par_comp_output->inner = NULL;
+        par_comp_output->inner_owned = false;
+    }
+}
+
+static enum aushape_rc
+aushape_par_comp_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_par_comp_output *par_comp_output =
+                                    (struct aushape_par_comp_output *)output;
+    struct aushape_output *inner = va_arg(ap, struct aushape_output *);
+    bool inner_owned = (bool)va_arg(ap, int);
+    enum aushape_comp comp = (enum aushape_comp)va_arg(ap, int);
+    int level = va_arg(ap, int);
+    size_t block_size = va_arg(ap, size_t);
+    size_t threads = va_arg(ap, size_t);
+    struct aushape_par_comp_output_worker *worker;
+    enum aushape_rc rc;
+    size_t i;
+
+    assert(par_comp_output != NULL);
+
+    if (!aushape_output_is_valid(inner) ||
+        !aushape_output_is_cont(inner) ||
+        !aushape_comp_is_valid(comp) ||
+        !aushape_comp_is_available(comp) ||
+        !aushape_comp_level_is_valid(comp, level) ||
+        threads == 0 ||
+        threads > SIZE_MAX / AUSHAPE_PAR_COMP_OUTPUT_JOBS_PER_WORKER) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    par_comp_output->comp = comp;
+    par_comp_output->block_size = block_size;
+
+    /* Allocate the job ring */
+    par_comp_output->job_list =
+            calloc(threads * AUSHAPE_PAR_COMP_OUTPUT_JOBS_PER_WORKER,
+                   sizeof(*par_comp_output->job_list));
+    AUSHAPE_GUARD_BOOL(NOMEM, par_comp_output->job_list != NULL);
+    par_comp_output->job_num = threads *
+                               AUSHAPE_PAR_COMP_OUTPUT_JOBS_PER_WORKER;
+    for (i = 0; i < par_comp_output->job_num; i++) {
+        aushape_gbuf_init(&par_comp_output->job_list[i].in,
+                          AUSHAPE_PAR_COMP_OUTPUT_BUF_SIZE, NULL);
+        aushape_gbuf_init(&par_comp_output->job_list[i].out,
+                          AUSHAPE_PAR_COMP_OUTPUT_BUF_SIZE, NULL);
+    }
+
+    /* Allocate workers and their compressors */
+    par_comp_output->worker_list =
+            calloc(threads, sizeof(*par_comp_output->worker_list));
+    AUSHAPE_GUARD_BOOL(NOMEM, par_comp_output->worker_list != NULL);
+    par_comp_output->worker_num = threads;
+    for (i = 0; i < par_comp_output->worker_num; i++) {
+        worker = &par_comp_output->worker_list[i];
+        worker->par_comp_output = par_comp_output;
+        switch (comp) {
+        case AUSHAPE_COMP_GZIP:
+            /* Add 16 to window bits to have gzip header and trailer */
+            switch (deflateInit2(&worker->gzip,
+                                 level == AUSHAPE_COMP_LEVEL_DEFAULT
+                                    ? Z_DEFAULT_COMPRESSION : level,
+                                 Z_DEFLATED, MAX_WBITS + 16, 8,
+                                 Z_DEFAULT_STRATEGY)) {
+            case Z_OK:
+                break;
+            case Z_MEM_ERROR:
+                rc = AUSHAPE_RC_NOMEM;
+                goto cleanup;
+            default:
+                rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+                goto cleanup;
+            }
+            worker->gzip_init = true;
+            break;
+#ifdef HAVE_ZSTD
+        case AUSHAPE_COMP_ZSTD:
+            worker->zstd = ZSTD_createCCtx();
+            AUSHAPE_GUARD_BOOL(NOMEM, worker->zstd != NULL);
+            AUSHAPE_GUARD_BOOL(
+                OUTPUT_INIT_FAILED,
+                (level == AUSHAPE_COMP_LEVEL_DEFAULT ||
+                 !ZSTD_isError(ZSTD_CCtx_setParameter(
+                                    worker->zstd,
+                                    ZSTD_c_compressionLevel, level))) &&
+                !ZSTD_isError(ZSTD_CCtx_setParameter(
+                                    worker->zstd,
+                                    ZSTD_c_checksumFlag, 1)));
+            break;
+#endif
+        default:
+            rc = AUSHAPE_RC_INVALID_ARGS;
+            goto cleanup;
+        }
+    }
+
+    /* Start the workers */
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_mutex_init(&par_comp_output->mutex,
+                                          NULL) == 0);
+    if (pthread_cond_init(&par_comp_output->submit_cond, NULL) != 0) {
+        pthread_mutex_destroy(&par_comp_output->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    if (pthread_cond_init(&par_comp_output->done_cond, NULL) != 0) {
+        pthread_cond_destroy(&par_comp_output->submit_cond);
+        pthread_mutex_destroy(&par_comp_output->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    par_comp_output->sync_init = true;
+    for (i = 0; i < par_comp_output->worker_num; i++) {
+        worker = &par_comp_output->worker_list[i];
+        AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                           pthread_create(&worker->thread, NULL,
+                                          aushape_par_comp_output_worker_run,
+                                          worker) == 0);
+        par_comp_output->worker_run_num++;
+    }
+
+    par_comp_output->inner = inner;
+    par_comp_output->inner_owned = inner_owned;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_par_comp_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_par_comp_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_par_comp_output *par_comp_output =
+                                    (struct aushape_par_comp_output *)output;
+    assert(par_comp_output != NULL);
+
+    return aushape_output_is_valid(par_comp_output->inner) &&
+           aushape_comp_is_valid(par_comp_output->comp) &&
+           par_comp_output->job_list != NULL &&
+           par_comp_output->worker_run_num > 0 &&
+           par_comp_output->worker_run_num == par_comp_output->worker_num;
+}
+
+static enum aushape_rc
+aushape_par_comp_output_write(struct aushape_output *output,
+                              const char *ptr,
+                              size_t len)
+{
+    struct aushape_par_comp_output *par_comp_output =
+                                    (struct aushape_par_comp_output *)output;
+    struct aushape_par_comp_output_job *job;
+    enum aushape_rc rc;
+
+    assert(par_comp_output != NULL);
+
+    if (par_comp_output->rc != AUSHAPE_RC_OK) {
+        return par_comp_output->rc;
+    }
+    if (len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+
+    job = &par_comp_output->job_list[par_comp_output->fill_seq %
+                                     par_comp_output->job_num];
+    AUSHAPE_GUARD(aushape_gbuf_add_buf(&job->in, ptr, len));
+    /* Don't let a large document hold up the workers */
+    if (par_comp_output->block_size > 0 &&
+        job->in.len / AUSHAPE_PAR_COMP_OUTPUT_BLOCK_MAX_RATIO >=
+            par_comp_output->block_size) {
+        AUSHAPE_GUARD(aushape_par_comp_output_end_block(par_comp_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    par_comp_output->rc = rc;
+    return rc;
+}
+
+static enum aushape_rc
+aushape_par_comp_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_par_comp_output *par_comp_output =
+                                    (struct aushape_par_comp_output *)output;
+    struct aushape_par_comp_output_job *job;
+    enum aushape_rc rc;
+
+    assert(par_comp_output != NULL);
+
+    if (par_comp_output->rc != AUSHAPE_RC_OK) {
+        return par_comp_output->rc;
+    }
+
+    job = &par_comp_output->job_list[par_comp_output->fill_seq %
+                                     par_comp_output->job_num];
+    if (full || job->in.len >= par_comp_output->block_size) {
+        AUSHAPE_GUARD(aushape_par_comp_output_end_block(par_comp_output));
+    }
+    if (full) {
+        AUSHAPE_GUARD(aushape_par_comp_output_drain(par_comp_output, true));
+    }
+
+    /* Only complete blocks are written to the inner output */
+    AUSHAPE_GUARD(aushape_output_sync(par_comp_output->inner, full));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    par_comp_output->rc = rc;
+    return rc;
+}
+
+const struct aushape_output_type aushape_par_comp_output_type = {
+    .size       = sizeof(struct aushape_par_comp_output),
+    .cont       = true,
+    .init       = aushape_par_comp_output_init,
+    .is_valid   = aushape_par_comp_output_is_valid,
+    .write      = aushape_par_comp_output_write,
+    .sync       = aushape_par_comp_output_sync,
+    .cleanup    = aushape_par_comp_output_cleanup,
+};
@@ -20,7 +20,6 @@
 
 #include <aushape/path_coll.h>
 #include <aushape/coll.h>
-#include <aushape/field.h>
 #include <aushape/guard.h>
 #include <string.h>
 #include <stdio.h>
@@ -32,15 +31,15 @@
 struct aushape_path_coll {
     /** Abstract base collector */
     struct aushape_coll             coll;
-    /** Growing buffer tree for output */
-    struct aushape_gbtree           gbtree;
+    /** Collected path items, indexed by item index */
+    struct aushape_itree            items;
 };
 
 static bool
 aushape_path_coll_is_valid(const struct aushape_coll *coll)
 {
     struct aushape_path_coll *path_coll = (struct aushape_path_coll *)coll;
-    return aushape_gbtree_is_valid(&path_coll->gbtree);
+    return aushape_itree_is_valid(&path_coll->items);
 }
 
 static enum aushape_rc
@@ -48,7 +47,7 @@ aushape_path_coll_init(struct aushape_coll *coll, const void *args)
 {
     struct aushape_path_coll *path_coll = (struct aushape_path_coll *)coll;
     (void)args;
-    aushape_gbtree_init(&path_coll->gbtree, 2048, 8, 8);
+    aushape_itree_init(&path_coll->items, coll->itree->pool, 8);
     return AUSHAPE_RC_OK;
 }
 
@@ -56,7 +55,23 @@ static void
 aushape_path_coll_cleanup(struct aushape_coll *coll)
 {
     struct aushape_path_coll *path_coll = (struct aushape_path_coll *)coll;
-    aushape_gbtree_cleanup(&path_coll->gbtree);
+    aushape_itree_cleanup(&path_coll->items);
+}
+
+static void
+aushape_path_coll_shrink(struct aushape_coll *coll)
+{
+    struct aushape_path_coll *path_coll = (struct aushape_path_coll *)coll;
+    aushape_itree_shrink(&path_coll->items);
+}
+
+static void
+aushape_path_coll_get_mem_usage(const struct aushape_coll *coll,
+                                struct aushape_mem_usage *usage)
+{
+    const struct aushape_path_coll *path_coll =
+                    (const struct aushape_path_coll *)coll;
+    aushape_itree_get_mem_usage(&path_coll->items, usage);
 }
 
 static bool
@@ -64,89 +79,59 @@ aushape_path_coll_is_empty(const struct aushape_coll *coll)
 {
     struct aushape_path_coll *path_coll =
                     (struct aushape_path_coll *)coll;
-    return aushape_gbtree_is_empty(&path_coll->gbtree);
+    return aushape_itree_is_empty(&path_coll->items);
 }
 
 static void
 aushape_path_coll_empty(struct aushape_coll *coll)
 {
     struct aushape_path_coll *path_coll = (struct aushape_path_coll *)coll;
-    aushape_gbtree_empty(&path_coll->gbtree);
+    aushape_itree_empty(&path_coll->items);
 }
 
 static enum aushape_rc
 aushape_path_coll_add(struct aushape_coll *coll,
                       size_t *pcount,
-                      size_t level,
                       size_t prio,
-                      auparse_state_t *au)
+                      const struct aushape_itree_node *record)
 {
     struct aushape_path_coll *path_coll = (struct aushape_path_coll *)coll;
-    struct aushape_gbtree *gbtree = &path_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
+    struct aushape_itree_pool *pool = coll->itree->pool;
     enum aushape_rc rc;
-    size_t l = level;
-    bool first_field = true;
-    const char *field_name;
+    struct aushape_itree_node node;
+    struct aushape_itree_field field;
     const char *field_value;
     bool got_idx = false;
     size_t idx;
     int end;
-    size_t node_idx;
+    size_t i;
 
     (void)pcount;
     (void)prio;
 
-    /* If haven't output anything yet */
-    if (aushape_gbtree_is_empty(gbtree)) {
-        /* Output prologue */
-        if (coll->format.lang == AUSHAPE_LANG_XML) {
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "<path>"));
-        } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\"path\":["));
-        }
-        /* Commit prologue item */
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree, 0));
-    }
+    assert(aushape_coll_is_valid(coll));
+    assert(pcount != NULL);
+    assert(record != NULL);
 
-    /* Account for the record markup */
-    l++;
-
-    /*
-     * Begin the item
-     */
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "<item>"));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '{'));
-    }
-    l++;
+    /* The item is the record without the index field */
+    node = *record;
+    node.pos = aushape_itree_pool_get_field_num(pool);
+    node.len = 0;
 
     /*
      * For each field in the record
      */
-    AUSHAPE_GUARD_BOOL(INVALID_PATH, auparse_first_field(au) != 0);
-    do {
-        field_name = auparse_get_field_name(au);
-        AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, field_name != NULL);
-        /* If it's the "type" pseudo-field */
-        if (strcmp(field_name, "type") == 0) {
-            continue;
-        /* If it's the "node" which we handle at event level */
-        } else if (strcmp(field_name, "node") == 0) {
-            continue;
+    for (i = 0; i < record->len; i++) {
+        /* Copy, as adding to the pool can move its fields */
+        field = *aushape_itree_pool_get_field(pool, record->pos + i);
         /* If it's the item index */
-        } else if (strcmp(field_name, "item") == 0) {
+        if (strcmp(aushape_itree_pool_get_str(pool, field.name),
+                   "item") == 0) {
             /* Make sure we haven't seen it yet */
             AUSHAPE_GUARD_BOOL(INVALID_PATH, !got_idx);
 
             /* Parse the value */
-            field_value = auparse_get_field_str(au);
-            AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, field_value != NULL);
+            field_value = aushape_itree_pool_get_str(pool, field.value_r);
             end = 0;
             AUSHAPE_GUARD_BOOL(
                     INVALID_PATH,
@@ -157,42 +142,23 @@ aushape_path_coll_add(struct aushape_coll *coll,
             got_idx = true;
         /* If it's something else */
         } else {
-            /* Add the field */
-            AUSHAPE_GUARD(aushape_field_format(gbuf,
-                                               &coll->format, l,
-                                               first_field, false,
-                                               field_name, au));
-            first_field = false;
+            /* Add the field to the item */
+            AUSHAPE_GUARD(aushape_itree_pool_add_field(pool, &field));
+            node.len++;
         }
-    } while (auparse_next_field(au) > 0);
+    }
 
     /* Make sure we found the index */
     AUSHAPE_GUARD_BOOL(INVALID_PATH, got_idx);
 
     /*
-     * Finish the item
-     */
-    l--;
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</item>"));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '}'));
-    }
-
-    /*
-     * Commit the item, leaving space for separator items, if needed
+     * Put the item at its index
      */
-    node_idx = ((coll->format.lang == AUSHAPE_LANG_JSON) ? idx * 2 : idx) + 1;
     AUSHAPE_GUARD_BOOL(INVALID_PATH,
-                       !aushape_gbtree_node_exists(gbtree, node_idx));
-    AUSHAPE_GUARD(aushape_gbtree_node_put_text(gbtree, node_idx, idx));
+                       !aushape_itree_node_exists(&path_coll->items, idx));
+    node.prio = idx;
+    AUSHAPE_GUARD(aushape_itree_node_put(&path_coll->items, idx, &node));
 
-    /* Account for the record markup */
-    l--;
-
-    assert(l == level);
     rc = AUSHAPE_RC_OK;
 cleanup:
     return rc;
@@ -201,57 +167,32 @@ cleanup:
 static enum aushape_rc
 aushape_path_coll_end(struct aushape_coll *coll,
                       size_t *pcount,
-                      size_t level,
                       size_t prio)
 {
     struct aushape_path_coll *path_coll =
                     (struct aushape_path_coll *)coll;
-    struct aushape_gbtree *gbtree = &path_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
+    struct aushape_itree_pool *pool = coll->itree->pool;
+    struct aushape_itree_node node = {
+        .type   = AUSHAPE_ITREE_NODE_TYPE_LIST,
+        .prio   = prio,
+        .pos    = 0,
+        .len    = aushape_itree_get_node_num(&path_coll->items),
+        .tree   = &path_coll->items,
+    };
     enum aushape_rc rc = AUSHAPE_RC_OK;
-    size_t idx;
 
     assert(aushape_coll_is_valid(coll));
     assert(pcount != NULL);
 
-    /* Insert item separators, if needed */
-    if (aushape_gbtree_get_node_num(gbtree) > 1) {
-        if (coll->format.lang == AUSHAPE_LANG_JSON) {
-            for (idx = 1;
-                 idx <= (aushape_gbtree_get_node_num(gbtree) - 1) / 2;
-                 idx++) {
-                /* TODO Reuse the comma, don't copy */
-                AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
-                AUSHAPE_GUARD(aushape_gbtree_node_put_text(gbtree,
-                                                           idx * 2, idx));
-            }
-        }
-    }
-
     /* Check that all items were received */
     AUSHAPE_GUARD_BOOL(INVALID_PATH,
-                       aushape_gbtree_is_solid(gbtree));
+                       aushape_itree_is_solid(&path_coll->items));
 
-    /* Output epilogue */
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, level));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</path>"));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        if (aushape_gbtree_get_node_num(gbtree) > 1) {
-            AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf,
-                                                     &coll->format, level));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ']'));
-    }
-    /* Commit epilogue item */
-    AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree, 0));
-
-    /* Commit record */
-    if (coll->format.lang == AUSHAPE_LANG_JSON && *pcount > 0) {
-        AUSHAPE_GUARD(aushape_gbuf_add_char(&coll->gbtree->text, ','));
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(coll->gbtree, prio));
-    }
-    AUSHAPE_GUARD(aushape_gbtree_node_add_tree(coll->gbtree, prio, gbtree));
+    /* Add the list of collected items */
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, "path", &node.name));
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, "item",
+                                             &node.item_name));
+    AUSHAPE_GUARD(aushape_itree_node_add(coll->itree, &node));
 
     (*pcount)++;
     rc = AUSHAPE_RC_OK;
@@ -268,4 +209,6 @@ const struct aushape_coll_type aushape_path_coll_type = {
     .empty      = aushape_path_coll_empty,
     .add        = aushape_path_coll_add,
     .end        = aushape_path_coll_end,
+    .shrink     = aushape_path_coll_shrink,
+    .get_mem_usage = aushape_path_coll_get_mem_usage,
 };
@@ -51,6 +51,10 @@ static const struct aushape_rc_info \
        "Output initialization failed"),
     RC(OUTPUT_WRITE_FAILED,
        "Output write failed"),
+    RC(SHM_CONSUMER_INIT_FAILED,
+       "Shared-memory consumer initialization failed"),
+    RC(SHM_CONSUMER_READ_FAILED,
+       "Shared-memory consumer read failed"),
 #undef RC
 };
 
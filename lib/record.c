@@ -19,45 +19,24 @@
  */
 
 #include <aushape/record.h>
-#include <aushape/field.h>
-#include <aushape/guard.h>
-#include <string.h>
+#include <aushape/emitter.h>
 
 enum aushape_rc
 aushape_record_format_fields(struct aushape_gbuf *gbuf,
                              const struct aushape_format *format,
                              size_t level,
-                             auparse_state_t *au)
+                             const struct aushape_itree_pool *pool,
+                             const struct aushape_itree_node *record)
 {
-    enum aushape_rc rc;
-    bool first_field;
-    const char *field_name;
-
-    AUSHAPE_GUARD_BOOL(INVALID_ARGS,
-                       aushape_gbuf_is_valid(gbuf) &&
-                       aushape_format_is_valid(format) &&
-                       au != NULL);
-
-    first_field = true;
-    if (auparse_first_field(au)) {
-        do {
-            field_name = auparse_get_field_name(au);
-            if (strcmp(field_name, "type") != 0 &&
-                strcmp(field_name, "node") != 0) {
-                rc = aushape_field_format(gbuf, format, level, first_field,
-                                          false, field_name, au);
-                if (rc != AUSHAPE_RC_OK) {
-                    assert(rc != AUSHAPE_RC_INVALID_ARGS);
-                    goto cleanup;
-                }
-                first_field = false;
-            }
-        } while (auparse_next_field(au) > 0);
+    if (!aushape_gbuf_is_valid(gbuf) ||
+        !aushape_format_is_valid(format) ||
+        !aushape_itree_pool_is_valid(pool) ||
+        record == NULL || record->type != AUSHAPE_ITREE_NODE_TYPE_RECORD) {
+        return AUSHAPE_RC_INVALID_ARGS;
     }
 
-    rc = AUSHAPE_RC_OK;
-cleanup:
-    return rc;
+    return aushape_emitter_get(format)->record_fields(gbuf, format, level,
+                                                      NULL, pool, record);
 }
 
 enum aushape_rc
@@ -65,60 +44,16 @@ aushape_record_format(struct aushape_gbuf *gbuf,
                       const struct aushape_format *format,
                       size_t level,
                       bool first,
-                      const char *name,
-                      auparse_state_t *au)
+                      const struct aushape_itree_pool *pool,
+                      const struct aushape_itree_node *record)
 {
-    enum aushape_rc rc;
-    size_t l = level;
-    size_t len;
-
-    AUSHAPE_GUARD_BOOL(INVALID_ARGS,
-                       aushape_gbuf_is_valid(gbuf) &&
-                       aushape_format_is_valid(format) &&
-                       name != NULL &&
-                       au != NULL);
-
-    if (format->lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '<'));
-        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase(gbuf, name));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '>'));
-    } else if (format->lang == AUSHAPE_LANG_JSON) {
-        if (!first) {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '"'));
-        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase(gbuf, name));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "\":"));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '{'));
-    }
-
-    l++;
-
-    len = gbuf->len;
-    rc = aushape_record_format_fields(gbuf, format, l, au);
-    if (rc != AUSHAPE_RC_OK) {
-        assert(rc != AUSHAPE_RC_INVALID_ARGS);
-        goto cleanup;
-    }
-
-    l--;
-
-    if (format->lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</"));
-        AUSHAPE_GUARD(aushape_gbuf_add_str_lowercase(gbuf, name));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, ">"));
-    } else if (format->lang == AUSHAPE_LANG_JSON) {
-        if (gbuf->len > len) {
-            AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, format, l));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '}'));
+    if (!aushape_gbuf_is_valid(gbuf) ||
+        !aushape_format_is_valid(format) ||
+        !aushape_itree_pool_is_valid(pool) ||
+        record == NULL || record->type != AUSHAPE_ITREE_NODE_TYPE_RECORD) {
+        return AUSHAPE_RC_INVALID_ARGS;
     }
 
-    assert(l == level);
-    rc = AUSHAPE_RC_OK;
-cleanup:
-    return rc;
+    return aushape_emitter_get(format)->record(gbuf, format, level, first,
+                                               NULL, pool, record);
 }
@@ -0,0 +1,116 @@
+#
+# Generate known record type definitions from the aushape JSON schema.
+#
+# Usage: LC_ALL=C awk -f record_def.awk aushape.schema.json > record_def_list.c
+#
+# Every record type referring to the "single_record" definition in the
+# schema gets an entry, sorted by the auparse (upper-case) type name, with
+# its markup pre-formatted for XML, JSON, CBOR, and MessagePack. The
+# MessagePack markup has only the record name, as the field map head depends
+# on the number of fields.
+#
+# Copyright (C) 2016 Red Hat
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+function fail(msg) {
+    print "record_def.awk: " FILENAME ":" FNR ": " msg > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+# Format a CBOR text string head for a string length, as C string escapes
+function cbor_text_head(len) {
+    if (len < 24) {
+        return sprintf("\\x%02x", 96 + len)
+    } else if (len < 256) {
+        return sprintf("\\x78\\x%02x", len)
+    }
+    fail("record name too long")
+}
+
+# Format a MessagePack string head for a string length, as C string escapes
+function msgpack_str_head(len) {
+    if (len < 32) {
+        return sprintf("\\x%02x", 160 + len)
+    } else if (len < 256) {
+        return sprintf("\\xd9\\x%02x", len)
+    }
+    fail("record name too long")
+}
+
+/"\$ref": *"#\/definitions\/single_record"/ {
+    if (match($0, /"[^"]*"/) == 0) {
+        fail("record name not found")
+    }
+    name = substr($0, RSTART + 1, RLENGTH - 2)
+    # Names are used verbatim in every language, so must need no escaping
+    if (name !~ /^[a-z][a-z0-9_]*$/) {
+        fail("unsupported record name \"" name "\"")
+    }
+    name = toupper(name)
+    for (i = num; i > 0 && list[i] > name; i--) {
+        list[i + 1] = list[i]
+    }
+    if (i > 0 && list[i] == name) {
+        fail("duplicate record name \"" name "\"")
+    }
+    list[i + 1] = name
+    num++
+}
+
+END {
+    if (failed) {
+        exit 1
+    }
+    if (num == 0) {
+        fail("no records found")
+    }
+
+    print "/*"
+    print " * Known record type definitions."
+    print " *"
+    print " * Generated by record_def.awk from aushape.schema.json, do not edit."
+    print " */"
+    print ""
+    print "#include <aushape/record_def.h>"
+    print ""
+    print "const struct aushape_record_def aushape_record_def_list[] = {"
+    for (i = 1; i <= num; i++) {
+        lower = tolower(list[i])
+        print "    {"
+        print "        .name = \"" list[i] "\","
+        print "        .markup = {"
+        print "            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP("
+        print "                \"<" lower ">\","
+        print "                \"</" lower ">\"),"
+        print "            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP("
+        print "                \"\\\"" lower "\\\":{\","
+        print "                \"}\"),"
+        print "            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP("
+        print "                \"" cbor_text_head(length(lower)) "\" \"" \
+              lower "\" \"\\xbf\","
+        print "                \"\\xff\"),"
+        print "            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP("
+        print "                \"" msgpack_str_head(length(lower)) "\" \"" \
+              lower "\","
+        print "                \"\"),"
+        print "        },"
+        print "    },"
+    }
+    print "};"
+    print ""
+    print "const size_t aushape_record_def_num = " num ";"
+}
@@ -0,0 +1,48 @@
+/*
+ * Known record type definitions.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/record_def.h>
+#include <assert.h>
+#include <string.h>
+
+const struct aushape_record_def *
+aushape_record_def_lookup(const char *name)
+{
+    size_t lo = 0;
+    size_t hi = aushape_record_def_num;
+    size_t mid;
+    int cmp;
+
+    assert(name != NULL);
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        cmp = strcmp(name, aushape_record_def_list[mid].name);
+        if (cmp == 0) {
+            return &aushape_record_def_list[mid];
+        } else if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return NULL;
+}
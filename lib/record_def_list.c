@@ -0,0 +1,2732 @@
+/*
+ * Known record type definitions.
+ *
+ * Generated by record_def.awk from aushape.schema.json, do not edit.
+ */
+
+#include <aushape/record_def.h>
+
+const struct aushape_record_def aushape_record_def_list[] = {
+    {
+        .name = "ACCT_LOCK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<acct_lock>",
+                "</acct_lock>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"acct_lock\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "acct_lock" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "acct_lock",
+                ""),
+        },
+    },
+    {
+        .name = "ACCT_UNLOCK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<acct_unlock>",
+                "</acct_unlock>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"acct_unlock\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "acct_unlock" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "acct_unlock",
+                ""),
+        },
+    },
+    {
+        .name = "ADD_GROUP",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<add_group>",
+                "</add_group>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"add_group\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "add_group" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "add_group",
+                ""),
+        },
+    },
+    {
+        .name = "ADD_USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<add_user>",
+                "</add_user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"add_user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "add_user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "add_user",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_ABEND",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_abend>",
+                "</anom_abend>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_abend\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "anom_abend" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "anom_abend",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_ACCESS_FS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_access_fs>",
+                "</anom_access_fs>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_access_fs\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "anom_access_fs" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "anom_access_fs",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_ADD_ACCT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_add_acct>",
+                "</anom_add_acct>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_add_acct\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "anom_add_acct" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "anom_add_acct",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_AMTU_FAIL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_amtu_fail>",
+                "</anom_amtu_fail>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_amtu_fail\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "anom_amtu_fail" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "anom_amtu_fail",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_CRYPTO_FAIL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_crypto_fail>",
+                "</anom_crypto_fail>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_crypto_fail\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "anom_crypto_fail" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "anom_crypto_fail",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_DEL_ACCT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_del_acct>",
+                "</anom_del_acct>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_del_acct\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "anom_del_acct" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "anom_del_acct",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_EXEC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_exec>",
+                "</anom_exec>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_exec\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "anom_exec" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "anom_exec",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_LINK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_link>",
+                "</anom_link>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_link\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "anom_link" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "anom_link",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_LOGIN_ACCT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_login_acct>",
+                "</anom_login_acct>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_login_acct\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "anom_login_acct" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "anom_login_acct",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_LOGIN_FAILURES",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_login_failures>",
+                "</anom_login_failures>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_login_failures\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x73" "anom_login_failures" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb3" "anom_login_failures",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_LOGIN_LOCATION",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_login_location>",
+                "</anom_login_location>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_login_location\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x73" "anom_login_location" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb3" "anom_login_location",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_LOGIN_SESSIONS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_login_sessions>",
+                "</anom_login_sessions>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_login_sessions\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x73" "anom_login_sessions" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb3" "anom_login_sessions",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_LOGIN_TIME",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_login_time>",
+                "</anom_login_time>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_login_time\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "anom_login_time" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "anom_login_time",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_MAX_DAC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_max_dac>",
+                "</anom_max_dac>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_max_dac\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "anom_max_dac" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "anom_max_dac",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_MAX_MAC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_max_mac>",
+                "</anom_max_mac>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_max_mac\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "anom_max_mac" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "anom_max_mac",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_MK_EXEC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_mk_exec>",
+                "</anom_mk_exec>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_mk_exec\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "anom_mk_exec" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "anom_mk_exec",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_MOD_ACCT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_mod_acct>",
+                "</anom_mod_acct>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_mod_acct\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "anom_mod_acct" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "anom_mod_acct",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_PROMISCUOUS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_promiscuous>",
+                "</anom_promiscuous>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_promiscuous\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "anom_promiscuous" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "anom_promiscuous",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_RBAC_FAIL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_rbac_fail>",
+                "</anom_rbac_fail>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_rbac_fail\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "anom_rbac_fail" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "anom_rbac_fail",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_RBAC_INTEGRITY_FAIL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_rbac_integrity_fail>",
+                "</anom_rbac_integrity_fail>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_rbac_integrity_fail\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x78\x18" "anom_rbac_integrity_fail" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb8" "anom_rbac_integrity_fail",
+                ""),
+        },
+    },
+    {
+        .name = "ANOM_ROOT_TRANS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<anom_root_trans>",
+                "</anom_root_trans>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"anom_root_trans\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "anom_root_trans" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "anom_root_trans",
+                ""),
+        },
+    },
+    {
+        .name = "APPARMOR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<apparmor>",
+                "</apparmor>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"apparmor\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "apparmor" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "apparmor",
+                ""),
+        },
+    },
+    {
+        .name = "APPARMOR_ALLOWED",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<apparmor_allowed>",
+                "</apparmor_allowed>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"apparmor_allowed\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "apparmor_allowed" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "apparmor_allowed",
+                ""),
+        },
+    },
+    {
+        .name = "APPARMOR_AUDIT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<apparmor_audit>",
+                "</apparmor_audit>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"apparmor_audit\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "apparmor_audit" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "apparmor_audit",
+                ""),
+        },
+    },
+    {
+        .name = "APPARMOR_DENIED",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<apparmor_denied>",
+                "</apparmor_denied>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"apparmor_denied\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "apparmor_denied" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "apparmor_denied",
+                ""),
+        },
+    },
+    {
+        .name = "APPARMOR_ERROR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<apparmor_error>",
+                "</apparmor_error>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"apparmor_error\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "apparmor_error" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "apparmor_error",
+                ""),
+        },
+    },
+    {
+        .name = "APPARMOR_HINT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<apparmor_hint>",
+                "</apparmor_hint>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"apparmor_hint\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "apparmor_hint" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "apparmor_hint",
+                ""),
+        },
+    },
+    {
+        .name = "APPARMOR_STATUS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<apparmor_status>",
+                "</apparmor_status>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"apparmor_status\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "apparmor_status" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "apparmor_status",
+                ""),
+        },
+    },
+    {
+        .name = "AVC_PATH",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<avc_path>",
+                "</avc_path>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"avc_path\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "avc_path" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "avc_path",
+                ""),
+        },
+    },
+    {
+        .name = "BPRM_FCAPS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<bprm_fcaps>",
+                "</bprm_fcaps>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"bprm_fcaps\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "bprm_fcaps" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "bprm_fcaps",
+                ""),
+        },
+    },
+    {
+        .name = "CAPSET",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<capset>",
+                "</capset>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"capset\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x66" "capset" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa6" "capset",
+                ""),
+        },
+    },
+    {
+        .name = "CHGRP_ID",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<chgrp_id>",
+                "</chgrp_id>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"chgrp_id\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "chgrp_id" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "chgrp_id",
+                ""),
+        },
+    },
+    {
+        .name = "CHUSER_ID",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<chuser_id>",
+                "</chuser_id>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"chuser_id\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "chuser_id" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "chuser_id",
+                ""),
+        },
+    },
+    {
+        .name = "CONFIG_CHANGE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<config_change>",
+                "</config_change>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"config_change\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "config_change" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "config_change",
+                ""),
+        },
+    },
+    {
+        .name = "CRED_ACQ",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<cred_acq>",
+                "</cred_acq>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"cred_acq\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "cred_acq" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "cred_acq",
+                ""),
+        },
+    },
+    {
+        .name = "CRED_DISP",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<cred_disp>",
+                "</cred_disp>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"cred_disp\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "cred_disp" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "cred_disp",
+                ""),
+        },
+    },
+    {
+        .name = "CRED_REFR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<cred_refr>",
+                "</cred_refr>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"cred_refr\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "cred_refr" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "cred_refr",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_FAILURE_USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_failure_user>",
+                "</crypto_failure_user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_failure_user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x73" "crypto_failure_user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb3" "crypto_failure_user",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_IKE_SA",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_ike_sa>",
+                "</crypto_ike_sa>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_ike_sa\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "crypto_ike_sa" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "crypto_ike_sa",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_IPSEC_SA",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_ipsec_sa>",
+                "</crypto_ipsec_sa>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_ipsec_sa\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "crypto_ipsec_sa" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "crypto_ipsec_sa",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_KEY_USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_key_user>",
+                "</crypto_key_user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_key_user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "crypto_key_user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "crypto_key_user",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_LOGIN",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_login>",
+                "</crypto_login>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_login\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "crypto_login" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "crypto_login",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_LOGOUT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_logout>",
+                "</crypto_logout>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_logout\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "crypto_logout" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "crypto_logout",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_PARAM_CHANGE_USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_param_change_user>",
+                "</crypto_param_change_user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_param_change_user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x78\x18" "crypto_param_change_user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb8" "crypto_param_change_user",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_REPLAY_USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_replay_user>",
+                "</crypto_replay_user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_replay_user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x72" "crypto_replay_user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb2" "crypto_replay_user",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_SESSION",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_session>",
+                "</crypto_session>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_session\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "crypto_session" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "crypto_session",
+                ""),
+        },
+    },
+    {
+        .name = "CRYPTO_TEST_USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<crypto_test_user>",
+                "</crypto_test_user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"crypto_test_user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "crypto_test_user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "crypto_test_user",
+                ""),
+        },
+    },
+    {
+        .name = "CWD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<cwd>",
+                "</cwd>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"cwd\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x63" "cwd" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa3" "cwd",
+                ""),
+        },
+    },
+    {
+        .name = "DAC_CHECK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<dac_check>",
+                "</dac_check>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"dac_check\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "dac_check" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "dac_check",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_ABORT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_abort>",
+                "</daemon_abort>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_abort\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "daemon_abort" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "daemon_abort",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_ACCEPT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_accept>",
+                "</daemon_accept>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_accept\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "daemon_accept" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "daemon_accept",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_CLOSE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_close>",
+                "</daemon_close>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_close\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "daemon_close" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "daemon_close",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_CONFIG",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_config>",
+                "</daemon_config>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_config\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "daemon_config" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "daemon_config",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_END",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_end>",
+                "</daemon_end>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_end\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "daemon_end" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "daemon_end",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_ERR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_err>",
+                "</daemon_err>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_err\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "daemon_err" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "daemon_err",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_RESUME",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_resume>",
+                "</daemon_resume>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_resume\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "daemon_resume" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "daemon_resume",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_ROTATE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_rotate>",
+                "</daemon_rotate>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_rotate\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "daemon_rotate" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "daemon_rotate",
+                ""),
+        },
+    },
+    {
+        .name = "DAEMON_START",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<daemon_start>",
+                "</daemon_start>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"daemon_start\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "daemon_start" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "daemon_start",
+                ""),
+        },
+    },
+    {
+        .name = "DEL_GROUP",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<del_group>",
+                "</del_group>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"del_group\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "del_group" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "del_group",
+                ""),
+        },
+    },
+    {
+        .name = "DEL_USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<del_user>",
+                "</del_user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"del_user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "del_user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "del_user",
+                ""),
+        },
+    },
+    {
+        .name = "DEV_ALLOC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<dev_alloc>",
+                "</dev_alloc>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"dev_alloc\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "dev_alloc" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "dev_alloc",
+                ""),
+        },
+    },
+    {
+        .name = "DEV_DEALLOC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<dev_dealloc>",
+                "</dev_dealloc>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"dev_dealloc\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "dev_dealloc" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "dev_dealloc",
+                ""),
+        },
+    },
+    {
+        .name = "FD_PAIR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<fd_pair>",
+                "</fd_pair>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"fd_pair\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x67" "fd_pair" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa7" "fd_pair",
+                ""),
+        },
+    },
+    {
+        .name = "FEATURE_CHANGE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<feature_change>",
+                "</feature_change>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"feature_change\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "feature_change" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "feature_change",
+                ""),
+        },
+    },
+    {
+        .name = "FS_RELABEL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<fs_relabel>",
+                "</fs_relabel>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"fs_relabel\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "fs_relabel" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "fs_relabel",
+                ""),
+        },
+    },
+    {
+        .name = "GRP_AUTH",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<grp_auth>",
+                "</grp_auth>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"grp_auth\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "grp_auth" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "grp_auth",
+                ""),
+        },
+    },
+    {
+        .name = "GRP_CHAUTHTOK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<grp_chauthtok>",
+                "</grp_chauthtok>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"grp_chauthtok\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "grp_chauthtok" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "grp_chauthtok",
+                ""),
+        },
+    },
+    {
+        .name = "GRP_MGMT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<grp_mgmt>",
+                "</grp_mgmt>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"grp_mgmt\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "grp_mgmt" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "grp_mgmt",
+                ""),
+        },
+    },
+    {
+        .name = "INTEGRITY_DATA",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<integrity_data>",
+                "</integrity_data>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"integrity_data\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "integrity_data" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "integrity_data",
+                ""),
+        },
+    },
+    {
+        .name = "INTEGRITY_HASH",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<integrity_hash>",
+                "</integrity_hash>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"integrity_hash\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "integrity_hash" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "integrity_hash",
+                ""),
+        },
+    },
+    {
+        .name = "INTEGRITY_METADATA",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<integrity_metadata>",
+                "</integrity_metadata>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"integrity_metadata\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x72" "integrity_metadata" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb2" "integrity_metadata",
+                ""),
+        },
+    },
+    {
+        .name = "INTEGRITY_PCR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<integrity_pcr>",
+                "</integrity_pcr>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"integrity_pcr\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "integrity_pcr" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "integrity_pcr",
+                ""),
+        },
+    },
+    {
+        .name = "INTEGRITY_RULE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<integrity_rule>",
+                "</integrity_rule>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"integrity_rule\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "integrity_rule" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "integrity_rule",
+                ""),
+        },
+    },
+    {
+        .name = "INTEGRITY_STATUS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<integrity_status>",
+                "</integrity_status>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"integrity_status\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "integrity_status" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "integrity_status",
+                ""),
+        },
+    },
+    {
+        .name = "IPC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<ipc>",
+                "</ipc>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"ipc\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x63" "ipc" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa3" "ipc",
+                ""),
+        },
+    },
+    {
+        .name = "IPC_SET_PERM",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<ipc_set_perm>",
+                "</ipc_set_perm>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"ipc_set_perm\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "ipc_set_perm" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "ipc_set_perm",
+                ""),
+        },
+    },
+    {
+        .name = "KERNEL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<kernel>",
+                "</kernel>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"kernel\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x66" "kernel" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa6" "kernel",
+                ""),
+        },
+    },
+    {
+        .name = "KERNEL_OTHER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<kernel_other>",
+                "</kernel_other>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"kernel_other\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "kernel_other" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "kernel_other",
+                ""),
+        },
+    },
+    {
+        .name = "LABEL_LEVEL_CHANGE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<label_level_change>",
+                "</label_level_change>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"label_level_change\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x72" "label_level_change" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb2" "label_level_change",
+                ""),
+        },
+    },
+    {
+        .name = "LABEL_OVERRIDE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<label_override>",
+                "</label_override>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"label_override\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "label_override" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "label_override",
+                ""),
+        },
+    },
+    {
+        .name = "LOGIN",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<login>",
+                "</login>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"login\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x65" "login" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa5" "login",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_CHECK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_check>",
+                "</mac_check>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_check\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "mac_check" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "mac_check",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_CIPSOV4_ADD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_cipsov4_add>",
+                "</mac_cipsov4_add>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_cipsov4_add\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "mac_cipsov4_add" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "mac_cipsov4_add",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_CIPSOV4_DEL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_cipsov4_del>",
+                "</mac_cipsov4_del>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_cipsov4_del\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "mac_cipsov4_del" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "mac_cipsov4_del",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_CONFIG_CHANGE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_config_change>",
+                "</mac_config_change>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_config_change\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x71" "mac_config_change" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb1" "mac_config_change",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_IPSEC_ADDSA",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_ipsec_addsa>",
+                "</mac_ipsec_addsa>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_ipsec_addsa\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "mac_ipsec_addsa" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "mac_ipsec_addsa",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_IPSEC_ADDSPD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_ipsec_addspd>",
+                "</mac_ipsec_addspd>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_ipsec_addspd\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "mac_ipsec_addspd" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "mac_ipsec_addspd",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_IPSEC_DELSA",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_ipsec_delsa>",
+                "</mac_ipsec_delsa>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_ipsec_delsa\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "mac_ipsec_delsa" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "mac_ipsec_delsa",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_IPSEC_DELSPD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_ipsec_delspd>",
+                "</mac_ipsec_delspd>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_ipsec_delspd\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "mac_ipsec_delspd" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "mac_ipsec_delspd",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_IPSEC_EVENT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_ipsec_event>",
+                "</mac_ipsec_event>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_ipsec_event\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "mac_ipsec_event" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "mac_ipsec_event",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_MAP_ADD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_map_add>",
+                "</mac_map_add>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_map_add\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "mac_map_add" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "mac_map_add",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_MAP_DEL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_map_del>",
+                "</mac_map_del>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_map_del\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "mac_map_del" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "mac_map_del",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_POLICY_LOAD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_policy_load>",
+                "</mac_policy_load>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_policy_load\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "mac_policy_load" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "mac_policy_load",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_STATUS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_status>",
+                "</mac_status>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_status\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "mac_status" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "mac_status",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_UNLBL_ALLOW",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_unlbl_allow>",
+                "</mac_unlbl_allow>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_unlbl_allow\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "mac_unlbl_allow" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "mac_unlbl_allow",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_UNLBL_STCADD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_unlbl_stcadd>",
+                "</mac_unlbl_stcadd>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_unlbl_stcadd\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "mac_unlbl_stcadd" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "mac_unlbl_stcadd",
+                ""),
+        },
+    },
+    {
+        .name = "MAC_UNLBL_STCDEL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mac_unlbl_stcdel>",
+                "</mac_unlbl_stcdel>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mac_unlbl_stcdel\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "mac_unlbl_stcdel" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "mac_unlbl_stcdel",
+                ""),
+        },
+    },
+    {
+        .name = "MMAP",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mmap>",
+                "</mmap>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mmap\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x64" "mmap" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa4" "mmap",
+                ""),
+        },
+    },
+    {
+        .name = "MQ_GETSETATTR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mq_getsetattr>",
+                "</mq_getsetattr>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mq_getsetattr\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "mq_getsetattr" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "mq_getsetattr",
+                ""),
+        },
+    },
+    {
+        .name = "MQ_NOTIFY",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mq_notify>",
+                "</mq_notify>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mq_notify\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "mq_notify" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "mq_notify",
+                ""),
+        },
+    },
+    {
+        .name = "MQ_OPEN",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mq_open>",
+                "</mq_open>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mq_open\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x67" "mq_open" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa7" "mq_open",
+                ""),
+        },
+    },
+    {
+        .name = "MQ_SENDRECV",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<mq_sendrecv>",
+                "</mq_sendrecv>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"mq_sendrecv\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "mq_sendrecv" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "mq_sendrecv",
+                ""),
+        },
+    },
+    {
+        .name = "NETFILTER_PKT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<netfilter_pkt>",
+                "</netfilter_pkt>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"netfilter_pkt\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "netfilter_pkt" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "netfilter_pkt",
+                ""),
+        },
+    },
+    {
+        .name = "PROCTITLE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<proctitle>",
+                "</proctitle>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"proctitle\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "proctitle" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "proctitle",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_ACCT_LOCK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_acct_lock>",
+                "</resp_acct_lock>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_acct_lock\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "resp_acct_lock" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "resp_acct_lock",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_ACCT_LOCK_TIMED",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_acct_lock_timed>",
+                "</resp_acct_lock_timed>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_acct_lock_timed\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x74" "resp_acct_lock_timed" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb4" "resp_acct_lock_timed",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_ACCT_REMOTE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_acct_remote>",
+                "</resp_acct_remote>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_acct_remote\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "resp_acct_remote" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "resp_acct_remote",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_ACCT_UNLOCK_TIMED",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_acct_unlock_timed>",
+                "</resp_acct_unlock_timed>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_acct_unlock_timed\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x76" "resp_acct_unlock_timed" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb6" "resp_acct_unlock_timed",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_ALERT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_alert>",
+                "</resp_alert>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_alert\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "resp_alert" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "resp_alert",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_ANOMALY",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_anomaly>",
+                "</resp_anomaly>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_anomaly\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "resp_anomaly" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "resp_anomaly",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_EXEC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_exec>",
+                "</resp_exec>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_exec\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "resp_exec" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "resp_exec",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_HALT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_halt>",
+                "</resp_halt>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_halt\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "resp_halt" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "resp_halt",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_KILL_PROC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_kill_proc>",
+                "</resp_kill_proc>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_kill_proc\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "resp_kill_proc" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "resp_kill_proc",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_SEBOOL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_sebool>",
+                "</resp_sebool>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_sebool\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "resp_sebool" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "resp_sebool",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_SINGLE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_single>",
+                "</resp_single>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_single\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "resp_single" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "resp_single",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_TERM_ACCESS",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_term_access>",
+                "</resp_term_access>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_term_access\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "resp_term_access" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "resp_term_access",
+                ""),
+        },
+    },
+    {
+        .name = "RESP_TERM_LOCK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<resp_term_lock>",
+                "</resp_term_lock>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"resp_term_lock\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "resp_term_lock" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "resp_term_lock",
+                ""),
+        },
+    },
+    {
+        .name = "ROLE_ASSIGN",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<role_assign>",
+                "</role_assign>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"role_assign\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "role_assign" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "role_assign",
+                ""),
+        },
+    },
+    {
+        .name = "ROLE_MODIFY",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<role_modify>",
+                "</role_modify>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"role_modify\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "role_modify" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "role_modify",
+                ""),
+        },
+    },
+    {
+        .name = "ROLE_REMOVE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<role_remove>",
+                "</role_remove>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"role_remove\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "role_remove" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "role_remove",
+                ""),
+        },
+    },
+    {
+        .name = "SECCOMP",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<seccomp>",
+                "</seccomp>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"seccomp\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x67" "seccomp" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa7" "seccomp",
+                ""),
+        },
+    },
+    {
+        .name = "SELINUX_ERR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<selinux_err>",
+                "</selinux_err>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"selinux_err\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "selinux_err" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "selinux_err",
+                ""),
+        },
+    },
+    {
+        .name = "SERVICE_START",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<service_start>",
+                "</service_start>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"service_start\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "service_start" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "service_start",
+                ""),
+        },
+    },
+    {
+        .name = "SERVICE_STOP",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<service_stop>",
+                "</service_stop>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"service_stop\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "service_stop" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "service_stop",
+                ""),
+        },
+    },
+    {
+        .name = "SOCKADDR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<sockaddr>",
+                "</sockaddr>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"sockaddr\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "sockaddr" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "sockaddr",
+                ""),
+        },
+    },
+    {
+        .name = "SOCKETCALL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<socketcall>",
+                "</socketcall>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"socketcall\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "socketcall" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "socketcall",
+                ""),
+        },
+    },
+    {
+        .name = "SYSCALL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<syscall>",
+                "</syscall>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"syscall\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x67" "syscall" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa7" "syscall",
+                ""),
+        },
+    },
+    {
+        .name = "SYSTEM_BOOT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<system_boot>",
+                "</system_boot>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"system_boot\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "system_boot" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "system_boot",
+                ""),
+        },
+    },
+    {
+        .name = "SYSTEM_RUNLEVEL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<system_runlevel>",
+                "</system_runlevel>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"system_runlevel\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "system_runlevel" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "system_runlevel",
+                ""),
+        },
+    },
+    {
+        .name = "SYSTEM_SHUTDOWN",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<system_shutdown>",
+                "</system_shutdown>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"system_shutdown\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "system_shutdown" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "system_shutdown",
+                ""),
+        },
+    },
+    {
+        .name = "TEST",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<test>",
+                "</test>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"test\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x64" "test" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa4" "test",
+                ""),
+        },
+    },
+    {
+        .name = "TRUSTED_APP",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<trusted_app>",
+                "</trusted_app>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"trusted_app\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "trusted_app" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "trusted_app",
+                ""),
+        },
+    },
+    {
+        .name = "TTY",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<tty>",
+                "</tty>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"tty\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x63" "tty" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa3" "tty",
+                ""),
+        },
+    },
+    {
+        .name = "USER",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user>",
+                "</user>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x64" "user" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa4" "user",
+                ""),
+        },
+    },
+    {
+        .name = "USER_ACCT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_acct>",
+                "</user_acct>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_acct\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "user_acct" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "user_acct",
+                ""),
+        },
+    },
+    {
+        .name = "USER_AUTH",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_auth>",
+                "</user_auth>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_auth\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "user_auth" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "user_auth",
+                ""),
+        },
+    },
+    {
+        .name = "USER_AVC",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_avc>",
+                "</user_avc>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_avc\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "user_avc" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "user_avc",
+                ""),
+        },
+    },
+    {
+        .name = "USER_CHAUTHTOK",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_chauthtok>",
+                "</user_chauthtok>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_chauthtok\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6e" "user_chauthtok" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xae" "user_chauthtok",
+                ""),
+        },
+    },
+    {
+        .name = "USER_CMD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_cmd>",
+                "</user_cmd>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_cmd\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "user_cmd" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "user_cmd",
+                ""),
+        },
+    },
+    {
+        .name = "USER_END",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_end>",
+                "</user_end>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_end\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "user_end" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "user_end",
+                ""),
+        },
+    },
+    {
+        .name = "USER_ERR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_err>",
+                "</user_err>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_err\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "user_err" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "user_err",
+                ""),
+        },
+    },
+    {
+        .name = "USER_LABELED_EXPORT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_labeled_export>",
+                "</user_labeled_export>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_labeled_export\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x73" "user_labeled_export" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb3" "user_labeled_export",
+                ""),
+        },
+    },
+    {
+        .name = "USER_LOGIN",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_login>",
+                "</user_login>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_login\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "user_login" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "user_login",
+                ""),
+        },
+    },
+    {
+        .name = "USER_LOGOUT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_logout>",
+                "</user_logout>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_logout\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "user_logout" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "user_logout",
+                ""),
+        },
+    },
+    {
+        .name = "USER_MAC_CONFIG_CHANGE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_mac_config_change>",
+                "</user_mac_config_change>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_mac_config_change\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x76" "user_mac_config_change" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb6" "user_mac_config_change",
+                ""),
+        },
+    },
+    {
+        .name = "USER_MAC_POLICY_LOAD",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_mac_policy_load>",
+                "</user_mac_policy_load>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_mac_policy_load\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x74" "user_mac_policy_load" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb4" "user_mac_policy_load",
+                ""),
+        },
+    },
+    {
+        .name = "USER_MGMT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_mgmt>",
+                "</user_mgmt>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_mgmt\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x69" "user_mgmt" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa9" "user_mgmt",
+                ""),
+        },
+    },
+    {
+        .name = "USER_ROLE_CHANGE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_role_change>",
+                "</user_role_change>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_role_change\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "user_role_change" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "user_role_change",
+                ""),
+        },
+    },
+    {
+        .name = "USER_SELINUX_ERR",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_selinux_err>",
+                "</user_selinux_err>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_selinux_err\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x70" "user_selinux_err" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb0" "user_selinux_err",
+                ""),
+        },
+    },
+    {
+        .name = "USER_START",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_start>",
+                "</user_start>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_start\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6a" "user_start" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaa" "user_start",
+                ""),
+        },
+    },
+    {
+        .name = "USER_TTY",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_tty>",
+                "</user_tty>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_tty\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x68" "user_tty" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xa8" "user_tty",
+                ""),
+        },
+    },
+    {
+        .name = "USER_UNLABELED_EXPORT",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<user_unlabeled_export>",
+                "</user_unlabeled_export>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"user_unlabeled_export\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x75" "user_unlabeled_export" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xb5" "user_unlabeled_export",
+                ""),
+        },
+    },
+    {
+        .name = "USYS_CONFIG",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<usys_config>",
+                "</usys_config>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"usys_config\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6b" "usys_config" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xab" "usys_config",
+                ""),
+        },
+    },
+    {
+        .name = "VIRT_CONTROL",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<virt_control>",
+                "</virt_control>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"virt_control\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6c" "virt_control" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xac" "virt_control",
+                ""),
+        },
+    },
+    {
+        .name = "VIRT_MACHINE_ID",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<virt_machine_id>",
+                "</virt_machine_id>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"virt_machine_id\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6f" "virt_machine_id" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xaf" "virt_machine_id",
+                ""),
+        },
+    },
+    {
+        .name = "VIRT_RESOURCE",
+        .markup = {
+            [AUSHAPE_LANG_XML] = AUSHAPE_RECORD_DEF_MARKUP(
+                "<virt_resource>",
+                "</virt_resource>"),
+            [AUSHAPE_LANG_JSON] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\"virt_resource\":{",
+                "}"),
+            [AUSHAPE_LANG_CBOR] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\x6d" "virt_resource" "\xbf",
+                "\xff"),
+            [AUSHAPE_LANG_MSGPACK] = AUSHAPE_RECORD_DEF_MARKUP(
+                "\xad" "virt_resource",
+                ""),
+        },
+    },
+};
+
+const size_t aushape_record_def_num = 160;
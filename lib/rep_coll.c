@@ -20,7 +20,6 @@
 
 #include <aushape/rep_coll.h>
 #include <aushape/coll.h>
-#include <aushape/record.h>
 #include <aushape/guard.h>
 #include <string.h>
 
@@ -29,8 +28,8 @@ struct aushape_rep_coll {
     struct aushape_coll     coll;
     /** Name of the output container */
     const char             *name;
-    /** Output growing buffer tree */
-    struct aushape_gbtree   gbtree;
+    /** Collected record items */
+    struct aushape_itree    items;
 };
 
 static bool
@@ -39,7 +38,7 @@ aushape_rep_coll_is_valid(const struct aushape_coll *coll)
     struct aushape_rep_coll *rep_coll =
                     (struct aushape_rep_coll *)coll;
     return rep_coll->name != NULL &&
-           aushape_gbtree_is_valid(&rep_coll->gbtree);
+           aushape_itree_is_valid(&rep_coll->items);
 }
 
 static enum aushape_rc
@@ -56,7 +55,7 @@ aushape_rep_coll_init(struct aushape_coll *coll,
                                      rep_args->name != NULL);
 
     rep_coll->name = rep_args->name;
-    aushape_gbtree_init(&rep_coll->gbtree, 4096, 8, 8);
+    aushape_itree_init(&rep_coll->items, coll->itree->pool, 8);
 
     rc = AUSHAPE_RC_OK;
 cleanup:
@@ -68,7 +67,24 @@ aushape_rep_coll_cleanup(struct aushape_coll *coll)
 {
     struct aushape_rep_coll *rep_coll =
                     (struct aushape_rep_coll *)coll;
-    aushape_gbtree_cleanup(&rep_coll->gbtree);
+    aushape_itree_cleanup(&rep_coll->items);
+}
+
+static void
+aushape_rep_coll_shrink(struct aushape_coll *coll)
+{
+    struct aushape_rep_coll *rep_coll =
+                    (struct aushape_rep_coll *)coll;
+    aushape_itree_shrink(&rep_coll->items);
+}
+
+static void
+aushape_rep_coll_get_mem_usage(const struct aushape_coll *coll,
+                               struct aushape_mem_usage *usage)
+{
+    const struct aushape_rep_coll *rep_coll =
+                    (const struct aushape_rep_coll *)coll;
+    aushape_itree_get_mem_usage(&rep_coll->items, usage);
 }
 
 static bool
@@ -76,7 +92,7 @@ aushape_rep_coll_is_empty(const struct aushape_coll *coll)
 {
     struct aushape_rep_coll *rep_coll =
                     (struct aushape_rep_coll *)coll;
-    return aushape_gbtree_is_empty(&rep_coll->gbtree);
+    return aushape_itree_is_empty(&rep_coll->items);
 }
 
 static void
@@ -84,143 +100,59 @@ aushape_rep_coll_empty(struct aushape_coll *coll)
 {
     struct aushape_rep_coll *rep_coll =
                     (struct aushape_rep_coll *)coll;
-    aushape_gbtree_empty(&rep_coll->gbtree);
+    aushape_itree_empty(&rep_coll->items);
 }
 
 static enum aushape_rc
 aushape_rep_coll_add(struct aushape_coll *coll,
                      size_t *pcount,
-                     size_t level,
                      size_t prio,
-                     auparse_state_t *au)
+                     const struct aushape_itree_node *record)
 {
-    enum aushape_rc rc;
-    size_t l = level;
     struct aushape_rep_coll *rep_coll =
                     (struct aushape_rep_coll *)coll;
-    struct aushape_gbtree *gbtree = &rep_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
-    size_t len;
+    struct aushape_itree_node node;
 
     (void)pcount;
     (void)prio;
 
     assert(aushape_coll_is_valid(coll));
     assert(pcount != NULL);
-    assert(au != NULL);
-
-    /* If it's the first record */
-    if (aushape_gbtree_is_empty(gbtree)) {
-        /* Output prologue */
-        if (coll->format.lang == AUSHAPE_LANG_XML) {
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "<%s>", rep_coll->name));
-        } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-            AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-            AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "\"%s\":[", rep_coll->name));
-        }
-        /* Commit prologue item */
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree, 0));
-    }
-
-    /* Account for the container markup */
-    l++;
-
-    /*
-     * Begin the item
-     */
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "<item>"));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        if (aushape_gbtree_get_node_num(gbtree) > 1) {
-            AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ','));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_space_opening(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '{'));
-    }
-
-    l++;
-
-    /*
-     * Output the fields
-     */
-    len = gbuf->len;
-    rc = aushape_record_format_fields(gbuf, &coll->format,
-                                      l, au);
-    if (rc != AUSHAPE_RC_OK) {
-        assert(rc != AUSHAPE_RC_INVALID_ARGS);
-        goto cleanup;
-    }
-
-    l--;
-
-    /*
-     * Finish the item
-     */
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_str(gbuf, "</item>"));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        if (gbuf->len > len) {
-            AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf,
-                                                     &coll->format, l));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, '}'));
-    }
-
-    /*
-     * Commit the item
-     */
-    aushape_gbtree_node_add_text(gbtree,
-                                 aushape_gbtree_get_node_num(gbtree) - 1);
-
-    /* Account for the container markup */
-    l--;
-
-    assert(l == level);
-    rc = AUSHAPE_RC_OK;
-cleanup:
-    return rc;
+    assert(record != NULL);
+
+    /* Add the record as the next item, in order */
+    node = *record;
+    node.prio = aushape_itree_get_node_num(&rep_coll->items);
+    return aushape_itree_node_add(&rep_coll->items, &node);
 }
 
 static enum aushape_rc
 aushape_rep_coll_end(struct aushape_coll *coll,
                      size_t *pcount,
-                     size_t level,
                      size_t prio)
 {
     struct aushape_rep_coll *rep_coll =
                     (struct aushape_rep_coll *)coll;
-    struct aushape_gbtree *gbtree = &rep_coll->gbtree;
-    struct aushape_gbuf *gbuf = &gbtree->text;
-    enum aushape_rc rc = AUSHAPE_RC_OK;
-    size_t l = level;
+    struct aushape_itree_pool *pool = coll->itree->pool;
+    struct aushape_itree_node node = {
+        .type   = AUSHAPE_ITREE_NODE_TYPE_LIST,
+        .prio   = prio,
+        .pos    = 0,
+        .len    = aushape_itree_get_node_num(&rep_coll->items),
+        .tree   = &rep_coll->items,
+    };
+    enum aushape_rc rc;
 
     assert(aushape_coll_is_valid(coll));
     assert(pcount != NULL);
 
-    /* Output epilogue */
-    if (coll->format.lang == AUSHAPE_LANG_XML) {
-        AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, l));
-        AUSHAPE_GUARD(aushape_gbuf_add_fmt(gbuf, "</%s>", rep_coll->name));
-    } else if (coll->format.lang == AUSHAPE_LANG_JSON) {
-        if (!aushape_gbtree_is_empty(gbtree)) {
-            AUSHAPE_GUARD(aushape_gbuf_space_closing(gbuf, &coll->format, l));
-        }
-        AUSHAPE_GUARD(aushape_gbuf_add_char(gbuf, ']'));
-    }
-    /* Commit epilogue */
-    AUSHAPE_GUARD(aushape_gbtree_node_add_text(gbtree, 0));
-
-    /* Output record */
-    if (coll->format.lang == AUSHAPE_LANG_JSON && *pcount > 0) {
-        AUSHAPE_GUARD(aushape_gbuf_add_char(&coll->gbtree->text, ','));
-        AUSHAPE_GUARD(aushape_gbtree_node_add_text(coll->gbtree, prio));
-    }
-    AUSHAPE_GUARD(aushape_gbtree_node_add_tree(coll->gbtree, prio, gbtree));
-
-    assert(l == level);
+    /* Add the list of collected items */
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, rep_coll->name,
+                                             &node.name));
+    AUSHAPE_GUARD(aushape_itree_pool_add_str(pool, "item",
+                                             &node.item_name));
+    AUSHAPE_GUARD(aushape_itree_node_add(coll->itree, &node));
+
     (*pcount)++;
     rc = AUSHAPE_RC_OK;
 cleanup:
@@ -236,4 +168,6 @@ const struct aushape_coll_type aushape_rep_coll_type = {
     .empty      = aushape_rep_coll_empty,
     .add        = aushape_rep_coll_add,
     .end        = aushape_rep_coll_end,
+    .shrink     = aushape_rep_coll_shrink,
+    .get_mem_usage = aushape_rep_coll_get_mem_usage,
 };
@@ -0,0 +1,235 @@
+/*
+ * Record shape cache.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/shape_cache.h>
+#include <string.h>
+
+/** FNV-1a 32-bit hash offset basis */
+#define AUSHAPE_SHAPE_HASH_BASIS    2166136261u
+/** FNV-1a 32-bit hash prime */
+#define AUSHAPE_SHAPE_HASH_PRIME    16777619u
+
+/**
+ * Add bytes to an FNV-1a hash.
+ *
+ * @param hash  The hash to add to.
+ * @param ptr   The bytes to add.
+ * @param len   Number of bytes to add.
+ *
+ * @return The updated hash.
+ */
+static uint32_t
+aushape_shape_hash_add(uint32_t hash, const void *ptr, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)ptr;
+    for (; len > 0; len--, p++) {
+        hash = (hash ^ *p) * AUSHAPE_SHAPE_HASH_PRIME;
+    }
+    return hash;
+}
+
+static bool
+aushape_shape_is_valid(const struct aushape_shape *shape)
+{
+    return shape != NULL &&
+           aushape_gbuf_is_valid(&shape->names) &&
+           aushape_gbuf_is_valid(&shape->skel) &&
+           aushape_garr_is_valid(&shape->fields) &&
+           (!shape->complete ||
+            aushape_garr_get_len(&shape->fields) == shape->field_num);
+}
+
+bool
+aushape_shape_cache_is_valid(const struct aushape_shape_cache *cache)
+{
+    size_t i;
+
+    if (cache == NULL) {
+        return false;
+    }
+    for (i = 0; i < AUSHAPE_SHAPE_CACHE_SIZE; i++) {
+        if (!aushape_shape_is_valid(&cache->slot_list[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+aushape_shape_cache_init(struct aushape_shape_cache *cache,
+                         const struct aushape_mem *mem)
+{
+    size_t i;
+    struct aushape_shape *shape;
+
+    assert(cache != NULL);
+    assert(aushape_mem_is_valid(mem));
+
+    memset(cache, 0, sizeof(*cache));
+    for (i = 0; i < AUSHAPE_SHAPE_CACHE_SIZE; i++) {
+        shape = &cache->slot_list[i];
+        aushape_gbuf_init(&shape->names, 256, mem);
+        aushape_gbuf_init(&shape->skel, 512, mem);
+        aushape_garr_init(&shape->fields, sizeof(struct aushape_shape_field),
+                          32, mem);
+    }
+    assert(aushape_shape_cache_is_valid(cache));
+}
+
+void
+aushape_shape_cache_cleanup(struct aushape_shape_cache *cache)
+{
+    size_t i;
+    struct aushape_shape *shape;
+
+    assert(aushape_shape_cache_is_valid(cache));
+
+    for (i = 0; i < AUSHAPE_SHAPE_CACHE_SIZE; i++) {
+        shape = &cache->slot_list[i];
+        aushape_gbuf_cleanup(&shape->names);
+        aushape_gbuf_cleanup(&shape->skel);
+        aushape_garr_cleanup(&shape->fields);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+void
+aushape_shape_cache_shrink(struct aushape_shape_cache *cache)
+{
+    size_t i;
+    struct aushape_shape *shape;
+
+    assert(aushape_shape_cache_is_valid(cache));
+
+    for (i = 0; i < AUSHAPE_SHAPE_CACHE_SIZE; i++) {
+        shape = &cache->slot_list[i];
+        aushape_gbuf_shrink(&shape->names);
+        aushape_gbuf_shrink(&shape->skel);
+        aushape_garr_shrink(&shape->fields);
+    }
+}
+
+void
+aushape_shape_cache_get_mem_usage(const struct aushape_shape_cache *cache,
+                                  struct aushape_mem_usage *usage)
+{
+    size_t i;
+    const struct aushape_shape *shape;
+
+    assert(aushape_shape_cache_is_valid(cache));
+    assert(usage != NULL);
+
+    for (i = 0; i < AUSHAPE_SHAPE_CACHE_SIZE; i++) {
+        shape = &cache->slot_list[i];
+        aushape_gbuf_get_mem_usage(&shape->names, usage);
+        aushape_gbuf_get_mem_usage(&shape->skel, usage);
+        aushape_garr_get_mem_usage(&shape->fields, usage);
+    }
+}
+
+struct aushape_shape *
+aushape_shape_cache_get(struct aushape_shape_cache *cache,
+                        size_t level,
+                        const struct aushape_itree_pool *pool,
+                        const struct aushape_itree_node *record)
+{
+    uint32_t hash = AUSHAPE_SHAPE_HASH_BASIS;
+    int type;
+    size_t field_num;
+    size_t i;
+    const char *name;
+    struct aushape_shape *shape;
+
+    assert(aushape_shape_cache_is_valid(cache));
+    assert(aushape_itree_pool_is_valid(pool));
+    assert(record != NULL);
+    assert(record->type == AUSHAPE_ITREE_NODE_TYPE_RECORD);
+
+    type = record->record_type;
+    field_num = record->len;
+    hash = aushape_shape_hash_add(hash, &type, sizeof(type));
+    hash = aushape_shape_hash_add(hash, &level, sizeof(level));
+    for (i = 0; i < field_num; i++) {
+        name = aushape_itree_pool_get_str(
+                    pool, aushape_itree_pool_get_field(pool,
+                                                       record->pos + i)->name);
+        hash = aushape_shape_hash_add(hash, name, strlen(name) + 1);
+    }
+
+    shape = &cache->slot_list[hash & (AUSHAPE_SHAPE_CACHE_SIZE - 1)];
+    if (!shape->complete ||
+        shape->hash != hash ||
+        shape->type != type ||
+        shape->level != level ||
+        shape->field_num != field_num) {
+        aushape_shape_empty(shape);
+        shape->hash = hash;
+        shape->type = type;
+        shape->level = level;
+        shape->field_num = field_num;
+    }
+    return shape;
+}
+
+void
+aushape_shape_empty(struct aushape_shape *shape)
+{
+    assert(aushape_shape_is_valid(shape));
+    shape->complete = false;
+    aushape_gbuf_empty(&shape->names);
+    aushape_gbuf_empty(&shape->skel);
+    aushape_garr_empty(&shape->fields);
+}
+
+enum aushape_rc
+aushape_shape_add_field(struct aushape_shape *shape,
+                        const char *name,
+                        enum aushape_field_kind kind,
+                        const char *skel,
+                        size_t skel_len)
+{
+    struct aushape_shape_field field;
+    enum aushape_rc rc;
+
+    assert(aushape_shape_is_valid(shape));
+    assert(!shape->complete);
+    assert(name != NULL);
+    assert(skel != NULL || skel_len == 0);
+
+    field.name_len = strlen(name);
+    field.skel_len = skel_len;
+    field.kind = kind;
+    rc = aushape_gbuf_add_buf(&shape->names, name, field.name_len + 1);
+    if (rc == AUSHAPE_RC_OK) {
+        rc = aushape_gbuf_add_buf(&shape->skel, skel, skel_len);
+    }
+    if (rc == AUSHAPE_RC_OK) {
+        rc = aushape_garr_add(&shape->fields, &field);
+    }
+    return rc;
+}
+
+void
+aushape_shape_complete(struct aushape_shape *shape)
+{
+    assert(aushape_shape_is_valid(shape));
+    shape->complete =
+        aushape_garr_get_len(&shape->fields) == shape->field_num;
+}
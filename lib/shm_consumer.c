@@ -0,0 +1,343 @@
+/*
+ * Shared-memory ring consumer.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/shm_consumer.h>
+#include <aushape/shm_ring.h>
+#include <aushape/guard.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <assert.h>
+
+struct aushape_shm_consumer {
+    int sock_fd;                    /**< Connection to the output */
+    int efd;                        /**< Wakeup eventfd */
+    struct aushape_shm_ring *ring;  /**< Mapped ring */
+    size_t map_size;                /**< Size of the ring mapping */
+    uint64_t size;                  /**< Size of the ring data area */
+    /** Our slot in the ring */
+    struct aushape_shm_ring_consumer *slot;
+    uint64_t cursor;                /**< Position of the next item */
+    bool held;                      /**< True if an item is not released */
+    bool hup;                       /**< True if the output hung up */
+};
+
+bool
+aushape_shm_consumer_is_valid(const struct aushape_shm_consumer *consumer)
+{
+    return consumer != NULL &&
+           consumer->sock_fd >= 0 &&
+           consumer->efd >= 0 &&
+           consumer->ring != NULL &&
+           consumer->size >= 4096 &&
+           (consumer->size & (consumer->size - 1)) == 0 &&
+           consumer->map_size == sizeof(struct aushape_shm_ring) +
+                                 consumer->size &&
+           consumer->slot >= consumer->ring->consumer_list &&
+           consumer->slot < consumer->ring->consumer_list +
+                            AUSHAPE_SHM_RING_CONSUMER_NUM;
+}
+
+enum aushape_rc
+aushape_shm_consumer_open(struct aushape_shm_consumer **pconsumer,
+                          const char *path)
+{
+    enum aushape_rc rc;
+    struct aushape_shm_consumer *consumer = NULL;
+    struct sockaddr_un addr;
+    uint32_t idx;
+    struct iovec iov;
+    struct msghdr msg;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int) * 2)];
+    } cmsg;
+    struct cmsghdr *phdr;
+    int fds[2] = {-1, -1};
+    struct stat st;
+    void *map;
+
+    if (pconsumer == NULL || path == NULL ||
+        strlen(path) >= sizeof(addr.sun_path)) {
+        rc = AUSHAPE_RC_INVALID_ARGS;
+        goto cleanup;
+    }
+
+    consumer = calloc(1, sizeof(*consumer));
+    AUSHAPE_GUARD_BOOL(NOMEM, consumer != NULL);
+    consumer->sock_fd = -1;
+    consumer->efd = -1;
+
+    /* Connect */
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    consumer->sock_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED, consumer->sock_fd >= 0);
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED,
+                       connect(consumer->sock_fd,
+                               (struct sockaddr *)&addr,
+                               sizeof(addr)) == 0);
+
+    /* Receive the slot index, the memory file and the eventfd */
+    iov.iov_base = &idx;
+    iov.iov_len = sizeof(idx);
+    memset(&msg, 0, sizeof(msg));
+    memset(&cmsg, 0, sizeof(cmsg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsg.buf;
+    msg.msg_controllen = sizeof(cmsg.buf);
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED,
+                       recvmsg(consumer->sock_fd, &msg,
+                               MSG_CMSG_CLOEXEC) == (ssize_t)sizeof(idx));
+    phdr = CMSG_FIRSTHDR(&msg);
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED,
+                       phdr != NULL &&
+                       phdr->cmsg_level == SOL_SOCKET &&
+                       phdr->cmsg_type == SCM_RIGHTS &&
+                       phdr->cmsg_len == CMSG_LEN(sizeof(fds)));
+    memcpy(fds, CMSG_DATA(phdr), sizeof(fds));
+    consumer->efd = fds[1];
+    fds[1] = -1;
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED,
+                       (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) == 0 &&
+                       idx < AUSHAPE_SHM_RING_CONSUMER_NUM);
+
+    /* Map and verify the ring */
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED,
+                       fstat(fds[0], &st) == 0 &&
+                       (size_t)st.st_size >
+                            sizeof(struct aushape_shm_ring));
+    consumer->map_size = (size_t)st.st_size;
+    map = mmap(NULL, consumer->map_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED, fds[0], 0);
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED, map != MAP_FAILED);
+    consumer->ring = (struct aushape_shm_ring *)map;
+    consumer->size = consumer->ring->size;
+    consumer->slot = &consumer->ring->consumer_list[idx];
+    AUSHAPE_GUARD_BOOL(SHM_CONSUMER_INIT_FAILED,
+                       memcmp(consumer->ring->magic, AUSHAPE_SHM_RING_MAGIC,
+                              sizeof(consumer->ring->magic)) == 0 &&
+                       consumer->ring->version ==
+                            AUSHAPE_SHM_RING_VERSION &&
+                       aushape_shm_consumer_is_valid(consumer));
+
+    /* The output set our cursor before sending the message */
+    consumer->cursor = __atomic_load_n(&consumer->slot->cursor,
+                                       __ATOMIC_ACQUIRE);
+
+    *pconsumer = consumer;
+    consumer = NULL;
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (fds[0] >= 0) {
+        close(fds[0]);
+    }
+    if (fds[1] >= 0) {
+        close(fds[1]);
+    }
+    aushape_shm_consumer_close(consumer);
+    if (rc != AUSHAPE_RC_OK && pconsumer != NULL) {
+        *pconsumer = NULL;
+    }
+    return rc;
+}
+
+int
+aushape_shm_consumer_get_fd(const struct aushape_shm_consumer *consumer)
+{
+    assert(aushape_shm_consumer_is_valid(consumer));
+    return consumer->efd;
+}
+
+/**
+ * Check if the output of a shared-memory consumer was destroyed.
+ *
+ * @param consumer  The consumer to check.
+ *
+ * @return True if the output was destroyed, false otherwise.
+ */
+static bool
+aushape_shm_consumer_is_hup(const struct aushape_shm_consumer *consumer)
+{
+    assert(aushape_shm_consumer_is_valid(consumer));
+    return consumer->hup ||
+           __atomic_load_n(&consumer->ring->closed, __ATOMIC_ACQUIRE);
+}
+
+bool
+aushape_shm_consumer_is_closed(const struct aushape_shm_consumer *consumer)
+{
+    assert(aushape_shm_consumer_is_valid(consumer));
+    /* Check the head after the hangup, as it's not moving after that */
+    return aushape_shm_consumer_is_hup(consumer) &&
+           __atomic_load_n(&consumer->ring->head, __ATOMIC_ACQUIRE) ==
+                consumer->cursor;
+}
+
+/**
+ * Get the current time of the monotonic clock in milliseconds.
+ *
+ * @return The current time, milliseconds.
+ */
+static int64_t
+aushape_shm_consumer_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+enum aushape_rc
+aushape_shm_consumer_next(struct aushape_shm_consumer *consumer,
+                          int timeout,
+                          const void **pptr,
+                          size_t *plen)
+{
+    char *data;
+    int64_t deadline = 0;
+    int64_t left;
+    uint64_t head;
+    uint64_t off;
+    uint32_t len;
+    bool hup;
+    struct pollfd pfd_list[2];
+    uint64_t count;
+
+    if (!aushape_shm_consumer_is_valid(consumer) || pptr == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    data = aushape_shm_ring_data(consumer->ring);
+    if (timeout > 0) {
+        deadline = aushape_shm_consumer_now() + timeout;
+    }
+
+    /* Let the output overwrite the previous item */
+    if (consumer->held) {
+        __atomic_store_n(&consumer->slot->cursor, consumer->cursor,
+                         __ATOMIC_RELEASE);
+        consumer->held = false;
+    }
+
+    while (true) {
+        /* Check the hangup first, as the head is final after it */
+        hup = aushape_shm_consumer_is_hup(consumer);
+        head = __atomic_load_n(&consumer->ring->head, __ATOMIC_ACQUIRE);
+        if (head != consumer->cursor) {
+            if (head - consumer->cursor > consumer->size) {
+                return AUSHAPE_RC_SHM_CONSUMER_READ_FAILED;
+            }
+            off = consumer->cursor & (consumer->size - 1);
+            len = *(const uint32_t *)(data + off);
+            if (len == AUSHAPE_SHM_RING_WRAP) {
+                consumer->cursor += consumer->size - off;
+                continue;
+            }
+            if (aushape_shm_ring_item_size(len) > consumer->size - off) {
+                return AUSHAPE_RC_SHM_CONSUMER_READ_FAILED;
+            }
+            *pptr = data + off + AUSHAPE_SHM_RING_HDR_SIZE;
+            if (plen != NULL) {
+                *plen = len;
+            }
+            consumer->cursor += aushape_shm_ring_item_size(len);
+            consumer->held = true;
+            return AUSHAPE_RC_OK;
+        }
+
+        /* Publish the skipped area, if any */
+        __atomic_store_n(&consumer->slot->cursor, consumer->cursor,
+                         __ATOMIC_RELEASE);
+
+        if (hup) {
+            break;
+        }
+        if (timeout < 0) {
+            left = -1;
+        } else if (timeout == 0 ||
+                   (left = deadline - aushape_shm_consumer_now()) <= 0) {
+            break;
+        }
+
+        /* Ask for a wakeup, and make sure nothing arrived meanwhile */
+        __atomic_store_n(&consumer->slot->waiting, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&consumer->ring->head, __ATOMIC_SEQ_CST) !=
+                consumer->cursor ||
+            aushape_shm_consumer_is_hup(consumer)) {
+            __atomic_store_n(&consumer->slot->waiting, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        pfd_list[0].fd = consumer->efd;
+        pfd_list[0].events = POLLIN;
+        pfd_list[1].fd = consumer->sock_fd;
+        pfd_list[1].events = POLLIN;
+        if (poll(pfd_list, 2, left > INT32_MAX ? -1 : (int)left) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return AUSHAPE_RC_SHM_CONSUMER_READ_FAILED;
+        }
+        if (pfd_list[0].revents != 0 &&
+            read(consumer->efd, &count, sizeof(count)) < 0 &&
+            errno != EAGAIN) {
+            return AUSHAPE_RC_SHM_CONSUMER_READ_FAILED;
+        }
+        /* The output doesn't send anything after the first message */
+        if (pfd_list[1].revents != 0) {
+            consumer->hup = true;
+        }
+    }
+
+    *pptr = NULL;
+    if (plen != NULL) {
+        *plen = 0;
+    }
+    return AUSHAPE_RC_OK;
+}
+
+void
+aushape_shm_consumer_close(struct aushape_shm_consumer *consumer)
+{
+    if (consumer == NULL) {
+        return;
+    }
+    if (consumer->ring != NULL) {
+        munmap(consumer->ring, consumer->map_size);
+    }
+    if (consumer->efd >= 0) {
+        close(consumer->efd);
+    }
+    if (consumer->sock_fd >= 0) {
+        close(consumer->sock_fd);
+    }
+    free(consumer);
+}
@@ -0,0 +1,535 @@
+/*
+ * Shared-memory ring discrete aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/shm_output.h>
+#include <aushape/shm_ring.h>
+#include <aushape/guard.h>
+#include <pthread.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Time to wait before checking for space in a full ring again, ns */
+#define AUSHAPE_SHM_OUTPUT_FULL_DELAY   1000000
+
+/** Shared-memory output data */
+struct aushape_shm_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    struct sockaddr_un addr;        /**< Listening socket address */
+    int listen_fd;                  /**< Listening socket */
+    int stop_fd;                    /**< Eventfd stopping the listener */
+    int mem_fd;                     /**< Ring memory file */
+    struct aushape_shm_ring *ring;  /**< Mapped ring */
+    size_t map_size;                /**< Size of the ring mapping */
+    uint64_t size;                  /**< Size of the ring data area */
+    bool block;                     /**< True if waiting for space */
+    /** Consumer connections, -1 for free slots */
+    int conn_list[AUSHAPE_SHM_RING_CONSUMER_NUM];
+    /** Consumer eventfds, -1 for free slots */
+    int efd_list[AUSHAPE_SHM_RING_CONSUMER_NUM];
+    /** Statistics */
+    struct aushape_shm_output_stats stats;
+    /** True if the mutex is initialized */
+    bool mutex_init;
+    /** Mutex protecting the head and slots against the listener thread */
+    pthread_mutex_t mutex;
+    bool listener_run;              /**< True if the listener is running */
+    pthread_t listener;             /**< Listener thread */
+};
+
+/**
+ * Wake up the waiting consumers of a shared-memory output.
+ *
+ * @param shm_output    The output to wake up the consumers of.
+ * @param all           True if all consumers should be woken up, false if
+ *                      only those waiting.
+ */
+static void
+aushape_shm_output_wake(struct aushape_shm_output *shm_output, bool all)
+{
+    struct aushape_shm_ring_consumer *slot;
+    uint64_t one = 1;
+    size_t i;
+
+    assert(shm_output != NULL);
+
+    /* Order the head store before the flag loads, as consumers do */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (i = 0; i < AUSHAPE_SHM_RING_CONSUMER_NUM; i++) {
+        slot = &shm_output->ring->consumer_list[i];
+        if (shm_output->efd_list[i] >= 0 &&
+            (__atomic_exchange_n(&slot->waiting, 0, __ATOMIC_SEQ_CST) ||
+             all)) {
+            /* A full counter wakes up the consumer just as well */
+            if (write(shm_output->efd_list[i], &one, sizeof(one)) < 0) {
+                continue;
+            }
+        }
+    }
+}
+
+/**
+ * Free a consumer slot of a shared-memory output.
+ *
+ * @param shm_output    The output to free the slot of.
+ * @param i             Index of the slot to free.
+ */
+static void
+aushape_shm_output_free_slot(struct aushape_shm_output *shm_output,
+                             size_t i)
+{
+    assert(shm_output != NULL);
+    assert(i < AUSHAPE_SHM_RING_CONSUMER_NUM);
+
+    __atomic_store_n(&shm_output->ring->consumer_list[i].active, 0,
+                     __ATOMIC_RELEASE);
+    if (shm_output->efd_list[i] >= 0) {
+        close(shm_output->efd_list[i]);
+        shm_output->efd_list[i] = -1;
+    }
+    if (shm_output->conn_list[i] >= 0) {
+        close(shm_output->conn_list[i]);
+        shm_output->conn_list[i] = -1;
+    }
+}
+
+/**
+ * Accept a consumer connection to a shared-memory output, and hand it the
+ * ring and a slot.
+ *
+ * @param shm_output    The output to accept the connection to.
+ */
+static void
+aushape_shm_output_accept(struct aushape_shm_output *shm_output)
+{
+    struct aushape_shm_ring_consumer *slot;
+    int fd;
+    size_t i;
+    uint32_t idx;
+    struct iovec iov;
+    struct msghdr msg;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int) * 2)];
+    } cmsg;
+    int *fds;
+
+    assert(shm_output != NULL);
+
+    fd = accept4(shm_output->listen_fd, NULL, NULL,
+                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&shm_output->mutex);
+    for (i = 0; i < AUSHAPE_SHM_RING_CONSUMER_NUM &&
+                shm_output->conn_list[i] >= 0; i++);
+    /* Turn the consumer away, if there are no free slots */
+    if (i >= AUSHAPE_SHM_RING_CONSUMER_NUM) {
+        close(fd);
+        goto cleanup;
+    }
+    shm_output->conn_list[i] = fd;
+    shm_output->efd_list[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (shm_output->efd_list[i] < 0) {
+        aushape_shm_output_free_slot(shm_output, i);
+        goto cleanup;
+    }
+
+    /* Have the consumer start at the head */
+    slot = &shm_output->ring->consumer_list[i];
+    __atomic_store_n(&slot->cursor, shm_output->ring->head,
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->waiting, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->active, 1, __ATOMIC_RELEASE);
+
+    /* Send the slot index, the memory file, and the eventfd */
+    idx = (uint32_t)i;
+    iov.iov_base = &idx;
+    iov.iov_len = sizeof(idx);
+    memset(&msg, 0, sizeof(msg));
+    memset(&cmsg, 0, sizeof(cmsg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsg.buf;
+    msg.msg_controllen = sizeof(cmsg.buf);
+    cmsg.hdr.cmsg_level = SOL_SOCKET;
+    cmsg.hdr.cmsg_type = SCM_RIGHTS;
+    cmsg.hdr.cmsg_len = CMSG_LEN(sizeof(int) * 2);
+    fds = (int *)CMSG_DATA(&cmsg.hdr);
+    fds[0] = shm_output->mem_fd;
+    fds[1] = shm_output->efd_list[i];
+    if (sendmsg(fd, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(idx)) {
+        aushape_shm_output_free_slot(shm_output, i);
+    }
+
+cleanup:
+    pthread_mutex_unlock(&shm_output->mutex);
+}
+
+/**
+ * Run the listener of a shared-memory output: accept consumer connections
+ * and free slots of consumers which disconnect, until stopped.
+ *
+ * @param arg   The shared-memory output to run the listener for.
+ *
+ * @return NULL.
+ */
+static void *
+aushape_shm_output_listener_run(void *arg)
+{
+    struct aushape_shm_output *shm_output =
+                                    (struct aushape_shm_output *)arg;
+    struct pollfd pfd_list[AUSHAPE_SHM_RING_CONSUMER_NUM + 2];
+    size_t idx_list[AUSHAPE_SHM_RING_CONSUMER_NUM];
+    size_t num;
+    size_t i;
+
+    while (true) {
+        /* Only the listener changes connections, no need to lock */
+        pfd_list[0].fd = shm_output->stop_fd;
+        pfd_list[0].events = POLLIN;
+        pfd_list[1].fd = shm_output->listen_fd;
+        pfd_list[1].events = POLLIN;
+        num = 2;
+        for (i = 0; i < AUSHAPE_SHM_RING_CONSUMER_NUM; i++) {
+            if (shm_output->conn_list[i] >= 0) {
+                /* Consumers don't send anything, just disconnect */
+                pfd_list[num].fd = shm_output->conn_list[i];
+                pfd_list[num].events = POLLIN;
+                idx_list[num - 2] = i;
+                num++;
+            }
+        }
+        if (poll(pfd_list, num, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (pfd_list[0].revents != 0) {
+            break;
+        }
+        for (i = 2; i < num; i++) {
+            if (pfd_list[i].revents != 0) {
+                pthread_mutex_lock(&shm_output->mutex);
+                aushape_shm_output_free_slot(shm_output, idx_list[i - 2]);
+                pthread_mutex_unlock(&shm_output->mutex);
+            }
+        }
+        if (pfd_list[1].revents != 0) {
+            aushape_shm_output_accept(shm_output);
+        }
+    }
+
+    return NULL;
+}
+
+static void aushape_shm_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_shm_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_shm_output *shm_output =
+                                    (struct aushape_shm_output *)output;
+    const char *path = va_arg(ap, const char *);
+    size_t size = va_arg(ap, size_t);
+    bool block = (bool)va_arg(ap, int);
+    void *map;
+    enum aushape_rc rc;
+    size_t i;
+
+    assert(shm_output != NULL);
+
+    shm_output->listen_fd = -1;
+    shm_output->stop_fd = -1;
+    shm_output->mem_fd = -1;
+    for (i = 0; i < AUSHAPE_SHM_RING_CONSUMER_NUM; i++) {
+        shm_output->conn_list[i] = -1;
+        shm_output->efd_list[i] = -1;
+    }
+
+    if (path == NULL || *path == '\0' ||
+        strlen(path) >= sizeof(shm_output->addr.sun_path) ||
+        size < 4096 || size > SIZE_MAX / 4) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    /* Round the size up to a power of two, for cheap offsets */
+    shm_output->size = 4096;
+    while (shm_output->size < size) {
+        shm_output->size *= 2;
+    }
+    shm_output->block = block;
+
+    /* Create and map the ring */
+    shm_output->map_size = sizeof(struct aushape_shm_ring) +
+                           shm_output->size;
+    shm_output->mem_fd = memfd_create("aushape-shm", MFD_CLOEXEC);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, shm_output->mem_fd >= 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       ftruncate(shm_output->mem_fd,
+                                 (off_t)shm_output->map_size) == 0);
+    map = mmap(NULL, shm_output->map_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED, shm_output->mem_fd, 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, map != MAP_FAILED);
+    shm_output->ring = (struct aushape_shm_ring *)map;
+    memcpy(shm_output->ring->magic, AUSHAPE_SHM_RING_MAGIC,
+           sizeof(shm_output->ring->magic));
+    shm_output->ring->version = AUSHAPE_SHM_RING_VERSION;
+    shm_output->ring->size = shm_output->size;
+
+    /* Listen for consumers */
+    shm_output->addr.sun_family = AF_UNIX;
+    strcpy(shm_output->addr.sun_path, path);
+    shm_output->listen_fd = socket(AF_UNIX,
+                                   SOCK_SEQPACKET | SOCK_NONBLOCK |
+                                   SOCK_CLOEXEC, 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, shm_output->listen_fd >= 0);
+    unlink(path);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       bind(shm_output->listen_fd,
+                            (struct sockaddr *)&shm_output->addr,
+                            sizeof(shm_output->addr)) == 0);
+    if (listen(shm_output->listen_fd, AUSHAPE_SHM_RING_CONSUMER_NUM) != 0) {
+        unlink(path);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+
+    /* Start the listener */
+    shm_output->stop_fd = eventfd(0, EFD_CLOEXEC);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, shm_output->stop_fd >= 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_mutex_init(&shm_output->mutex, NULL) == 0);
+    shm_output->mutex_init = true;
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_create(&shm_output->listener, NULL,
+                                      aushape_shm_output_listener_run,
+                                      shm_output) == 0);
+    shm_output->listener_run = true;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_shm_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_shm_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_shm_output *shm_output =
+                                    (struct aushape_shm_output *)output;
+    assert(shm_output != NULL);
+
+    return shm_output->listen_fd >= 0 &&
+           shm_output->stop_fd >= 0 &&
+           shm_output->mem_fd >= 0 &&
+           shm_output->ring != NULL &&
+           shm_output->size >= 4096 &&
+           (shm_output->size & (shm_output->size - 1)) == 0 &&
+           shm_output->map_size == sizeof(struct aushape_shm_ring) +
+                                   shm_output->size &&
+           shm_output->mutex_init &&
+           shm_output->listener_run;
+}
+
+static void
+aushape_shm_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_shm_output *shm_output =
+                                    (struct aushape_shm_output *)output;
+    uint64_t one = 1;
+    size_t i;
+
+    assert(shm_output != NULL);
+
+    /* Stop the listener */
+    if (shm_output->listener_run) {
+        if (write(shm_output->stop_fd, &one, sizeof(one)) ==
+                (ssize_t)sizeof(one)) {
+            pthread_join(shm_output->listener, NULL);
+        } else {
+            pthread_cancel(shm_output->listener);
+            pthread_join(shm_output->listener, NULL);
+        }
+        shm_output->listener_run = false;
+    }
+    if (shm_output->mutex_init) {
+        pthread_mutex_destroy(&shm_output->mutex);
+        shm_output->mutex_init = false;
+    }
+
+    /* Let the consumers drain the ring and go */
+    if (shm_output->ring != NULL) {
+        __atomic_store_n(&shm_output->ring->closed, 1, __ATOMIC_RELEASE);
+        aushape_shm_output_wake(shm_output, true);
+    }
+    for (i = 0; i < AUSHAPE_SHM_RING_CONSUMER_NUM; i++) {
+        if (shm_output->ring != NULL) {
+            aushape_shm_output_free_slot(shm_output, i);
+        }
+    }
+
+    if (shm_output->stop_fd >= 0) {
+        close(shm_output->stop_fd);
+        shm_output->stop_fd = -1;
+    }
+    if (shm_output->listen_fd >= 0) {
+        unlink(shm_output->addr.sun_path);
+        close(shm_output->listen_fd);
+        shm_output->listen_fd = -1;
+    }
+    if (shm_output->ring != NULL) {
+        munmap(shm_output->ring, shm_output->map_size);
+        shm_output->ring = NULL;
+    }
+    if (shm_output->mem_fd >= 0) {
+        close(shm_output->mem_fd);
+        shm_output->mem_fd = -1;
+    }
+}
+
+static enum aushape_rc
+aushape_shm_output_write(struct aushape_output *output,
+                         const char *ptr,
+                         size_t len)
+{
+    struct aushape_shm_output *shm_output =
+                                    (struct aushape_shm_output *)output;
+    struct aushape_shm_ring *ring = shm_output->ring;
+    char *data = aushape_shm_ring_data(ring);
+    const struct timespec delay = {0, AUSHAPE_SHM_OUTPUT_FULL_DELAY};
+    uint64_t head;
+    uint64_t tail;
+    uint64_t cursor;
+    uint64_t off;
+    uint64_t item_size;
+    uint64_t need;
+    bool full = false;
+    size_t i;
+
+    assert(shm_output != NULL);
+    assert(ptr != NULL || len == 0);
+
+    pthread_mutex_lock(&shm_output->mutex);
+
+    item_size = aushape_shm_ring_item_size(len);
+    if (item_size > shm_output->size || len >= AUSHAPE_SHM_RING_WRAP) {
+        shm_output->stats.dropped++;
+        goto cleanup;
+    }
+
+    /* Wait for the slowest consumer to free enough space, or give up */
+    while (true) {
+        /* Only this thread changes the head */
+        head = ring->head;
+        off = head & (shm_output->size - 1);
+        need = item_size;
+        if (shm_output->size - off < item_size) {
+            need += shm_output->size - off;
+        }
+        tail = head;
+        for (i = 0; i < AUSHAPE_SHM_RING_CONSUMER_NUM; i++) {
+            if (shm_output->efd_list[i] >= 0) {
+                cursor = __atomic_load_n(&ring->consumer_list[i].cursor,
+                                         __ATOMIC_ACQUIRE);
+                if (head - cursor > head - tail) {
+                    tail = cursor;
+                }
+            }
+        }
+        if (shm_output->size - (head - tail) >= need) {
+            break;
+        }
+        if (!full) {
+            shm_output->stats.full++;
+            full = true;
+        }
+        if (!shm_output->block) {
+            shm_output->stats.dropped++;
+            goto cleanup;
+        }
+        /* Let the listener free slots of consumers gone meanwhile */
+        pthread_mutex_unlock(&shm_output->mutex);
+        nanosleep(&delay, NULL);
+        pthread_mutex_lock(&shm_output->mutex);
+    }
+
+    /* Skip the rest of the data area, if the item doesn't fit */
+    if (need > item_size) {
+        *(uint32_t *)(data + off) = AUSHAPE_SHM_RING_WRAP;
+        head += shm_output->size - off;
+        off = 0;
+    }
+
+    /* Append and publish the item */
+    ((uint32_t *)(data + off))[0] = (uint32_t)len;
+    ((uint32_t *)(data + off))[1] = 0;
+    memcpy(data + off + AUSHAPE_SHM_RING_HDR_SIZE, ptr, len);
+    __atomic_store_n(&ring->head, head + item_size, __ATOMIC_RELEASE);
+    shm_output->stats.appended++;
+    aushape_shm_output_wake(shm_output, false);
+
+cleanup:
+    pthread_mutex_unlock(&shm_output->mutex);
+    return AUSHAPE_RC_OK;
+}
+
+enum aushape_rc
+aushape_shm_output_get_stats(const struct aushape_output *output,
+                             struct aushape_shm_output_stats *pstats)
+{
+    struct aushape_shm_output *shm_output =
+                                    (struct aushape_shm_output *)output;
+
+    if (!aushape_output_is_valid(output) ||
+        output->type != &aushape_shm_output_type ||
+        pstats == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    pthread_mutex_lock(&shm_output->mutex);
+    *pstats = shm_output->stats;
+    pthread_mutex_unlock(&shm_output->mutex);
+
+    return AUSHAPE_RC_OK;
+}
+
+const struct aushape_output_type aushape_shm_output_type = {
+    .size       = sizeof(struct aushape_shm_output),
+    .cont       = false,
+    .init       = aushape_shm_output_init,
+    .is_valid   = aushape_shm_output_is_valid,
+    .write      = aushape_shm_output_write,
+    .cleanup    = aushape_shm_output_cleanup,
+};
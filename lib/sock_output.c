@@ -0,0 +1,853 @@
+/*
+ * Socket aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/sock_output.h>
+#include <aushape/guard.h>
+#include <aushape/flusher.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Length of the length prefix of framed documents, bytes */
+#define AUSHAPE_SOCK_OUTPUT_FRAME_HDR_LEN   4
+
+/** Outcome of an attempt to send a part of the buffer */
+enum aushape_sock_output_send {
+    /** Some output was sent */
+    AUSHAPE_SOCK_OUTPUT_SEND_OK,
+    /** The socket can't accept more output now */
+    AUSHAPE_SOCK_OUTPUT_SEND_WAIT,
+    /** The connection failed */
+    AUSHAPE_SOCK_OUTPUT_SEND_BROKEN,
+    /** The output can never be sent */
+    AUSHAPE_SOCK_OUTPUT_SEND_FAILED,
+};
+
+/** Socket output data */
+struct aushape_sock_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    /** Socket protocol */
+    enum aushape_sock_output_proto proto;
+    struct sockaddr_un unix_addr;   /**< Unix socket address */
+    char *host;                     /**< TCP host, or NULL */
+    char *port;                     /**< TCP port, or NULL */
+    bool framed;                    /**< True if documents are length-framed */
+    int fd;                         /**< Connected socket, or -1 */
+    size_t buf_size;                /**< Size of a batch, bytes */
+    char *buf;                      /**< Buffer of the batch being collected */
+    size_t buf_alloc;               /**< Allocated size of the buffer */
+    size_t buf_len;                 /**< Length of output in the buffer */
+    /** True if the buffer starts at a document boundary */
+    bool buf_whole;
+    /** Offsets of document ends in the buffer, ascending */
+    size_t *ends;
+    size_t ends_num;                /**< Number of document ends */
+    size_t ends_alloc;              /**< Allocated number of document ends */
+    /** Message headers for sending datagrams, ends_alloc long */
+    struct mmsghdr *msgs;
+    /** Message pieces for sending datagrams, ends_alloc long */
+    struct iovec *iovs;
+    size_t sent;                    /**< Length of the buffer sent so far */
+    unsigned int max_latency;       /**< Max buffering time, ms, or zero */
+    /** Monotonic time the buffer received its first byte at */
+    struct timespec buf_time;
+    unsigned int retry_min;         /**< First reconnection delay, ms */
+    unsigned int retry_max;         /**< Maximum reconnection delay, ms */
+    unsigned int retry;             /**< Next reconnection delay, ms */
+    unsigned int timeout;           /**< Batch sending timeout, ms, or zero */
+    /** Failure of sending the buffer, sticky */
+    enum aushape_rc rc;
+    /** Flusher sending the buffer after the maximum latency */
+    struct aushape_flusher flusher;
+};
+
+/**
+ * Wait for a socket to become writable.
+ *
+ * @param fd        The socket to wait for.
+ * @param deadline  The monotonic time to stop waiting at, or NULL for
+ *                  never.
+ *
+ * @return True if the socket became writable, or its connection failed,
+ *         false if waiting timed out, or failed.
+ */
+static bool
+aushape_sock_output_wait(int fd, const struct timespec *deadline)
+{
+    struct pollfd pfd;
+    int rc;
+
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    do {
+        rc = poll(&pfd, 1, aushape_flusher_time_left(deadline));
+    } while (rc < 0 && errno == EINTR);
+    return rc > 0;
+}
+
+/**
+ * Make an attempt to connect a non-blocking socket to an address.
+ *
+ * @param domain    The socket domain.
+ * @param type      The socket type.
+ * @param addr      The address to connect to.
+ * @param addrlen   The length of the address.
+ * @param deadline  The monotonic time to stop waiting for the connection
+ *                  at, or NULL for never.
+ *
+ * @return The connected socket, or -1, if connecting failed.
+ */
+static int
+aushape_sock_output_connect_addr(int domain, int type,
+                                 const struct sockaddr *addr,
+                                 socklen_t addrlen,
+                                 const struct timespec *deadline)
+{
+    int fd;
+    int err;
+    socklen_t errlen = sizeof(err);
+
+    assert(addr != NULL);
+
+    fd = socket(domain, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, addr, addrlen) == 0) {
+        return fd;
+    }
+    /* Wait for the connection to complete, if it didn't at once */
+    if ((errno == EINPROGRESS || errno == EINTR) &&
+        aushape_sock_output_wait(fd, deadline) &&
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen) == 0 &&
+        err == 0) {
+        return fd;
+    }
+    close(fd);
+    return -1;
+}
+
+/**
+ * Make an attempt to connect the socket of a socket output.
+ *
+ * @param sock_output   The socket output to connect.
+ * @param deadline      The monotonic time to stop waiting for the
+ *                      connection at, or NULL for never.
+ *
+ * @return True if connected, false otherwise.
+ */
+static bool
+aushape_sock_output_connect_once(struct aushape_sock_output *sock_output,
+                                 const struct timespec *deadline)
+{
+    struct addrinfo hints;
+    struct addrinfo *list;
+    struct addrinfo *ai;
+    int one = 1;
+
+    assert(sock_output != NULL);
+    assert(sock_output->fd < 0);
+
+    if (sock_output->proto != AUSHAPE_SOCK_OUTPUT_PROTO_TCP) {
+        sock_output->fd = aushape_sock_output_connect_addr(
+                    AF_UNIX,
+                    sock_output->proto == AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_DGRAM
+                        ? SOCK_DGRAM : SOCK_STREAM,
+                    (const struct sockaddr *)&sock_output->unix_addr,
+                    sizeof(sock_output->unix_addr),
+                    deadline);
+        return sock_output->fd >= 0;
+    }
+
+    /* Resolve on each attempt, to follow address changes */
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+    if (getaddrinfo(sock_output->host, sock_output->port,
+                    &hints, &list) != 0) {
+        return false;
+    }
+    for (ai = list; ai != NULL && sock_output->fd < 0; ai = ai->ai_next) {
+        sock_output->fd = aushape_sock_output_connect_addr(
+                                            ai->ai_family, ai->ai_socktype,
+                                            ai->ai_addr, ai->ai_addrlen,
+                                            deadline);
+    }
+    freeaddrinfo(list);
+    if (sock_output->fd < 0) {
+        return false;
+    }
+    /* Batches are formed already, don't delay them further */
+    setsockopt(sock_output->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+/**
+ * Connect the socket of a socket output, retrying with exponentially
+ * increasing delays.
+ *
+ * @param sock_output   The socket output to connect.
+ * @param deadline      The monotonic time to fail at, or NULL for never.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - connected successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - the deadline passed.
+ */
+static enum aushape_rc
+aushape_sock_output_connect(struct aushape_sock_output *sock_output,
+                            const struct timespec *deadline)
+{
+    struct timespec delay;
+    int left;
+
+    assert(sock_output != NULL);
+
+    while (!aushape_sock_output_connect_once(sock_output, deadline)) {
+        left = aushape_flusher_time_left(deadline);
+        if (left == 0) {
+            return AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+        if (left > 0 && (unsigned int)left < sock_output->retry) {
+            delay.tv_sec = left / 1000;
+            delay.tv_nsec = (long)(left % 1000) * 1000000;
+        } else {
+            delay.tv_sec = sock_output->retry / 1000;
+            delay.tv_nsec = (long)(sock_output->retry % 1000) * 1000000;
+        }
+        while (nanosleep(&delay, &delay) < 0 && errno == EINTR);
+        sock_output->retry = sock_output->retry > sock_output->retry_max / 2
+                                ? sock_output->retry_max
+                                : sock_output->retry * 2;
+    }
+    sock_output->retry = sock_output->retry_min;
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Close the connection of a socket output after it failed, and rewind
+ * the sent part of the buffer to the start of the first document not sent
+ * completely, if it's in the buffer, to send it whole again.
+ *
+ * @param sock_output   The socket output to disconnect.
+ */
+static void
+aushape_sock_output_disconnect(struct aushape_sock_output *sock_output)
+{
+    size_t sent;
+    size_t i;
+
+    assert(sock_output != NULL);
+    assert(sock_output->fd >= 0);
+
+    close(sock_output->fd);
+    sock_output->fd = -1;
+
+    sent = sock_output->buf_whole ? 0 : sock_output->sent;
+    for (i = 0; i < sock_output->ends_num &&
+                sock_output->ends[i] <= sock_output->sent; i++) {
+        sent = sock_output->ends[i];
+    }
+    sock_output->sent = sent;
+}
+
+/**
+ * Make an attempt to send a part of the buffer of a stream socket output.
+ *
+ * @param sock_output   The socket output to send the buffer of.
+ * @param len           Length of the buffer part to send.
+ *
+ * @return The outcome of the attempt.
+ */
+static enum aushape_sock_output_send
+aushape_sock_output_send_stream(struct aushape_sock_output *sock_output,
+                                size_t len)
+{
+    ssize_t rc;
+
+    assert(sock_output != NULL);
+    assert(sock_output->sent < len);
+
+    rc = send(sock_output->fd, sock_output->buf + sock_output->sent,
+              len - sock_output->sent, MSG_NOSIGNAL);
+    if (rc < 0) {
+        if (errno == EINTR) {
+            return AUSHAPE_SOCK_OUTPUT_SEND_OK;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return AUSHAPE_SOCK_OUTPUT_SEND_WAIT;
+        } else {
+            return AUSHAPE_SOCK_OUTPUT_SEND_BROKEN;
+        }
+    }
+    sock_output->sent += (size_t)rc;
+    return AUSHAPE_SOCK_OUTPUT_SEND_OK;
+}
+
+/**
+ * Make an attempt to send the datagrams in a part of the buffer of a
+ * datagram socket output.
+ *
+ * @param sock_output   The socket output to send the buffer of.
+ * @param len           Length of the buffer part to send, must be a
+ *                      document end.
+ *
+ * @return The outcome of the attempt.
+ */
+static enum aushape_sock_output_send
+aushape_sock_output_send_dgram(struct aushape_sock_output *sock_output,
+                               size_t len)
+{
+    size_t start = sock_output->sent;
+    unsigned int num = 0;
+    size_t i;
+    int rc;
+
+    assert(sock_output != NULL);
+    assert(sock_output->sent < len);
+
+    /* Describe the datagrams to send */
+    for (i = 0; i < sock_output->ends_num &&
+                sock_output->ends[i] <= len; i++) {
+        if (sock_output->ends[i] <= start) {
+            continue;
+        }
+        sock_output->iovs[num].iov_base = sock_output->buf + start;
+        sock_output->iovs[num].iov_len = sock_output->ends[i] - start;
+        memset(&sock_output->msgs[num], 0, sizeof(sock_output->msgs[num]));
+        sock_output->msgs[num].msg_hdr.msg_iov = &sock_output->iovs[num];
+        sock_output->msgs[num].msg_hdr.msg_iovlen = 1;
+        start = sock_output->ends[i];
+        num++;
+        if (num >= UIO_MAXIOV) {
+            break;
+        }
+    }
+    assert(num > 0);
+
+    rc = sendmmsg(sock_output->fd, sock_output->msgs, num, MSG_NOSIGNAL);
+    if (rc < 0) {
+        if (errno == EINTR) {
+            return AUSHAPE_SOCK_OUTPUT_SEND_OK;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK ||
+                   errno == ENOBUFS) {
+            return AUSHAPE_SOCK_OUTPUT_SEND_WAIT;
+        } else if (errno == EMSGSIZE) {
+            return AUSHAPE_SOCK_OUTPUT_SEND_FAILED;
+        } else {
+            return AUSHAPE_SOCK_OUTPUT_SEND_BROKEN;
+        }
+    }
+    for (i = 0; i < (size_t)rc; i++) {
+        sock_output->sent += sock_output->iovs[i].iov_len;
+    }
+    return AUSHAPE_SOCK_OUTPUT_SEND_OK;
+}
+
+/**
+ * Send a part of the buffer of a socket output, reconnecting as necessary,
+ * and remove it from the buffer, with the flusher locked, if started.
+ * Records the failure as the output's sticky return code.
+ *
+ * @param sock_output   The socket output to flush.
+ * @param len           Length of the buffer part to send, must be a
+ *                      document end for datagram sockets.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - flushed successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - sending failed.
+ */
+static enum aushape_rc
+aushape_sock_output_flush(struct aushape_sock_output *sock_output,
+                          size_t len)
+{
+    struct timespec deadline;
+    const struct timespec *pdeadline = NULL;
+    enum aushape_sock_output_send send;
+    size_t i;
+    size_t j;
+
+    assert(sock_output != NULL);
+    assert(len <= sock_output->buf_len);
+
+    if (sock_output->rc != AUSHAPE_RC_OK || len == 0) {
+        return sock_output->rc;
+    }
+
+    if (sock_output->timeout > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        aushape_flusher_time_add(&deadline, sock_output->timeout);
+        pdeadline = &deadline;
+    }
+
+    while (sock_output->sent < len) {
+        if (sock_output->fd < 0) {
+            sock_output->rc = aushape_sock_output_connect(sock_output,
+                                                          pdeadline);
+            if (sock_output->rc != AUSHAPE_RC_OK) {
+                return sock_output->rc;
+            }
+        }
+        send = (sock_output->proto == AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_DGRAM)
+                ? aushape_sock_output_send_dgram(sock_output, len)
+                : aushape_sock_output_send_stream(sock_output, len);
+        if (send == AUSHAPE_SOCK_OUTPUT_SEND_WAIT) {
+            if (!aushape_sock_output_wait(sock_output->fd, pdeadline) &&
+                aushape_flusher_time_left(pdeadline) == 0) {
+                sock_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+                return sock_output->rc;
+            }
+        } else if (send == AUSHAPE_SOCK_OUTPUT_SEND_BROKEN) {
+            aushape_sock_output_disconnect(sock_output);
+        } else if (send == AUSHAPE_SOCK_OUTPUT_SEND_FAILED) {
+            sock_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            return sock_output->rc;
+        }
+    }
+
+    /* Remove the sent part, and the ends within it */
+    memmove(sock_output->buf, sock_output->buf + len,
+            sock_output->buf_len - len);
+    sock_output->buf_len -= len;
+    sock_output->buf_whole = false;
+    for (i = 0, j = 0; i < sock_output->ends_num; i++) {
+        if (sock_output->ends[i] == len) {
+            sock_output->buf_whole = true;
+        } else if (sock_output->ends[i] > len) {
+            sock_output->ends[j++] = sock_output->ends[i] - len;
+        }
+    }
+    sock_output->ends_num = j;
+    sock_output->sent = 0;
+    if (sock_output->buf_len > 0 &&
+        aushape_flusher_is_started(&sock_output->flusher)) {
+        clock_gettime(CLOCK_MONOTONIC, &sock_output->buf_time);
+    }
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Record a document end at the end of the buffer of a socket output,
+ * unless there's one already.
+ *
+ * @param sock_output   The socket output to record the end for.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - recorded successfully,
+ *          AUSHAPE_RC_NOMEM    - memory allocation failed.
+ */
+static enum aushape_rc
+aushape_sock_output_add_end(struct aushape_sock_output *sock_output)
+{
+    size_t ends_alloc;
+    void *ptr;
+
+    assert(sock_output != NULL);
+
+    if (sock_output->buf_len == 0) {
+        sock_output->buf_whole = true;
+        return AUSHAPE_RC_OK;
+    }
+    if (sock_output->ends_num > 0 &&
+        sock_output->ends[sock_output->ends_num - 1] ==
+            sock_output->buf_len) {
+        return AUSHAPE_RC_OK;
+    }
+
+    if (sock_output->ends_num >= sock_output->ends_alloc) {
+        ends_alloc = sock_output->ends_alloc == 0
+                        ? 64 : sock_output->ends_alloc * 2;
+        ptr = realloc(sock_output->ends, sizeof(*sock_output->ends) *
+                                         ends_alloc);
+        if (ptr == NULL) {
+            return AUSHAPE_RC_NOMEM;
+        }
+        sock_output->ends = ptr;
+        if (sock_output->proto == AUSHAPE_SOCK_OUTPUT_PROTO_UNIX_DGRAM) {
+            ptr = realloc(sock_output->msgs, sizeof(*sock_output->msgs) *
+                                             ends_alloc);
+            if (ptr == NULL) {
+                return AUSHAPE_RC_NOMEM;
+            }
+            sock_output->msgs = ptr;
+            ptr = realloc(sock_output->iovs, sizeof(*sock_output->iovs) *
+                                             ends_alloc);
+            if (ptr == NULL) {
+                return AUSHAPE_RC_NOMEM;
+            }
+            sock_output->iovs = ptr;
+        }
+        sock_output->ends_alloc = ends_alloc;
+    }
+    sock_output->ends[sock_output->ends_num++] = sock_output->buf_len;
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Append a piece to the buffer of a socket output, notifying the flusher,
+ * if the buffer was empty. The piece must fit into the allocated buffer.
+ *
+ * @param sock_output   The socket output to append to.
+ * @param ptr           The piece to append.
+ * @param len           Length of the piece.
+ */
+static void
+aushape_sock_output_append(struct aushape_sock_output *sock_output,
+                           const void *ptr, size_t len)
+{
+    assert(sock_output != NULL);
+    assert(len <= sock_output->buf_alloc - sock_output->buf_len);
+
+    if (sock_output->buf_len == 0 &&
+        aushape_flusher_is_started(&sock_output->flusher)) {
+        clock_gettime(CLOCK_MONOTONIC, &sock_output->buf_time);
+        aushape_flusher_signal(&sock_output->flusher);
+    }
+    memcpy(sock_output->buf + sock_output->buf_len, ptr, len);
+    sock_output->buf_len += len;
+}
+
+/**
+ * Get the time a socket output's buffer is due to be sent at by the
+ * flusher: once it stays in the buffer for the maximum latency.
+ *
+ * @param data      The socket output to get the flush time of.
+ * @param pdeadline Location for the flush time.
+ *
+ * @return True if a flush is pending, false otherwise.
+ */
+static bool
+aushape_sock_output_flusher_due(void *data, struct timespec *pdeadline)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)data;
+
+    assert(sock_output != NULL);
+    assert(pdeadline != NULL);
+
+    if (sock_output->buf_len == 0 || sock_output->rc != AUSHAPE_RC_OK) {
+        return false;
+    }
+    *pdeadline = sock_output->buf_time;
+    aushape_flusher_time_add(pdeadline, sock_output->max_latency);
+    return true;
+}
+
+/**
+ * Flush a socket output from the flusher: send the whole buffer.
+ *
+ * @param data  The socket output to flush.
+ * @param now   The current monotonic time.
+ */
+static void
+aushape_sock_output_flusher_flush(void *data, const struct timespec *now)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)data;
+
+    assert(sock_output != NULL);
+    assert(now != NULL);
+    (void)now;
+
+    aushape_sock_output_flush(sock_output, sock_output->buf_len);
+}
+
+static void aushape_sock_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_sock_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)output;
+    enum aushape_sock_output_proto proto =
+                            (enum aushape_sock_output_proto)va_arg(ap, int);
+    const char *addr = va_arg(ap, const char *);
+    bool framed = (bool)va_arg(ap, int);
+    size_t buf_size = va_arg(ap, size_t);
+    unsigned int max_latency = va_arg(ap, unsigned int);
+    unsigned int retry_min = va_arg(ap, unsigned int);
+    unsigned int retry_max = va_arg(ap, unsigned int);
+    unsigned int timeout = va_arg(ap, unsigned int);
+    const char *colon;
+    const char *host;
+    size_t host_len;
+    enum aushape_rc rc;
+
+    assert(sock_output != NULL);
+
+    sock_output->fd = -1;
+
+    if (!aushape_sock_output_proto_is_valid(proto) || addr == NULL ||
+        buf_size == 0 || retry_min == 0 || retry_max < retry_min) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    /* Parse the address */
+    if (proto == AUSHAPE_SOCK_OUTPUT_PROTO_TCP) {
+        colon = strrchr(addr, ':');
+        if (colon == NULL || colon == addr || colon[1] == '\0') {
+            return AUSHAPE_RC_INVALID_ARGS;
+        }
+        host = addr;
+        host_len = (size_t)(colon - addr);
+        if (host[0] == '[' && host[host_len - 1] == ']') {
+            host++;
+            host_len -= 2;
+        }
+        sock_output->host = strndup(host, host_len);
+        AUSHAPE_GUARD_BOOL(NOMEM, sock_output->host != NULL);
+        sock_output->port = strdup(colon + 1);
+        AUSHAPE_GUARD_BOOL(NOMEM, sock_output->port != NULL);
+    } else {
+        AUSHAPE_GUARD_BOOL(INVALID_ARGS,
+                           *addr != '\0' &&
+                           strlen(addr) <
+                                sizeof(sock_output->unix_addr.sun_path));
+        sock_output->unix_addr.sun_family = AF_UNIX;
+        strcpy(sock_output->unix_addr.sun_path, addr);
+    }
+
+    sock_output->proto = proto;
+    sock_output->framed = framed;
+    sock_output->buf = malloc(buf_size);
+    AUSHAPE_GUARD_BOOL(NOMEM, sock_output->buf != NULL);
+    sock_output->buf_size = buf_size;
+    sock_output->buf_alloc = buf_size;
+    sock_output->buf_whole = true;
+    sock_output->retry_min = retry_min;
+    sock_output->retry_max = retry_max;
+    sock_output->retry = retry_min;
+    sock_output->timeout = timeout;
+    sock_output->rc = AUSHAPE_RC_OK;
+
+    /* Start the flusher, if the buffering time is limited */
+    if (max_latency > 0) {
+        sock_output->max_latency = max_latency;
+        AUSHAPE_GUARD(aushape_flusher_start(&sock_output->flusher,
+                                            aushape_sock_output_flusher_due,
+                                            aushape_sock_output_flusher_flush,
+                                            sock_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_sock_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_sock_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)output;
+    assert(sock_output != NULL);
+
+    return aushape_sock_output_proto_is_valid(sock_output->proto) &&
+           (sock_output->proto != AUSHAPE_SOCK_OUTPUT_PROTO_TCP ||
+            (sock_output->host != NULL && sock_output->port != NULL)) &&
+           sock_output->buf != NULL &&
+           sock_output->buf_size > 0 &&
+           sock_output->retry_min > 0 &&
+           sock_output->retry_max >= sock_output->retry_min &&
+           (sock_output->max_latency == 0 ||
+            aushape_flusher_is_started(&sock_output->flusher));
+}
+
+static void
+aushape_sock_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)output;
+    assert(sock_output != NULL);
+
+    /* Stop the flusher */
+    aushape_flusher_stop(&sock_output->flusher);
+
+    /* Try to send the remaining output */
+    if (sock_output->buf != NULL) {
+        aushape_sock_output_flush(sock_output, sock_output->buf_len);
+    }
+    if (sock_output->fd >= 0) {
+        close(sock_output->fd);
+        sock_output->fd = -1;
+    }
+
+    free(sock_output->iovs);
+    sock_output->iovs = NULL;
+    free(sock_output->msgs);
+    sock_output->msgs = NULL;
+    free(sock_output->ends);
+    sock_output->ends = NULL;
+    sock_output->ends_num = 0;
+    sock_output->ends_alloc = 0;
+    free(sock_output->buf);
+    sock_output->buf = NULL;
+    sock_output->buf_len = 0;
+    free(sock_output->port);
+    sock_output->port = NULL;
+    free(sock_output->host);
+    sock_output->host = NULL;
+}
+
+static enum aushape_rc
+aushape_sock_output_write(struct aushape_output *output,
+                          const char *ptr,
+                          size_t len)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)output;
+    size_t space;
+
+    assert(sock_output != NULL);
+
+    if (len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+
+    aushape_flusher_lock(&sock_output->flusher);
+    /* Continue the document, sending full batches */
+    while (sock_output->rc == AUSHAPE_RC_OK && len > 0) {
+        if (sock_output->buf_len >= sock_output->buf_size) {
+            aushape_sock_output_flush(sock_output, sock_output->buf_len);
+            continue;
+        }
+        space = sock_output->buf_size - sock_output->buf_len;
+        if (space > len) {
+            space = len;
+        }
+        aushape_sock_output_append(sock_output, ptr, space);
+        ptr += space;
+        len -= space;
+    }
+    aushape_flusher_unlock(&sock_output->flusher);
+    return sock_output->rc;
+}
+
+static enum aushape_rc
+aushape_sock_output_disc_write(struct aushape_output *output,
+                               const char *ptr,
+                               size_t len)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)output;
+    unsigned char hdr[AUSHAPE_SOCK_OUTPUT_FRAME_HDR_LEN];
+    size_t hdr_len = sock_output->framed ? sizeof(hdr) : 0;
+    char *buf;
+    enum aushape_rc rc;
+
+    assert(sock_output != NULL);
+
+    if (len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+    if (sock_output->framed && len > UINT32_MAX) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    aushape_flusher_lock(&sock_output->flusher);
+    /* Send the batch, if the document doesn't fit */
+    if (hdr_len + len > sock_output->buf_size - sock_output->buf_len) {
+        AUSHAPE_GUARD(aushape_sock_output_flush(sock_output,
+                                                sock_output->buf_len));
+    }
+    AUSHAPE_GUARD(sock_output->rc);
+    /* Keep the document whole, even if it's bigger than a batch */
+    if (hdr_len + len > sock_output->buf_alloc) {
+        buf = realloc(sock_output->buf, hdr_len + len);
+        AUSHAPE_GUARD_BOOL(NOMEM, buf != NULL);
+        sock_output->buf = buf;
+        sock_output->buf_alloc = hdr_len + len;
+    }
+    if (sock_output->framed) {
+        hdr[0] = (unsigned char)(len >> 24);
+        hdr[1] = (unsigned char)(len >> 16);
+        hdr[2] = (unsigned char)(len >> 8);
+        hdr[3] = (unsigned char)len;
+        aushape_sock_output_append(sock_output, hdr, hdr_len);
+    }
+    aushape_sock_output_append(sock_output, ptr, len);
+    AUSHAPE_GUARD(aushape_sock_output_add_end(sock_output));
+    if (sock_output->buf_len >= sock_output->buf_size) {
+        AUSHAPE_GUARD(aushape_sock_output_flush(sock_output,
+                                                sock_output->buf_len));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_flusher_unlock(&sock_output->flusher);
+    return rc;
+}
+
+static enum aushape_rc
+aushape_sock_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_sock_output *sock_output =
+                                    (struct aushape_sock_output *)output;
+    enum aushape_rc rc;
+
+    assert(sock_output != NULL);
+
+    aushape_flusher_lock(&sock_output->flusher);
+    AUSHAPE_GUARD(sock_output->rc);
+    AUSHAPE_GUARD(aushape_sock_output_add_end(sock_output));
+    /* Keep collecting the batch between documents, unless flushed */
+    if (full) {
+        AUSHAPE_GUARD(aushape_sock_output_flush(sock_output,
+                                                sock_output->buf_len));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_flusher_unlock(&sock_output->flusher);
+    return rc;
+}
+
+const struct aushape_output_type aushape_sock_output_type = {
+    .size       = sizeof(struct aushape_sock_output),
+    .cont       = true,
+    .init       = aushape_sock_output_init,
+    .is_valid   = aushape_sock_output_is_valid,
+    .write      = aushape_sock_output_write,
+    .sync       = aushape_sock_output_sync,
+    .cleanup    = aushape_sock_output_cleanup,
+};
+
+const struct aushape_output_type aushape_sock_disc_output_type = {
+    .size       = sizeof(struct aushape_sock_output),
+    .cont       = false,
+    .init       = aushape_sock_output_init,
+    .is_valid   = aushape_sock_output_is_valid,
+    .write      = aushape_sock_output_disc_write,
+    .sync       = aushape_sock_output_sync,
+    .cleanup    = aushape_sock_output_cleanup,
+};
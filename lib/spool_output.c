@@ -0,0 +1,1378 @@
+/*
+ * Disk-spooling aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <aushape/spool_output.h>
+#include <aushape/flusher.h>
+#include <aushape/gbuf.h>
+#include <aushape/guard.h>
+#include <zlib.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <assert.h>
+
+/** Initial size of record data buffers, bytes */
+#define AUSHAPE_SPOOL_OUTPUT_BUF_SIZE   4096
+
+/** Record header magic number, "ASPL" */
+#define AUSHAPE_SPOOL_OUTPUT_REC_MAGIC  0x4c505341
+
+/** Record header flag: the record ends at a document boundary */
+#define AUSHAPE_SPOOL_OUTPUT_REC_BOUNDARY   0x1
+
+/** Segment file name format, taking the segment sequence number */
+#define AUSHAPE_SPOOL_OUTPUT_SEG_NAME_FMT   "%016" PRIx64 ".seg"
+
+/** Length of a segment file name */
+#define AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN   20
+
+/** Cursor file name */
+#define AUSHAPE_SPOOL_OUTPUT_CURSOR_NAME    "cursor"
+
+/** Temporary cursor file name, renamed to the cursor file name */
+#define AUSHAPE_SPOOL_OUTPUT_CURSOR_TMP_NAME    "cursor.tmp"
+
+/** Minimum time between cursor checkpoints, milliseconds */
+#define AUSHAPE_SPOOL_OUTPUT_CHECKPOINT_INTERVAL    1000
+
+/*
+ * Records are stored in the host byte order, as the spool is not supposed
+ * to be moved between hosts.
+ */
+
+/** Record header */
+struct aushape_spool_output_rec_hdr {
+    uint32_t    magic;      /**< AUSHAPE_SPOOL_OUTPUT_REC_MAGIC */
+    uint32_t    flags;      /**< AUSHAPE_SPOOL_OUTPUT_REC_* flags */
+    uint32_t    data_len;   /**< Length of the output */
+    uint32_t    event_num;  /**< Number of events following the output */
+    /** CRC32 of the header with zero CRC, the output and the events */
+    uint32_t    crc;
+    uint32_t    reserved;   /**< Zero */
+};
+
+/** Record event */
+struct aushape_spool_output_rec_event {
+    uint64_t    serial;     /**< Event serial number */
+    int64_t     sec;        /**< Event time, seconds since epoch */
+    uint32_t    msec;       /**< Event time, milliseconds */
+    uint32_t    reserved;   /**< Zero */
+};
+
+/** Record contents */
+struct aushape_spool_output_rec {
+    /** Output */
+    struct aushape_gbuf data;
+    /** Notified events, an array of struct aushape_spool_output_rec_event */
+    struct aushape_gbuf events;
+    /** True if the record ends at a document boundary */
+    bool boundary;
+};
+
+/** Result of reading a record from a segment */
+enum aushape_spool_output_read {
+    /** Read successfully */
+    AUSHAPE_SPOOL_OUTPUT_READ_OK,
+    /** Reached the end of the segment */
+    AUSHAPE_SPOOL_OUTPUT_READ_END,
+    /** Found a damaged or incomplete record */
+    AUSHAPE_SPOOL_OUTPUT_READ_DAMAGED,
+    /** Reading failed */
+    AUSHAPE_SPOOL_OUTPUT_READ_FAILED,
+};
+
+/** Spooling output data */
+struct aushape_spool_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    struct aushape_output *inner;   /**< Output to write to */
+    bool inner_owned;               /**< True if inner output is owned */
+    uint64_t max_size;              /**< Maximum size of segments, bytes */
+    uint64_t segment_size;          /**< Size to start a new segment at */
+    unsigned int retry;             /**< Write retry delay, ms */
+    /** Full spool policy */
+    enum aushape_spool_output_policy policy;
+
+    /** Spool directory FD, locked, or -1 */
+    int dir_fd;
+    /** FD of the segment being appended to, or -1 */
+    int tail_fd;
+
+    /** Record being filled, accessed by the converting thread only */
+    struct aushape_spool_output_rec fill;
+    /** Record being written, accessed by the writer thread only */
+    struct aushape_spool_output_rec work;
+
+    /** True if the mutex and conditions below are initialized */
+    bool            sync_init;
+    /** Mutex protecting everything below */
+    pthread_mutex_t mutex;
+    /**
+     * Condition signaled when a record is appended, or a synchronization
+     * is requested, or the writer should stop. Uses the monotonic clock.
+     */
+    pthread_cond_t  appended_cond;
+    /** Condition signaled when the writer removes a segment, or exits */
+    pthread_cond_t  removed_cond;
+    /** Sequence number of the oldest segment, the one being read */
+    uint64_t        head_seq;
+    /** Offset of the next record to read in the oldest segment */
+    uint64_t        read_off;
+    /**
+     * Offset in the oldest segment, up to which the records written to the
+     * inner output were confirmed by its full synchronization
+     */
+    uint64_t        synced_off;
+    /** Sequence number of the segment being appended to */
+    uint64_t        tail_seq;
+    /** Length of the records appended to the segment being appended to */
+    uint64_t        tail_len;
+    /** Size of the segment files, bytes */
+    uint64_t        size;
+    /** True if the inner output should be fully synchronized once idle */
+    bool            sync_req;
+    /** True if the writer should exit when out of records, or failing */
+    bool            stop;
+    /** True if the writer thread is running */
+    bool            writer_run;
+    /** Writer thread */
+    pthread_t       writer;
+    /** First spool failure return code, or OK */
+    enum aushape_rc rc;
+    /** Statistics, except size and segments */
+    struct aushape_spool_output_stats stats;
+};
+
+/**
+ * Initialize a record.
+ *
+ * @param rec   The record to initialize.
+ */
+static void
+aushape_spool_output_rec_init(struct aushape_spool_output_rec *rec)
+{
+    assert(rec != NULL);
+    aushape_gbuf_init(&rec->data, AUSHAPE_SPOOL_OUTPUT_BUF_SIZE, NULL);
+    aushape_gbuf_init(&rec->events,
+                      sizeof(struct aushape_spool_output_rec_event) * 16,
+                      NULL);
+    rec->boundary = false;
+}
+
+/**
+ * Empty a record, keeping its memory.
+ *
+ * @param rec   The record to empty.
+ */
+static void
+aushape_spool_output_rec_empty(struct aushape_spool_output_rec *rec)
+{
+    assert(rec != NULL);
+    aushape_gbuf_empty(&rec->data);
+    aushape_gbuf_empty(&rec->events);
+    rec->boundary = false;
+}
+
+/**
+ * Cleanup a record, freeing its memory.
+ *
+ * @param rec   The record to cleanup.
+ */
+static void
+aushape_spool_output_rec_cleanup(struct aushape_spool_output_rec *rec)
+{
+    assert(rec != NULL);
+    aushape_gbuf_cleanup(&rec->data);
+    aushape_gbuf_cleanup(&rec->events);
+}
+
+/**
+ * Format the name of a segment file.
+ *
+ * @param buf   The buffer to format the name in, at least
+ *              AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN + 1 bytes long.
+ * @param seq   The sequence number of the segment.
+ *
+ * @return The buffer.
+ */
+static char *
+aushape_spool_output_seg_name(char *buf, uint64_t seq)
+{
+    assert(buf != NULL);
+    snprintf(buf, AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN + 1,
+             AUSHAPE_SPOOL_OUTPUT_SEG_NAME_FMT, seq);
+    return buf;
+}
+
+/**
+ * Compute the checksum of a record.
+ *
+ * @param hdr       The record header, with zero checksum.
+ * @param data      The record output.
+ * @param events    The record events.
+ *
+ * @return The checksum.
+ */
+static uint32_t
+aushape_spool_output_rec_crc(const struct aushape_spool_output_rec_hdr *hdr,
+                             const struct aushape_gbuf *data,
+                             const struct aushape_gbuf *events)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+
+    assert(hdr != NULL);
+    assert(hdr->crc == 0);
+    assert(aushape_gbuf_is_valid(data));
+    assert(aushape_gbuf_is_valid(events));
+
+    crc = crc32(crc, (const Bytef *)hdr, sizeof(*hdr));
+    if (data->len > 0) {
+        crc = crc32(crc, (const Bytef *)data->ptr, (uInt)data->len);
+    }
+    if (events->len > 0) {
+        crc = crc32(crc, (const Bytef *)events->ptr, (uInt)events->len);
+    }
+    return (uint32_t)crc;
+}
+
+/**
+ * Read a piece of a file at an offset completely.
+ *
+ * @param fd    The FD of the file to read.
+ * @param ptr   The buffer to read into.
+ * @param len   Length of the piece to read.
+ * @param off   Offset of the piece to read.
+ *
+ * @return True if read successfully, false if reading failed, or the file
+ *         ended.
+ */
+static bool
+aushape_spool_output_pread(int fd, void *ptr, size_t len, uint64_t off)
+{
+    ssize_t rc;
+
+    while (len > 0) {
+        rc = pread(fd, ptr, len, (off_t)off);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        } else if (rc == 0) {
+            return false;
+        }
+        ptr = (char *)ptr + rc;
+        len -= (size_t)rc;
+        off += (uint64_t)rc;
+    }
+    return true;
+}
+
+/**
+ * Write a vector of pieces to a file completely.
+ *
+ * @param fd        The FD of the file to write.
+ * @param iov       The vector of pieces to write, will be modified.
+ * @param iovcnt    Number of pieces in the vector.
+ *
+ * @return True if written successfully, false otherwise.
+ */
+static bool
+aushape_spool_output_writev(int fd, struct iovec *iov, int iovcnt)
+{
+    ssize_t rc;
+    size_t len;
+
+    assert(iov != NULL || iovcnt == 0);
+
+    while (iovcnt > 0) {
+        rc = writev(fd, iov, iovcnt);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        len = (size_t)rc;
+        while (iovcnt > 0 && len >= iov->iov_len) {
+            len -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + len;
+            iov->iov_len -= len;
+        }
+    }
+    return true;
+}
+
+/**
+ * Load the state of the spool directory of a spooling output: read the
+ * cursor, remove the segments before it, and account for the rest.
+ *
+ * @param spool_output  The spooling output to load the spool of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - loaded successfully,
+ *          AUSHAPE_RC_OUTPUT_INIT_FAILED   - accessing the spool failed.
+ */
+static enum aushape_rc
+aushape_spool_output_load(struct aushape_spool_output *spool_output)
+{
+    enum aushape_rc rc;
+    int fd = -1;
+    DIR *dir = NULL;
+    struct dirent *ent;
+    struct stat st;
+    char buf[64];
+    ssize_t len;
+    uint64_t cursor_seq = 0;
+    uint64_t cursor_off = 0;
+    bool cursor = false;
+    uint64_t seq;
+    uint64_t min_seq = UINT64_MAX;
+    uint64_t max_seq = 0;
+    int end;
+
+    assert(spool_output != NULL);
+    assert(spool_output->dir_fd >= 0);
+
+    /* Read the cursor, if any, ignoring it if damaged */
+    fd = openat(spool_output->dir_fd, AUSHAPE_SPOOL_OUTPUT_CURSOR_NAME,
+                O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        len = read(fd, buf, sizeof(buf) - 1);
+        AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, len >= 0);
+        buf[len] = '\0';
+        end = 0;
+        cursor = sscanf(buf, "%" SCNu64 " %" SCNu64 "\n%n",
+                        &cursor_seq, &cursor_off, &end) >= 2 &&
+                 end == len;
+        close(fd);
+        fd = -1;
+    } else {
+        AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, errno == ENOENT);
+    }
+
+    /* Scan the segments, removing those already written */
+    fd = openat(spool_output->dir_fd, ".",
+                O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, fd >= 0);
+    dir = fdopendir(fd);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, dir != NULL);
+    fd = -1;
+    while ((ent = readdir(dir)) != NULL) {
+        end = 0;
+        if (strlen(ent->d_name) != AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN ||
+            sscanf(ent->d_name, "%16" SCNx64 ".seg%n", &seq, &end) < 1 ||
+            end != AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN) {
+            continue;
+        }
+        if (cursor && seq < cursor_seq) {
+            AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                               unlinkat(spool_output->dir_fd,
+                                        ent->d_name, 0) == 0);
+            continue;
+        }
+        AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                           fstatat(spool_output->dir_fd, ent->d_name,
+                                   &st, 0) == 0);
+        spool_output->size += (uint64_t)st.st_size;
+        if (seq < min_seq) {
+            min_seq = seq;
+        }
+        if (seq > max_seq) {
+            max_seq = seq;
+        }
+    }
+
+    /* Continue reading from the cursor, and append to a new segment */
+    if (cursor && cursor_seq > max_seq) {
+        max_seq = cursor_seq;
+    }
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, max_seq < UINT64_MAX);
+    spool_output->tail_seq = max_seq + 1;
+    if (min_seq == UINT64_MAX) {
+        spool_output->head_seq = spool_output->tail_seq;
+    } else {
+        spool_output->head_seq = min_seq;
+        if (cursor && cursor_seq == min_seq) {
+            spool_output->read_off = cursor_off;
+            spool_output->synced_off = cursor_off;
+        }
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (dir != NULL) {
+        closedir(dir);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return rc;
+}
+
+/**
+ * Checkpoint the cursor of a spooling output, the position of the records
+ * confirmed by the inner output, to the cursor file, replacing it
+ * atomically. Called by the writer only.
+ *
+ * @param spool_output  The spooling output to checkpoint the cursor of.
+ * @param seq           Sequence number of the segment being read.
+ * @param off           Offset of the next record to read in the segment.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - checkpointed successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - writing the cursor failed.
+ */
+static enum aushape_rc
+aushape_spool_output_checkpoint(struct aushape_spool_output *spool_output,
+                                uint64_t seq, uint64_t off)
+{
+    enum aushape_rc rc;
+    char buf[64];
+    struct iovec iov;
+    int fd;
+
+    assert(spool_output != NULL);
+
+    iov.iov_base = buf;
+    iov.iov_len = (size_t)snprintf(buf, sizeof(buf),
+                                   "%" PRIu64 " %" PRIu64 "\n", seq, off);
+    fd = openat(spool_output->dir_fd, AUSHAPE_SPOOL_OUTPUT_CURSOR_TMP_NAME,
+                O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, fd >= 0);
+    if (!aushape_spool_output_writev(fd, &iov, 1)) {
+        close(fd);
+        rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        goto cleanup;
+    }
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, close(fd) == 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                       renameat(spool_output->dir_fd,
+                                AUSHAPE_SPOOL_OUTPUT_CURSOR_TMP_NAME,
+                                spool_output->dir_fd,
+                                AUSHAPE_SPOOL_OUTPUT_CURSOR_NAME) == 0);
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Read a record from a segment into the work record of a spooling output.
+ * Called by the writer only.
+ *
+ * @param spool_output  The spooling output to read the record for.
+ * @param fd            The FD of the segment to read.
+ * @param off           Offset of the record in the segment.
+ * @param end           Length of the records in the segment.
+ * @param plen          Location for the length of the read record.
+ *
+ * @return The result of reading.
+ */
+static enum aushape_spool_output_read
+aushape_spool_output_read(struct aushape_spool_output *spool_output,
+                          int fd, uint64_t off, uint64_t end, uint64_t *plen)
+{
+    struct aushape_spool_output_rec *work = &spool_output->work;
+    struct aushape_spool_output_rec_hdr hdr;
+    uint32_t crc;
+    uint64_t left;
+    size_t events_len;
+
+    assert(spool_output != NULL);
+    assert(plen != NULL);
+
+    if (off >= end) {
+        return AUSHAPE_SPOOL_OUTPUT_READ_END;
+    }
+    left = end - off;
+    if (left < sizeof(hdr) ||
+        !aushape_spool_output_pread(fd, &hdr, sizeof(hdr), off) ||
+        hdr.magic != AUSHAPE_SPOOL_OUTPUT_REC_MAGIC) {
+        return AUSHAPE_SPOOL_OUTPUT_READ_DAMAGED;
+    }
+    left -= sizeof(hdr);
+    if (hdr.data_len > left ||
+        hdr.event_num > (left - hdr.data_len) /
+                        sizeof(struct aushape_spool_output_rec_event)) {
+        return AUSHAPE_SPOOL_OUTPUT_READ_DAMAGED;
+    }
+    events_len = hdr.event_num *
+                 sizeof(struct aushape_spool_output_rec_event);
+
+    aushape_spool_output_rec_empty(work);
+    if (aushape_gbuf_accomodate(&work->data, hdr.data_len) !=
+            AUSHAPE_RC_OK ||
+        aushape_gbuf_accomodate(&work->events, events_len) !=
+            AUSHAPE_RC_OK) {
+        return AUSHAPE_SPOOL_OUTPUT_READ_FAILED;
+    }
+    off += sizeof(hdr);
+    if (!aushape_spool_output_pread(fd, work->data.ptr,
+                                    hdr.data_len, off) ||
+        !aushape_spool_output_pread(fd, work->events.ptr,
+                                    events_len, off + hdr.data_len)) {
+        return AUSHAPE_SPOOL_OUTPUT_READ_DAMAGED;
+    }
+    work->data.len = hdr.data_len;
+    work->events.len = events_len;
+    work->boundary = (hdr.flags & AUSHAPE_SPOOL_OUTPUT_REC_BOUNDARY) != 0;
+
+    crc = hdr.crc;
+    hdr.crc = 0;
+    if (aushape_spool_output_rec_crc(&hdr, &work->data, &work->events) !=
+            crc) {
+        return AUSHAPE_SPOOL_OUTPUT_READ_DAMAGED;
+    }
+
+    *plen = sizeof(hdr) + hdr.data_len + events_len;
+    return AUSHAPE_SPOOL_OUTPUT_READ_OK;
+}
+
+/**
+ * Write the work record of a spooling output to the inner output.
+ * Called by the writer only.
+ *
+ * @param spool_output  The spooling output to write the record of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK   - written successfully,
+ *          other           - inner output failure.
+ */
+static enum aushape_rc
+aushape_spool_output_write_work(struct aushape_spool_output *spool_output)
+{
+    struct aushape_spool_output_rec *work = &spool_output->work;
+    const struct aushape_spool_output_rec_event *rec_event;
+    const struct aushape_spool_output_rec_event *rec_events_end;
+    struct aushape_output_event event;
+    enum aushape_rc rc;
+
+    assert(spool_output != NULL);
+
+    if (work->events.len > 0) {
+        rec_event = (const struct aushape_spool_output_rec_event *)
+                        work->events.ptr;
+        rec_events_end = (const struct aushape_spool_output_rec_event *)
+                            (work->events.ptr + work->events.len);
+        for (; rec_event < rec_events_end; rec_event++) {
+            event.serial = (unsigned long)rec_event->serial;
+            event.sec = (time_t)rec_event->sec;
+            event.msec = (unsigned int)rec_event->msec;
+            /* Descriptive fields are not spooled */
+            event.fields_len = 0;
+            AUSHAPE_GUARD(aushape_output_event(spool_output->inner, &event));
+        }
+    }
+    if (work->data.len > 0) {
+        AUSHAPE_GUARD(aushape_output_write(spool_output->inner,
+                                           work->data.ptr, work->data.len));
+    }
+    if (work->boundary) {
+        AUSHAPE_GUARD(aushape_output_sync(spool_output->inner, false));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Have the inner output of a spooling output confirm the records written
+ * to it from the oldest segment, by synchronizing it fully, with the mutex
+ * locked. Moves the synchronized offset up to the read offset on success,
+ * and the read offset back to the synchronized offset on failure, so the
+ * records are written again. Called by the writer only, unlocks the mutex
+ * while synchronizing.
+ *
+ * @param spool_output  The spooling output to confirm the records of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK   - confirmed successfully, or nothing to confirm,
+ *          other           - inner output failure.
+ */
+static enum aushape_rc
+aushape_spool_output_confirm(struct aushape_spool_output *spool_output)
+{
+    enum aushape_rc rc;
+    uint64_t seq;
+    uint64_t off;
+
+    assert(spool_output != NULL);
+
+    seq = spool_output->head_seq;
+    off = spool_output->read_off;
+    if (off == spool_output->synced_off) {
+        return AUSHAPE_RC_OK;
+    }
+    pthread_mutex_unlock(&spool_output->mutex);
+    rc = aushape_output_sync(spool_output->inner, true);
+    pthread_mutex_lock(&spool_output->mutex);
+    /* If the segment was dropped meanwhile, there is nothing to move */
+    if (spool_output->head_seq == seq) {
+        if (rc == AUSHAPE_RC_OK) {
+            spool_output->synced_off = off;
+        } else {
+            spool_output->read_off = spool_output->synced_off;
+        }
+    }
+    if (rc != AUSHAPE_RC_OK) {
+        spool_output->stats.failures++;
+    }
+    return rc;
+}
+
+/**
+ * Run the writer of a spooling output: write spooled records to the inner
+ * output in order, removing the segments written out and confirmed, and
+ * retrying failed writes after a delay, until stopped and out of records,
+ * or failing.
+ *
+ * @param arg   The spooling output to run the writer for.
+ *
+ * @return NULL.
+ */
+static void *
+aushape_spool_output_writer_run(void *arg)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)arg;
+    struct aushape_spool_output_stats *stats = &spool_output->stats;
+    enum aushape_spool_output_read read;
+    enum aushape_rc rc = AUSHAPE_RC_OK;
+    enum aushape_rc inner_rc;
+    char name[AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN + 1];
+    struct stat st;
+    int read_fd = -1;
+    uint64_t read_seq = 0;
+    uint64_t seq;
+    uint64_t off;
+    uint64_t end;
+    uint64_t len = 0;
+    bool empty;
+    bool failing = false;
+    bool dirty = false;
+    struct timespec checkpoint_time;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &checkpoint_time);
+    pthread_mutex_lock(&spool_output->mutex);
+    while (true) {
+        empty = spool_output->head_seq == spool_output->tail_seq &&
+                spool_output->read_off == spool_output->tail_len;
+
+        /* Confirm the written records and checkpoint them, if it's time */
+        deadline = checkpoint_time;
+        aushape_flusher_time_add(&deadline,
+                                 AUSHAPE_SPOOL_OUTPUT_CHECKPOINT_INTERVAL);
+        if (dirty && aushape_flusher_time_left(&deadline) == 0) {
+            if (aushape_spool_output_confirm(spool_output) !=
+                    AUSHAPE_RC_OK) {
+                clock_gettime(CLOCK_MONOTONIC, &checkpoint_time);
+                failing = true;
+                continue;
+            }
+            seq = spool_output->head_seq;
+            off = spool_output->synced_off;
+            pthread_mutex_unlock(&spool_output->mutex);
+            rc = aushape_spool_output_checkpoint(spool_output, seq, off);
+            clock_gettime(CLOCK_MONOTONIC, &checkpoint_time);
+            dirty = false;
+            pthread_mutex_lock(&spool_output->mutex);
+            if (rc != AUSHAPE_RC_OK) {
+                break;
+            }
+            continue;
+        }
+
+        /* Wait before retrying a failed write */
+        if (failing) {
+            if (spool_output->stop) {
+                break;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            aushape_flusher_time_add(&deadline, spool_output->retry);
+            while (!spool_output->stop &&
+                   aushape_flusher_time_left(&deadline) > 0) {
+                pthread_cond_timedwait(&spool_output->appended_cond,
+                                       &spool_output->mutex, &deadline);
+            }
+            failing = false;
+            continue;
+        }
+
+        if (empty) {
+            /* Fully synchronize the inner output, if requested */
+            if (spool_output->sync_req) {
+                spool_output->sync_req = false;
+                if (aushape_spool_output_confirm(spool_output) !=
+                        AUSHAPE_RC_OK) {
+                    failing = true;
+                }
+                continue;
+            }
+            if (spool_output->stop) {
+                break;
+            }
+            /* Wait for a record, or for the checkpoint time */
+            if (dirty) {
+                pthread_cond_timedwait(&spool_output->appended_cond,
+                                       &spool_output->mutex, &deadline);
+            } else {
+                pthread_cond_wait(&spool_output->appended_cond,
+                                  &spool_output->mutex);
+            }
+            continue;
+        }
+
+        /* Read and write the next record */
+        seq = spool_output->head_seq;
+        off = spool_output->read_off;
+        end = spool_output->tail_len;
+        if (seq != spool_output->tail_seq) {
+            end = UINT64_MAX;
+        }
+        pthread_mutex_unlock(&spool_output->mutex);
+
+        if (read_fd >= 0 && read_seq != seq) {
+            close(read_fd);
+            read_fd = -1;
+        }
+        if (read_fd < 0) {
+            read_fd = openat(spool_output->dir_fd,
+                             aushape_spool_output_seg_name(name, seq),
+                             O_RDONLY | O_CLOEXEC);
+            read_seq = seq;
+        }
+        if (read_fd < 0) {
+            /* Consider a missing segment written out */
+            read = errno == ENOENT && end == UINT64_MAX
+                        ? AUSHAPE_SPOOL_OUTPUT_READ_END
+                        : AUSHAPE_SPOOL_OUTPUT_READ_FAILED;
+            st.st_size = 0;
+        } else if (end == UINT64_MAX && fstat(read_fd, &st) < 0) {
+            read = AUSHAPE_SPOOL_OUTPUT_READ_FAILED;
+        } else {
+            if (end == UINT64_MAX) {
+                end = (uint64_t)st.st_size;
+            }
+            read = aushape_spool_output_read(spool_output, read_fd,
+                                             off, end, &len);
+        }
+        if (read == AUSHAPE_SPOOL_OUTPUT_READ_OK) {
+            inner_rc = aushape_spool_output_write_work(spool_output);
+        }
+
+        pthread_mutex_lock(&spool_output->mutex);
+        /* If the segment was dropped meanwhile, move on */
+        if (spool_output->head_seq != seq) {
+            continue;
+        }
+        switch (read) {
+        case AUSHAPE_SPOOL_OUTPUT_READ_OK:
+            if (inner_rc == AUSHAPE_RC_OK) {
+                spool_output->read_off += len;
+                stats->written++;
+                dirty = true;
+            } else {
+                /* Write again what the inner output could've lost */
+                spool_output->read_off = spool_output->synced_off;
+                stats->failures++;
+                failing = true;
+            }
+            break;
+        case AUSHAPE_SPOOL_OUTPUT_READ_DAMAGED:
+            /* Segments being appended to are never damaged */
+            if (seq == spool_output->tail_seq) {
+                rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+                goto exit;
+            }
+            stats->damaged++;
+            /* Fall through */
+        case AUSHAPE_SPOOL_OUTPUT_READ_END:
+            assert(seq != spool_output->tail_seq);
+            /* Don't remove the segment until its records are confirmed */
+            if (aushape_spool_output_confirm(spool_output) !=
+                    AUSHAPE_RC_OK) {
+                failing = true;
+                break;
+            }
+            if (spool_output->head_seq != seq) {
+                break;
+            }
+            if (read_fd >= 0) {
+                close(read_fd);
+                read_fd = -1;
+                if (unlinkat(spool_output->dir_fd,
+                             aushape_spool_output_seg_name(name, seq),
+                             0) < 0 && errno != ENOENT) {
+                    rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+                    goto exit;
+                }
+            }
+            spool_output->size -= (uint64_t)st.st_size <
+                                  spool_output->size
+                                        ? (uint64_t)st.st_size
+                                        : spool_output->size;
+            spool_output->head_seq++;
+            spool_output->read_off = 0;
+            spool_output->synced_off = 0;
+            dirty = true;
+            pthread_cond_broadcast(&spool_output->removed_cond);
+            break;
+        default:
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            goto exit;
+        }
+    }
+
+exit:
+    /* Have the records written last confirmed, to checkpoint them */
+    if (rc == AUSHAPE_RC_OK) {
+        aushape_spool_output_confirm(spool_output);
+    }
+    if (rc != AUSHAPE_RC_OK && spool_output->rc == AUSHAPE_RC_OK) {
+        spool_output->rc = rc;
+    }
+    seq = spool_output->head_seq;
+    off = spool_output->synced_off;
+    pthread_cond_broadcast(&spool_output->removed_cond);
+    pthread_mutex_unlock(&spool_output->mutex);
+
+    if (read_fd >= 0) {
+        close(read_fd);
+    }
+    /* Checkpoint the final position */
+    if (dirty && rc == AUSHAPE_RC_OK) {
+        rc = aushape_spool_output_checkpoint(spool_output, seq, off);
+        if (rc != AUSHAPE_RC_OK) {
+            pthread_mutex_lock(&spool_output->mutex);
+            if (spool_output->rc == AUSHAPE_RC_OK) {
+                spool_output->rc = rc;
+            }
+            pthread_mutex_unlock(&spool_output->mutex);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Start a new segment to append to, with the mutex locked.
+ * Called by the converting thread only.
+ *
+ * @param spool_output  The spooling output to start a segment for.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - started successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - creating the segment failed.
+ */
+static enum aushape_rc
+aushape_spool_output_roll(struct aushape_spool_output *spool_output)
+{
+    enum aushape_rc rc;
+    char name[AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN + 1];
+
+    assert(spool_output != NULL);
+    assert(spool_output->tail_fd >= 0);
+
+    /* Make the finished segment durable */
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                       fdatasync(spool_output->tail_fd) == 0);
+    close(spool_output->tail_fd);
+    spool_output->tail_fd = openat(spool_output->dir_fd,
+                                   aushape_spool_output_seg_name(
+                                        name, spool_output->tail_seq + 1),
+                                   O_WRONLY | O_CREAT | O_EXCL |
+                                   O_APPEND | O_CLOEXEC,
+                                   S_IRUSR | S_IWUSR);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, spool_output->tail_fd >= 0);
+    spool_output->tail_seq++;
+    spool_output->tail_len = 0;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Remove the oldest segment, with the mutex locked.
+ * Called by the converting thread only.
+ *
+ * @param spool_output  The spooling output to drop the segment of.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - dropped successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - removing the segment failed.
+ */
+static enum aushape_rc
+aushape_spool_output_drop_head(struct aushape_spool_output *spool_output)
+{
+    enum aushape_rc rc;
+    char name[AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN + 1];
+    struct stat st;
+    uint64_t size = 0;
+
+    assert(spool_output != NULL);
+    assert(spool_output->head_seq != spool_output->tail_seq);
+
+    aushape_spool_output_seg_name(name, spool_output->head_seq);
+    if (fstatat(spool_output->dir_fd, name, &st, 0) == 0) {
+        size = (uint64_t)st.st_size;
+        AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED,
+                           unlinkat(spool_output->dir_fd, name, 0) == 0 ||
+                           errno == ENOENT);
+    } else {
+        AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, errno == ENOENT);
+    }
+    if (size > spool_output->read_off) {
+        spool_output->stats.dropped += size - spool_output->read_off;
+    }
+    spool_output->size -= size < spool_output->size
+                                ? size : spool_output->size;
+    spool_output->head_seq++;
+    spool_output->read_off = 0;
+    spool_output->synced_off = 0;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Append the record being filled to the spool, applying the full spool
+ * policy, if needed.
+ *
+ * @param spool_output  The spooling output to append the record of.
+ * @param boundary      True if the record ends at a document boundary.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - appended, or dropped
+ *                                            successfully,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - writing the spool failed.
+ */
+static enum aushape_rc
+aushape_spool_output_append(struct aushape_spool_output *spool_output,
+                            bool boundary)
+{
+    enum aushape_rc rc;
+    struct aushape_spool_output_rec *fill = &spool_output->fill;
+    struct aushape_spool_output_stats *stats = &spool_output->stats;
+    struct aushape_spool_output_rec_hdr hdr;
+    struct iovec iov[3];
+    uint64_t len;
+    bool written;
+
+    assert(spool_output != NULL);
+
+    if (fill->data.len == 0 && fill->events.len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+
+    pthread_mutex_lock(&spool_output->mutex);
+    AUSHAPE_GUARD(spool_output->rc);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, fill->data.len <= UINT32_MAX);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = AUSHAPE_SPOOL_OUTPUT_REC_MAGIC;
+    hdr.flags = boundary ? AUSHAPE_SPOOL_OUTPUT_REC_BOUNDARY : 0;
+    hdr.data_len = (uint32_t)fill->data.len;
+    hdr.event_num = (uint32_t)(fill->events.len /
+                        sizeof(struct aushape_spool_output_rec_event));
+    hdr.crc = aushape_spool_output_rec_crc(&hdr, &fill->data, &fill->events);
+    len = sizeof(hdr) + fill->data.len + fill->events.len;
+
+    /* Make room, if needed */
+    if (spool_output->size + len > spool_output->max_size) {
+        stats->full++;
+        /* Let the writer remove the segment it's reading */
+        if (spool_output->head_seq == spool_output->tail_seq &&
+            spool_output->tail_len > 0) {
+            AUSHAPE_GUARD(aushape_spool_output_roll(spool_output));
+        }
+        switch (spool_output->policy) {
+        case AUSHAPE_SPOOL_OUTPUT_POLICY_BLOCK:
+            if (spool_output->size + len > spool_output->max_size &&
+                spool_output->head_seq != spool_output->tail_seq) {
+                stats->stalls++;
+                do {
+                    pthread_cond_wait(&spool_output->removed_cond,
+                                      &spool_output->mutex);
+                    AUSHAPE_GUARD(spool_output->rc);
+                } while (spool_output->size + len >
+                            spool_output->max_size &&
+                         spool_output->head_seq != spool_output->tail_seq);
+            }
+            break;
+        case AUSHAPE_SPOOL_OUTPUT_POLICY_DROP_NEWEST:
+            if (spool_output->size + len > spool_output->max_size &&
+                spool_output->head_seq != spool_output->tail_seq) {
+                stats->dropped += len;
+                rc = AUSHAPE_RC_OK;
+                goto cleanup;
+            }
+            break;
+        case AUSHAPE_SPOOL_OUTPUT_POLICY_DROP_OLDEST:
+            while (spool_output->size + len > spool_output->max_size &&
+                   spool_output->head_seq != spool_output->tail_seq) {
+                AUSHAPE_GUARD(aushape_spool_output_drop_head(spool_output));
+            }
+            break;
+        default:
+            assert(false);
+            rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+            goto cleanup;
+        }
+    }
+    if (spool_output->tail_len > 0 &&
+        spool_output->tail_len + len > spool_output->segment_size) {
+        AUSHAPE_GUARD(aushape_spool_output_roll(spool_output));
+    }
+
+    /* Append the record, letting the writer read meanwhile */
+    pthread_mutex_unlock(&spool_output->mutex);
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = fill->data.ptr;
+    iov[1].iov_len = fill->data.len;
+    iov[2].iov_base = fill->events.ptr;
+    iov[2].iov_len = fill->events.len;
+    written = aushape_spool_output_writev(spool_output->tail_fd, iov, 3);
+    pthread_mutex_lock(&spool_output->mutex);
+    AUSHAPE_GUARD_BOOL(OUTPUT_WRITE_FAILED, written);
+    spool_output->tail_len += len;
+    spool_output->size += len;
+    pthread_cond_signal(&spool_output->appended_cond);
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_spool_output_rec_empty(fill);
+    if (spool_output->rc == AUSHAPE_RC_OK) {
+        spool_output->rc = rc;
+    }
+    pthread_mutex_unlock(&spool_output->mutex);
+    return rc;
+}
+
+static void aushape_spool_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_spool_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)output;
+    struct aushape_output *inner = va_arg(ap, struct aushape_output *);
+    bool inner_owned = (bool)va_arg(ap, int);
+    const char *dir = va_arg(ap, const char *);
+    uint64_t max_size = va_arg(ap, uint64_t);
+    uint64_t segment_size = va_arg(ap, uint64_t);
+    unsigned int retry = va_arg(ap, unsigned int);
+    enum aushape_spool_output_policy policy =
+                        (enum aushape_spool_output_policy)va_arg(ap, int);
+    pthread_condattr_t condattr;
+    char name[AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN + 1];
+    enum aushape_rc rc;
+
+    assert(spool_output != NULL);
+
+    if (!aushape_output_is_valid(inner) ||
+        aushape_output_is_cont(inner) != output->type->cont ||
+        dir == NULL ||
+        segment_size == 0 || segment_size > max_size / 2 ||
+        !aushape_spool_output_policy_is_valid(policy)) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    spool_output->dir_fd = -1;
+    spool_output->tail_fd = -1;
+    spool_output->max_size = max_size;
+    spool_output->segment_size = segment_size;
+    spool_output->retry = retry;
+    spool_output->policy = policy;
+    aushape_spool_output_rec_init(&spool_output->fill);
+    aushape_spool_output_rec_init(&spool_output->work);
+
+    /* Open and lock the spool */
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       mkdir(dir, S_IRWXU) == 0 || errno == EEXIST);
+    spool_output->dir_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, spool_output->dir_fd >= 0);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       flock(spool_output->dir_fd, LOCK_EX | LOCK_NB) == 0);
+    AUSHAPE_GUARD(aushape_spool_output_load(spool_output));
+    spool_output->tail_fd = openat(spool_output->dir_fd,
+                                   aushape_spool_output_seg_name(
+                                        name, spool_output->tail_seq),
+                                   O_WRONLY | O_CREAT | O_EXCL |
+                                   O_APPEND | O_CLOEXEC,
+                                   S_IRUSR | S_IWUSR);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED, spool_output->tail_fd >= 0);
+
+    /* Start the writer */
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_mutex_init(&spool_output->mutex, NULL) == 0);
+    if (pthread_condattr_init(&condattr) != 0) {
+        pthread_mutex_destroy(&spool_output->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    if (pthread_condattr_setclock(&condattr, CLOCK_MONOTONIC) != 0 ||
+        pthread_cond_init(&spool_output->appended_cond, &condattr) != 0) {
+        pthread_condattr_destroy(&condattr);
+        pthread_mutex_destroy(&spool_output->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    pthread_condattr_destroy(&condattr);
+    if (pthread_cond_init(&spool_output->removed_cond, NULL) != 0) {
+        pthread_cond_destroy(&spool_output->appended_cond);
+        pthread_mutex_destroy(&spool_output->mutex);
+        rc = AUSHAPE_RC_OUTPUT_INIT_FAILED;
+        goto cleanup;
+    }
+    spool_output->sync_init = true;
+    spool_output->inner = inner;
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       pthread_create(&spool_output->writer, NULL,
+                                      aushape_spool_output_writer_run,
+                                      spool_output) == 0);
+    spool_output->writer_run = true;
+
+    spool_output->inner_owned = inner_owned;
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_spool_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_spool_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)output;
+    assert(spool_output != NULL);
+
+    /* The inner output is used by the writer, don't look inside */
+    return spool_output->inner != NULL &&
+           aushape_spool_output_policy_is_valid(spool_output->policy) &&
+           spool_output->segment_size > 0 &&
+           spool_output->segment_size <= spool_output->max_size / 2 &&
+           spool_output->dir_fd >= 0 &&
+           spool_output->tail_fd >= 0 &&
+           spool_output->writer_run &&
+           aushape_gbuf_is_valid(&spool_output->fill.data) &&
+           aushape_gbuf_is_valid(&spool_output->fill.events);
+}
+
+static enum aushape_rc
+aushape_spool_output_write(struct aushape_output *output,
+                           const char *ptr,
+                           size_t len)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)output;
+    enum aushape_rc rc;
+
+    assert(spool_output != NULL);
+
+    if (len == 0) {
+        return AUSHAPE_RC_OK;
+    }
+    rc = aushape_gbuf_add_buf(&spool_output->fill.data, ptr, len);
+    if (rc != AUSHAPE_RC_OK) {
+        return rc;
+    }
+    /* Discrete outputs get complete documents with every write */
+    if (!output->type->cont) {
+        return aushape_spool_output_append(spool_output, true);
+    } else if (spool_output->fill.data.len >=
+               AUSHAPE_SPOOL_OUTPUT_REC_SIZE) {
+        return aushape_spool_output_append(spool_output, false);
+    }
+    return AUSHAPE_RC_OK;
+}
+
+static enum aushape_rc
+aushape_spool_output_event(struct aushape_output *output,
+                           const struct aushape_output_event *event)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)output;
+    struct aushape_spool_output_rec_event rec_event;
+
+    assert(spool_output != NULL);
+    assert(event != NULL);
+
+    memset(&rec_event, 0, sizeof(rec_event));
+    rec_event.serial = event->serial;
+    rec_event.sec = (int64_t)event->sec;
+    rec_event.msec = event->msec;
+    return aushape_gbuf_add_buf(&spool_output->fill.events,
+                                &rec_event, sizeof(rec_event));
+}
+
+static enum aushape_rc
+aushape_spool_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)output;
+    enum aushape_rc rc;
+
+    assert(spool_output != NULL);
+
+    rc = aushape_spool_output_append(spool_output, true);
+    if (rc != AUSHAPE_RC_OK || !full) {
+        return rc;
+    }
+
+    /* Make the spool durable, and request the inner output sync */
+    if (fdatasync(spool_output->tail_fd) < 0) {
+        rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+    }
+    pthread_mutex_lock(&spool_output->mutex);
+    if (rc == AUSHAPE_RC_OK) {
+        spool_output->sync_req = true;
+        pthread_cond_signal(&spool_output->appended_cond);
+    } else if (spool_output->rc == AUSHAPE_RC_OK) {
+        spool_output->rc = rc;
+    }
+    pthread_mutex_unlock(&spool_output->mutex);
+    return rc;
+}
+
+static void
+aushape_spool_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)output;
+    char name[AUSHAPE_SPOOL_OUTPUT_SEG_NAME_LEN + 1];
+
+    assert(spool_output != NULL);
+
+    /* Try to append the remaining output, and let the writer finish */
+    if (spool_output->writer_run) {
+        if (aushape_spool_output_append(spool_output, true) ==
+                AUSHAPE_RC_OK) {
+            fdatasync(spool_output->tail_fd);
+        }
+        pthread_mutex_lock(&spool_output->mutex);
+        spool_output->stop = true;
+        pthread_cond_signal(&spool_output->appended_cond);
+        pthread_mutex_unlock(&spool_output->mutex);
+        pthread_join(spool_output->writer, NULL);
+        spool_output->writer_run = false;
+    }
+
+    if (spool_output->sync_init) {
+        pthread_cond_destroy(&spool_output->removed_cond);
+        pthread_cond_destroy(&spool_output->appended_cond);
+        pthread_mutex_destroy(&spool_output->mutex);
+        spool_output->sync_init = false;
+    }
+
+    /* Remove the last segment, if empty or written out and confirmed */
+    if (spool_output->tail_fd >= 0) {
+        close(spool_output->tail_fd);
+        spool_output->tail_fd = -1;
+        if (spool_output->tail_len == 0 ||
+            (spool_output->head_seq == spool_output->tail_seq &&
+             spool_output->synced_off == spool_output->tail_len)) {
+            unlinkat(spool_output->dir_fd,
+                     aushape_spool_output_seg_name(name,
+                                                   spool_output->tail_seq),
+                     0);
+        }
+    }
+    /* Close the spool, releasing the lock */
+    if (spool_output->dir_fd >= 0) {
+        close(spool_output->dir_fd);
+        spool_output->dir_fd = -1;
+    }
+
+    aushape_spool_output_rec_cleanup(&spool_output->fill);
+    aushape_spool_output_rec_cleanup(&spool_output->work);
+
+    if (spool_output->inner_owned) {
+        aushape_output_destroy(spool_output->inner);
+        spool_output->inner = NULL;
+        spool_output->inner_owned = false;
+    }
+}
+
+enum aushape_rc
+aushape_spool_output_get_stats(const struct aushape_output *output,
+                               struct aushape_spool_output_stats *pstats)
+{
+    struct aushape_spool_output *spool_output =
+                                    (struct aushape_spool_output *)output;
+
+    if (!aushape_output_is_valid(output) ||
+        (output->type != &aushape_spool_output_type &&
+         output->type != &aushape_spool_disc_output_type) ||
+        pstats == NULL) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    pthread_mutex_lock(&spool_output->mutex);
+    *pstats = spool_output->stats;
+    pstats->size = spool_output->size;
+    pstats->segments = spool_output->tail_seq - spool_output->head_seq + 1;
+    pthread_mutex_unlock(&spool_output->mutex);
+
+    return AUSHAPE_RC_OK;
+}
+
+const struct aushape_output_type aushape_spool_output_type = {
+    .size       = sizeof(struct aushape_spool_output),
+    .cont       = true,
+    .init       = aushape_spool_output_init,
+    .is_valid   = aushape_spool_output_is_valid,
+    .write      = aushape_spool_output_write,
+    .sync       = aushape_spool_output_sync,
+    .event      = aushape_spool_output_event,
+    .cleanup    = aushape_spool_output_cleanup,
+};
+
+const struct aushape_output_type aushape_spool_disc_output_type = {
+    .size       = sizeof(struct aushape_spool_output),
+    .cont       = false,
+    .init       = aushape_spool_output_init,
+    .is_valid   = aushape_spool_output_is_valid,
+    .write      = aushape_spool_output_write,
+    .sync       = aushape_spool_output_sync,
+    .event      = aushape_spool_output_event,
+    .cleanup    = aushape_spool_output_cleanup,
+};
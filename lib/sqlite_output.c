@@ -0,0 +1,547 @@
+/*
+ * SQLite discrete aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/sqlite_output.h>
+#ifdef HAVE_SQLITE
+#include <aushape/guard.h>
+#include <aushape/flusher.h>
+#include <sqlite3.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+/** Time to wait for other connections to release the database, ms */
+#define AUSHAPE_SQLITE_OUTPUT_BUSY_TIMEOUT  10000
+
+/**
+ * Statements setting up the database. An event is identified by its node,
+ * serial and time, the unique key also serving lookups by node. The rest of
+ * the indexes are created after the bulk of the events is inserted.
+ */
+static const char *aushape_sqlite_output_sql_schema =
+    "PRAGMA journal_mode = WAL;\n"
+    "PRAGMA synchronous = NORMAL;\n"
+    "CREATE TABLE IF NOT EXISTS event (\n"
+    "    id INTEGER PRIMARY KEY,\n"
+    "    serial INTEGER,\n"
+    "    time REAL,\n"
+    "    node TEXT NOT NULL,\n"
+    "    key TEXT,\n"
+    "    json TEXT NOT NULL,\n"
+    "    UNIQUE (node, serial, time)\n"
+    ");\n"
+    "CREATE TABLE IF NOT EXISTS record (\n"
+    "    event INTEGER NOT NULL REFERENCES event (id),\n"
+    "    type TEXT NOT NULL,\n"
+    "    json TEXT NOT NULL\n"
+    ");\n";
+
+/** Statements creating the secondary indexes */
+static const char *aushape_sqlite_output_sql_index =
+    "CREATE INDEX IF NOT EXISTS event_time ON event (time);\n"
+    "CREATE INDEX IF NOT EXISTS event_serial ON event (serial);\n"
+    "CREATE INDEX IF NOT EXISTS event_key ON event (key);\n"
+    "CREATE INDEX IF NOT EXISTS record_event ON record (event);\n"
+    "CREATE INDEX IF NOT EXISTS record_type ON record (type);\n";
+
+/**
+ * Statement inserting an event, unless it's in the database already.
+ * A missing node is stored empty, as NULLs never conflict.
+ */
+static const char *aushape_sqlite_output_sql_event =
+    "INSERT OR IGNORE INTO event (serial, time, node, key, json) "
+    "VALUES (?, ?, IFNULL(?, ''), ?, ?)";
+
+/**
+ * Statement inserting the records of an event, taking the event row ID,
+ * and the event JSON. Records of the same type come in arrays.
+ */
+static const char *aushape_sqlite_output_sql_records =
+    "INSERT INTO record (event, type, json) "
+    "SELECT ?1, d.key, IFNULL(a.value, d.value) "
+    "FROM json_each(?2, '$.data') AS d "
+    "LEFT JOIN json_each(CASE d.type WHEN 'array' THEN d.value END) AS a";
+
+/** SQLite output data */
+struct aushape_sqlite_output {
+    struct aushape_output output;   /**< Abstract output instance */
+    sqlite3 *db;                    /**< Database connection */
+    sqlite3_stmt *begin;            /**< Transaction start statement */
+    sqlite3_stmt *commit;           /**< Transaction commit statement */
+    sqlite3_stmt *event;            /**< Event insertion statement */
+    sqlite3_stmt *records;          /**< Records insertion statement */
+    /** Last event notification, valid if last_event_set is true */
+    struct aushape_output_event last_event;
+    bool last_event_set;            /**< True if last_event is valid */
+    size_t batch_size;              /**< Number of events in a transaction */
+    bool txn;                       /**< True if a transaction is open */
+    size_t txn_events;              /**< Events in the open transaction */
+    /** Monotonic time the open transaction started at */
+    struct timespec txn_time;
+    bool indexed;                   /**< True if the indexes are created */
+    unsigned int max_latency;       /**< Max transaction time, ms, or 0 */
+    /** Flusher committing the transaction after the maximum latency */
+    struct aushape_flusher flusher;
+    /** First database failure return code, or OK */
+    enum aushape_rc rc;
+};
+
+/**
+ * Execute a prepared statement of an SQLite output to completion, and
+ * reset it.
+ *
+ * @param stmt  The statement to execute.
+ *
+ * @return True if executed successfully, false otherwise.
+ */
+static bool
+aushape_sqlite_output_step(sqlite3_stmt *stmt)
+{
+    int rc;
+
+    assert(stmt != NULL);
+    rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    return rc == SQLITE_DONE;
+}
+
+/**
+ * Commit the open transaction of an SQLite output, if any, unless it
+ * failed already. Record the failure.
+ *
+ * @param sqlite_output The output to commit the transaction of.
+ *
+ * @return The output return code.
+ */
+static enum aushape_rc
+aushape_sqlite_output_commit(struct aushape_sqlite_output *sqlite_output)
+{
+    assert(sqlite_output != NULL);
+
+    if (sqlite_output->rc == AUSHAPE_RC_OK && sqlite_output->txn) {
+        if (aushape_sqlite_output_step(sqlite_output->commit)) {
+            sqlite_output->txn = false;
+            sqlite_output->txn_events = 0;
+        } else {
+            sqlite_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+    }
+    return sqlite_output->rc;
+}
+
+/**
+ * Commit the open transaction of an SQLite output, if any, and create the
+ * secondary indexes, if not created yet. Indexing the bulk of the events at
+ * once is faster than updating the indexes on every insert.
+ *
+ * @param sqlite_output The output to commit and index.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK                   - committed and indexed,
+ *          AUSHAPE_RC_OUTPUT_WRITE_FAILED  - failed committing or indexing,
+ *                                            now or before.
+ */
+static enum aushape_rc
+aushape_sqlite_output_index(struct aushape_sqlite_output *sqlite_output)
+{
+    assert(sqlite_output != NULL);
+
+    if (aushape_sqlite_output_commit(sqlite_output) == AUSHAPE_RC_OK &&
+        !sqlite_output->indexed) {
+        if (sqlite3_exec(sqlite_output->db,
+                         aushape_sqlite_output_sql_index,
+                         NULL, NULL, NULL) == SQLITE_OK) {
+            sqlite_output->indexed = true;
+        } else {
+            sqlite_output->rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+        }
+    }
+    return sqlite_output->rc;
+}
+
+/**
+ * Get the time an SQLite output's transaction is due to be committed at
+ * by the flusher: once it is open for the maximum latency.
+ *
+ * @param data      The SQLite output to get the flush time of.
+ * @param pdeadline Location for the flush time.
+ *
+ * @return True if a flush is pending, false otherwise.
+ */
+static bool
+aushape_sqlite_output_flusher_due(void *data, struct timespec *pdeadline)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)data;
+
+    assert(sqlite_output != NULL);
+    assert(pdeadline != NULL);
+
+    if (!sqlite_output->txn || sqlite_output->rc != AUSHAPE_RC_OK) {
+        return false;
+    }
+    *pdeadline = sqlite_output->txn_time;
+    aushape_flusher_time_add(pdeadline, sqlite_output->max_latency);
+    return true;
+}
+
+/**
+ * Flush an SQLite output from the flusher: commit the open transaction.
+ *
+ * @param data  The SQLite output to flush.
+ * @param now   The current monotonic time.
+ */
+static void
+aushape_sqlite_output_flusher_flush(void *data, const struct timespec *now)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)data;
+
+    assert(sqlite_output != NULL);
+    assert(now != NULL);
+    (void)now;
+
+    aushape_sqlite_output_commit(sqlite_output);
+}
+
+static void aushape_sqlite_output_cleanup(struct aushape_output *output);
+
+static enum aushape_rc
+aushape_sqlite_output_init(struct aushape_output *output, va_list ap)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)output;
+    const char *path = va_arg(ap, const char *);
+    size_t batch_size = va_arg(ap, size_t);
+    unsigned int max_latency = va_arg(ap, unsigned int);
+    enum aushape_rc rc;
+
+    assert(sqlite_output != NULL);
+
+    if (path == NULL || batch_size == 0) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    sqlite_output->batch_size = batch_size;
+    sqlite_output->rc = AUSHAPE_RC_OK;
+    /* Take the event node and key for the columns */
+    output->event_fields = true;
+
+    /* Open and set up the database, the flusher locks the connection */
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       sqlite3_open_v2(path, &sqlite_output->db,
+                                       SQLITE_OPEN_READWRITE |
+                                       SQLITE_OPEN_CREATE |
+                                       SQLITE_OPEN_NOMUTEX,
+                                       NULL) == SQLITE_OK);
+    sqlite3_busy_timeout(sqlite_output->db,
+                         AUSHAPE_SQLITE_OUTPUT_BUSY_TIMEOUT);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       sqlite3_exec(sqlite_output->db,
+                                    aushape_sqlite_output_sql_schema,
+                                    NULL, NULL, NULL) == SQLITE_OK);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       sqlite3_prepare_v2(sqlite_output->db, "BEGIN", -1,
+                                          &sqlite_output->begin,
+                                          NULL) == SQLITE_OK);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       sqlite3_prepare_v2(sqlite_output->db, "COMMIT", -1,
+                                          &sqlite_output->commit,
+                                          NULL) == SQLITE_OK);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       sqlite3_prepare_v2(sqlite_output->db,
+                                          aushape_sqlite_output_sql_event,
+                                          -1, &sqlite_output->event,
+                                          NULL) == SQLITE_OK);
+    AUSHAPE_GUARD_BOOL(OUTPUT_INIT_FAILED,
+                       sqlite3_prepare_v2(sqlite_output->db,
+                                          aushape_sqlite_output_sql_records,
+                                          -1, &sqlite_output->records,
+                                          NULL) == SQLITE_OK);
+
+    /* Start the flusher, if the transaction time is limited */
+    if (max_latency > 0) {
+        sqlite_output->max_latency = max_latency;
+        AUSHAPE_GUARD(aushape_flusher_start(
+                                    &sqlite_output->flusher,
+                                    aushape_sqlite_output_flusher_due,
+                                    aushape_sqlite_output_flusher_flush,
+                                    sqlite_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    if (rc != AUSHAPE_RC_OK) {
+        aushape_sqlite_output_cleanup(output);
+    }
+    return rc;
+}
+
+static bool
+aushape_sqlite_output_is_valid(const struct aushape_output *output)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)output;
+    assert(sqlite_output != NULL);
+
+    return sqlite_output->db != NULL &&
+           sqlite_output->begin != NULL &&
+           sqlite_output->commit != NULL &&
+           sqlite_output->event != NULL &&
+           sqlite_output->records != NULL &&
+           sqlite_output->batch_size > 0 &&
+           (sqlite_output->max_latency == 0 ||
+            aushape_flusher_is_started(&sqlite_output->flusher));
+}
+
+static void
+aushape_sqlite_output_cleanup(struct aushape_output *output)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)output;
+    assert(sqlite_output != NULL);
+
+    /* Stop the flusher */
+    aushape_flusher_stop(&sqlite_output->flusher);
+
+    /*
+     * Commit what's inserted and index it, if not done yet,
+     * a failed transaction is rolled back
+     */
+    aushape_sqlite_output_index(sqlite_output);
+    sqlite3_finalize(sqlite_output->records);
+    sqlite_output->records = NULL;
+    sqlite3_finalize(sqlite_output->event);
+    sqlite_output->event = NULL;
+    sqlite3_finalize(sqlite_output->commit);
+    sqlite_output->commit = NULL;
+    sqlite3_finalize(sqlite_output->begin);
+    sqlite_output->begin = NULL;
+    sqlite3_close(sqlite_output->db);
+    sqlite_output->db = NULL;
+}
+
+static enum aushape_rc
+aushape_sqlite_output_event(struct aushape_output *output,
+                            const struct aushape_output_event *event)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)output;
+
+    assert(sqlite_output != NULL);
+    assert(event != NULL);
+
+    /* The event isn't shared with the flusher, no need to lock */
+    memcpy(&sqlite_output->last_event, event, sizeof(*event));
+    sqlite_output->last_event_set = true;
+    return AUSHAPE_RC_OK;
+}
+
+/**
+ * Bind a field of the last event notification of an SQLite output to a
+ * statement parameter, if the event has it.
+ *
+ * @param sqlite_output The output to bind the event field of.
+ * @param stmt          The statement to bind the field to.
+ * @param idx           The index of the parameter to bind the field to.
+ * @param name          The name of the field, with the "=" appended.
+ *
+ * @return SQLite return code.
+ */
+static int
+aushape_sqlite_output_bind_field(struct aushape_sqlite_output *sqlite_output,
+                                 sqlite3_stmt *stmt, int idx,
+                                 const char *name)
+{
+    const struct aushape_output_event *event = &sqlite_output->last_event;
+    size_t name_len = strlen(name);
+    size_t i;
+
+    if (sqlite_output->last_event_set) {
+        for (i = 0; i < event->fields_len;
+             i += strlen(event->fields + i) + 1) {
+            if (strncmp(event->fields + i, name, name_len) == 0) {
+                return sqlite3_bind_text(stmt, idx,
+                                         event->fields + i + name_len, -1,
+                                         SQLITE_STATIC);
+            }
+        }
+    }
+    return SQLITE_OK;
+}
+
+static enum aushape_rc
+aushape_sqlite_output_write(struct aushape_output *output,
+                            const char *ptr,
+                            size_t len)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)output;
+    const struct aushape_output_event *event = &sqlite_output->last_event;
+    sqlite3_stmt *stmt;
+    enum aushape_rc rc;
+
+    assert(sqlite_output != NULL);
+
+    /* Don't store the newline of NDJSON */
+    if (len > 0 && ptr[len - 1] == '\n') {
+        len--;
+    }
+    if (len == 0 || len > INT32_MAX) {
+        return AUSHAPE_RC_INVALID_ARGS;
+    }
+
+    aushape_flusher_lock(&sqlite_output->flusher);
+    AUSHAPE_GUARD(sqlite_output->rc);
+    rc = AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+
+    /* Start a transaction */
+    if (!sqlite_output->txn) {
+        if (!aushape_sqlite_output_step(sqlite_output->begin)) {
+            sqlite_output->rc = rc;
+            goto cleanup;
+        }
+        sqlite_output->txn = true;
+        if (aushape_flusher_is_started(&sqlite_output->flusher)) {
+            clock_gettime(CLOCK_MONOTONIC, &sqlite_output->txn_time);
+            aushape_flusher_signal(&sqlite_output->flusher);
+        }
+    }
+
+    /* Insert the event, unbound parameters are NULL */
+    stmt = sqlite_output->event;
+    if ((sqlite_output->last_event_set &&
+         (sqlite3_bind_int64(stmt, 1,
+                             (sqlite3_int64)event->serial) != SQLITE_OK ||
+          sqlite3_bind_double(stmt, 2,
+                              (double)event->sec +
+                              event->msec / 1000.0) != SQLITE_OK)) ||
+        aushape_sqlite_output_bind_field(sqlite_output, stmt, 3,
+                                         "node=") != SQLITE_OK ||
+        aushape_sqlite_output_bind_field(sqlite_output, stmt, 4,
+                                         "key=") != SQLITE_OK ||
+        sqlite3_bind_text(stmt, 5, ptr, (int)len,
+                          SQLITE_STATIC) != SQLITE_OK ||
+        !aushape_sqlite_output_step(stmt)) {
+        sqlite3_clear_bindings(stmt);
+        sqlite_output->rc = rc;
+        goto cleanup;
+    }
+    sqlite3_clear_bindings(stmt);
+    sqlite_output->last_event_set = false;
+
+    /* Insert its records, unless the event was a duplicate */
+    stmt = sqlite_output->records;
+    if (sqlite3_changes(sqlite_output->db) > 0 &&
+        (sqlite3_bind_int64(stmt, 1,
+                            sqlite3_last_insert_rowid(sqlite_output->db)) !=
+            SQLITE_OK ||
+         sqlite3_bind_text(stmt, 2, ptr, (int)len,
+                           SQLITE_STATIC) != SQLITE_OK ||
+         !aushape_sqlite_output_step(stmt))) {
+        sqlite3_clear_bindings(stmt);
+        sqlite_output->rc = rc;
+        goto cleanup;
+    }
+    sqlite3_clear_bindings(stmt);
+
+    /* Commit a full batch */
+    sqlite_output->txn_events++;
+    if (sqlite_output->txn_events >= sqlite_output->batch_size) {
+        AUSHAPE_GUARD(aushape_sqlite_output_commit(sqlite_output));
+    }
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    aushape_flusher_unlock(&sqlite_output->flusher);
+    return rc;
+}
+
+static enum aushape_rc
+aushape_sqlite_output_sync(struct aushape_output *output, bool full)
+{
+    struct aushape_sqlite_output *sqlite_output =
+                                    (struct aushape_sqlite_output *)output;
+    enum aushape_rc rc;
+
+    assert(sqlite_output != NULL);
+
+    aushape_flusher_lock(&sqlite_output->flusher);
+    /* Keep the batch open, unless flushed explicitly */
+    rc = full ? aushape_sqlite_output_index(sqlite_output)
+              : sqlite_output->rc;
+    aushape_flusher_unlock(&sqlite_output->flusher);
+    return rc;
+}
+
+bool
+aushape_sqlite_output_is_available(void)
+{
+    return true;
+}
+
+const struct aushape_output_type aushape_sqlite_output_type = {
+    .size       = sizeof(struct aushape_sqlite_output),
+    .cont       = false,
+    .init       = aushape_sqlite_output_init,
+    .is_valid   = aushape_sqlite_output_is_valid,
+    .write      = aushape_sqlite_output_write,
+    .sync       = aushape_sqlite_output_sync,
+    .event      = aushape_sqlite_output_event,
+    .cleanup    = aushape_sqlite_output_cleanup,
+};
+
+#else /* ! HAVE_SQLITE */
+
+static enum aushape_rc
+aushape_sqlite_output_init(struct aushape_output *output, va_list ap)
+{
+    (void)output;
+    (void)ap;
+    return AUSHAPE_RC_OUTPUT_INIT_FAILED;
+}
+
+static enum aushape_rc
+aushape_sqlite_output_write(struct aushape_output *output,
+                            const char *ptr,
+                            size_t len)
+{
+    (void)output;
+    (void)ptr;
+    (void)len;
+    return AUSHAPE_RC_OUTPUT_WRITE_FAILED;
+}
+
+bool
+aushape_sqlite_output_is_available(void)
+{
+    return false;
+}
+
+const struct aushape_output_type aushape_sqlite_output_type = {
+    .size       = sizeof(struct aushape_output),
+    .cont       = false,
+    .init       = aushape_sqlite_output_init,
+    .write      = aushape_sqlite_output_write,
+};
+
+#endif /* HAVE_SQLITE */
@@ -20,8 +20,6 @@
 
 #include <aushape/uniq_coll.h>
 #include <aushape/coll.h>
-#include <aushape/record.h>
-#include <aushape/auparse.h>
 #include <aushape/guard.h>
 #include <string.h>
 
@@ -47,7 +45,8 @@ aushape_uniq_coll_init(struct aushape_coll *coll,
     struct aushape_uniq_coll *uniq_coll =
                     (struct aushape_uniq_coll *)coll;
     (void)args;
-    aushape_gbuf_init(&uniq_coll->seen, 4096);
+    aushape_gbuf_init(&uniq_coll->seen, 4096,
+                      aushape_itree_pool_get_mem(coll->itree->pool));
     return AUSHAPE_RC_OK;
 }
 
@@ -59,6 +58,23 @@ aushape_uniq_coll_cleanup(struct aushape_coll *coll)
     aushape_gbuf_cleanup(&uniq_coll->seen);
 }
 
+static void
+aushape_uniq_coll_shrink(struct aushape_coll *coll)
+{
+    struct aushape_uniq_coll *uniq_coll =
+                    (struct aushape_uniq_coll *)coll;
+    aushape_gbuf_shrink(&uniq_coll->seen);
+}
+
+static void
+aushape_uniq_coll_get_mem_usage(const struct aushape_coll *coll,
+                                struct aushape_mem_usage *usage)
+{
+    const struct aushape_uniq_coll *uniq_coll =
+                    (const struct aushape_uniq_coll *)coll;
+    aushape_gbuf_get_mem_usage(&uniq_coll->seen, usage);
+}
+
 static bool
 aushape_uniq_coll_is_empty(const struct aushape_coll *coll)
 {
@@ -135,32 +151,28 @@ aushape_uniq_coll_seen_add(struct aushape_coll *coll,
 static enum aushape_rc
 aushape_uniq_coll_add(struct aushape_coll *coll,
                       size_t *pcount,
-                      size_t level,
                       size_t prio,
-                      auparse_state_t *au)
+                      const struct aushape_itree_node *record)
 {
     enum aushape_rc rc;
     const char *name;
+    struct aushape_itree_node node;
 
     assert(aushape_coll_is_valid(coll));
     assert(pcount != NULL);
-    assert(au != NULL);
+    assert(record != NULL);
 
-    name = aushape_auparse_get_type_name(au);
-    AUSHAPE_GUARD_BOOL(AUPARSE_FAILED, name != NULL);
+    name = aushape_itree_pool_get_str(coll->itree->pool, record->name);
     if (aushape_uniq_coll_seen_has(coll, name)) {
         rc = AUSHAPE_RC_REPEATED_RECORD;
         goto cleanup;
     } else {
         AUSHAPE_GUARD(aushape_uniq_coll_seen_add(coll, name));
     }
-    rc = aushape_record_format(&coll->gbtree->text,
-                               &coll->format, level, *pcount == 0, name, au);
-    if (rc != AUSHAPE_RC_OK) {
-        assert(rc != AUSHAPE_RC_INVALID_ARGS);
-        goto cleanup;
-    }
-    AUSHAPE_GUARD(aushape_gbtree_node_add_text(coll->gbtree, prio));
+    node = *record;
+    node.prio = prio;
+    node.def = aushape_record_def_lookup(name);
+    AUSHAPE_GUARD(aushape_itree_node_add(coll->itree, &node));
     (*pcount)++;
     rc = AUSHAPE_RC_OK;
 cleanup:
@@ -175,4 +187,6 @@ const struct aushape_coll_type aushape_uniq_coll_type = {
     .is_empty   = aushape_uniq_coll_is_empty,
     .empty      = aushape_uniq_coll_empty,
     .add        = aushape_uniq_coll_add,
+    .shrink     = aushape_uniq_coll_shrink,
+    .get_mem_usage = aushape_uniq_coll_get_mem_usage,
 };
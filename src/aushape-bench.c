@@ -0,0 +1,419 @@
+/*
+ * Benchmark rendering and trimming of a large event buffer tree.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/gbtree.h>
+#include <aushape/gbuf.h>
+#include <aushape/guard.h>
+#include <getopt.h>
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+static const char *cmd_help =
+   "Usage: aushape-bench [OPTION]...\n"
+   "Benchmark rendering and trimming of a large SYSCALL/EXECVE event\n"
+   "buffer tree, shaped the way the converter builds it for JSON.\n"
+   "\n"
+   "Options:\n"
+   "    -h, --help              Output this help message and exit.\n"
+   "    -v, --version           Output version information and exit.\n"
+   "    -a, --args=NUM          Put NUM arguments into the EXECVE record.\n"
+   "                            Default: 4096\n"
+   "    -l, --arg-len=NUM       Make each argument NUM bytes long.\n"
+   "                            Default: 32\n"
+   "    -t, --trim=PERCENT      Trim the event to PERCENT of its length.\n"
+   "                            Default: 33\n"
+   "    -n, --iterations=NUM    Repeat each measurement NUM times.\n"
+   "                            Default: 100\n";
+
+/** SYSCALL record fields: name, value and priority */
+static const struct {
+    const char *name;
+    const char *value;
+    size_t      prio;
+} syscall_field_list[] = {
+    {"arch",    "c000003e",             1},
+    {"syscall", "59",                   1},
+    {"success", "yes",                  1},
+    {"exit",    "0",                    1},
+    {"a0",      "55b0a3e1c2a0",         3},
+    {"a1",      "55b0a3e1c3f0",         3},
+    {"a2",      "55b0a3e1c410",         3},
+    {"a3",      "8",                    3},
+    {"items",   "2",                    2},
+    {"ppid",    "1234",                 2},
+    {"pid",     "5678",                 1},
+    {"auid",    "1000",                 1},
+    {"uid",     "1000",                 1},
+    {"gid",     "1000",                 2},
+    {"euid",    "1000",                 2},
+    {"suid",    "1000",                 2},
+    {"fsuid",   "1000",                 2},
+    {"egid",    "1000",                 2},
+    {"sgid",    "1000",                 2},
+    {"fsgid",   "1000",                 2},
+    {"tty",     "pts0",                 2},
+    {"ses",     "3",                    1},
+    {"comm",    "sh",                   1},
+    {"exe",     "/usr/bin/bash",        1},
+    {"subj",    "unconfined_u:unconfined_r:unconfined_t:s0-s0:c0.c1023", 2},
+    {"key",     "exec",                 1},
+};
+
+/** Benchmark state */
+struct bench {
+    /** Event tree */
+    struct aushape_gbtree   event;
+    /** "data" object tree */
+    struct aushape_gbtree   data;
+    /** SYSCALL record tree */
+    struct aushape_gbtree   syscall;
+    /** EXECVE record tree */
+    struct aushape_gbtree   execve;
+    /** Argument value, NUL-terminated */
+    char                   *arg;
+    /** Number of EXECVE arguments */
+    size_t                  arg_num;
+};
+
+/**
+ * Build the event tree, the way the converter does for an event with a
+ * SYSCALL and a long EXECVE record, in compact JSON.
+ *
+ * @param bench The benchmark state to build the tree in.
+ *
+ * @return Return code:
+ *          AUSHAPE_RC_OK       - built successfully,
+ *          AUSHAPE_RC_NOMEM    - failed to allocate memory.
+ */
+static enum aushape_rc
+bench_build(struct bench *bench)
+{
+    enum aushape_rc rc;
+    struct aushape_gbtree *tree;
+    size_t i;
+
+    aushape_gbtree_empty(&bench->event);
+    aushape_gbtree_empty(&bench->data);
+    aushape_gbtree_empty(&bench->syscall);
+    aushape_gbtree_empty(&bench->execve);
+
+    /* SYSCALL record, fields prioritized by importance */
+    tree = &bench->syscall;
+    AUSHAPE_GUARD(aushape_gbuf_add_str(&tree->text, "\"syscall\":{"));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+    for (i = 0;
+         i < sizeof(syscall_field_list) / sizeof(*syscall_field_list);
+         i++) {
+        AUSHAPE_GUARD(aushape_gbuf_add_fmt(&tree->text,
+                                           i == 0 ? "\"%s\":[" : ",\"%s\":[",
+                                           syscall_field_list[i].name));
+        AUSHAPE_GUARD(aushape_gbuf_add_str_json(&tree->text,
+                                                syscall_field_list[i].value));
+        AUSHAPE_GUARD(aushape_gbuf_add_str(&tree->text, "]"));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(
+                                    tree, syscall_field_list[i].prio));
+    }
+    AUSHAPE_GUARD(aushape_gbuf_add_char(&tree->text, '}'));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+
+    /* EXECVE record, later arguments dropped first */
+    tree = &bench->execve;
+    AUSHAPE_GUARD(aushape_gbuf_add_fmt(&tree->text,
+                                       ",\"execve\":{\"argc\":[\"%zu\"],"
+                                       "\"a\":[",
+                                       bench->arg_num));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+    for (i = 0; i < bench->arg_num; i++) {
+        if (i > 0) {
+            AUSHAPE_GUARD(aushape_gbuf_add_char(&tree->text, ','));
+        }
+        AUSHAPE_GUARD(aushape_gbuf_add_char(&tree->text, '"'));
+        AUSHAPE_GUARD(aushape_gbuf_add_str_json(&tree->text, bench->arg));
+        AUSHAPE_GUARD(aushape_gbuf_add_char(&tree->text, '"'));
+        AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, i));
+    }
+    AUSHAPE_GUARD(aushape_gbuf_add_str(&tree->text, "]}"));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+
+    /* "data" object, the EXECVE record less important than SYSCALL */
+    tree = &bench->data;
+    AUSHAPE_GUARD(aushape_gbuf_add_str(&tree->text, ",\"data\":{"));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_tree(tree, 0, &bench->syscall));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_tree(tree, 1, &bench->execve));
+    AUSHAPE_GUARD(aushape_gbuf_add_char(&tree->text, '}'));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+
+    /* Event */
+    tree = &bench->event;
+    AUSHAPE_GUARD(aushape_gbuf_add_str(&tree->text,
+                                       "{\"serial\":123456,"
+                                       "\"time\":\"2016-01-01T00:00:00.000"
+                                       "+00:00\",\"host\":\"host\""));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_tree(tree, 2, &bench->data));
+    AUSHAPE_GUARD(aushape_gbuf_add_char(&tree->text, '}'));
+    AUSHAPE_GUARD(aushape_gbtree_node_add_text(tree, 0));
+
+    rc = AUSHAPE_RC_OK;
+cleanup:
+    return rc;
+}
+
+/**
+ * Get the current monotonic time in seconds.
+ *
+ * @return The time.
+ */
+static double
+bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Parse a positive decimal number option value.
+ *
+ * @param name  The option name, for error messages.
+ * @param str   The option value to parse.
+ * @param pnum  Location for the parsed number.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+parse_num(const char *name, const char *str, size_t *pnum)
+{
+    char *end;
+    unsigned long long num;
+
+    errno = 0;
+    num = strtoull(str, &end, 10);
+    if (errno != 0 || *str == '\0' || *end != '\0' || num == 0 ||
+        num > SIZE_MAX) {
+        fprintf(stderr, "Invalid %s: %s\n%s\n", name, str, cmd_help);
+        return false;
+    }
+    *pnum = (size_t)num;
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        {.name = "help",        .has_arg = no_argument,         .val = 'h'},
+        {.name = "version",     .has_arg = no_argument,         .val = 'v'},
+        {.name = "args",        .has_arg = required_argument,   .val = 'a'},
+        {.name = "arg-len",     .has_arg = required_argument,   .val = 'l'},
+        {.name = "trim",        .has_arg = required_argument,   .val = 't'},
+        {.name = "iterations",  .has_arg = required_argument,   .val = 'n'},
+        {.name = NULL}
+    };
+    int status = 1;
+    enum aushape_rc rc;
+    struct bench bench;
+    struct aushape_gbuf out;
+    size_t arg_len = 32;
+    size_t trim_pct = 33;
+    size_t iter_num = 100;
+    size_t node_num;
+    size_t len;
+    size_t trim_len;
+    size_t trimmed_len = 0;
+    double build_time = 0;
+    double len_time = 0;
+    double trim_time = 0;
+    double render_time = 0;
+    double trimmed_render_time = 0;
+    double start;
+    size_t i;
+    int optcode;
+
+    memset(&bench, 0, sizeof(bench));
+    bench.arg_num = 4096;
+    aushape_gbtree_init(&bench.event, 4096, 16, 4, NULL);
+    aushape_gbtree_init(&bench.data, 4096, 16, 4, NULL);
+    aushape_gbtree_init(&bench.syscall, 4096, 64, 4, NULL);
+    aushape_gbtree_init(&bench.execve, 4096, 64, 16, NULL);
+    aushape_gbuf_init(&out, 4096, NULL);
+
+    opterr = 0;
+    while ((optcode = getopt_long(argc, argv, ":hva:l:t:n:",
+                                  longopts, NULL)) >= 0) {
+        switch (optcode) {
+        case 'h':
+            fprintf(stdout, "%s\n", cmd_help);
+            status = 0;
+            goto cleanup;
+        case 'v':
+            fprintf(stdout, "%s",
+                    "aushape-bench (" PACKAGE_STRING ")\n"
+                    "Copyright (C) 2016 Red Hat\n"
+                    "License GPLv2+: GNU GPL version 2 or later "
+                        "<http://gnu.org/licenses/gpl.html>.\n"
+                    "\n"
+                    "This is free software: "
+                        "you are free to change and redistribute it.\n"
+                    "There is NO WARRANTY, to the extent permitted by law.\n");
+            status = 0;
+            goto cleanup;
+        case 'a':
+            if (!parse_num("number of arguments", optarg, &bench.arg_num)) {
+                goto cleanup;
+            }
+            break;
+        case 'l':
+            if (!parse_num("argument length", optarg, &arg_len)) {
+                goto cleanup;
+            }
+            break;
+        case 't':
+            if (!parse_num("trim percentage", optarg, &trim_pct)) {
+                goto cleanup;
+            }
+            if (trim_pct > 100) {
+                fprintf(stderr, "Trim percentage above 100\n%s\n", cmd_help);
+                goto cleanup;
+            }
+            break;
+        case 'n':
+            if (!parse_num("number of iterations", optarg, &iter_num)) {
+                goto cleanup;
+            }
+            break;
+        case '?':
+            fprintf(stderr, "Invalid option\n%s\n", cmd_help);
+            goto cleanup;
+        case ':':
+            fprintf(stderr, "Option value is missing\n%s\n", cmd_help);
+            goto cleanup;
+        default:
+            fprintf(stderr, "Unknown option code: %d\n%s\n",
+                    optcode, cmd_help);
+            goto cleanup;
+        }
+    }
+    if (optind < argc) {
+        fprintf(stderr, "Too many arguments\n%s\n", cmd_help);
+        goto cleanup;
+    }
+
+    /* Make an argument value needing a little escaping */
+    bench.arg = malloc(arg_len + 1);
+    if (bench.arg == NULL) {
+        fprintf(stderr, "Failed allocating the argument\n");
+        goto cleanup;
+    }
+    for (i = 0; i < arg_len; i++) {
+        bench.arg[i] = (i % 16 == 15) ? '"' : 'a' + i % 26;
+    }
+    bench.arg[arg_len] = '\0';
+
+    /* Measure building, including emptying the previous tree */
+    for (i = 0; i < iter_num; i++) {
+        start = bench_now();
+        rc = bench_build(&bench);
+        build_time += bench_now() - start;
+        if (rc != AUSHAPE_RC_OK) {
+            goto failure;
+        }
+    }
+    node_num = aushape_gbtree_get_node_num(&bench.syscall) +
+               aushape_gbtree_get_node_num(&bench.execve) +
+               aushape_gbtree_get_node_num(&bench.data) +
+               aushape_gbtree_get_node_num(&bench.event);
+
+    /* Measure rendering the full tree */
+    for (i = 0; i < iter_num; i++) {
+        aushape_gbuf_empty(&out);
+        start = bench_now();
+        rc = aushape_gbtree_render(&bench.event, &out);
+        render_time += bench_now() - start;
+        if (rc != AUSHAPE_RC_OK) {
+            goto failure;
+        }
+    }
+    len = out.len;
+    trim_len = len * trim_pct / 100;
+
+    /*
+     * Measure calculating the length and trimming, the way the converter
+     * does it, and rendering the trimmed tree, rebuilding it each time.
+     */
+    for (i = 0; i < iter_num; i++) {
+        rc = bench_build(&bench);
+        if (rc != AUSHAPE_RC_OK) {
+            goto failure;
+        }
+        start = bench_now();
+        aushape_gbtree_get_len(&bench.event, false);
+        len_time += bench_now() - start;
+        start = bench_now();
+        trimmed_len = aushape_gbtree_trim(&bench.event, false, true,
+                                          trim_len);
+        trim_time += bench_now() - start;
+        aushape_gbuf_empty(&out);
+        start = bench_now();
+        rc = aushape_gbtree_render(&bench.event, &out);
+        trimmed_render_time += bench_now() - start;
+        if (rc != AUSHAPE_RC_OK) {
+            goto failure;
+        }
+        assert(out.len == trimmed_len);
+    }
+
+    fprintf(stdout,
+            "Event:           %zu bytes, %zu nodes\n"
+            "Trimmed to:      %zu bytes, limit %zu\n"
+            "Iterations:      %zu\n"
+            "Build:           %.0f ns\n"
+            "Render:          %.0f ns\n"
+            "Length:          %.0f ns\n"
+            "Trim:            %.0f ns\n"
+            "Trimmed render:  %.0f ns\n",
+            len, node_num, trimmed_len, trim_len, iter_num,
+            build_time / iter_num * 1e9,
+            render_time / iter_num * 1e9,
+            len_time / iter_num * 1e9,
+            trim_time / iter_num * 1e9,
+            trimmed_render_time / iter_num * 1e9);
+    status = 0;
+    goto cleanup;
+
+failure:
+    fprintf(stderr, "Failed building or rendering the event: %s\n",
+            aushape_rc_to_desc(rc));
+cleanup:
+    free(bench.arg);
+    aushape_gbuf_cleanup(&out);
+    aushape_gbtree_cleanup(&bench.execve);
+    aushape_gbtree_cleanup(&bench.syscall);
+    aushape_gbtree_cleanup(&bench.data);
+    aushape_gbtree_cleanup(&bench.event);
+    return status;
+}
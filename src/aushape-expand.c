@@ -0,0 +1,544 @@
+/*
+ * Expand compact keys in aushape JSON output back to the original names.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/gbuf.h>
+#include <aushape/key_dict.h>
+#include <getopt.h>
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+/** Maximum number of keys a dictionary can have */
+#define DICT_MAX_NUM    (26 + 26 * 36)
+
+static const char *cmd_help =
+   "Usage: aushape-expand [OPTION]... [INPUT]\n"
+   "Expand compact keys in aushape JSON output.\n"
+   "\n"
+   "Arguments:\n"
+   "    INPUT                   Input file path or \"-\" for stdin.\n"
+   "                            Default: \"-\"\n"
+   "\n"
+   "Options:\n"
+   "    -h, --help              Output this help message and exit.\n"
+   "    -v, --version           Output version information and exit.\n"
+   "    -d, --dict=PATH         Use the key dictionary sidecar file PATH,\n"
+   "                            as output by \"aushape --key-dict\".\n"
+   "                            Default: the built-in dictionary\n";
+
+/** A key dictionary */
+struct dict {
+    /** Version */
+    char       *version;
+    /** Key names, indexed by key ID index, NULL if not assigned */
+    char       *name_list[DICT_MAX_NUM];
+};
+
+/** Expander state */
+enum state {
+    STATE_VALUE,        /**< Outside strings */
+    STATE_STR,          /**< Inside a string */
+    STATE_STR_ESC,      /**< Inside a string, after a backslash */
+    STATE_STR_END,      /**< After a string, before the next token */
+};
+
+/** Expander */
+struct expander {
+    /** Key dictionary to expand keys with */
+    const struct dict  *dict;
+    /** Output stream */
+    FILE               *stream;
+    /** Current state */
+    enum state          state;
+    /** Container nesting depth */
+    size_t              depth;
+    /** True if the outermost container is an array */
+    bool                outer_array;
+    /** True if the dictionary identification is being skipped */
+    bool                skipping;
+    /** Whitespace preceding the current token */
+    struct aushape_gbuf space;
+    /** Contents of the current string, without quotes */
+    struct aushape_gbuf str;
+    /** Whitespace following the current string */
+    struct aushape_gbuf str_space;
+};
+
+/**
+ * Cleanup a dictionary (free allocated data).
+ *
+ * @param dict  The dictionary to cleanup.
+ */
+static void
+dict_cleanup(struct dict *dict)
+{
+    size_t i;
+    free(dict->version);
+    for (i = 0; i < DICT_MAX_NUM; i++) {
+        free(dict->name_list[i]);
+    }
+    memset(dict, 0, sizeof(*dict));
+}
+
+/**
+ * Load the built-in key dictionary.
+ *
+ * @param dict  The dictionary to load into, must be empty.
+ *
+ * @return True if loaded successfully, false if failed and an error message
+ *         was printed to stderr.
+ */
+static bool
+dict_load_builtin(struct dict *dict)
+{
+    size_t i;
+    const struct aushape_key_def *def;
+    ssize_t idx;
+
+    dict->version = strdup(aushape_key_dict_version);
+    if (dict->version == NULL) {
+        fprintf(stderr, "Failed loading the key dictionary: %s\n",
+                strerror(errno));
+        return false;
+    }
+    for (i = 0; i < aushape_key_dict_num; i++) {
+        def = &aushape_key_dict_list[i];
+        idx = aushape_key_dict_id_to_index(def->id, strlen(def->id));
+        assert(idx >= 0 && (size_t)idx < DICT_MAX_NUM);
+        dict->name_list[idx] = strdup(def->name);
+        if (dict->name_list[idx] == NULL) {
+            fprintf(stderr, "Failed loading the key dictionary: %s\n",
+                    strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Load a key dictionary from a sidecar file.
+ *
+ * @param dict  The dictionary to load into, must be empty.
+ * @param path  The sidecar file path.
+ *
+ * @return True if loaded successfully, false if failed and an error message
+ *         was printed to stderr.
+ */
+static bool
+dict_load_file(struct dict *dict, const char *path)
+{
+    bool result = false;
+    FILE *file;
+    char line[256];
+    size_t line_num = 0;
+    size_t len;
+    char *name;
+    ssize_t idx;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Failed opening key dictionary \"%s\": %s\n",
+                path, strerror(errno));
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_num++;
+        len = strlen(line);
+        if (len == 0 || line[len - 1] != '\n') {
+            fprintf(stderr, "%s:%zu: Line too long\n", path, line_num);
+            goto cleanup;
+        }
+        line[--len] = '\0';
+        if (line_num == 1) {
+            if (strncmp(line, AUSHAPE_KEY_DICT_MAGIC,
+                        sizeof(AUSHAPE_KEY_DICT_MAGIC) - 1) != 0) {
+                fprintf(stderr, "%s:%zu: Not a key dictionary\n",
+                        path, line_num);
+                goto cleanup;
+            }
+            dict->version =
+                strdup(line + sizeof(AUSHAPE_KEY_DICT_MAGIC) - 1);
+            if (dict->version == NULL) {
+                fprintf(stderr, "Failed loading key dictionary: %s\n",
+                        strerror(errno));
+                goto cleanup;
+            }
+            continue;
+        }
+        name = strchr(line, ' ');
+        idx = name == NULL
+                ? -1
+                : aushape_key_dict_id_to_index(line, name - line);
+        if (idx < 0 || dict->name_list[idx] != NULL || name[1] == '\0') {
+            fprintf(stderr, "%s:%zu: Invalid key definition\n",
+                    path, line_num);
+            goto cleanup;
+        }
+        dict->name_list[idx] = strdup(name + 1);
+        if (dict->name_list[idx] == NULL) {
+            fprintf(stderr, "Failed loading key dictionary: %s\n",
+                    strerror(errno));
+            goto cleanup;
+        }
+    }
+    if (ferror(file)) {
+        fprintf(stderr, "Failed reading key dictionary \"%s\": %s\n",
+                path, strerror(errno));
+        goto cleanup;
+    }
+    if (dict->version == NULL) {
+        fprintf(stderr, "%s: Empty key dictionary\n", path);
+        goto cleanup;
+    }
+
+    result = true;
+cleanup:
+    fclose(file);
+    return result;
+}
+
+/**
+ * Initialize an expander.
+ *
+ * @param exp       The expander to initialize.
+ * @param dict      The key dictionary to expand keys with.
+ * @param stream    The stream to output to.
+ */
+static void
+expander_init(struct expander *exp, const struct dict *dict, FILE *stream)
+{
+    memset(exp, 0, sizeof(*exp));
+    exp->dict = dict;
+    exp->stream = stream;
+    exp->state = STATE_VALUE;
+    aushape_gbuf_init(&exp->space, 256, NULL);
+    aushape_gbuf_init(&exp->str, 256, NULL);
+    aushape_gbuf_init(&exp->str_space, 256, NULL);
+}
+
+/**
+ * Cleanup an expander (free allocated data).
+ *
+ * @param exp   The expander to cleanup.
+ */
+static void
+expander_cleanup(struct expander *exp)
+{
+    aushape_gbuf_cleanup(&exp->space);
+    aushape_gbuf_cleanup(&exp->str);
+    aushape_gbuf_cleanup(&exp->str_space);
+}
+
+/**
+ * Output the contents of a growing buffer and empty it.
+ *
+ * @param exp   The expander to output with.
+ * @param gbuf  The buffer to output.
+ */
+static void
+expander_flush(struct expander *exp, struct aushape_gbuf *gbuf)
+{
+    if (gbuf->len > 0) {
+        fwrite(gbuf->ptr, 1, gbuf->len, exp->stream);
+        aushape_gbuf_empty(gbuf);
+    }
+}
+
+/**
+ * Output the current string, followed by a token character.
+ *
+ * @param exp   The expander to output the string with.
+ * @param c     The character following the string and its whitespace.
+ *
+ * @return True if the string was output, false if it was an invalid key,
+ *         or had a mismatching dictionary version, and an error message
+ *         was printed to stderr.
+ */
+static bool
+expander_end_str(struct expander *exp, char c)
+{
+    const char *str = exp->str.ptr;
+    size_t len = exp->str.len;
+    ssize_t idx;
+    const char *version;
+
+    /* If it's a key */
+    if (c == ':') {
+        idx = aushape_key_dict_id_to_index(str, len);
+        if (idx >= 0) {
+            if (exp->dict->name_list[idx] == NULL) {
+                fprintf(stderr, "Unknown key ID \"%.*s\"\n", (int)len, str);
+                return false;
+            }
+            str = exp->dict->name_list[idx];
+            len = strlen(str);
+        } else if (len > 0 && str[0] == AUSHAPE_KEY_DICT_ESCAPE) {
+            str++;
+            len--;
+        }
+    /* Else, if it's the dictionary identification of a document */
+    } else if (exp->depth == 1 && exp->outer_array &&
+               len > sizeof(AUSHAPE_KEY_DICT_MAGIC) - 1 &&
+               memcmp(str, AUSHAPE_KEY_DICT_MAGIC,
+                      sizeof(AUSHAPE_KEY_DICT_MAGIC) - 1) == 0) {
+        version = str + sizeof(AUSHAPE_KEY_DICT_MAGIC) - 1;
+        len -= sizeof(AUSHAPE_KEY_DICT_MAGIC) - 1;
+        if (len != strlen(exp->dict->version) ||
+            memcmp(version, exp->dict->version, len) != 0) {
+            fprintf(stderr, "Document key dictionary version \"%.*s\" "
+                            "doesn't match \"%s\"\n",
+                    (int)len, version, exp->dict->version);
+            return false;
+        }
+        /* Drop it, together with the surrounding space and separator */
+        aushape_gbuf_empty(&exp->space);
+        aushape_gbuf_empty(&exp->str);
+        aushape_gbuf_empty(&exp->str_space);
+        exp->skipping = (c == ',');
+        return true;
+    }
+
+    expander_flush(exp, &exp->space);
+    fputc('"', exp->stream);
+    fwrite(str, 1, len, exp->stream);
+    fputc('"', exp->stream);
+    aushape_gbuf_empty(&exp->str);
+    expander_flush(exp, &exp->str_space);
+    return true;
+}
+
+/**
+ * Feed a character to an expander.
+ *
+ * @param exp   The expander to feed the character to.
+ * @param c     The character to feed.
+ *
+ * @return True if the character was processed, false if the input is
+ *         invalid, or memory allocation failed, and an error message was
+ *         printed to stderr.
+ */
+static bool
+expander_feed(struct expander *exp, char c)
+{
+    bool space = (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+    enum aushape_rc rc = AUSHAPE_RC_OK;
+
+    switch (exp->state) {
+    case STATE_STR:
+        if (c == '"') {
+            exp->state = STATE_STR_END;
+        } else {
+            if (c == '\\') {
+                exp->state = STATE_STR_ESC;
+            }
+            rc = aushape_gbuf_add_char(&exp->str, c);
+        }
+        break;
+    case STATE_STR_ESC:
+        exp->state = STATE_STR;
+        rc = aushape_gbuf_add_char(&exp->str, c);
+        break;
+    case STATE_STR_END:
+        if (space) {
+            rc = aushape_gbuf_add_char(&exp->str_space, c);
+            break;
+        }
+        if (!expander_end_str(exp, c)) {
+            return false;
+        }
+        exp->state = STATE_VALUE;
+        if (exp->skipping) {
+            exp->skipping = false;
+            break;
+        }
+        /* FALLTHROUGH */
+    case STATE_VALUE:
+        if (space) {
+            rc = aushape_gbuf_add_char(&exp->space, c);
+            break;
+        }
+        if (c == '"') {
+            exp->state = STATE_STR;
+            break;
+        }
+        if (c == '[' || c == '{') {
+            if (exp->depth == 0) {
+                exp->outer_array = (c == '[');
+            }
+            exp->depth++;
+        } else if ((c == ']' || c == '}') && exp->depth > 0) {
+            exp->depth--;
+        }
+        expander_flush(exp, &exp->space);
+        fputc(c, exp->stream);
+        break;
+    }
+
+    if (rc != AUSHAPE_RC_OK) {
+        fprintf(stderr, "Failed expanding keys: %s\n",
+                aushape_rc_to_desc(rc));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Finish expanding input, outputting whatever is pending.
+ *
+ * @param exp   The expander to finish.
+ *
+ * @return True if finished successfully, false if the input was truncated
+ *         and an error message was printed to stderr.
+ */
+static bool
+expander_finish(struct expander *exp)
+{
+    if (exp->state == STATE_STR_END) {
+        if (!expander_end_str(exp, '\0')) {
+            return false;
+        }
+        exp->state = STATE_VALUE;
+    }
+    expander_flush(exp, &exp->space);
+    if (exp->state != STATE_VALUE) {
+        fprintf(stderr, "Input ends inside a string\n");
+        return false;
+    }
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        {.name = "help",    .has_arg = no_argument,         .val = 'h'},
+        {.name = "version", .has_arg = no_argument,         .val = 'v'},
+        {.name = "dict",    .has_arg = required_argument,   .val = 'd'},
+        {.name = NULL}
+    };
+    int status = 1;
+    const char *dict_path = NULL;
+    const char *input = "-";
+    FILE *input_stream = NULL;
+    struct dict dict;
+    struct expander exp;
+    char buf[4096];
+    size_t len;
+    size_t i;
+    int optcode;
+
+    memset(&dict, 0, sizeof(dict));
+    expander_init(&exp, &dict, stdout);
+
+    opterr = 0;
+    while ((optcode = getopt_long(argc, argv, ":hvd:",
+                                  longopts, NULL)) >= 0) {
+        switch (optcode) {
+        case 'h':
+            fprintf(stdout, "%s\n", cmd_help);
+            status = 0;
+            goto cleanup;
+        case 'v':
+            fprintf(stdout, "%s",
+                    "aushape-expand (" PACKAGE_STRING ")\n"
+                    "Copyright (C) 2016 Red Hat\n"
+                    "License GPLv2+: GNU GPL version 2 or later "
+                        "<http://gnu.org/licenses/gpl.html>.\n"
+                    "\n"
+                    "This is free software: "
+                        "you are free to change and redistribute it.\n"
+                    "There is NO WARRANTY, to the extent permitted by law.\n");
+            status = 0;
+            goto cleanup;
+        case 'd':
+            dict_path = optarg;
+            break;
+        case '?':
+            fprintf(stderr, "Invalid option\n%s\n", cmd_help);
+            goto cleanup;
+        case ':':
+            fprintf(stderr, "Option value is missing\n%s\n", cmd_help);
+            goto cleanup;
+        default:
+            fprintf(stderr, "Unknown option code: %d\n%s\n",
+                    optcode, cmd_help);
+            goto cleanup;
+        }
+    }
+    if (optind < argc) {
+        input = argv[optind++];
+    }
+    if (optind < argc) {
+        fprintf(stderr, "Too many arguments\n%s\n", cmd_help);
+        goto cleanup;
+    }
+
+    /* Load the dictionary */
+    if (dict_path == NULL ? !dict_load_builtin(&dict)
+                          : !dict_load_file(&dict, dict_path)) {
+        goto cleanup;
+    }
+
+    /* Open input */
+    if (strcmp(input, "-") == 0) {
+        input_stream = stdin;
+    } else {
+        input_stream = fopen(input, "r");
+        if (input_stream == NULL) {
+            fprintf(stderr, "Failed opening input file \"%s\": %s\n",
+                    input, strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    /* Expand */
+    while ((len = fread(buf, 1, sizeof(buf), input_stream)) > 0) {
+        for (i = 0; i < len; i++) {
+            if (!expander_feed(&exp, buf[i])) {
+                goto cleanup;
+            }
+        }
+    }
+    if (ferror(input_stream)) {
+        fprintf(stderr, "Failed reading input: %s\n", strerror(errno));
+        goto cleanup;
+    }
+    if (!expander_finish(&exp)) {
+        goto cleanup;
+    }
+    if (fflush(stdout) != 0) {
+        fprintf(stderr, "Failed writing output: %s\n", strerror(errno));
+        goto cleanup;
+    }
+
+    status = 0;
+
+cleanup:
+    if (input_stream != NULL && input_stream != stdin) {
+        fclose(input_stream);
+    }
+    expander_cleanup(&exp);
+    dict_cleanup(&dict);
+    return status;
+}
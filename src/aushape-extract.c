@@ -0,0 +1,710 @@
+/*
+ * Extract a time window from indexed compressed aushape output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/comp_index.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <getopt.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Size of the buffers for compressed and decompressed data */
+#define BUF_SIZE    (64 * 1024)
+
+static const char *cmd_help =
+   "Usage: aushape-extract [OPTION]... INPUT\n"
+   "Extract events from a time window out of compressed aushape output\n"
+   "indexed with \"aushape --compress-index\", decompressing only the\n"
+   "frames containing them.\n"
+   "\n"
+   "Arguments:\n"
+   "    INPUT                   Input file path.\n"
+   "\n"
+   "Options:\n"
+   "    -h, --help              Output this help message and exit.\n"
+   "    -v, --version           Output version information and exit.\n"
+   "    -l, --list              List the indexed frames instead of\n"
+   "                            extracting: offset, size, length, number of\n"
+   "                            events, first and last serial number,\n"
+   "                            earliest and latest time.\n"
+   "    -f, --from=TIME         Extract frames with events not earlier than\n"
+   "                            TIME, seconds since epoch, with up to three\n"
+   "                            fractional digits.\n"
+   "                            Default: no limit\n"
+   "    -t, --to=TIME           Extract frames with events not later than\n"
+   "                            TIME, seconds since epoch, with up to three\n"
+   "                            fractional digits.\n"
+   "                            Default: no limit\n"
+   "\n"
+   "Without --from and --to all frames are extracted, including those\n"
+   "without events.\n";
+
+/** Indexed compressed input */
+struct input {
+    /** File descriptor */
+    int                                 fd;
+    /** Compression algorithm */
+    enum aushape_comp                   comp;
+    /** Offset of the index trailer, i.e. the end of the frames */
+    uint64_t                            end;
+    /** Frame index entries */
+    struct aushape_comp_index_frame    *frame_list;
+    /** Number of frame index entries */
+    size_t                              frame_num;
+};
+
+/**
+ * Parse a time in seconds since epoch, with optional fraction.
+ *
+ * @param str   The string to parse.
+ * @param ptime Location for the parsed time, milliseconds since epoch.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+parse_time(const char *str, long long *ptime)
+{
+    long long time = 0;
+    size_t digits;
+
+    if (*str < '0' || *str > '9') {
+        return false;
+    }
+    for (; *str >= '0' && *str <= '9'; str++) {
+        if (time > (LLONG_MAX / 1000 - 9) / 10) {
+            return false;
+        }
+        time = time * 10 + (*str - '0');
+    }
+    if (*str == '.') {
+        str++;
+    } else if (*str != '\0') {
+        return false;
+    }
+    for (digits = 0; digits < 3; digits++) {
+        if (*str >= '0' && *str <= '9') {
+            time = time * 10 + (*str++ - '0');
+        } else {
+            time = time * 10;
+        }
+    }
+    if (*str != '\0') {
+        return false;
+    }
+    *ptime = time;
+    return true;
+}
+
+/**
+ * Read a piece of an input file completely.
+ *
+ * @param fd        The input file descriptor.
+ * @param buf       The buffer to read into.
+ * @param len       Number of bytes to read.
+ * @param offset    Offset to read at.
+ *
+ * @return True if read successfully, false if failed and an error message
+ *         was printed to stderr.
+ */
+static bool
+read_at(int fd, void *buf, size_t len, uint64_t offset)
+{
+    ssize_t rc;
+
+    while (len > 0) {
+        rc = pread(fd, buf, len, (off_t)offset);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Failed reading input: %s\n", strerror(errno));
+            return false;
+        } else if (rc == 0) {
+            fprintf(stderr, "Input is truncated\n");
+            return false;
+        }
+        buf = (char *)buf + rc;
+        len -= (size_t)rc;
+        offset += (uint64_t)rc;
+    }
+    return true;
+}
+
+/**
+ * Decode a little-endian unsigned integer.
+ *
+ * @param ptr   Pointer to the encoded integer.
+ * @param size  Size of the encoded integer, bytes.
+ *
+ * @return The decoded integer.
+ */
+static uint64_t
+get_le(const void *ptr, size_t size)
+{
+    const unsigned char *p = (const unsigned char *)ptr;
+    uint64_t val = 0;
+
+    while (size > 0) {
+        val = (val << 8) | p[--size];
+    }
+    return val;
+}
+
+/**
+ * Locate and read the index of a gzip input.
+ *
+ * @param input     The input to read the index of, with the file
+ *                  descriptor set.
+ * @param size      Size of the input file.
+ * @param pindex    Location for the allocated zero-terminated index text.
+ *
+ * @return True if read successfully, false if failed and an error message
+ *         was printed to stderr.
+ */
+static bool
+read_gzip_index(struct input *input, uint64_t size, char **pindex)
+{
+    unsigned char loc[AUSHAPE_COMP_INDEX_GZIP_LOC_SIZE];
+    uint64_t len;
+    char *member;
+
+    if (!read_at(input->fd, loc, sizeof(loc), size - sizeof(loc))) {
+        return false;
+    }
+    input->end = get_le(loc + 16, 8);
+    if (memcmp(loc, "\x1f\x8b\x08\x04", 4) != 0 ||
+        get_le(loc + 10, 2) != 12 ||
+        loc[12] != AUSHAPE_COMP_INDEX_GZIP_SI1 ||
+        loc[13] != AUSHAPE_COMP_INDEX_GZIP_SI2 ||
+        get_le(loc + 14, 2) != 8 ||
+        input->end > size - sizeof(loc) ||
+        size - sizeof(loc) - input->end < 10 + 1 + 10) {
+        fprintf(stderr, "Index locator is invalid\n");
+        return false;
+    }
+
+    len = size - sizeof(loc) - input->end;
+    if (len > SIZE_MAX) {
+        fprintf(stderr, "Index is too big\n");
+        return false;
+    }
+    member = malloc((size_t)len);
+    if (member == NULL) {
+        fprintf(stderr, "Failed allocating the index\n");
+        return false;
+    }
+    if (!read_at(input->fd, member, (size_t)len, input->end)) {
+        free(member);
+        return false;
+    }
+    /* Check the header and the empty body, move the comment to the start */
+    if (memcmp(member, "\x1f\x8b\x08\x10", 4) != 0 ||
+        memcmp(member + len - 11, "\0\x03\0\0\0\0\0\0\0\0\0", 11) != 0 ||
+        memchr(member + 10, '\0', len - 11 - 10) != NULL) {
+        fprintf(stderr, "Index member is invalid\n");
+        free(member);
+        return false;
+    }
+    memmove(member, member + 10, len - 10 - 10);
+    *pindex = member;
+    return true;
+}
+
+/**
+ * Locate and read the index of a zstd input.
+ *
+ * @param input     The input to read the index of, with the file
+ *                  descriptor set.
+ * @param size      Size of the input file.
+ * @param pindex    Location for the allocated zero-terminated index text.
+ *
+ * @return True if read successfully, false if failed and an error message
+ *         was printed to stderr.
+ */
+static bool
+read_zstd_index(struct input *input, uint64_t size, char **pindex)
+{
+    unsigned char footer[AUSHAPE_COMP_INDEX_ZSTD_SEEK_FOOTER_SIZE];
+    unsigned char entry[8];
+    uint64_t frame_num;
+    uint64_t table_size;
+    uint64_t len;
+    char *frame;
+
+    if (!read_at(input->fd, footer, sizeof(footer), size - sizeof(footer))) {
+        return false;
+    }
+    frame_num = get_le(footer, 4);
+    table_size = 8 + frame_num * 8 + sizeof(footer);
+    if (footer[4] != 0 || frame_num == 0 || table_size > size) {
+        fprintf(stderr, "Seek table is invalid or unsupported\n");
+        return false;
+    }
+    /* The last entry is the index frame */
+    if (!read_at(input->fd, entry, sizeof(entry),
+                 size - sizeof(footer) - sizeof(entry))) {
+        return false;
+    }
+    len = get_le(entry, 4);
+    if (len < 8 || len > size - table_size) {
+        fprintf(stderr, "Seek table is invalid\n");
+        return false;
+    }
+    input->end = size - table_size - len;
+    frame = malloc((size_t)len + 1);
+    if (frame == NULL) {
+        fprintf(stderr, "Failed allocating the index\n");
+        return false;
+    }
+    if (!read_at(input->fd, frame, (size_t)len, input->end)) {
+        free(frame);
+        return false;
+    }
+    if (get_le(frame, 4) != AUSHAPE_COMP_INDEX_ZSTD_MAGIC ||
+        get_le(frame + 4, 4) != len - 8 ||
+        memchr(frame + 8, '\0', len - 8) != NULL) {
+        fprintf(stderr, "Index frame is invalid\n");
+        free(frame);
+        return false;
+    }
+    memmove(frame, frame + 8, len - 8);
+    frame[len - 8] = '\0';
+    *pindex = frame;
+    return true;
+}
+
+/**
+ * Open an indexed compressed input and read its index.
+ *
+ * @param input The input to open.
+ * @param path  The input file path.
+ *
+ * @return True if opened successfully, false if failed and an error message
+ *         was printed to stderr.
+ */
+static bool
+input_open(struct input *input, const char *path)
+{
+    bool result = false;
+    struct stat st;
+    unsigned char tail[4];
+    char *index = NULL;
+    char *line;
+    char *next;
+    size_t frame_max = 0;
+    struct aushape_comp_index_frame *frame_list;
+
+    memset(input, 0, sizeof(*input));
+    input->fd = open(path, O_RDONLY);
+    if (input->fd < 0) {
+        fprintf(stderr, "Failed opening input file \"%s\": %s\n",
+                path, strerror(errno));
+        goto cleanup;
+    }
+    if (fstat(input->fd, &st) < 0) {
+        fprintf(stderr, "Failed getting input file status: %s\n",
+                strerror(errno));
+        goto cleanup;
+    }
+    if (!S_ISREG(st.st_mode) ||
+        (uint64_t)st.st_size < AUSHAPE_COMP_INDEX_GZIP_LOC_SIZE) {
+        fprintf(stderr, "Input is not an indexed compressed file\n");
+        goto cleanup;
+    }
+
+    /* Detect the algorithm by the trailer end */
+    if (!read_at(input->fd, tail, sizeof(tail), st.st_size - sizeof(tail))) {
+        goto cleanup;
+    }
+    if (get_le(tail, 4) == AUSHAPE_COMP_INDEX_ZSTD_SEEK_END_MAGIC) {
+        input->comp = AUSHAPE_COMP_ZSTD;
+        if (!read_zstd_index(input, st.st_size, &index)) {
+            goto cleanup;
+        }
+    } else {
+        input->comp = AUSHAPE_COMP_GZIP;
+        if (!read_gzip_index(input, st.st_size, &index)) {
+            goto cleanup;
+        }
+    }
+    if (!aushape_comp_is_available(input->comp)) {
+        fprintf(stderr, "Compression algorithm is not supported "
+                        "by this build\n");
+        goto cleanup;
+    }
+
+    /* Parse the index */
+    if (strncmp(index, AUSHAPE_COMP_INDEX_MAGIC,
+                strlen(AUSHAPE_COMP_INDEX_MAGIC)) != 0) {
+        fprintf(stderr, "Index format is unsupported\n");
+        goto cleanup;
+    }
+    for (line = index + strlen(AUSHAPE_COMP_INDEX_MAGIC);
+         *line != '\0'; line = next) {
+        next = strchr(line, '\n');
+        if (next == NULL) {
+            fprintf(stderr, "Index is truncated\n");
+            goto cleanup;
+        }
+        *next++ = '\0';
+        if (input->frame_num >= frame_max) {
+            frame_max = frame_max == 0 ? 64 : frame_max * 2;
+            frame_list = realloc(input->frame_list,
+                                 frame_max * sizeof(*frame_list));
+            if (frame_list == NULL) {
+                fprintf(stderr, "Failed allocating the index\n");
+                goto cleanup;
+            }
+            input->frame_list = frame_list;
+        }
+        if (!aushape_comp_index_parse_frame(
+                            line, &input->frame_list[input->frame_num]) ||
+            input->frame_list[input->frame_num].offset > input->end ||
+            input->frame_list[input->frame_num].size >
+                input->end - input->frame_list[input->frame_num].offset) {
+            fprintf(stderr, "Invalid index entry: %s\n", line);
+            goto cleanup;
+        }
+        input->frame_num++;
+    }
+
+    result = true;
+cleanup:
+    free(index);
+    return result;
+}
+
+/**
+ * Close an input, freeing its index.
+ *
+ * @param input The input to close.
+ */
+static void
+input_close(struct input *input)
+{
+    if (input->fd >= 0) {
+        close(input->fd);
+    }
+    free(input->frame_list);
+    memset(input, 0, sizeof(*input));
+    input->fd = -1;
+}
+
+/**
+ * Decompress a gzip member of an input to stdout.
+ *
+ * @param input The input to decompress the member from.
+ * @param frame The member index entry.
+ * @param ibuf  Buffer for compressed data, BUF_SIZE bytes.
+ * @param obuf  Buffer for decompressed data, BUF_SIZE bytes.
+ *
+ * @return True if decompressed successfully, false if failed and an error
+ *         message was printed to stderr.
+ */
+static bool
+extract_gzip(const struct input *input,
+             const struct aushape_comp_index_frame *frame,
+             char *ibuf, char *obuf)
+{
+    bool result = false;
+    z_stream gzip;
+    uint64_t offset = frame->offset;
+    uint64_t left = frame->size;
+    int zrc = Z_OK;
+
+    memset(&gzip, 0, sizeof(gzip));
+    /* Add 16 to window bits to expect gzip header and trailer */
+    if (inflateInit2(&gzip, MAX_WBITS + 16) != Z_OK) {
+        fprintf(stderr, "Failed initializing gzip decompression\n");
+        return false;
+    }
+    while (zrc != Z_STREAM_END) {
+        if (gzip.avail_in == 0) {
+            if (left == 0) {
+                fprintf(stderr, "Frame at %" PRIu64 " is truncated\n",
+                        frame->offset);
+                goto cleanup;
+            }
+            gzip.avail_in = left < BUF_SIZE ? (uInt)left : BUF_SIZE;
+            if (!read_at(input->fd, ibuf, gzip.avail_in, offset)) {
+                goto cleanup;
+            }
+            gzip.next_in = (Bytef *)ibuf;
+            offset += gzip.avail_in;
+            left -= gzip.avail_in;
+        }
+        gzip.next_out = (Bytef *)obuf;
+        gzip.avail_out = BUF_SIZE;
+        zrc = inflate(&gzip, Z_NO_FLUSH);
+        if (zrc != Z_OK && zrc != Z_STREAM_END) {
+            fprintf(stderr, "Failed decompressing frame at %" PRIu64 "\n",
+                    frame->offset);
+            goto cleanup;
+        }
+        if (fwrite(obuf, 1, BUF_SIZE - gzip.avail_out, stdout) !=
+                BUF_SIZE - gzip.avail_out) {
+            fprintf(stderr, "Failed writing output: %s\n", strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    result = true;
+cleanup:
+    inflateEnd(&gzip);
+    return result;
+}
+
+#ifdef HAVE_ZSTD
+/**
+ * Decompress a zstd frame of an input to stdout.
+ *
+ * @param input The input to decompress the frame from.
+ * @param frame The frame index entry.
+ * @param ibuf  Buffer for compressed data, BUF_SIZE bytes.
+ * @param obuf  Buffer for decompressed data, BUF_SIZE bytes.
+ *
+ * @return True if decompressed successfully, false if failed and an error
+ *         message was printed to stderr.
+ */
+static bool
+extract_zstd(const struct input *input,
+             const struct aushape_comp_index_frame *frame,
+             char *ibuf, char *obuf)
+{
+    bool result = false;
+    ZSTD_DCtx *zstd;
+    ZSTD_inBuffer in = {.src = ibuf, .size = 0, .pos = 0};
+    ZSTD_outBuffer out;
+    uint64_t offset = frame->offset;
+    uint64_t left = frame->size;
+    size_t remaining = 1;
+
+    zstd = ZSTD_createDCtx();
+    if (zstd == NULL) {
+        fprintf(stderr, "Failed initializing zstd decompression\n");
+        return false;
+    }
+    while (remaining != 0) {
+        if (in.pos == in.size) {
+            if (left == 0) {
+                fprintf(stderr, "Frame at %" PRIu64 " is truncated\n",
+                        frame->offset);
+                goto cleanup;
+            }
+            in.size = left < BUF_SIZE ? (size_t)left : BUF_SIZE;
+            in.pos = 0;
+            if (!read_at(input->fd, ibuf, in.size, offset)) {
+                goto cleanup;
+            }
+            offset += in.size;
+            left -= in.size;
+        }
+        out.dst = obuf;
+        out.size = BUF_SIZE;
+        out.pos = 0;
+        remaining = ZSTD_decompressStream(zstd, &out, &in);
+        if (ZSTD_isError(remaining)) {
+            fprintf(stderr, "Failed decompressing frame at %" PRIu64 ": %s\n",
+                    frame->offset, ZSTD_getErrorName(remaining));
+            goto cleanup;
+        }
+        if (fwrite(obuf, 1, out.pos, stdout) != out.pos) {
+            fprintf(stderr, "Failed writing output: %s\n", strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    result = true;
+cleanup:
+    ZSTD_freeDCtx(zstd);
+    return result;
+}
+#endif
+
+/**
+ * Print a time in milliseconds since epoch as seconds with a fraction.
+ *
+ * @param time  The time to print.
+ */
+static void
+print_time(long long time)
+{
+    unsigned long long abs_time = (unsigned long long)time;
+    if (time < 0) {
+        abs_time = -abs_time;
+    }
+    printf("%s%llu.%03llu", time < 0 ? "-" : "",
+           abs_time / 1000, abs_time % 1000);
+}
+
+int
+main(int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        {.name = "help",    .has_arg = no_argument,         .val = 'h'},
+        {.name = "version", .has_arg = no_argument,         .val = 'v'},
+        {.name = "list",    .has_arg = no_argument,         .val = 'l'},
+        {.name = "from",    .has_arg = required_argument,   .val = 'f'},
+        {.name = "to",      .has_arg = required_argument,   .val = 't'},
+        {.name = NULL}
+    };
+    int status = 1;
+    bool list = false;
+    bool window = false;
+    long long from = LLONG_MIN;
+    long long to = LLONG_MAX;
+    struct input input = {.fd = -1};
+    const struct aushape_comp_index_frame *frame;
+    char *ibuf = NULL;
+    char *obuf = NULL;
+    bool ok;
+    size_t i;
+    int optcode;
+
+    opterr = 0;
+    while ((optcode = getopt_long(argc, argv, ":hvlf:t:",
+                                  longopts, NULL)) >= 0) {
+        switch (optcode) {
+        case 'h':
+            fprintf(stdout, "%s\n", cmd_help);
+            status = 0;
+            goto cleanup;
+        case 'v':
+            fprintf(stdout, "%s",
+                    "aushape-extract (" PACKAGE_STRING ")\n"
+                    "Copyright (C) 2016 Red Hat\n"
+                    "License GPLv2+: GNU GPL version 2 or later "
+                        "<http://gnu.org/licenses/gpl.html>.\n"
+                    "\n"
+                    "This is free software: "
+                        "you are free to change and redistribute it.\n"
+                    "There is NO WARRANTY, to the extent permitted by law.\n");
+            status = 0;
+            goto cleanup;
+        case 'l':
+            list = true;
+            break;
+        case 'f':
+            if (!parse_time(optarg, &from)) {
+                fprintf(stderr, "Invalid time: %s\n%s\n", optarg, cmd_help);
+                goto cleanup;
+            }
+            window = true;
+            break;
+        case 't':
+            if (!parse_time(optarg, &to)) {
+                fprintf(stderr, "Invalid time: %s\n%s\n", optarg, cmd_help);
+                goto cleanup;
+            }
+            window = true;
+            break;
+        case '?':
+            fprintf(stderr, "Invalid option\n%s\n", cmd_help);
+            goto cleanup;
+        case ':':
+            fprintf(stderr, "Option value is missing\n%s\n", cmd_help);
+            goto cleanup;
+        default:
+            fprintf(stderr, "Unknown option code: %d\n%s\n",
+                    optcode, cmd_help);
+            goto cleanup;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "Input file is not specified\n%s\n", cmd_help);
+        goto cleanup;
+    }
+    if (optind + 1 < argc) {
+        fprintf(stderr, "Too many arguments\n%s\n", cmd_help);
+        goto cleanup;
+    }
+
+    if (!input_open(&input, argv[optind])) {
+        goto cleanup;
+    }
+
+    ibuf = malloc(BUF_SIZE);
+    obuf = malloc(BUF_SIZE);
+    if (ibuf == NULL || obuf == NULL) {
+        fprintf(stderr, "Failed allocating buffers\n");
+        goto cleanup;
+    }
+
+    for (i = 0; i < input.frame_num; i++) {
+        frame = &input.frame_list[i];
+        /* Skip frames outside the window */
+        if (window &&
+            (frame->events == 0 ||
+             frame->latest < from || frame->earliest > to)) {
+            continue;
+        }
+        if (list) {
+            printf("%" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64
+                   " %lu %lu ",
+                   frame->offset, frame->size, frame->len, frame->events,
+                   frame->first_serial, frame->last_serial);
+            print_time(frame->earliest);
+            putchar(' ');
+            print_time(frame->latest);
+            putchar('\n');
+            continue;
+        }
+        switch (input.comp) {
+        case AUSHAPE_COMP_GZIP:
+            ok = extract_gzip(&input, frame, ibuf, obuf);
+            break;
+#ifdef HAVE_ZSTD
+        case AUSHAPE_COMP_ZSTD:
+            ok = extract_zstd(&input, frame, ibuf, obuf);
+            break;
+#endif
+        default:
+            assert(false);
+            ok = false;
+            break;
+        }
+        if (!ok) {
+            goto cleanup;
+        }
+    }
+    if (fflush(stdout) != 0) {
+        fprintf(stderr, "Failed writing output: %s\n", strerror(errno));
+        goto cleanup;
+    }
+
+    status = 0;
+
+cleanup:
+    free(obuf);
+    free(ibuf);
+    input_close(&input);
+    return status;
+}
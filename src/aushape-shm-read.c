@@ -0,0 +1,163 @@
+/*
+ * Read items from an aushape shared-memory output.
+ *
+ * Copyright (C) 2016 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <config.h>
+#include <aushape/shm_consumer.h>
+#include <getopt.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+static const char *cmd_help =
+   "Usage: aushape-shm-read [OPTION]... SOCKET\n"
+   "Read items from an aushape shared-memory output, accepting consumers\n"
+   "on SOCKET, and write them to stdout verbatim.\n"
+   "\n"
+   "Arguments:\n"
+   "    SOCKET                  The path to the Unix socket of the output,\n"
+   "                            as specified with \"aushape --shm-socket\".\n"
+   "\n"
+   "Options:\n"
+   "    -h, --help              Output this help message and exit.\n"
+   "    -v, --version           Output version information and exit.\n"
+   "    -n, --count=NUMBER      Exit after reading NUMBER items.\n"
+   "                            Default: read until the output is closed\n"
+   "    -t, --timeout=MS        Exit if no items arrive for MS\n"
+   "                            milliseconds.\n"
+   "                            Default: wait indefinitely\n";
+
+int
+main(int argc, char **argv)
+{
+    static const struct option longopts[] = {
+        {.name = "help",    .has_arg = no_argument,         .val = 'h'},
+        {.name = "version", .has_arg = no_argument,         .val = 'v'},
+        {.name = "count",   .has_arg = required_argument,   .val = 'n'},
+        {.name = "timeout", .has_arg = required_argument,   .val = 't'},
+        {.name = NULL}
+    };
+    int status = 1;
+    enum aushape_rc rc;
+    struct aushape_shm_consumer *consumer = NULL;
+    const char *path;
+    size_t count = 0;
+    int timeout = -1;
+    const void *ptr;
+    size_t len;
+    size_t num = 0;
+    int end;
+    int optcode;
+
+    opterr = 0;
+    while ((optcode = getopt_long(argc, argv, ":hvn:t:",
+                                  longopts, NULL)) >= 0) {
+        switch (optcode) {
+        case 'h':
+            fprintf(stdout, "%s\n", cmd_help);
+            status = 0;
+            goto cleanup;
+        case 'v':
+            fprintf(stdout, "%s",
+                    "aushape-shm-read (" PACKAGE_STRING ")\n"
+                    "Copyright (C) 2016 Red Hat\n"
+                    "License GPLv2+: GNU GPL version 2 or later "
+                        "<http://gnu.org/licenses/gpl.html>.\n"
+                    "\n"
+                    "This is free software: "
+                        "you are free to change and redistribute it.\n"
+                    "There is NO WARRANTY, to the extent permitted by law.\n");
+            status = 0;
+            goto cleanup;
+        case 'n':
+            end = 0;
+            if (sscanf(optarg, "%zu%n", &count, &end) < 1 ||
+                (size_t)end != strlen(optarg) || count == 0) {
+                fprintf(stderr, "Invalid item count: %s\n%s\n",
+                        optarg, cmd_help);
+                goto cleanup;
+            }
+            break;
+        case 't':
+            end = 0;
+            if (sscanf(optarg, "%d%n", &timeout, &end) < 1 ||
+                (size_t)end != strlen(optarg) || timeout < 0) {
+                fprintf(stderr, "Invalid timeout: %s\n%s\n",
+                        optarg, cmd_help);
+                goto cleanup;
+            }
+            break;
+        case '?':
+            fprintf(stderr, "Invalid option\n%s\n", cmd_help);
+            goto cleanup;
+        case ':':
+            fprintf(stderr, "Option value is missing\n%s\n", cmd_help);
+            goto cleanup;
+        default:
+            fprintf(stderr, "Unknown option code: %d\n%s\n",
+                    optcode, cmd_help);
+            goto cleanup;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "Socket path is missing\n%s\n", cmd_help);
+        goto cleanup;
+    }
+    path = argv[optind++];
+    if (optind < argc) {
+        fprintf(stderr, "Too many arguments\n%s\n", cmd_help);
+        goto cleanup;
+    }
+
+    rc = aushape_shm_consumer_open(&consumer, path);
+    if (rc != AUSHAPE_RC_OK) {
+        fprintf(stderr, "Failed connecting to \"%s\": %s: %s\n",
+                path, aushape_rc_to_desc(rc), strerror(errno));
+        goto cleanup;
+    }
+
+    /* Copy items until done, or the output is closed */
+    while (count == 0 || num < count) {
+        rc = aushape_shm_consumer_next(consumer, timeout, &ptr, &len);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed reading an item: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+        if (ptr == NULL) {
+            break;
+        }
+        if (fwrite(ptr, 1, len, stdout) != len) {
+            fprintf(stderr, "Failed writing output: %s\n", strerror(errno));
+            goto cleanup;
+        }
+        num++;
+    }
+    if (fflush(stdout) != 0) {
+        fprintf(stderr, "Failed writing output: %s\n", strerror(errno));
+        goto cleanup;
+    }
+
+    status = 0;
+
+cleanup:
+    aushape_shm_consumer_close(consumer);
+    return status;
+}
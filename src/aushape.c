@@ -17,13 +17,23 @@
  */
 
 #include <config.h>
+#include <aushape/async_output.h>
+#include <aushape/comp_output.h>
 #include <aushape/conf.h>
 #include <aushape/conv.h>
+#include <aushape/devlog_output.h>
 #include <aushape/fd_output.h>
-#include <aushape/syslog_output.h>
+#include <aushape/file_output.h>
+#include <aushape/http_output.h>
+#include <aushape/journal_output.h>
+#include <aushape/par_comp_output.h>
+#include <aushape/key_dict.h>
+#include <aushape/shm_output.h>
+#include <aushape/sock_output.h>
+#include <aushape/spool_output.h>
+#include <aushape/sqlite_output.h>
 #include <aushape/syslog_misc.h>
 #include <auparse.h>
-#include <syslog.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -35,74 +45,272 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <limits.h>
 
+/** Outputs created for an output configuration, to report on */
+struct output_set {
+    /** Native syslog output, or NULL, if none */
+    struct aushape_output  *devlog;
+    /** HTTP bulk output, or NULL, if none */
+    struct aushape_output  *http;
+    /** Shared-memory output, or NULL, if none */
+    struct aushape_output  *shm;
+    /** Spooling output, or NULL, if none */
+    struct aushape_output  *spool;
+    /** Asynchronous output, or NULL, if none */
+    struct aushape_output  *async;
+};
+
 /**
- * Create a converter attached to an output according to configuration.
+ * Create an output according to output configuration.
  *
- * @param pconv Location for the created converter pointer.
- * @param conf  The aushape configuration.
+ * @param poutput   Location for the created output pointer.
+ * @param set       Location for the pointers to the outputs created, which
+ *                  are owned by the created output, and are reported on.
+ * @param conf      The output configuration.
  *
- * @return True if converter created successfully, false if creation failed,
+ * @return True if output created successfully, false if creation failed,
  *         and an error message was printed to stderr.
  */
 static bool
-create_converter(struct aushape_conv **pconv,
-                 const struct aushape_conf *conf)
+create_output(struct aushape_output **poutput,
+              struct output_set *set,
+              const struct aushape_conf_output *conf)
 {
     bool result = false;
-    int output_fd = -1;
-    bool output_fd_owned = false;
     struct aushape_output *output = NULL;
-    struct aushape_conv *conv = NULL;
     enum aushape_rc rc;
 
     /* Create output */
+    memset(set, 0, sizeof(*set));
     if (conf->output_type == AUSHAPE_CONF_OUTPUT_TYPE_FD) {
-        if (strcmp(conf->output_conf.fd.path, "-") == 0) {
-            output_fd = STDOUT_FILENO;
+        const struct aushape_conf_fd_output *fd_conf = &conf->output_conf.fd;
+        if (strcmp(fd_conf->path, "-") == 0) {
+            rc = aushape_fd_output_create_synced(&output, STDOUT_FILENO, false,
+                                                 fd_conf->buf_size,
+                                                 fd_conf->max_latency,
+                                                 fd_conf->sync_interval,
+                                                 fd_conf->sync_size);
         } else {
-            output_fd = open(conf->output_conf.fd.path,
-                             O_CREAT | O_TRUNC | O_WRONLY,
-                             S_IRUSR | S_IRGRP | S_IROTH |
-                             S_IWUSR | S_IWGRP | S_IWOTH);
-            if (output_fd < 0) {
+            rc = aushape_file_output_create(&output, fd_conf->path,
+                                            fd_conf->buf_size,
+                                            fd_conf->max_latency,
+                                            fd_conf->sync_interval,
+                                            fd_conf->sync_size,
+                                            (uint64_t)fd_conf->rotate_size,
+                                            fd_conf->rotate_time,
+                                            fd_conf->prealloc);
+            if (rc == AUSHAPE_RC_OUTPUT_INIT_FAILED) {
                 fprintf(stderr, "Failed opening output file \"%s\": %s\n",
-                        conf->output_conf.fd.path, strerror(errno));
+                        fd_conf->path, strerror(errno));
                 goto cleanup;
             }
-            output_fd_owned = true;
         }
-        rc = aushape_fd_output_create(&output, output_fd, output_fd_owned);
         if (rc != AUSHAPE_RC_OK) {
             fprintf(stderr, "Failed creating output: %s\n",
                     aushape_rc_to_desc(rc));
             goto cleanup;
         }
-        output_fd_owned = false;
+        if (aushape_comp_is_valid(conf->comp.comp)) {
+            struct aushape_output *comp_output;
+            if (conf->comp.threads > 0) {
+                rc = aushape_par_comp_output_create(&comp_output,
+                                                    output, true,
+                                                    conf->comp.comp,
+                                                    conf->comp.level,
+                                                    conf->comp.frame_size,
+                                                    conf->comp.threads);
+            } else {
+                rc = aushape_comp_output_create(&comp_output, output, true,
+                                                conf->comp.comp,
+                                                conf->comp.level,
+                                                conf->comp.frame_size,
+                                                conf->comp.indexed);
+            }
+            if (rc != AUSHAPE_RC_OK) {
+                fprintf(stderr, "Failed creating compressed output: %s\n",
+                        aushape_rc_to_desc(rc));
+                goto cleanup;
+            }
+            output = comp_output;
+        }
     } else if (conf->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SYSLOG) {
-        openlog("aushape", LOG_NDELAY, conf->output_conf.syslog.facility);
-        rc = aushape_syslog_output_create(&output,
-                                          conf->output_conf.syslog.priority);
+        const struct aushape_conf_syslog_output *syslog_conf =
+                                                &conf->output_conf.syslog;
+        rc = aushape_devlog_output_create(&output, syslog_conf->path,
+                                          "aushape",
+                                          syslog_conf->facility,
+                                          syslog_conf->priority,
+                                          syslog_conf->format,
+                                          syslog_conf->batch_size,
+                                          syslog_conf->queue_size,
+                                          syslog_conf->max_latency);
         if (rc != AUSHAPE_RC_OK) {
-            fprintf(stderr, "Failed creating output: %s\n",
+            fprintf(stderr, "Failed creating syslog output: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+        set->devlog = output;
+    } else if (conf->output_type == AUSHAPE_CONF_OUTPUT_TYPE_JOURNAL) {
+        const struct aushape_conf_journal_output *journal_conf =
+                                                &conf->output_conf.journal;
+        rc = aushape_journal_output_create(&output, journal_conf->path,
+                                           "aushape",
+                                           conf->output_conf.syslog.facility,
+                                           conf->output_conf.syslog.priority,
+                                           journal_conf->batch_size,
+                                           journal_conf->max_latency);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating journal output: %s\n",
                     aushape_rc_to_desc(rc));
             goto cleanup;
         }
+    } else if (conf->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SOCK) {
+        const struct aushape_conf_sock_output *sock_conf =
+                                                &conf->output_conf.sock;
+        rc = aushape_sock_output_create(&output, sock_conf->proto,
+                                        sock_conf->addr, sock_conf->framed,
+                                        sock_conf->buf_size,
+                                        sock_conf->max_latency,
+                                        sock_conf->retry_min,
+                                        sock_conf->retry_max,
+                                        sock_conf->timeout);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating socket output: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+    } else if (conf->output_type == AUSHAPE_CONF_OUTPUT_TYPE_HTTP) {
+        const struct aushape_conf_http_output *http_conf =
+                                                &conf->output_conf.http;
+        rc = aushape_http_output_create(&output, http_conf->url,
+                                        http_conf->index, http_conf->gzip,
+                                        http_conf->batch_size,
+                                        http_conf->max_latency,
+                                        http_conf->retry_min,
+                                        http_conf->retry_max,
+                                        http_conf->timeout);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating HTTP output: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+        set->http = output;
+    } else if (conf->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SQLITE) {
+        const struct aushape_conf_sqlite_output *sqlite_conf =
+                                                &conf->output_conf.sqlite;
+        rc = aushape_sqlite_output_create(&output, sqlite_conf->path,
+                                          sqlite_conf->batch_size,
+                                          sqlite_conf->max_latency);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating SQLite output: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+    } else if (conf->output_type == AUSHAPE_CONF_OUTPUT_TYPE_SHM) {
+        const struct aushape_conf_shm_output *shm_conf =
+                                                &conf->output_conf.shm;
+        rc = aushape_shm_output_create(&output, shm_conf->path,
+                                       shm_conf->size, shm_conf->block);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating shared-memory output: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+        set->shm = output;
     } else {
         fprintf(stderr, "Unknown output type: %u\n",
                 (unsigned int)conf->output_type);
         goto cleanup;
     }
 
-    /* Create converter */
-    rc = aushape_conv_create(&conv, &conf->format, output, true);
-    if (rc != AUSHAPE_RC_OK) {
-        fprintf(stderr, "Failed creating converter: %s\n",
-                aushape_rc_to_desc(rc));
-        goto cleanup;
+    /* Spool output to disk, if requested */
+    if (conf->spool.dir != NULL) {
+        struct aushape_output *spool_output;
+        rc = aushape_spool_output_create(&spool_output, output, true,
+                                         conf->spool.dir,
+                                         (uint64_t)conf->spool.max_size,
+                                         (uint64_t)conf->spool.segment_size,
+                                         conf->spool.retry,
+                                         conf->spool.policy);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating spooling output in \"%s\": %s\n",
+                    conf->spool.dir, aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+        output = spool_output;
+        set->spool = spool_output;
+    }
+
+    /* Move writing to a separate thread, if requested */
+    if (conf->async.queue_size > 0) {
+        struct aushape_output *async_output;
+        rc = aushape_async_output_create(&async_output, output, true,
+                                         conf->async.queue_size,
+                                         conf->async.policy);
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating asynchronous output: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+        output = async_output;
+        set->async = async_output;
     }
+
+    /* Output the output */
+    *poutput = output;
     output = NULL;
+    result = true;
+cleanup:
+
+    aushape_output_destroy(output);
+    return result;
+}
+
+/**
+ * Create a converter attached to outputs according to configuration.
+ *
+ * @param pconv     Location for the created converter pointer.
+ * @param set_list  Location for the output sets created for each output
+ *                  configuration, owned by the converter, to report on.
+ * @param conf      The aushape configuration.
+ *
+ * @return True if converter created successfully, false if creation failed,
+ *         and an error message was printed to stderr.
+ */
+static bool
+create_converter(struct aushape_conv **pconv,
+                 struct output_set *set_list,
+                 const struct aushape_conf *conf)
+{
+    bool result = false;
+    struct aushape_output *output = NULL;
+    struct aushape_conv *conv = NULL;
+    const struct aushape_conf_output *output_conf;
+    enum aushape_rc rc;
+    size_t i;
+
+    for (i = 0; i < conf->output_num; i++) {
+        output_conf = &conf->output_list[i];
+        if (!create_output(&output, &set_list[i], output_conf)) {
+            goto cleanup;
+        }
+        /* Parse once, format separately for each output */
+        if (conv == NULL) {
+            rc = aushape_conv_create(&conv, &output_conf->format,
+                                     output, true);
+        } else {
+            rc = aushape_conv_add_output(conv, &output_conf->format,
+                                         output, true);
+        }
+        if (rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Failed creating converter: %s\n",
+                    aushape_rc_to_desc(rc));
+            goto cleanup;
+        }
+        output = NULL;
+    }
 
     /* Output converter */
     *pconv = conv;
@@ -110,14 +318,126 @@ create_converter(struct aushape_conv **pconv,
     result = true;
 cleanup:
 
-    if (output_fd_owned) {
-        close(output_fd);
-    }
     aushape_output_destroy(output);
     aushape_conv_destroy(conv);
     return result;
 }
 
+/**
+ * Report statistics of outputs which lost, or had rejected any output.
+ *
+ * @param set   The set of outputs to report on.
+ */
+static void
+report_outputs(const struct output_set *set)
+{
+    struct aushape_devlog_output_stats devlog_stats;
+    struct aushape_http_output_stats http_stats;
+    struct aushape_shm_output_stats shm_stats;
+    struct aushape_spool_output_stats spool_stats;
+    struct aushape_async_output_stats async_stats;
+
+    /* Report output lost to a full asynchronous queue */
+    if (set->async != NULL &&
+        aushape_async_output_get_stats(set->async,
+                                       &async_stats) == AUSHAPE_RC_OK &&
+        async_stats.dropped > 0) {
+        fprintf(stderr, "Dropped %" PRIu64 " output items, "
+                        "the queue was full %" PRIu64 " times\n",
+                async_stats.dropped, async_stats.full);
+    }
+
+    /* Report output lost to a full spool */
+    if (set->spool != NULL &&
+        aushape_spool_output_get_stats(set->spool,
+                                       &spool_stats) == AUSHAPE_RC_OK &&
+        spool_stats.dropped > 0) {
+        fprintf(stderr, "Dropped %" PRIu64 " bytes of output, "
+                        "the spool was full %" PRIu64 " times\n",
+                spool_stats.dropped, spool_stats.full);
+    }
+
+    /* Report messages the syslog socket couldn't take, or still queued */
+    if (set->devlog != NULL &&
+        aushape_devlog_output_get_stats(set->devlog,
+                                        &devlog_stats) == AUSHAPE_RC_OK &&
+        devlog_stats.dropped + devlog_stats.depth > 0) {
+        fprintf(stderr, "Dropped %" PRIu64 " syslog messages, "
+                        "the socket was full %" PRIu64 " times\n",
+                devlog_stats.dropped + devlog_stats.depth,
+                devlog_stats.full);
+    }
+
+    /* Report events the HTTP server refused to index */
+    if (set->http != NULL &&
+        aushape_http_output_get_stats(set->http,
+                                      &http_stats) == AUSHAPE_RC_OK &&
+        http_stats.rejected > 0) {
+        fprintf(stderr, "%" PRIu64 " of %" PRIu64 " events were rejected "
+                        "by the HTTP server\n",
+                http_stats.rejected, http_stats.events);
+    }
+
+    /* Report items lost to a full shared-memory ring */
+    if (set->shm != NULL &&
+        aushape_shm_output_get_stats(set->shm,
+                                     &shm_stats) == AUSHAPE_RC_OK &&
+        shm_stats.dropped > 0) {
+        fprintf(stderr, "Dropped %" PRIu64 " shared-memory items, "
+                        "the ring was full %" PRIu64 " times\n",
+                shm_stats.dropped, shm_stats.full);
+    }
+}
+
+/**
+ * Report converter outputs which failed, if any.
+ *
+ * @param conv  The converter to report the outputs of.
+ * @param num   Number of the converter's outputs.
+ *
+ * @return True if any output failed, false otherwise.
+ */
+static bool
+report_failed_outputs(const struct aushape_conv *conv, size_t num)
+{
+    bool failed = false;
+    enum aushape_rc rc;
+    size_t i;
+
+    for (i = 0; i < num; i++) {
+        if (aushape_conv_get_output_rc(conv, i, &rc) == AUSHAPE_RC_OK &&
+            rc != AUSHAPE_RC_OK) {
+            fprintf(stderr, "Output #%zu failed: %s\n",
+                    i + 1, aushape_rc_to_desc(rc));
+            failed = true;
+        }
+    }
+    return failed;
+}
+
+/**
+ * Check if any of the converter outputs failed.
+ *
+ * @param conv  The converter to check the outputs of.
+ * @param num   Number of the converter's outputs.
+ *
+ * @return True if any output failed, false otherwise.
+ */
+static bool
+any_output_failed(const struct aushape_conv *conv, size_t num)
+{
+    enum aushape_rc rc;
+    size_t i;
+
+    for (i = 0; i < num; i++) {
+        if (aushape_conv_get_output_rc(conv, i, &rc) == AUSHAPE_RC_OK &&
+            rc != AUSHAPE_RC_OK) {
+            return true;
+        }
+    }
+    return false;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -126,9 +446,11 @@ main(int argc, char **argv)
     bool input_fd_owned = false;
     int input_fd;
     struct aushape_conv *conv = NULL;
+    struct output_set set_list[AUSHAPE_CONF_OUTPUT_MAX];
     enum aushape_rc aushape_rc;
     char buf[4096];
     ssize_t rc;
+    size_t i;
 
     /* Setup auparse library, if necessary */
 #if AUPARSE_SET_ESCAPE_MODE_VER == 1
@@ -162,6 +484,19 @@ main(int argc, char **argv)
         goto cleanup;
     }
 
+    /* If asked for the key dictionary, output it as a sidecar file */
+    if (conf.key_dict) {
+        fprintf(stdout, "%s%s\n",
+                AUSHAPE_KEY_DICT_MAGIC, aushape_key_dict_version);
+        for (i = 0; i < aushape_key_dict_num; i++) {
+            fprintf(stdout, "%s %s\n",
+                    aushape_key_dict_list[i].id,
+                    aushape_key_dict_list[i].name);
+        }
+        status = 0;
+        goto cleanup;
+    }
+
     /* Open input */
     if (strcmp(conf.input, "-") == 0) {
         input_fd = STDIN_FILENO;
@@ -176,12 +511,14 @@ main(int argc, char **argv)
     }
 
     /* Create converter */
-    if (!create_converter(&conv, &conf)) {
+    if (!create_converter(&conv, set_list, &conf)) {
         goto cleanup;
     }
 
+    /* Carry on with the working outputs, if only some failed */
     aushape_rc = aushape_conv_begin(conv);
-    if (aushape_rc != AUSHAPE_RC_OK) {
+    if (aushape_rc != AUSHAPE_RC_OK &&
+        !any_output_failed(conv, conf.output_num)) {
         fprintf(stderr, "Failed starting document: %s\n",
                 aushape_rc_to_desc(aushape_rc));
         goto cleanup;
@@ -197,27 +534,39 @@ main(int argc, char **argv)
     }
 
     aushape_rc = aushape_conv_flush(conv);
-    if (aushape_rc != AUSHAPE_RC_OK) {
+    if (aushape_rc != AUSHAPE_RC_OK &&
+        !any_output_failed(conv, conf.output_num)) {
         fprintf(stderr, "Failed flushing the converter: %s\n",
                 aushape_rc_to_desc(aushape_rc));
         goto cleanup;
     }
 
     aushape_rc = aushape_conv_end(conv);
-    if (aushape_rc != AUSHAPE_RC_OK) {
+    if (aushape_rc != AUSHAPE_RC_OK &&
+        !any_output_failed(conv, conf.output_num)) {
         fprintf(stderr, "Failed finishing document: %s\n",
                 aushape_rc_to_desc(aushape_rc));
         goto cleanup;
     }
 
+    /* Report outputs which lost, or had rejected any output */
+    for (i = 0; i < conf.output_num; i++) {
+        report_outputs(&set_list[i]);
+    }
+
     if (rc < 0) {
         fprintf(stderr, "Failed reading input: %s\n", strerror(errno));
         goto cleanup;
     }
 
-    status = 0;
+    if (!any_output_failed(conv, conf.output_num)) {
+        status = 0;
+    }
 
 cleanup:
+    if (conv != NULL) {
+        report_failed_outputs(conv, conf.output_num);
+    }
     aushape_conv_destroy(conv);
     if (input_fd_owned) {
         close(input_fd);